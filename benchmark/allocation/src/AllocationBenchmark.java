@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class AllocationBenchmark {
+    private Object sink;
+
+    public void timeNewObject(int count) {
+        for (int i = 0; i < count; ++i) {
+            sink = new Object();
+        }
+    }
+
+    public void timeNewSmallInstance(int count) {
+        for (int i = 0; i < count; ++i) {
+            sink = new Point(i, i);
+        }
+    }
+
+    public void timeNewIntArray16(int count) {
+        for (int i = 0; i < count; ++i) {
+            sink = new int[16];
+        }
+    }
+
+    public void timeNewIntArray1024(int count) {
+        for (int i = 0; i < count; ++i) {
+            sink = new int[1024];
+        }
+    }
+
+    public void timeNewObjectArray16(int count) {
+        for (int i = 0; i < count; ++i) {
+            sink = new Object[16];
+        }
+    }
+
+    public void timeNewByteArrayVariableSize(int count) {
+        for (int i = 0; i < count; ++i) {
+            sink = new byte[i & 255];
+        }
+    }
+
+    static class Point {
+        final int x;
+        final int y;
+
+        Point(int x, int y) {
+            this.x = x;
+            this.y = y;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Each operation is one explicit collection, so the reported time per operation approximates
+ * the pause of a full collection over a heap of the given shape.
+ */
+public class GcPauseBenchmark {
+    private static final int kTreeDepth = 16;
+    private static final int kListLength = 1 << 16;
+    private static final int kArrayCount = 64;
+
+    private Object retained;
+
+    public void timeGcEmptyHeap(int count) {
+        retained = null;
+        collect(count);
+    }
+
+    public void timeGcBinaryTrees(int count) {
+        retained = makeTree(kTreeDepth);
+        collect(count);
+        retained = null;
+    }
+
+    public void timeGcLinkedList(int count) {
+        Node head = null;
+        for (int i = 0; i < kListLength; ++i) {
+            head = new Node(head, null);
+        }
+        retained = head;
+        collect(count);
+        retained = null;
+    }
+
+    public void timeGcLargeArrays(int count) {
+        Object[] arrays = new Object[kArrayCount];
+        for (int i = 0; i < kArrayCount; ++i) {
+            arrays[i] = new long[16 * 1024];
+        }
+        retained = arrays;
+        collect(count);
+        retained = null;
+    }
+
+    public void timeGcReferenceArrays(int count) {
+        Object[][] arrays = new Object[kArrayCount][];
+        for (int i = 0; i < kArrayCount; ++i) {
+            arrays[i] = new Object[1024];
+            for (int j = 0; j < arrays[i].length; ++j) {
+                arrays[i][j] = new Object();
+            }
+        }
+        retained = arrays;
+        collect(count);
+        retained = null;
+    }
+
+    private static void collect(int count) {
+        Runtime runtime = Runtime.getRuntime();
+        for (int i = 0; i < count; ++i) {
+            runtime.gc();
+        }
+    }
+
+    private static Node makeTree(int depth) {
+        return (depth == 0) ? null : new Node(makeTree(depth - 1), makeTree(depth - 1));
+    }
+
+    static class Node {
+        final Node left;
+        final Node right;
+
+        Node(Node left, Node right) {
+            this.left = left;
+            this.right = right;
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "jni.h"
+
+#include "base/macros.h"
+#include "base/time_utils.h"
+#include "gc/gc_pause_listener.h"
+#include "gc/heap.h"
+#include "runtime.h"
+
+namespace art {
+namespace {
+
+// Records the duration of every pause of the mutators, as reported to the heap's
+// GcPauseListener. Only one listener can be installed, so this replaces the JVMTI one.
+class PauseRecorder final : public gc::GcPauseListener {
+ public:
+  void StartPause() override {
+    pause_start_ns_ = NanoTime();
+  }
+
+  void EndPause() override {
+    uint64_t pause_ns = NanoTime() - pause_start_ns_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    pauses_ns_.push_back(pause_ns);
+  }
+
+  std::vector<uint64_t> TakePauses() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<uint64_t> pauses;
+    pauses.swap(pauses_ns_);
+    return pauses;
+  }
+
+ private:
+  // Pauses do not overlap, so the start time needs no lock.
+  uint64_t pause_start_ns_ = 0u;
+  std::mutex mutex_;
+  std::vector<uint64_t> pauses_ns_;
+};
+
+PauseRecorder gPauseRecorder;
+uint64_t gStartGcCount = 0u;
+uint64_t gStartGcCpuTimeNs = 0u;
+
+uint64_t Percentile(const std::vector<uint64_t>& sorted, size_t percent) {
+  if (sorted.empty()) {
+    return 0u;
+  }
+  size_t index = (sorted.size() - 1u) * percent / 100u;
+  return sorted[index];
+}
+
+extern "C" JNIEXPORT void JNICALL Java_GcStressBenchmark_startRecording(JNIEnv*, jclass) {
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  gPauseRecorder.TakePauses();
+  gStartGcCount = heap->GetGcCount();
+  gStartGcCpuTimeNs = heap->GetTotalGcCpuTime();
+  heap->SetGcPauseListener(&gPauseRecorder);
+}
+
+// Returns { number of collections, number of pauses, p50, p99 and maximum pause in
+// nanoseconds, GC CPU time in nanoseconds } since the call to `startRecording()`.
+extern "C" JNIEXPORT jlongArray JNICALL Java_GcStressBenchmark_stopRecording(JNIEnv* env,
+                                                                             jclass) {
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  heap->RemoveGcPauseListener();
+  std::vector<uint64_t> pauses = gPauseRecorder.TakePauses();
+  std::sort(pauses.begin(), pauses.end());
+  jlong results[] = {
+      static_cast<jlong>(heap->GetGcCount() - gStartGcCount),
+      static_cast<jlong>(pauses.size()),
+      static_cast<jlong>(Percentile(pauses, 50u)),
+      static_cast<jlong>(Percentile(pauses, 99u)),
+      static_cast<jlong>(pauses.empty() ? 0u : pauses.back()),
+      static_cast<jlong>(heap->GetTotalGcCpuTime() - gStartGcCpuTimeNs),
+  };
+  jlongArray array = env->NewLongArray(arraysize(results));
+  if (array != nullptr) {
+    env->SetLongArrayRegion(array, 0, arraysize(results), results);
+  }
+  return array;
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_GcStressBenchmark_collectorName(JNIEnv* env, jclass) {
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  std::ostringstream os;
+  os << heap->CurrentCollectorType();
+  if (heap->CurrentCollectorType() == gc::kCollectorTypeCC && heap->GetUseGenerationalCC()) {
+    os << " (generational)";
+  }
+  return env->NewStringUTF(os.str().c_str());
+}
+
+}  // namespace
+}  // namespace art
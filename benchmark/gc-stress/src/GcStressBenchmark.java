@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.ref.WeakReference;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Builds a live heap of the requested shape, then runs mutator threads that allocate short-lived
+ * objects at a fixed rate and overwrite parts of the live heap, and reports the GC pauses seen
+ * in the meantime.
+ */
+public class GcStressBenchmark {
+    private static final int kNodeBytes = 64;
+    private static final int kHugeArrayBytes = 1024 * 1024;
+
+    private static native void startRecording();
+    private static native long[] stopRecording();
+    private static native String collectorName();
+
+    private String shape = "tree";
+    private int liveMb = 64;
+    private int allocMbPerSecond = 100;
+    private int threads = 1;
+    private int seconds = 10;
+
+    // Roots of the live heap. Mutators replace random entries, which also creates references
+    // from old objects to newly allocated ones.
+    private Object[] roots;
+
+    public static void main(String[] args) throws Exception {
+        System.loadLibrary("artbenchmark");
+        GcStressBenchmark benchmark = new GcStressBenchmark();
+        for (int i = 0; i < args.length; ++i) {
+            switch (args[i]) {
+                case "--shape":
+                    benchmark.shape = args[++i];
+                    break;
+                case "--live-mb":
+                    benchmark.liveMb = Integer.parseInt(args[++i]);
+                    break;
+                case "--alloc-mb-per-s":
+                    benchmark.allocMbPerSecond = Integer.parseInt(args[++i]);
+                    break;
+                case "--threads":
+                    benchmark.threads = Integer.parseInt(args[++i]);
+                    break;
+                case "--seconds":
+                    benchmark.seconds = Integer.parseInt(args[++i]);
+                    break;
+                default:
+                    System.err.println("Unknown option " + args[i]);
+                    System.exit(1);
+            }
+        }
+        benchmark.run();
+    }
+
+    private void run() throws Exception {
+        long liveBytes = (long) liveMb * 1024 * 1024;
+        roots = buildLiveHeap(shape, liveBytes);
+        Runtime.getRuntime().gc();
+
+        startRecording();
+        long start = System.nanoTime();
+        long deadline = start + seconds * 1000L * 1000 * 1000;
+        Mutator[] mutators = new Mutator[threads];
+        for (int i = 0; i < threads; ++i) {
+            mutators[i] = new Mutator(i, deadline);
+            mutators[i].start();
+        }
+        long allocatedBytes = 0;
+        for (Mutator mutator : mutators) {
+            mutator.join();
+            allocatedBytes += mutator.allocatedBytes;
+        }
+        long elapsedNs = System.nanoTime() - start;
+        long[] stats = stopRecording();
+
+        System.out.println("{\"shape\": \"" + shape + "\", "
+                + "\"collector\": \"" + collectorName() + "\", "
+                + "\"live_mb\": " + liveMb + ", "
+                + "\"threads\": " + threads + ", "
+                + "\"target_alloc_mb_per_s\": " + allocMbPerSecond + ", "
+                + "\"alloc_mb_per_s\": "
+                + (allocatedBytes / (1024.0 * 1024.0)) / (elapsedNs / 1e9) + ", "
+                + "\"gc_count\": " + stats[0] + ", "
+                + "\"pauses\": " + stats[1] + ", "
+                + "\"pause_p50_ns\": " + stats[2] + ", "
+                + "\"pause_p99_ns\": " + stats[3] + ", "
+                + "\"pause_max_ns\": " + stats[4] + ", "
+                + "\"gc_cpu_ns\": " + stats[5] + ", "
+                + "\"wall_ns\": " + elapsedNs + "}");
+    }
+
+    private static Object[] buildLiveHeap(String shape, long liveBytes) {
+        int nodes = (int) (liveBytes / kNodeBytes);
+        switch (shape) {
+            case "tree": {
+                // Complete binary trees of 1024 nodes, so that mutators can replace subtrees.
+                Object[] trees = new Object[Math.max(1, nodes / 1024)];
+                for (int i = 0; i < trees.length; ++i) {
+                    trees[i] = makeTree(10);
+                }
+                return trees;
+            }
+            case "list": {
+                // A few very deep lists, which are the worst case for marking parallelism.
+                Object[] lists = new Object[4];
+                for (int i = 0; i < lists.length; ++i) {
+                    Node head = null;
+                    for (int j = 0; j < nodes / lists.length; ++j) {
+                        head = new Node(head, null);
+                    }
+                    lists[i] = head;
+                }
+                return lists;
+            }
+            case "arrays": {
+                Object[] arrays = new Object[(int) Math.max(1, liveBytes / kHugeArrayBytes)];
+                for (int i = 0; i < arrays.length; ++i) {
+                    // Alternate primitive arrays and reference arrays full of small objects.
+                    if ((i & 1) == 0) {
+                        arrays[i] = new long[kHugeArrayBytes / 8];
+                    } else {
+                        Object[] references = new Object[kHugeArrayBytes / kNodeBytes];
+                        for (int j = 0; j < references.length; ++j) {
+                            references[j] = new Node(null, null);
+                        }
+                        arrays[i] = references;
+                    }
+                }
+                return arrays;
+            }
+            case "weak": {
+                // Every other referent is only weakly reachable and cleared by the next GC.
+                Object[] references = new Object[nodes / 2];
+                List<Object> strong = new ArrayList<>();
+                for (int i = 0; i < references.length; ++i) {
+                    Node referent = new Node(null, null);
+                    if ((i & 1) == 0) {
+                        strong.add(referent);
+                    }
+                    references[i] = new WeakReference<>(referent);
+                }
+                return new Object[] { references, strong };
+            }
+            case "finalizers": {
+                Object[] objects = new Object[nodes];
+                for (int i = 0; i < objects.length; ++i) {
+                    objects[i] = new Finalizable();
+                }
+                return objects;
+            }
+            default:
+                throw new IllegalArgumentException("Unknown heap shape " + shape);
+        }
+    }
+
+    private static Node makeTree(int depth) {
+        return (depth == 0) ? null : new Node(makeTree(depth - 1), makeTree(depth - 1));
+    }
+
+    private class Mutator extends Thread {
+        private final Random random;
+        private final long deadline;
+        long allocatedBytes;
+
+        Mutator(int id, long deadline) {
+            this.random = new Random(id);
+            this.deadline = deadline;
+        }
+
+        @Override
+        public void run() {
+            double bytesPerNs = allocMbPerSecond * 1024.0 * 1024.0 / 1e9 / threads;
+            long start = System.nanoTime();
+            Object last = null;
+            for (long now = start; now < deadline; now = System.nanoTime()) {
+                if (allocatedBytes > (now - start) * bytesPerNs) {
+                    // Ahead of the requested allocation rate.
+                    try {
+                        Thread.sleep(1);
+                    } catch (InterruptedException e) {
+                        return;
+                    }
+                    continue;
+                }
+                // Allocate in batches to keep the overhead of the rate control low.
+                for (int i = 0; i < 256; ++i) {
+                    int size = 16 + random.nextInt(496);
+                    last = shape.equals("finalizers") ? new Finalizable() : new byte[size];
+                    allocatedBytes += shape.equals("finalizers") ? kNodeBytes : size;
+                }
+                Object[] liveRoots = roots;
+                if (liveRoots.length != 0) {
+                    replaceRoot(liveRoots, random.nextInt(liveRoots.length), last);
+                }
+            }
+        }
+    }
+
+    private void replaceRoot(Object[] liveRoots, int index, Object young) {
+        switch (shape) {
+            case "tree":
+                // Replace the root of a tree, keeping half of the old tree alive.
+                liveRoots[index] = new Node(((Node) liveRoots[index]).left, null);
+                break;
+            case "finalizers":
+                liveRoots[index] = young;
+                break;
+            default:
+                // Keep the live heap of other shapes unchanged, their mutators only
+                // allocate garbage.
+                break;
+        }
+    }
+
+    static class Node {
+        final Node left;
+        final Node right;
+        final byte[] payload = new byte[16];
+
+        Node(Node left, Node right) {
+            this.left = left;
+            this.right = right;
+        }
+    }
+
+    static class Finalizable {
+        final byte[] payload = new byte[16];
+
+        @Override
+        protected void finalize() {
+        }
+    }
+}
@@ -16,6 +16,7 @@
 
 #include "jni.h"
 
+#include "indirect_reference_table-inl.h"
 #include "jni/java_vm_ext.h"
 #include "mirror/class-inl.h"
 #include "scoped_thread_state_change-inl.h"
@@ -23,6 +24,9 @@
 namespace art {
 namespace {
 
+// Enough references for the tables to double many times from their initial capacity.
+static constexpr jint kManyRefs = 64 * 1024;
+
 extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeAddRemoveLocal(
     JNIEnv* env, jobject jobj, jint reps) {
   ScopedObjectAccess soa(env);
@@ -46,6 +50,38 @@ extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeDecodeLocal(
   soa.Env()->DeleteLocalRef(ref);
 }
 
+extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeAddManyLocalsInFrame(
+    JNIEnv* env, jobject jobj, jint reps) {
+  ScopedObjectAccess soa(env);
+  ObjPtr<mirror::Object> obj = soa.Decode<mirror::Object>(jobj);
+  CHECK(obj != nullptr);
+  for (jint i = 0; i < reps; ++i) {
+    soa.Env()->PushFrame(/*capacity=*/ 16);
+    for (jint j = 0; j < kManyRefs; ++j) {
+      soa.Env()->AddLocalReference<jobject>(obj);
+    }
+    soa.Env()->PopFrame();
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeGrowLocalTable(
+    JNIEnv* env, jobject jobj, jint reps) {
+  ScopedObjectAccess soa(env);
+  ObjPtr<mirror::Object> obj = soa.Decode<mirror::Object>(jobj);
+  CHECK(obj != nullptr);
+  for (jint i = 0; i < reps; ++i) {
+    std::string error_msg;
+    IndirectReferenceTable table(/*max_count=*/ 512,
+                                 kLocal,
+                                 IndirectReferenceTable::ResizableCapacity::kYes,
+                                 &error_msg);
+    CHECK(table.IsValid()) << error_msg;
+    for (jint j = 0; j < kManyRefs; ++j) {
+      CHECK(table.Add(kIRTFirstSegment, obj, &error_msg) != nullptr) << error_msg;
+    }
+  }
+}
+
 extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeAddRemoveGlobal(
     JNIEnv* env, jobject jobj, jint reps) {
   ScopedObjectAccess soa(env);
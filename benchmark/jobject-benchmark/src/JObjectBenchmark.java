@@ -20,6 +20,8 @@ public class JObjectBenchmark {
     System.loadLibrary("artbenchmark");
     timeAddRemoveLocal(1);
     timeDecodeLocal(1);
+    timeAddManyLocalsInFrame(1);
+    timeGrowLocalTable(1);
     timeAddRemoveGlobal(1);
     timeDecodeGlobal(1);
     timeAddRemoveWeakGlobal(1);
@@ -29,6 +31,8 @@ public class JObjectBenchmark {
 
   public native void timeAddRemoveLocal(int reps);
   public native void timeDecodeLocal(int reps);
+  public native void timeAddManyLocalsInFrame(int reps);
+  public native void timeGrowLocalTable(int reps);
   public native void timeAddRemoveGlobal(int reps);
   public native void timeDecodeGlobal(int reps);
   public native void timeAddRemoveWeakGlobal(int reps);
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni.h"
+
+#include "gc/heap.h"
+#include "runtime.h"
+
+namespace art {
+namespace {
+
+// Typical sizes registered by NativeAllocationRegistry for small bitmaps and buffers.
+static constexpr size_t kAllocationSizes[] = { 64, 256, 4 * KB, 16 * KB };
+
+extern "C" JNIEXPORT void JNICALL Java_NativeAllocationBenchmark_timeRegisterNativeAllocation(
+    JNIEnv* env, jobject, jint reps) {
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  for (jint i = 0; i < reps; ++i) {
+    for (size_t bytes : kAllocationSizes) {
+      heap->RegisterNativeAllocation(env, bytes);
+    }
+    for (size_t bytes : kAllocationSizes) {
+      heap->RegisterNativeFree(env, bytes);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace art
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class NativeAllocationBenchmark {
+  private static final int THREAD_COUNT = 4;
+
+  public NativeAllocationBenchmark() {
+    // Make sure to link methods before benchmark starts.
+    System.loadLibrary("artbenchmark");
+    timeRegisterNativeAllocation(1);
+    timeRegisterNativeAllocationContended(1);
+  }
+
+  // Registers and frees `reps` small native allocations of a few different sizes.
+  public native void timeRegisterNativeAllocation(int reps);
+
+  public void timeRegisterNativeAllocationContended(final int reps) throws Exception {
+    Thread[] threads = new Thread[THREAD_COUNT];
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+      threads[i] = new Thread(() -> timeRegisterNativeAllocation(reps));
+    }
+    for (Thread thread : threads) {
+      thread.start();
+    }
+    for (Thread thread : threads) {
+      thread.join();
+    }
+  }
+}
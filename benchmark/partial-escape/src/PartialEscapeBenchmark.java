@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class PartialEscapeBenchmark {
+    static class Pair {
+        Pair(int first, int second) {
+            this.first = first;
+            this.second = second;
+        }
+        int first;
+        int second;
+    }
+
+    static Pair sEscaped;
+
+    // Every 1024th pair escapes.
+    private static final int RARE_MASK = 1023;
+
+    public int timeNoEscape(int count) {
+        int result = 0;
+        for (int i = 0; i < count; ++i) {
+            Pair pair = new Pair(i, count);
+            result += pair.first ^ pair.second;
+        }
+        return result;
+    }
+
+    public int timeEscapeOnRarePath(int count) {
+        int result = 0;
+        for (int i = 0; i < count; ++i) {
+            Pair pair = new Pair(i, count);
+            if ((i & RARE_MASK) == 0) {
+                sEscaped = pair;
+            } else {
+                result += pair.first ^ pair.second;
+            }
+        }
+        return result;
+    }
+
+    public int timeEscapeOnEveryPath(int count) {
+        int result = 0;
+        for (int i = 0; i < count; ++i) {
+            Pair pair = new Pair(i, count);
+            sEscaped = pair;
+            result += i ^ count;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.invoke.MethodHandle;
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.MethodType;
+import java.lang.reflect.Field;
+import java.lang.reflect.Method;
+
+public class ReflectionInvokeBenchmark {
+    private int value;
+
+    private final Method getValueMethod;
+    private final Method addStaticMethod;
+    private final Field valueField;
+    private final MethodHandle getValueHandle;
+    private final MethodHandle addStaticHandle;
+
+    public ReflectionInvokeBenchmark() throws Exception {
+        getValueMethod = ReflectionInvokeBenchmark.class.getDeclaredMethod("getValue");
+        addStaticMethod =
+                ReflectionInvokeBenchmark.class.getDeclaredMethod("add", int.class, int.class);
+        valueField = ReflectionInvokeBenchmark.class.getDeclaredField("value");
+        MethodHandles.Lookup lookup = MethodHandles.lookup();
+        getValueHandle = lookup.findVirtual(
+                ReflectionInvokeBenchmark.class, "getValue", MethodType.methodType(int.class));
+        addStaticHandle = lookup.findStatic(ReflectionInvokeBenchmark.class,
+                                            "add",
+                                            MethodType.methodType(int.class, int.class, int.class));
+    }
+
+    public int getValue() {
+        return value;
+    }
+
+    public static int add(int a, int b) {
+        return a + b;
+    }
+
+    public void timeMethodInvokeVirtual(int count) throws Exception {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += (Integer) getValueMethod.invoke(this);
+        }
+        value = sum;
+    }
+
+    public void timeMethodInvokeStatic(int count) throws Exception {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum = (Integer) addStaticMethod.invoke(null, sum, 1);
+        }
+        value = sum;
+    }
+
+    public void timeFieldGetInt(int count) throws Exception {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += valueField.getInt(this);
+        }
+        value = sum;
+    }
+
+    public void timeMethodHandleInvokeExactVirtual(int count) throws Throwable {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += (int) getValueHandle.invokeExact(this);
+        }
+        value = sum;
+    }
+
+    public void timeMethodHandleInvokeExactStatic(int count) throws Throwable {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum = (int) addStaticHandle.invokeExact(sum, 1);
+        }
+        value = sum;
+    }
+
+    public void timeMethodHandleInvokeStatic(int count) throws Throwable {
+        // invoke() with boxed arguments goes through an asType() conversion.
+        Integer one = 1;
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum = (int) addStaticHandle.invoke(sum, one);
+        }
+        value = sum;
+    }
+}
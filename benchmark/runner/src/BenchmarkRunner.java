@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Comparator;
+import java.util.List;
+
+/**
+ * Drives the Caliper-style benchmarks of this directory: every public `void timeXxx(int count)`
+ * method of the given classes is calibrated, warmed up and sampled, and the nanoseconds per
+ * operation of each sample are printed as a JSON array on stdout.
+ */
+public class BenchmarkRunner {
+    private int samples = 10;
+    private long sampleNs = 200L * 1000 * 1000;
+    private String filter = "";
+
+    public static void main(String[] args) throws Exception {
+        BenchmarkRunner runner = new BenchmarkRunner();
+        List<String> classNames = new ArrayList<>();
+        for (int i = 0; i < args.length; ++i) {
+            switch (args[i]) {
+                case "--samples":
+                    runner.samples = Integer.parseInt(args[++i]);
+                    break;
+                case "--sample-ms":
+                    runner.sampleNs = Long.parseLong(args[++i]) * 1000 * 1000;
+                    break;
+                case "--filter":
+                    runner.filter = args[++i];
+                    break;
+                default:
+                    classNames.add(args[i]);
+                    break;
+            }
+        }
+        if (classNames.isEmpty() || runner.samples < 2) {
+            System.err.println("Usage: BenchmarkRunner [--samples N] [--sample-ms M] "
+                    + "[--filter SUBSTRING] Class...");
+            System.exit(1);
+        }
+
+        StringBuilder json = new StringBuilder("[\n");
+        boolean first = true;
+        for (String className : classNames) {
+            Class<?> benchmarkClass = Class.forName(className);
+            Object instance = benchmarkClass.getDeclaredConstructor().newInstance();
+            for (Method method : findBenchmarks(benchmarkClass)) {
+                String name = benchmarkClass.getSimpleName() + "." + method.getName();
+                if (!name.contains(runner.filter)) {
+                    continue;
+                }
+                System.err.println("Running " + name);
+                double[] nsPerOp = runner.run(instance, method);
+                if (!first) {
+                    json.append(",\n");
+                }
+                first = false;
+                appendResult(json, name, nsPerOp);
+            }
+        }
+        json.append("\n]");
+        System.out.println(json);
+    }
+
+    private static List<Method> findBenchmarks(Class<?> benchmarkClass) {
+        List<Method> benchmarks = new ArrayList<>();
+        for (Method method : benchmarkClass.getMethods()) {
+            if (method.getName().startsWith("time") &&
+                    !Modifier.isStatic(method.getModifiers()) &&
+                    method.getReturnType() == void.class &&
+                    Arrays.equals(method.getParameterTypes(), new Class<?>[] { int.class })) {
+                benchmarks.add(method);
+            }
+        }
+        // Reflection does not guarantee any order, keep runs of different builds comparable.
+        benchmarks.sort(Comparator.comparing(Method::getName));
+        return benchmarks;
+    }
+
+    private double[] run(Object instance, Method method) throws Exception {
+        // Find a count that takes about a sample's duration. This also warms up the JIT.
+        int count = 1;
+        long elapsed = time(instance, method, count);
+        while (elapsed < sampleNs && count < (1 << 30)) {
+            long scaled = (elapsed <= 0) ? count * 2L : count * sampleNs / elapsed;
+            count = (int) Math.min(1 << 30, Math.max(count * 2L, scaled));
+            elapsed = time(instance, method, count);
+        }
+        double[] nsPerOp = new double[samples];
+        for (int i = 0; i < samples; ++i) {
+            nsPerOp[i] = (double) time(instance, method, count) / count;
+        }
+        return nsPerOp;
+    }
+
+    private static long time(Object instance, Method method, int count) throws Exception {
+        long start = System.nanoTime();
+        try {
+            method.invoke(instance, count);
+        } catch (InvocationTargetException e) {
+            throw new RuntimeException("Benchmark " + method.getName() + " failed", e.getCause());
+        }
+        return System.nanoTime() - start;
+    }
+
+    private static void appendResult(StringBuilder json, String name, double[] nsPerOp) {
+        double[] sorted = nsPerOp.clone();
+        Arrays.sort(sorted);
+        double median = (sorted.length % 2 == 1)
+                ? sorted[sorted.length / 2]
+                : (sorted[sorted.length / 2 - 1] + sorted[sorted.length / 2]) / 2;
+        double mean = 0;
+        for (double value : nsPerOp) {
+            mean += value;
+        }
+        mean /= nsPerOp.length;
+        double variance = 0;
+        for (double value : nsPerOp) {
+            variance += (value - mean) * (value - mean);
+        }
+        variance /= nsPerOp.length - 1;
+
+        json.append("  {\"benchmark\": \"").append(name).append("\", ")
+            .append("\"median_ns\": ").append(median).append(", ")
+            .append("\"mean_ns\": ").append(mean).append(", ")
+            .append("\"stddev_ns\": ").append(Math.sqrt(variance)).append(", ")
+            .append("\"samples_ns\": [");
+        for (int i = 0; i < nsPerOp.length; ++i) {
+            json.append(i == 0 ? "" : ", ").append(nsPerOp[i]);
+        }
+        json.append("]}");
+    }
+}
@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2020 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Generates synthetic apps, launches them repeatedly with the host `art` script and
+   prints their startup times as JSON, in the format of benchmark/runner, so that
+   tools/compare_benchmarks.py can compare two builds."""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import time
+
+MAIN_JAVA = '''
+import java.lang.reflect.Constructor;
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    long start = System.nanoTime();
+    run(Main.class.getClassLoader(), args);
+    long first = System.nanoTime();
+    // Load the app again in a new class loader, with the runtime and the files already hot.
+    ClassLoader boot = ClassLoader.getSystemClassLoader().getParent();
+    run(newPathClassLoader(System.getProperty("java.class.path"), boot), args);
+    long end = System.nanoTime();
+    System.out.println("first_ns " + (first - start));
+    System.out.println("hot_ns " + (end - first));
+  }
+
+  // Each argument is a jar that is loaded by a new class loader, whose parent is
+  // the class loader of the previous jar.
+  private static void run(ClassLoader loader, String[] chain) throws Exception {
+    for (String jar : chain) {
+      loader = newPathClassLoader(jar, loader);
+    }
+    Class.forName("app.Entry", true, loader).getMethod("run").invoke(null);
+  }
+
+  // Use reflection so that Main.java compiles without the Android class library.
+  private static ClassLoader newPathClassLoader(String path, ClassLoader parent) throws Exception {
+    Constructor<?> constructor = Class.forName("dalvik.system.PathClassLoader")
+        .getConstructor(String.class, ClassLoader.class);
+    return (ClassLoader) constructor.newInstance(path, parent);
+  }
+}
+'''
+
+
+def write(path, text):
+  os.makedirs(os.path.dirname(path), exist_ok=True)
+  with open(path, 'w') as f:
+    f.write(text)
+
+
+def class_with_methods(package, name, extra=''):
+  """A class with a few methods that need some verification work."""
+  return '''package %s;
+
+public class %s {
+  private int[] data = new int[8];
+%s
+  public static int value() {
+    return new %s().compute(3);
+  }
+
+  int compute(int n) {
+    int sum = 0;
+    for (int i = 0; i < data.length; ++i) {
+      data[i] = i * n;
+      sum += (i & 1) == 0 ? data[i] : -data[i];
+    }
+    return sum + describe().length();
+  }
+
+  String describe() {
+    StringBuilder sb = new StringBuilder();
+    for (int v : data) {
+      sb.append(v).append(',');
+    }
+    return sb.toString();
+  }
+}
+''' % (package, name, extra, name)
+
+
+def entry(package_classes):
+  calls = ''.join('    sum += %s.value();\n' % c for c in package_classes)
+  return '''package app;
+
+public class Entry {
+  public static int sum;
+
+  public static void run() {
+%s  }
+}
+''' % calls
+
+
+def generate_many_classes(src, count):
+  names = ['C%04d' % i for i in range(count)]
+  for name in names:
+    write(os.path.join(src, 'app', name + '.java'), class_with_methods('app', name))
+  write(os.path.join(src, 'app', 'Entry.java'), entry(names))
+
+
+def generate_heavy_clinit(src, count):
+  clinit = '''  static final int[] TABLE = new int[4096];
+  static final java.util.HashMap<String, Integer> NAMES = new java.util.HashMap<>();
+  static {
+    for (int i = 0; i < TABLE.length; ++i) {
+      TABLE[i] = (i * i) ^ (i >>> 3);
+    }
+    for (int i = 0; i < 64; ++i) {
+      NAMES.put("name" + i, TABLE[i]);
+    }
+  }
+'''
+  names = ['H%03d' % i for i in range(count)]
+  for name in names:
+    write(os.path.join(src, 'app', name + '.java'), class_with_methods('app', name, clinit))
+  write(os.path.join(src, 'app', 'Entry.java'), entry(names))
+
+
+def generate_loader_chain(out, depth, count):
+  """Each part is its own jar and package; classes of a part call into the previous part."""
+  for part in range(depth):
+    package = 'p%d' % part
+    src = os.path.join(out, 'parts', package)
+    for i in range(count):
+      name = 'C%03d' % i
+      extra = ''
+      if part > 0:
+        extra = '  static int previous = p%d.%s.value();\n' % (part - 1, name)
+      write(os.path.join(src, package, name + '.java'), class_with_methods(package, name, extra))
+  last = 'p%d' % (depth - 1)
+  write(os.path.join(out, 'parts', last, 'app', 'Entry.java'),
+        entry(['%s.C%03d' % (last, i) for i in range(count)]))
+
+
+def run(cmd, **kwargs):
+  return subprocess.run(cmd, check=True, stdout=subprocess.PIPE, universal_newlines=True,
+                        **kwargs).stdout
+
+
+def java_sources(src):
+  return [os.path.join(d, f) for d, _, files in os.walk(src) for f in files if f.endswith('.java')]
+
+
+def build_jar(d8, src, out_jar, classpath):
+  classes = out_jar + '.classes'
+  os.makedirs(classes, exist_ok=True)
+  cp = ['-cp', ':'.join(classpath)] if classpath else []
+  run(['javac', '-source', '1.8', '-target', '1.8', '-nowarn', '-d', classes] + cp +
+      java_sources(src))
+  class_files = [os.path.join(d, f) for d, _, files in os.walk(classes)
+                 for f in files if f.endswith('.class')]
+  run([d8, '--min-api', '26', '--output', out_jar] + cp + class_files)
+  return classes
+
+
+def build_apps(args):
+  out = args.out
+  d8 = os.path.join(args.host_out, 'bin', 'd8')
+  apps = {}
+
+  main_src = os.path.join(out, 'main-src')
+  write(os.path.join(main_src, 'Main.java'), MAIN_JAVA)
+
+  generators = (
+      ('many-classes', lambda src: generate_many_classes(src, args.classes)),
+      ('heavy-clinit', lambda src: generate_heavy_clinit(src, args.classes // 10)),
+  )
+  for name, generate in generators:
+    src = os.path.join(out, name, 'src')
+    generate(src)
+    run(['cp', os.path.join(main_src, 'Main.java'), src])
+    jar = os.path.join(out, name, name + '.jar')
+    build_jar(d8, src, jar, [])
+    apps[name] = ([jar], [])
+
+  chain_dir = os.path.join(out, 'loader-chain')
+  generate_loader_chain(chain_dir, args.chain_depth, args.classes // args.chain_depth)
+  parts = []
+  classpath = []
+  for part in range(args.chain_depth):
+    jar = os.path.join(chain_dir, 'p%d.jar' % part)
+    classpath.append(build_jar(d8, os.path.join(chain_dir, 'parts', 'p%d' % part), jar, classpath))
+    parts.append(jar)
+  main_jar = os.path.join(chain_dir, 'main.jar')
+  build_jar(d8, main_src, main_jar, [])
+  apps['loader-chain'] = ([main_jar], parts)
+  return apps
+
+
+def drop_caches():
+  try:
+    with open('/proc/sys/vm/drop_caches', 'w') as f:
+      f.write('3')
+    return True
+  except OSError:
+    return False
+
+
+def launch(art, classpath, chain, flags, compile_first):
+  cmd = [art, '--64', '--no-clean'] + ([] if compile_first else ['--no-compile'])
+  cmd += flags + ['-cp', ':'.join(classpath), 'Main'] + chain
+  start = time.monotonic_ns()
+  output = run(cmd)
+  wall = time.monotonic_ns() - start
+  times = dict(line.split() for line in output.splitlines()
+               if line.startswith(('first_ns ', 'hot_ns ')))
+  return wall, int(times['first_ns']), int(times['hot_ns'])
+
+
+def result(name, samples):
+  return {
+      'benchmark': name,
+      'median_ns': statistics.median(samples),
+      'mean_ns': statistics.mean(samples),
+      'stddev_ns': statistics.stdev(samples) if len(samples) > 1 else 0.0,
+      'samples_ns': samples,
+  }
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('out', help='directory for the generated apps')
+  parser.add_argument('--host-out', default=os.environ.get('ANDROID_HOST_OUT', ''))
+  parser.add_argument('--runs', type=int, default=10)
+  parser.add_argument('--classes', type=int, default=2000,
+                      help='number of classes of the many-classes and loader-chain apps')
+  parser.add_argument('--chain-depth', type=int, default=16)
+  parser.add_argument('--cold', action='store_true',
+                      help='drop the page cache before each launch (needs root)')
+  args = parser.parse_args()
+  if not args.host_out:
+    sys.exit('Set ANDROID_HOST_OUT or pass --host-out')
+  art = os.path.join(args.host_out, 'bin', 'art')
+
+  apps = build_apps(args)
+  # The same apps, compiled without and with an app image by the `art` script.
+  configurations = (('oat', ['-Xcompiler-option', '--compiler-filter=speed']),
+                    ('app-image', ['-Xcompiler-option', '--compiler-filter=speed',
+                                   '-Xcompiler-option', '--app-image-file=%s']))
+  results = []
+  for app, (classpath, chain) in sorted(apps.items()):
+    for config, flags in configurations:
+      jar = classpath[0]
+      image = os.path.join(os.path.dirname(jar), 'oat', 'x86_64',
+                           os.path.splitext(os.path.basename(jar))[0] + '.art')
+      flags = [flag.replace('%s', image) for flag in flags]
+      # The first launch compiles the class path and warms up the page cache.
+      launch(art, classpath, chain, flags, compile_first=True)
+      samples = {'wall': [], 'first': [], 'hot': []}
+      for _ in range(args.runs):
+        if args.cold and not drop_caches():
+          sys.exit('Cannot drop the page cache, run as root or without --cold')
+        wall, first, hot = launch(art, classpath, chain, flags, compile_first=False)
+        samples['wall'].append(wall)
+        samples['first'].append(first)
+        samples['hot'].append(hot)
+      mode = 'cold' if args.cold else 'warm'
+      for kind in ('wall', 'first', 'hot'):
+        results.append(result('startup/%s/%s/%s/%s' % (app, config, mode, kind), samples[kind]))
+  json.dump(results, sys.stdout, indent=2)
+  print()
+
+
+if __name__ == '__main__':
+  main()
@@ -16,6 +16,15 @@
 
 public class StringIndexOfBenchmark {
     public static final String string36 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";  // length = 36
+    public static final String string4 = "0123";  // length = 4
+    public static final String string360 = repeat(string36, 10);  // length = 360
+    public static final String string360Utf16 = repeat(string36, 9) + "0123456789\u00c0BCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    // Copies with the same contents, but a different identity.
+    public static final String string4Copy = new String(string4);
+    public static final String string36Copy = new String(string36);
+    public static final String string360Copy = new String(string360);
+    public static final String string360Utf16Copy = new String(string360Utf16);
 
     public void timeIndexOf0(int count) {
         final char c = '0';
@@ -113,6 +122,67 @@ public class StringIndexOfBenchmark {
         }
     }
 
+    public void timeIndexOfShort(int count) {
+        final char c = '3';
+        String s = string4;
+        for (int i = 0; i < count; ++i) {
+            $noinline$indexOf(s, c);
+        }
+    }
+
+    public void timeIndexOfLong(int count) {
+        final char c = '_';
+        String s = string360;
+        for (int i = 0; i < count; ++i) {
+            $noinline$indexOf(s, c);
+        }
+    }
+
+    public void timeEqualsShort(int count) {
+        String s = string4;
+        String t = string4Copy;
+        for (int i = 0; i < count; ++i) {
+            $noinline$equals(s, t);
+        }
+    }
+
+    public void timeEquals36(int count) {
+        String s = string36;
+        String t = string36Copy;
+        for (int i = 0; i < count; ++i) {
+            $noinline$equals(s, t);
+        }
+    }
+
+    public void timeEqualsLong(int count) {
+        String s = string360;
+        String t = string360Copy;
+        for (int i = 0; i < count; ++i) {
+            $noinline$equals(s, t);
+        }
+    }
+
+    public void timeEqualsLongUtf16(int count) {
+        String s = string360Utf16;
+        String t = string360Utf16Copy;
+        for (int i = 0; i < count; ++i) {
+            $noinline$equals(s, t);
+        }
+    }
+
+    static String repeat(String s, int times) {
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < times; ++i) {
+            sb.append(s);
+        }
+        return sb.toString();
+    }
+
+    static boolean $noinline$equals(String s, Object o) {
+        if (doThrow) { throw new Error(); }
+        return s.equals(o);
+    }
+
     static int $noinline$indexOf(String s, char c) {
         if (doThrow) { throw new Error(); }
         return s.indexOf(c);
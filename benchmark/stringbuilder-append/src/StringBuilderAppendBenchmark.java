@@ -20,6 +20,8 @@ public class StringBuilderAppendBenchmark {
     public static String longString1 = "This is a long string 1";
     public static String longString2 = "This is a long string 2";
     public static int int1 = 42;
+    public static float float1 = 3.25f;
+    public static double double1 = 0.1;
 
     public void timeAppendStrings(int count) {
         String s1 = string1;
@@ -59,4 +61,30 @@ public class StringBuilderAppendBenchmark {
             throw new AssertionError();
         }
     }
+
+    public void timeAppendStringAndFloat(int count) {
+        String s1 = string1;
+        float f1 = float1;
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            String result = s1 + f1;
+            sum += result.length();  // Make sure the append is not optimized away.
+        }
+        if (sum != count * (s1.length() + Float.toString(f1).length())) {
+            throw new AssertionError();
+        }
+    }
+
+    public void timeAppendStringAndDouble(int count) {
+        String s1 = string1;
+        double d1 = double1;
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            String result = s1 + d1;
+            sum += result.length();  // Make sure the append is not optimized away.
+        }
+        if (sum != count * (s1.length() + Double.toString(d1).length())) {
+            throw new AssertionError();
+        }
+    }
 }
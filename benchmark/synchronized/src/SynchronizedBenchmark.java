@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.Hashtable;
+import java.util.Vector;
+
+public class SynchronizedBenchmark {
+    private int value;
+    private final Object lock = new Object();
+
+    public void timeSynchronizedMethod(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$synchronizedIncrement();
+        }
+    }
+
+    public void timeSynchronizedBlock(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$blockIncrement();
+        }
+    }
+
+    public void timeRecursiveSynchronizedMethod(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$recursiveIncrement();
+        }
+    }
+
+    public void timeSynchronizedGetter(int count) {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += $noinline$getValue();
+        }
+        value = sum;
+    }
+
+    public void timeContendedSynchronizedBlock(int count) throws InterruptedException {
+        // A second thread keeps taking the same lock, so that it gets inflated and the
+        // timed thread regularly has to wait for it.
+        final boolean[] done = { false };
+        Thread contender = new Thread(() -> {
+            while (true) {
+                synchronized (lock) {
+                    if (done[0]) {
+                        return;
+                    }
+                    ++value;
+                }
+            }
+        });
+        contender.start();
+        for (int i = 0; i < count; ++i) {
+            $noinline$blockIncrement();
+        }
+        synchronized (lock) {
+            done[0] = true;
+        }
+        contender.join();
+    }
+
+    public void timeStringBufferAppend(int count) {
+        StringBuffer sb = new StringBuffer();
+        for (int i = 0; i < count; ++i) {
+            if (sb.length() >= 1024) {
+                sb.setLength(0);
+            }
+            sb.append('a');
+        }
+    }
+
+    public void timeVectorGet(int count) {
+        Vector<Integer> vector = new Vector<>();
+        vector.add(42);
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += vector.get(0);
+        }
+        value = sum;
+    }
+
+    public void timeHashtableGet(int count) {
+        Hashtable<String, Integer> table = new Hashtable<>();
+        table.put("key", 42);
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += table.get("key");
+        }
+        value = sum;
+    }
+
+    public synchronized void $noinline$synchronizedIncrement() {
+        ++value;
+    }
+
+    public void $noinline$blockIncrement() {
+        synchronized (lock) {
+            ++value;
+        }
+    }
+
+    public synchronized void $noinline$recursiveIncrement() {
+        $noinline$synchronizedIncrement();
+    }
+
+    public synchronized int $noinline$getValue() {
+        return value;
+    }
+}
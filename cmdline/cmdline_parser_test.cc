@@ -236,6 +236,28 @@ TEST_F(CmdlineParserTest, TestSimpleSuccesses) {
   EXPECT_SINGLE_PARSE_VALUE(false, "-XX:DisableHSpaceCompactForOOM", M::EnableHSpaceCompactForOOM);
   EXPECT_SINGLE_PARSE_VALUE(0.5, "-XX:HeapTargetUtilization=0.5", M::HeapTargetUtilization);
   EXPECT_SINGLE_PARSE_VALUE(5u, "-XX:ParallelGCThreads=5", M::ParallelGCThreads);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:ParallelCCMarking:true", M::ParallelCCMarking);
+  EXPECT_SINGLE_PARSE_VALUE(false, "-XX:ParallelCCMarking:false", M::ParallelCCMarking);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:ParallelCCEvacuation:true", M::ParallelCCEvacuation);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:NumaAwareHeap:true", M::NumaAwareHeap);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:NonMovingSpaceTrim:true", M::NonMovingSpaceTrim);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:HugePageHeap:true", M::HugePageHeap);
+  EXPECT_SINGLE_PARSE_VALUE(true,
+                            "-XX:ParallelReferenceProcessing:true",
+                            M::ParallelReferenceProcessing);
+  EXPECT_SINGLE_PARSE_VALUE(true,
+                            "-XX:ParallelSystemWeakSweeping:true",
+                            M::ParallelSystemWeakSweeping);
+  EXPECT_SINGLE_PARSE_VALUE(true,
+                            "-XX:GenerationalCCRememberedSet:true",
+                            M::GenerationalCCRememberedSet);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:ForkedHprofDump:true", M::ForkedHprofDump);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:CompressHprofDump:true", M::CompressHprofDump);
+  EXPECT_SINGLE_PARSE_VALUE(true, "-XX:DeduplicateHprofArrays:true", M::DeduplicateHprofArrays);
+  EXPECT_SINGLE_PARSE_VALUE(5u, "-XX:GcPauseTargetMs=5", M::GcPauseTargetMs);
+  EXPECT_SINGLE_PARSE_VALUE(0.05, "-XX:GcCpuFractionTarget=0.05", M::GcCpuFractionTarget);
+  EXPECT_SINGLE_PARSE_VALUE(
+      4096u, "-XX:RegionEvacuationCopyBudgetKB=4096", M::RegionEvacuationCopyBudgetKB);
   EXPECT_SINGLE_PARSE_EXISTS("-Xno-dex-file-fallback", M::NoDexFileFallback);
 }  // TEST_F
 
@@ -482,6 +504,19 @@ TEST_F(CmdlineParserTest, TestJitOptions) {
   {
     EXPECT_SINGLE_PARSE_VALUE(12345u, "-Xjitthreshold:12345", M::JITCompileThreshold);
   }
+  {
+    EXPECT_SINGLE_PARSE_VALUE(
+        true, "-Xusebaselineplusjit:true", M::UseBaselinePlusJitCompilation);
+    EXPECT_SINGLE_PARSE_VALUE(
+        32u, "-Xjitbaselineplusqueuethreshold:32", M::JITBaselinePlusQueueThreshold);
+  }
+  {
+    EXPECT_SINGLE_PARSE_VALUE(4u, "-Xjitthreadcount:4", M::JITPoolThreadCount);
+    EXPECT_SINGLE_PARSE_VALUE_STR(
+        "/data/misc/jit.warm", "-Xjitwarmstartfile:/data/misc/jit.warm", M::JITWarmStartFile);
+    EXPECT_SINGLE_PARSE_VALUE(
+        true, "-Xjitsegmentedcodecache:true", M::JITSegmentedCodeCache);
+  }
 }  // TEST_F
 
 /*
@@ -49,14 +49,26 @@ class ElfDebugLineWriter {
   // Write line table for given set of methods.
   // Returns the number of bytes written.
   size_t WriteCompilationUnit(ElfCompilationUnit& compilation_unit) {
+    return WriteLineTable(compilation_unit, MakeLineTable(compilation_unit));
+  }
+
+  // Write line table created by MakeLineTable() for the given compilation unit.
+  // Returns the number of bytes written.
+  size_t WriteLineTable(ElfCompilationUnit& compilation_unit, const std::vector<uint8_t>& buffer) {
+    compilation_unit.debug_line_offset = builder_->GetDebugLine()->GetPosition();
+    builder_->GetDebugLine()->WriteFully(buffer.data(), buffer.size());
+    return buffer.size();
+  }
+
+  // Create line table for given set of methods. The table does not depend on its position
+  // in the section, so tables of several compilation units can be created concurrently.
+  std::vector<uint8_t> MakeLineTable(const ElfCompilationUnit& compilation_unit) const {
     const InstructionSet isa = builder_->GetIsa();
     const bool is64bit = Is64BitInstructionSet(isa);
     const Elf_Addr base_address = compilation_unit.is_code_address_text_relative
         ? builder_->GetText()->GetAddress()
         : 0;
 
-    compilation_unit.debug_line_offset = builder_->GetDebugLine()->GetPosition();
-
     std::vector<dwarf::FileEntry> files;
     std::unordered_map<std::string, size_t> files_map;
     std::vector<std::string> directories;
@@ -262,8 +274,7 @@ class ElfDebugLineWriter {
     std::vector<uint8_t> buffer;
     buffer.reserve(opcodes.data()->size() + KB);
     WriteDebugLineTable(directories, files, opcodes, &buffer);
-    builder_->GetDebugLine()->WriteFully(buffer.data(), buffer.size());
-    return buffer.size();
+    return buffer;
   }
 
   void End() {
@@ -16,6 +16,7 @@
 
 #include "elf_debug_writer.h"
 
+#include <atomic>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -37,6 +38,8 @@
 #include "jit/debugger_interface.h"
 #include "oat.h"
 #include "stream/vector_output_stream.h"
+#include "thread-current-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace debug {
@@ -45,7 +48,8 @@ using ElfRuntimeTypes = std::conditional<sizeof(void*) == 4, ElfTypes32, ElfType
 
 template <typename ElfTypes>
 void WriteDebugInfo(ElfBuilder<ElfTypes>* builder,
-                    const DebugInfo& debug_info) {
+                    const DebugInfo& debug_info,
+                    ThreadPool* thread_pool) {
   // Write .strtab and .symtab.
   WriteDebugSymbols(builder, /* mini-debug-info= */ false, debug_info);
 
@@ -91,11 +95,34 @@ void WriteDebugInfo(ElfBuilder<ElfTypes>* builder,
   // Write .debug_line section.
   if (!compilation_units.empty()) {
     ElfDebugLineWriter<ElfTypes> line_writer(builder);
-    line_writer.Start();
-    for (auto& compilation_unit : compilation_units) {
-      line_writer.WriteCompilationUnit(compilation_unit);
+    if (thread_pool != nullptr && compilation_units.size() > 1) {
+      // Create the line tables in parallel, then write them in compilation unit order.
+      std::vector<std::vector<uint8_t>> line_tables(compilation_units.size());
+      std::atomic<size_t> next_index(0u);
+      auto make_line_tables = [&](Thread*) {
+        for (size_t i = next_index++; i < compilation_units.size(); i = next_index++) {
+          line_tables[i] = line_writer.MakeLineTable(compilation_units[i]);
+        }
+      };
+      Thread* self = Thread::Current();
+      for (size_t i = 0; i != thread_pool->GetThreadCount(); ++i) {
+        thread_pool->AddTask(self, new FunctionTask(make_line_tables));
+      }
+      thread_pool->StartWorkers(self);
+      make_line_tables(self);
+      thread_pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+      line_writer.Start();
+      for (size_t i = 0; i != compilation_units.size(); ++i) {
+        line_writer.WriteLineTable(compilation_units[i], line_tables[i]);
+      }
+      line_writer.End();
+    } else {
+      line_writer.Start();
+      for (auto& compilation_unit : compilation_units) {
+        line_writer.WriteCompilationUnit(compilation_unit);
+      }
+      line_writer.End();
     }
-    line_writer.End();
   }
 
   // Write .debug_info section.
@@ -372,10 +399,12 @@ std::vector<uint8_t> WriteDebugElfFileForClasses(
 // Explicit instantiations
 template void WriteDebugInfo<ElfTypes32>(
     ElfBuilder<ElfTypes32>* builder,
-    const DebugInfo& debug_info);
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool);
 template void WriteDebugInfo<ElfTypes64>(
     ElfBuilder<ElfTypes64>* builder,
-    const DebugInfo& debug_info);
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool);
 
 }  // namespace debug
 }  // namespace art
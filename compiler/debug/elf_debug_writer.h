@@ -29,6 +29,7 @@
 
 namespace art {
 class OatHeader;
+class ThreadPool;
 struct JITCodeEntry;
 namespace mirror {
 class Class;
@@ -36,10 +37,13 @@ class Class;
 namespace debug {
 struct MethodDebugInfo;
 
+// If `thread_pool` is not null, its workers help the calling thread with the parts that can be
+// generated independently. The output does not depend on the number of threads.
 template <typename ElfTypes>
 void WriteDebugInfo(
     ElfBuilder<ElfTypes>* builder,
-    const DebugInfo& debug_info);
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool = nullptr);
 
 std::vector<uint8_t> MakeMiniDebugInfo(
     InstructionSet isa,
@@ -0,0 +1,443 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compiled_method_cache.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "android-base/logging.h"
+#include "android-base/stringprintf.h"
+
+#include "base/array_ref.h"
+#include "base/casts.h"
+#include "base/globals.h"
+#include "base/os.h"
+#include "base/unix_file/fd_file.h"
+#include "base/utils.h"
+#include "compiled_method-inl.h"
+#include "dex/dex_file.h"
+#include "driver/compiled_method_storage.h"
+#include "linker/linker_patch.h"
+
+namespace art {
+
+namespace {  // anonymous namespace
+
+// Bump when the format of the entries changes.
+constexpr uint32_t kEntryMagic = 0x31636d63u;  // "cmc1"
+
+constexpr uint8_t kNoTargetDexFile = 0u;
+constexpr uint8_t kOwnTargetDexFile = 1u;
+
+class EntryWriter {
+ public:
+  void WriteU8(uint8_t value) {
+    data_.push_back(value);
+  }
+
+  void WriteU32(uint32_t value) {
+    for (size_t i = 0; i != sizeof(value); ++i) {
+      data_.push_back(static_cast<uint8_t>(value >> (i * kBitsPerByte)));
+    }
+  }
+
+  void WriteBytes(ArrayRef<const uint8_t> bytes) {
+    WriteU32(dchecked_integral_cast<uint32_t>(bytes.size()));
+    data_.insert(data_.end(), bytes.begin(), bytes.end());
+  }
+
+  void WriteString(const std::string& value) {
+    WriteBytes(ArrayRef<const uint8_t>(reinterpret_cast<const uint8_t*>(value.data()),
+                                       value.size()));
+  }
+
+  const std::vector<uint8_t>& GetData() const {
+    return data_;
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+class EntryReader {
+ public:
+  explicit EntryReader(ArrayRef<const uint8_t> data) : data_(data), pos_(0u), ok_(true) {}
+
+  bool IsOk() const {
+    return ok_;
+  }
+
+  bool IsAtEnd() const {
+    return pos_ == data_.size();
+  }
+
+  uint8_t ReadU8() {
+    if (!Check(1u)) {
+      return 0u;
+    }
+    return data_[pos_++];
+  }
+
+  uint32_t ReadU32() {
+    if (!Check(sizeof(uint32_t))) {
+      return 0u;
+    }
+    uint32_t value = 0u;
+    for (size_t i = 0; i != sizeof(value); ++i) {
+      value |= static_cast<uint32_t>(data_[pos_++]) << (i * kBitsPerByte);
+    }
+    return value;
+  }
+
+  ArrayRef<const uint8_t> ReadBytes() {
+    uint32_t size = ReadU32();
+    if (!Check(size)) {
+      return ArrayRef<const uint8_t>();
+    }
+    ArrayRef<const uint8_t> bytes = data_.SubArray(pos_, size);
+    pos_ += size;
+    return bytes;
+  }
+
+  std::string ReadString() {
+    ArrayRef<const uint8_t> bytes = ReadBytes();
+    return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  }
+
+ private:
+  bool Check(size_t size) {
+    ok_ = ok_ && (data_.size() - pos_ >= size);
+    return ok_;
+  }
+
+  const ArrayRef<const uint8_t> data_;
+  size_t pos_;
+  bool ok_;
+};
+
+// Writes `patch`, or returns false if it targets a dex file other than `dex_file`.
+bool WritePatch(EntryWriter* writer, const linker::LinkerPatch& patch, const DexFile* dex_file) {
+  using Type = linker::LinkerPatch::Type;
+  const DexFile* target_dex_file = nullptr;
+  uint32_t value1 = 0u;
+  uint32_t value2 = 0u;
+  switch (patch.GetType()) {
+    case Type::kIntrinsicReference:
+      value1 = patch.IntrinsicData();
+      value2 = patch.PcInsnOffset();
+      break;
+    case Type::kDataBimgRelRo:
+      value1 = patch.BootImageOffset();
+      value2 = patch.PcInsnOffset();
+      break;
+    case Type::kMethodRelative:
+    case Type::kMethodBssEntry:
+      target_dex_file = patch.TargetMethod().dex_file;
+      value1 = patch.TargetMethod().index;
+      value2 = patch.PcInsnOffset();
+      break;
+    case Type::kCallRelative:
+      target_dex_file = patch.TargetMethod().dex_file;
+      value1 = patch.TargetMethod().index;
+      break;
+    case Type::kTypeRelative:
+    case Type::kTypeBssEntry:
+      target_dex_file = patch.TargetTypeDexFile();
+      value1 = patch.TargetTypeIndex().index_;
+      value2 = patch.PcInsnOffset();
+      break;
+    case Type::kStringRelative:
+    case Type::kStringBssEntry:
+      target_dex_file = patch.TargetStringDexFile();
+      value1 = patch.TargetStringIndex().index_;
+      value2 = patch.PcInsnOffset();
+      break;
+    case Type::kCallEntrypoint:
+      value1 = patch.EntrypointOffset();
+      break;
+    case Type::kBakerReadBarrierBranch:
+      value1 = patch.GetBakerCustomValue1();
+      value2 = patch.GetBakerCustomValue2();
+      break;
+  }
+  const bool has_target_dex_file = (patch.GetType() != Type::kIntrinsicReference &&
+                                    patch.GetType() != Type::kDataBimgRelRo &&
+                                    patch.GetType() != Type::kCallEntrypoint &&
+                                    patch.GetType() != Type::kBakerReadBarrierBranch);
+  if (has_target_dex_file && target_dex_file != dex_file) {
+    return false;
+  }
+  writer->WriteU8(static_cast<uint8_t>(patch.GetType()));
+  writer->WriteU32(dchecked_integral_cast<uint32_t>(patch.LiteralOffset()));
+  writer->WriteU8(has_target_dex_file ? kOwnTargetDexFile : kNoTargetDexFile);
+  writer->WriteU32(value1);
+  writer->WriteU32(value2);
+  return true;
+}
+
+bool ReadPatch(EntryReader* reader, const DexFile* dex_file, /*out*/ linker::LinkerPatch* patch) {
+  using Type = linker::LinkerPatch::Type;
+  using LinkerPatch = linker::LinkerPatch;
+  const Type type = static_cast<Type>(reader->ReadU8());
+  const size_t literal_offset = reader->ReadU32();
+  const uint8_t target = reader->ReadU8();
+  const uint32_t value1 = reader->ReadU32();
+  const uint32_t value2 = reader->ReadU32();
+  if (!reader->IsOk() || (target != kNoTargetDexFile && target != kOwnTargetDexFile)) {
+    return false;
+  }
+  switch (type) {
+    case Type::kIntrinsicReference:
+      *patch = LinkerPatch::IntrinsicReferencePatch(literal_offset, value2, value1);
+      return true;
+    case Type::kDataBimgRelRo:
+      *patch = LinkerPatch::DataBimgRelRoPatch(literal_offset, value2, value1);
+      return true;
+    case Type::kMethodRelative:
+      *patch = LinkerPatch::RelativeMethodPatch(literal_offset, dex_file, value2, value1);
+      return true;
+    case Type::kMethodBssEntry:
+      *patch = LinkerPatch::MethodBssEntryPatch(literal_offset, dex_file, value2, value1);
+      return true;
+    case Type::kCallRelative:
+      *patch = LinkerPatch::RelativeCodePatch(literal_offset, dex_file, value1);
+      return true;
+    case Type::kTypeRelative:
+      *patch = LinkerPatch::RelativeTypePatch(literal_offset, dex_file, value2, value1);
+      return true;
+    case Type::kTypeBssEntry:
+      *patch = LinkerPatch::TypeBssEntryPatch(literal_offset, dex_file, value2, value1);
+      return true;
+    case Type::kStringRelative:
+      *patch = LinkerPatch::RelativeStringPatch(literal_offset, dex_file, value2, value1);
+      return true;
+    case Type::kStringBssEntry:
+      *patch = LinkerPatch::StringBssEntryPatch(literal_offset, dex_file, value2, value1);
+      return true;
+    case Type::kCallEntrypoint:
+      *patch = LinkerPatch::CallEntrypointPatch(literal_offset, value1);
+      return true;
+    case Type::kBakerReadBarrierBranch:
+      *patch = LinkerPatch::BakerReadBarrierBranchPatch(literal_offset, value1, value2);
+      return true;
+  }
+  return false;
+}
+
+// Whether the code generator may have emitted a thunk for `patch`.
+bool MayHaveThunk(const linker::LinkerPatch& patch) {
+  using Type = linker::LinkerPatch::Type;
+  return patch.GetType() == Type::kCallEntrypoint ||
+      patch.GetType() == Type::kBakerReadBarrierBranch ||
+      patch.GetType() == Type::kCallRelative;
+}
+
+// FNV-1a, only used to name the entries; the entries hold their full key.
+uint64_t HashKey(const std::string& key) {
+  uint64_t hash = UINT64_C(0xcbf29ce484222325);
+  for (char c : key) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * UINT64_C(0x100000001b3);
+  }
+  return hash;
+}
+
+}  // anonymous namespace
+
+CompiledMethodCache::CompiledMethodCache(const std::string& directory,
+                                         const std::string& environment)
+    : directory_(directory),
+      environment_(environment),
+      hits_(0u),
+      misses_(0u),
+      stores_(0u) {}
+
+std::string CompiledMethodCache::GetMethodKey(const DexFile& dex_file,
+                                              uint32_t method_idx,
+                                              uint32_t access_flags,
+                                              InvokeType invoke_type) const {
+  // The SHA-1 signature of the dex file covers the code item of the method as well as
+  // every index the code item and its linker patches refer to.
+  std::string key = environment_;
+  key += "\ndex=";
+  for (uint8_t b : dex_file.GetHeader().signature_) {
+    key += android::base::StringPrintf("%02x", b);
+  }
+  key += android::base::StringPrintf("\nmethod=%u\naccess_flags=%x\ninvoke_type=%d",
+                                     method_idx,
+                                     access_flags,
+                                     static_cast<int>(invoke_type));
+  return key;
+}
+
+std::string CompiledMethodCache::GetEntryPath(const std::string& key) const {
+  return android::base::StringPrintf("%s/%016" PRIx64, directory_.c_str(), HashKey(key));
+}
+
+CompiledMethod* CompiledMethodCache::Lookup(CompiledMethodStorage* storage,
+                                            const std::string& key,
+                                            const DexFile* dex_file) {
+  const std::string path = GetEntryPath(key);
+  std::unique_ptr<File> file(OS::OpenFileForReading(path.c_str()));
+  int64_t length = (file != nullptr) ? file->GetLength() : -1;
+  std::vector<uint8_t> data(std::max<int64_t>(length, 0));
+  if (length <= 0 || !file->ReadFully(data.data(), data.size())) {
+    ++misses_;
+    return nullptr;
+  }
+
+  EntryReader reader{ArrayRef<const uint8_t>(data)};
+  if (reader.ReadU32() != kEntryMagic || reader.ReadString() != key) {
+    ++misses_;
+    return nullptr;
+  }
+  const InstructionSet instruction_set = static_cast<InstructionSet>(reader.ReadU32());
+  const bool is_intrinsic = (reader.ReadU8() != 0u);
+  ArrayRef<const uint8_t> code = reader.ReadBytes();
+  ArrayRef<const uint8_t> vmap_table = reader.ReadBytes();
+  ArrayRef<const uint8_t> cfi_info = reader.ReadBytes();
+  const uint32_t num_patches = reader.ReadU32();
+  std::vector<linker::LinkerPatch> patches;
+  for (uint32_t i = 0; reader.IsOk() && i != num_patches; ++i) {
+    linker::LinkerPatch patch = linker::LinkerPatch::CallEntrypointPatch(0u, 0u);
+    if (!ReadPatch(&reader, dex_file, &patch)) {
+      break;
+    }
+    patches.push_back(patch);
+  }
+  const uint32_t num_thunks = reader.ReadU32();
+  struct Thunk {
+    uint32_t patch_index;
+    ArrayRef<const uint8_t> code;
+    std::string debug_name;
+  };
+  std::vector<Thunk> thunks;
+  for (uint32_t i = 0; reader.IsOk() && i != num_thunks; ++i) {
+    uint32_t patch_index = reader.ReadU32();
+    ArrayRef<const uint8_t> thunk_code = reader.ReadBytes();
+    thunks.push_back({patch_index, thunk_code, reader.ReadString()});
+  }
+  if (!reader.IsOk() || !reader.IsAtEnd() || patches.size() != num_patches) {
+    LOG(WARNING) << "Ignoring corrupt compiled method cache entry " << path;
+    ++misses_;
+    return nullptr;
+  }
+
+  // The patches that need thunks only get them from the code generator, which we skip.
+  for (const Thunk& thunk : thunks) {
+    if (thunk.patch_index >= patches.size() || !MayHaveThunk(patches[thunk.patch_index])) {
+      ++misses_;
+      return nullptr;
+    }
+    const linker::LinkerPatch& patch = patches[thunk.patch_index];
+    if (storage->GetThunkCode(patch).empty()) {
+      storage->SetThunkCode(patch, thunk.code, thunk.debug_name);
+    }
+  }
+
+  CompiledMethod* compiled_method = CompiledMethod::SwapAllocCompiledMethod(
+      storage,
+      instruction_set,
+      code,
+      vmap_table,
+      cfi_info,
+      ArrayRef<const linker::LinkerPatch>(patches));
+  if (is_intrinsic) {
+    compiled_method->MarkAsIntrinsic();
+  }
+  ++hits_;
+  return compiled_method;
+}
+
+bool CompiledMethodCache::Store(CompiledMethodStorage* storage,
+                                const std::string& key,
+                                const DexFile* dex_file,
+                                const CompiledMethod* compiled_method) {
+  EntryWriter writer;
+  writer.WriteU32(kEntryMagic);
+  writer.WriteString(key);
+  writer.WriteU32(static_cast<uint32_t>(compiled_method->GetInstructionSet()));
+  writer.WriteU8(compiled_method->IsIntrinsic() ? 1u : 0u);
+  writer.WriteBytes(compiled_method->GetQuickCode());
+  writer.WriteBytes(compiled_method->GetVmapTable());
+  writer.WriteBytes(compiled_method->GetCFIInfo());
+  ArrayRef<const linker::LinkerPatch> patches = compiled_method->GetPatches();
+  writer.WriteU32(dchecked_integral_cast<uint32_t>(patches.size()));
+  for (const linker::LinkerPatch& patch : patches) {
+    if (!WritePatch(&writer, patch, dex_file)) {
+      return false;
+    }
+  }
+  EntryWriter thunk_writer;
+  uint32_t num_thunks = 0u;
+  for (size_t i = 0; i != patches.size(); ++i) {
+    if (!MayHaveThunk(patches[i])) {
+      continue;
+    }
+    std::string debug_name;
+    ArrayRef<const uint8_t> thunk_code = storage->GetThunkCode(patches[i], &debug_name);
+    if (!thunk_code.empty()) {
+      thunk_writer.WriteU32(dchecked_integral_cast<uint32_t>(i));
+      thunk_writer.WriteBytes(thunk_code);
+      thunk_writer.WriteString(debug_name);
+      ++num_thunks;
+    }
+  }
+  writer.WriteU32(num_thunks);
+  const std::vector<uint8_t>& data = writer.GetData();
+  const std::vector<uint8_t>& thunk_data = thunk_writer.GetData();
+
+  // Write to a file of our own and rename it into place, for the other processes.
+  const std::string path = GetEntryPath(key);
+  const std::string temp_path =
+      android::base::StringPrintf("%s.%d.%d.tmp", path.c_str(), getpid(), GetTid());
+  std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(temp_path.c_str()));
+  if (file == nullptr) {
+    PLOG(WARNING) << "Could not create compiled method cache entry " << temp_path;
+    return false;
+  }
+  if (!file->WriteFully(data.data(), data.size()) ||
+      !file->WriteFully(thunk_data.data(), thunk_data.size())) {
+    PLOG(WARNING) << "Could not write compiled method cache entry " << temp_path;
+    file->Erase(/*unlink=*/ true);
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    PLOG(WARNING) << "Could not close compiled method cache entry " << temp_path;
+    unlink(temp_path.c_str());
+    return false;
+  }
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    PLOG(WARNING) << "Could not rename compiled method cache entry " << temp_path;
+    unlink(temp_path.c_str());
+    return false;
+  }
+  ++stores_;
+  return true;
+}
+
+void CompiledMethodCache::Dump(std::ostream& os) const {
+  os << "Compiled method cache " << directory_ << ": " << hits_.load() << " hits, "
+     << misses_.load() << " misses, " << stores_.load() << " stores";
+}
+
+}  // namespace art
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_COMPILED_METHOD_CACHE_H_
+#define ART_COMPILER_DRIVER_COMPILED_METHOD_CACHE_H_
+
+#include <atomic>
+#include <iosfwd>
+#include <string>
+
+#include "base/macros.h"
+#include "dex/invoke_type.h"
+
+namespace art {
+
+class CompiledMethod;
+class CompiledMethodStorage;
+class DexFile;
+
+/**
+ * On-disk cache of compiled methods, shared by the dex2oat processes pointed at the same
+ * directory, so that compiling the same inputs again does not run the compiler again.
+ *
+ * The code of a method depends on much more than its bytecode: on how its references
+ * resolve, on the class loader and the boot image, on the profile and on the compiler
+ * options. All of that is folded into the `environment` given by the caller, and each entry
+ * holds its full key, so that a hash collision is a miss rather than wrong code.
+ *
+ * Entries are written to a temporary file and renamed into place, so concurrent readers
+ * see either a complete entry or none.
+ */
+class CompiledMethodCache {
+ public:
+  CompiledMethodCache(const std::string& directory, const std::string& environment);
+
+  // Returns the key of the method in this cache's environment.
+  std::string GetMethodKey(const DexFile& dex_file,
+                           uint32_t method_idx,
+                           uint32_t access_flags,
+                           InvokeType invoke_type) const;
+
+  // Returns the method cached for `key`, allocated in `storage`, or null. `dex_file` is the
+  // dex file of the method, the target of the linker patches of the cached code.
+  CompiledMethod* Lookup(CompiledMethodStorage* storage,
+                         const std::string& key,
+                         const DexFile* dex_file);
+
+  // Caches `compiled_method` for `key`. Methods with linker patches into dex files other than
+  // `dex_file` are not cached. Returns whether the method was cached.
+  bool Store(CompiledMethodStorage* storage,
+             const std::string& key,
+             const DexFile* dex_file,
+             const CompiledMethod* compiled_method);
+
+  void Dump(std::ostream& os) const;
+
+ private:
+  std::string GetEntryPath(const std::string& key) const;
+
+  const std::string directory_;
+  const std::string environment_;
+
+  std::atomic<size_t> hits_;
+  std::atomic<size_t> misses_;
+  std::atomic<size_t> stores_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompiledMethodCache);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_COMPILED_METHOD_CACHE_H_
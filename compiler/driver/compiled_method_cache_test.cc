@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compiled_method_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "base/common_art_test.h"
+#include "compiled_method-inl.h"
+#include "compiled_method_storage.h"
+#include "linker/linker_patch.h"
+
+namespace art {
+
+class CompiledMethodCacheTest : public CommonArtTest {
+ protected:
+  CompiledMethod* CreateCompiledMethod(CompiledMethodStorage* storage) {
+    const uint8_t raw_code[] = { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u };
+    const uint8_t raw_vmap_table[] = { 2u, 4u, 6u };
+    const uint8_t raw_cfi_info[] = { 1u, 3u, 5u };
+    const linker::LinkerPatch raw_patches[] = {
+        linker::LinkerPatch::IntrinsicReferencePatch(0u, 0u, 7u),
+        linker::LinkerPatch::RelativeMethodPatch(4u, /* target_dex_file= */ nullptr, 0u, 1u),
+        linker::LinkerPatch::BakerReadBarrierBranchPatch(4u, 3u, 5u),
+    };
+    return CompiledMethod::SwapAllocCompiledMethod(
+        storage,
+        InstructionSet::kArm64,
+        ArrayRef<const uint8_t>(raw_code),
+        ArrayRef<const uint8_t>(raw_vmap_table),
+        ArrayRef<const uint8_t>(raw_cfi_info),
+        ArrayRef<const linker::LinkerPatch>(raw_patches));
+  }
+};
+
+TEST_F(CompiledMethodCacheTest, StoreAndLookup) {
+  ScratchDir cache_dir;
+  CompiledMethodStorage storage(/* swap_fd= */ -1);
+  CompiledMethod* compiled_method = CreateCompiledMethod(&storage);
+  const uint8_t raw_thunk[] = { 9u, 9u };
+  storage.SetThunkCode(compiled_method->GetPatches()[2], ArrayRef<const uint8_t>(raw_thunk), "t");
+
+  CompiledMethodCache cache(cache_dir.GetPath(), "environment");
+  EXPECT_EQ(cache.Lookup(&storage, "key", /* dex_file= */ nullptr), nullptr);
+  ASSERT_TRUE(cache.Store(&storage, "key", /* dex_file= */ nullptr, compiled_method));
+
+  // Another process, with its own storage, finds the method and the thunk it needs.
+  CompiledMethodStorage other_storage(/* swap_fd= */ -1);
+  CompiledMethodCache other_cache(cache_dir.GetPath(), "environment");
+  CompiledMethod* cached_method = other_cache.Lookup(&other_storage, "key", nullptr);
+  ASSERT_NE(cached_method, nullptr);
+  EXPECT_EQ(cached_method->GetInstructionSet(), compiled_method->GetInstructionSet());
+  EXPECT_EQ(cached_method->GetQuickCode(), compiled_method->GetQuickCode());
+  EXPECT_EQ(cached_method->GetVmapTable(), compiled_method->GetVmapTable());
+  EXPECT_EQ(cached_method->GetCFIInfo(), compiled_method->GetCFIInfo());
+  EXPECT_EQ(cached_method->GetPatches(), compiled_method->GetPatches());
+  std::string debug_name;
+  EXPECT_EQ(other_storage.GetThunkCode(cached_method->GetPatches()[2], &debug_name),
+            ArrayRef<const uint8_t>(raw_thunk));
+  EXPECT_EQ(debug_name, "t");
+  EXPECT_EQ(other_cache.Lookup(&other_storage, "other key", nullptr), nullptr);
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&other_storage, cached_method);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, compiled_method);
+}
+
+TEST_F(CompiledMethodCacheTest, DoesNotStorePatchesIntoOtherDexFiles) {
+  ScratchDir cache_dir;
+  CompiledMethodStorage storage(/* swap_fd= */ -1);
+  CompiledMethod* compiled_method = CreateCompiledMethod(&storage);
+
+  // The relative method patch of the method targets the null dex file.
+  const DexFile* other_dex_file = reinterpret_cast<const DexFile*>(&storage);
+  CompiledMethodCache cache(cache_dir.GetPath(), "environment");
+  EXPECT_FALSE(cache.Store(&storage, "key", other_dex_file, compiled_method));
+  EXPECT_EQ(cache.Lookup(&storage, "key", other_dex_file), nullptr);
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, compiled_method);
+}
+
+}  // namespace art
@@ -24,6 +24,7 @@
 #include "base/data_hash.h"
 #include "base/utils.h"
 #include "compiled_method.h"
+#include "compiled_method_cache.h"
 #include "linker/linker_patch.h"
 #include "thread-current-inl.h"
 #include "utils/dedupe_set-inl.h"
@@ -172,6 +173,23 @@ void CompiledMethodStorage::DumpMemoryUsage(std::ostream& os, bool extended) con
     os << "\nVmap table dedupe: " << dedupe_vmap_table_.DumpStats(self);
     os << "\nCFI info dedupe: " << dedupe_cfi_info_.DumpStats(self);
   }
+  if (compiled_method_cache_ != nullptr) {
+    os << "\n";
+    compiled_method_cache_->Dump(os);
+  }
+}
+
+void CompiledMethodStorage::ReleaseDeduplicatedArrays() {
+  Thread* self = Thread::Current();
+  dedupe_code_.Clear(self);
+  dedupe_vmap_table_.Clear(self);
+  dedupe_cfi_info_.Clear(self);
+  dedupe_linker_patches_.Clear(self);
+}
+
+void CompiledMethodStorage::SetCompiledMethodCache(
+    std::unique_ptr<CompiledMethodCache> compiled_method_cache) {
+  compiled_method_cache_ = std::move(compiled_method_cache);
 }
 
 const LengthPrefixedArray<uint8_t>* CompiledMethodStorage::DeduplicateCode(
@@ -29,6 +29,8 @@
 
 namespace art {
 
+class CompiledMethodCache;
+
 namespace linker {
 class LinkerPatch;
 }  // namespace linker
@@ -47,10 +49,20 @@ class CompiledMethodStorage {
     return dedupe_enabled_;
   }
 
+  // The on-disk cache of compiled methods, if any.
+  void SetCompiledMethodCache(std::unique_ptr<CompiledMethodCache> compiled_method_cache);
+  CompiledMethodCache* GetCompiledMethodCache() const {
+    return compiled_method_cache_.get();
+  }
+
   SwapAllocator<void> GetSwapSpaceAllocator() {
     return SwapAllocator<void>(swap_space_.get());
   }
 
+  // Frees the deduplicated code, vmap tables, CFI and linker patches. All the compiled methods
+  // must have been released.
+  void ReleaseDeduplicatedArrays();
+
   const LengthPrefixedArray<uint8_t>* DeduplicateCode(const ArrayRef<const uint8_t>& code);
   void ReleaseCode(const LengthPrefixedArray<uint8_t>* code);
 
@@ -120,6 +132,8 @@ class CompiledMethodStorage {
   ArrayDedupeSet<uint8_t> dedupe_cfi_info_;
   ArrayDedupeSet<linker::LinkerPatch> dedupe_linker_patches_;
 
+  std::unique_ptr<CompiledMethodCache> compiled_method_cache_;
+
   Mutex thunk_map_lock_;
   ThunkMap thunk_map_ GUARDED_BY(thunk_map_lock_);
 
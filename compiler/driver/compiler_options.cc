@@ -17,6 +17,7 @@
 #include "compiler_options.h"
 
 #include <fstream>
+#include <sstream>
 #include <string_view>
 
 #include "android-base/stringprintf.h"
@@ -64,6 +65,7 @@ CompilerOptions::CompilerOptions()
       dump_timings_(false),
       dump_pass_timings_(false),
       dump_stats_(false),
+      dump_method_stats_file_name_(""),
       top_k_profile_threshold_(kDefaultTopKProfileThreshold),
       profile_compilation_info_(nullptr),
       verbose_methods_(),
@@ -75,11 +77,15 @@ CompilerOptions::CompilerOptions()
       force_determinism_(false),
       deduplicate_code_(true),
       count_hotness_in_compiled_code_(false),
+      profile_branches_(false),
       resolve_startup_const_strings_(false),
       initialize_app_image_classes_(false),
+      initialize_startup_app_image_classes_(false),
       check_profiled_methods_(ProfileMethodsCheck::kNone),
       max_image_block_size_(std::numeric_limits<uint32_t>::max()),
       register_allocation_strategy_(RegisterAllocator::kRegisterAllocatorDefault),
+      graph_color_for_hot_methods_only_(false),
+      graph_color_max_ssa_values_(kDefaultGraphColorMaxSsaValues),
       passes_to_run_(nullptr) {
 }
 
@@ -116,12 +122,17 @@ bool CompilerOptions::ParseDumpInitFailures(const std::string& option, std::stri
 
 bool CompilerOptions::ParseRegisterAllocationStrategy(const std::string& option,
                                                       std::string* error_msg) {
+  graph_color_for_hot_methods_only_ = false;
   if (option == "linear-scan") {
     register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorLinearScan;
   } else if (option == "graph-color") {
     register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorGraphColor;
+  } else if (option == "graph-color-hot") {
+    register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorGraphColor;
+    graph_color_for_hot_methods_only_ = true;
   } else {
-    *error_msg = "Unrecognized register allocation strategy. Try linear-scan, or graph-color.";
+    *error_msg = "Unrecognized register allocation strategy. "
+        "Try linear-scan, graph-color, or graph-color-hot.";
     return false;
   }
   return true;
@@ -184,6 +195,45 @@ bool CompilerOptions::IsMethodVerifiedWithoutFailures(uint32_t method_idx,
   return is_system_class;
 }
 
+std::string CompilerOptions::GetCodeGenerationFingerprint() const {
+  std::ostringstream oss;
+  oss << "filter=" << CompilerFilter::NameOfFilter(compiler_filter_)
+      << "\nisa=" << instruction_set_
+      << "\nisa_features=" << instruction_set_features_->GetFeatureString()
+      << "\nhuge_method_threshold=" << huge_method_threshold_
+      << "\nlarge_method_threshold=" << large_method_threshold_
+      << "\nnum_dex_methods_threshold=" << num_dex_methods_threshold_
+      << "\ninline_max_code_units=" << inline_max_code_units_
+      << "\ntop_k_profile_threshold=" << top_k_profile_threshold_
+      << "\nimage_type=" << static_cast<int>(image_type_)
+      << "\ncore_image=" << compiling_with_core_image_
+      << "\nbaseline=" << baseline_
+      << "\ndebuggable=" << debuggable_
+      << "\ndebug_info=" << generate_debug_info_
+      << "\nmini_debug_info=" << generate_mini_debug_info_
+      << "\nimplicit_checks=" << implicit_null_checks_ << implicit_so_checks_
+      << implicit_suspend_checks_
+      << "\npic=" << compile_pic_
+      << "\ncount_hotness=" << count_hotness_in_compiled_code_
+      << "\nprofile_branches=" << profile_branches_
+      << "\nresolve_startup_const_strings=" << resolve_startup_const_strings_
+      << "\nregister_allocation=" << static_cast<int>(register_allocation_strategy_)
+      << "\ngraph_color_hot_only=" << graph_color_for_hot_methods_only_
+      << "\ngraph_color_max_ssa_values=" << graph_color_max_ssa_values_
+      << "\nruntime_checks=" << EmitRunTimeChecksInDebugMode();
+  oss << "\nno_inline_from=";
+  for (const DexFile* dex_file : no_inline_from_) {
+    oss << dex_file->GetLocation() << ":";
+  }
+  oss << "\npasses=";
+  if (passes_to_run_ != nullptr) {
+    for (const std::string& pass : *passes_to_run_) {
+      oss << pass << ":";
+    }
+  }
+  return oss.str();
+}
+
 bool CompilerOptions::IsCoreImageFilename(const std::string& boot_image_filename) {
   std::string_view filename(boot_image_filename);
   size_t colon_pos = filename.find(':');
@@ -67,6 +67,7 @@ class CompilerOptions final {
   static const bool kDefaultGenerateDebugInfo = false;
   static const bool kDefaultGenerateMiniDebugInfo = false;
   static const size_t kDefaultInlineMaxCodeUnits = 32;
+  static const size_t kDefaultGraphColorMaxSsaValues = 4096;
   static constexpr size_t kUnsetInlineMaxCodeUnits = -1;
 
   enum class ImageType : uint8_t {
@@ -319,6 +320,18 @@ class CompilerOptions final {
     return register_allocation_strategy_;
   }
 
+  // Whether graph coloring register allocation is only used for the methods that are hot
+  // in the profile, linear scan being used for the other methods and for JIT compilation.
+  bool IsGraphColorForHotMethodsOnly() const {
+    return graph_color_for_hot_methods_only_;
+  }
+
+  // Maximum number of SSA values of a method allocated by graph coloring. Larger methods are
+  // allocated by linear scan, to bound the size of the interference graph.
+  size_t GetGraphColorMaxSsaValues() const {
+    return graph_color_max_ssa_values_;
+  }
+
   const std::vector<std::string>* GetPassesToRun() const {
     return passes_to_run_;
   }
@@ -335,10 +348,19 @@ class CompilerOptions final {
     return dump_stats_;
   }
 
+  // File to which the statistics of each compiled method are appended, as JSON lines.
+  const std::string& GetDumpMethodStatsFileName() const {
+    return dump_method_stats_file_name_;
+  }
+
   bool CountHotnessInCompiledCode() const {
     return count_hotness_in_compiled_code_;
   }
 
+  bool ProfileBranches() const {
+    return profile_branches_;
+  }
+
   bool ResolveStartupConstStrings() const {
     return resolve_startup_const_strings_;
   }
@@ -359,10 +381,18 @@ class CompilerOptions final {
     return initialize_app_image_classes_;
   }
 
+  bool InitializeStartupAppImageClasses() const {
+    return initialize_startup_app_image_classes_;
+  }
+
   // Is `boot_image_filename` the name of a core image (small boot
   // image used for ART testing only)?
   static bool IsCoreImageFilename(const std::string& boot_image_filename);
 
+  // Describes the options that the generated code depends on. Options that change the
+  // generated code must be added there, or the compiled method cache returns stale code.
+  std::string GetCodeGenerationFingerprint() const;
+
  private:
   bool ParseDumpInitFailures(const std::string& option, std::string* error_msg);
   bool ParseRegisterAllocationStrategy(const std::string& option, std::string* error_msg);
@@ -405,6 +435,7 @@ class CompilerOptions final {
   bool dump_timings_;
   bool dump_pass_timings_;
   bool dump_stats_;
+  std::string dump_method_stats_file_name_;
 
   // When using a profile file only the top K% of the profiled samples will be compiled.
   double top_k_profile_threshold_;
@@ -438,6 +469,10 @@ class CompilerOptions final {
   // won't be atomic for performance reasons, so we accept races, just like in interpreter.
   bool count_hotness_in_compiled_code_;
 
+  // Whether baseline JIT code should count the taken and not taken conditional branches into the
+  // ProfilingInfo, so that optimized code can use them.
+  bool profile_branches_;
+
   // Whether we eagerly resolve all of the const strings that are loaded from startup methods in the
   // profile.
   bool resolve_startup_const_strings_;
@@ -445,6 +480,10 @@ class CompilerOptions final {
   // Whether we attempt to run class initializers for app image classes.
   bool initialize_app_image_classes_;
 
+  // Whether we attempt to run class initializers for app image classes whose class initializer
+  // the profile marks as run during startup.
+  bool initialize_startup_app_image_classes_;
+
   // When running profile-guided compilation, check that methods intended to be compiled end
   // up compiled and are not punted.
   ProfileMethodsCheck check_profiled_methods_;
@@ -453,6 +492,8 @@ class CompilerOptions final {
   uint32_t max_image_block_size_;
 
   RegisterAllocator::Strategy register_allocation_strategy_;
+  bool graph_color_for_hot_methods_only_;
+  size_t graph_color_max_ssa_values_;
 
   // If not null, specifies optimization passes which will be run instead of defaults.
   // Note that passes_to_run_ is not checked for correctness and providing an incorrect
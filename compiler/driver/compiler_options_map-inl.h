@@ -69,17 +69,25 @@ inline bool ReadCompilerOptions(Base& map, CompilerOptions* options, std::string
     options->dump_cfg_append_ = true;
   }
   if (map.Exists(Base::RegisterAllocationStrategy)) {
-    if (!options->ParseRegisterAllocationStrategy(*map.Get(Base::DumpInitFailures), error_msg)) {
+    if (!options->ParseRegisterAllocationStrategy(*map.Get(Base::RegisterAllocationStrategy),
+                                                  error_msg)) {
       return false;
     }
   }
+  map.AssignIfExists(Base::RegisterAllocationGraphColorMaxSsaValues,
+                     &options->graph_color_max_ssa_values_);
   map.AssignIfExists(Base::VerboseMethods, &options->verbose_methods_);
   options->deduplicate_code_ = map.GetOrDefault(Base::DeduplicateCode);
   if (map.Exists(Base::CountHotnessInCompiledCode)) {
     options->count_hotness_in_compiled_code_ = true;
   }
+  if (map.Exists(Base::ProfileBranches)) {
+    options->profile_branches_ = true;
+  }
   map.AssignIfExists(Base::ResolveStartupConstStrings, &options->resolve_startup_const_strings_);
   map.AssignIfExists(Base::InitializeAppImageClasses, &options->initialize_app_image_classes_);
+  map.AssignIfExists(Base::InitializeStartupAppImageClasses,
+                     &options->initialize_startup_app_image_classes_);
   if (map.Exists(Base::CheckProfiledMethods)) {
     options->check_profiled_methods_ = *map.Get(Base::CheckProfiledMethods);
   }
@@ -97,6 +105,8 @@ inline bool ReadCompilerOptions(Base& map, CompilerOptions* options, std::string
     options->dump_stats_ = true;
   }
 
+  map.AssignIfExists(Base::DumpMethodStats, &options->dump_method_stats_file_name_);
+
   return true;
 }
 
@@ -142,6 +152,9 @@ inline void AddCompilerOptionsArgumentParserOptions(Builder& b) {
       .Define({"--count-hotness-in-compiled-code"})
           .IntoKey(Map::CountHotnessInCompiledCode)
 
+      .Define({"--profile-branches"})
+          .IntoKey(Map::ProfileBranches)
+
       .Define({"--check-profiled-methods=_"})
           .template WithType<ProfileMethodsCheck>()
           .WithValueMap({{"log", ProfileMethodsCheck::kLog},
@@ -157,6 +170,10 @@ inline void AddCompilerOptionsArgumentParserOptions(Builder& b) {
       .Define({"--dump-stats"})
           .IntoKey(Map::DumpStats)
 
+      .Define("--dump-method-stats=_")
+          .template WithType<std::string>()
+          .IntoKey(Map::DumpMethodStats)
+
       .Define("--debuggable")
           .IntoKey(Map::Debuggable)
 
@@ -187,6 +204,9 @@ inline void AddCompilerOptionsArgumentParserOptions(Builder& b) {
       .Define("--register-allocation-strategy=_")
           .template WithType<std::string>()
           .IntoKey(Map::RegisterAllocationStrategy)
+      .Define("--register-allocation-graph-color-max-ssa-values=_")
+          .template WithType<unsigned int>()
+          .IntoKey(Map::RegisterAllocationGraphColorMaxSsaValues)
 
       .Define("--resolve-startup-const-strings=_")
           .template WithType<bool>()
@@ -198,6 +218,11 @@ inline void AddCompilerOptionsArgumentParserOptions(Builder& b) {
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(Map::InitializeAppImageClasses)
 
+      .Define("--initialize-startup-app-image-classes=_")
+          .template WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(Map::InitializeStartupAppImageClasses)
+
       .Define("--verbose-methods=_")
           .template WithType<ParseStringList<','>>()
           .IntoKey(Map::VerboseMethods)
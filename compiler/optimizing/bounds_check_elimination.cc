@@ -16,13 +16,19 @@
 
 #include "bounds_check_elimination.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "base/scoped_arena_allocator.h"
 #include "base/scoped_arena_containers.h"
+#include "dex/method_reference.h"
+#include "driver/compiler_options.h"
 #include "induction_var_range.h"
 #include "nodes.h"
+#include "optimizing_compiler_stats.h"
+#include "profile/profile_compilation_info.h"
 #include "side_effects_analysis.h"
+#include "superblock_cloner.h"
 
 namespace art {
 
@@ -1940,6 +1946,265 @@ class BCEVisitor : public HGraphVisitor {
   DISALLOW_COPY_AND_ASSIGN(BCEVisitor);
 };
 
+/**
+ * Versions the hot loops whose bounds checks remain after BCEVisitor, i.e. the loops where
+ * deoptimization could not be used. A single test before the loop compares the ranges of
+ * the indices with the lengths of the arrays: when it holds, the original loop runs without
+ * the bounds checks; otherwise, a copy of the loop that keeps them runs instead.
+ *
+ *           preheader: if (ranges are in bounds)
+ *            /                              \
+ *   loop (no bounds checks)       copy of the loop (bounds checks)
+ *            \                              /
+ *                         exit
+ */
+class BCELoopVersioning : public ValueObject {
+ public:
+  BCELoopVersioning(HGraph* graph,
+                    HInductionVarAnalysis* induction_analysis,
+                    const CompilerOptions* compiler_options,
+                    OptimizingCompilerStats* stats)
+      : graph_(graph),
+        induction_range_(induction_analysis),
+        compiler_options_(compiler_options),
+        stats_(stats) {}
+
+  void Run() {
+    // OSR enters the original loops at their headers, bypassing the guard.
+    if (graph_->IsCompilingOsr() || graph_->HasIrreducibleLoops() || graph_->HasTryCatch()) {
+      return;
+    }
+
+    // Local allocator to discard data structures created below at the end of this optimization.
+    ScopedArenaAllocator allocator(graph_->GetArenaStack());
+
+    // Collect the loops first, versioning adds new ones.
+    ScopedArenaVector<HLoopInformation*> loops(
+        allocator.Adapter(kArenaAllocBoundsCheckElimination));
+    for (HBasicBlock* block : graph_->GetPostOrder()) {
+      if (block->IsLoopHeader()) {
+        loops.push_back(block->GetLoopInformation());
+      }
+    }
+    for (HLoopInformation* loop : loops) {
+      TryVersionLoop(loop, &allocator);
+    }
+  }
+
+ private:
+  // Versioning doubles the code of the loop, so only small loops are versioned.
+  static constexpr size_t kMaxInstructionsInVersionedLoop = 64;
+  // Minimum number of iterations in the branch profile for a loop to be considered hot.
+  static constexpr uint16_t kMinIterationsForVersioning = 1000;
+
+  static HInstruction* GetArray(HInstruction* length) {
+    HInstruction* array = length->InputAt(0);
+    return array->IsNullCheck() ? array->InputAt(0) : array;
+  }
+
+  // Returns whether the loop is worth versioning: either one of its branches stayed in the
+  // loop often enough, or the whole method is hot in the profile.
+  bool IsHotLoop(HLoopInformation* loop) const {
+    for (HBlocksInLoopIterator it(*loop); !it.Done(); it.Advance()) {
+      HInstruction* last = it.Current()->GetLastInstruction();
+      if (!last->IsIf() || !last->AsIf()->HasBranchProfile()) {
+        continue;
+      }
+      HIf* branch = last->AsIf();
+      bool true_in_loop = loop->Contains(*branch->IfTrueSuccessor());
+      bool false_in_loop = loop->Contains(*branch->IfFalseSuccessor());
+      if (true_in_loop != false_in_loop) {
+        uint16_t count = true_in_loop ? branch->GetTrueCount() : branch->GetFalseCount();
+        if (count >= kMinIterationsForVersioning) {
+          return true;
+        }
+      }
+    }
+    const ProfileCompilationInfo* profile =
+        compiler_options_ != nullptr ? compiler_options_->GetProfileCompilationInfo() : nullptr;
+    return profile != nullptr &&
+        profile->GetMethodHotness(
+            MethodReference(&graph_->GetDexFile(), graph_->GetMethodIdx())).IsHot();
+  }
+
+  // Returns whether the guard before `loop` can cover `bounds_check`.
+  bool CanVersionBoundsCheck(HLoopInformation* loop,
+                             HBoundsCheck* bounds_check,
+                             /*inout*/ bool* needs_taken_test) {
+    HInstruction* index = bounds_check->InputAt(0);
+    HInstruction* length = bounds_check->InputAt(1);
+    if (!loop->IsDefinedOutOfTheLoop(length) &&
+        !(length->IsArrayLength() && loop->IsDefinedOutOfTheLoop(GetArray(length)))) {
+      return false;
+    }
+    bool needs_finite_test = false;
+    bool needs_taken = false;
+    if (!induction_range_.CanGenerateRange(bounds_check, index, &needs_finite_test, &needs_taken) ||
+        needs_finite_test) {
+      // The range of an infinite loop does not bound the index.
+      return false;
+    }
+    *needs_taken_test = *needs_taken_test || needs_taken;
+    return true;
+  }
+
+  HInstruction* Insert(HBasicBlock* block, HInstruction* instruction) {
+    block->InsertInstructionBefore(instruction, block->GetLastInstruction());
+    return instruction;
+  }
+
+  HInstruction* InsertAnd(HBasicBlock* block, HInstruction* left, HInstruction* right) {
+    return left == nullptr
+        ? right
+        : Insert(block, new (graph_->GetAllocator()) HAnd(DataType::Type::kInt32, left, right));
+  }
+
+  void TryVersionLoop(HLoopInformation* loop, ScopedArenaAllocator* allocator) {
+    HBasicBlock* header = loop->GetHeader();
+    if (loop->IsIrreducible() || !IsHotLoop(loop)) {
+      return;
+    }
+
+    // Only version small innermost loops, and collect their bounds checks.
+    ScopedArenaVector<HBoundsCheck*> bounds_checks(
+        allocator->Adapter(kArenaAllocBoundsCheckElimination));
+    size_t number_of_instructions = 0;
+    bool needs_taken_test = false;
+    for (HBlocksInLoopIterator it_loop(*loop); !it_loop.Done(); it_loop.Advance()) {
+      HBasicBlock* block = it_loop.Current();
+      if (block->IsLoopHeader() && block != header) {
+        return;
+      }
+      for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+        ++number_of_instructions;
+        if (it.Current()->IsBoundsCheck() &&
+            CanVersionBoundsCheck(loop, it.Current()->AsBoundsCheck(), &needs_taken_test)) {
+          bounds_checks.push_back(it.Current()->AsBoundsCheck());
+        }
+      }
+    }
+    if (bounds_checks.empty() ||
+        number_of_instructions > kMaxInstructionsInVersionedLoop ||
+        !PeelUnrollHelper::IsLoopClonable(loop)) {
+      return;
+    }
+
+    // The lengths loaded in the loop are loaded again by the guard, where the arrays may
+    // still be null; a null array selects the copy of the loop that throws.
+    ScopedArenaVector<HInstruction*> nullable_arrays(
+        allocator->Adapter(kArenaAllocBoundsCheckElimination));
+    for (HBoundsCheck* bounds_check : bounds_checks) {
+      HInstruction* length = bounds_check->InputAt(1);
+      if (!loop->IsDefinedOutOfTheLoop(length)) {
+        HInstruction* array = GetArray(length);
+        if (array->CanBeNull() &&
+            std::find(nullable_arrays.begin(), nullable_arrays.end(), array) ==
+                nullable_arrays.end()) {
+          nullable_arrays.push_back(array);
+        }
+      }
+    }
+
+    // Generate the top test structure when the ranges may only be evaluated after testing
+    // that the loop is taken and that the arrays are not null.
+    ArenaAllocator* graph_allocator = graph_->GetAllocator();
+    HBasicBlock* guard_block = loop->GetPreHeader();
+    if (needs_taken_test || !nullable_arrays.empty()) {
+      graph_->TransformLoopHeaderForBCE(header);
+      HBasicBlock* new_preheader = loop->GetPreHeader();
+      HBasicBlock* if_block = new_preheader->GetDominator();
+      HBasicBlock* true_block = if_block->GetSuccessors()[0];  // True successor.
+      HBasicBlock* false_block = if_block->GetSuccessors()[1];  // False successor.
+      true_block->AddInstruction(new (graph_allocator) HGoto());
+      false_block->AddInstruction(new (graph_allocator) HGoto());
+      new_preheader->AddInstruction(new (graph_allocator) HGoto());
+      if_block->AddInstruction(new (graph_allocator) HGoto());  // placeholder
+      HInstruction* condition = needs_taken_test
+          ? induction_range_.GenerateTakenTest(header->GetLastInstruction(), graph_, if_block)
+          : nullptr;
+      for (HInstruction* array : nullable_arrays) {
+        HInstruction* not_null =
+            Insert(if_block, new (graph_allocator) HNotEqual(array, graph_->GetNullConstant()));
+        condition = InsertAnd(if_block, condition, not_null);
+      }
+      DCHECK(condition != nullptr);
+      if_block->ReplaceAndRemoveInstructionWith(if_block->GetLastInstruction(),
+                                                new (graph_allocator) HIf(condition));
+      guard_block = true_block;
+    }
+
+    // Generate the guard: every index range is within [0, length).
+    ScopedArenaSafeMap<HInstruction*, HInstruction*> guard_lengths(
+        std::less<HInstruction*>(), allocator->Adapter(kArenaAllocBoundsCheckElimination));
+    HInstruction* in_bounds = nullptr;
+    for (HBoundsCheck* bounds_check : bounds_checks) {
+      HInstruction* length = bounds_check->InputAt(1);
+      if (!loop->IsDefinedOutOfTheLoop(length)) {
+        HInstruction* array = GetArray(length);
+        auto it = guard_lengths.find(array);
+        if (it == guard_lengths.end()) {
+          HInstruction* guard_length = Insert(guard_block, new (graph_allocator) HArrayLength(
+              array, length->GetDexPc(), length->AsArrayLength()->IsStringLength()));
+          it = guard_lengths.Put(array, guard_length);
+        }
+        length = it->second;
+      }
+      HInstruction* lower = nullptr;
+      HInstruction* upper = nullptr;
+      induction_range_.GenerateRange(
+          bounds_check, bounds_check->InputAt(0), graph_, guard_block, &lower, &upper);
+      DCHECK(upper != nullptr);
+      // An unsigned comparison also rules out a negative upper bound.
+      in_bounds = InsertAnd(
+          guard_block, in_bounds, Insert(guard_block, new (graph_allocator) HBelow(upper, length)));
+      if (lower != nullptr) {
+        // A lower bound above the upper one denotes an arithmetic wrap-around.
+        HInstruction* zero = graph_->GetIntConstant(0);
+        in_bounds = InsertAnd(
+            guard_block,
+            in_bounds,
+            Insert(guard_block, new (graph_allocator) HGreaterThanOrEqual(lower, zero)));
+        in_bounds = InsertAnd(
+            guard_block,
+            in_bounds,
+            Insert(guard_block, new (graph_allocator) HLessThanOrEqual(lower, upper)));
+      }
+    }
+
+    // Branch on the guard in the preheader.
+    HBasicBlock* preheader = loop->GetPreHeader();
+    if (guard_block != preheader) {
+      // Skipping the guard selects the copy of the loop.
+      HPhi* phi = new (graph_allocator) HPhi(
+          graph_allocator, kNoRegNumber, /* number_of_inputs= */ 0, DataType::Type::kInt32);
+      preheader->AddPhi(phi);
+      phi->AddInput(in_bounds);  // From the true block.
+      phi->AddInput(graph_->GetIntConstant(0));  // From the false block.
+      in_bounds = phi;
+    }
+    preheader->ReplaceAndRemoveInstructionWith(preheader->GetLastInstruction(),
+                                               new (graph_allocator) HIf(in_bounds));
+
+    // The copy of the loop keeps the bounds checks; remove them from the original loop.
+    PeelUnrollSimpleHelper helper(loop, &induction_range_);
+    HBasicBlock* copy_header = helper.DoVersioning();
+    for (HBoundsCheck* bounds_check : bounds_checks) {
+      bounds_check->ReplaceWith(bounds_check->InputAt(0));
+      bounds_check->GetBlock()->RemoveInstruction(bounds_check);
+    }
+    induction_range_.ReVisit(loop);
+    induction_range_.ReVisit(copy_header->GetLoopInformation());
+    MaybeRecordStat(stats_, MethodCompilationStat::kLoopVersionedForBCE);
+  }
+
+  HGraph* const graph_;
+  InductionVarRange induction_range_;
+  const CompilerOptions* const compiler_options_;
+  OptimizingCompilerStats* const stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(BCELoopVersioning);
+};
+
 bool BoundsCheckElimination::Run() {
   if (!graph_->HasBoundsChecks()) {
     return false;
@@ -1971,6 +2236,10 @@ bool BoundsCheckElimination::Run() {
   // Perform cleanup.
   visitor.Finish();
 
+  // Version the hot loops for the bounds checks that remain.
+  BCELoopVersioning versioning(graph_, induction_analysis_, compiler_options_, stats_);
+  versioning.Run();
+
   return true;
 }
 
@@ -21,18 +21,28 @@
 
 namespace art {
 
+class CompilerOptions;
 class SideEffectsAnalysis;
 class HInductionVarAnalysis;
 
+/**
+ * Eliminates bounds checks statically with value range and induction analysis, and
+ * dynamically with deoptimization tests. The bounds checks that remain in the hot loops
+ * are then eliminated by loop versioning when possible: a single test before the loop
+ * selects the loop without its bounds checks, or a copy of the loop that keeps them.
+ */
 class BoundsCheckElimination : public HOptimization {
  public:
   BoundsCheckElimination(HGraph* graph,
                          const SideEffectsAnalysis& side_effects,
                          HInductionVarAnalysis* induction_analysis,
+                         const CompilerOptions* compiler_options = nullptr,
+                         OptimizingCompilerStats* stats = nullptr,
                          const char* name = kBoundsCheckEliminationPassName)
-      : HOptimization(graph, name),
+      : HOptimization(graph, name, stats),
         side_effects_(side_effects),
-        induction_analysis_(induction_analysis) {}
+        induction_analysis_(induction_analysis),
+        compiler_options_(compiler_options) {}
 
   bool Run() override;
 
@@ -41,6 +51,9 @@ class BoundsCheckElimination : public HOptimization {
  private:
   const SideEffectsAnalysis& side_effects_;
   HInductionVarAnalysis* induction_analysis_;
+  // Used to find out whether the method is hot in the profile; loop versioning is only
+  // applied to hot loops. May be null, in which case only branch profiles are used.
+  const CompilerOptions* compiler_options_;
 
   DISALLOW_COPY_AND_ASSIGN(BoundsCheckElimination);
 };
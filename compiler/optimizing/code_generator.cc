@@ -32,10 +32,12 @@
 #include "code_generator_x86_64.h"
 #endif
 
+#include "base/arena_bit_vector.h"
 #include "base/bit_utils.h"
 #include "base/bit_utils_iterator.h"
 #include "base/casts.h"
 #include "base/leb128.h"
+#include "base/scoped_arena_allocator.h"
 #include "class_linker.h"
 #include "compiled_method.h"
 #include "dex/bytecode_utils.h"
@@ -373,6 +375,84 @@ void CodeGenerator::InitializeCodeGenerationData() {
   code_generation_data_ = CodeGenerationData::Create(graph_->GetArenaStack(), GetInstructionSet());
 }
 
+// Minimum number of times the other successor of a profiled branch must have been taken to
+// consider a never taken successor as cold.
+static constexpr uint16_t kMinimumBranchCountForColdBlock = 100u;
+
+// Returns whether `block` is only reached through a profiled branch that was never taken.
+static bool IsNeverTakenBranchTarget(HBasicBlock* block) {
+  if (block->GetPredecessors().size() != 1u) {
+    return false;
+  }
+  HInstruction* last_instruction = block->GetSinglePredecessor()->GetLastInstruction();
+  if (!last_instruction->IsIf() || !last_instruction->AsIf()->HasBranchProfile()) {
+    return false;
+  }
+  HIf* if_instr = last_instruction->AsIf();
+  bool is_true_successor = (block == if_instr->IfTrueSuccessor());
+  uint16_t count = is_true_successor ? if_instr->GetTrueCount() : if_instr->GetFalseCount();
+  uint16_t other_count = is_true_successor ? if_instr->GetFalseCount() : if_instr->GetTrueCount();
+  return count == 0u && other_count >= kMinimumBranchCountForColdBlock;
+}
+
+void CodeGenerator::ComputeCodeLayout() {
+  // Keep the linear order for baseline code, whose blocks have no known frequency, and for
+  // debuggable code, whose layout should match the dex code.
+  if (GetGraph()->IsCompilingBaseline() || GetGraph()->IsDebuggable()) {
+    return;
+  }
+
+  // A block is cold if it is a catch block, if it throws, if the profiled branch leading to it was
+  // never taken, or if all its successors are cold. Visiting in post order sees the successors
+  // before the block, except for back edges, whose loop header is then conservatively considered
+  // hot.
+  ScopedArenaAllocator allocator(GetGraph()->GetArenaStack());
+  ArenaBitVector cold_blocks(
+      &allocator, GetGraph()->GetBlocks().size(), /* expandable= */ false, kArenaAllocCodeGenerator);
+  size_t number_of_cold_blocks = 0u;
+  for (HBasicBlock* block : GetGraph()->GetPostOrder()) {
+    bool is_cold;
+    if (block->IsEntryBlock() || block->IsExitBlock()) {
+      is_cold = false;
+    } else if (block->IsCatchBlock() ||
+               block->GetLastInstruction()->IsThrow() ||
+               IsNeverTakenBranchTarget(block)) {
+      is_cold = true;
+    } else {
+      is_cold = std::all_of(block->GetSuccessors().begin(),
+                            block->GetSuccessors().end(),
+                            [&](HBasicBlock* successor) {
+                              return cold_blocks.IsBitSet(successor->GetBlockId());
+                            });
+    }
+    if (is_cold) {
+      cold_blocks.SetBit(block->GetBlockId());
+      ++number_of_cold_blocks;
+    }
+  }
+  if (number_of_cold_blocks == 0u) {
+    return;
+  }
+
+  // Emit the hot blocks first, then the cold blocks, both in linear order, so that the cold code
+  // sits with the slow paths after the hot code.
+  DCHECK(code_layout_.empty());
+  code_layout_.reserve(block_order_->size());
+  for (HBasicBlock* block : *block_order_) {
+    if (!cold_blocks.IsBitSet(block->GetBlockId())) {
+      code_layout_.push_back(block);
+    }
+  }
+  for (HBasicBlock* block : *block_order_) {
+    if (cold_blocks.IsBitSet(block->GetBlockId())) {
+      code_layout_.push_back(block);
+    }
+  }
+  DCHECK_EQ(code_layout_.size(), block_order_->size());
+  block_order_ = &code_layout_;
+  MaybeRecordStat(stats_, MethodCompilationStat::kColdBlockMoved, number_of_cold_blocks);
+}
+
 void CodeGenerator::Compile(CodeAllocator* allocator) {
   InitializeCodeGenerationData();
 
@@ -388,7 +468,10 @@ void CodeGenerator::Compile(CodeAllocator* allocator) {
                                    core_spill_mask_,
                                    fpu_spill_mask_,
                                    GetGraph()->GetNumberOfVRegs(),
-                                   GetGraph()->IsCompilingBaseline());
+                                   GetGraph()->IsCompilingBaseline(),
+                                   GetGraph()->IsCompilingBaselinePlus());
+
+  ComputeCodeLayout();
 
   size_t frame_start = GetAssembler()->CodeSize();
   GenerateFrameEntry();
@@ -471,6 +554,7 @@ void CodeGenerator::InitializeCodeGeneration(size_t number_of_spill_slots,
   ComputeSpillMask();
   first_register_slot_in_slow_path_ = RoundUp(
       (number_of_out_slots + number_of_spill_slots) * kVRegSize, GetPreferredSlotsAlignment());
+  MaybeRecordStat(stats_, MethodCompilationStat::kSpillSlotsAllocated, number_of_spill_slots);
 
   if (number_of_spill_slots == 0
       && !HasAllocatedCalleeSaveRegisters()
@@ -988,6 +1072,7 @@ CodeGenerator::CodeGenerator(HGraph* graph,
       compiler_options_(compiler_options),
       current_slow_path_(nullptr),
       current_block_index_(0),
+      code_layout_(graph->GetAllocator()->Adapter(kArenaAllocCodeGenerator)),
       is_leaf_(true),
       requires_current_method_(false),
       code_generation_data_() {
@@ -1224,6 +1309,12 @@ void CodeGenerator::RecordPcInfo(HInstruction* instruction,
   }
 }
 
+bool CodeGenerator::IsProfilingBranches() const {
+  return GetGraph()->IsCompilingBaseline() &&
+      GetCompilerOptions().ProfileBranches() &&
+      !Runtime::Current()->IsAotCompiler();
+}
+
 bool CodeGenerator::HasStackMapAtCurrentPc() {
   uint32_t pc = GetAssembler()->CodeSize();
   StackMapStream* stack_map_stream = GetStackMapStream();
@@ -1473,7 +1564,8 @@ void CodeGenerator::EmitEnvironment(HEnvironment* environment,
     stack_map_stream->BeginInlineInfoEntry(environment->GetMethod(),
                                            environment->GetDexPc(),
                                            needs_vreg_info ? environment->Size() : 0,
-                                           &graph_->GetDexFile());
+                                           &graph_->GetDexFile(),
+                                           &GetCompilerOptions().GetDexFilesForOatFile());
   }
 
   if (needs_vreg_info) {
@@ -1486,6 +1578,46 @@ void CodeGenerator::EmitEnvironment(HEnvironment* environment,
   }
 }
 
+bool CodeGenerator::FieldGetNeedsReadBarrier(HInstruction* field_get) {
+  DCHECK(field_get->IsInstanceFieldGet() || field_get->IsStaticFieldGet());
+  if (!kEmitCompilerReadBarrier || field_get->GetType() != DataType::Type::kReference) {
+    return false;
+  }
+  HInstruction* object = field_get->InputAt(0);
+  if (!field_get->IsInstanceFieldGet() ||
+      !object->IsNewInstance() ||
+      object->GetBlock() != field_get->GetBlock()) {
+    return true;
+  }
+  // Bound the scan so that long blocks do not make code generation quadratic.
+  static constexpr size_t kMaxInstructionsToScan = 32u;
+  size_t scanned = 0u;
+  for (HInstruction* current = object->GetNext(); current != field_get;
+       current = current->GetNext()) {
+    if (current == nullptr || ++scanned > kMaxInstructionsToScan) {
+      return true;
+    }
+    // A GC point lets the collector flip this thread, after which the object's fields may hold
+    // references that were stored in the previous phase.
+    if (current->GetSideEffects().Includes(SideEffects::CanTriggerGC())) {
+      return true;
+    }
+    // Once the object is visible to other threads, they may store references into it that this
+    // thread has not seen through a read barrier.
+    for (size_t i = 0, e = current->InputCount(); i != e; ++i) {
+      if (current->InputAt(i) != object) {
+        continue;
+      }
+      bool is_field_access_base = (i == 0u) &&
+          (current->IsInstanceFieldGet() || current->IsInstanceFieldSet());
+      if (!is_field_access_base && !current->IsConstructorFence()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 bool CodeGenerator::CanMoveNullCheckToUser(HNullCheck* null_check) {
   return null_check->IsEmittedAtUseSite();
 }
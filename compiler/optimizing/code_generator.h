@@ -391,6 +391,9 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
     return is_leaf_;
   }
 
+  // Whether the code counts the taken and not taken conditional branches in the ProfilingInfo.
+  bool IsProfilingBranches() const;
+
   void MarkNotLeaf() {
     is_leaf_ = false;
     requires_current_method_ = true;
@@ -452,6 +455,12 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
     return InstanceOfNeedsReadBarrier(instance_of) ? kWithReadBarrier : kWithoutReadBarrier;
   }
 
+  // Returns whether the reference loaded by a field get needs a read barrier. A load from an
+  // object allocated earlier in the same block, with no GC point in between and without the
+  // object escaping, can only see references this thread stored there while the GC was in its
+  // current phase, and those are already to-space references.
+  static bool FieldGetNeedsReadBarrier(HInstruction* field_get);
+
   static bool IsTypeCheckSlowPathFatal(HCheckCast* check_cast) {
     switch (check_cast->GetTypeCheckKind()) {
       case TypeCheckKind::kExactCheck:
@@ -665,6 +674,10 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
 
   virtual void GenerateNop() = 0;
 
+  // Returns the allocation entrypoint matching the array's component size. Allocation always goes
+  // through the entrypoint, even for small constant lengths: the region TLAB stubs already do the
+  // bump-pointer allocation without a frame, and allocation tracking swaps these entrypoints
+  // without revoking TLABs, so an inlined bump would silently miss instrumented allocations.
   static QuickEntrypointEnum GetArrayAllocationEntrypoint(HNewArray* new_array);
 
  protected:
@@ -786,6 +799,8 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
   class CodeGenerationData;
 
   void InitializeCodeGenerationData();
+  // Moves the cold blocks after the hot blocks in the order of code generation.
+  void ComputeCodeLayout();
   size_t GetStackOffsetOfSavedRegister(size_t index);
   void GenerateSlowPaths();
   void BlockIfInRegister(Location location, bool is_out = false) const;
@@ -806,6 +821,9 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
   // we are generating code for.
   size_t current_block_index_;
 
+  // The order of code generation, when it differs from the linear order.
+  ArenaVector<HBasicBlock*> code_layout_;
+
   // Whether the method is a leaf method.
   bool is_leaf_;
 
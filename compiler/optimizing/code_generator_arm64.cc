@@ -31,6 +31,7 @@
 #include "heap_poisoning.h"
 #include "intrinsics.h"
 #include "intrinsics_arm64.h"
+#include "jit/profiling_info.h"
 #include "linker/linker_patch.h"
 #include "lock_word.h"
 #include "mirror/array-inl.h"
@@ -1871,6 +1872,13 @@ void CodeGeneratorARM64::GenerateMemoryBarrier(MemBarrierKind kind) {
 
 void InstructionCodeGeneratorARM64::GenerateSuspendCheck(HSuspendCheck* instruction,
                                                          HBasicBlock* successor) {
+  if (instruction->IsNoOp()) {
+    if (successor != nullptr) {
+      __ B(codegen_->GetLabelOf(successor));
+    }
+    return;
+  }
+
   SuspendCheckSlowPathARM64* slow_path =
       down_cast<SuspendCheckSlowPathARM64*>(instruction->GetSlowPath());
   if (slow_path == nullptr) {
@@ -1933,8 +1941,7 @@ void LocationsBuilderARM64::HandleFieldGet(HInstruction* instruction,
                                            const FieldInfo& field_info) {
   DCHECK(instruction->IsInstanceFieldGet() || instruction->IsStaticFieldGet());
 
-  bool object_field_get_with_read_barrier =
-      kEmitCompilerReadBarrier && (instruction->GetType() == DataType::Type::kReference);
+  bool object_field_get_with_read_barrier = CodeGenerator::FieldGetNeedsReadBarrier(instruction);
   LocationSummary* locations =
       new (GetGraph()->GetAllocator()) LocationSummary(instruction,
                                                        object_field_get_with_read_barrier
@@ -1973,9 +1980,9 @@ void InstructionCodeGeneratorARM64::HandleFieldGet(HInstruction* instruction,
   DCHECK_EQ(DataType::Size(field_info.GetFieldType()), DataType::Size(instruction->GetType()));
   DataType::Type load_type = instruction->GetType();
   MemOperand field = HeapOperand(InputRegisterAt(instruction, 0), field_info.GetFieldOffset());
+  bool needs_read_barrier = CodeGenerator::FieldGetNeedsReadBarrier(instruction);
 
-  if (kEmitCompilerReadBarrier && kUseBakerReadBarrier &&
-      load_type == DataType::Type::kReference) {
+  if (needs_read_barrier && kUseBakerReadBarrier) {
     // Object FieldGet with Baker's read barrier case.
     // /* HeapReference<Object> */ out = *(base + offset)
     Register base = RegisterFrom(base_loc, DataType::Type::kReference);
@@ -2005,11 +2012,12 @@ void InstructionCodeGeneratorARM64::HandleFieldGet(HInstruction* instruction,
       codegen_->Load(load_type, OutputCPURegister(instruction), field);
       codegen_->MaybeRecordImplicitNullCheck(instruction);
     }
-    if (load_type == DataType::Type::kReference) {
-      // If read barriers are enabled, emit read barriers other than
-      // Baker's using a slow path (and also unpoison the loaded
-      // reference, if heap poisoning is enabled).
+    if (needs_read_barrier) {
+      // Emit read barriers other than Baker's using a slow path. The
+      // runtime also takes care of unpoisoning the loaded reference.
       codegen_->MaybeGenerateReadBarrierSlow(instruction, out, out, base_loc, offset);
+    } else if (load_type == DataType::Type::kReference) {
+      GetAssembler()->MaybeUnpoisonHeapReference(OutputRegister(instruction));
     }
   }
 }
@@ -3382,6 +3390,32 @@ void InstructionCodeGeneratorARM64::VisitIf(HIf* if_instr) {
   if (codegen_->GoesToNextBlock(if_instr->GetBlock(), false_successor)) {
     false_target = nullptr;
   }
+  if (codegen_->IsProfilingBranches() &&
+      IsBooleanValueOrMaterializedCondition(if_instr->InputAt(0))) {
+    ScopedObjectAccess soa(Thread::Current());
+    ProfilingInfo* info = GetGraph()->GetArtMethod()->GetProfilingInfo(kRuntimePointerSize);
+    BranchCache* cache = (info != nullptr) ? info->GetBranchCache(if_instr->GetDexPc()) : nullptr;
+    if (cache != nullptr) {
+      static_assert(
+          BranchCache::TrueOffset().Int32Value() - BranchCache::FalseOffset().Int32Value() == 2,
+          "Unexpected offsets for BranchCache");
+      uint64_t address =
+          reinterpret_cast64<uint64_t>(cache) + BranchCache::FalseOffset().Int32Value();
+      vixl::aarch64::Label done;
+      UseScratchRegisterScope temps(GetVIXLAssembler());
+      Register temp = temps.AcquireX();
+      Register counter = temps.AcquireW();
+      // The condition is 0 or 1, and indexes the false and true counters.
+      MemOperand counter_address(temp, InputRegisterAt(if_instr, 0).W(), UXTW, 1);
+      __ Mov(temp, address);
+      __ Ldrh(counter, counter_address);
+      __ Add(counter, counter, 1);
+      // Do not store the counter if it would overflow.
+      __ Tbnz(counter, 16, &done);
+      __ Strh(counter, counter_address);
+      __ Bind(&done);
+    }
+  }
   GenerateTestAndBranch(if_instr, /* condition_input_index= */ 0, true_target, false_target);
 }
 
@@ -4095,11 +4129,18 @@ void CodeGeneratorARM64::MaybeGenerateInlineCacheCheck(HInstruction* instruction
       InlineCache* cache = info->GetInlineCache(instruction->GetDexPc());
       uint64_t address = reinterpret_cast64<uint64_t>(cache);
       vixl::aarch64::Label done;
+      vixl::aarch64::Label update_cache;
       __ Mov(x8, address);
       __ Ldr(x9, MemOperand(x8, InlineCache::ClassesOffset().Int32Value()));
-      // Fast path for a monomorphic cache.
+      // Fast path for a monomorphic cache: only do a saturating increment of the count.
       __ Cmp(klass, x9);
-      __ B(eq, &done);
+      __ B(ne, &update_cache);
+      __ Ldrh(w9, MemOperand(x8, InlineCache::CountsOffset().Int32Value()));
+      __ Add(w9, w9, 1);
+      __ Tbnz(w9, 16, &done);
+      __ Strh(w9, MemOperand(x8, InlineCache::CountsOffset().Int32Value()));
+      __ B(&done);
+      __ Bind(&update_cache);
       InvokeRuntime(kQuickUpdateInlineCache, instruction, instruction->GetDexPc());
       __ Bind(&done);
     }
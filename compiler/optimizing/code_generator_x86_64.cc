@@ -1785,7 +1785,9 @@ void InstructionCodeGeneratorX86_64::GenerateTestAndBranch(HInstruction* instruc
   //        - condition true => branch to true_target
   //        - branch to false_target
   if (IsBooleanValueOrMaterializedCondition(cond)) {
-    if (AreEflagsSetFrom(cond, instruction)) {
+    // Branch profiling clobbers the flags set by the condition.
+    if (AreEflagsSetFrom(cond, instruction) &&
+        !(instruction->IsIf() && codegen_->IsProfilingBranches())) {
       if (true_target == nullptr) {
         __ j(X86_64IntegerCondition(cond->AsCondition()->GetOppositeCondition()), false_target);
       } else {
@@ -1838,7 +1840,10 @@ void InstructionCodeGeneratorX86_64::GenerateTestAndBranch(HInstruction* instruc
 void LocationsBuilderX86_64::VisitIf(HIf* if_instr) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(if_instr);
   if (IsBooleanValueOrMaterializedCondition(if_instr->InputAt(0))) {
-    locations->SetInAt(0, Location::Any());
+    // Branch profiling indexes the branch cache with the condition.
+    locations->SetInAt(0, codegen_->IsProfilingBranches()
+        ? Location::RequiresRegister()
+        : Location::Any());
   }
 }
 
@@ -1849,6 +1854,29 @@ void InstructionCodeGeneratorX86_64::VisitIf(HIf* if_instr) {
       nullptr : codegen_->GetLabelOf(true_successor);
   Label* false_target = codegen_->GoesToNextBlock(if_instr->GetBlock(), false_successor) ?
       nullptr : codegen_->GetLabelOf(false_successor);
+  if (codegen_->IsProfilingBranches() &&
+      IsBooleanValueOrMaterializedCondition(if_instr->InputAt(0))) {
+    ScopedObjectAccess soa(Thread::Current());
+    ProfilingInfo* info = GetGraph()->GetArtMethod()->GetProfilingInfo(kRuntimePointerSize);
+    BranchCache* cache = (info != nullptr) ? info->GetBranchCache(if_instr->GetDexPc()) : nullptr;
+    if (cache != nullptr) {
+      static_assert(
+          BranchCache::TrueOffset().Int32Value() - BranchCache::FalseOffset().Int32Value() == 2,
+          "Unexpected offsets for BranchCache");
+      uint64_t address =
+          reinterpret_cast64<uint64_t>(cache) + BranchCache::FalseOffset().Int32Value();
+      CpuRegister condition = if_instr->GetLocations()->InAt(0).AsRegister<CpuRegister>();
+      // The condition is 0 or 1, and indexes the false and true counters.
+      Address counter_address(CpuRegister(TMP), condition, TIMES_2, 0);
+      NearLabel done;
+      __ movq(CpuRegister(TMP), Immediate(address));
+      // Do not increment the counter if it would overflow.
+      __ cmpw(counter_address, Immediate(-1));
+      __ j(kEqual, &done);
+      __ addw(counter_address, Immediate(1));
+      __ Bind(&done);
+    }
+  }
   GenerateTestAndBranch(if_instr, /* condition_input_index= */ 0, true_target, false_target);
 }
 
@@ -2583,10 +2611,17 @@ void CodeGeneratorX86_64::MaybeGenerateInlineCacheCheck(HInstruction* instructio
       InlineCache* cache = info->GetInlineCache(instruction->GetDexPc());
       uint64_t address = reinterpret_cast64<uint64_t>(cache);
       NearLabel done;
+      NearLabel update_cache;
+      Address count_address(CpuRegister(TMP), InlineCache::CountsOffset().Int32Value());
       __ movq(CpuRegister(TMP), Immediate(address));
-      // Fast path for a monomorphic cache.
+      // Fast path for a monomorphic cache: only do a saturating increment of the count.
       __ cmpl(Address(CpuRegister(TMP), InlineCache::ClassesOffset().Int32Value()), klass);
+      __ j(kNotEqual, &update_cache);
+      __ cmpw(count_address, Immediate(-1));
       __ j(kEqual, &done);
+      __ addw(count_address, Immediate(1));
+      __ jmp(&done);
+      __ Bind(&update_cache);
       GenerateInvokeRuntime(
           GetThreadOffset<kX86_64PointerSize>(kQuickUpdateInlineCache).Int32Value());
       __ Bind(&done);
@@ -5655,6 +5690,13 @@ void InstructionCodeGeneratorX86_64::VisitSuspendCheck(HSuspendCheck* instructio
 
 void InstructionCodeGeneratorX86_64::GenerateSuspendCheck(HSuspendCheck* instruction,
                                                           HBasicBlock* successor) {
+  if (instruction->IsNoOp()) {
+    if (successor != nullptr) {
+      __ jmp(codegen_->GetLabelOf(successor));
+    }
+    return;
+  }
+
   SuspendCheckSlowPathX86_64* slow_path =
       down_cast<SuspendCheckSlowPathX86_64*>(instruction->GetSlowPath());
   if (slow_path == nullptr) {
@@ -58,7 +58,9 @@ static bool IsInterestingInstruction(HInstruction* instruction) {
     }
   }
 
-  // Check allocations first, as they can throw, but it is safe to move them.
+  // Check allocations first, as they can throw, but it is safe to move them. Each allocation
+  // moves on its own; adjacent allocations are not merged since every one of them must go
+  // through the (possibly instrumented) allocation entrypoint.
   if (instruction->IsNewInstance() || instruction->IsNewArray()) {
     return true;
   }
@@ -19,6 +19,7 @@
 #include "base/arena_allocator.h"
 #include "base/scoped_arena_allocator.h"
 #include "base/scoped_arena_containers.h"
+#include "escape.h"
 
 namespace art {
 
@@ -250,7 +251,65 @@ class CFREVisitor : public HGraphVisitor {
   DISALLOW_COPY_AND_ASSIGN(CFREVisitor);
 };
 
+// Remove all monitor-enter and monitor-exit operations on `allocation`. No other thread
+// can ever contend for the lock of an object that never leaves the current thread.
+static void RemoveMonitorOperations(HInstruction* allocation, OptimizingCompilerStats* stats) {
+  const HUseList<HInstruction*>& uses = allocation->GetUses();
+  for (auto it = uses.begin(), end = uses.end(); it != end; /* ++it below */) {
+    HInstruction* user = it->GetUser();
+    ++it;
+    if (user->IsMonitorOperation()) {
+      user->GetBlock()->RemoveInstruction(user);
+      MaybeRecordStat(stats, MethodCompilationStat::kRemovedMonitorOperation);
+    }
+  }
+}
+
+// Remove all constructor fences guarding allocations that never leave the current thread.
+// Such an object cannot be observed by another thread, so there is nothing to publish.
+// Synchronization on such an object is removed as well.
+static void RemoveFencesForThreadLocalAllocations(HGraph* graph, OptimizingCompilerStats* stats) {
+  // A debugger can read any local and hand the object to another thread.
+  if (graph->IsDebuggable()) {
+    return;
+  }
+  ScopedArenaAllocator allocator(graph->GetArenaStack());
+  ScopedArenaVector<HInstruction*> allocations(allocator.Adapter(kArenaAllocCFRE));
+  for (HBasicBlock* block : graph->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      if (instruction->IsNewInstance() || instruction->IsNewArray()) {
+        allocations.push_back(instruction);
+      }
+    }
+  }
+  // Fences are only removed once the walk above is done, as they usually follow their
+  // allocation immediately and would invalidate the iterator.
+  for (HInstruction* allocation : allocations) {
+    bool is_singleton;
+    bool is_singleton_and_not_returned;
+    bool is_singleton_and_not_deopt_visible;
+    CalculateEscape(allocation,
+                    /* no_escape= */ nullptr,
+                    &is_singleton,
+                    &is_singleton_and_not_returned,
+                    &is_singleton_and_not_deopt_visible);
+    // An object handed to the interpreter on deoptimization may still be published there.
+    if (is_singleton_and_not_returned && is_singleton_and_not_deopt_visible) {
+      size_t removed = HConstructorFence::RemoveConstructorFences(allocation);
+      MaybeRecordStat(stats, MethodCompilationStat::kConstructorFenceRemovedCFRE, removed);
+      // With OSR, the interpreter may already hold the lock when entering compiled code,
+      // and the matching monitor-exit must still release it.
+      if (!graph->IsCompilingOsr()) {
+        RemoveMonitorOperations(allocation, stats);
+      }
+    }
+  }
+}
+
 bool ConstructorFenceRedundancyElimination::Run() {
+  RemoveFencesForThreadLocalAllocations(graph_, stats_);
+
   CFREVisitor cfre_visitor(graph_, stats_);
 
   // Arbitrarily visit in reverse-post order.
@@ -44,6 +44,9 @@ namespace art {
  * - If we see an interesting publish, merge all instructions in CFS into a single CF(CFTargets).
  * - Repeat until the block is fully visited.
  * - At the end of the block, merge all instructions in CFS into a single CF(CFTargets).
+ *
+ * Before merging, fences for allocations that escape analysis proves never leave the
+ * current thread are removed altogether, together with any monitor operations on them.
  */
 class ConstructorFenceRedundancyElimination : public HOptimization {
  public:
@@ -28,7 +28,7 @@ namespace art {
 /**
  * A ValueSet holds instructions that can replace other instructions. It is updated
  * through the `Add` method, and the `Kill` method. The `Kill` method removes
- * instructions that are affected by the given side effect.
+ * instructions that are affected by the given write.
  *
  * The `Lookup` method returns an equivalent instruction to the given instruction
  * if there is one in the set. In GVN, we would say those instructions have the
@@ -124,9 +124,18 @@ class ValueSet : public ArenaObject<kArenaAllocGvn> {
   }
 
   // Removes all instructions in the set affected by the given side effects.
-  void Kill(SideEffects side_effects) {
-    DeleteAllImpureWhich([side_effects](Node* node) {
-      return node->GetInstruction()->GetSideEffects().MayDependOn(side_effects);
+  // Removes all instructions that may depend on `write`. Field accesses are told apart
+  // by their offsets and not only by the types of their side effects.
+  void Kill(HInstruction* write) {
+    DeleteAllImpureWhich([write](Node* node) {
+      return SideEffectsAnalysis::MayDependOn(node->GetInstruction(), write);
+    });
+  }
+
+  // Removes all instructions that may depend on a write in the loop `info`.
+  void KillLoopWrites(const SideEffectsAnalysis& side_effects, HLoopInformation* info) {
+    DeleteAllImpureWhich([&side_effects, info](Node* node) {
+      return side_effects.MayDependOnLoopWrites(node->GetInstruction(), info);
     });
   }
 
@@ -455,7 +464,7 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         } else {
           DCHECK(!block->GetLoopInformation()->IsIrreducible());
           DCHECK_EQ(block->GetDominator(), block->GetLoopInformation()->GetPreHeader());
-          set->Kill(side_effects_.GetLoopEffects(block));
+          set->KillLoopWrites(side_effects_, block->GetLoopInformation());
         }
       } else if (predecessors.size() > 1) {
         for (HBasicBlock* predecessor : predecessors) {
@@ -494,11 +503,11 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         current->ReplaceWith(existing);
         current->GetBlock()->RemoveInstruction(current);
       } else {
-        set->Kill(current->GetSideEffects());
+        set->Kill(current);
         set->Add(current);
       }
     } else {
-      set->Kill(current->GetSideEffects());
+      set->Kill(current);
     }
     current = next;
   }
@@ -34,6 +34,7 @@
 #include "intrinsics.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
+#include "method_compilation_stats.h"
 #include "mirror/class_loader.h"
 #include "mirror/dex_cache.h"
 #include "mirror/object_array-alloc-inl.h"
@@ -68,6 +69,16 @@ static constexpr size_t kMaximumNumberOfRecursiveCalls = 4;
 // Controls the use of inline caches in AOT mode.
 static constexpr bool kUseAOTInlineCaches = true;
 
+// A receiver of a megamorphic call is inlined if it was the receiver of at least a fifth of the
+// counted calls, and there were enough counted calls to trust the distribution of receivers.
+static constexpr uint32_t kMegamorphicReceiverShareDivider = 5;
+static constexpr uint32_t kMinimumMegamorphicCallCount = 64;
+
+// The code item limit is raised for the targets of a call site whose inline cache counted at
+// least this many calls, as inlining pays off most on hot paths.
+static constexpr uint32_t kHotCallSiteCallCount = 1024;
+static constexpr size_t kHotCallSiteCodeUnitsMultiplier = 2;
+
 // We check for line numbers to make sure the DepthString implementation
 // aligns the output nicely.
 #define LOG_INTERNAL(msg) \
@@ -78,7 +89,8 @@ static constexpr bool kUseAOTInlineCaches = true;
 #define LOG_TRY() LOG_INTERNAL("Try inlinining call: ")
 #define LOG_NOTE() LOG_INTERNAL("Note: ")
 #define LOG_SUCCESS() LOG_INTERNAL("Success: ")
-#define LOG_FAIL(stats_ptr, stat) MaybeRecordStat(stats_ptr, stat); LOG_INTERNAL("Fail: ")
+#define LOG_FAIL(stats_ptr, stat) \
+  MaybeRecordStat(stats_ptr, stat); inline_failure_reason_ = stat; LOG_INTERNAL("Fail: ")
 #define LOG_FAIL_NO_STAT() LOG_INTERNAL("Fail: ")
 
 std::string HInliner::DepthString(int line) const {
@@ -178,7 +190,7 @@ bool HInliner::Run() {
               call->GetDexMethodIndex(), /* with_signature= */ false);
           // Tests prevent inlining by having $noinline$ in their method names.
           if (callee_name.find("$noinline$") == std::string::npos) {
-            if (TryInline(call)) {
+            if (TryInlineAndRecordDecision(call)) {
               didInline = true;
             } else if (honor_inline_directives) {
               bool should_have_inlined = (callee_name.find("$inline$") != std::string::npos);
@@ -188,7 +200,7 @@ bool HInliner::Run() {
         } else {
           DCHECK(!honor_inline_directives);
           // Normal case: try to inline.
-          if (TryInline(call)) {
+          if (TryInlineAndRecordDecision(call)) {
             didInline = true;
           }
         }
@@ -368,6 +380,26 @@ HInliner::InlineCacheType HInliner::GetInlineCacheType(
   }
 }
 
+// Sorts the first `number_of_types` classes of an inline cache by decreasing count, so that the
+// type guards test the most frequent receivers first. Classes with equal counts keep their order.
+static void SortInlineCacheByCounts(Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                    /*inout*/ uint16_t* counts,
+                                    size_t number_of_types)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // Insertion sort, as inline caches are small.
+  for (size_t i = 1; i < number_of_types && classes->Get(i) != nullptr; ++i) {
+    ObjPtr<mirror::Class> klass = classes->Get(i);
+    uint16_t count = counts[i];
+    size_t j = i;
+    for (; j != 0u && counts[j - 1] < count; --j) {
+      classes->Set(j, classes->Get(j - 1));
+      counts[j] = counts[j - 1];
+    }
+    classes->Set(j, klass);
+    counts[j] = count;
+  }
+}
+
 static ObjPtr<mirror::Class> GetMonomorphicType(Handle<mirror::ObjectArray<mirror::Class>> classes)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   DCHECK(classes->Get(0) != nullptr);
@@ -489,6 +521,20 @@ ArtMethod* HInliner::FindActualCallTarget(HInvoke* invoke_instruction, bool* cha
   return actual_method;
 }
 
+bool HInliner::TryInlineAndRecordDecision(HInvoke* invoke_instruction) {
+  MethodCompilationStats* method_stats = (stats_ != nullptr) ? stats_->GetMethodStats() : nullptr;
+  if (method_stats == nullptr) {
+    return TryInline(invoke_instruction);
+  }
+  // Get the callee name first, `invoke_instruction` is removed when inlined.
+  std::string callee_name =
+      caller_compilation_unit_.GetDexFile()->PrettyMethod(invoke_instruction->GetDexMethodIndex());
+  inline_failure_reason_ = MethodCompilationStat::kLastStat;
+  bool inlined = TryInline(invoke_instruction);
+  method_stats->RecordInliningDecision(callee_name, inlined, inline_failure_reason_);
+  return inlined;
+}
+
 bool HInliner::TryInline(HInvoke* invoke_instruction) {
   if (invoke_instruction->IsInvokeUnresolved() ||
       invoke_instruction->IsInvokePolymorphic() ||
@@ -517,7 +563,9 @@ bool HInliner::TryInline(HInvoke* invoke_instruction) {
   if (actual_method == nullptr) {
     DCHECK(!invoke_instruction->IsInvokeStaticOrDirect());
 
-    return TryInlineFromInlineCache(caller_dex_file, invoke_instruction, resolved_method);
+    bool result = TryInlineFromInlineCache(caller_dex_file, invoke_instruction, resolved_method);
+    call_site_count_ = 0u;
+    return result;
   }
 
   // Single target.
@@ -604,12 +652,17 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
 
   StackHandleScope<1> hs(Thread::Current());
   Handle<mirror::ObjectArray<mirror::Class>> inline_cache;
+  // Offline profiles have no receiver counts.
+  uint16_t counts[InlineCache::kIndividualCacheSize] = {};
   // The Zygote JIT compiles based on a profile, so we shouldn't use runtime inline caches
   // for it.
   InlineCacheType inline_cache_type =
       (Runtime::Current()->IsAotCompiler() || Runtime::Current()->IsZygote())
           ? GetInlineCacheAOT(caller_dex_file, invoke_instruction, &hs, &inline_cache)
-          : GetInlineCacheJIT(invoke_instruction, &hs, &inline_cache);
+          : GetInlineCacheJIT(invoke_instruction, &hs, &inline_cache, counts);
+  for (uint16_t count : counts) {
+    call_site_count_ += count;
+  }
 
   switch (inline_cache_type) {
     case kInlineCacheNoData: {
@@ -630,7 +683,8 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
     case kInlineCacheMonomorphic: {
       MaybeRecordStat(stats_, MethodCompilationStat::kMonomorphicCall);
       if (UseOnlyPolymorphicInliningWithNoDeopt()) {
-        return TryInlinePolymorphicCall(invoke_instruction, resolved_method, inline_cache);
+        return TryInlinePolymorphicCall(
+            invoke_instruction, resolved_method, inline_cache, /* is_megamorphic= */ false);
       } else {
         return TryInlineMonomorphicCall(invoke_instruction, resolved_method, inline_cache);
       }
@@ -638,10 +692,16 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
 
     case kInlineCachePolymorphic: {
       MaybeRecordStat(stats_, MethodCompilationStat::kPolymorphicCall);
-      return TryInlinePolymorphicCall(invoke_instruction, resolved_method, inline_cache);
+      SortInlineCacheByCounts(inline_cache, counts, InlineCache::kIndividualCacheSize);
+      return TryInlinePolymorphicCall(
+          invoke_instruction, resolved_method, inline_cache, /* is_megamorphic= */ false);
     }
 
     case kInlineCacheMegamorphic: {
+      if (TryInlineMegamorphicCall(invoke_instruction, resolved_method, inline_cache, counts)) {
+        MaybeRecordStat(stats_, MethodCompilationStat::kMegamorphicCall);
+        return true;
+      }
       LOG_FAIL_NO_STAT()
           << "Interface or virtual call to "
           << caller_dex_file.PrettyMethod(invoke_instruction->GetDexMethodIndex())
@@ -664,7 +724,8 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
 HInliner::InlineCacheType HInliner::GetInlineCacheJIT(
     HInvoke* invoke_instruction,
     StackHandleScope<1>* hs,
-    /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache)
+    /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache,
+    /*out*/uint16_t* counts)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   DCHECK(Runtime::Current()->UseJitCompilation());
 
@@ -685,7 +746,8 @@ HInliner::InlineCacheType HInliner::GetInlineCacheJIT(
   } else {
     Runtime::Current()->GetJit()->GetCodeCache()->CopyInlineCacheInto(
         *profiling_info->GetInlineCache(invoke_instruction->GetDexPc()),
-        *inline_cache);
+        *inline_cache,
+        counts);
     return GetInlineCacheType(*inline_cache);
   }
 }
@@ -926,6 +988,53 @@ void HInliner::AddCHAGuard(HInstruction* invoke_instruction,
   outermost_graph_->IncrementNumberOfCHAGuards();
 }
 
+HInvokeStaticOrDirect* HInliner::TryBuildCHADirectCall(HInvoke* invoke_instruction,
+                                                       ArtMethod* method) {
+  DCHECK(!invoke_instruction->IsInvokeStaticOrDirect());
+  if (!Runtime::Current()->UseJitCompilation()) {
+    return nullptr;
+  }
+  HInvokeStaticOrDirect::DispatchInfo dispatch_info =
+      HSharpening::SharpenInvokeStaticOrDirect(method, codegen_);
+  if (dispatch_info.method_load_kind != HInvokeStaticOrDirect::MethodLoadKind::kJitDirectAddress &&
+      dispatch_info.method_load_kind != HInvokeStaticOrDirect::MethodLoadKind::kRecursive) {
+    // A runtime call would resolve the method index of the caller as a direct method.
+    return nullptr;
+  }
+  const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
+  uint32_t dex_method_index = FindMethodIndexIn(
+      method, caller_dex_file, invoke_instruction->GetDexMethodIndex());
+  if (dex_method_index == dex::kDexNoIndex) {
+    return nullptr;
+  }
+  MethodReference target_method(method->GetDexFile(), method->GetDexMethodIndex());
+  HInvokeStaticOrDirect* new_invoke = new (graph_->GetAllocator()) HInvokeStaticOrDirect(
+      graph_->GetAllocator(),
+      invoke_instruction->GetNumberOfArguments(),
+      invoke_instruction->GetType(),
+      invoke_instruction->GetDexPc(),
+      dex_method_index,
+      method,
+      dispatch_info,
+      kDirect,
+      target_method,
+      HInvokeStaticOrDirect::ClinitCheckRequirement::kNone);
+  HInputsRef inputs = invoke_instruction->GetInputs();
+  for (size_t index = 0; index != invoke_instruction->GetNumberOfArguments(); ++index) {
+    new_invoke->SetArgumentAt(index, inputs[index]);
+  }
+  if (HInvokeStaticOrDirect::NeedsCurrentMethodInput(dispatch_info.method_load_kind)) {
+    new_invoke->SetArgumentAt(new_invoke->GetSpecialInputIndex(), graph_->GetCurrentMethod());
+  }
+  invoke_instruction->GetBlock()->InsertInstructionBefore(new_invoke, invoke_instruction);
+  new_invoke->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  if (invoke_instruction->GetType() == DataType::Type::kReference) {
+    new_invoke->SetReferenceTypeInfo(invoke_instruction->GetReferenceTypeInfo());
+  }
+  MaybeRecordStat(stats_, MethodCompilationStat::kCHADirectCall);
+  return new_invoke;
+}
+
 HInstruction* HInliner::AddTypeGuard(HInstruction* receiver,
                                      HInstruction* cursor,
                                      HBasicBlock* bb_cursor,
@@ -999,13 +1108,47 @@ HInstruction* HInliner::AddTypeGuard(HInstruction* receiver,
   return compare;
 }
 
+bool HInliner::TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                        ArtMethod* resolved_method,
+                                        Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                        uint16_t* counts) {
+  uint32_t total_count = 0u;
+  for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
+    total_count += counts[i];
+  }
+  if (total_count < kMinimumMegamorphicCallCount) {
+    // Not enough counted calls, e.g. for code not counting receivers.
+    return false;
+  }
+
+  // The last entry counts all the receivers not in the cache, so it is never dominant.
+  constexpr size_t kNumberOfCountedReceivers = InlineCache::kIndividualCacheSize - 1;
+  SortInlineCacheByCounts(classes, counts, kNumberOfCountedReceivers);
+  size_t number_of_dominant_receivers = 0u;
+  while (number_of_dominant_receivers < kNumberOfCountedReceivers &&
+         counts[number_of_dominant_receivers] * kMegamorphicReceiverShareDivider >= total_count) {
+    ++number_of_dominant_receivers;
+  }
+  if (number_of_dominant_receivers == 0u) {
+    return false;
+  }
+  for (size_t i = number_of_dominant_receivers; i < InlineCache::kIndividualCacheSize; ++i) {
+    classes->Set(i, nullptr);
+  }
+  return TryInlinePolymorphicCall(
+      invoke_instruction, resolved_method, classes, /* is_megamorphic= */ true);
+}
+
 bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
                                         ArtMethod* resolved_method,
-                                        Handle<mirror::ObjectArray<mirror::Class>> classes) {
+                                        Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                        bool is_megamorphic) {
   DCHECK(invoke_instruction->IsInvokeVirtual() || invoke_instruction->IsInvokeInterface())
       << invoke_instruction->DebugName();
 
-  if (TryInlinePolymorphicCallToSameTarget(invoke_instruction, resolved_method, classes)) {
+  // Other receivers of a megamorphic call may have other targets.
+  if (!is_megamorphic &&
+      TryInlinePolymorphicCallToSameTarget(invoke_instruction, resolved_method, classes)) {
     return true;
   }
 
@@ -1052,7 +1195,8 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
 
       // If we have inlined all targets before, and this receiver is the last seen,
       // we deoptimize instead of keeping the original invoke instruction.
-      bool deoptimize = !UseOnlyPolymorphicInliningWithNoDeopt() &&
+      bool deoptimize = !is_megamorphic &&
+          !UseOnlyPolymorphicInliningWithNoDeopt() &&
           all_targets_inlined &&
           (i != InlineCache::kIndividualCacheSize - 1) &&
           (classes->Get(i + 1) == nullptr);
@@ -1086,7 +1230,9 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
     return false;
   }
 
-  MaybeRecordStat(stats_, MethodCompilationStat::kInlinedPolymorphicCall);
+  MaybeRecordStat(stats_,
+                  is_megamorphic ? MethodCompilationStat::kInlinedMegamorphicCall
+                                 : MethodCompilationStat::kInlinedPolymorphicCall);
 
   // Run type propagation to get the guards typed.
   ReferenceTypePropagation rtp_fixup(graph_,
@@ -1342,7 +1488,15 @@ bool HInliner::TryInlineAndReplace(HInvoke* invoke_instruction,
       invoke_instruction->SetResolvedMethod(method);
     }
   } else if (!TryBuildAndInline(invoke_instruction, method, receiver_type, &return_replacement)) {
-    if (invoke_instruction->IsInvokeInterface()) {
+    HInvokeStaticOrDirect* direct_call =
+        cha_devirtualize ? TryBuildCHADirectCall(invoke_instruction, method) : nullptr;
+    if (direct_call != nullptr) {
+      // The CHA guard makes `method` the only possible target, call it without
+      // going through the IMT or the vtable.
+      return_replacement = direct_call;
+      // invoke_instruction is replaced with direct_call.
+      should_remove_invoke_instruction = true;
+    } else if (invoke_instruction->IsInvokeInterface()) {
       DCHECK(!method->IsProxyMethod());
       // Turn an invoke-interface into an invoke-virtual. An invoke-virtual is always
       // better than an invoke-interface because:
@@ -1470,8 +1624,8 @@ bool HInliner::IsInliningAllowed(ArtMethod* method, const CodeItemDataAccessor&
 // Returns whether ART supports inlining this method.
 //
 // Some methods are not supported because they have features for which inlining
-// is not implemented. For example, we do not currently support inlining throw
-// instructions into a try block.
+// is not implemented. For example, we do not currently support inlining methods
+// with try blocks.
 bool HInliner::IsInliningSupported(const HInvoke* invoke_instruction,
                                    ArtMethod* method,
                                    const CodeItemDataAccessor& accessor) const {
@@ -1514,6 +1668,14 @@ bool HInliner::IsInliningBudgetAvailable(ArtMethod* method,
   }
 
   size_t inline_max_code_units = codegen_->GetCompilerOptions().GetInlineMaxCodeUnits();
+  if (call_site_count_ >= kHotCallSiteCallCount &&
+      accessor.InsnsSizeInCodeUnits() > inline_max_code_units &&
+      accessor.InsnsSizeInCodeUnits() <= inline_max_code_units * kHotCallSiteCodeUnitsMultiplier) {
+    LOG_NOTE() << "Raising the code item limit for " << method->PrettyMethod()
+               << " at a call site with " << call_site_count_ << " counted calls";
+    MaybeRecordStat(stats_, MethodCompilationStat::kInlineCodeItemLimitRaisedForHotCall);
+    inline_max_code_units *= kHotCallSiteCodeUnitsMultiplier;
+  }
   if (accessor.InsnsSizeInCodeUnits() > inline_max_code_units) {
     LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedCodeItem)
         << "Method " << method->PrettyMethod()
@@ -1550,6 +1712,20 @@ bool HInliner::TryBuildAndInline(HInvoke* invoke_instruction,
     return false;
   }
 
+  if (outermost_graph_->IsCompilingBaselinePlus()) {
+    // Baseline-plus compilation only inlines trivial callees, which do not need a callee graph.
+    // This also keeps the inline caches of the baseline code indexed by dex pcs of the method.
+    if (TryPatternSubstitution(invoke_instruction, method, return_replacement)) {
+      LOG_SUCCESS() << "Successfully replaced pattern of invoke "
+                    << method->PrettyMethod();
+      MaybeRecordStat(stats_, MethodCompilationStat::kReplacedInvokeWithSimplePattern);
+      return true;
+    }
+    LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedWont)
+        << "Won't inline " << method->PrettyMethod() << " in baseline-plus compilation";
+    return false;
+  }
+
   CodeItemDataAccessor accessor(method->DexInstructionData());
 
   if (!IsInliningAllowed(method, accessor)) {
@@ -1780,18 +1956,26 @@ static inline Handle<T> NewHandleIfDifferent(ObjPtr<T> object,
   return (object != hint.Get()) ? handles->NewHandle(object) : hint;
 }
 
-static bool CanEncodeInlinedMethodInStackMap(const DexFile& caller_dex_file, ArtMethod* callee)
+static bool CanEncodeInlinedMethodInStackMap(const CompilerOptions& compiler_options,
+                                             const DexFile& caller_dex_file,
+                                             ArtMethod* callee)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   if (!Runtime::Current()->IsAotCompiler()) {
     // JIT can always encode methods in stack maps.
     return true;
   }
-  if (IsSameDexFile(caller_dex_file, *callee->GetDexFile())) {
+  const DexFile& callee_dex_file = *callee->GetDexFile();
+  if (IsSameDexFile(caller_dex_file, callee_dex_file)) {
     return true;
   }
-  // TODO(ngeoffray): Support more AOT cases for inlining:
-  // - methods in multidex
-  // - methods in boot image for on-device non-PIC compilation.
+  // Methods from the other dex files of the oat file are encoded with the index of their dex
+  // file. These dex files are loaded together by the same class loader, and the checksums in
+  // the oat file invalidate the code if any of them changes. The boot image can have several
+  // oat files, so the index would be ambiguous there.
+  // TODO(ngeoffray): Support inlining methods in boot image for on-device non-PIC compilation.
+  if (!compiler_options.IsBootImage() && !compiler_options.IsBootImageExtension()) {
+    return ContainsElement(compiler_options.GetDexFilesForOatFile(), &callee_dex_file);
+  }
   return false;
 }
 
@@ -1845,7 +2029,7 @@ void HInliner::SubstituteArguments(HGraph* callee_graph,
   }
 }
 
-// Returns whether we can inline the callee_graph into the target_block.
+// Returns whether we can inline the callee_graph.
 //
 // This performs a combination of semantics checks, compiler support checks, and
 // resource limit checks.
@@ -1853,7 +2037,6 @@ void HInliner::SubstituteArguments(HGraph* callee_graph,
 // If this function returns true, it will also set out_number_of_instructions to
 // the number of instructions in the inlined body.
 bool HInliner::CanInlineBody(const HGraph* callee_graph,
-                             const HBasicBlock* target_block,
                              size_t* out_number_of_instructions) const {
   const DexFile& callee_dex_file = callee_graph->GetDexFile();
   ArtMethod* const resolved_method = callee_graph->GetArtMethod();
@@ -1872,14 +2055,7 @@ bool HInliner::CanInlineBody(const HGraph* callee_graph,
   bool has_one_return = false;
   for (HBasicBlock* predecessor : exit_block->GetPredecessors()) {
     if (predecessor->GetLastInstruction()->IsThrow()) {
-      if (target_block->IsTryBlock()) {
-        // TODO(ngeoffray): Support adding HTryBoundary in Hgraph::InlineInto.
-        LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedTryCatch)
-            << "Method " << callee_dex_file.PrettyMethod(method_index)
-            << " could not be inlined because one branch always throws and"
-            << " caller is in a try/catch block";
-        return false;
-      } else if (graph_->GetExitBlock() == nullptr) {
+      if (graph_->GetExitBlock() == nullptr) {
         // TODO(ngeoffray): Support adding HExit in the caller graph.
         LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedInfiniteLoop)
             << "Method " << callee_dex_file.PrettyMethod(method_index)
@@ -1950,7 +2126,8 @@ bool HInliner::CanInlineBody(const HGraph* callee_graph,
       }
 
       if (current->NeedsEnvironment() &&
-          !CanEncodeInlinedMethodInStackMap(*caller_compilation_unit_.GetDexFile(),
+          !CanEncodeInlinedMethodInStackMap(codegen_->GetCompilerOptions(),
+                                            *caller_compilation_unit_.GetDexFile(),
                                             resolved_method)) {
         LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedStackMaps)
             << "Method " << callee_dex_file.PrettyMethod(method_index)
@@ -2082,7 +2259,7 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
   RunOptimizations(callee_graph, code_item, dex_compilation_unit);
 
   size_t number_of_instructions = 0;
-  if (!CanInlineBody(callee_graph, invoke_instruction->GetBlock(), &number_of_instructions)) {
+  if (!CanInlineBody(callee_graph, &number_of_instructions)) {
     return false;
   }
 
@@ -20,6 +20,7 @@
 #include "dex/dex_file_types.h"
 #include "dex/invoke_type.h"
 #include "optimization.h"
+#include "optimizing_compiler_stats.h"
 #include "profile/profile_compilation_info.h"
 
 namespace art {
@@ -54,8 +55,10 @@ class HInliner : public HOptimization {
         parent_(parent),
         depth_(depth),
         inlining_budget_(0),
+        call_site_count_(0u),
         handles_(handles),
-        inline_stats_(nullptr) {}
+        inline_stats_(nullptr),
+        inline_failure_reason_(MethodCompilationStat::kLastStat) {}
 
   bool Run() override;
 
@@ -71,6 +74,10 @@ class HInliner : public HOptimization {
     kInlineCacheMissingTypes = 5
   };
 
+  // Try to inline `invoke_instruction`, and record the decision in the statistics of the
+  // compiled method if requested.
+  bool TryInlineAndRecordDecision(HInvoke* invoke_instruction);
+
   bool TryInline(HInvoke* invoke_instruction);
 
   // Attempt to resolve the target of the invoke instruction to an acutal call
@@ -132,8 +139,8 @@ class HInliner : public HOptimization {
   // Returns whether ART supports inlining this method.
   //
   // Some methods are not supported because they have features for which inlining
-  // is not implemented. For example, we do not currently support inlining throw
-  // instructions into a try block.
+  // is not implemented. For example, we do not currently support inlining methods
+  // with try blocks.
   bool IsInliningSupported(const HInvoke* invoke_instruction,
                            art::ArtMethod* method,
                            const CodeItemDataAccessor& accessor) const
@@ -150,9 +157,8 @@ class HInliner : public HOptimization {
   // inlined.
   //
   // This checks for instructions and constructs that we do not support
-  // inlining, such as inlining a throw instruction into a try block.
+  // inlining, such as a method that always throws.
   bool CanInlineBody(const HGraph* callee_graph,
-                     const HBasicBlock* target_block,
                      size_t* out_number_of_instructions) const
     REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -177,10 +183,12 @@ class HInliner : public HOptimization {
   // Try getting the inline cache from JIT code cache.
   // Return true if the inline cache was successfully allocated and the
   // invoke info was found in the profile info.
+  // The counts of the receivers are copied into `counts`.
   InlineCacheType GetInlineCacheJIT(
       HInvoke* invoke_instruction,
       StackHandleScope<1>* hs,
-      /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache)
+      /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache,
+      /*out*/uint16_t* counts)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Try getting the inline cache from AOT offline profile.
@@ -215,10 +223,20 @@ class HInliner : public HOptimization {
                                 Handle<mirror::ObjectArray<mirror::Class>> classes)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Try to inline targets of a polymorphic call.
+  // Try to inline targets of a polymorphic call. For a megamorphic call, `classes` only holds
+  // some of the receivers, and the original invoke is kept for the others.
   bool TryInlinePolymorphicCall(HInvoke* invoke_instruction,
                                 ArtMethod* resolved_method,
-                                Handle<mirror::ObjectArray<mirror::Class>> classes)
+                                Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                bool is_megamorphic)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Try to inline the targets of the dominant receivers of a megamorphic call, according to the
+  // `counts` of the inline cache, each behind a type guard.
+  bool TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                ArtMethod* resolved_method,
+                                Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                uint16_t* counts)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
   bool TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
@@ -235,6 +253,12 @@ class HInliner : public HOptimization {
   ArtMethod* TryCHADevirtualization(ArtMethod* resolved_method)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Build a direct call to `method`, the single implementation found by CHA for the
+  // target of `invoke_instruction`, which is not inlined. Returns null if the JIT
+  // cannot embed `method` in the code.
+  HInvokeStaticOrDirect* TryBuildCHADirectCall(HInvoke* invoke_instruction, ArtMethod* method)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Add a CHA guard for a CHA-based devirtualized call. A CHA guard checks a
   // should_deoptimize flag and if it's true, does deoptimization.
   void AddCHAGuard(HInstruction* invoke_instruction,
@@ -335,12 +359,20 @@ class HInliner : public HOptimization {
 
   // The budget left for inlining, in number of instructions.
   size_t inlining_budget_;
+
+  // The number of calls counted by the inline cache of the call site being inlined,
+  // or 0 when unknown.
+  uint32_t call_site_count_;
   VariableSizedHandleScope* const handles_;
 
   // Used to record stats about optimizations on the inlined graph.
   // If the inlining is successful, these stats are merged to the caller graph's stats.
   OptimizingCompilerStats* inline_stats_;
 
+  // The reason of the last inlining failure, for the statistics of the compiled method.
+  // Set by the const checks as well.
+  mutable MethodCompilationStat inline_failure_reason_;
+
   DISALLOW_COPY_AND_ASSIGN(HInliner);
 };
 
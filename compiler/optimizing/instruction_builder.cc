@@ -30,6 +30,7 @@
 #include "driver/compiler_options.h"
 #include "imtable-inl.h"
 #include "jit/jit.h"
+#include "jit/profiling_info.h"
 #include "mirror/dex_cache.h"
 #include "oat_file.h"
 #include "optimizing_compiler_stats.h"
@@ -65,6 +66,7 @@ HInstructionBuilder::HInstructionBuilder(HGraph* graph,
       code_generator_(code_generator),
       dex_compilation_unit_(dex_compilation_unit),
       outer_compilation_unit_(outer_compilation_unit),
+      profiling_info_(nullptr),
       quicken_info_(interpreter_metadata),
       compilation_stats_(compiler_stats),
       local_allocator_(local_allocator),
@@ -327,6 +329,17 @@ bool HInstructionBuilder::Build() {
     native_debug_info_locations = FindNativeDebugInfoLocations();
   }
 
+  // Branch counts are only recorded in the ProfilingInfo of the method, so ignore inlined methods.
+  if (code_generator_ != nullptr &&
+      code_generator_->GetCompilerOptions().ProfileBranches() &&
+      !graph_->IsCompilingBaseline() &&
+      dex_compilation_unit_ == outer_compilation_unit_ &&
+      graph_->GetArtMethod() != nullptr &&
+      !Runtime::Current()->IsAotCompiler()) {
+    ScopedObjectAccess soa(Thread::Current());
+    profiling_info_ = graph_->GetArtMethod()->GetProfilingInfo(kRuntimePointerSize);
+  }
+
   for (HBasicBlock* block : graph_->GetReversePostOrder()) {
     current_block_ = block;
     uint32_t block_dex_pc = current_block_->GetDexPc();
@@ -605,7 +618,7 @@ void HInstructionBuilder::If_22t(const Instruction& instruction, uint32_t dex_pc
   HInstruction* second = LoadLocal(instruction.VRegB(), DataType::Type::kInt32);
   T* comparison = new (allocator_) T(first, second, dex_pc);
   AppendInstruction(comparison);
-  AppendInstruction(new (allocator_) HIf(comparison, dex_pc));
+  AppendIf(new (allocator_) HIf(comparison, dex_pc), dex_pc);
   current_block_ = nullptr;
 }
 
@@ -614,10 +627,21 @@ void HInstructionBuilder::If_21t(const Instruction& instruction, uint32_t dex_pc
   HInstruction* value = LoadLocal(instruction.VRegA(), DataType::Type::kInt32);
   T* comparison = new (allocator_) T(value, graph_->GetIntConstant(0, dex_pc), dex_pc);
   AppendInstruction(comparison);
-  AppendInstruction(new (allocator_) HIf(comparison, dex_pc));
+  AppendIf(new (allocator_) HIf(comparison, dex_pc), dex_pc);
   current_block_ = nullptr;
 }
 
+void HInstructionBuilder::AppendIf(HIf* if_instr, uint32_t dex_pc) {
+  if (profiling_info_ != nullptr) {
+    BranchCache* cache = profiling_info_->GetBranchCache(dex_pc);
+    if (cache != nullptr) {
+      // The counters are updated racily by the baseline code, a stale value is fine.
+      if_instr->SetBranchCounts(cache->GetTrue(), cache->GetFalse());
+    }
+  }
+  AppendInstruction(if_instr);
+}
+
 template<typename T>
 void HInstructionBuilder::Unop_12x(const Instruction& instruction,
                                    DataType::Type type,
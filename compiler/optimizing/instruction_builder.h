@@ -39,6 +39,7 @@ class HBasicBlockBuilder;
 class Instruction;
 class InstructionOperands;
 class OptimizingCompilerStats;
+class ProfilingInfo;
 class ScopedObjectAccess;
 class SsaBuilder;
 class VariableSizedHandleScope;
@@ -125,6 +126,9 @@ class HInstructionBuilder : public ValueObject {
   template<typename T> void If_21t(const Instruction& instruction, uint32_t dex_pc);
   template<typename T> void If_22t(const Instruction& instruction, uint32_t dex_pc);
 
+  // Appends `if_instr`, with the branch counts recorded at `dex_pc` by baseline code, if any.
+  void AppendIf(HIf* if_instr, uint32_t dex_pc);
+
   void Conversion_12x(const Instruction& instruction,
                       DataType::Type input_type,
                       DataType::Type result_type,
@@ -316,6 +320,10 @@ class HInstructionBuilder : public ValueObject {
   // methods.
   const DexCompilationUnit* const outer_compilation_unit_;
 
+  // The profiling info holding the branch counts of the method, when building the graph of the
+  // outermost method for optimized JIT code.
+  ProfilingInfo* profiling_info_;
+
   // Original values kept after instruction quickening.
   QuickenInfoTable quicken_info_;
 
@@ -1014,6 +1014,7 @@ void InstructionSimplifierVisitor::VisitIf(HIf* instruction) {
     // Swap successors if input is negated.
     instruction->ReplaceInput(condition->InputAt(0), 0);
     instruction->GetBlock()->SwapSuccessors();
+    instruction->SetBranchCounts(instruction->GetFalseCount(), instruction->GetTrueCount());
     RecordSimplification();
   }
 }
@@ -2515,9 +2516,22 @@ static bool TryReplaceStringBuilderAppend(HInvoke* invoke) {
       DCHECK(!seen_constructor_fence);
       StringBuilderAppend::Argument arg;
       switch (as_invoke_virtual->GetIntrinsic()) {
-        case Intrinsics::kStringBuilderAppendObject:
-          // TODO: Unimplemented, needs to call String.valueOf().
-          return false;
+        case Intrinsics::kStringBuilderAppendObject: {
+          // Only an Object known to be a String (or null) is supported, String.valueOf()
+          // of other Objects calls arbitrary toString() code.
+          ReferenceTypeInfo rti = user->AsInvokeVirtual()->InputAt(1)->GetReferenceTypeInfo();
+          if (!rti.IsValid()) {
+            return false;
+          }
+          ScopedObjectAccess soa(Thread::Current());
+          Handle<mirror::Class> input_type = rti.GetTypeHandle();
+          DCHECK(input_type != nullptr);
+          if (input_type.Get() != GetClassRoot<mirror::String>()) {
+            return false;
+          }
+          arg = StringBuilderAppend::Argument::kString;
+          break;
+        }
         case Intrinsics::kStringBuilderAppendString:
           arg = StringBuilderAppend::Argument::kString;
           break;
@@ -2557,9 +2571,11 @@ static bool TryReplaceStringBuilderAppend(HInvoke* invoke) {
           break;
         }
         case Intrinsics::kStringBuilderAppendFloat:
+          arg = StringBuilderAppend::Argument::kFloat;
+          break;
         case Intrinsics::kStringBuilderAppendDouble:
-          // TODO: Unimplemented, needs to call FloatingDecimal.getBinaryToASCIIConverter().
-          return false;
+          arg = StringBuilderAppend::Argument::kDouble;
+          break;
         default: {
           return false;
         }
@@ -52,6 +52,7 @@ using helpers::LocationFrom;
 using helpers::OperandFrom;
 using helpers::RegisterFrom;
 using helpers::SRegisterFrom;
+using helpers::VRegisterFrom;
 using helpers::WRegisterFrom;
 using helpers::XRegisterFrom;
 using helpers::HRegisterFrom;
@@ -1426,6 +1427,13 @@ void IntrinsicLocationsBuilderARM64::VisitStringEquals(HInvoke* invoke) {
   if (const_string == nullptr || const_string_length > (is_compressed ? 8u : 4u)) {
     locations->AddTemp(Location::RequiresRegister());
   }
+  // The generic implementation compares 16 bytes at a time in vector registers.
+  if (const_string == nullptr ||
+      const_string_length > (is_compressed ? kShortConstStringEqualsCutoffInBytes
+                                           : kShortConstStringEqualsCutoffInBytes / 2u)) {
+    locations->AddTemp(Location::RequiresFpuRegister());
+    locations->AddTemp(Location::RequiresFpuRegister());
+  }
 
   // TODO: If the String.equals() is used only for an immediately following HIf, we can
   // mark it as emitted-at-use-site and emit branches directly to the appropriate blocks.
@@ -1571,16 +1579,32 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
 
     temp1 = temp1.X();
     Register temp2 = XRegisterFrom(locations->GetTemp(0));
-    // Loop to compare strings 8 bytes at a time starting at the front of the string.
+    VRegister str_data = VRegisterFrom(locations->GetTemp(1));
+    VRegister arg_data = VRegisterFrom(locations->GetTemp(2));
+    vixl::aarch64::Label last_8_bytes;
+    // Loop to compare strings 16 bytes at a time starting at the front of the string, as long
+    // as more than 8 bytes remain. The strings are only zero padded to 8 bytes, so the last
+    // 8 bytes are compared on their own.
     __ Bind(&loop);
+    // With string compression, `temp` counts bytes, otherwise chars.
+    __ Cmp(temp, Operand(mirror::kUseStringCompression ? 8 : 4));
+    __ B(&last_8_bytes, ls);
+    __ Ldr(str_data.Q(), MemOperand(str.X(), temp1));
+    __ Ldr(arg_data.Q(), MemOperand(arg.X(), temp1));
+    __ Add(temp1, temp1, Operand(2u * sizeof(uint64_t)));
+    __ Eor(str_data.V16B(), str_data.V16B(), arg_data.V16B());
+    __ Umaxv(str_data.S(), str_data.V4S());
+    __ Umov(out.W(), str_data.V4S(), 0);
+    __ Cbnz(out, &return_false);
+    __ Sub(temp, temp, Operand(mirror::kUseStringCompression ? 16 : 8), SetFlags);
+    __ B(&loop, hi);
+    __ B(&return_true);
+
+    __ Bind(&last_8_bytes);
     __ Ldr(out, MemOperand(str.X(), temp1));
     __ Ldr(temp2, MemOperand(arg.X(), temp1));
-    __ Add(temp1, temp1, Operand(sizeof(uint64_t)));
     __ Cmp(out, temp2);
     __ B(&return_false, ne);
-    // With string compression, we have compared 8 bytes, otherwise 4 chars.
-    __ Sub(temp, temp, Operand(mirror::kUseStringCompression ? 8 : 4), SetFlags);
-    __ B(&loop, hi);
   }
 
   // Return true and exit the function.
@@ -1595,6 +1619,32 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
   __ Bind(&end);
 }
 
+void IntrinsicLocationsBuilderARM64::VisitStringHashCode(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  // The slow path needs the receiver after the output is written.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitStringHashCode(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+
+  Register str = InputRegisterAt(invoke, 0);
+  Register out = OutputRegister(invoke);
+
+  // Note that the null check must have been done earlier.
+  DCHECK(!invoke->CanDoImplicitNullCheckOn(invoke->InputAt(0)));
+
+  // Return the cached hash code. If it is not computed yet, call String.hashCode().
+  SlowPathCodeARM64* slow_path =
+      new (codegen_->GetScopedAllocator()) IntrinsicSlowPathARM64(invoke);
+  codegen_->AddSlowPath(slow_path);
+  __ Ldr(out, HeapOperand(str, mirror::String::HashCodeOffset()));
+  __ Cbz(out, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 static void GenerateVisitStringIndexOf(HInvoke* invoke,
                                        MacroAssembler* masm,
                                        CodeGeneratorARM64* codegen,
@@ -2061,9 +2111,9 @@ void IntrinsicCodeGeneratorARM64::VisitStringGetCharsNoCheck(HInvoke* invoke) {
   __ Bind(&done);
 }
 
-// Mirrors ARRAYCOPY_SHORT_CHAR_ARRAY_THRESHOLD in libcore, so we can choose to use the native
-// implementation there for longer copy lengths.
-static constexpr int32_t kSystemArrayCopyCharThreshold = 32;
+// Mirrors the ARRAYCOPY_SHORT_{BYTE,CHAR,INT}_ARRAY_THRESHOLD constants in libcore, so we can
+// choose to use the native implementation there for longer copy lengths.
+static constexpr int32_t kSystemArrayCopyPrimitiveThreshold = 32;
 
 static void SetSystemArrayCopyLocationRequires(LocationSummary* locations,
                                                uint32_t at,
@@ -2076,7 +2126,7 @@ static void SetSystemArrayCopyLocationRequires(LocationSummary* locations,
   }
 }
 
-void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+static void CreateSystemArrayCopyPrimitiveLocations(HInvoke* invoke) {
   // Check to see if we have known failures that will cause us to have to bail out
   // to the runtime, and just generate the runtime call directly.
   HIntConstant* src_pos = invoke->InputAt(1)->AsIntConstant();
@@ -2094,7 +2144,7 @@ void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   HIntConstant* length = invoke->InputAt(4)->AsIntConstant();
   if (length != nullptr) {
     int32_t len = length->GetValue();
-    if (len < 0 || len > kSystemArrayCopyCharThreshold) {
+    if (len < 0 || len > kSystemArrayCopyPrimitiveThreshold) {
       // Just call as normal.
       return;
     }
@@ -2103,7 +2153,7 @@ void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   ArenaAllocator* allocator = invoke->GetBlock()->GetGraph()->GetAllocator();
   LocationSummary* locations =
       new (allocator) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
-  // arraycopy(char[] src, int src_pos, char[] dst, int dst_pos, int length).
+  // arraycopy(T[] src, int src_pos, T[] dst, int dst_pos, int length) for a primitive T.
   locations->SetInAt(0, Location::RequiresRegister());
   SetSystemArrayCopyLocationRequires(locations, 1, invoke->InputAt(1));
   locations->SetInAt(2, Location::RequiresRegister());
@@ -2115,6 +2165,18 @@ void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   locations->AddTemp(Location::RequiresRegister());
 }
 
+void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyByte(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(invoke);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(invoke);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyInt(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(invoke);
+}
+
 static void CheckSystemArrayCopyPosition(MacroAssembler* masm,
                                          const Location& pos,
                                          const Register& input,
@@ -2172,8 +2234,11 @@ static void GenSystemArrayCopyAddresses(MacroAssembler* masm,
                                         const Register& src_base,
                                         const Register& dst_base,
                                         const Register& src_end) {
-  // This routine is used by the SystemArrayCopy and the SystemArrayCopyChar intrinsics.
-  DCHECK(type == DataType::Type::kReference || type == DataType::Type::kUint16)
+  // This routine is used by the SystemArrayCopy and the primitive SystemArrayCopy* intrinsics.
+  DCHECK(type == DataType::Type::kReference ||
+         type == DataType::Type::kInt8 ||
+         type == DataType::Type::kUint16 ||
+         type == DataType::Type::kInt32)
       << "Unexpected element type: " << type;
   const int32_t element_size = DataType::Size(type);
   const int32_t element_size_shift = DataType::SizeShift(type);
@@ -2203,8 +2268,10 @@ static void GenSystemArrayCopyAddresses(MacroAssembler* masm,
   }
 }
 
-void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
-  MacroAssembler* masm = GetVIXLAssembler();
+static void GenSystemArrayCopyPrimitive(HInvoke* invoke,
+                                        CodeGeneratorARM64* codegen,
+                                        DataType::Type type) {
+  MacroAssembler* masm = codegen->GetVIXLAssembler();
   LocationSummary* locations = invoke->GetLocations();
   Register src = XRegisterFrom(locations->InAt(0));
   Location src_pos = locations->InAt(1);
@@ -2213,8 +2280,8 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   Location length = locations->InAt(4);
 
   SlowPathCodeARM64* slow_path =
-      new (codegen_->GetScopedAllocator()) IntrinsicSlowPathARM64(invoke);
-  codegen_->AddSlowPath(slow_path);
+      new (codegen->GetScopedAllocator()) IntrinsicSlowPathARM64(invoke);
+  codegen->AddSlowPath(slow_path);
 
   // If source and destination are the same, take the slow path. Overlapping copy regions must be
   // copied in reverse and we can't know in all cases if it's needed.
@@ -2231,12 +2298,13 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
     // Merge the following two comparisons into one:
     //   If the length is negative, bail out (delegate to libcore's native implementation).
     //   If the length > 32 then (currently) prefer libcore's native implementation.
-    __ Cmp(WRegisterFrom(length), kSystemArrayCopyCharThreshold);
+    __ Cmp(WRegisterFrom(length), kSystemArrayCopyPrimitiveThreshold);
     __ B(slow_path->GetEntryLabel(), hi);
   } else {
     // We have already checked in the LocationsBuilder for the constant case.
     DCHECK_GE(length.GetConstant()->AsIntConstant()->GetValue(), 0);
-    DCHECK_LE(length.GetConstant()->AsIntConstant()->GetValue(), 32);
+    DCHECK_LE(length.GetConstant()->AsIntConstant()->GetValue(),
+              kSystemArrayCopyPrimitiveThreshold);
   }
 
   Register src_curr_addr = WRegisterFrom(locations->GetTemp(0));
@@ -2264,7 +2332,7 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   src_stop_addr = src_stop_addr.X();
 
   GenSystemArrayCopyAddresses(masm,
-                              DataType::Type::kUint16,
+                              type,
                               src,
                               src_pos,
                               dst,
@@ -2274,22 +2342,51 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
                               dst_curr_addr,
                               src_stop_addr);
 
-  // Iterate over the arrays and do a raw copy of the chars.
-  const int32_t char_size = DataType::Size(DataType::Type::kUint16);
+  // Iterate over the arrays and do a raw copy of the elements.
+  const int32_t element_size = DataType::Size(type);
   UseScratchRegisterScope temps(masm);
   Register tmp = temps.AcquireW();
   vixl::aarch64::Label loop, done;
   __ Bind(&loop);
   __ Cmp(src_curr_addr, src_stop_addr);
   __ B(&done, eq);
-  __ Ldrh(tmp, MemOperand(src_curr_addr, char_size, PostIndex));
-  __ Strh(tmp, MemOperand(dst_curr_addr, char_size, PostIndex));
+  MemOperand src_operand(src_curr_addr, element_size, PostIndex);
+  MemOperand dst_operand(dst_curr_addr, element_size, PostIndex);
+  switch (type) {
+    case DataType::Type::kInt8:
+      __ Ldrb(tmp, src_operand);
+      __ Strb(tmp, dst_operand);
+      break;
+    case DataType::Type::kUint16:
+      __ Ldrh(tmp, src_operand);
+      __ Strh(tmp, dst_operand);
+      break;
+    case DataType::Type::kInt32:
+      __ Ldr(tmp, src_operand);
+      __ Str(tmp, dst_operand);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected element type: " << type;
+      UNREACHABLE();
+  }
   __ B(&loop);
   __ Bind(&done);
 
   __ Bind(slow_path->GetExitLabel());
 }
 
+void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyByte(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(invoke, codegen_, DataType::Type::kInt8);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(invoke, codegen_, DataType::Type::kUint16);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyInt(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(invoke, codegen_, DataType::Type::kInt32);
+}
+
 // We can choose to use the native implementation there for longer copy lengths.
 static constexpr int32_t kSystemArrayCopyThreshold = 128;
 
@@ -3006,16 +3103,21 @@ void IntrinsicCodeGeneratorARM64::VisitCRC32Update(HInvoke* invoke) {
 //   crc    - a register holding an initial CRC value
 //   ptr    - a register holding a memory address of bytes
 //   length - a register holding a number of bytes to process
+//   temp   - a temporary register
 //   out    - a register to put a result of calculation
 static void GenerateCodeForCalculationCRC32ValueOfBytes(MacroAssembler* masm,
                                                         const Register& crc,
                                                         const Register& ptr,
                                                         const Register& length,
+                                                        const Register& temp,
                                                         const Register& out) {
   // The algorithm of CRC32 of bytes is:
   //   crc = ~crc
   //   process a few first bytes to make the array 8-byte aligned
-  //   while array has 8 bytes do:
+  //   while array has 16 bytes do:
+  //     crc = crc32_of_8bytes(crc, 8_bytes(array))
+  //     crc = crc32_of_8bytes(crc, next_8_bytes(array))
+  //   if array has 8 bytes:
   //     crc = crc32_of_8bytes(crc, 8_bytes(array))
   //   if array has 4 bytes:
   //     crc = crc32_of_4bytes(crc, 4_bytes(array))
@@ -3026,7 +3128,7 @@ static void GenerateCodeForCalculationCRC32ValueOfBytes(MacroAssembler* masm,
   //   crc = ~crc
 
   vixl::aarch64::Label loop, done;
-  vixl::aarch64::Label process_4bytes, process_2bytes, process_1byte;
+  vixl::aarch64::Label process_8bytes, process_4bytes, process_2bytes, process_1byte;
   vixl::aarch64::Label aligned2, aligned4, aligned8;
 
   // Use VIXL scratch registers as the VIXL macro assembler won't use them in
@@ -3059,27 +3161,36 @@ static void GenerateCodeForCalculationCRC32ValueOfBytes(MacroAssembler* masm,
   __ Crc32w(out, out, array_elem);
 
   __ Bind(&aligned8);
-  __ Subs(len, len, 8);
-  // If len < 8 go to process data by 4 bytes, 2 bytes and a byte.
-  __ B(&process_4bytes, lo);
+  __ Subs(len, len, 16);
+  // If len < 16 go to process data by 8 bytes, 4 bytes, 2 bytes and a byte.
+  __ B(&process_8bytes, lo);
 
-  // The main loop processing data by 8 bytes.
+  // The main loop processing data by 16 bytes. A load pair halves the number
+  // of loads and loop iterations compared to loading 8 bytes at a time.
   __ Bind(&loop);
-  __ Ldr(array_elem.X(), MemOperand(ptr, 8, PostIndex));
-  __ Subs(len, len, 8);
+  __ Ldp(array_elem.X(), temp.X(), MemOperand(ptr, 16, PostIndex));
+  __ Subs(len, len, 16);
   __ Crc32x(out, out, array_elem.X());
-  // if len >= 8, process the next 8 bytes.
+  __ Crc32x(out, out, temp.X());
+  // if len >= 16, process the next 16 bytes.
   __ B(&loop, hs);
 
-  // Process the data which is less than 8 bytes.
+  // Process the data which is less than 16 bytes.
   // The code generated below works with values of len
-  // which come in the range [-8, 0].
-  // The first three bits are used to detect whether 4 bytes or 2 bytes or
-  // a byte can be processed.
-  // The checking order is from bit 2 to bit 0:
+  // which come in the range [-16, -1].
+  // The first four bits are used to detect whether 8 bytes or 4 bytes or
+  // 2 bytes or a byte can be processed.
+  // The checking order is from bit 3 to bit 0:
+  //  bit 3 is set: at least 8 bytes available
   //  bit 2 is set: at least 4 bytes available
   //  bit 1 is set: at least 2 bytes available
   //  bit 0 is set: at least a byte available
+  __ Bind(&process_8bytes);
+  // Goto process_4bytes if less than eight bytes available
+  __ Tbz(len, 3, &process_4bytes);
+  __ Ldr(array_elem.X(), MemOperand(ptr, 8, PostIndex));
+  __ Crc32x(out, out, array_elem.X());
+
   __ Bind(&process_4bytes);
   // Goto process_2bytes if less than four bytes available
   __ Tbz(len, 2, &process_2bytes);
@@ -3121,6 +3232,7 @@ void IntrinsicLocationsBuilderARM64::VisitCRC32UpdateBytes(HInvoke* invoke) {
   locations->SetInAt(2, Location::RegisterOrConstant(invoke->InputAt(2)));
   locations->SetInAt(3, Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
   locations->SetOut(Location::RequiresRegister());
 }
 
@@ -3155,9 +3267,10 @@ void IntrinsicCodeGeneratorARM64::VisitCRC32UpdateBytes(HInvoke* invoke) {
   }
 
   Register crc = WRegisterFrom(locations->InAt(0));
+  Register temp = XRegisterFrom(locations->GetTemp(1));
   Register out = WRegisterFrom(locations->Out());
 
-  GenerateCodeForCalculationCRC32ValueOfBytes(masm, crc, ptr, length, out);
+  GenerateCodeForCalculationCRC32ValueOfBytes(masm, crc, ptr, length, temp, out);
 
   __ Bind(slow_path->GetExitLabel());
 }
@@ -3177,6 +3290,7 @@ void IntrinsicLocationsBuilderARM64::VisitCRC32UpdateByteBuffer(HInvoke* invoke)
   locations->SetInAt(2, Location::RequiresRegister());
   locations->SetInAt(3, Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
   locations->SetOut(Location::RequiresRegister());
 }
 
@@ -3201,8 +3315,9 @@ void IntrinsicCodeGeneratorARM64::VisitCRC32UpdateByteBuffer(HInvoke* invoke) {
 
   Register crc = WRegisterFrom(locations->InAt(0));
   Register length = WRegisterFrom(locations->InAt(3));
+  Register temp = XRegisterFrom(locations->GetTemp(1));
   Register out = WRegisterFrom(locations->Out());
-  GenerateCodeForCalculationCRC32ValueOfBytes(masm, crc, ptr, length, out);
+  GenerateCodeForCalculationCRC32ValueOfBytes(masm, crc, ptr, length, temp, out);
 }
 
 void IntrinsicLocationsBuilderARM64::VisitFP16ToFloat(HInvoke* invoke) {
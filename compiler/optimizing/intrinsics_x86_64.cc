@@ -1235,12 +1235,13 @@ void IntrinsicLocationsBuilderX86_64::VisitStringEquals(HInvoke* invoke) {
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RequiresRegister());
 
-  // Request temporary registers, RCX and RDI needed for repe_cmpsq instruction.
+  // Request temporary registers, RCX needed for jrcxz instruction.
   locations->AddTemp(Location::RegisterLocation(RCX));
-  locations->AddTemp(Location::RegisterLocation(RDI));
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 
-  // Set output, RSI needed for repe_cmpsq instruction anyways.
-  locations->SetOut(Location::RegisterLocation(RSI), Location::kOutputOverlap);
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 }
 
 void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
@@ -1250,8 +1251,10 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   CpuRegister str = locations->InAt(0).AsRegister<CpuRegister>();
   CpuRegister arg = locations->InAt(1).AsRegister<CpuRegister>();
   CpuRegister rcx = locations->GetTemp(0).AsRegister<CpuRegister>();
-  CpuRegister rdi = locations->GetTemp(1).AsRegister<CpuRegister>();
-  CpuRegister rsi = locations->Out().AsRegister<CpuRegister>();
+  CpuRegister offset = locations->GetTemp(1).AsRegister<CpuRegister>();
+  XmmRegister str_data = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+  XmmRegister arg_data = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
 
   NearLabel end, return_true, return_false;
 
@@ -1316,9 +1319,8 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
     __ shrl(rcx, Immediate(1));
     __ Bind(&string_uncompressed);
   }
-  // Load starting addresses of string values into RSI/RDI as required for repe_cmpsq instruction.
-  __ leal(rsi, Address(str, value_offset));
-  __ leal(rdi, Address(arg, value_offset));
+  // Load offset of string values in preparation for the comparison loop.
+  __ movl(offset, Immediate(value_offset));
 
   // Divide string length by 4 and adjust for lengths not divisible by 4.
   __ addl(rcx, Immediate(3));
@@ -1329,23 +1331,68 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   DCHECK_ALIGNED(value_offset, 8);
   static_assert(IsAligned<8>(kObjectAlignment), "String is not zero padded");
 
-  // Loop to compare strings four characters at a time starting at the beginning of the string.
-  __ repe_cmpsq();
-  // If strings are not equal, zero flag will be cleared.
+  // Loop to compare strings 16 bytes at a time starting at the beginning of the string,
+  // as long as at least two quadwords remain. The last quadword is compared on its own,
+  // so that the loads do not go past the zero padding of the strings.
+  NearLabel loop, last_quadword;
+  __ Bind(&loop);
+  __ cmpl(rcx, Immediate(2));
+  __ j(kLess, &last_quadword);
+  __ movdqu(str_data, Address(str, offset, TIMES_1, 0));
+  __ movdqu(arg_data, Address(arg, offset, TIMES_1, 0));
+  __ pcmpeqb(str_data, arg_data);
+  __ pmovmskb(out, str_data);
+  __ cmpl(out, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ addl(offset, Immediate(2 * sizeof(uint64_t)));
+  __ subl(rcx, Immediate(2));
+  __ jmp(&loop);
+
+  __ Bind(&last_quadword);
+  __ jrcxz(&return_true);
+  __ movq(out, Address(str, offset, TIMES_1, 0));
+  __ cmpq(out, Address(arg, offset, TIMES_1, 0));
   __ j(kNotEqual, &return_false);
 
   // Return true and exit the function.
   // If loop does not result in returning false, we return true.
   __ Bind(&return_true);
-  __ movl(rsi, Immediate(1));
+  __ movl(out, Immediate(1));
   __ jmp(&end);
 
   // Return false and exit the function.
   __ Bind(&return_false);
-  __ xorl(rsi, rsi);
+  __ xorl(out, out);
   __ Bind(&end);
 }
 
+void IntrinsicLocationsBuilderX86_64::VisitStringHashCode(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  // The slow path needs the receiver after the output is written.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitStringHashCode(HInvoke* invoke) {
+  X86_64Assembler* assembler = GetAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister str = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+
+  // Note that the null check must have been done earlier.
+  DCHECK(!invoke->CanDoImplicitNullCheckOn(invoke->InputAt(0)));
+
+  // Return the cached hash code. If it is not computed yet, call String.hashCode().
+  SlowPathCode* slow_path = new (codegen_->GetScopedAllocator()) IntrinsicSlowPathX86_64(invoke);
+  codegen_->AddSlowPath(slow_path);
+  __ movl(out, Address(str, mirror::String::HashCodeOffset().Int32Value()));
+  __ testl(out, out);
+  __ j(kEqual, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 static void CreateStringIndexOfLocations(HInvoke* invoke,
                                          ArenaAllocator* allocator,
                                          bool start_at_zero) {
@@ -2745,6 +2792,8 @@ void IntrinsicCodeGeneratorX86_64::VisitReachabilityFence(HInvoke* invoke ATTRIB
 UNIMPLEMENTED_INTRINSIC(X86_64, ReferenceGetReferent)
 UNIMPLEMENTED_INTRINSIC(X86_64, FloatIsInfinite)
 UNIMPLEMENTED_INTRINSIC(X86_64, DoubleIsInfinite)
+UNIMPLEMENTED_INTRINSIC(X86_64, SystemArrayCopyByte)
+UNIMPLEMENTED_INTRINSIC(X86_64, SystemArrayCopyInt)
 UNIMPLEMENTED_INTRINSIC(X86_64, CRC32Update)
 UNIMPLEMENTED_INTRINSIC(X86_64, CRC32UpdateBytes)
 UNIMPLEMENTED_INTRINSIC(X86_64, CRC32UpdateByteBuffer)
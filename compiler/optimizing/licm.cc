@@ -99,7 +99,6 @@ bool LICM::Run() {
     }
 
     HLoopInformation* loop_info = block->GetLoopInformation();
-    SideEffects loop_effects = side_effects_.GetLoopEffects(block);
     HBasicBlock* pre_header = loop_info->GetPreHeader();
 
     for (HBlocksInLoopIterator it_loop(*loop_info); !it_loop.Done(); it_loop.Advance()) {
@@ -140,11 +139,11 @@ bool LICM::Run() {
                 // in the loop header so far have been hoisted out, we can hoist
                 // the clinit check out also.
                 can_move = true;
-              } else if (!instruction->GetSideEffects().MayDependOn(loop_effects)) {
+              } else if (!side_effects_.MayDependOnLoopWrites(instruction, loop_info)) {
                 can_move = true;
               }
             }
-          } else if (!instruction->GetSideEffects().MayDependOn(loop_effects)) {
+          } else if (!side_effects_.MayDependOnLoopWrites(instruction, loop_info)) {
             can_move = true;
           }
         }
@@ -31,6 +31,10 @@ namespace art {
 // Enables vectorization (SIMDization) in the loop optimizer.
 static constexpr bool kEnableVectorization = true;
 
+// Upper bound on the number of instructions (trip count times body size) that an inner loop
+// may execute without polling for suspension at its back edge.
+static constexpr uint64_t kMaxInstructionsWithoutSuspendCheck = 1024;
+
 //
 // Static helpers.
 //
@@ -483,6 +487,7 @@ HLoopOptimization::HLoopOptimization(HGraph* graph,
       vector_header_(nullptr),
       vector_body_(nullptr),
       vector_index_(nullptr),
+      vector_tail_(false),
       arch_loop_helper_(ArchNoOptsLoopHelper::Create(compiler_options_ != nullptr
                                                           ? compiler_options_->GetInstructionSet()
                                                           : InstructionSet::kNone,
@@ -628,6 +633,7 @@ bool HLoopOptimization::TraverseLoopsInnerToOuter(LoopNode* node) {
     } while (simplified_);
     // Optimize inner loop.
     if (node->inner == nullptr) {
+      TryToNoOpSuspendCheck(node);
       changed = OptimizeInnerLoop(node) || changed;
     }
   }
@@ -917,6 +923,34 @@ bool HLoopOptimization::TryPeelingAndUnrolling(LoopNode* node) {
          TryUnrollingForBranchPenaltyReduction(&analysis_info);
 }
 
+void HLoopOptimization::TryToNoOpSuspendCheck(LoopNode* node) {
+  if (!graph_->SuspendChecksAreAllowedToNoOp()) {
+    return;
+  }
+  HLoopInformation* loop_info = node->loop_info;
+  HSuspendCheck* suspend_check = loop_info->GetSuspendCheck();
+  if (suspend_check->IsNoOp()) {
+    return;
+  }
+  int64_t trip_count = LoopAnalysis::GetLoopTripCount(loop_info, &induction_range_);
+  if (trip_count == LoopAnalysisInfo::kUnknownTripCount ||
+      static_cast<uint64_t>(trip_count) > kMaxInstructionsWithoutSuspendCheck) {
+    return;
+  }
+  LoopAnalysisInfo analysis_info(loop_info);
+  LoopAnalysis::CalculateLoopBasicProperties(loop_info, &analysis_info, trip_count);
+  // Calls and allocations may take arbitrarily long; keep polling around them.
+  if (analysis_info.HasInstructionsPreventingScalarOpts() ||
+      static_cast<uint64_t>(trip_count) * analysis_info.GetNumberOfInstructions() >
+          kMaxInstructionsWithoutSuspendCheck) {
+    return;
+  }
+  // The loop runs a bounded number of cheap iterations, so the suspend checks before and after
+  // it are enough to keep time-to-safepoint short.
+  suspend_check->SetIsNoOp(true);
+  MaybeRecordStat(stats_, MethodCompilationStat::kLoopSuspendCheckNoOp);
+}
+
 //
 // Loop vectorization. The implementation is based on the book by Aart J.C. Bik:
 // "The Software Vectorization Handbook. Applying Multimedia Extensions for Maximum Performance."
@@ -1108,6 +1142,7 @@ void HLoopOptimization::Vectorize(LoopNode* node,
   // i = 0;
   HInstruction* stc = induction_range_.GenerateTripCount(node->loop_info, graph_, preheader);
   HInstruction* vtc = stc;
+  HInstruction* rem = nullptr;
   if (needs_cleanup) {
     DCHECK(IsPowerOfTwo(chunk));
     HInstruction* diff = stc;
@@ -1118,7 +1153,7 @@ void HLoopOptimization::Vectorize(LoopNode* node,
       }
       diff = Insert(preheader, new (global_allocator_) HSub(induc_type, stc, ptc));
     }
-    HInstruction* rem = Insert(
+    rem = Insert(
         preheader, new (global_allocator_) HAnd(induc_type,
                                                 diff,
                                                 graph_->GetConstant(induc_type, chunk - 1)));
@@ -1169,6 +1204,43 @@ void HLoopOptimization::Vectorize(LoopNode* node,
                   unroll);
   HLoopInformation* vloop = vector_header_->GetLoopInformation();
 
+  // Generate overlapping vector tail, if possible, which executes the remainder
+  // iterations as one vector iteration ending at the trip count, re-executing
+  // some iterations of the vector loop, rather than in the cleanup loop:
+  // ok  = stc >= VL && rem != 0 && a != b ...;
+  // tlo = ok ? stc - VL : vtc;
+  // thi = ok ? stc : vtc;
+  // for (i = tlo; i < thi; i += VL)
+  //    <vectorized-loop-body>
+  ScopedArenaVector<std::pair<HInstruction*, HInstruction*>> tail_tests(
+      loop_allocator_->Adapter(kArenaAllocLoopOptimization));
+  if (rem != nullptr && chunk == vector_length_ && CanOverlapVectorTail(&tail_tests)) {
+    HInstruction* vl = graph_->GetConstant(induc_type, vector_length_);
+    HInstruction* tail_lo = Insert(preheader, new (global_allocator_) HSub(induc_type, stc, vl));
+    HInstruction* tail_hi = stc;
+    ScopedArenaVector<HInstruction*> conds(loop_allocator_->Adapter(kArenaAllocLoopOptimization));
+    conds.push_back(Insert(preheader, new (global_allocator_) HGreaterThanOrEqual(stc, vl)));
+    conds.push_back(Insert(preheader, new (global_allocator_) HNotEqual(
+        rem, graph_->GetConstant(induc_type, 0))));
+    for (const std::pair<HInstruction*, HInstruction*>& test : tail_tests) {
+      conds.push_back(Insert(preheader, new (global_allocator_) HNotEqual(test.first, test.second)));
+    }
+    for (HInstruction* cond : conds) {
+      tail_lo = Insert(preheader, new (global_allocator_) HSelect(cond, tail_lo, vtc, kNoDexPc));
+      tail_hi = Insert(preheader, new (global_allocator_) HSelect(cond, tail_hi, vtc, kNoDexPc));
+    }
+    vector_tail_ = true;
+    GenerateNewLoop(node,
+                    block,
+                    graph_->TransformLoopForVectorization(vector_header_, vector_body_, exit),
+                    tail_lo,
+                    tail_hi,
+                    vl,
+                    LoopAnalysisInfo::kNoUnrollingFactor);
+    vector_tail_ = false;
+    MaybeRecordStat(stats_, MethodCompilationStat::kLoopVectorizedTail);
+  }
+
   // Generate cleanup loop, if needed:
   // for ( ; i < stc; i += 1)
   //    <loop-body>
@@ -1210,6 +1282,40 @@ void HLoopOptimization::Vectorize(LoopNode* node,
   node->loop_info = vloop;
 }
 
+// Returns whether the vector loop body can be executed again on iterations it
+// already executed, as needed by the overlapping vector tail. This holds when the
+// body has no reductions and no array it writes is also read, since values are
+// then only recomputed from unchanged inputs. Arrays that may be the same at
+// runtime are returned in `runtime_tests`, to be tested for inequality.
+bool HLoopOptimization::CanOverlapVectorTail(
+    /*out*/ ScopedArenaVector<std::pair<HInstruction*, HInstruction*>>* runtime_tests) {
+  static constexpr size_t kMaxRuntimeTests = 2;
+  if (!reductions_->empty() || vector_runtime_test_a_ != nullptr) {
+    return false;
+  }
+  for (const ArrayReference& def : *vector_refs_) {
+    if (!def.lhs) {
+      continue;
+    }
+    for (const ArrayReference& use : *vector_refs_) {
+      if (use.lhs || DataType::Size(def.type) != DataType::Size(use.type)) {
+        continue;  // arrays of different component types never alias
+      }
+      if (def.base == use.base) {
+        return false;
+      }
+      std::pair<HInstruction*, HInstruction*> test(def.base, use.base);
+      if (std::find(runtime_tests->begin(), runtime_tests->end(), test) == runtime_tests->end()) {
+        if (runtime_tests->size() == kMaxRuntimeTests) {
+          return false;
+        }
+        runtime_tests->push_back(test);
+      }
+    }
+  }
+  return true;
+}
+
 void HLoopOptimization::GenerateNewLoop(LoopNode* node,
                                         HBasicBlock* block,
                                         HBasicBlock* new_preheader,
@@ -1738,8 +1844,12 @@ void HLoopOptimization::GenerateVecMem(HInstruction* org,
                                                 is_string_char_at,
                                                 dex_pc);
     }
-    // Known (forced/adjusted/original) alignment?
-    if (vector_dynamic_peeling_candidate_ != nullptr) {
+    // Known (forced/adjusted/original) alignment? The overlapping vector tail
+    // keeps the natural alignment, since it does not start at a multiple of VL.
+    if (vector_tail_) {
+      vector->AsVecMemoryOperation()->SetAlignment(  // natural
+          Alignment(DataType::Size(type), 0));
+    } else if (vector_dynamic_peeling_candidate_ != nullptr) {
       if (vector_dynamic_peeling_candidate_->offset == offset &&  // TODO: diffs too?
           DataType::Size(vector_dynamic_peeling_candidate_->type) == DataType::Size(type) &&
           vector_dynamic_peeling_candidate_->is_string_char_at == is_string_char_at) {
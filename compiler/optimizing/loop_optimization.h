@@ -165,6 +165,10 @@ class HLoopOptimization : public HOptimization {
   // Tries to apply scalar loop peeling and unrolling.
   bool TryPeelingAndUnrolling(LoopNode* node);
 
+  // Turns the suspend check of a short inner loop into a no-op. Does not change the graph
+  // structure, so induction information stays valid.
+  void TryToNoOpSuspendCheck(LoopNode* node);
+
   //
   // Vectorization analysis and synthesis.
   //
@@ -178,6 +182,8 @@ class HLoopOptimization : public HOptimization {
                        HInstruction* hi,
                        HInstruction* step,
                        uint32_t unroll);
+  bool CanOverlapVectorTail(
+      /*out*/ ScopedArenaVector<std::pair<HInstruction*, HInstruction*>>* runtime_tests);
   bool VectorizeDef(LoopNode* node, HInstruction* instruction, bool generate_code);
   bool VectorizeUse(LoopNode* node,
                     HInstruction* instruction,
@@ -325,6 +331,7 @@ class HLoopOptimization : public HOptimization {
   HBasicBlock* vector_header_;  // header of the new loop
   HBasicBlock* vector_body_;  // body of the new loop
   HInstruction* vector_index_;  // normalized index of the new loop
+  bool vector_tail_;  // new loop is the overlapping vector tail
 
   // Helper for target-specific behaviour for loop optimizations.
   ArchNoOptsLoopHelper* arch_loop_helper_;
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "method_compilation_stats.h"
+
+#include <ostream>
+#include <sstream>
+
+#include "android-base/stringprintf.h"
+
+#include "base/time_utils.h"
+#include "nodes.h"
+
+namespace art {
+
+// Writes `value` as a JSON string.
+static void DumpJsonString(std::ostream& os, const std::string& value) {
+  os << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20u) {
+      os << android::base::StringPrintf("\\u%04x", static_cast<unsigned>(c));
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+
+static std::string StatName(MethodCompilationStat stat) {
+  std::ostringstream oss;
+  oss << stat;
+  return oss.str();
+}
+
+static size_t CountInstructions(const HGraph* graph, /*out*/ size_t* number_of_blocks) {
+  size_t number_of_instructions = 0u;
+  *number_of_blocks = 0u;
+  for (HBasicBlock* block : graph->GetBlocks()) {
+    if (block == nullptr) {
+      continue;
+    }
+    ++*number_of_blocks;
+    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
+      ++number_of_instructions;
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      ++number_of_instructions;
+    }
+  }
+  return number_of_instructions;
+}
+
+MethodCompilationStats::MethodCompilationStats(CompilationKind compilation_kind,
+                                               OptimizingCompilerStats* global_stats)
+    : compilation_kind_(compilation_kind),
+      global_stats_(global_stats),
+      counters_(this),
+      start_ns_(NanoTime()),
+      passes_(),
+      inlining_decisions_(),
+      number_of_blocks_(0u),
+      number_of_instructions_(0u),
+      code_size_(0u) {}
+
+MethodCompilationStats::~MethodCompilationStats() {
+  if (global_stats_ != nullptr) {
+    counters_.AddTo(global_stats_);
+  }
+}
+
+void MethodCompilationStats::RecordPass(const char* pass_name,
+                                        uint64_t duration_ns,
+                                        const HGraph* graph) {
+  size_t number_of_blocks;
+  passes_.push_back({pass_name, duration_ns, CountInstructions(graph, &number_of_blocks)});
+}
+
+void MethodCompilationStats::RecordInliningDecision(const std::string& callee_name,
+                                                    bool inlined,
+                                                    MethodCompilationStat reason) {
+  inlining_decisions_.push_back({callee_name, inlined, reason});
+}
+
+void MethodCompilationStats::RecordCode(const HGraph* graph, size_t code_size) {
+  number_of_instructions_ = CountInstructions(graph, &number_of_blocks_);
+  code_size_ = code_size;
+}
+
+void MethodCompilationStats::Dump(std::ostream& os, const std::string& method_name) const {
+  os << "{\"method\":";
+  DumpJsonString(os, method_name);
+  os << ",\"kind\":\"" << compilation_kind_ << "\"";
+  os << ",\"compiled\":"
+     << (counters_.GetStat(MethodCompilationStat::kCompiledBytecode) != 0u ? "true" : "false");
+  os << ",\"total_ns\":" << (NanoTime() - start_ns_);
+  os << ",\"blocks\":" << number_of_blocks_;
+  os << ",\"instructions\":" << number_of_instructions_;
+  os << ",\"code_size\":" << code_size_;
+  os << ",\"spill_slots\":" << counters_.GetStat(MethodCompilationStat::kSpillSlotsAllocated);
+
+  os << ",\"passes\":[";
+  const char* separator = "";
+  for (const PassStats& pass : passes_) {
+    os << separator << "{\"name\":";
+    DumpJsonString(os, pass.name);
+    os << ",\"ns\":" << pass.duration_ns << ",\"instructions\":" << pass.number_of_instructions
+       << "}";
+    separator = ",";
+  }
+  os << "]";
+
+  os << ",\"inlining\":[";
+  separator = "";
+  for (const InliningDecision& decision : inlining_decisions_) {
+    os << separator << "{\"callee\":";
+    DumpJsonString(os, decision.callee_name);
+    os << ",\"inlined\":" << (decision.inlined ? "true" : "false");
+    if (!decision.inlined && decision.reason != MethodCompilationStat::kLastStat) {
+      os << ",\"reason\":";
+      DumpJsonString(os, StatName(decision.reason));
+    }
+    os << "}";
+    separator = ",";
+  }
+  os << "]";
+
+  os << ",\"stats\":{";
+  separator = "";
+  for (size_t i = 0; i != static_cast<size_t>(MethodCompilationStat::kLastStat); ++i) {
+    MethodCompilationStat stat = static_cast<MethodCompilationStat>(i);
+    uint32_t count = counters_.GetStat(stat);
+    if (count != 0u) {
+      os << separator;
+      DumpJsonString(os, StatName(stat));
+      os << ":" << count;
+      separator = ",";
+    }
+  }
+  os << "}}\n";
+}
+
+}  // namespace art
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_METHOD_COMPILATION_STATS_H_
+#define ART_COMPILER_OPTIMIZING_METHOD_COMPILATION_STATS_H_
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "compilation_kind.h"
+#include "optimizing_compiler_stats.h"
+
+namespace art {
+
+class HGraph;
+
+/**
+ * Statistics of the compilation of a single method, requested with --dump-method-stats:
+ * the time and graph size after each pass, the inlining decisions, the code size and the
+ * counters of the method. They are dumped as one line of JSON per method, so that the
+ * methods that blow up the compile time of dex2oat and of the JIT can be found with the
+ * usual line based tools.
+ *
+ * The counters are merged into the global ones, if any, on destruction.
+ */
+class MethodCompilationStats {
+ public:
+  MethodCompilationStats(CompilationKind compilation_kind, OptimizingCompilerStats* global_stats);
+  ~MethodCompilationStats();
+
+  // The counters to pass to the compiler for this method.
+  OptimizingCompilerStats* GetCounters() { return &counters_; }
+
+  void RecordPass(const char* pass_name, uint64_t duration_ns, const HGraph* graph);
+
+  // Records whether a call of the method was inlined, and otherwise why not. The reason
+  // is `MethodCompilationStat::kLastStat` when unknown.
+  void RecordInliningDecision(const std::string& callee_name,
+                              bool inlined,
+                              MethodCompilationStat reason);
+
+  // Records the final graph and the size of the code generated from it.
+  void RecordCode(const HGraph* graph, size_t code_size);
+
+  // Writes the statistics as one line of JSON.
+  void Dump(std::ostream& os, const std::string& method_name) const;
+
+ private:
+  struct PassStats {
+    const char* name;
+    uint64_t duration_ns;
+    size_t number_of_instructions;
+  };
+
+  struct InliningDecision {
+    std::string callee_name;
+    bool inlined;
+    MethodCompilationStat reason;
+  };
+
+  const CompilationKind compilation_kind_;
+  OptimizingCompilerStats* const global_stats_;
+  OptimizingCompilerStats counters_;
+  const uint64_t start_ns_;
+
+  std::vector<PassStats> passes_;
+  std::vector<InliningDecision> inlining_decisions_;
+  size_t number_of_blocks_;
+  size_t number_of_instructions_;
+  size_t code_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(MethodCompilationStats);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_METHOD_COMPILATION_STATS_H_
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "method_compilation_stats.h"
+
+#include <sstream>
+
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+class MethodCompilationStatsTest : public OptimizingUnitTest {
+ protected:
+  HGraph* CreateGotoGraph() {
+    HGraph* graph = CreateGraph();
+    HBasicBlock* entry = new (GetAllocator()) HBasicBlock(graph);
+    graph->AddBlock(entry);
+    graph->SetEntryBlock(entry);
+    entry->AddInstruction(new (GetAllocator()) HGoto());
+    HBasicBlock* exit = new (GetAllocator()) HBasicBlock(graph);
+    graph->AddBlock(exit);
+    graph->SetExitBlock(exit);
+    exit->AddInstruction(new (GetAllocator()) HExit());
+    entry->AddSuccessor(exit);
+    return graph;
+  }
+
+  static std::string StatName(MethodCompilationStat stat) {
+    std::ostringstream oss;
+    oss << stat;
+    return oss.str();
+  }
+};
+
+TEST_F(MethodCompilationStatsTest, DumpsOneJsonLine) {
+  HGraph* graph = CreateGotoGraph();
+  MethodCompilationStats method_stats(CompilationKind::kOptimized, /* global_stats= */ nullptr);
+  EXPECT_EQ(method_stats.GetCounters()->GetMethodStats(), &method_stats);
+
+  MaybeRecordStat(method_stats.GetCounters(), MethodCompilationStat::kCompiledBytecode);
+  MaybeRecordStat(method_stats.GetCounters(), MethodCompilationStat::kSpillSlotsAllocated, 3u);
+  method_stats.RecordPass("builder", 1000u, graph);
+  method_stats.RecordInliningDecision("int Foo.\"bar\"()", /* inlined= */ true,
+                                      MethodCompilationStat::kLastStat);
+  method_stats.RecordInliningDecision("int Foo.baz()", /* inlined= */ false,
+                                      MethodCompilationStat::kNotInlinedCodeItem);
+  method_stats.RecordCode(graph, 42u);
+
+  std::ostringstream oss;
+  method_stats.Dump(oss, "void Foo.main()");
+  std::string line = oss.str();
+
+  ASSERT_FALSE(line.empty());
+  EXPECT_EQ(line.find('\n'), line.size() - 1u);
+  EXPECT_EQ(line.front(), '{');
+  EXPECT_NE(line.find("\"method\":\"void Foo.main()\""), std::string::npos);
+  EXPECT_NE(line.find("\"compiled\":true"), std::string::npos);
+  EXPECT_NE(line.find("\"blocks\":2,\"instructions\":2,\"code_size\":42"), std::string::npos);
+  EXPECT_NE(line.find("\"spill_slots\":3"), std::string::npos);
+  EXPECT_NE(line.find("{\"name\":\"builder\",\"ns\":1000,\"instructions\":2}"), std::string::npos);
+  EXPECT_NE(line.find("{\"callee\":\"int Foo.\\\"bar\\\"()\",\"inlined\":true}"),
+            std::string::npos);
+  std::string failure = "{\"callee\":\"int Foo.baz()\",\"inlined\":false,\"reason\":\"" +
+      StatName(MethodCompilationStat::kNotInlinedCodeItem) + "\"}";
+  EXPECT_NE(line.find(failure), std::string::npos);
+}
+
+TEST_F(MethodCompilationStatsTest, MergesIntoGlobalStats) {
+  OptimizingCompilerStats global_stats;
+  MaybeRecordStat(&global_stats, MethodCompilationStat::kCompiledBytecode);
+  {
+    MethodCompilationStats method_stats(CompilationKind::kBaseline, &global_stats);
+    MaybeRecordStat(method_stats.GetCounters(), MethodCompilationStat::kCompiledBytecode);
+    MaybeRecordStat(method_stats.GetCounters(), MethodCompilationStat::kInlinedInvoke, 2u);
+    EXPECT_EQ(global_stats.GetStat(MethodCompilationStat::kInlinedInvoke), 0u);
+  }
+  EXPECT_EQ(global_stats.GetStat(MethodCompilationStat::kCompiledBytecode), 2u);
+  EXPECT_EQ(global_stats.GetStat(MethodCompilationStat::kInlinedInvoke), 2u);
+  EXPECT_EQ(global_stats.GetMethodStats(), nullptr);
+}
+
+}  // namespace art
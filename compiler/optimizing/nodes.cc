@@ -2543,8 +2543,9 @@ HInstruction* HGraph::InlineInto(HGraph* outer_graph, HInvoke* invoke) {
 
     // Update all predecessors of the exit block (now the `to` block)
     // to not `HReturn` but `HGoto` instead. Special case throwing blocks
-    // to now get the outer graph exit block as successor. Note that the inliner
-    // currently doesn't support inlining methods with try/catch.
+    // to now get the outer graph exit block as successor, through an exiting
+    // TryBoundary if `at` is in a try block. Note that the inliner currently
+    // doesn't support inlining methods with try/catch.
     HPhi* return_value_phi = nullptr;
     bool rerun_dominance = false;
     bool rerun_loop_analysis = false;
@@ -2552,8 +2553,22 @@ HInstruction* HGraph::InlineInto(HGraph* outer_graph, HInvoke* invoke) {
       HBasicBlock* predecessor = to->GetPredecessors()[pred];
       HInstruction* last = predecessor->GetLastInstruction();
       if (last->IsThrow()) {
-        DCHECK(!at->IsTryBlock());
-        predecessor->ReplaceSuccessor(to, outer_graph->GetExitBlock());
+        if (at->IsTryBlock()) {
+          // The throwing block is now covered by the try block of `at`. Leave the try block
+          // with the same exception handlers before jumping to the exit block, like the
+          // builder does for throws in a try block.
+          TryCatchInformation* try_catch_info = at->GetTryCatchInformation();
+          HBasicBlock* boundary_block = outer_graph->SplitEdge(predecessor, to);
+          boundary_block->AddInstruction(
+              new (allocator) HTryBoundary(HTryBoundary::BoundaryKind::kExit, last->GetDexPc()));
+          boundary_block->SetTryCatchInformation(try_catch_info);
+          boundary_block->ReplaceSuccessor(to, outer_graph->GetExitBlock());
+          for (HBasicBlock* handler : try_catch_info->GetTryEntry().GetExceptionHandlers()) {
+            boundary_block->AddSuccessor(handler);
+          }
+        } else {
+          predecessor->ReplaceSuccessor(to, outer_graph->GetExitBlock());
+        }
         --pred;
         // We need to re-run dominance information, as the exit block now has
         // a new dominator.
@@ -360,6 +360,7 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         inexact_object_rti_(ReferenceTypeInfo::CreateInvalid()),
         osr_(osr),
         baseline_(baseline),
+        baseline_plus_(false),
         cha_single_implementation_list_(allocator->Adapter(kArenaAllocCHA)),
         is_shared_jit_code_(is_shared_jit_code) {
     blocks_.reserve(kDefaultNumberOfBlocks);
@@ -591,8 +592,19 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
 
   bool IsCompilingOsr() const { return osr_; }
 
+  // Loop suspend checks may only be turned into no-ops when nothing needs to stop at every
+  // back edge: debuggers need suspend points and OSR needs stack maps at loop headers.
+  bool SuspendChecksAreAllowedToNoOp() const { return !IsDebuggable() && !IsCompilingOsr(); }
+
   bool IsCompilingBaseline() const { return baseline_; }
 
+  bool IsCompilingBaselinePlus() const { return baseline_plus_; }
+
+  void SetCompilingBaselinePlus() {
+    DCHECK(baseline_);
+    baseline_plus_ = true;
+  }
+
   bool IsCompilingForSharedJitCode() const {
     return is_shared_jit_code_;
   }
@@ -794,6 +806,10 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // the code being generated.
   const bool baseline_;
 
+  // Whether we are compiling baseline code with the cheaper optimizations, see
+  // OptimizingCompiler::RunBaselinePlusOptimizations.
+  bool baseline_plus_;
+
   // List of methods that are assumed to have single implementation.
   ArenaSet<ArtMethod*> cha_single_implementation_list_;
 
@@ -3168,7 +3184,7 @@ class HDoubleConstant final : public HConstant {
 class HIf final : public HExpression<1> {
  public:
   explicit HIf(HInstruction* input, uint32_t dex_pc = kNoDexPc)
-      : HExpression(kIf, SideEffects::None(), dex_pc) {
+      : HExpression(kIf, SideEffects::None(), dex_pc), true_count_(0u), false_count_(0u) {
     SetRawInputAt(0, input);
   }
 
@@ -3183,10 +3199,25 @@ class HIf final : public HExpression<1> {
     return GetBlock()->GetSuccessors()[1];
   }
 
+  // Number of times the true and false successors were taken, as recorded by baseline code in
+  // the ProfilingInfo. Both counts are zero if the branch has no profile.
+  void SetBranchCounts(uint16_t true_count, uint16_t false_count) {
+    true_count_ = true_count;
+    false_count_ = false_count;
+  }
+
+  uint16_t GetTrueCount() const { return true_count_; }
+  uint16_t GetFalseCount() const { return false_count_; }
+  bool HasBranchProfile() const { return true_count_ != 0u || false_count_ != 0u; }
+
   DECLARE_INSTRUCTION(If);
 
  protected:
   DEFAULT_COPY_CONSTRUCTOR(If);
+
+ private:
+  uint16_t true_count_;
+  uint16_t false_count_;
 };
 
 
@@ -6230,12 +6261,22 @@ class HSuspendCheck final : public HExpression<0> {
   void SetSlowPath(SlowPathCode* slow_path) { slow_path_ = slow_path; }
   SlowPathCode* GetSlowPath() const { return slow_path_; }
 
+  // A no-op suspend check keeps its place (and environment) in the graph but emits no code.
+  // Loop optimization uses this for loops that are guaranteed to finish quickly.
+  void SetIsNoOp(bool is_no_op) { SetPackedFlag<kFlagIsNoOp>(is_no_op); }
+  bool IsNoOp() const { return GetPackedFlag<kFlagIsNoOp>(); }
+
   DECLARE_INSTRUCTION(SuspendCheck);
 
  protected:
   DEFAULT_COPY_CONSTRUCTOR(SuspendCheck);
 
  private:
+  static constexpr size_t kFlagIsNoOp = kNumberOfGenericPackedBits;
+  static constexpr size_t kNumberOfSuspendCheckPackedBits = kFlagIsNoOp + 1;
+  static_assert(kNumberOfSuspendCheckPackedBits <= HInstruction::kMaxNumberOfPackedBits,
+                "Too many packed fields.");
+
   // Only used for code generation, in order to share the same slow path between back edges
   // of a same loop.
   SlowPathCode* slow_path_;
@@ -6915,7 +6956,8 @@ class HStringBuilderAppend final : public HVariableInputSizeInstruction {
             kStringBuilderAppend,
             DataType::Type::kReference,
             // The runtime call may read memory from inputs. It never writes outside
-            // of the newly allocated result object (or newly allocated helper objects).
+            // of the newly allocated result object (or newly allocated helper objects),
+            // except for the thread-local buffers of Float/Double.toString().
             SideEffects::AllReads().Union(SideEffects::CanTriggerGC()),
             dex_pc,
             allocator,
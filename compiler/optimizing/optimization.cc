@@ -51,6 +51,7 @@
 #include "load_store_analysis.h"
 #include "load_store_elimination.h"
 #include "loop_optimization.h"
+#include "partial_escape_analysis.h"
 #include "scheduler.h"
 #include "select_generator.h"
 #include "sharpening.h"
@@ -78,6 +79,8 @@ const char* OptimizationPassName(OptimizationPass pass) {
       return BoundsCheckElimination::kBoundsCheckEliminationPassName;
     case OptimizationPass::kLoadStoreElimination:
       return LoadStoreElimination::kLoadStoreEliminationPassName;
+    case OptimizationPass::kPartialEscapeAnalysis:
+      return PartialEscapeAnalysis::kPartialEscapeAnalysisPassName;
     case OptimizationPass::kConstantFolding:
       return HConstantFolding::kConstantFoldingPassName;
     case OptimizationPass::kDeadCodeElimination:
@@ -141,6 +144,7 @@ OptimizationPass OptimizationPassByName(const std::string& pass_name) {
   X(OptimizationPass::kLoadStoreAnalysis);
   X(OptimizationPass::kLoadStoreElimination);
   X(OptimizationPass::kLoopOptimization);
+  X(OptimizationPass::kPartialEscapeAnalysis);
   X(OptimizationPass::kScheduling);
   X(OptimizationPass::kSelectGenerator);
   X(OptimizationPass::kSideEffectsAnalysis);
@@ -218,8 +222,12 @@ ArenaVector<HOptimization*> ConstructOptimizations(
         break;
       case OptimizationPass::kBoundsCheckElimination:
         CHECK(most_recent_side_effects != nullptr && most_recent_induction != nullptr);
-        opt = new (allocator) BoundsCheckElimination(
-            graph, *most_recent_side_effects, most_recent_induction, pass_name);
+        opt = new (allocator) BoundsCheckElimination(graph,
+                                                     *most_recent_side_effects,
+                                                     most_recent_induction,
+                                                     &codegen->GetCompilerOptions(),
+                                                     stats,
+                                                     pass_name);
         break;
       case OptimizationPass::kLoadStoreElimination:
         CHECK(most_recent_side_effects != nullptr && most_recent_induction != nullptr);
@@ -264,6 +272,9 @@ ArenaVector<HOptimization*> ConstructOptimizations(
       case OptimizationPass::kCodeSinking:
         opt = new (allocator) CodeSinking(graph, stats, pass_name);
         break;
+      case OptimizationPass::kPartialEscapeAnalysis:
+        opt = new (allocator) PartialEscapeAnalysis(graph, stats, pass_name);
+        break;
       case OptimizationPass::kConstructorFenceRedundancyElimination:
         opt = new (allocator) ConstructorFenceRedundancyElimination(graph, stats, pass_name);
         break;
@@ -80,6 +80,7 @@ enum class OptimizationPass {
   kLoadStoreAnalysis,
   kLoadStoreElimination,
   kLoopOptimization,
+  kPartialEscapeAnalysis,
   kScheduling,
   kSelectGenerator,
   kSideEffectsAnalysis,
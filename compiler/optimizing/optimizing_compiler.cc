@@ -30,6 +30,7 @@
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "base/scoped_arena_allocator.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "builder.h"
 #include "class_root.h"
@@ -53,9 +54,11 @@
 #include "jit/jit_logger.h"
 #include "jni/quick/jni_compiler.h"
 #include "linker/linker_patch.h"
+#include "method_compilation_stats.h"
 #include "nodes.h"
 #include "oat_quick_method_header.h"
 #include "prepare_for_register_allocation.h"
+#include "profile/profile_compilation_info.h"
 #include "reference_type_propagation.h"
 #include "register_allocator_linear_scan.h"
 #include "select_generator.h"
@@ -70,6 +73,14 @@ namespace art {
 
 static constexpr size_t kArenaAllocatorMemoryReportThreshold = 8 * MB;
 
+// Arena memory a single JIT compilation may use. Compilations that go over it are
+// abandoned, and the method is not JIT compiled again.
+static constexpr size_t kJitArenaMemoryBudget = 64 * MB;
+
+static size_t TotalArenaMemory(ArenaAllocator* allocator, ArenaStack* arena_stack) {
+  return allocator->BytesAllocated() + arena_stack->PeakBytesAllocated();
+}
+
 static constexpr const char* kPassNameSeparator = "$";
 
 /**
@@ -108,7 +119,10 @@ class PassObserver : public ValueObject {
                CodeGenerator* codegen,
                std::ostream* visualizer_output,
                const CompilerOptions& compiler_options,
-               Mutex& dump_mutex)
+               Mutex& dump_mutex,
+               OptimizingCompilerStats* compilation_stats,
+               MethodCompilationStats* method_stats = nullptr,
+               std::ostream* method_stats_output = nullptr)
       : graph_(graph),
         last_seen_graph_size_(0),
         cached_method_name_(),
@@ -120,7 +134,12 @@ class PassObserver : public ValueObject {
         visualizer_enabled_(!compiler_options.GetDumpCfgFileName().empty()),
         visualizer_(&visualizer_oss_, graph, *codegen),
         visualizer_dump_mutex_(dump_mutex),
+        compilation_stats_(compilation_stats),
+        method_stats_(method_stats),
+        method_stats_output_(method_stats_output),
+        pass_start_ns_(0u),
         graph_in_bad_state_(false) {
+    DCHECK_EQ(method_stats_ != nullptr, method_stats_output_ != nullptr);
     if (timing_logger_enabled_ || visualizer_enabled_) {
       if (!IsVerboseMethod(compiler_options, GetMethodName())) {
         timing_logger_enabled_ = visualizer_enabled_ = false;
@@ -141,6 +160,9 @@ class PassObserver : public ValueObject {
       FlushVisualizer();
     }
     DCHECK(visualizer_oss_.str().empty());
+    if (method_stats_ != nullptr) {
+      FlushMethodStats();
+    }
   }
 
   void DumpDisassembly() {
@@ -151,6 +173,10 @@ class PassObserver : public ValueObject {
 
   void SetGraphInBadState() { graph_in_bad_state_ = true; }
 
+  // The counters of the compiled method: its own ones when dumping method statistics,
+  // the global ones otherwise.
+  OptimizingCompilerStats* GetCompilationStats() const { return compilation_stats_; }
+
   const char* GetMethodName() {
     // PrettyMethod() is expensive, so we delay calling it until we actually have to.
     if (cached_method_name_.empty()) {
@@ -169,6 +195,9 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.StartTiming(pass_name);
     }
+    if (method_stats_ != nullptr) {
+      pass_start_ns_ = NanoTime();
+    }
   }
 
   void FlushVisualizer() REQUIRES(!visualizer_dump_mutex_) {
@@ -179,11 +208,23 @@ class PassObserver : public ValueObject {
     visualizer_oss_.clear();
   }
 
+  void FlushMethodStats() REQUIRES(!visualizer_dump_mutex_) {
+    // Write whole lines only, the output is shared by the compiler threads.
+    std::ostringstream oss;
+    method_stats_->Dump(oss, GetMethodName());
+    MutexLock mu(Thread::Current(), visualizer_dump_mutex_);
+    *method_stats_output_ << oss.str();
+    method_stats_output_->flush();
+  }
+
   void EndPass(const char* pass_name, bool pass_change) {
     // Pause timer first, then dump graph.
     if (timing_logger_enabled_) {
       timing_logger_.EndTiming();
     }
+    if (method_stats_ != nullptr) {
+      method_stats_->RecordPass(pass_name, NanoTime() - pass_start_ns_, graph_);
+    }
     if (visualizer_enabled_) {
       visualizer_.DumpGraph(pass_name, /* is_after_pass= */ true, graph_in_bad_state_);
     }
@@ -233,6 +274,11 @@ class PassObserver : public ValueObject {
   HGraphVisualizer visualizer_;
   Mutex& visualizer_dump_mutex_;
 
+  OptimizingCompilerStats* const compilation_stats_;
+  MethodCompilationStats* const method_stats_;
+  std::ostream* const method_stats_output_;
+  uint64_t pass_start_ns_;
+
   // Flag to be set by the compiler if the pass failed and the graph is not
   // expected to validate.
   bool graph_in_bad_state_;
@@ -297,8 +343,7 @@ class OptimizingCompiler final : public Compiler {
                   jit::JitCodeCache* code_cache,
                   jit::JitMemoryRegion* region,
                   ArtMethod* method,
-                  bool baseline,
-                  bool osr,
+                  CompilationKind compilation_kind,
                   jit::JitLogger* jit_logger)
       override
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -317,7 +362,7 @@ class OptimizingCompiler final : public Compiler {
         length,
         graph->GetAllocator(),
         graph,
-        compilation_stats_.get(),
+        pass_observer->GetCompilationStats(),
         codegen,
         dex_compilation_unit,
         handles);
@@ -382,8 +427,7 @@ class OptimizingCompiler final : public Compiler {
                             CodeVectorAllocator* code_allocator,
                             const DexCompilationUnit& dex_compilation_unit,
                             ArtMethod* method,
-                            bool baseline,
-                            bool osr,
+                            CompilationKind compilation_kind,
                             bool is_shared_jit_code,
                             VariableSizedHandleScope* handles) const;
 
@@ -406,13 +450,21 @@ class OptimizingCompiler final : public Compiler {
                                 PassObserver* pass_observer,
                                 VariableSizedHandleScope* handles) const;
 
+  void RunBaselinePlusOptimizations(HGraph* graph,
+                                    CodeGenerator* codegen,
+                                    const DexCompilationUnit& dex_compilation_unit,
+                                    PassObserver* pass_observer,
+                                    VariableSizedHandleScope* handles) const;
+
   void GenerateJitDebugInfo(const debug::MethodDebugInfo& method_debug_info);
 
   std::unique_ptr<OptimizingCompilerStats> compilation_stats_;
 
   std::unique_ptr<std::ostream> visualizer_output_;
 
-  mutable Mutex dump_mutex_;  // To synchronize visualizer writing.
+  std::unique_ptr<std::ostream> method_stats_output_;
+
+  mutable Mutex dump_mutex_;  // To synchronize visualizer and method statistics writing.
 
   DISALLOW_COPY_AND_ASSIGN(OptimizingCompiler);
 };
@@ -433,6 +485,11 @@ OptimizingCompiler::OptimizingCompiler(const CompilerOptions& compiler_options,
   if (compiler_options.GetDumpStats()) {
     compilation_stats_.reset(new OptimizingCompilerStats());
   }
+  // Always append, so that the JIT of each process adds to the same file.
+  const std::string& method_stats_file_name = compiler_options.GetDumpMethodStatsFileName();
+  if (!method_stats_file_name.empty()) {
+    method_stats_output_.reset(new std::ofstream(method_stats_file_name, std::ofstream::app));
+  }
 }
 
 OptimizingCompiler::~OptimizingCompiler() {
@@ -483,6 +540,47 @@ bool OptimizingCompiler::RunBaselineOptimizations(HGraph* graph,
   }
 }
 
+void OptimizingCompiler::RunBaselinePlusOptimizations(
+    HGraph* graph,
+    CodeGenerator* codegen,
+    const DexCompilationUnit& dex_compilation_unit,
+    PassObserver* pass_observer,
+    VariableSizedHandleScope* handles) const {
+  // The cheap subset of RunOptimizations: no loop optimizations nor load-store elimination, and
+  // the inliner only replaces invokes of trivial callees (see HInliner::TryBuildAndInline).
+  OptimizationDef optimizations[] = {
+    OptDef(OptimizationPass::kConstantFolding),
+    OptDef(OptimizationPass::kInstructionSimplifier),
+    OptDef(OptimizationPass::kDeadCodeElimination,
+           "dead_code_elimination$initial"),
+    OptDef(OptimizationPass::kInliner),
+    OptDef(OptimizationPass::kConstantFolding,
+           "constant_folding$after_inlining",
+           OptimizationPass::kInliner),
+    OptDef(OptimizationPass::kInstructionSimplifier,
+           "instruction_simplifier$after_inlining",
+           OptimizationPass::kInliner),
+    OptDef(OptimizationPass::kSideEffectsAnalysis,
+           "side_effects$before_gvn"),
+    OptDef(OptimizationPass::kGlobalValueNumbering),
+    OptDef(OptimizationPass::kDeadCodeElimination,
+           "dead_code_elimination$final"),
+    // The codegen has a few assumptions that only the instruction simplifier
+    // can satisfy.
+    OptDef(OptimizationPass::kInstructionSimplifier,
+           "instruction_simplifier$before_codegen"),
+  };
+  RunOptimizations(graph,
+                   codegen,
+                   dex_compilation_unit,
+                   pass_observer,
+                   handles,
+                   optimizations);
+
+  // Run the architecture passes that baseline code also needs.
+  RunBaselineOptimizations(graph, codegen, dex_compilation_unit, pass_observer, handles);
+}
+
 bool OptimizingCompiler::RunArchOptimizations(HGraph* graph,
                                               CodeGenerator* codegen,
                                               const DexCompilationUnit& dex_compilation_unit,
@@ -545,6 +643,8 @@ bool OptimizingCompiler::RunArchOptimizations(HGraph* graph,
         OptDef(OptimizationPass::kInstructionSimplifierX86_64),
         OptDef(OptimizationPass::kSideEffectsAnalysis),
         OptDef(OptimizationPass::kGlobalValueNumbering, "GVN$after_arch"),
+        // Schedule before generating the memory operands, which rely on the order.
+        OptDef(OptimizationPass::kScheduling),
         OptDef(OptimizationPass::kX86MemoryOperandGeneration)
       };
       return RunOptimizations(graph,
@@ -581,6 +681,16 @@ static void AllocateRegisters(HGraph* graph,
   }
   {
     PassScope scope(RegisterAllocator::kRegisterAllocatorPassName, pass_observer);
+    if (strategy == RegisterAllocator::kRegisterAllocatorGraphColor) {
+      // Bound the size of the interference graph, and the compile time.
+      if (liveness.GetNumberOfSsaValues() >
+              codegen->GetCompilerOptions().GetGraphColorMaxSsaValues()) {
+        strategy = RegisterAllocator::kRegisterAllocatorLinearScan;
+        MaybeRecordStat(stats, MethodCompilationStat::kGraphColorTooManySsaValues);
+      } else {
+        MaybeRecordStat(stats, MethodCompilationStat::kGraphColorRegisterAllocation);
+      }
+    }
     std::unique_ptr<RegisterAllocator> register_allocator =
         RegisterAllocator::Create(&local_allocator, codegen, liveness, strategy);
     register_allocator->AllocateRegisters();
@@ -662,6 +772,7 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
     OptDef(OptimizationPass::kInstructionSimplifier,
            "instruction_simplifier$after_bce"),
     // Other high-level optimizations.
+    OptDef(OptimizationPass::kPartialEscapeAnalysis),
     OptDef(OptimizationPass::kSideEffectsAnalysis,
            "side_effects$before_lse"),
     OptDef(OptimizationPass::kLoadStoreAnalysis),
@@ -735,8 +846,7 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
                                               CodeVectorAllocator* code_allocator,
                                               const DexCompilationUnit& dex_compilation_unit,
                                               ArtMethod* method,
-                                              bool baseline,
-                                              bool osr,
+                                              CompilationKind compilation_kind,
                                               bool is_shared_jit_code,
                                               VariableSizedHandleScope* handles) const {
   MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kAttemptBytecodeCompilation);
@@ -774,6 +884,12 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
 
   CodeItemDebugInfoAccessor code_item_accessor(dex_file, code_item, method_idx);
 
+  const bool osr = (compilation_kind == CompilationKind::kOsr);
+  const bool baseline_plus = (compilation_kind == CompilationKind::kBaselinePlus);
+  const bool baseline = (compilation_kind == CompilationKind::kBaseline) ||
+                        baseline_plus ||
+                        compiler_options.IsBaseline();
+
   bool dead_reference_safe;
   ArrayRef<const uint8_t> interpreter_metadata;
   // For AOT compilation, we may not get a method, for example if its class is erroneous,
@@ -796,6 +912,14 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
     dead_reference_safe = false;
   }
 
+  // Statistics of this method when dumping them. They are merged into the global ones when done.
+  std::unique_ptr<MethodCompilationStats> method_stats;
+  OptimizingCompilerStats* stats = compilation_stats_.get();
+  if (method_stats_output_ != nullptr) {
+    method_stats.reset(new MethodCompilationStats(compilation_kind, stats));
+    stats = method_stats->GetCounters();
+  }
+
   HGraph* graph = new (allocator) HGraph(
       allocator,
       arena_stack,
@@ -812,13 +936,16 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
   if (method != nullptr) {
     graph->SetArtMethod(method);
   }
+  if (baseline_plus) {
+    graph->SetCompilingBaselinePlus();
+  }
 
   std::unique_ptr<CodeGenerator> codegen(
       CodeGenerator::Create(graph,
                             compiler_options,
-                            compilation_stats_.get()));
+                            stats));
   if (codegen.get() == nullptr) {
-    MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kNotCompiledNoCodegen);
+    MaybeRecordStat(stats, MethodCompilationStat::kNotCompiledNoCodegen);
     return nullptr;
   }
   codegen->GetAssembler()->cfi().SetEnabled(compiler_options.GenerateAnyDebugInfo());
@@ -827,7 +954,10 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
                              codegen.get(),
                              visualizer_output_.get(),
                              compiler_options,
-                             dump_mutex_);
+                             dump_mutex_,
+                             stats,
+                             method_stats.get(),
+                             method_stats_output_.get());
 
   {
     VLOG(compiler) << "Building " << pass_observer.GetMethodName();
@@ -837,39 +967,39 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
                           &dex_compilation_unit,
                           &dex_compilation_unit,
                           codegen.get(),
-                          compilation_stats_.get(),
+                          stats,
                           interpreter_metadata,
                           handles);
     GraphAnalysisResult result = builder.BuildGraph();
     if (result != kAnalysisSuccess) {
       switch (result) {
         case kAnalysisSkipped: {
-          MaybeRecordStat(compilation_stats_.get(),
+          MaybeRecordStat(stats,
                           MethodCompilationStat::kNotCompiledSkipped);
           break;
         }
         case kAnalysisInvalidBytecode: {
-          MaybeRecordStat(compilation_stats_.get(),
+          MaybeRecordStat(stats,
                           MethodCompilationStat::kNotCompiledInvalidBytecode);
           break;
         }
         case kAnalysisFailThrowCatchLoop: {
-          MaybeRecordStat(compilation_stats_.get(),
+          MaybeRecordStat(stats,
                           MethodCompilationStat::kNotCompiledThrowCatchLoop);
           break;
         }
         case kAnalysisFailAmbiguousArrayOp: {
-          MaybeRecordStat(compilation_stats_.get(),
+          MaybeRecordStat(stats,
                           MethodCompilationStat::kNotCompiledAmbiguousArrayOp);
           break;
         }
         case kAnalysisFailIrreducibleLoopAndStringInit: {
-          MaybeRecordStat(compilation_stats_.get(),
+          MaybeRecordStat(stats,
                           MethodCompilationStat::kNotCompiledIrreducibleLoopAndStringInit);
           break;
         }
         case kAnalysisFailPhiEquivalentInOsr: {
-          MaybeRecordStat(compilation_stats_.get(),
+          MaybeRecordStat(stats,
                           MethodCompilationStat::kNotCompiledPhiEquivalentInOsr);
           break;
         }
@@ -881,24 +1011,56 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
     }
   }
 
-  if (baseline) {
+  if (baseline_plus) {
+    RunBaselinePlusOptimizations(
+        graph, codegen.get(), dex_compilation_unit, &pass_observer, handles);
+  } else if (baseline) {
     RunBaselineOptimizations(graph, codegen.get(), dex_compilation_unit, &pass_observer, handles);
   } else {
     RunOptimizations(graph, codegen.get(), dex_compilation_unit, &pass_observer, handles);
   }
 
-  RegisterAllocator::Strategy regalloc_strategy =
-    compiler_options.GetRegisterAllocationStrategy();
+  // Stop before register allocation, which needs the most memory, if the optimizations already
+  // went over the JIT memory budget.
+  if (compiler_options.IsJitCompiler() &&
+      TotalArenaMemory(allocator, arena_stack) > kJitArenaMemoryBudget) {
+    MaybeRecordStat(stats, MethodCompilationStat::kNotCompiledJitMemoryBudget);
+    pass_observer.SetGraphInBadState();
+    return nullptr;
+  }
+
+  // Baseline-plus compilation favors compile time, and always uses linear scan.
+  RegisterAllocator::Strategy regalloc_strategy = baseline_plus
+      ? RegisterAllocator::kRegisterAllocatorLinearScan
+      : compiler_options.GetRegisterAllocationStrategy();
+  if (regalloc_strategy == RegisterAllocator::kRegisterAllocatorGraphColor &&
+      compiler_options.IsGraphColorForHotMethodsOnly()) {
+    // Spend the compile time of graph coloring only on the methods that are hot in the profile.
+    const ProfileCompilationInfo* profile = compiler_options.GetProfileCompilationInfo();
+    if (profile == nullptr ||
+        !profile->GetMethodHotness(MethodReference(&dex_file, method_idx)).IsHot()) {
+      regalloc_strategy = RegisterAllocator::kRegisterAllocatorLinearScan;
+    }
+  }
   AllocateRegisters(graph,
                     codegen.get(),
                     &pass_observer,
                     regalloc_strategy,
-                    compilation_stats_.get());
+                    stats);
+  if (compiler_options.IsJitCompiler() &&
+      TotalArenaMemory(allocator, arena_stack) > kJitArenaMemoryBudget) {
+    MaybeRecordStat(stats, MethodCompilationStat::kNotCompiledJitMemoryBudget);
+    pass_observer.SetGraphInBadState();
+    return nullptr;
+  }
 
   codegen->Compile(code_allocator);
   pass_observer.DumpDisassembly();
+  if (method_stats != nullptr) {
+    method_stats->RecordCode(graph, code_allocator->GetMemory().size());
+  }
 
-  MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kCompiledBytecode);
+  MaybeRecordStat(stats, MethodCompilationStat::kCompiledBytecode);
   return codegen.release();
 }
 
@@ -952,7 +1114,8 @@ CodeGenerator* OptimizingCompiler::TryCompileIntrinsic(
                              codegen.get(),
                              visualizer_output_.get(),
                              compiler_options,
-                             dump_mutex_);
+                             dump_mutex_,
+                             compilation_stats_.get());
 
   {
     VLOG(compiler) << "Building intrinsic graph " << pass_observer.GetMethodName();
@@ -1067,8 +1230,7 @@ CompiledMethod* OptimizingCompiler::Compile(const dex::CodeItem* code_item,
                        &code_allocator,
                        dex_compilation_unit,
                        method,
-                       compiler_options.IsBaseline(),
-                       /* osr= */ false,
+                       CompilationKind::kOptimized,
                        /* is_shared_jit_code= */ false,
                        &handles));
       }
@@ -1215,9 +1377,9 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                                     jit::JitCodeCache* code_cache,
                                     jit::JitMemoryRegion* region,
                                     ArtMethod* method,
-                                    bool baseline,
-                                    bool osr,
+                                    CompilationKind compilation_kind,
                                     jit::JitLogger* jit_logger) {
+  const bool osr = (compilation_kind == CompilationKind::kOsr);
   StackHandleScope<3> hs(self);
   Handle<mirror::ClassLoader> class_loader(hs.NewHandle(
       method->GetDeclaringClass()->GetClassLoader()));
@@ -1254,6 +1416,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                              stack_map.size(),
                              /* number_of_roots= */ 0,
                              method,
+                             /* baseline= */ false,
                              /*out*/ &reserved_code,
                              /*out*/ &reserved_data)) {
       MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kJitOutOfMemoryForCommit);
@@ -1332,11 +1495,15 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                    &code_allocator,
                    dex_compilation_unit,
                    method,
-                   baseline || GetCompilerOptions().IsBaseline(),
-                   osr,
+                   compilation_kind,
                    /* is_shared_jit_code= */ code_cache->IsSharedRegion(*region),
                    &handles));
     if (codegen.get() == nullptr) {
+      size_t total_allocated = TotalArenaMemory(&allocator, &arena_stack);
+      if (total_allocated > kJitArenaMemoryBudget) {
+        ScopedObjectAccess soa(self);
+        runtime->GetJit()->NotifyMemoryBudgetExceeded(method, total_allocated);
+      }
       return false;
     }
   }
@@ -1351,6 +1518,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                            stack_map.size(),
                            /*number_of_roots=*/codegen->GetNumberOfJitRoots(),
                            method,
+                           /* baseline= */ codegen->GetGraph()->IsCompilingBaseline(),
                            /*out*/ &reserved_code,
                            /*out*/ &reserved_data)) {
     MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kJitOutOfMemoryForCommit);
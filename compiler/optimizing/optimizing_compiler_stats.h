@@ -36,6 +36,7 @@ enum class MethodCompilationStat {
   kCompiledIntrinsic,
   kCompiledBytecode,
   kCHAInline,
+  kCHADirectCall,
   kInlinedInvoke,
   kReplacedInvokeWithSimplePattern,
   kInstructionSimplifications,
@@ -46,6 +47,7 @@ enum class MethodCompilationStat {
   kRemovedCheckedCast,
   kRemovedDeadInstruction,
   kRemovedNullCheck,
+  kRemovedMonitorOperation,
   kNotCompiledSkipped,
   kNotCompiledInvalidBytecode,
   kNotCompiledThrowCatchLoop,
@@ -62,8 +64,10 @@ enum class MethodCompilationStat {
   kNotCompiledVerifyAtRuntime,
   kNotCompiledIrreducibleLoopAndStringInit,
   kNotCompiledPhiEquivalentInOsr,
+  kNotCompiledJitMemoryBudget,
   kInlinedMonomorphicCall,
   kInlinedPolymorphicCall,
+  kInlinedMegamorphicCall,
   kMonomorphicCall,
   kPolymorphicCall,
   kMegamorphicCall,
@@ -72,6 +76,9 @@ enum class MethodCompilationStat {
   kLoopInvariantMoved,
   kLoopVectorized,
   kLoopVectorizedIdiom,
+  kLoopVectorizedTail,
+  kLoopVersionedForBCE,
+  kLoopSuspendCheckNoOp,
   kSelectGenerated,
   kRemovedInstanceOf,
   kInlinedInvokeVirtualOrInterface,
@@ -80,6 +87,8 @@ enum class MethodCompilationStat {
   kSimplifyIf,
   kSimplifyThrowingInvoke,
   kInstructionSunk,
+  kAllocationMaterialized,
+  kColdBlockMoved,
   kNotInlinedUnresolvedEntrypoint,
   kNotInlinedDexCache,
   kNotInlinedStackMaps,
@@ -94,6 +103,7 @@ enum class MethodCompilationStat {
   kNotInlinedCannotBuild,
   kNotInlinedNotVerified,
   kNotInlinedCodeItem,
+  kInlineCodeItemLimitRaisedForHotCall,
   kNotInlinedWont,
   kNotInlinedRecursiveBudget,
   kNotInlinedProxy,
@@ -104,17 +114,28 @@ enum class MethodCompilationStat {
   kConstructorFenceRemovedCFRE,
   kBitstringTypeCheck,
   kJitOutOfMemoryForCommit,
+  kGraphColorRegisterAllocation,
+  kGraphColorTooManySsaValues,
+  kSpillSlotsAllocated,
   kLastStat
 };
 std::ostream& operator<<(std::ostream& os, const MethodCompilationStat& rhs);
 
+class MethodCompilationStats;
+
 class OptimizingCompilerStats {
  public:
-  OptimizingCompilerStats() {
+  OptimizingCompilerStats() : OptimizingCompilerStats(nullptr) {}
+
+  explicit OptimizingCompilerStats(MethodCompilationStats* method_stats)
+      : method_stats_(method_stats) {
     // The std::atomic<> default constructor leaves values uninitialized, so initialize them now.
     Reset();
   }
 
+  // The statistics of the compiled method when these are its counters, null otherwise.
+  MethodCompilationStats* GetMethodStats() const { return method_stats_; }
+
   void RecordStat(MethodCompilationStat stat, uint32_t count = 1) {
     size_t stat_index = static_cast<size_t>(stat);
     DCHECK_LT(stat_index, arraysize(compile_stats_));
@@ -173,6 +194,7 @@ class OptimizingCompilerStats {
   }
 
  private:
+  MethodCompilationStats* const method_stats_;
   std::atomic<uint32_t> compile_stats_[static_cast<size_t>(MethodCompilationStat::kLastStat)];
 
   DISALLOW_COPY_AND_ASSIGN(OptimizingCompilerStats);
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "partial_escape_analysis.h"
+
+#include <algorithm>
+
+#include "base/scoped_arena_allocator.h"
+#include "optimizing_compiler_stats.h"
+
+namespace art {
+
+// Returns whether `user` makes `reference`, its input at `index`, visible outside of
+// the method, or to another name.
+static bool IsEscape(HInstruction* user, size_t index) {
+  return user->IsInvoke() ||
+      user->IsReturn() ||
+      (user->IsInstanceFieldSet() && index == 1u) ||
+      (user->IsStaticFieldSet() && index == 1u) ||
+      (user->IsArraySet() && index == 2u);
+}
+
+bool PartialEscapeAnalysis::Run() {
+  // Load-store elimination, which removes the original allocations, does not run on these
+  // graphs. When compiling OSR, the interpreter state is also needed at every suspend check.
+  if (graph_->IsDebuggable() || graph_->HasTryCatch() || graph_->IsCompilingOsr()) {
+    return false;
+  }
+
+  // Local allocator to discard data structures created below at the end of this optimization.
+  ScopedArenaAllocator allocator(graph_->GetArenaStack());
+
+  // Collect the allocations first, materializing adds new ones.
+  ScopedArenaVector<HNewInstance*> new_instances(allocator.Adapter(kArenaAllocMisc));
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (it.Current()->IsNewInstance()) {
+        new_instances.push_back(it.Current()->AsNewInstance());
+      }
+    }
+  }
+
+  bool changed = false;
+  for (HNewInstance* new_instance : new_instances) {
+    if (TryMaterializeAtEscapes(new_instance, &allocator)) {
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool PartialEscapeAnalysis::TryMaterializeAtEscapes(HNewInstance* new_instance,
+                                                    ScopedArenaAllocator* allocator) {
+  if (new_instance->IsFinalizable() ||
+      new_instance->NeedsChecks() ||
+      new_instance->IsStringAlloc()) {
+    return false;
+  }
+  for (const HUseListNode<HEnvironment*>& use : new_instance->GetEnvUses()) {
+    if (use.GetUser()->GetHolder()->IsDeoptimize()) {
+      // The interpreter could see the original allocation after an escape.
+      return false;
+    }
+  }
+
+  // Classify the uses. Besides the escapes, only field accesses and constructor fences
+  // are supported, so that the original allocation can be removed afterwards.
+  ScopedArenaVector<HInstruction*> escapes(allocator->Adapter(kArenaAllocMisc));
+  ScopedArenaVector<HInstanceFieldSet*> stores(allocator->Adapter(kArenaAllocMisc));
+  bool needs_constructor_fence = false;
+  for (const HUseListNode<HInstruction*>& use : new_instance->GetUses()) {
+    HInstruction* user = use.GetUser();
+    size_t index = use.GetIndex();
+    if (user->IsInstanceFieldGet()) {
+      if (user->AsInstanceFieldGet()->IsVolatile()) {
+        return false;
+      }
+    } else if (user->IsInstanceFieldSet() && index == 0u) {
+      HInstanceFieldSet* store = user->AsInstanceFieldSet();
+      if (store->IsVolatile() || store->GetValue() == new_instance) {
+        return false;
+      }
+      stores.push_back(store);
+    } else if (user->IsConstructorFence()) {
+      needs_constructor_fence = true;
+    } else if (IsEscape(user, index)) {
+      if (std::find(escapes.begin(), escapes.end(), user) == escapes.end()) {
+        escapes.push_back(user);
+      }
+    } else {
+      return false;
+    }
+  }
+  if (escapes.empty()) {
+    return false;
+  }
+
+  // Only materialize if some path from the allocation to the exit does not escape.
+  HBasicBlock* allocation_block = new_instance->GetBlock();
+  size_t number_of_blocks = graph_->GetBlocks().size();
+  ArenaBitVector escape_blocks(allocator, number_of_blocks, /* expandable= */ false);
+  escape_blocks.ClearAllBits();
+  for (HInstruction* escape : escapes) {
+    if (escape->GetBlock() == allocation_block) {
+      return false;
+    }
+    escape_blocks.SetBit(escape->GetBlock()->GetBlockId());
+  }
+  ArenaBitVector visited(allocator, number_of_blocks, /* expandable= */ false);
+  visited.ClearAllBits();
+  ScopedArenaVector<HBasicBlock*> worklist(allocator->Adapter(kArenaAllocMisc));
+  worklist.push_back(allocation_block);
+  visited.SetBit(allocation_block->GetBlockId());
+  bool reaches_exit = false;
+  while (!worklist.empty() && !reaches_exit) {
+    HBasicBlock* block = worklist.back();
+    worklist.pop_back();
+    if (block->IsExitBlock()) {
+      reaches_exit = true;
+    }
+    for (HBasicBlock* successor : block->GetSuccessors()) {
+      if (!visited.IsBitSet(successor->GetBlockId()) &&
+          !escape_blocks.IsBitSet(successor->GetBlockId())) {
+        visited.SetBit(successor->GetBlockId());
+        worklist.push_back(successor);
+      }
+    }
+  }
+  if (!reaches_exit) {
+    return false;
+  }
+
+  // Order the escapes in reverse post order, so that an escape comes after the escapes
+  // that dominate it.
+  ScopedArenaVector<HInstruction*> ordered_escapes(allocator->Adapter(kArenaAllocMisc));
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    if (!escape_blocks.IsBitSet(block->GetBlockId())) {
+      continue;
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (std::find(escapes.begin(), escapes.end(), it.Current()) != escapes.end()) {
+        ordered_escapes.push_back(it.Current());
+      }
+    }
+  }
+  DCHECK_EQ(ordered_escapes.size(), escapes.size());
+
+  // Pick the escapes to materialize at. The uses that can be reached from one of them must
+  // be dominated by it, and then use the materialized allocation.
+  ScopedArenaVector<HInstruction*> materialization_points(allocator->Adapter(kArenaAllocMisc));
+  ArenaBitVector region(allocator, number_of_blocks, /* expandable= */ false);
+  for (HInstruction* escape : ordered_escapes) {
+    if (std::any_of(materialization_points.begin(),
+                    materialization_points.end(),
+                    [escape](HInstruction* point) { return point->StrictlyDominates(escape); })) {
+      continue;
+    }
+    if (!CollectEscapeRegion(new_instance, escape, allocator, &region)) {
+      return false;
+    }
+    for (const HUseListNode<HInstruction*>& use : new_instance->GetUses()) {
+      HInstruction* user = use.GetUser();
+      if (region.IsBitSet(user->GetBlock()->GetBlockId()) &&
+          user != escape &&
+          !escape->StrictlyDominates(user)) {
+        return false;
+      }
+    }
+    materialization_points.push_back(escape);
+  }
+
+  for (HInstruction* escape : materialization_points) {
+    Materialize(new_instance, escape, stores, needs_constructor_fence);
+  }
+  return true;
+}
+
+bool PartialEscapeAnalysis::CollectEscapeRegion(HNewInstance* new_instance,
+                                                HInstruction* escape,
+                                                ScopedArenaAllocator* allocator,
+                                                /*out*/ ArenaBitVector* region) {
+  region->ClearAllBits();
+  ScopedArenaVector<HBasicBlock*> worklist(allocator->Adapter(kArenaAllocMisc));
+  worklist.insert(worklist.end(),
+                  escape->GetBlock()->GetSuccessors().begin(),
+                  escape->GetBlock()->GetSuccessors().end());
+  while (!worklist.empty()) {
+    HBasicBlock* block = worklist.back();
+    worklist.pop_back();
+    if (block == escape->GetBlock()) {
+      // The escape is in a loop that does not allocate again.
+      return false;
+    }
+    if (block == new_instance->GetBlock() || region->IsBitSet(block->GetBlockId())) {
+      // Uses after the allocation refer to its next object.
+      continue;
+    }
+    region->SetBit(block->GetBlockId());
+    worklist.insert(worklist.end(), block->GetSuccessors().begin(), block->GetSuccessors().end());
+  }
+  return true;
+}
+
+void PartialEscapeAnalysis::Materialize(HNewInstance* new_instance,
+                                        HInstruction* escape,
+                                        const ScopedArenaVector<HInstanceFieldSet*>& stores,
+                                        bool needs_constructor_fence) {
+  ArenaAllocator* allocator = graph_->GetAllocator();
+  HBasicBlock* block = escape->GetBlock();
+  uint32_t dex_pc = escape->GetDexPc();
+
+  HNewInstance* materialized = new (allocator) HNewInstance(new_instance->InputAt(0),
+                                                            new_instance->GetDexPc(),
+                                                            new_instance->GetTypeIndex(),
+                                                            new_instance->GetDexFile(),
+                                                            /* finalizable= */ false,
+                                                            new_instance->GetEntrypoint());
+  materialized->SetReferenceTypeInfo(new_instance->GetReferenceTypeInfo());
+  block->InsertInstructionBefore(materialized, escape);
+  // The allocation throws like the original one would have.
+  materialized->CopyEnvironmentFrom(new_instance->GetEnvironment());
+
+  // Copy the fields written before the escape. The other fields still have their default
+  // value. Load-store elimination replaces the loads with the stored values.
+  for (size_t i = 0; i != stores.size(); ++i) {
+    const FieldInfo& field_info = stores[i]->GetFieldInfo();
+    uint32_t offset = field_info.GetFieldOffset().Uint32Value();
+    if (std::any_of(stores.begin(),
+                    stores.begin() + i,
+                    [offset](HInstanceFieldSet* store) {
+                      return store->GetFieldOffset().Uint32Value() == offset;
+                    })) {
+      continue;
+    }
+    HInstanceFieldGet* value = new (allocator) HInstanceFieldGet(
+        new_instance,
+        field_info.GetField(),
+        field_info.GetFieldType(),
+        field_info.GetFieldOffset(),
+        /* is_volatile= */ false,
+        field_info.GetFieldIndex(),
+        field_info.GetDeclaringClassDefIndex(),
+        field_info.GetDexFile(),
+        dex_pc);
+    if (value->GetType() == DataType::Type::kReference) {
+      value->SetReferenceTypeInfo(graph_->GetInexactObjectRti());
+    }
+    block->InsertInstructionBefore(value, escape);
+    HInstanceFieldSet* copy = new (allocator) HInstanceFieldSet(
+        materialized,
+        value,
+        field_info.GetField(),
+        field_info.GetFieldType(),
+        field_info.GetFieldOffset(),
+        /* is_volatile= */ false,
+        field_info.GetFieldIndex(),
+        field_info.GetDeclaringClassDefIndex(),
+        field_info.GetDexFile(),
+        dex_pc);
+    block->InsertInstructionBefore(copy, escape);
+  }
+  if (needs_constructor_fence) {
+    HConstructorFence* fence = new (allocator) HConstructorFence(materialized, dex_pc, allocator);
+    block->InsertInstructionBefore(fence, escape);
+  }
+
+  HInstruction* cursor = escape->GetPrevious();
+  new_instance->ReplaceUsesDominatedBy(cursor, materialized);
+  new_instance->ReplaceEnvUsesDominatedBy(cursor, materialized);
+  MaybeRecordStat(stats_, MethodCompilationStat::kAllocationMaterialized);
+}
+
+}  // namespace art
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_PARTIAL_ESCAPE_ANALYSIS_H_
+#define ART_COMPILER_OPTIMIZING_PARTIAL_ESCAPE_ANALYSIS_H_
+
+#include "base/arena_bit_vector.h"
+#include "base/scoped_arena_containers.h"
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+/**
+ * Optimization pass for allocations that escape only on some paths. A copy of
+ * the allocation is materialized right before each escape, from the fields of
+ * the original allocation, and replaces it from there on. The original
+ * allocation is then a singleton that load-store elimination can remove, so
+ * that the paths that do not escape no longer allocate.
+ *
+ * An escape is only materialized when no use of the original allocation can
+ * be reached from it, other than the uses it dominates, so that the object
+ * keeps a single identity on every path.
+ */
+class PartialEscapeAnalysis : public HOptimization {
+ public:
+  PartialEscapeAnalysis(HGraph* graph,
+                        OptimizingCompilerStats* stats,
+                        const char* name = kPartialEscapeAnalysisPassName)
+      : HOptimization(graph, name, stats) {}
+
+  bool Run() override;
+
+  static constexpr const char* kPartialEscapeAnalysisPassName = "partial_escape_analysis";
+
+ private:
+  // Try to materialize `new_instance` at each of its escapes. Returns whether the graph changed.
+  bool TryMaterializeAtEscapes(HNewInstance* new_instance, ScopedArenaAllocator* allocator);
+
+  // Collect in `region` the blocks that can be reached from `escape` without going through
+  // the allocation of `new_instance` again. Returns false if the block of `escape` itself
+  // can be reached.
+  bool CollectEscapeRegion(HNewInstance* new_instance,
+                           HInstruction* escape,
+                           ScopedArenaAllocator* allocator,
+                           /*out*/ ArenaBitVector* region);
+
+  // Insert a copy of `new_instance` before `escape`, with the fields written by `stores`,
+  // and replace the uses of `new_instance` dominated by `escape` with it.
+  void Materialize(HNewInstance* new_instance,
+                   HInstruction* escape,
+                   const ScopedArenaVector<HInstanceFieldSet*>& stores,
+                   bool needs_constructor_fence);
+
+  DISALLOW_COPY_AND_ASSIGN(PartialEscapeAnalysis);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_PARTIAL_ESCAPE_ANALYSIS_H_
@@ -181,6 +181,13 @@ bool PrepareForRegisterAllocation::CanEmitConditionAt(HCondition* condition,
     return false;
   }
 
+  if (user->IsIf() &&
+      GetGraph()->IsCompilingBaseline() &&
+      compiler_options_.ProfileBranches()) {
+    // The baseline code uses the materialized condition to index the branch cache.
+    return false;
+  }
+
   if (user->IsIf() || user->IsDeoptimize()) {
     return true;
   }
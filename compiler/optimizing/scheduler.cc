@@ -24,6 +24,7 @@
 #include "prepare_for_register_allocation.h"
 
 #ifdef ART_ENABLE_CODEGEN_arm64
+#include "arch/arm64/instruction_set_features_arm64.h"
 #include "scheduler_arm64.h"
 #endif
 
@@ -31,6 +32,10 @@
 #include "scheduler_arm.h"
 #endif
 
+#ifdef ART_ENABLE_CODEGEN_x86_64
+#include "scheduler_x86_64.h"
+#endif
+
 namespace art {
 
 void SchedulingGraph::AddDependency(SchedulingNode* node,
@@ -797,7 +802,8 @@ bool HScheduler::IsSchedulingBarrier(const HInstruction* instr) const {
 
 bool HInstructionScheduling::Run(bool only_optimize_loop_blocks,
                                  bool schedule_randomly) {
-#if defined(ART_ENABLE_CODEGEN_arm64) || defined(ART_ENABLE_CODEGEN_arm)
+#if defined(ART_ENABLE_CODEGEN_arm64) || defined(ART_ENABLE_CODEGEN_arm) || \
+    defined(ART_ENABLE_CODEGEN_x86_64)
   // Phase-local allocator that allocates scheduler internal data structures like
   // scheduling nodes, internel nodes map, dependencies, etc.
   CriticalPathSchedulingNodeSelector critical_path_selector;
@@ -815,7 +821,13 @@ bool HInstructionScheduling::Run(bool only_optimize_loop_blocks,
   switch (instruction_set_) {
 #ifdef ART_ENABLE_CODEGEN_arm64
     case InstructionSet::kArm64: {
-      arm64::HSchedulerARM64 scheduler(selector);
+      // The in-order cores need their own latencies, they cannot hide them behind other work.
+      bool is_in_order = codegen_ != nullptr &&
+          codegen_->GetCompilerOptions().GetInstructionSetFeatures()
+              ->AsArm64InstructionSetFeatures()->IsInOrder();
+      arm64::HSchedulerARM64 scheduler(selector,
+                                       is_in_order ? arm64::kArm64InOrderLatencyModel
+                                                   : arm64::kArm64GenericLatencyModel);
       scheduler.SetOnlyOptimizeLoopBlocks(only_optimize_loop_blocks);
       scheduler.Schedule(graph_);
       break;
@@ -830,6 +842,14 @@ bool HInstructionScheduling::Run(bool only_optimize_loop_blocks,
       scheduler.Schedule(graph_);
       break;
     }
+#endif
+#ifdef ART_ENABLE_CODEGEN_x86_64
+    case InstructionSet::kX86_64: {
+      x86_64::HSchedulerX86_64 scheduler(selector);
+      scheduler.SetOnlyOptimizeLoopBlocks(only_optimize_loop_blocks);
+      scheduler.Schedule(graph_);
+      break;
+    }
 #endif
     default:
       break;
@@ -25,56 +25,56 @@ namespace arm64 {
 
 void SchedulingLatencyVisitorARM64::VisitBinaryOperation(HBinaryOperation* instr) {
   last_visited_latency_ = DataType::IsFloatingPointType(instr->GetResultType())
-      ? kArm64FloatingPointOpLatency
-      : kArm64IntegerOpLatency;
+      ? latencies_.floating_point_op
+      : latencies_.integer_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitBitwiseNegatedRight(
     HBitwiseNegatedRight* ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64IntegerOpLatency;
+  last_visited_latency_ = latencies_.integer_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitDataProcWithShifterOp(
     HDataProcWithShifterOp* ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64DataProcWithShifterOpLatency;
+  last_visited_latency_ = latencies_.data_proc_with_shifter_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitIntermediateAddress(
     HIntermediateAddress* ATTRIBUTE_UNUSED) {
   // Although the code generated is a simple `add` instruction, we found through empirical results
   // that spacing it from its use in memory accesses was beneficial.
-  last_visited_latency_ = kArm64IntegerOpLatency + 2;
+  last_visited_latency_ = latencies_.integer_op + 2;
 }
 
 void SchedulingLatencyVisitorARM64::VisitIntermediateAddressIndex(
     HIntermediateAddressIndex* instr ATTRIBUTE_UNUSED) {
   // Although the code generated is a simple `add` instruction, we found through empirical results
   // that spacing it from its use in memory accesses was beneficial.
-  last_visited_latency_ = kArm64DataProcWithShifterOpLatency + 2;
+  last_visited_latency_ = latencies_.data_proc_with_shifter_op + 2;
 }
 
 void SchedulingLatencyVisitorARM64::VisitMultiplyAccumulate(HMultiplyAccumulate* ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64MulIntegerLatency;
+  last_visited_latency_ = latencies_.mul_integer;
 }
 
 void SchedulingLatencyVisitorARM64::VisitArrayGet(HArrayGet* instruction) {
   if (!instruction->GetArray()->IsIntermediateAddress()) {
     // Take the intermediate address computation into account.
-    last_visited_internal_latency_ = kArm64IntegerOpLatency;
+    last_visited_internal_latency_ = latencies_.integer_op;
   }
-  last_visited_latency_ = kArm64MemoryLoadLatency;
+  last_visited_latency_ = latencies_.memory_load;
 }
 
 void SchedulingLatencyVisitorARM64::VisitArrayLength(HArrayLength* ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64MemoryLoadLatency;
+  last_visited_latency_ = latencies_.memory_load;
 }
 
 void SchedulingLatencyVisitorARM64::VisitArraySet(HArraySet* ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64MemoryStoreLatency;
+  last_visited_latency_ = latencies_.memory_store;
 }
 
 void SchedulingLatencyVisitorARM64::VisitBoundsCheck(HBoundsCheck* ATTRIBUTE_UNUSED) {
-  last_visited_internal_latency_ = kArm64IntegerOpLatency;
+  last_visited_internal_latency_ = latencies_.integer_op;
   // Users do not use any data results.
   last_visited_latency_ = 0;
 }
@@ -83,10 +83,10 @@ void SchedulingLatencyVisitorARM64::VisitDiv(HDiv* instr) {
   DataType::Type type = instr->GetResultType();
   switch (type) {
     case DataType::Type::kFloat32:
-      last_visited_latency_ = kArm64DivFloatLatency;
+      last_visited_latency_ = latencies_.div_float;
       break;
     case DataType::Type::kFloat64:
-      last_visited_latency_ = kArm64DivDoubleLatency;
+      last_visited_latency_ = latencies_.div_double;
       break;
     default:
       // Follow the code path used by code generation.
@@ -97,65 +97,65 @@ void SchedulingLatencyVisitorARM64::VisitDiv(HDiv* instr) {
           last_visited_latency_ = 0;
         } else if (imm == 1 || imm == -1) {
           last_visited_internal_latency_ = 0;
-          last_visited_latency_ = kArm64IntegerOpLatency;
+          last_visited_latency_ = latencies_.integer_op;
         } else if (IsPowerOfTwo(AbsOrMin(imm))) {
-          last_visited_internal_latency_ = 4 * kArm64IntegerOpLatency;
-          last_visited_latency_ = kArm64IntegerOpLatency;
+          last_visited_internal_latency_ = 4 * latencies_.integer_op;
+          last_visited_latency_ = latencies_.integer_op;
         } else {
           DCHECK(imm <= -2 || imm >= 2);
-          last_visited_internal_latency_ = 4 * kArm64IntegerOpLatency;
-          last_visited_latency_ = kArm64MulIntegerLatency;
+          last_visited_internal_latency_ = 4 * latencies_.integer_op;
+          last_visited_latency_ = latencies_.mul_integer;
         }
       } else {
-        last_visited_latency_ = kArm64DivIntegerLatency;
+        last_visited_latency_ = latencies_.div_integer;
       }
       break;
   }
 }
 
 void SchedulingLatencyVisitorARM64::VisitInstanceFieldGet(HInstanceFieldGet* ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64MemoryLoadLatency;
+  last_visited_latency_ = latencies_.memory_load;
 }
 
 void SchedulingLatencyVisitorARM64::VisitInstanceOf(HInstanceOf* ATTRIBUTE_UNUSED) {
-  last_visited_internal_latency_ = kArm64CallInternalLatency;
-  last_visited_latency_ = kArm64IntegerOpLatency;
+  last_visited_internal_latency_ = latencies_.call_internal;
+  last_visited_latency_ = latencies_.integer_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitInvoke(HInvoke* ATTRIBUTE_UNUSED) {
-  last_visited_internal_latency_ = kArm64CallInternalLatency;
-  last_visited_latency_ = kArm64CallLatency;
+  last_visited_internal_latency_ = latencies_.call_internal;
+  last_visited_latency_ = latencies_.call;
 }
 
 void SchedulingLatencyVisitorARM64::VisitLoadString(HLoadString* ATTRIBUTE_UNUSED) {
-  last_visited_internal_latency_ = kArm64LoadStringInternalLatency;
-  last_visited_latency_ = kArm64MemoryLoadLatency;
+  last_visited_internal_latency_ = latencies_.load_string_internal;
+  last_visited_latency_ = latencies_.memory_load;
 }
 
 void SchedulingLatencyVisitorARM64::VisitMul(HMul* instr) {
   last_visited_latency_ = DataType::IsFloatingPointType(instr->GetResultType())
-      ? kArm64MulFloatingPointLatency
-      : kArm64MulIntegerLatency;
+      ? latencies_.mul_floating_point
+      : latencies_.mul_integer;
 }
 
 void SchedulingLatencyVisitorARM64::VisitNewArray(HNewArray* ATTRIBUTE_UNUSED) {
-  last_visited_internal_latency_ = kArm64IntegerOpLatency + kArm64CallInternalLatency;
-  last_visited_latency_ = kArm64CallLatency;
+  last_visited_internal_latency_ = latencies_.integer_op + latencies_.call_internal;
+  last_visited_latency_ = latencies_.call;
 }
 
 void SchedulingLatencyVisitorARM64::VisitNewInstance(HNewInstance* instruction) {
   if (instruction->IsStringAlloc()) {
-    last_visited_internal_latency_ = 2 + kArm64MemoryLoadLatency + kArm64CallInternalLatency;
+    last_visited_internal_latency_ = 2 + latencies_.memory_load + latencies_.call_internal;
   } else {
-    last_visited_internal_latency_ = kArm64CallInternalLatency;
+    last_visited_internal_latency_ = latencies_.call_internal;
   }
-  last_visited_latency_ = kArm64CallLatency;
+  last_visited_latency_ = latencies_.call;
 }
 
 void SchedulingLatencyVisitorARM64::VisitRem(HRem* instruction) {
   if (DataType::IsFloatingPointType(instruction->GetResultType())) {
-    last_visited_internal_latency_ = kArm64CallInternalLatency;
-    last_visited_latency_ = kArm64CallLatency;
+    last_visited_internal_latency_ = latencies_.call_internal;
+    last_visited_latency_ = latencies_.call;
   } else {
     // Follow the code path used by code generation.
     if (instruction->GetRight()->IsConstant()) {
@@ -165,24 +165,24 @@ void SchedulingLatencyVisitorARM64::VisitRem(HRem* instruction) {
         last_visited_latency_ = 0;
       } else if (imm == 1 || imm == -1) {
         last_visited_internal_latency_ = 0;
-        last_visited_latency_ = kArm64IntegerOpLatency;
+        last_visited_latency_ = latencies_.integer_op;
       } else if (IsPowerOfTwo(AbsOrMin(imm))) {
-        last_visited_internal_latency_ = 4 * kArm64IntegerOpLatency;
-        last_visited_latency_ = kArm64IntegerOpLatency;
+        last_visited_internal_latency_ = 4 * latencies_.integer_op;
+        last_visited_latency_ = latencies_.integer_op;
       } else {
         DCHECK(imm <= -2 || imm >= 2);
-        last_visited_internal_latency_ = 4 * kArm64IntegerOpLatency;
-        last_visited_latency_ = kArm64MulIntegerLatency;
+        last_visited_internal_latency_ = 4 * latencies_.integer_op;
+        last_visited_latency_ = latencies_.mul_integer;
       }
     } else {
-      last_visited_internal_latency_ = kArm64DivIntegerLatency;
-      last_visited_latency_ = kArm64MulIntegerLatency;
+      last_visited_internal_latency_ = latencies_.div_integer;
+      last_visited_latency_ = latencies_.mul_integer;
     }
   }
 }
 
 void SchedulingLatencyVisitorARM64::VisitStaticFieldGet(HStaticFieldGet* ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64MemoryLoadLatency;
+  last_visited_latency_ = latencies_.memory_load;
 }
 
 void SchedulingLatencyVisitorARM64::VisitSuspendCheck(HSuspendCheck* instruction) {
@@ -196,23 +196,23 @@ void SchedulingLatencyVisitorARM64::VisitSuspendCheck(HSuspendCheck* instruction
 void SchedulingLatencyVisitorARM64::VisitTypeConversion(HTypeConversion* instr) {
   if (DataType::IsFloatingPointType(instr->GetResultType()) ||
       DataType::IsFloatingPointType(instr->GetInputType())) {
-    last_visited_latency_ = kArm64TypeConversionFloatingPointIntegerLatency;
+    last_visited_latency_ = latencies_.type_conversion_floating_point_integer;
   } else {
-    last_visited_latency_ = kArm64IntegerOpLatency;
+    last_visited_latency_ = latencies_.integer_op;
   }
 }
 
 void SchedulingLatencyVisitorARM64::HandleSimpleArithmeticSIMD(HVecOperation *instr) {
   if (DataType::IsFloatingPointType(instr->GetPackedType())) {
-    last_visited_latency_ = kArm64SIMDFloatingPointOpLatency;
+    last_visited_latency_ = latencies_.simd_floating_point_op;
   } else {
-    last_visited_latency_ = kArm64SIMDIntegerOpLatency;
+    last_visited_latency_ = latencies_.simd_integer_op;
   }
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecReplicateScalar(
     HVecReplicateScalar* instr ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64SIMDReplicateOpLatency;
+  last_visited_latency_ = latencies_.simd_replicate_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecExtractScalar(HVecExtractScalar* instr) {
@@ -224,7 +224,7 @@ void SchedulingLatencyVisitorARM64::VisitVecReduce(HVecReduce* instr) {
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecCnv(HVecCnv* instr ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64SIMDTypeConversionInt2FPLatency;
+  last_visited_latency_ = latencies_.simd_type_conversion_int_to_fp;
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecNeg(HVecNeg* instr) {
@@ -237,9 +237,9 @@ void SchedulingLatencyVisitorARM64::VisitVecAbs(HVecAbs* instr) {
 
 void SchedulingLatencyVisitorARM64::VisitVecNot(HVecNot* instr) {
   if (instr->GetPackedType() == DataType::Type::kBool) {
-    last_visited_internal_latency_ = kArm64SIMDIntegerOpLatency;
+    last_visited_internal_latency_ = latencies_.simd_integer_op;
   }
-  last_visited_latency_ = kArm64SIMDIntegerOpLatency;
+  last_visited_latency_ = latencies_.simd_integer_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecAdd(HVecAdd* instr) {
@@ -256,18 +256,18 @@ void SchedulingLatencyVisitorARM64::VisitVecSub(HVecSub* instr) {
 
 void SchedulingLatencyVisitorARM64::VisitVecMul(HVecMul* instr) {
   if (DataType::IsFloatingPointType(instr->GetPackedType())) {
-    last_visited_latency_ = kArm64SIMDMulFloatingPointLatency;
+    last_visited_latency_ = latencies_.simd_mul_floating_point;
   } else {
-    last_visited_latency_ = kArm64SIMDMulIntegerLatency;
+    last_visited_latency_ = latencies_.simd_mul_integer;
   }
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecDiv(HVecDiv* instr) {
   if (instr->GetPackedType() == DataType::Type::kFloat32) {
-    last_visited_latency_ = kArm64SIMDDivFloatLatency;
+    last_visited_latency_ = latencies_.simd_div_float;
   } else {
     DCHECK(instr->GetPackedType() == DataType::Type::kFloat64);
-    last_visited_latency_ = kArm64SIMDDivDoubleLatency;
+    last_visited_latency_ = latencies_.simd_div_double;
   }
 }
 
@@ -280,19 +280,19 @@ void SchedulingLatencyVisitorARM64::VisitVecMax(HVecMax* instr) {
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecAnd(HVecAnd* instr ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64SIMDIntegerOpLatency;
+  last_visited_latency_ = latencies_.simd_integer_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecAndNot(HVecAndNot* instr ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64SIMDIntegerOpLatency;
+  last_visited_latency_ = latencies_.simd_integer_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecOr(HVecOr* instr ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64SIMDIntegerOpLatency;
+  last_visited_latency_ = latencies_.simd_integer_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecXor(HVecXor* instr ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64SIMDIntegerOpLatency;
+  last_visited_latency_ = latencies_.simd_integer_op;
 }
 
 void SchedulingLatencyVisitorARM64::VisitVecShl(HVecShl* instr) {
@@ -313,7 +313,7 @@ void SchedulingLatencyVisitorARM64::VisitVecSetScalars(HVecSetScalars* instr) {
 
 void SchedulingLatencyVisitorARM64::VisitVecMultiplyAccumulate(
     HVecMultiplyAccumulate* instr ATTRIBUTE_UNUSED) {
-  last_visited_latency_ = kArm64SIMDMulIntegerLatency;
+  last_visited_latency_ = latencies_.simd_mul_integer;
 }
 
 void SchedulingLatencyVisitorARM64::HandleVecAddress(
@@ -321,7 +321,7 @@ void SchedulingLatencyVisitorARM64::HandleVecAddress(
     size_t size ATTRIBUTE_UNUSED) {
   HInstruction* index = instruction->InputAt(1);
   if (!index->IsConstant()) {
-    last_visited_internal_latency_ += kArm64DataProcWithShifterOpLatency;
+    last_visited_internal_latency_ += latencies_.data_proc_with_shifter_op;
   }
 }
 
@@ -333,12 +333,12 @@ void SchedulingLatencyVisitorARM64::VisitVecLoad(HVecLoad* instr) {
       && mirror::kUseStringCompression
       && instr->IsStringCharAt()) {
     // Set latencies for the uncompressed case.
-    last_visited_internal_latency_ += kArm64MemoryLoadLatency + kArm64BranchLatency;
+    last_visited_internal_latency_ += latencies_.memory_load + latencies_.branch;
     HandleVecAddress(instr, size);
-    last_visited_latency_ = kArm64SIMDMemoryLoadLatency;
+    last_visited_latency_ = latencies_.simd_memory_load;
   } else {
     HandleVecAddress(instr, size);
-    last_visited_latency_ = kArm64SIMDMemoryLoadLatency;
+    last_visited_latency_ = latencies_.simd_memory_load;
   }
 }
 
@@ -346,7 +346,7 @@ void SchedulingLatencyVisitorARM64::VisitVecStore(HVecStore* instr) {
   last_visited_internal_latency_ = 0;
   size_t size = DataType::Size(instr->GetPackedType());
   HandleVecAddress(instr, size);
-  last_visited_latency_ = kArm64SIMDMemoryStoreLatency;
+  last_visited_latency_ = latencies_.simd_memory_store;
 }
 
 }  // namespace arm64
@@ -22,44 +22,109 @@
 namespace art {
 namespace arm64 {
 
-static constexpr uint32_t kArm64MemoryLoadLatency = 5;
-static constexpr uint32_t kArm64MemoryStoreLatency = 3;
-
-static constexpr uint32_t kArm64CallInternalLatency = 10;
-static constexpr uint32_t kArm64CallLatency = 5;
-
-// AArch64 instruction latency.
-// We currently assume that all arm64 CPUs share the same instruction latency list.
-static constexpr uint32_t kArm64IntegerOpLatency = 2;
-static constexpr uint32_t kArm64FloatingPointOpLatency = 5;
-
-
-static constexpr uint32_t kArm64DataProcWithShifterOpLatency = 3;
-static constexpr uint32_t kArm64DivDoubleLatency = 30;
-static constexpr uint32_t kArm64DivFloatLatency = 15;
-static constexpr uint32_t kArm64DivIntegerLatency = 5;
-static constexpr uint32_t kArm64LoadStringInternalLatency = 7;
-static constexpr uint32_t kArm64MulFloatingPointLatency = 6;
-static constexpr uint32_t kArm64MulIntegerLatency = 6;
-static constexpr uint32_t kArm64TypeConversionFloatingPointIntegerLatency = 5;
-static constexpr uint32_t kArm64BranchLatency = kArm64IntegerOpLatency;
-
-static constexpr uint32_t kArm64SIMDFloatingPointOpLatency = 10;
-static constexpr uint32_t kArm64SIMDIntegerOpLatency = 6;
-static constexpr uint32_t kArm64SIMDMemoryLoadLatency = 10;
-static constexpr uint32_t kArm64SIMDMemoryStoreLatency = 6;
-static constexpr uint32_t kArm64SIMDMulFloatingPointLatency = 12;
-static constexpr uint32_t kArm64SIMDMulIntegerLatency = 12;
-static constexpr uint32_t kArm64SIMDReplicateOpLatency = 16;
-static constexpr uint32_t kArm64SIMDDivDoubleLatency = 60;
-static constexpr uint32_t kArm64SIMDDivFloatLatency = 30;
-static constexpr uint32_t kArm64SIMDTypeConversionInt2FPLatency = 10;
+// Instruction latencies, in cycles, of a family of AArch64 CPUs.
+struct Arm64LatencyModel {
+  uint32_t memory_load;
+  uint32_t memory_store;
+
+  uint32_t call_internal;
+  uint32_t call;
+
+  uint32_t integer_op;
+  uint32_t floating_point_op;
+
+  uint32_t data_proc_with_shifter_op;
+  uint32_t div_double;
+  uint32_t div_float;
+  uint32_t div_integer;
+  uint32_t load_string_internal;
+  uint32_t mul_floating_point;
+  uint32_t mul_integer;
+  uint32_t type_conversion_floating_point_integer;
+  uint32_t branch;
+
+  uint32_t simd_floating_point_op;
+  uint32_t simd_integer_op;
+  uint32_t simd_memory_load;
+  uint32_t simd_memory_store;
+  uint32_t simd_mul_floating_point;
+  uint32_t simd_mul_integer;
+  uint32_t simd_replicate_op;
+  uint32_t simd_div_double;
+  uint32_t simd_div_float;
+  uint32_t simd_type_conversion_int_to_fp;
+};
+
+// The model used for the CPUs without a more specific one. It is tuned for the out-of-order
+// cores, and pessimistic about the memory latencies.
+static constexpr Arm64LatencyModel kArm64GenericLatencyModel = {
+  /* memory_load= */ 5,
+  /* memory_store= */ 3,
+  /* call_internal= */ 10,
+  /* call= */ 5,
+  /* integer_op= */ 2,
+  /* floating_point_op= */ 5,
+  /* data_proc_with_shifter_op= */ 3,
+  /* div_double= */ 30,
+  /* div_float= */ 15,
+  /* div_integer= */ 5,
+  /* load_string_internal= */ 7,
+  /* mul_floating_point= */ 6,
+  /* mul_integer= */ 6,
+  /* type_conversion_floating_point_integer= */ 5,
+  /* branch= */ 2,
+  /* simd_floating_point_op= */ 10,
+  /* simd_integer_op= */ 6,
+  /* simd_memory_load= */ 10,
+  /* simd_memory_store= */ 6,
+  /* simd_mul_floating_point= */ 12,
+  /* simd_mul_integer= */ 12,
+  /* simd_replicate_op= */ 16,
+  /* simd_div_double= */ 60,
+  /* simd_div_float= */ 30,
+  /* simd_type_conversion_int_to_fp= */ 10,
+};
+
+// The model of the in-order cores, from the Cortex-A55 optimization guide. These cores cannot
+// hide a latency behind independent instructions, so the latencies are the actual ones rather
+// than pessimistic ones.
+static constexpr Arm64LatencyModel kArm64InOrderLatencyModel = {
+  /* memory_load= */ 3,
+  /* memory_store= */ 1,
+  /* call_internal= */ 10,
+  /* call= */ 5,
+  /* integer_op= */ 1,
+  /* floating_point_op= */ 4,
+  /* data_proc_with_shifter_op= */ 2,
+  /* div_double= */ 22,
+  /* div_float= */ 13,
+  /* div_integer= */ 12,
+  /* load_string_internal= */ 5,
+  /* mul_floating_point= */ 4,
+  /* mul_integer= */ 3,
+  /* type_conversion_floating_point_integer= */ 4,
+  /* branch= */ 1,
+  /* simd_floating_point_op= */ 4,
+  /* simd_integer_op= */ 2,
+  /* simd_memory_load= */ 4,
+  /* simd_memory_store= */ 1,
+  /* simd_mul_floating_point= */ 4,
+  /* simd_mul_integer= */ 4,
+  /* simd_replicate_op= */ 3,
+  /* simd_div_double= */ 44,
+  /* simd_div_float= */ 26,
+  /* simd_type_conversion_int_to_fp= */ 4,
+};
 
 class SchedulingLatencyVisitorARM64 : public SchedulingLatencyVisitor {
  public:
+  explicit SchedulingLatencyVisitorARM64(
+      const Arm64LatencyModel& latencies = kArm64GenericLatencyModel)
+      : latencies_(latencies) {}
+
   // Default visitor for instructions not handled specifically below.
   void VisitInstruction(HInstruction* ATTRIBUTE_UNUSED) override {
-    last_visited_latency_ = kArm64IntegerOpLatency;
+    last_visited_latency_ = latencies_.integer_op;
   }
 
 // We add a second unused parameter to be able to use this macro like the others
@@ -130,12 +195,16 @@ class SchedulingLatencyVisitorARM64 : public SchedulingLatencyVisitor {
  private:
   void HandleSimpleArithmeticSIMD(HVecOperation *instr);
   void HandleVecAddress(HVecMemoryOperation* instruction, size_t size);
+
+  const Arm64LatencyModel& latencies_;
 };
 
 class HSchedulerARM64 : public HScheduler {
  public:
-  explicit HSchedulerARM64(SchedulingNodeSelector* selector)
-      : HScheduler(&arm64_latency_visitor_, selector) {}
+  explicit HSchedulerARM64(SchedulingNodeSelector* selector,
+                           const Arm64LatencyModel& latencies = kArm64GenericLatencyModel)
+      : HScheduler(&arm64_latency_visitor_, selector),
+        arm64_latency_visitor_(latencies) {}
   ~HSchedulerARM64() override {}
 
   bool IsSchedulable(const HInstruction* instruction) const override {
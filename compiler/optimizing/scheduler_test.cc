@@ -34,6 +34,10 @@
 #include "scheduler_arm.h"
 #endif
 
+#ifdef ART_ENABLE_CODEGEN_x86_64
+#include "scheduler_x86_64.h"
+#endif
+
 namespace art {
 
 // Return all combinations of ISA and code generator that are executable on
@@ -399,6 +403,12 @@ TEST_F(SchedulerTest, ArrayAccessAliasingARM64) {
   arm64::HSchedulerARM64 scheduler(&critical_path_selector);
   TestDependencyGraphOnAliasingArrayAccesses(&scheduler);
 }
+
+TEST_F(SchedulerTest, DependencyGraphAndSchedulerARM64InOrder) {
+  CriticalPathSchedulingNodeSelector critical_path_selector;
+  arm64::HSchedulerARM64 scheduler(&critical_path_selector, arm64::kArm64InOrderLatencyModel);
+  TestBuildDependencyGraphAndSchedule(&scheduler);
+}
 #endif
 
 #if defined(ART_ENABLE_CODEGEN_arm)
@@ -417,6 +427,20 @@ TEST_F(SchedulerTest, ArrayAccessAliasingARM) {
 }
 #endif
 
+#if defined(ART_ENABLE_CODEGEN_x86_64)
+TEST_F(SchedulerTest, DependencyGraphAndSchedulerX86_64) {
+  CriticalPathSchedulingNodeSelector critical_path_selector;
+  x86_64::HSchedulerX86_64 scheduler(&critical_path_selector);
+  TestBuildDependencyGraphAndSchedule(&scheduler);
+}
+
+TEST_F(SchedulerTest, ArrayAccessAliasingX86_64) {
+  CriticalPathSchedulingNodeSelector critical_path_selector;
+  x86_64::HSchedulerX86_64 scheduler(&critical_path_selector);
+  TestDependencyGraphOnAliasingArrayAccesses(&scheduler);
+}
+#endif
+
 TEST_F(SchedulerTest, RandomScheduling) {
   //
   // Java source: crafted code to make sure (random) scheduling should get correct result.
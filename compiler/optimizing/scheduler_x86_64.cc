@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scheduler_x86_64.h"
+
+#include "code_generator_utils.h"
+#include "mirror/string.h"
+
+namespace art {
+namespace x86_64 {
+
+void SchedulingLatencyVisitorX86_64::VisitBinaryOperation(HBinaryOperation* instr) {
+  last_visited_latency_ = DataType::IsFloatingPointType(instr->GetResultType())
+      ? kX86_64FloatingPointOpLatency
+      : kX86_64IntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitX86AndNot(HX86AndNot* ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64IntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitX86MaskOrResetLeastSetBit(
+    HX86MaskOrResetLeastSetBit* ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64IntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitArrayGet(HArrayGet* ATTRIBUTE_UNUSED) {
+  // The index is part of the addressing mode of the load.
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitArrayLength(HArrayLength* ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitArraySet(HArraySet* ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryStoreLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitBoundsCheck(HBoundsCheck* ATTRIBUTE_UNUSED) {
+  last_visited_internal_latency_ = kX86_64IntegerOpLatency;
+  // Users do not use any data results.
+  last_visited_latency_ = 0;
+}
+
+void SchedulingLatencyVisitorX86_64::HandleDivRemInteger(HBinaryOperation* instr) {
+  // Follow the code path used by code generation.
+  if (instr->GetRight()->IsConstant()) {
+    int64_t imm = Int64FromConstant(instr->GetRight()->AsConstant());
+    if (imm == 0) {
+      last_visited_internal_latency_ = 0;
+      last_visited_latency_ = 0;
+    } else if (imm == 1 || imm == -1) {
+      last_visited_internal_latency_ = 0;
+      last_visited_latency_ = kX86_64IntegerOpLatency;
+    } else if (IsPowerOfTwo(AbsOrMin(imm))) {
+      last_visited_internal_latency_ = 3 * kX86_64IntegerOpLatency;
+      last_visited_latency_ = kX86_64IntegerOpLatency;
+    } else {
+      DCHECK(imm <= -2 || imm >= 2);
+      last_visited_internal_latency_ = kX86_64MulIntegerLatency + 3 * kX86_64IntegerOpLatency;
+      last_visited_latency_ = kX86_64IntegerOpLatency;
+    }
+  } else {
+    last_visited_latency_ = (instr->GetResultType() == DataType::Type::kInt64)
+        ? kX86_64DivLongLatency
+        : kX86_64DivIntegerLatency;
+  }
+}
+
+void SchedulingLatencyVisitorX86_64::VisitDiv(HDiv* instr) {
+  DataType::Type type = instr->GetResultType();
+  switch (type) {
+    case DataType::Type::kFloat32:
+      last_visited_latency_ = kX86_64DivFloatLatency;
+      break;
+    case DataType::Type::kFloat64:
+      last_visited_latency_ = kX86_64DivDoubleLatency;
+      break;
+    default:
+      HandleDivRemInteger(instr);
+      break;
+  }
+}
+
+void SchedulingLatencyVisitorX86_64::VisitInstanceFieldGet(HInstanceFieldGet* ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitInstanceOf(HInstanceOf* ATTRIBUTE_UNUSED) {
+  last_visited_internal_latency_ = kX86_64CallInternalLatency;
+  last_visited_latency_ = kX86_64IntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitInvoke(HInvoke* ATTRIBUTE_UNUSED) {
+  last_visited_internal_latency_ = kX86_64CallInternalLatency;
+  last_visited_latency_ = kX86_64CallLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitLoadString(HLoadString* ATTRIBUTE_UNUSED) {
+  last_visited_internal_latency_ = kX86_64LoadStringInternalLatency;
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitMul(HMul* instr) {
+  last_visited_latency_ = DataType::IsFloatingPointType(instr->GetResultType())
+      ? kX86_64MulFloatingPointLatency
+      : kX86_64MulIntegerLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitNewArray(HNewArray* ATTRIBUTE_UNUSED) {
+  last_visited_internal_latency_ = kX86_64IntegerOpLatency + kX86_64CallInternalLatency;
+  last_visited_latency_ = kX86_64CallLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitNewInstance(HNewInstance* instruction) {
+  if (instruction->IsStringAlloc()) {
+    last_visited_internal_latency_ = 2 + kX86_64MemoryLoadLatency + kX86_64CallInternalLatency;
+  } else {
+    last_visited_internal_latency_ = kX86_64CallInternalLatency;
+  }
+  last_visited_latency_ = kX86_64CallLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitRem(HRem* instruction) {
+  if (DataType::IsFloatingPointType(instruction->GetResultType())) {
+    // The remainder is computed with an x87 `fprem` loop, through the stack.
+    last_visited_internal_latency_ = kX86_64CallInternalLatency;
+    last_visited_latency_ = kX86_64CallLatency;
+  } else {
+    HandleDivRemInteger(instruction);
+  }
+}
+
+void SchedulingLatencyVisitorX86_64::VisitStaticFieldGet(HStaticFieldGet* ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitSuspendCheck(HSuspendCheck* instruction) {
+  HBasicBlock* block = instruction->GetBlock();
+  DCHECK((block->GetLoopInformation() != nullptr) ||
+         (block->IsEntryBlock() && instruction->GetNext()->IsGoto()));
+  // Users do not use any data results.
+  last_visited_latency_ = 0;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitTypeConversion(HTypeConversion* instr) {
+  if (DataType::IsFloatingPointType(instr->GetResultType()) ||
+      DataType::IsFloatingPointType(instr->GetInputType())) {
+    last_visited_latency_ = kX86_64TypeConversionFloatingPointIntegerLatency;
+  } else {
+    last_visited_latency_ = kX86_64IntegerOpLatency;
+  }
+}
+
+void SchedulingLatencyVisitorX86_64::HandleSimpleArithmeticSIMD(HVecOperation *instr) {
+  if (DataType::IsFloatingPointType(instr->GetPackedType())) {
+    last_visited_latency_ = kX86_64SIMDFloatingPointOpLatency;
+  } else {
+    last_visited_latency_ = kX86_64SIMDIntegerOpLatency;
+  }
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecReplicateScalar(
+    HVecReplicateScalar* instr ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64SIMDReplicateOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecExtractScalar(HVecExtractScalar* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecReduce(HVecReduce* instr) {
+  // The reduction is a sequence of shuffles and operations.
+  last_visited_internal_latency_ = kX86_64SIMDReplicateOpLatency;
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecCnv(HVecCnv* instr ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64SIMDTypeConversionInt2FPLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecNeg(HVecNeg* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecAbs(HVecAbs* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecNot(HVecNot* instr) {
+  if (instr->GetPackedType() == DataType::Type::kBool) {
+    last_visited_internal_latency_ = kX86_64SIMDIntegerOpLatency;
+  }
+  last_visited_latency_ = kX86_64SIMDIntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecAdd(HVecAdd* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecHalvingAdd(HVecHalvingAdd* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecSub(HVecSub* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecMul(HVecMul* instr) {
+  if (DataType::IsFloatingPointType(instr->GetPackedType())) {
+    last_visited_latency_ = kX86_64SIMDMulFloatingPointLatency;
+  } else {
+    last_visited_latency_ = kX86_64SIMDMulIntegerLatency;
+  }
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecDiv(HVecDiv* instr) {
+  if (instr->GetPackedType() == DataType::Type::kFloat32) {
+    last_visited_latency_ = kX86_64SIMDDivFloatLatency;
+  } else {
+    DCHECK(instr->GetPackedType() == DataType::Type::kFloat64);
+    last_visited_latency_ = kX86_64SIMDDivDoubleLatency;
+  }
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecMin(HVecMin* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecMax(HVecMax* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecAnd(HVecAnd* instr ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64SIMDIntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecAndNot(HVecAndNot* instr ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64SIMDIntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecOr(HVecOr* instr ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64SIMDIntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecXor(HVecXor* instr ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64SIMDIntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecShl(HVecShl* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecShr(HVecShr* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecUShr(HVecUShr* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecSetScalars(HVecSetScalars* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecLoad(HVecLoad* instr) {
+  last_visited_internal_latency_ = 0;
+  if (instr->GetPackedType() == DataType::Type::kUint16
+      && mirror::kUseStringCompression
+      && instr->IsStringCharAt()) {
+    // Set latencies for the uncompressed case.
+    last_visited_internal_latency_ = kX86_64MemoryLoadLatency + kX86_64IntegerOpLatency;
+  }
+  last_visited_latency_ = kX86_64SIMDMemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitVecStore(HVecStore* instr ATTRIBUTE_UNUSED) {
+  last_visited_internal_latency_ = 0;
+  last_visited_latency_ = kX86_64SIMDMemoryStoreLatency;
+}
+
+}  // namespace x86_64
+}  // namespace art
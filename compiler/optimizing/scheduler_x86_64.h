@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_SCHEDULER_X86_64_H_
+#define ART_COMPILER_OPTIMIZING_SCHEDULER_X86_64_H_
+
+#include "scheduler.h"
+
+namespace art {
+namespace x86_64 {
+
+// x86-64 instruction latencies.
+// The x86-64 CPUs are out-of-order cores with short integer latencies, so the scheduler mostly
+// helps hiding the latencies of the loads, multiplications, divisions and floating point
+// operations. We currently assume that all of them share the same instruction latency list.
+static constexpr uint32_t kX86_64MemoryLoadLatency = 5;
+static constexpr uint32_t kX86_64MemoryStoreLatency = 1;
+
+static constexpr uint32_t kX86_64CallInternalLatency = 10;
+static constexpr uint32_t kX86_64CallLatency = 5;
+
+static constexpr uint32_t kX86_64IntegerOpLatency = 1;
+static constexpr uint32_t kX86_64FloatingPointOpLatency = 4;
+
+static constexpr uint32_t kX86_64DivDoubleLatency = 14;
+static constexpr uint32_t kX86_64DivFloatLatency = 11;
+static constexpr uint32_t kX86_64DivIntegerLatency = 26;
+static constexpr uint32_t kX86_64DivLongLatency = 40;
+static constexpr uint32_t kX86_64LoadStringInternalLatency = 6;
+static constexpr uint32_t kX86_64MulFloatingPointLatency = 4;
+static constexpr uint32_t kX86_64MulIntegerLatency = 3;
+static constexpr uint32_t kX86_64TypeConversionFloatingPointIntegerLatency = 6;
+
+static constexpr uint32_t kX86_64SIMDFloatingPointOpLatency = 4;
+static constexpr uint32_t kX86_64SIMDIntegerOpLatency = 1;
+static constexpr uint32_t kX86_64SIMDMemoryLoadLatency = 6;
+static constexpr uint32_t kX86_64SIMDMemoryStoreLatency = 1;
+static constexpr uint32_t kX86_64SIMDMulFloatingPointLatency = 4;
+static constexpr uint32_t kX86_64SIMDMulIntegerLatency = 10;
+static constexpr uint32_t kX86_64SIMDReplicateOpLatency = 3;
+static constexpr uint32_t kX86_64SIMDDivDoubleLatency = 14;
+static constexpr uint32_t kX86_64SIMDDivFloatLatency = 11;
+static constexpr uint32_t kX86_64SIMDTypeConversionInt2FPLatency = 4;
+
+class SchedulingLatencyVisitorX86_64 : public SchedulingLatencyVisitor {
+ public:
+  // Default visitor for instructions not handled specifically below.
+  void VisitInstruction(HInstruction* ATTRIBUTE_UNUSED) override {
+    last_visited_latency_ = kX86_64IntegerOpLatency;
+  }
+
+// We add a second unused parameter to be able to use this macro like the others
+// defined in `nodes.h`.
+#define FOR_EACH_SCHEDULED_X86_64_INSTRUCTION(M)     \
+  M(ArrayGet             , unused)                   \
+  M(ArrayLength          , unused)                   \
+  M(ArraySet             , unused)                   \
+  M(BoundsCheck          , unused)                   \
+  M(Div                  , unused)                   \
+  M(InstanceFieldGet     , unused)                   \
+  M(InstanceOf           , unused)                   \
+  M(LoadString           , unused)                   \
+  M(Mul                  , unused)                   \
+  M(NewArray             , unused)                   \
+  M(NewInstance          , unused)                   \
+  M(Rem                  , unused)                   \
+  M(StaticFieldGet       , unused)                   \
+  M(SuspendCheck         , unused)                   \
+  M(TypeConversion       , unused)                   \
+  M(VecReplicateScalar   , unused)                   \
+  M(VecExtractScalar     , unused)                   \
+  M(VecReduce            , unused)                   \
+  M(VecCnv               , unused)                   \
+  M(VecNeg               , unused)                   \
+  M(VecAbs               , unused)                   \
+  M(VecNot               , unused)                   \
+  M(VecAdd               , unused)                   \
+  M(VecHalvingAdd        , unused)                   \
+  M(VecSub               , unused)                   \
+  M(VecMul               , unused)                   \
+  M(VecDiv               , unused)                   \
+  M(VecMin               , unused)                   \
+  M(VecMax               , unused)                   \
+  M(VecAnd               , unused)                   \
+  M(VecAndNot            , unused)                   \
+  M(VecOr                , unused)                   \
+  M(VecXor               , unused)                   \
+  M(VecShl               , unused)                   \
+  M(VecShr               , unused)                   \
+  M(VecUShr              , unused)                   \
+  M(VecSetScalars        , unused)                   \
+  M(VecLoad              , unused)                   \
+  M(VecStore             , unused)
+
+#define FOR_EACH_SCHEDULED_ABSTRACT_X86_64_INSTRUCTION(M) \
+  M(BinaryOperation      , unused)                        \
+  M(Invoke               , unused)
+
+#define DECLARE_VISIT_INSTRUCTION(type, unused)  \
+  void Visit##type(H##type* instruction) override;
+
+  FOR_EACH_SCHEDULED_X86_64_INSTRUCTION(DECLARE_VISIT_INSTRUCTION)
+  FOR_EACH_SCHEDULED_ABSTRACT_X86_64_INSTRUCTION(DECLARE_VISIT_INSTRUCTION)
+  FOR_EACH_CONCRETE_INSTRUCTION_X86_COMMON(DECLARE_VISIT_INSTRUCTION)
+
+#undef DECLARE_VISIT_INSTRUCTION
+
+ private:
+  void HandleSimpleArithmeticSIMD(HVecOperation *instr);
+  void HandleDivRemInteger(HBinaryOperation* instr);
+};
+
+class HSchedulerX86_64 : public HScheduler {
+ public:
+  explicit HSchedulerX86_64(SchedulingNodeSelector* selector)
+      : HScheduler(&x86_64_latency_visitor_, selector) {}
+  ~HSchedulerX86_64() override {}
+
+  bool IsSchedulable(const HInstruction* instruction) const override {
+#define CASE_INSTRUCTION_KIND(type, unused) case \
+  HInstruction::InstructionKind::k##type:
+    switch (instruction->GetKind()) {
+      FOR_EACH_CONCRETE_INSTRUCTION_X86_COMMON(CASE_INSTRUCTION_KIND)
+        return true;
+      FOR_EACH_SCHEDULED_X86_64_INSTRUCTION(CASE_INSTRUCTION_KIND)
+        return true;
+      default:
+        return HScheduler::IsSchedulable(instruction);
+    }
+#undef CASE_INSTRUCTION_KIND
+  }
+
+  // As on ARM64, the vector instructions whose live ranges exceed the vectorized loop are
+  // scheduling barriers: all the live XMM registers are saved and restored around a call.
+  bool IsSchedulingBarrier(const HInstruction* instr) const override {
+    return HScheduler::IsSchedulingBarrier(instr) ||
+           instr->IsVecReduce() ||
+           instr->IsVecExtractScalar() ||
+           instr->IsVecSetScalars() ||
+           instr->IsVecReplicateScalar();
+  }
+
+ private:
+  SchedulingLatencyVisitorX86_64 x86_64_latency_visitor_;
+  DISALLOW_COPY_AND_ASSIGN(HSchedulerX86_64);
+};
+
+}  // namespace x86_64
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_SCHEDULER_X86_64_H_
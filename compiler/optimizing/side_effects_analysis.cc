@@ -81,6 +81,63 @@ SideEffects SideEffectsAnalysis::GetBlockEffects(HBasicBlock* block) const {
   return block_effects_[block->GetBlockId()];
 }
 
+bool SideEffectsAnalysis::MayDependOnLoopWrites(HInstruction* instruction,
+                                                HLoopInformation* info) const {
+  if (!instruction->GetSideEffects().MayDependOn(GetLoopEffects(info->GetHeader()))) {
+    return false;
+  }
+  if (!instruction->IsInstanceFieldGet() && !instruction->IsStaticFieldGet()) {
+    return true;
+  }
+  for (HBlocksInLoopIterator it_loop(*info); !it_loop.Done(); it_loop.Advance()) {
+    HBasicBlock* block = it_loop.Current();
+    if (!instruction->GetSideEffects().MayDependOn(GetBlockEffects(block))) {
+      continue;
+    }
+    for (HInstructionIterator inst_it(block->GetInstructions()); !inst_it.Done();
+         inst_it.Advance()) {
+      if (MayDependOn(instruction, inst_it.Current())) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static const FieldInfo* GetFieldInfoOrNull(HInstruction* instruction) {
+  if (instruction->IsInstanceFieldGet()) {
+    return &instruction->AsInstanceFieldGet()->GetFieldInfo();
+  } else if (instruction->IsInstanceFieldSet()) {
+    return &instruction->AsInstanceFieldSet()->GetFieldInfo();
+  } else if (instruction->IsStaticFieldGet()) {
+    return &instruction->AsStaticFieldGet()->GetFieldInfo();
+  } else if (instruction->IsStaticFieldSet()) {
+    return &instruction->AsStaticFieldSet()->GetFieldInfo();
+  } else {
+    return nullptr;
+  }
+}
+
+bool SideEffectsAnalysis::MayDependOn(HInstruction* instruction, HInstruction* write) {
+  if (!instruction->GetSideEffects().MayDependOn(write->GetSideEffects())) {
+    return false;
+  }
+  const FieldInfo* read_field = GetFieldInfoOrNull(instruction);
+  const FieldInfo* write_field = GetFieldInfoOrNull(write);
+  if (read_field == nullptr ||
+      write_field == nullptr ||
+      read_field->IsVolatile() ||
+      write_field->IsVolatile()) {
+    return true;
+  }
+  // Fields at different offsets never overlap, whichever objects they belong to.
+  size_t read_start = read_field->GetFieldOffset().SizeValue();
+  size_t read_end = read_start + DataType::Size(read_field->GetFieldType());
+  size_t write_start = write_field->GetFieldOffset().SizeValue();
+  size_t write_end = write_start + DataType::Size(write_field->GetFieldType());
+  return read_start < write_end && write_start < read_end;
+}
+
 void SideEffectsAnalysis::UpdateLoopEffects(HLoopInformation* info, SideEffects effects) {
   uint32_t id = info->GetHeader()->GetBlockId();
   loop_effects_[id] = loop_effects_[id].Union(effects);
@@ -36,6 +36,16 @@ class SideEffectsAnalysis : public HOptimization {
   SideEffects GetLoopEffects(HBasicBlock* block) const;
   SideEffects GetBlockEffects(HBasicBlock* block) const;
 
+  // Returns whether `instruction` may depend on a write in the loop `info`. This is
+  // more precise than `GetLoopEffects` for field loads, as it looks at the stores
+  // of the loop and ignores the ones to other field offsets.
+  bool MayDependOnLoopWrites(HInstruction* instruction, HLoopInformation* info) const;
+
+  // Returns whether `instruction` may depend on `write`. Side effects only tell field
+  // accesses apart by type, so two accesses to non-overlapping field offsets are
+  // additionally known to be independent.
+  static bool MayDependOn(HInstruction* instruction, HInstruction* write);
+
   // Compute side effects of individual blocks and loops.
   bool Run();
 
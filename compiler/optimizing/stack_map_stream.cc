@@ -16,6 +16,7 @@
 
 #include "stack_map_stream.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "art_method-inl.h"
@@ -43,7 +44,8 @@ void StackMapStream::BeginMethod(size_t frame_size_in_bytes,
                                  size_t core_spill_mask,
                                  size_t fp_spill_mask,
                                  uint32_t num_dex_registers,
-                                 bool baseline) {
+                                 bool baseline,
+                                 bool baseline_plus) {
   DCHECK(!in_method_) << "Mismatched Begin/End calls";
   in_method_ = true;
   DCHECK_EQ(packed_frame_size_, 0u) << "BeginMethod was already called";
@@ -54,6 +56,7 @@ void StackMapStream::BeginMethod(size_t frame_size_in_bytes,
   fp_spill_mask_ = fp_spill_mask;
   num_dex_registers_ = num_dex_registers;
   baseline_ = baseline;
+  baseline_plus_ = baseline_plus;
 
   if (kVerifyStackMaps) {
     dchecks_.emplace_back([=](const CodeInfo& code_info) {
@@ -178,10 +181,12 @@ void StackMapStream::EndStackMapEntry() {
   }
 }
 
-void StackMapStream::BeginInlineInfoEntry(ArtMethod* method,
-                                          uint32_t dex_pc,
-                                          uint32_t num_dex_registers,
-                                          const DexFile* outer_dex_file) {
+void StackMapStream::BeginInlineInfoEntry(
+    ArtMethod* method,
+    uint32_t dex_pc,
+    uint32_t num_dex_registers,
+    const DexFile* outer_dex_file,
+    const std::vector<const DexFile*>* dex_files_for_oat_file) {
   DCHECK(in_stack_map_) << "Call BeginStackMapEntry first";
   DCHECK(!in_inline_info_) << "Mismatched Begin/End calls";
   in_inline_info_ = true;
@@ -190,6 +195,7 @@ void StackMapStream::BeginInlineInfoEntry(ArtMethod* method,
   expected_num_dex_registers_ += num_dex_registers;
 
   BitTableBuilder<InlineInfo>::Entry entry;
+  uint32_t dex_file_index = MethodInfo::kSameDexFile;
   entry[InlineInfo::kIsLast] = InlineInfo::kMore;
   entry[InlineInfo::kDexPc] = dex_pc;
   entry[InlineInfo::kNumberOfDexRegisters] = static_cast<uint32_t>(expected_num_dex_registers_);
@@ -197,12 +203,20 @@ void StackMapStream::BeginInlineInfoEntry(ArtMethod* method,
     entry[InlineInfo::kArtMethodHi] = High32Bits(reinterpret_cast<uintptr_t>(method));
     entry[InlineInfo::kArtMethodLo] = Low32Bits(reinterpret_cast<uintptr_t>(method));
   } else {
-    if (dex_pc != static_cast<uint32_t>(-1) && kIsDebugBuild) {
+    if (dex_pc != static_cast<uint32_t>(-1) && outer_dex_file != nullptr) {
       ScopedObjectAccess soa(Thread::Current());
-      DCHECK(IsSameDexFile(*outer_dex_file, *method->GetDexFile()));
+      const DexFile* dex_file = method->GetDexFile();
+      if (!IsSameDexFile(*outer_dex_file, *dex_file)) {
+        // The method was inlined from another dex file of the oat file.
+        DCHECK(dex_files_for_oat_file != nullptr);
+        auto it = std::find(
+            dex_files_for_oat_file->begin(), dex_files_for_oat_file->end(), dex_file);
+        DCHECK(it != dex_files_for_oat_file->end());
+        dex_file_index = static_cast<uint32_t>(it - dex_files_for_oat_file->begin());
+      }
     }
     uint32_t dex_method_index = method->GetDexMethodIndex();
-    entry[InlineInfo::kMethodInfoIndex] = method_infos_.Dedup({dex_method_index});
+    entry[InlineInfo::kMethodInfoIndex] = method_infos_.Dedup({dex_method_index, dex_file_index});
   }
   current_inline_infos_.push_back(entry);
 
@@ -219,6 +233,7 @@ void StackMapStream::BeginInlineInfoEntry(ArtMethod* method,
         CHECK_EQ(inline_info.GetArtMethod(), method);
       } else {
         CHECK_EQ(code_info.GetMethodIndexOf(inline_info), method->GetDexMethodIndex());
+        CHECK_EQ(code_info.GetDexFileIndexOf(inline_info), dex_file_index);
       }
     });
   }
@@ -302,6 +317,7 @@ ScopedArenaVector<uint8_t> StackMapStream::Encode() {
 
   uint32_t flags = (inline_infos_.size() > 0) ? CodeInfo::kHasInlineInfo : 0;
   flags |= baseline_ ? CodeInfo::kIsBaseline : 0;
+  flags |= baseline_plus_ ? CodeInfo::kIsBaselinePlus : 0;
   uint32_t bit_table_flags = 0;
   ForEachBitTable([&bit_table_flags](size_t i, auto bit_table) {
     if (bit_table->size() != 0) {  // Record which bit-tables are stored.
@@ -62,7 +62,8 @@ class StackMapStream : public DeletableArenaObject<kArenaAllocStackMapStream> {
                    size_t core_spill_mask,
                    size_t fp_spill_mask,
                    uint32_t num_dex_registers,
-                   bool baseline = false);
+                   bool baseline = false,
+                   bool baseline_plus = false);
   void EndMethod();
 
   void BeginStackMapEntry(uint32_t dex_pc,
@@ -77,10 +78,14 @@ class StackMapStream : public DeletableArenaObject<kArenaAllocStackMapStream> {
     current_dex_registers_.push_back(DexRegisterLocation(kind, value));
   }
 
+  // `dex_files_for_oat_file` are the dex files of the oat file being compiled. They are
+  // needed when `method` is not encoded as an ArtMethod* and is in another dex file than
+  // `outer_dex_file`.
   void BeginInlineInfoEntry(ArtMethod* method,
                             uint32_t dex_pc,
                             uint32_t num_dex_registers,
-                            const DexFile* outer_dex_file = nullptr);
+                            const DexFile* outer_dex_file = nullptr,
+                            const std::vector<const DexFile*>* dex_files_for_oat_file = nullptr);
   void EndInlineInfoEntry();
 
   size_t GetNumberOfStackMaps() const {
@@ -121,6 +126,7 @@ class StackMapStream : public DeletableArenaObject<kArenaAllocStackMapStream> {
   uint32_t fp_spill_mask_ = 0;
   uint32_t num_dex_registers_ = 0;
   bool baseline_;
+  bool baseline_plus_;
   BitTableBuilder<StackMap> stack_maps_;
   BitTableBuilder<RegisterMask> register_masks_;
   BitmapTableBuilder stack_masks_;
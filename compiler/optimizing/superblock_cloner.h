@@ -160,7 +160,7 @@ class SuperblockCloner : public ValueObject {
   //
   // TODO: formally describe the criteria.
   //
-  // Loop peeling and unrolling satisfy the criteria.
+  // Loop peeling, unrolling and versioning satisfy the criteria.
   bool IsFastCase() const;
 
   // Runs the copy algorithm according to the description.
@@ -296,6 +296,14 @@ class SuperblockCloner : public ValueObject {
   // Remaps copy internal edge to its origin, adjusts the phi inputs in orig_succ.
   void RemapCopyInternalEdge(HBasicBlock* orig_block, HBasicBlock* orig_succ);
 
+  // Returns whether all the remapping sets are empty, which stands for loop versioning: the
+  // copy subgraph keeps its internal edges and gets a copy of each incoming edge.
+  bool IsRemapInfoForVersioning() const;
+
+  // For each incoming edge (X, Y) adds an edge (X, Y_1), with the same phi inputs in Y_1 as
+  // in Y. The new edge is the last successor of X.
+  void CopyIncomingEdgesForVersioning();
+
   //
   // Local versions of control flow calculation/adjustment routines.
   //
@@ -361,7 +369,7 @@ class SuperblockCloner : public ValueObject {
   DISALLOW_COPY_AND_ASSIGN(SuperblockCloner);
 };
 
-// Helper class to perform loop peeling/unrolling.
+// Helper class to perform loop peeling/unrolling/versioning.
 //
 // This helper should be used when correspondence map between original and copied
 // basic blocks/instructions are demanded.
@@ -385,6 +393,12 @@ class PeelUnrollHelper : public ValueObject {
 
   HBasicBlock* DoPeeling() { return DoPeelUnrollImpl(/* to_unroll= */ false); }
   HBasicBlock* DoUnrolling() { return DoPeelUnrollImpl(/* to_unroll= */ true); }
+
+  // Copies the loop next to the original one. The preheader of the loop must end with an HIf
+  // whose only successor is the loop header; the copy becomes its false successor. Returns the
+  // header of the copy.
+  HBasicBlock* DoVersioning();
+
   HLoopInformation* GetRegionToBeAdjusted() const { return cloner_.GetRegionToBeAdjusted(); }
 
  protected:
@@ -400,7 +414,7 @@ class PeelUnrollHelper : public ValueObject {
   DISALLOW_COPY_AND_ASSIGN(PeelUnrollHelper);
 };
 
-// Helper class to perform loop peeling/unrolling.
+// Helper class to perform loop peeling/unrolling/versioning.
 //
 // This helper should be used when there is no need to get correspondence information between
 // original and copied basic blocks/instructions.
@@ -410,6 +424,7 @@ class PeelUnrollSimpleHelper : public ValueObject {
   bool IsLoopClonable() const { return helper_.IsLoopClonable(); }
   HBasicBlock* DoPeeling() { return helper_.DoPeeling(); }
   HBasicBlock* DoUnrolling() { return helper_.DoUnrolling(); }
+  HBasicBlock* DoVersioning() { return helper_.DoVersioning(); }
   HLoopInformation* GetRegionToBeAdjusted() const { return helper_.GetRegionToBeAdjusted(); }
 
   const SuperblockCloner::HBasicBlockMap* GetBasicBlockMap() const { return &bb_map_; }
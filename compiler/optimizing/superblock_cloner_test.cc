@@ -408,6 +408,71 @@ TEST_F(SuperblockClonerTest, LoopUnrolling) {
   EXPECT_EQ(loop_info->GetBackEdges()[0], bb_map.Get(loop_body));
 }
 
+// Tests SuperblockCloner for loop versioning case.
+//
+// Control Flow of the example (ignoring critical edges splitting).
+//
+//       Before                    After
+//
+//         |B|                      |B|
+//          |                        |
+//          v                        v
+//         |1|                      |1|
+//          |                      /   \
+//          v                     v     v
+//         |2|<-\               |2|<-\  |2A|<-\
+//         / \  /               / \  /   / \   /
+//        v   v/               /   v/   /   v /
+//       |4|  |3|             /   |3|  /   |3A|
+//        |                   \       /
+//        v                    v     v
+//       |E|                     |4|
+//                                |
+//                                v
+//                               |E|
+TEST_F(SuperblockClonerTest, LoopVersioning) {
+  HBasicBlock* header = nullptr;
+  HBasicBlock* loop_body = nullptr;
+
+  InitGraph();
+  CreateBasicLoopControlFlow(entry_block_, return_block_, &header, &loop_body);
+  CreateBasicLoopDataFlow(header, loop_body);
+  graph_->BuildDominatorTree();
+  EXPECT_TRUE(CheckGraph());
+
+  // The versioning condition.
+  HLoopInformation* loop_info = header->GetLoopInformation();
+  HBasicBlock* preheader = loop_info->GetPreHeader();
+  preheader->AddInstruction(new (GetAllocator()) HIf(parameters_[0]));
+
+  HBasicBlockMap bb_map(
+      std::less<HBasicBlock*>(), graph_->GetAllocator()->Adapter(kArenaAllocSuperblockCloner));
+  HInstructionMap hir_map(
+      std::less<HInstruction*>(), graph_->GetAllocator()->Adapter(kArenaAllocSuperblockCloner));
+
+  PeelUnrollHelper helper(loop_info, &bb_map, &hir_map, /* induction_range= */ nullptr);
+  EXPECT_TRUE(helper.IsLoopClonable());
+  HBasicBlock* copy_header = helper.DoVersioning();
+
+  EXPECT_TRUE(CheckGraph());
+
+  // Check the versioning branch: the copy of the loop is its false successor.
+  EXPECT_EQ(copy_header, bb_map.Get(header));
+  EXPECT_EQ(preheader->GetSuccessors().size(), 2u);
+  EXPECT_EQ(preheader->GetSuccessors()[0]->GetSingleSuccessor(), header);
+  EXPECT_EQ(preheader->GetSuccessors()[1]->GetSingleSuccessor(), copy_header);
+
+  // Check loop structure.
+  EXPECT_EQ(loop_info, header->GetLoopInformation());
+  EXPECT_EQ(loop_info->GetBackEdges().size(), 1u);
+  EXPECT_EQ(loop_info->GetBackEdges()[0], loop_body);
+  HLoopInformation* copy_loop_info = copy_header->GetLoopInformation();
+  EXPECT_NE(copy_loop_info, loop_info);
+  EXPECT_EQ(copy_loop_info->GetHeader(), copy_header);
+  EXPECT_EQ(copy_loop_info->GetBackEdges().size(), 1u);
+  EXPECT_EQ(copy_loop_info->GetBackEdges()[0], bb_map.Get(loop_body));
+}
+
 // Checks that loop unrolling works fine for a loop with multiple back edges. Tests that after
 // the transformation the loop has a single preheader.
 TEST_F(SuperblockClonerTest, LoopPeelingMultipleBackEdges) {
@@ -81,6 +81,15 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
     return store_key;
   }
 
+  void Clear(Thread* self) REQUIRES(!lock_) {
+    MutexLock lock(self, lock_);
+    for (const HashedKey<StoreKey>& key : keys_) {
+      DCHECK(key.Key() != nullptr);
+      alloc_.Destroy(key.Key());
+    }
+    keys_.clear();
+  }
+
   void UpdateStats(Thread* self, Stats* global_stats) REQUIRES(!lock_) {
     // HashSet<> doesn't keep entries ordered by hash, so we actually allocate memory
     // for bookkeeping while collecting the stats.
@@ -202,6 +211,18 @@ const StoreKey* DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::A
   return shards_[shard_bin]->Add(self, shard_hash, key);
 }
 
+template <typename InKey,
+          typename StoreKey,
+          typename Alloc,
+          typename HashType,
+          typename HashFunc,
+          HashType kShard>
+void DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Clear(Thread* self) {
+  for (HashType i = 0; i < kShard; ++i) {
+    shards_[i]->Clear(self);
+  }
+}
+
 template <typename InKey,
           typename StoreKey,
           typename Alloc,
@@ -41,6 +41,9 @@ class DedupeSet {
   // Add a new key to the dedupe set if not present. Return the equivalent deduplicated stored key.
   const StoreKey* Add(Thread* self, const InKey& key);
 
+  // Destroy all the stored keys. The keys returned by Add() must no longer be in use.
+  void Clear(Thread* self);
+
   DedupeSet(const char* set_name, const Alloc& alloc);
 
   ~DedupeSet();
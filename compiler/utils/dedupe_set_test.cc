@@ -88,4 +88,27 @@ TEST(DedupeSetTest, Test) {
   }
 }
 
+TEST(DedupeSetTest, Clear) {
+  Thread* self = Thread::Current();
+  DedupeSetTestAlloc alloc;
+  DedupeSet<ArrayRef<const uint8_t>,
+            std::vector<uint8_t>,
+            DedupeSetTestAlloc,
+            size_t,
+            DedupeSetTestHashFunc,
+            4> deduplicator("test", alloc);
+  uint8_t raw_test1[] = { 10u, 20u, 30u, 45u };
+  uint8_t raw_test2[] = { 10u, 22u, 30u, 47u };
+  ASSERT_NE(deduplicator.Add(self, ArrayRef<const uint8_t>(raw_test1)), nullptr);
+  ASSERT_NE(deduplicator.Add(self, ArrayRef<const uint8_t>(raw_test2)), nullptr);
+
+  deduplicator.Clear(self);
+
+  // The set is usable again after clearing it.
+  const std::vector<uint8_t>* array1 = deduplicator.Add(self, ArrayRef<const uint8_t>(raw_test1));
+  ASSERT_NE(array1, nullptr);
+  ASSERT_TRUE(std::equal(std::begin(raw_test1), std::end(raw_test1), array1->begin()));
+  ASSERT_EQ(deduplicator.Add(self, ArrayRef<const uint8_t>(raw_test1)), array1);
+}
+
 }  // namespace art
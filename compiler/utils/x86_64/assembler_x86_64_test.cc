@@ -1873,6 +1873,10 @@ TEST_F(AssemblerX86_64Test, PCmpgtq) {
   DriverStr(RepeatFF(&x86_64::X86_64Assembler::pcmpgtq, "pcmpgtq %{reg2}, %{reg1}"), "pcmpgtq");
 }
 
+TEST_F(AssemblerX86_64Test, PMovmskb) {
+  DriverStr(RepeatrF(&x86_64::X86_64Assembler::pmovmskb, "pmovmskb %{reg2}, %{reg1}"), "pmovmskb");
+}
+
 TEST_F(AssemblerX86_64Test, Shufps) {
   DriverStr(RepeatFFI(&x86_64::X86_64Assembler::shufps, /*imm_bytes*/ 1U,
                       "shufps ${imm}, %{reg2}, %{reg1}"), "shufps");
@@ -37,6 +37,8 @@
 #endif  // __arm__
 #endif
 
+#include <openssl/sha.h>
+
 #include "android-base/parseint.h"
 #include "android-base/stringprintf.h"
 #include "android-base/strings.h"
@@ -49,6 +51,7 @@
 #include "base/file_utils.h"
 #include "base/leb128.h"
 #include "base/macros.h"
+#include "base/memfd.h"
 #include "base/mutex.h"
 #include "base/os.h"
 #include "base/scoped_flock.h"
@@ -73,6 +76,8 @@
 #include "dex2oat_options.h"
 #include "dex2oat_return_codes.h"
 #include "dexlayout.h"
+#include "driver/compiled_method_cache.h"
+#include "driver/compiled_method_storage.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
 #include "driver/compiler_options_map-inl.h"
@@ -369,11 +374,29 @@ NO_RETURN static void Usage(const char* fmt, ...) {
              CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("      Default: %d", CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("");
+  UsageError("  --register-allocation-strategy=(linear-scan|graph-color|graph-color-hot):");
+  UsageError("      select the register allocator. graph-color-hot uses graph coloring only for");
+  UsageError("      the methods that are hot in the profile, and linear scan otherwise.");
+  UsageError("      Default: linear-scan");
+  UsageError("");
+  UsageError("  --register-allocation-graph-color-max-ssa-values=<count>: the maximum number of");
+  UsageError("      SSA values of a method allocated by graph coloring. Larger methods are");
+  UsageError("      allocated by linear scan.");
+  UsageError("      Example: --register-allocation-graph-color-max-ssa-values=%zu",
+             CompilerOptions::kDefaultGraphColorMaxSsaValues);
+  UsageError("      Default: %zu", CompilerOptions::kDefaultGraphColorMaxSsaValues);
+  UsageError("");
   UsageError("  --dump-timings: display a breakdown of where time was spent");
   UsageError("");
   UsageError("  --dump-pass-timings: display a breakdown of time spent in optimization");
   UsageError("      passes for each compiled method.");
   UsageError("");
+  UsageError("  --dump-method-stats=<file>: append the statistics of each compiled method to the");
+  UsageError("      specified file, as one line of JSON per method: time and graph size after");
+  UsageError("      each pass, inlining decisions, code size and spill slots. Also available to");
+  UsageError("      the JIT through -Xcompiler-option.");
+  UsageError("      Example: --dump-method-stats=method-stats.json");
+  UsageError("");
   UsageError("  -g");
   UsageError("  --generate-debug-info: Generate debug information for native debugging,");
   UsageError("      such as stack unwinding information, ELF symbols and DWARF sections.");
@@ -426,6 +449,12 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("      Example: --swap-dex-count-threshold=10");
   UsageError("      Default: %zu", kDefaultMinDexFilesForSwap);
   UsageError("");
+  UsageError("  --compiled-method-cache=<directory>: reuse the code compiled for the same method");
+  UsageError("      by earlier dex2oat invocations with the same inputs and options, and store");
+  UsageError("      the code compiled by this one, in the given directory. The directory can be");
+  UsageError("      shared by concurrent dex2oat processes. Not used when compiling an image.");
+  UsageError("      Example: --compiled-method-cache=/tmp/dex2oat-cache");
+  UsageError("");
   UsageError("  --very-large-app-threshold=<size>: specifies the minimum total dex file size in");
   UsageError("      bytes to consider the input \"very large\" and reduce compilation done.");
   UsageError("      Example: --very-large-app-threshold=100000000");
@@ -519,6 +548,12 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --resolve-startup-const-strings=true|false: If true, the compiler eagerly");
   UsageError("      resolves strings referenced from const-string of startup methods.");
   UsageError("");
+  UsageError("  --initialize-startup-app-image-classes=true|false: If true, the compiler runs");
+  UsageError("      the class initializers that the profile marks as startup methods in");
+  UsageError("      transaction mode, and stores the classes initialized in the app image.");
+  UsageError("      Classes whose initializer has side effects outside the class are left");
+  UsageError("      uninitialized.");
+  UsageError("");
   UsageError("  --max-image-block-size=<size>: Maximum solid block size for compressed images.");
   UsageError("");
   std::cerr << "See log for usage error information\n";
@@ -782,7 +817,7 @@ class Dex2Oat final {
       key_value_store_(nullptr),
       verification_results_(nullptr),
       runtime_(nullptr),
-      thread_count_(sysconf(_SC_NPROCESSORS_CONF)),
+      thread_count_(GetUsableCpuCount()),
       start_ns_(NanoTime()),
       start_cputime_ns_(ProcessCpuNanoTime()),
       strip_(false),
@@ -1327,6 +1362,7 @@ class Dex2Oat final {
     AssignIfExists(args, M::SwapFileFd, &swap_fd_);
     AssignIfExists(args, M::SwapDexSizeThreshold, &min_dex_file_cumulative_size_for_swap_);
     AssignIfExists(args, M::SwapDexCountThreshold, &min_dex_files_for_swap_);
+    AssignIfExists(args, M::CompiledMethodCache, &compiled_method_cache_dir_);
     AssignIfExists(args, M::VeryLargeAppThreshold, &very_large_threshold_);
     AssignIfExists(args, M::AppImageFile, &app_image_file_name_);
     AssignIfExists(args, M::AppImageFileFd, &app_image_fd_);
@@ -1902,7 +1938,8 @@ class Dex2Oat final {
         rodata_.push_back(elf_writers_[i]->StartRoData());
         if (!oat_writers_[i]->StartRoData(dex_files_per_oat_file_[i],
                                           rodata_.back(),
-                                          (i == 0u) ? key_value_store_.get() : nullptr)) {
+                                          (i == 0u) ? key_value_store_.get() : nullptr,
+                                          thread_count_)) {
           return dex2oat::ReturnCode::kOther;
         }
       }
@@ -2081,6 +2118,10 @@ class Dex2Oat final {
       driver_->SetClasspathDexFiles(class_loader_context_->FlattenOpenedDexFiles());
     }
 
+    if (!compiled_method_cache_dir_.empty()) {
+      SetUpCompiledMethodCache();
+    }
+
     const bool compile_individually = ShouldCompileDexFilesIndividually();
     if (compile_individually) {
       // Set the compiler driver in the callbacks so that we can avoid re-verification. This not
@@ -2399,7 +2440,12 @@ class Dex2Oat final {
 
         oat_writer.reset();
         // We may still need the ELF writer later for stripping.
+
+        // The code of the oat file is written out, so free it before writing the next oat
+        // file and the image, which are the memory peaks of boot image compilation.
+        driver_->ReleaseCompiledMethods(dex_files_per_oat_file_[i]);
       }
+      driver_->GetCompiledMethodStorage()->ReleaseDeduplicatedArrays();
     }
 
     return true;
@@ -2550,6 +2596,76 @@ class Dex2Oat final {
     return DoDexLayoutOptimizations();
   }
 
+  // Describes, as a SHA-1 digest, everything outside of a method that its compiled code
+  // depends on: the compiler and its options, the boot image, the class loader with the
+  // dex files being compiled, and the profile.
+  bool GetCompiledMethodCacheEnvironment(/*out*/ std::string* environment) {
+    auto get_key = [&](const char* key) -> std::string {
+      auto it = key_value_store_->find(key);
+      return (it != key_value_store_->end()) ? it->second : std::string();
+    };
+    std::ostringstream oss;
+    oss << "oat_version=" << OatHeader::kOatVersion.data()
+        << "\ndebug_build=" << kIsDebugBuild
+        << "\n" << compiler_options_->GetCodeGenerationFingerprint()
+        << "\nboot_class_path=" << get_key(OatHeader::kBootClassPathChecksumsKey)
+        << "\nclass_path=" << get_key(OatHeader::kClassPathKey)
+        << "\ndex_files=";
+    for (const DexFile* dex_file : compiler_options_->GetDexFilesForOatFile()) {
+      for (uint8_t b : dex_file->GetHeader().signature_) {
+        oss << StringPrintf("%02x", b);
+      }
+      oss << ":";
+    }
+    std::string description = oss.str();
+
+    SHA_CTX ctx;
+    SHA1_Init(&ctx);
+    SHA1_Update(&ctx, description.data(), description.size());
+    if (profile_compilation_info_ != nullptr) {
+      File profile_copy(memfd_create_compat("profile", /* flags= */ 0), /* check_usage= */ false);
+      if (!profile_copy.IsOpened() || !profile_compilation_info_->Save(profile_copy.Fd())) {
+        PLOG(WARNING) << "Could not copy the profile";
+        return false;
+      }
+      std::vector<uint8_t> profile_data(profile_copy.GetLength());
+      if (!profile_copy.PreadFully(profile_data.data(), profile_data.size(), /* offset= */ 0)) {
+        PLOG(WARNING) << "Could not read the copy of the profile";
+        return false;
+      }
+      SHA1_Update(&ctx, profile_data.data(), profile_data.size());
+    }
+    uint8_t digest[SHA_DIGEST_LENGTH];
+    SHA1_Final(digest, &ctx);
+    environment->clear();
+    for (uint8_t b : digest) {
+      *environment += StringPrintf("%02x", b);
+    }
+    return true;
+  }
+
+  void SetUpCompiledMethodCache() {
+    // Compiled code of images depends on the layout of the image being written.
+    if (IsImage()) {
+      LOG(WARNING) << "Ignoring --compiled-method-cache when compiling an image";
+      return;
+    }
+    if (!OS::DirectoryExists(compiled_method_cache_dir_.c_str()) &&
+        mkdir(compiled_method_cache_dir_.c_str(), 0700) != 0 &&
+        errno != EEXIST) {
+      PLOG(WARNING) << "Could not create compiled method cache " << compiled_method_cache_dir_;
+      return;
+    }
+    TimingLogger::ScopedTiming t("Setup compiled method cache", timings_);
+    std::string environment;
+    if (!GetCompiledMethodCacheEnvironment(&environment)) {
+      LOG(WARNING) << "Not using the compiled method cache";
+      return;
+    }
+    driver_->GetCompiledMethodStorage()->SetCompiledMethodCache(
+        std::make_unique<CompiledMethodCache>(compiled_method_cache_dir_, environment));
+  }
+
   bool DoEagerUnquickeningOfVdex() const {
     return MayInvalidateVdexMetadata() && dm_file_ == nullptr;
   }
@@ -2729,7 +2845,8 @@ class Dex2Oat final {
     elf_writers_.reserve(oat_files_.size());
     oat_writers_.reserve(oat_files_.size());
     for (const std::unique_ptr<File>& oat_file : oat_files_) {
-      elf_writers_.emplace_back(linker::CreateElfWriterQuick(*compiler_options_, oat_file.get()));
+      elf_writers_.emplace_back(
+          linker::CreateElfWriterQuick(*compiler_options_, oat_file.get(), thread_count_));
       elf_writers_.back()->Start();
       bool do_oat_writer_layout = DoDexLayoutOptimizations() || DoOatLayoutOptimizations();
       if (profile_compilation_info_ != nullptr && profile_compilation_info_->IsEmpty()) {
@@ -2870,7 +2987,8 @@ class Dex2Oat final {
     }
     if (!image_writer_->Write(IsAppImage() ? app_image_fd_ : image_fd_,
                               image_filenames_,
-                              IsAppImage() ? 1u : dex_locations_.size())) {
+                              IsAppImage() ? 1u : dex_locations_.size(),
+                              thread_count_)) {
       LOG(ERROR) << "Failure during image file creation";
       return false;
     }
@@ -3064,6 +3182,7 @@ class Dex2Oat final {
   int swap_fd_;
   size_t min_dex_files_for_swap_ = kDefaultMinDexFilesForSwap;
   size_t min_dex_file_cumulative_size_for_swap_ = kDefaultMinDexFileCumulativeSizeForSwap;
+  std::string compiled_method_cache_dir_;
   size_t very_large_threshold_ = std::numeric_limits<size_t>::max();
   std::string app_image_file_name_;
   int app_image_fd_;
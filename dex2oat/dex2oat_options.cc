@@ -155,7 +155,10 @@ static void AddSwapMappings(Builder& builder) {
           .IntoKey(M::SwapDexSizeThreshold)
       .Define("--swap-dex-count-threshold=_")
           .WithType<unsigned int>()
-          .IntoKey(M::SwapDexCountThreshold);
+          .IntoKey(M::SwapDexCountThreshold)
+      .Define("--compiled-method-cache=_")
+          .WithType<std::string>()
+          .IntoKey(M::CompiledMethodCache);
 }
 
 static void AddCompilerMappings(Builder& builder) {
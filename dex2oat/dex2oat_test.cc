@@ -2453,7 +2453,7 @@ TEST_F(Dex2oatTest, AppImageResolveStrings) {
     std::set<std::string> boot_image_strings;
     std::set<std::string> app_image_strings;
 
-    MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+    WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
     intern_table.VisitInterns([&](const GcRoot<mirror::String>& root)
         REQUIRES_SHARED(Locks::mutator_lock_) {
       boot_image_strings.insert(root.Read()->ToModifiedUtf8());
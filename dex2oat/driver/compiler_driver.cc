@@ -22,6 +22,7 @@
 #include <malloc.h>  // For mallinfo
 #endif
 
+#include <algorithm>
 #include <string_view>
 #include <unordered_set>
 #include <vector>
@@ -55,6 +56,7 @@
 #include "dex/dex_to_dex_compiler.h"
 #include "dex/verification_results.h"
 #include "dex/verified_method.h"
+#include "driver/compiled_method_cache.h"
 #include "driver/compiler_options.h"
 #include "driver/dex_compilation_unit.h"
 #include "gc/accounting/card_table-inl.h"
@@ -589,15 +591,27 @@ static void CompileMethodQuick(
               driver->ShouldCompileBasedOnProfile(method_ref);
 
       if (compile) {
-        // NOTE: if compiler declines to compile this method, it will return null.
-        compiled_method = driver->GetCompiler()->Compile(code_item,
-                                                         access_flags,
-                                                         invoke_type,
-                                                         class_def_idx,
-                                                         method_idx,
-                                                         class_loader,
-                                                         dex_file,
-                                                         dex_cache);
+        CompiledMethodStorage* storage = driver->GetCompiledMethodStorage();
+        CompiledMethodCache* cache = storage->GetCompiledMethodCache();
+        std::string cache_key;
+        if (cache != nullptr) {
+          cache_key = cache->GetMethodKey(dex_file, method_idx, access_flags, invoke_type);
+          compiled_method = cache->Lookup(storage, cache_key, &dex_file);
+        }
+        if (compiled_method == nullptr) {
+          // NOTE: if compiler declines to compile this method, it will return null.
+          compiled_method = driver->GetCompiler()->Compile(code_item,
+                                                           access_flags,
+                                                           invoke_type,
+                                                           class_def_idx,
+                                                           method_idx,
+                                                           class_loader,
+                                                           dex_file,
+                                                           dex_cache);
+          if (cache != nullptr && compiled_method != nullptr) {
+            cache->Store(storage, cache_key, &dex_file, compiled_method);
+          }
+        }
         ProfileMethodsCheck check_type =
             driver->GetCompilerOptions().CheckProfiledMethodsCompiled();
         if (UNLIKELY(check_type != ProfileMethodsCheck::kNone)) {
@@ -1464,16 +1478,26 @@ class ParallelCompilationManager {
     ForAllLambda(begin, end, [visitor](size_t index) { visitor->Visit(index); }, work_units);
   }
 
+  // Calls `fn` for each index in [begin, end) on `work_units` threads. If `busy_times_ns` is
+  // not null, it receives the time each work unit spent running `fn`.
   template <typename Fn>
-  void ForAllLambda(size_t begin, size_t end, Fn fn, size_t work_units)
+  void ForAllLambda(size_t begin,
+                    size_t end,
+                    Fn fn,
+                    size_t work_units,
+                    std::vector<uint64_t>* busy_times_ns = nullptr)
       REQUIRES(!*Locks::mutator_lock_) {
     Thread* self = Thread::Current();
     self->AssertNoPendingException();
     CHECK_GT(work_units, 0U);
 
+    if (busy_times_ns != nullptr) {
+      busy_times_ns->assign(work_units, 0u);
+    }
     index_.store(begin, std::memory_order_relaxed);
     for (size_t i = 0; i < work_units; ++i) {
-      thread_pool_->AddTask(self, new ForAllClosureLambda<Fn>(this, end, fn));
+      uint64_t* busy_time_ns = (busy_times_ns != nullptr) ? &(*busy_times_ns)[i] : nullptr;
+      thread_pool_->AddTask(self, new ForAllClosureLambda<Fn>(this, end, fn, busy_time_ns));
     }
     thread_pool_->StartWorkers(self);
 
@@ -1496,10 +1520,14 @@ class ParallelCompilationManager {
   template <typename Fn>
   class ForAllClosureLambda : public Task {
    public:
-    ForAllClosureLambda(ParallelCompilationManager* manager, size_t end, Fn fn)
+    ForAllClosureLambda(ParallelCompilationManager* manager,
+                        size_t end,
+                        Fn fn,
+                        uint64_t* busy_time_ns)
         : manager_(manager),
           end_(end),
-          fn_(fn) {}
+          fn_(fn),
+          busy_time_ns_(busy_time_ns) {}
 
     void Run(Thread* self) override {
       while (true) {
@@ -1507,7 +1535,11 @@ class ParallelCompilationManager {
         if (UNLIKELY(index >= end_)) {
           break;
         }
+        const uint64_t start_ns = (busy_time_ns_ != nullptr) ? NanoTime() : 0u;
         fn_(index);
+        if (busy_time_ns_ != nullptr) {
+          *busy_time_ns_ += NanoTime() - start_ns;
+        }
         self->AssertNoPendingException();
       }
     }
@@ -1520,6 +1552,7 @@ class ParallelCompilationManager {
     ParallelCompilationManager* const manager_;
     const size_t end_;
     Fn fn_;
+    uint64_t* const busy_time_ns_;
   };
 
   AtomicInteger index_;
@@ -1771,30 +1804,68 @@ static void LoadAndUpdateStatus(const ClassAccessor& accessor,
 bool CompilerDriver::FastVerify(jobject jclass_loader,
                                 const std::vector<const DexFile*>& dex_files,
                                 TimingLogger* timings,
-                                /*out*/ VerificationResults* verification_results) {
+                                /*out*/ VerificationResults* verification_results,
+                                /*out*/ std::vector<const DexFile*>* dex_files_to_verify) {
   verifier::VerifierDeps* verifier_deps =
       Runtime::Current()->GetCompilerCallbacks()->GetVerifierDeps();
   // If there exist VerifierDeps that aren't the ones we just created to output, use them to verify.
   if (verifier_deps == nullptr || verifier_deps->OutputOnly()) {
+    *dex_files_to_verify = dex_files;
     return false;
   }
   TimingLogger::ScopedTiming t("Fast Verify", timings);
 
+  // The dependencies are validated per dex file: only the dex files whose dependencies no
+  // longer hold, for instance because a library of the classpath changed, are verified again.
+  // The dex files are independent, so their dependencies are validated in parallel. Validation
+  // of a dex file stops at its first failing dependency.
+  // This returns classpath dex files in no particular order but VerifierDeps
+  // does not care about the order.
+  const std::vector<const DexFile*> classpath = classpath_classes_.GetDexFiles();
+  std::vector<uint8_t> dependencies_valid(dex_files.size(), 0u);
+  std::vector<std::string> error_msgs(dex_files.size());
+  if (!dex_files.empty()) {
+    TimingLogger::ScopedTiming t2("Validate Dependencies", timings);
+    const bool force_determinism = GetCompilerOptions().IsForceDeterminism();
+    ParallelCompilationManager context(Runtime::Current()->GetClassLinker(),
+                                       jclass_loader,
+                                       this,
+                                       /* dex_file= */ nullptr,
+                                       dex_files,
+                                       force_determinism ? single_thread_pool_.get()
+                                                         : parallel_thread_pool_.get());
+    auto validate = [&](size_t index) {
+      ScopedObjectAccess soa(Thread::Current());
+      StackHandleScope<1> hs(soa.Self());
+      Handle<mirror::ClassLoader> class_loader(
+          hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
+      dependencies_valid[index] = verifier_deps->ValidateDexFileDependencies(
+          soa.Self(), class_loader, *dex_files[index], classpath, &error_msgs[index]) ? 1u : 0u;
+    };
+    size_t thread_count =
+        force_determinism ? 1u : std::min(parallel_thread_count_, dex_files.size());
+    context.ForAllLambda(0, dex_files.size(), validate, thread_count);
+  }
+
   ScopedObjectAccess soa(Thread::Current());
   StackHandleScope<2> hs(soa.Self());
   Handle<mirror::ClassLoader> class_loader(
       hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
-  std::string error_msg;
-
-  if (!verifier_deps->ValidateDependencies(
-      soa.Self(),
-      class_loader,
-      // This returns classpath dex files in no particular order but VerifierDeps
-      // does not care about the order.
-      classpath_classes_.GetDexFiles(),
-      &error_msg)) {
-    LOG(WARNING) << "Fast verification failed: " << error_msg;
-    return false;
+
+  // Drop the stale dependencies of the dex files that failed so that verification records
+  // them anew.
+  std::vector<const DexFile*> fast_verified_dex_files;
+  dex_files_to_verify->clear();
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    const DexFile* dex_file = dex_files[i];
+    if (dependencies_valid[i] != 0u) {
+      fast_verified_dex_files.push_back(dex_file);
+    } else {
+      LOG(WARNING) << "Fast verification failed for " << dex_file->GetLocation() << ": "
+                   << error_msgs[i];
+      verifier_deps->ClearDexFileDependencies(*dex_file);
+      dex_files_to_verify->push_back(dex_file);
+    }
   }
 
   bool compiler_only_verifies =
@@ -1806,7 +1877,7 @@ bool CompilerDriver::FastVerify(jobject jclass_loader,
   // could not be fully verified; we could try again, but that would hurt verification
   // time. So instead we assume these classes still need to be verified at
   // runtime.
-  for (const DexFile* dex_file : dex_files) {
+  for (const DexFile* dex_file : fast_verified_dex_files) {
     // Fetch the list of verified classes.
     const std::vector<bool>& verified_classes = verifier_deps->GetVerifiedClasses(*dex_file);
     DCHECK_EQ(verified_classes.size(), dex_file->NumClassDefs());
@@ -1844,14 +1915,15 @@ bool CompilerDriver::FastVerify(jobject jclass_loader,
       }
     }
   }
-  return true;
+  return dex_files_to_verify->empty();
 }
 
 void CompilerDriver::Verify(jobject jclass_loader,
                             const std::vector<const DexFile*>& dex_files,
                             TimingLogger* timings,
                             /*out*/ VerificationResults* verification_results) {
-  if (FastVerify(jclass_loader, dex_files, timings, verification_results)) {
+  std::vector<const DexFile*> dex_files_to_verify;
+  if (FastVerify(jclass_loader, dex_files, timings, verification_results, &dex_files_to_verify)) {
     return;
   }
 
@@ -1879,15 +1951,12 @@ void CompilerDriver::Verify(jobject jclass_loader,
   ThreadPool* verify_thread_pool =
       force_determinism ? single_thread_pool_.get() : parallel_thread_pool_.get();
   size_t verify_thread_count = force_determinism ? 1U : parallel_thread_count_;
-  for (const DexFile* dex_file : dex_files) {
-    CHECK(dex_file != nullptr);
-    VerifyDexFile(jclass_loader,
-                  *dex_file,
-                  dex_files,
-                  verify_thread_pool,
-                  verify_thread_count,
-                  timings);
-  }
+  VerifyDexFiles(jclass_loader,
+                 dex_files_to_verify,
+                 dex_files,
+                 verify_thread_pool,
+                 verify_thread_count,
+                 timings);
 
   if (!GetCompilerOptions().IsBootImage() && !GetCompilerOptions().IsBootImageExtension()) {
     // Merge all VerifierDeps into the main one.
@@ -1904,15 +1973,19 @@ void CompilerDriver::Verify(jobject jclass_loader,
 
 class VerifyClassVisitor : public CompilationVisitor {
  public:
-  VerifyClassVisitor(const ParallelCompilationManager* manager, verifier::HardFailLogMode log_level)
+  VerifyClassVisitor(const ParallelCompilationManager* manager,
+                     const std::vector<ClassReference>& classes,
+                     verifier::HardFailLogMode log_level)
      : manager_(manager),
+       classes_(classes),
        log_level_(log_level),
        sdk_version_(Runtime::Current()->GetTargetSdkVersion()) {}
 
-  void Visit(size_t class_def_index) REQUIRES(!Locks::mutator_lock_) override {
+  void Visit(size_t index) REQUIRES(!Locks::mutator_lock_) override {
     ScopedTrace trace(__FUNCTION__);
     ScopedObjectAccess soa(Thread::Current());
-    const DexFile& dex_file = *manager_->GetDexFile();
+    const DexFile& dex_file = *classes_[index].dex_file;
+    const uint32_t class_def_index = classes_[index].ClassDefIdx();
     const dex::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
     const char* descriptor = dex_file.GetClassDescriptor(class_def);
     ClassLinker* class_linker = manager_->GetClassLinker();
@@ -1993,7 +2066,7 @@ class VerifyClassVisitor : public CompilationVisitor {
           << klass->PrettyDescriptor() << ": state=" << klass->GetStatus();
 
       // Class has a meaningful status for the compiler now, record it.
-      ClassReference ref(manager_->GetDexFile(), class_def_index);
+      ClassReference ref(&dex_file, class_def_index);
       ClassStatus status = klass->GetStatus();
       if (status == ClassStatus::kInitialized) {
         // Initialized classes shall be visibly initialized when loaded from the image.
@@ -2037,27 +2110,48 @@ class VerifyClassVisitor : public CompilationVisitor {
 
  private:
   const ParallelCompilationManager* const manager_;
+  const std::vector<ClassReference>& classes_;
   const verifier::HardFailLogMode log_level_;
   const uint32_t sdk_version_;
 };
 
-void CompilerDriver::VerifyDexFile(jobject class_loader,
-                                   const DexFile& dex_file,
-                                   const std::vector<const DexFile*>& dex_files,
-                                   ThreadPool* thread_pool,
-                                   size_t thread_count,
-                                   TimingLogger* timings) {
-  TimingLogger::ScopedTiming t("Verify Dex File", timings);
+void CompilerDriver::VerifyDexFiles(jobject class_loader,
+                                    const std::vector<const DexFile*>& dex_files_to_verify,
+                                    const std::vector<const DexFile*>& dex_files,
+                                    ThreadPool* thread_pool,
+                                    size_t thread_count,
+                                    TimingLogger* timings) {
+  TimingLogger::ScopedTiming t("Verify Dex Files", timings);
   ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
-  ParallelCompilationManager context(class_linker, class_loader, this, &dex_file, dex_files,
-                                     thread_pool);
+
+  // The classes of all dex files are verified in a single parallel pass, so that the threads
+  // do not wait for the slowest class of each dex file before starting on the next one.
+  // Classes are handed out in dex file order and class def order within each dex file. The dex
+  // format requires a superclass and interfaces to be defined before the classes that extend
+  // them, so a class is picked after its superclasses in the same dex file and its verification
+  // rarely has to wait for another thread to finish verifying one of them.
+  std::vector<ClassReference> classes;
+  size_t num_classes = 0u;
+  for (const DexFile* dex_file : dex_files_to_verify) {
+    CHECK(dex_file != nullptr);
+    num_classes += dex_file->NumClassDefs();
+  }
+  classes.reserve(num_classes);
+  for (const DexFile* dex_file : dex_files_to_verify) {
+    for (uint32_t i = 0, num_class_defs = dex_file->NumClassDefs(); i != num_class_defs; ++i) {
+      classes.emplace_back(dex_file, i);
+    }
+  }
+
+  ParallelCompilationManager context(class_linker, class_loader, this, /* dex_file= */ nullptr,
+                                     dex_files, thread_pool);
   bool abort_on_verifier_failures = GetCompilerOptions().AbortOnHardVerifierFailure()
                                     || GetCompilerOptions().AbortOnSoftVerifierFailure();
   verifier::HardFailLogMode log_level = abort_on_verifier_failures
                               ? verifier::HardFailLogMode::kLogInternalFatal
                               : verifier::HardFailLogMode::kLogWarning;
-  VerifyClassVisitor visitor(&context, log_level);
-  context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count);
+  VerifyClassVisitor visitor(&context, classes, log_level);
+  context.ForAll(0, classes.size(), &visitor, thread_count);
 
   // Make initialized classes visibly initialized.
   class_linker->MakeInitializedClassesVisiblyInitialized(Thread::Current(), /*wait=*/ true);
@@ -2247,6 +2341,8 @@ class InitializeClassVisitor : public CompilationVisitor {
                 !soa.Self()->IsExceptionPending() &&
                 !compiler_options.GetDebuggable() &&
                 (compiler_options.InitializeAppImageClasses() ||
+                 (compiler_options.InitializeStartupAppImageClasses() &&
+                  HasStartupClassInitializer(klass)) ||
                  NoClinitInDependency(klass, soa.Self(), &class_loader));
             // TODO The checking for clinit can be removed since it's already
             // checked when init superclass. Currently keep it because it contains
@@ -2492,6 +2588,21 @@ class InitializeClassVisitor : public CompilationVisitor {
     return PreResolveTypes(self, klass);
   }
 
+  // Returns whether the profile marks the class initializer of `klass` as run during startup.
+  // The transaction still rolls back initializers with side effects outside the class.
+  bool HasStartupClassInitializer(const Handle<mirror::Class>& klass)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    const ProfileCompilationInfo* profile_compilation_info =
+        manager_->GetCompiler()->GetCompilerOptions().GetProfileCompilationInfo();
+    if (profile_compilation_info == nullptr) {
+      return false;
+    }
+    ArtMethod* clinit =
+        klass->FindClassInitializer(manager_->GetClassLinker()->GetImagePointerSize());
+    return clinit != nullptr &&
+           profile_compilation_info->GetMethodHotness(clinit->GetReference()).IsStartup();
+  }
+
   // In this phase the classes containing class initializers are ignored. Make sure no
   // clinit appears in kalss's super class chain and interfaces.
   bool NoClinitInDependency(const Handle<mirror::Class>& klass,
@@ -2658,7 +2769,66 @@ static void CompileDexFile(CompilerDriver* driver,
                                      dex_files,
                                      thread_pool);
 
-  auto compile = [&context, &compile_fn](size_t class_def_index) {
+  // With several threads, the work items are handed out longest first, based on an estimate
+  // of their compilation cost, so that no expensive item is left to hold up the end of the
+  // compilation on a single thread. Large methods get a work item of their own, the other
+  // methods are compiled with their class. The estimate is the number of code units of the
+  // methods that the profile, if any, lets us compile.
+  const size_t large_method_threshold = driver->GetCompilerOptions().GetLargeMethodThreshold();
+  const bool split_large_methods = (thread_count > 1u);
+  auto is_large_method = [large_method_threshold](const ClassAccessor::Method& method) {
+    return method.GetCodeItemOffset() != 0u &&
+        method.GetInstructions().InsnsSizeInCodeUnits() > large_method_threshold;
+  };
+  struct WorkItem {
+    uint32_t class_def_index;
+    uint32_t method_idx;  // The large method to compile, or `dex::kDexNoIndex` for the class.
+    uint64_t cost;
+  };
+  std::vector<WorkItem> work_items;
+  work_items.reserve(dex_file.NumClassDefs());
+  if (split_large_methods) {
+    TimingLogger::ScopedTiming t2("Estimate compilation costs", timings);
+    auto method_cost = [driver, &dex_file](const ClassAccessor::Method& method) -> uint64_t {
+      // Every method compiled costs at least the lookup of its class and a JNI stub or an
+      // empty method; those that the profile excludes cost nothing beyond that.
+      if (method.GetCodeItemOffset() == 0u ||
+          !driver->ShouldCompileBasedOnProfile(MethodReference(&dex_file, method.GetIndex()))) {
+        return 1u;
+      }
+      return 1u + method.GetInstructions().InsnsSizeInCodeUnits();
+    };
+    for (ClassAccessor accessor : dex_file.GetClasses()) {
+      const uint32_t class_def_index = accessor.GetClassDefIndex();
+      uint64_t class_cost = 1u;
+      int64_t previous_method_idx = -1;
+      for (const ClassAccessor::Method& method : accessor.GetMethods()) {
+        const uint32_t method_idx = method.GetIndex();
+        if (method_idx == previous_method_idx) {
+          continue;  // Skipped below as well.
+        }
+        previous_method_idx = method_idx;
+        if (is_large_method(method)) {
+          work_items.push_back({class_def_index, method_idx, method_cost(method)});
+        } else {
+          class_cost += method_cost(method);
+        }
+      }
+      work_items.push_back({class_def_index, dex::kDexNoIndex, class_cost});
+    }
+    std::stable_sort(work_items.begin(),
+                     work_items.end(),
+                     [](const WorkItem& lhs, const WorkItem& rhs) {
+                       return lhs.cost > rhs.cost;
+                     });
+  } else {
+    for (uint32_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+      work_items.push_back({i, dex::kDexNoIndex, 0u});
+    }
+  }
+
+  // Compile the methods of the class for which `should_compile` returns true.
+  auto compile_methods = [&context, &compile_fn](size_t class_def_index, auto should_compile) {
     const DexFile& dex_file = *context.GetDexFile();
     SCOPED_TRACE << "compile " << dex_file.GetLocation() << "@" << class_def_index;
     ClassLinker* class_linker = context.GetClassLinker();
@@ -2714,6 +2884,9 @@ static void CompileDexFile(CompilerDriver* driver,
         continue;
       }
       previous_method_idx = method_idx;
+      if (!should_compile(method)) {
+        continue;
+      }
       compile_fn(soa.Self(),
                  driver,
                  method.GetCodeItem(),
@@ -2727,7 +2900,38 @@ static void CompileDexFile(CompilerDriver* driver,
                  dex_cache);
     }
   };
-  context.ForAllLambda(0, dex_file.NumClassDefs(), compile, thread_count);
+
+  auto compile = [&](size_t index) {
+    const WorkItem& item = work_items[index];
+    if (item.method_idx != dex::kDexNoIndex) {
+      const uint32_t method_idx = item.method_idx;
+      compile_methods(item.class_def_index,
+                      [method_idx](const ClassAccessor::Method& method) {
+                        return method.GetIndex() == method_idx;
+                      });
+    } else {
+      compile_methods(item.class_def_index,
+                      [&](const ClassAccessor::Method& method) {
+                        return !split_large_methods || !is_large_method(method);
+                      });
+    }
+  };
+  const bool dump_timings = driver->GetCompilerOptions().GetDumpTimings();
+  std::vector<uint64_t> busy_times_ns;
+  const uint64_t start_ns = dump_timings ? NanoTime() : 0u;
+  context.ForAllLambda(0,
+                       work_items.size(),
+                       compile,
+                       thread_count,
+                       dump_timings ? &busy_times_ns : nullptr);
+  if (dump_timings) {
+    const uint64_t wall_time_ns = NanoTime() - start_ns;
+    for (size_t i = 0; i != busy_times_ns.size(); ++i) {
+      LOG(INFO) << timing_name << " " << dex_file.GetLocation() << ": work unit " << i
+                << " busy " << PrettyDuration(busy_times_ns[i]) << ", idle "
+                << PrettyDuration(wall_time_ns - std::min(wall_time_ns, busy_times_ns[i]));
+    }
+  }
 }
 
 void CompilerDriver::Compile(jobject class_loader,
@@ -2796,6 +3000,22 @@ CompiledMethod* CompilerDriver::RemoveCompiledMethod(const MethodReference& meth
   return ret;
 }
 
+void CompilerDriver::ReleaseCompiledMethods(const std::vector<const DexFile*>& dex_files) {
+  for (const DexFile* dex_file : dex_files) {
+    if (!compiled_methods_.HaveDexFile(dex_file)) {
+      continue;
+    }
+    for (uint32_t method_idx = 0; method_idx != dex_file->NumMethodIds(); ++method_idx) {
+      CompiledMethod* compiled_method = nullptr;
+      compiled_methods_.Remove(MethodReference(dex_file, method_idx), &compiled_method);
+      if (compiled_method != nullptr) {
+        CompiledMethod::ReleaseSwapAllocatedCompiledMethod(GetCompiledMethodStorage(),
+                                                           compiled_method);
+      }
+    }
+  }
+}
+
 bool CompilerDriver::GetCompiledClass(const ClassReference& ref, ClassStatus* status) const {
   DCHECK(status != nullptr);
   // The table doesn't know if something wasn't inserted. For this case it will return
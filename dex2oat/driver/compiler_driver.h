@@ -138,6 +138,9 @@ class CompilerDriver {
   void AddCompiledMethod(const MethodReference& method_ref, CompiledMethod* const compiled_method);
   CompiledMethod* RemoveCompiledMethod(const MethodReference& method_ref);
 
+  // Frees the compiled methods of `dex_files`, once they have been written out.
+  void ReleaseCompiledMethods(const std::vector<const DexFile*>& dex_files);
+
   // Resolve compiling method's class. Returns null on failure.
   ObjPtr<mirror::Class> ResolveCompilingMethodsClass(const ScopedObjectAccess& soa,
                                                      Handle<mirror::DexCache> dex_cache,
@@ -249,23 +252,25 @@ class CompilerDriver {
       REQUIRES(!Locks::mutator_lock_);
 
   // Do fast verification through VerifierDeps if possible. Return whether
-  // verification was successful.
+  // verification was successful for all dex files; otherwise, `dex_files_to_verify`
+  // holds the dex files that still need to be verified.
   bool FastVerify(jobject class_loader,
                   const std::vector<const DexFile*>& dex_files,
                   TimingLogger* timings,
-                  /*out*/ VerificationResults* verification_results);
+                  /*out*/ VerificationResults* verification_results,
+                  /*out*/ std::vector<const DexFile*>* dex_files_to_verify);
 
   void Verify(jobject class_loader,
               const std::vector<const DexFile*>& dex_files,
               TimingLogger* timings,
               /*out*/ VerificationResults* verification_results);
 
-  void VerifyDexFile(jobject class_loader,
-                     const DexFile& dex_file,
-                     const std::vector<const DexFile*>& dex_files,
-                     ThreadPool* thread_pool,
-                     size_t thread_count,
-                     TimingLogger* timings)
+  void VerifyDexFiles(jobject class_loader,
+                      const std::vector<const DexFile*>& dex_files_to_verify,
+                      const std::vector<const DexFile*>& dex_files,
+                      ThreadPool* thread_pool,
+                      size_t thread_count,
+                      TimingLogger* timings)
       REQUIRES(!Locks::mutator_lock_);
 
   void SetVerified(jobject class_loader,
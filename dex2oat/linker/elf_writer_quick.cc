@@ -88,7 +88,8 @@ template <typename ElfTypes>
 class ElfWriterQuick final : public ElfWriter {
  public:
   ElfWriterQuick(const CompilerOptions& compiler_options,
-                 File* elf_file);
+                 File* elf_file,
+                 size_t thread_count);
   ~ElfWriterQuick();
 
   void Start() override;
@@ -121,6 +122,7 @@ class ElfWriterQuick final : public ElfWriter {
  private:
   const CompilerOptions& compiler_options_;
   File* const elf_file_;
+  const size_t thread_count_;
   size_t rodata_size_;
   size_t text_size_;
   size_t data_bimg_rel_ro_size_;
@@ -137,19 +139,23 @@ class ElfWriterQuick final : public ElfWriter {
 };
 
 std::unique_ptr<ElfWriter> CreateElfWriterQuick(const CompilerOptions& compiler_options,
-                                                File* elf_file) {
+                                                File* elf_file,
+                                                size_t thread_count) {
   if (Is64BitInstructionSet(compiler_options.GetInstructionSet())) {
-    return std::make_unique<ElfWriterQuick<ElfTypes64>>(compiler_options, elf_file);
+    return std::make_unique<ElfWriterQuick<ElfTypes64>>(compiler_options, elf_file, thread_count);
   } else {
-    return std::make_unique<ElfWriterQuick<ElfTypes32>>(compiler_options, elf_file);
+    return std::make_unique<ElfWriterQuick<ElfTypes32>>(compiler_options, elf_file, thread_count);
   }
 }
 
 template <typename ElfTypes>
-ElfWriterQuick<ElfTypes>::ElfWriterQuick(const CompilerOptions& compiler_options, File* elf_file)
+ElfWriterQuick<ElfTypes>::ElfWriterQuick(const CompilerOptions& compiler_options,
+                                         File* elf_file,
+                                         size_t thread_count)
     : ElfWriter(),
       compiler_options_(compiler_options),
       elf_file_(elf_file),
+      thread_count_(thread_count),
       rodata_size_(0u),
       text_size_(0u),
       data_bimg_rel_ro_size_(0u),
@@ -274,8 +280,12 @@ void ElfWriterQuick<ElfTypes>::WriteDebugInfo(const debug::DebugInfo& debug_info
   }
   // The Strip method expects debug info to be last (mini-debug-info is not stripped).
   if (!debug_info.Empty() && compiler_options_.GetGenerateDebugInfo()) {
-    // Generate all the debug information we can.
-    debug::WriteDebugInfo(builder_.get(), debug_info);
+    // Generate all the debug information we can. The calling thread does its share of the work.
+    std::unique_ptr<ThreadPool> thread_pool;
+    if (thread_count_ > 1u) {
+      thread_pool = std::make_unique<ThreadPool>("Debug info writer", thread_count_ - 1u);
+    }
+    debug::WriteDebugInfo(builder_.get(), debug_info, thread_pool.get());
   }
 }
 
@@ -346,7 +346,8 @@ inline void ImageTest::DoCompile(ImageHeader::StorageMode storage_mode,
 
     bool success_image = writer->Write(kInvalidFd,
                                        image_filenames,
-                                       image_filenames.size());
+                                       image_filenames.size(),
+                                       /*thread_count=*/ 2u);
     ASSERT_TRUE(success_image);
 
     for (size_t i = 0, size = oat_filenames.size(); i != size; ++i) {
@@ -21,6 +21,7 @@
 #include <sys/stat.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <unordered_set>
@@ -80,6 +81,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 #include "subtype_check.h"
+#include "thread_pool.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 #include "well_known_classes.h"
 
@@ -402,7 +404,8 @@ class ImageWriter::ImageFileGuard {
 
 bool ImageWriter::Write(int image_fd,
                         const std::vector<std::string>& image_filenames,
-                        size_t component_count) {
+                        size_t component_count,
+                        size_t thread_count) {
   // If image_fd or oat_fd are not kInvalidFd then we may have empty strings in image_filenames or
   // oat_filenames.
   CHECK(!image_filenames.empty());
@@ -425,7 +428,7 @@ bool ImageWriter::Write(int image_fd,
     // TODO: heap validation can't handle these fix up passes.
     ScopedObjectAccess soa(self);
     Runtime::Current()->GetHeap()->DisableObjectValidation();
-    CopyAndFixupObjects();
+    CopyAndFixupObjects(thread_count);
   }
 
   if (compiler_options_.IsAppImage()) {
@@ -493,14 +496,37 @@ bool ImageWriter::Write(int image_fd,
     image_checksum = adler32(image_checksum,
                              reinterpret_cast<const uint8_t*>(image_header),
                              sizeof(ImageHeader));
-    // Copy and compress blocks.
-    size_t out_offset = sizeof(ImageHeader);
-    for (const std::pair<uint32_t, uint32_t> block : block_sources) {
+    // Compress the blocks. Blocks are compressed independently, so with more than one thread
+    // they are compressed in parallel and then written in order.
+    std::vector<std::vector<uint8_t>> compressed_data(block_sources.size());
+    std::vector<ArrayRef<const uint8_t>> block_data(block_sources.size());
+    auto compress_block = [&](size_t block_index) {
+      const std::pair<uint32_t, uint32_t>& block = block_sources[block_index];
       ArrayRef<const uint8_t> raw_image_data(image_info.image_.Begin() + block.first,
                                              block.second);
-      std::vector<uint8_t> compressed_data;
-      ArrayRef<const uint8_t> image_data =
-          MaybeCompressData(raw_image_data, image_storage_mode_, &compressed_data);
+      block_data[block_index] =
+          MaybeCompressData(raw_image_data, image_storage_mode_, &compressed_data[block_index]);
+    };
+    if (is_compressed && thread_count > 1u && block_sources.size() > 1u) {
+      // The current thread takes part in the work, so it counts as one of the threads.
+      size_t num_workers = std::min(thread_count, block_sources.size()) - 1u;
+      ThreadPool thread_pool("Image compression thread pool", num_workers);
+      for (size_t block_index = 0; block_index != block_sources.size(); ++block_index) {
+        thread_pool.AddTask(self, new FunctionTask([=](Thread*) { compress_block(block_index); }));
+      }
+      thread_pool.StartWorkers(self);
+      thread_pool.Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+    } else {
+      for (size_t block_index = 0; block_index != block_sources.size(); ++block_index) {
+        compress_block(block_index);
+      }
+    }
+
+    // Copy the blocks.
+    size_t out_offset = sizeof(ImageHeader);
+    for (size_t block_index = 0; block_index != block_sources.size(); ++block_index) {
+      const std::pair<uint32_t, uint32_t>& block = block_sources[block_index];
+      ArrayRef<const uint8_t> image_data = block_data[block_index];
 
       if (!is_compressed) {
         // For uncompressed, preserve alignment since the image will be directly mapped.
@@ -2888,9 +2914,9 @@ void ImageWriter::CopyAndFixupNativeData(size_t oat_index) {
     CHECK_EQ(temp_intern_table.Size(), intern_table->Size());
     temp_intern_table.VisitRoots(&root_visitor, kVisitRootFlagAllRoots);
     // Record relocations. (The root visitor does not get to see the slot addresses.)
-    MutexLock lock(Thread::Current(), *Locks::intern_table_lock_);
-    DCHECK(!temp_intern_table.strong_interns_.tables_.empty());
-    DCHECK(!temp_intern_table.strong_interns_.tables_[0].Empty());  // Inserted at the beginning.
+    WriterMutexLock lock(Thread::Current(), *Locks::intern_table_lock_);
+    DCHECK(!temp_intern_table.image_strong_interns_.tables_.empty());
+    DCHECK(!temp_intern_table.image_strong_interns_.tables_[0].Empty());
   }
   // Write the class table(s) into the image. class_table_bytes_ may be 0 if there are multiple
   // class loaders. Writing multiple class tables into the image is currently unsupported.
@@ -2966,7 +2992,8 @@ void ImageWriter::CopyAndFixupObject(Object* obj) {
   DCHECK_LT(offset, image_info.image_end_);
   const auto* src = reinterpret_cast<const uint8_t*>(obj);
 
-  image_info.image_bitmap_.Set(dst);  // Mark the obj as live.
+  // Neighbouring objects may be copied by other threads and share the bitmap word.
+  image_info.image_bitmap_.AtomicTestAndSet(dst);  // Mark the obj as live.
 
   const size_t n = obj->SizeOf();
 
@@ -3030,12 +3057,43 @@ class ImageWriter::FixupVisitor {
   mirror::Object* const copy_;
 };
 
-void ImageWriter::CopyAndFixupObjects() {
-  auto visitor = [&](Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
-    DCHECK(obj != nullptr);
-    CopyAndFixupObject(obj);
-  };
-  Runtime::Current()->GetHeap()->VisitObjects(visitor);
+void ImageWriter::CopyAndFixupObjects(size_t thread_count) {
+  if (thread_count <= 1u) {
+    auto visitor = [&](Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+      DCHECK(obj != nullptr);
+      CopyAndFixupObject(obj);
+    };
+    Runtime::Current()->GetHeap()->VisitObjects(visitor);
+  } else {
+    // Each object is copied to its own slot assigned by CalculateNewObjectOffsets(), so the
+    // objects can be copied and fixed up in any order and the image does not depend on how
+    // the work is split between the threads.
+    std::vector<Object*> objects;
+    auto visitor = [&](Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+      DCHECK(obj != nullptr);
+      if (IsImageBinSlotAssigned(obj)) {
+        objects.push_back(obj);
+      }
+    };
+    Runtime::Current()->GetHeap()->VisitObjects(visitor);
+
+    static constexpr size_t kObjectsPerTask = 1024u;
+    Thread* self = Thread::Current();
+    ScopedThreadSuspension sts(self, kNative);
+    // The current thread takes part in the work, so it counts as one of the threads.
+    ThreadPool thread_pool("Image writer thread pool", thread_count - 1u);
+    for (size_t begin = 0; begin < objects.size(); begin += kObjectsPerTask) {
+      size_t end = std::min(begin + kObjectsPerTask, objects.size());
+      thread_pool.AddTask(self, new FunctionTask([this, &objects, begin, end](Thread* worker) {
+        ScopedObjectAccess soa(worker);
+        for (size_t i = begin; i != end; ++i) {
+          CopyAndFixupObject(objects[i]);
+        }
+      }));
+    }
+    thread_pool.StartWorkers(self);
+    thread_pool.Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+  }
   // Fill the padding objects since they are required for in order traversal of the image space.
   for (ImageInfo& image_info : image_infos_) {
     for (const size_t start_offset : image_info.padding_offsets_) {
@@ -3184,9 +3242,9 @@ void ImageWriter::FixupObject(Object* orig, Object* copy) {
     // Is this a native pointer array?
     auto it = pointer_arrays_.find(down_cast<mirror::PointerArray*>(orig));
     if (it != pointer_arrays_.end()) {
-      // Should only need to fixup every pointer array exactly once.
+      // Every pointer array is fixed up exactly once, as every object is copied once.
+      // The map is left untouched as other threads may be looking up their arrays.
       FixupPointerArray(copy, down_cast<mirror::PointerArray*>(orig), it->second);
-      pointer_arrays_.erase(it);
       return;
     }
   }
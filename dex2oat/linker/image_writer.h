@@ -143,9 +143,11 @@ class ImageWriter final {
   // the names in image_filenames.
   // If oat_fd is not kInvalidFd, then we use that for the oat file. Otherwise we open
   // the names in oat_filenames.
+  // Up to `thread_count` threads copy and fix up the objects of the image.
   bool Write(int image_fd,
              const std::vector<std::string>& image_filenames,
-             size_t component_count)
+             size_t component_count,
+             size_t thread_count = 1u)
       REQUIRES(!Locks::mutator_lock_);
 
   uintptr_t GetOatDataBegin(size_t oat_index) {
@@ -484,7 +486,7 @@ class ImageWriter final {
 
   // Creates the contiguous image in memory and adjusts pointers.
   void CopyAndFixupNativeData(size_t oat_index) REQUIRES_SHARED(Locks::mutator_lock_);
-  void CopyAndFixupObjects() REQUIRES_SHARED(Locks::mutator_lock_);
+  void CopyAndFixupObjects(size_t thread_count) REQUIRES_SHARED(Locks::mutator_lock_);
   void CopyAndFixupObject(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_);
   void CopyAndFixupMethod(ArtMethod* orig, ArtMethod* copy, size_t oat_index)
       REQUIRES_SHARED(Locks::mutator_lock_);
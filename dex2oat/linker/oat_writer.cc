@@ -70,6 +70,7 @@
 #include "stream/buffered_output_stream.h"
 #include "stream/file_output_stream.h"
 #include "stream/output_stream.h"
+#include "thread_pool.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 #include "vdex_file.h"
 #include "verifier/verifier_deps.h"
@@ -694,7 +695,8 @@ bool OatWriter::WriteAndOpenDexFiles(
 
 bool OatWriter::StartRoData(const std::vector<const DexFile*>& dex_files,
                             OutputStream* oat_rodata,
-                            SafeMap<std::string, std::string>* key_value_store) {
+                            SafeMap<std::string, std::string>* key_value_store,
+                            size_t thread_count) {
   CHECK(write_state_ == WriteState::kStartRoData);
 
   // Record the ELF rodata section offset, i.e. the beginning of the OAT data.
@@ -712,7 +714,7 @@ bool OatWriter::StartRoData(const std::vector<const DexFile*>& dex_files,
   ChecksumUpdatingOutputStream checksum_updating_rodata(oat_rodata, this);
 
   // Write type lookup tables into the oat file.
-  if (!WriteTypeLookupTables(&checksum_updating_rodata, dex_files)) {
+  if (!WriteTypeLookupTables(&checksum_updating_rodata, dex_files, thread_count)) {
     return false;
   }
 
@@ -924,9 +926,9 @@ class OatWriter::InitBssLayoutMethodVisitor : public DexMethodVisitor {
   void AddBssReference(const DexFileReference& ref,
                        size_t number_of_indexes,
                        /*inout*/ SafeMap<const DexFile*, BitVector>* references) {
-    // We currently support inlining of throwing instructions only when they originate in the
-    // same dex file as the outer method. All .bss references are used by throwing instructions.
-    DCHECK_EQ(dex_file_, ref.dex_file);
+    // We currently support inlining of throwing instructions only when they originate in a
+    // dex file of this oat file. All .bss references are used by throwing instructions.
+    DCHECK(ContainsElement(*writer_->dex_files_, ref.dex_file));
 
     auto refs_it = references->find(ref.dex_file);
     if (refs_it == references->end()) {
@@ -1046,19 +1048,15 @@ struct OatWriter::OrderedMethodData {
     return debug_info_idx != kDebugInfoIdxInvalid;
   }
 
-  // Bin each method according to the profile flags.
-  //
-  // Groups by e.g.
-  //  -- not hot at all
-  //  -- hot
-  //  -- hot and startup
+  // Bin each method according to the profile flags, in this order:
+  //  -- startup (hot ones first, then those also run post-startup)
   //  -- hot and post-startup
-  //  -- hot and startup and poststartup
-  //  -- startup
-  //  -- startup and post-startup
   //  -- post-startup
+  //  -- hot
+  //  -- not hot at all
   //
-  // (See MethodHotness enum definition for up-to-date binning order.)
+  // Keeping all startup code contiguous at the start of the text section means an app launch
+  // faults in as few code pages as possible, and cold code does not get interleaved with it.
   bool operator<(const OrderedMethodData& other) const {
     if (kOatWriterForceOatCodeLayout) {
       // Development flag: Override default behavior by sorting by name.
@@ -1079,26 +1077,8 @@ struct OatWriter::OrderedMethodData {
 
  private:
   // Used to determine relative order for OAT code layout when determining
-  // binning.
+  // binning. Lower values are laid out first.
   size_t GetMethodHotnessOrder() const {
-    bool hotness[] = {
-      method_hotness.IsHot(),
-      method_hotness.IsStartup(),
-      method_hotness.IsPostStartup()
-    };
-
-
-    // Note: Bin-to-bin order does not matter. If the kernel does or does not read-ahead
-    // any memory, it only goes into the buffer cache and does not grow the PSS until the first
-    // time that memory is referenced in the process.
-
-    size_t hotness_bits = 0;
-    for (size_t i = 0; i < arraysize(hotness); ++i) {
-      if (hotness[i]) {
-        hotness_bits |= (1 << i);
-      }
-    }
-
     if (kIsDebugBuild) {
       // Check for bins that are always-empty given a real profile.
       if (method_hotness.IsHot() &&
@@ -1110,7 +1090,16 @@ struct OatWriter::OrderedMethodData {
       }
     }
 
-    return hotness_bits;
+    const bool hot = method_hotness.IsHot();
+    const bool startup = method_hotness.IsStartup();
+    const bool post_startup = method_hotness.IsPostStartup();
+    if (startup) {
+      return (hot ? 0u : 2u) + (post_startup ? 1u : 0u);
+    }
+    if (post_startup) {
+      return hot ? 4u : 5u;
+    }
+    return hot ? 6u : 7u;
   }
 };
 
@@ -1482,7 +1471,7 @@ class OatWriter::InitMapMethodVisitor : public OatDexMethodVisitor {
 
       ArrayRef<const uint8_t> map = compiled_method->GetVmapTable();
       if (map.size() != 0u) {
-        size_t offset = dedupe_code_info_.GetOrCreate(map.data(), [=]() {
+        size_t offset = dedupe_code_info_.GetOrCreate(map, [=]() {
           // Deduplicate the inner BitTable<>s within the CodeInfo.
           return offset_ + dedupe_bit_table_.Dedupe(map.data());
         });
@@ -1497,10 +1486,20 @@ class OatWriter::InitMapMethodVisitor : public OatDexMethodVisitor {
   }
 
  private:
+  struct CodeInfoComparator {
+    bool operator()(ArrayRef<const uint8_t> lhs, ArrayRef<const uint8_t> rhs) const {
+      if (lhs.data() == rhs.data() && lhs.size() == rhs.size()) {
+        return false;  // Fast path for tables that the compiler driver already deduplicated.
+      }
+      return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+  };
+
   // Deduplicate at CodeInfo level. The value is byte offset within code_info_data_.
   // This deduplicates the whole CodeInfo object without going into the inner tables.
-  // The compiler already deduplicated the pointers but it did not dedupe the tables.
-  SafeMap<const uint8_t*, size_t> dedupe_code_info_;
+  // The compiler usually deduplicated the pointers already, but it does not do so
+  // with --deduplicate-code=false, so compare the contents.
+  SafeMap<ArrayRef<const uint8_t>, size_t, CodeInfoComparator> dedupe_code_info_;
 
   // Deduplicate at BitTable level.
   CodeInfo::Deduper dedupe_bit_table_;
@@ -3479,6 +3478,8 @@ bool OatWriter::LayoutAndWriteDexFile(OutputStream* out, OatDexFile* oat_dex_fil
   Options options;
   options.compact_dex_level_ = compact_dex_level_;
   options.update_checksum_ = true;
+  options.dedupe_code_items_across_dex_files_ =
+      !CompilerFilter::IsQuickeningCompilationEnabled(compiler_options_.GetCompilerFilter());
   DexLayout dex_layout(options, profile_compilation_info_, /*file*/ nullptr, /*header*/ nullptr);
   const uint8_t* dex_src = nullptr;
   {
@@ -3795,7 +3796,8 @@ bool OatWriter::OpenDexFiles(
 }
 
 bool OatWriter::WriteTypeLookupTables(OutputStream* oat_rodata,
-                                      const std::vector<const DexFile*>& opened_dex_files) {
+                                      const std::vector<const DexFile*>& opened_dex_files,
+                                      size_t thread_count) {
   TimingLogger::ScopedTiming split("WriteTypeLookupTables", timings_);
 
   uint32_t expected_offset = oat_data_offset_ + oat_size_;
@@ -3807,31 +3809,52 @@ bool OatWriter::WriteTypeLookupTables(OutputStream* oat_rodata,
   }
 
   DCHECK_EQ(opened_dex_files.size(), oat_dex_files_.size());
+  std::vector<size_t> table_indexes;
   for (size_t i = 0, size = opened_dex_files.size(); i != size; ++i) {
-    OatDexFile* oat_dex_file = &oat_dex_files_[i];
-    DCHECK_EQ(oat_dex_file->lookup_table_offset_, 0u);
+    const OatDexFile& oat_dex_file = oat_dex_files_[i];
+    DCHECK_EQ(oat_dex_file.lookup_table_offset_, 0u);
+    if (oat_dex_file.create_type_lookup_table_ == CreateTypeLookupTable::kCreate &&
+        !oat_dex_file.class_offsets_.empty() &&
+        TypeLookupTable::RawDataLength(oat_dex_file.class_offsets_.size()) != 0u) {
+      table_indexes.push_back(i);
+    }
+  }
 
-    if (oat_dex_file->create_type_lookup_table_ != CreateTypeLookupTable::kCreate ||
-        oat_dex_file->class_offsets_.empty()) {
-      continue;
+  // Create the lookup tables. Hashing the class descriptors is the expensive part of this
+  // section, so multi-dex inputs create their tables in parallel. The tables are then written
+  // in dex file order, keeping the output independent of the thread count.
+  // TODO: Create the tables in an mmap()ed region of the output file to reduce dirty memory.
+  // (We used to do that when dex files were still copied into the oat file.)
+  std::vector<TypeLookupTable> type_lookup_tables(table_indexes.size());
+  auto create_table = [&](size_t index) {
+    type_lookup_tables[index] = TypeLookupTable::Create(*opened_dex_files[table_indexes[index]]);
+  };
+  if (thread_count > 1u && type_lookup_tables.size() > 1u) {
+    // The current thread takes part in the work, so it counts as one of the threads.
+    size_t num_workers = std::min(thread_count, type_lookup_tables.size()) - 1u;
+    Thread* self = Thread::Current();
+    ThreadPool thread_pool("Type lookup table creation thread pool", num_workers);
+    for (size_t index = 0; index != type_lookup_tables.size(); ++index) {
+      thread_pool.AddTask(self, new FunctionTask([=](Thread*) { create_table(index); }));
     }
+    thread_pool.StartWorkers(self);
+    thread_pool.Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+  } else {
+    for (size_t index = 0; index != type_lookup_tables.size(); ++index) {
+      create_table(index);
+    }
+  }
 
+  for (size_t index = 0; index != table_indexes.size(); ++index) {
+    size_t i = table_indexes[index];
+    OatDexFile* oat_dex_file = &oat_dex_files_[i];
     size_t table_size = TypeLookupTable::RawDataLength(oat_dex_file->class_offsets_.size());
-    if (table_size == 0u) {
-      continue;
-    }
 
-    // Create the lookup table. When `nullptr` is given as the storage buffer,
-    // TypeLookupTable allocates its own and OatDexFile takes ownership.
-    // TODO: Create the table in an mmap()ed region of the output file to reduce dirty memory.
-    // (We used to do that when dex files were still copied into the oat file.)
+    // The OatDexFile takes ownership of the table, which allocated its own storage.
     const DexFile& dex_file = *opened_dex_files[i];
-    {
-      TypeLookupTable type_lookup_table = TypeLookupTable::Create(dex_file);
-      type_lookup_table_oat_dex_files_.push_back(
-          std::make_unique<art::OatDexFile>(std::move(type_lookup_table)));
-      dex_file.SetOatDexFile(type_lookup_table_oat_dex_files_.back().get());
-    }
+    type_lookup_table_oat_dex_files_.push_back(
+        std::make_unique<art::OatDexFile>(std::move(type_lookup_tables[index])));
+    dex_file.SetOatDexFile(type_lookup_table_oat_dex_files_.back().get());
     const TypeLookupTable& table = type_lookup_table_oat_dex_files_.back()->GetTypeLookupTable();
     DCHECK(table.Valid());
 
@@ -178,9 +178,11 @@ class OatWriter {
                             /*out*/ std::vector<MemMap>* opened_dex_files_map,
                             /*out*/ std::vector<std::unique_ptr<const DexFile>>* opened_dex_files);
   // Start writing .rodata, including supporting data structures for dex files.
+  // Up to `thread_count` threads create the type lookup tables of the dex files.
   bool StartRoData(const std::vector<const DexFile*>& dex_files,
                    OutputStream* oat_rodata,
-                   SafeMap<std::string, std::string>* key_value_store);
+                   SafeMap<std::string, std::string>* key_value_store,
+                   size_t thread_count = 1u);
   // Initialize the writer with the given parameters.
   void Initialize(const CompilerDriver* compiler_driver,
                   ImageWriter* image_writer,
@@ -340,7 +342,8 @@ class OatWriter {
 
   bool RecordOatDataOffset(OutputStream* out);
   bool WriteTypeLookupTables(OutputStream* oat_rodata,
-                             const std::vector<const DexFile*>& opened_dex_files);
+                             const std::vector<const DexFile*>& opened_dex_files,
+                             size_t thread_count);
   bool WriteDexLayoutSections(OutputStream* oat_rodata,
                               const std::vector<const DexFile*>& opened_dex_files);
   bool WriteCodeAlignment(OutputStream* out, uint32_t aligned_code_delta);
@@ -199,7 +199,9 @@ class OatTest : public CommonCompilerDriverTest {
     MultiOatRelativePatcher patcher(compiler_options_->GetInstructionSet(),
                                     compiler_options_->GetInstructionSetFeatures(),
                                     compiler_driver_->GetCompiledMethodStorage());
-    if (!oat_writer.StartRoData(dex_files, oat_rodata, &key_value_store)) {
+    // Create the type lookup tables of multi-dex inputs in parallel, as dex2oat does.
+    if (!oat_writer.StartRoData(
+            dex_files, oat_rodata, &key_value_store, /*thread_count=*/ 2u)) {
       return false;
     }
     oat_writer.Initialize(compiler_driver_.get(), /*image_writer=*/ nullptr, dex_files);
@@ -124,6 +124,7 @@ CompactDexWriter::ScopedDataSectionItem::~ScopedDataSectionItem() {
   // If we deduped, only use the deduped offset if the alignment matches the required alignment.
   // Otherwise, return without deduping.
   if (deduped_offset != Deduper::kDidNotDedupe && IsAlignedParam(deduped_offset, alignment_)) {
+    deduper_->RecordDeduped(stream_->Tell() - start_offset_);
     // Update the IR offset to the offset of the deduped item.
     item_->SetOffset(deduped_offset);
     // Clear the written data for the item so that the stream write doesn't abort in the future.
@@ -521,10 +522,18 @@ bool CompactDexWriter::Write(DexContainer* output, std::string* error_msg)  {
     WriteHeader(main_stream);
   }
 
+  VLOG(dex) << "Deduped code items: " << code_item_dedupe_->NumDedupedItems()
+            << " (" << code_item_dedupe_->DedupedBytes() << " bytes), data items: "
+            << data_item_dedupe_->NumDedupedItems()
+            << " (" << data_item_dedupe_->DedupedBytes() << " bytes)";
+
   // Clear the dedupe to prevent interdex code item deduping. This does not currently work well with
   // dex2oat's class unloading. The issue is that verification encounters quickened opcodes after
-  // the first dex gets unloaded.
-  code_item_dedupe_->Clear();
+  // the first dex gets unloaded. Without quickening, the code items are never modified and can be
+  // shared between all the dex files of the container.
+  if (!dex_layout_->GetOptions().dedupe_code_items_across_dex_files_) {
+    code_item_dedupe_->Clear();
+  }
 
   return true;
 }
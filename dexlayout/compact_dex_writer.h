@@ -49,6 +49,20 @@ class CompactDexWriter : public DexWriter {
       dedupe_map_.clear();
     }
 
+    // Record that an item of `size` bytes was replaced by an existing one.
+    void RecordDeduped(size_t size) {
+      ++num_deduped_items_;
+      deduped_bytes_ += size;
+    }
+
+    size_t NumDedupedItems() const {
+      return num_deduped_items_;
+    }
+
+    size_t DedupedBytes() const {
+      return deduped_bytes_;
+    }
+
    private:
     class HashedMemoryRange {
      public:
@@ -87,6 +101,10 @@ class CompactDexWriter : public DexWriter {
 
     const bool enabled_;
 
+    // Statistics over the whole container.
+    size_t num_deduped_items_ = 0u;
+    size_t deduped_bytes_ = 0u;
+
     // Dedupe map.
     std::unordered_map<HashedMemoryRange,
                        uint32_t,
@@ -25,6 +25,7 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -1811,10 +1812,121 @@ void DexLayout::LayoutCodeItems(const DexFile* dex_file) {
   });
 }
 
+// Moves the items of `collection` that are in `items` to the front. The writer assigns the offsets
+// in collection order, so this clusters the items on as few pages as possible. Stable partition to
+// preserve any existing locality that might be there.
+template <typename T>
+static void MoveItemsToFront(dex_ir::CollectionVector<T>& collection,
+                             const std::unordered_set<const T*>& items) {
+  std::stable_partition(collection.begin(),
+                        collection.end(),
+                        [&items](const std::unique_ptr<T>& item) {
+    return items.find(item.get()) != items.end();
+  });
+}
+
+// Orders the data items that are read when loading and initializing profile classes, or when
+// executing profile methods, before the other items of their section.
+void DexLayout::LayoutDataItems(const DexFile* dex_file) {
+  std::unordered_set<const dex_ir::TypeList*> hot_type_lists;
+  std::unordered_set<const dex_ir::EncodedArrayItem*> hot_encoded_arrays;
+  std::unordered_set<const dex_ir::AnnotationsDirectoryItem*> hot_annotations_directories;
+  std::unordered_set<const dex_ir::AnnotationSetRefList*> hot_annotation_set_ref_lists;
+  std::unordered_set<const dex_ir::AnnotationSetItem*> hot_annotation_sets;
+  std::unordered_set<const dex_ir::AnnotationItem*> hot_annotations;
+  std::unordered_set<const dex_ir::DebugInfoItem*> hot_debug_infos;
+  auto add_annotation_set = [&](dex_ir::AnnotationSetItem* set_item) {
+    if (set_item != nullptr && hot_annotation_sets.insert(set_item).second) {
+      for (dex_ir::AnnotationItem* annotation : *set_item->GetItems()) {
+        hot_annotations.insert(annotation);
+      }
+    }
+  };
+  for (auto& class_def : header_->ClassDefs()) {
+    const bool is_profile_class =
+        info_->ContainsClass(*dex_file, dex::TypeIndex(class_def->ClassType()->GetIndex()));
+    if (is_profile_class) {
+      // The interfaces and static values are read when linking and initializing the class, the
+      // annotations are looked up for the native methods and by reflection.
+      if (class_def->Interfaces() != nullptr) {
+        hot_type_lists.insert(class_def->Interfaces());
+      }
+      if (class_def->StaticValues() != nullptr) {
+        hot_encoded_arrays.insert(class_def->StaticValues());
+      }
+      dex_ir::AnnotationsDirectoryItem* annotations = class_def->Annotations();
+      if (annotations != nullptr) {
+        hot_annotations_directories.insert(annotations);
+        add_annotation_set(annotations->GetClassAnnotation());
+        if (annotations->GetFieldAnnotations() != nullptr) {
+          for (auto& field : *annotations->GetFieldAnnotations()) {
+            add_annotation_set(field->GetAnnotationSetItem());
+          }
+        }
+        if (annotations->GetMethodAnnotations() != nullptr) {
+          for (auto& method : *annotations->GetMethodAnnotations()) {
+            add_annotation_set(method->GetAnnotationSetItem());
+          }
+        }
+        if (annotations->GetParameterAnnotations() != nullptr) {
+          for (auto& parameter : *annotations->GetParameterAnnotations()) {
+            dex_ir::AnnotationSetRefList* ref_list = parameter->GetAnnotations();
+            hot_annotation_set_ref_lists.insert(ref_list);
+            for (dex_ir::AnnotationSetItem* set_item : *ref_list->GetItems()) {
+              add_annotation_set(set_item);
+            }
+          }
+        }
+      }
+    }
+    dex_ir::ClassData* data = class_def->GetClassData();
+    if (data == nullptr) {
+      continue;
+    }
+    for (size_t i = 0; i < 2; ++i) {
+      for (auto& method : *(i == 0 ? data->DirectMethods() : data->VirtualMethods())) {
+        const dex_ir::MethodId* method_id = method.GetMethodId();
+        const bool is_clinit = is_profile_class &&
+            (method.GetAccessFlags() & kAccConstructor) != 0 &&
+            (method.GetAccessFlags() & kAccStatic) != 0;
+        const bool method_executed = is_clinit ||
+            info_->GetMethodHotness(MethodReference(dex_file, method_id->GetIndex())).IsInProfile();
+        if (!method_executed) {
+          continue;
+        }
+        // The parameters are read when resolving and linking the method, the debug info when
+        // walking the stack of the method, for example for exceptions.
+        if (method_id->Proto()->Parameters() != nullptr) {
+          hot_type_lists.insert(method_id->Proto()->Parameters());
+        }
+        dex_ir::CodeItem* code_item = method.GetCodeItem();
+        if (code_item != nullptr && code_item->DebugInfo() != nullptr) {
+          hot_debug_infos.insert(code_item->DebugInfo());
+        }
+      }
+    }
+  }
+  VLOG(dex) << "Hot data items: type_lists=" << hot_type_lists.size()
+            << " encoded_arrays=" << hot_encoded_arrays.size()
+            << " annotations_directories=" << hot_annotations_directories.size()
+            << " annotation_set_ref_lists=" << hot_annotation_set_ref_lists.size()
+            << " annotation_sets=" << hot_annotation_sets.size()
+            << " annotations=" << hot_annotations.size()
+            << " debug_infos=" << hot_debug_infos.size();
+  MoveItemsToFront(header_->TypeLists(), hot_type_lists);
+  MoveItemsToFront(header_->EncodedArrayItems(), hot_encoded_arrays);
+  MoveItemsToFront(header_->AnnotationsDirectoryItems(), hot_annotations_directories);
+  MoveItemsToFront(header_->AnnotationSetRefLists(), hot_annotation_set_ref_lists);
+  MoveItemsToFront(header_->AnnotationSetItems(), hot_annotation_sets);
+  MoveItemsToFront(header_->AnnotationItems(), hot_annotations);
+  MoveItemsToFront(header_->DebugInfoItems(), hot_debug_infos);
+}
+
 void DexLayout::LayoutOutputFile(const DexFile* dex_file) {
   LayoutStringData(dex_file);
   LayoutClassDefsAndClassData(dex_file);
   LayoutCodeItems(dex_file);
+  LayoutDataItems(dex_file);
 }
 
 bool DexLayout::OutputDexFile(const DexFile* input_dex_file,
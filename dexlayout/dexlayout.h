@@ -68,6 +68,9 @@ class Options {
   bool update_checksum_ = false;
   CompactDexLevel compact_dex_level_ = CompactDexLevel::kCompactDexLevelNone;
   bool dedupe_code_items_ = true;
+  // Keep deduping code items against the ones of previous dex files in the same container. This
+  // is only safe when the code items do not get quickened later.
+  bool dedupe_code_items_across_dex_files_ = false;
   OutputFormat output_format_ = kOutputPlain;
   const char* output_dex_directory_ = nullptr;
   const char* output_file_name_ = nullptr;
@@ -174,9 +177,11 @@ class DexLayout {
   void LayoutClassDefsAndClassData(const DexFile* dex_file);
   void LayoutCodeItems(const DexFile* dex_file);
   void LayoutStringData(const DexFile* dex_file);
+  void LayoutDataItems(const DexFile* dex_file);
 
   // Creates a new layout for the dex file based on profile info.
-  // Currently reorders ClassDefs, ClassDataItems, and CodeItems.
+  // Currently reorders ClassDefs, ClassDataItems, CodeItems, StringDatas and the data items
+  // referenced by profile classes and methods.
   void LayoutOutputFile(const DexFile* dex_file);
   bool OutputDexFile(const DexFile* input_dex_file,
                      bool compute_offsets,
@@ -24,6 +24,7 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -1116,11 +1117,13 @@ class ImgDiagDumper {
   explicit ImgDiagDumper(std::ostream* os,
                          pid_t image_diff_pid,
                          pid_t zygote_diff_pid,
-                         bool dump_dirty_objects)
+                         bool dump_dirty_objects,
+                         bool dirty_pages_only)
       : os_(os),
         image_diff_pid_(image_diff_pid),
         zygote_diff_pid_(zygote_diff_pid),
         dump_dirty_objects_(dump_dirty_objects),
+        dirty_pages_only_(dirty_pages_only),
         zygote_pid_only_(false) {}
 
   bool Init() {
@@ -1168,7 +1171,11 @@ class ImgDiagDumper {
       }
       return true;
     };
-    auto open_mem_file = [&open_file](pid_t pid, /*out*/ std::unique_ptr<File>* mem_file) {
+    auto open_mem_file = [&](pid_t pid, /*out*/ std::unique_ptr<File>* mem_file) {
+      if (dirty_pages_only_) {
+        // The remote contents are never read.
+        return true;
+      }
       // Open /proc/<pid>/mem and for reading remote contents.
       std::string mem_file_name =
           StringPrintf("/proc/%ld/mem", static_cast<long>(pid));  // NOLINT [runtime/int]
@@ -1268,11 +1275,15 @@ class ImgDiagDumper {
 
     // Commit the mappings and files.
     image_proc_maps_ = std::move(image_proc_maps);
-    image_mem_file_ = std::move(*image_mem_file);
+    if (image_mem_file != nullptr) {
+      image_mem_file_ = std::move(*image_mem_file);
+    }
     image_pagemap_file_ = std::move(*image_pagemap_file);
     if (zygote_diff_pid_ != -1) {
       zygote_proc_maps_ = std::move(zygote_proc_maps);
-      zygote_mem_file_ = std::move(*zygote_mem_file);
+      if (zygote_mem_file != nullptr) {
+        zygote_mem_file_ = std::move(*zygote_mem_file);
+      }
       zygote_pagemap_file_ = std::move(*zygote_pagemap_file);
     }
     clean_pagemap_file_ = std::move(*clean_pagemap_file);
@@ -1311,114 +1322,149 @@ class ImgDiagDumper {
     return DumpImageDiffMap(image_header, image_location);
   }
 
+  // Compares the local image with the remote contents one page at a time. The pages are split
+  // into contiguous chunks that are compared on separate threads, as this is the expensive part
+  // of the comparison for large images.
+  static void ComputeDifferentBytes(const uint8_t* local_begin,
+                                    ArrayRef<const uint8_t> remote_contents,
+                                    MappingData* mapping_data /*out*/) {
+    struct ContentDiff {
+      size_t different_pages = 0;
+      size_t different_bytes = 0;
+      size_t different_int32s = 0;
+    };
+
+    size_t num_pages = remote_contents.size() / kPageSize;
+    size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min(num_threads, std::max<size_t>(num_pages, 1u));
+    size_t pages_per_thread = (num_pages + num_threads - 1u) / num_threads;
+    std::vector<ContentDiff> diffs(num_threads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t != num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        ContentDiff* diff = &diffs[t];
+        size_t page_end = std::min(num_pages, (t + 1u) * pages_per_thread);
+        for (size_t page = t * pages_per_thread; page < page_end; ++page) {
+          const uint8_t* local_ptr = local_begin + page * kPageSize;
+          const uint8_t* remote_ptr = &remote_contents[page * kPageSize];
+          if (memcmp(local_ptr, remote_ptr, kPageSize) == 0) {
+            continue;
+          }
+          diff->different_pages++;
+          // Count the number of bytes and 32-bit integers that are different.
+          const uint32_t* remote_ptr_int32 = reinterpret_cast<const uint32_t*>(remote_ptr);
+          const uint32_t* local_ptr_int32 = reinterpret_cast<const uint32_t*>(local_ptr);
+          for (size_t i = 0; i < kPageSize / sizeof(uint32_t); ++i) {
+            if (remote_ptr_int32[i] != local_ptr_int32[i]) {
+              diff->different_int32s++;
+            }
+          }
+          for (size_t i = 0; i < kPageSize; ++i) {
+            if (remote_ptr[i] != local_ptr[i]) {
+              diff->different_bytes++;
+            }
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    for (const ContentDiff& diff : diffs) {
+      mapping_data->different_pages += diff.different_pages;
+      mapping_data->different_bytes += diff.different_bytes;
+      mapping_data->different_int32s += diff.different_int32s;
+    }
+  }
+
+  // If `remote_contents` is empty, only the page dirtiness reported by the kernel is computed.
   bool ComputeDirtyBytes(const ImageHeader& image_header,
-                         const uint8_t* image_begin,
                          const backtrace_map_t& boot_map,
                          ArrayRef<uint8_t> remote_contents,
                          MappingData* mapping_data /*out*/) {
     std::ostream& os = *os_;
 
-    size_t virtual_page_idx = 0;   // Virtual page number (for an absolute memory address)
-    size_t page_idx = 0;           // Page index relative to 0
-    size_t previous_page_idx = 0;  // Previous page index relative to 0
-
-
-    // Iterate through one page at a time. Boot map begin/end already implicitly aligned.
-    for (uintptr_t begin = boot_map.start; begin != boot_map.end; begin += kPageSize) {
-      ptrdiff_t offset = begin - boot_map.start;
-
-      // We treat the image header as part of the memory map for now
-      // If we wanted to change this, we could pass base=start+sizeof(ImageHeader)
-      // But it might still be interesting to see if any of the ImageHeader data mutated
-      const uint8_t* local_ptr = reinterpret_cast<const uint8_t*>(&image_header) + offset;
-      const uint8_t* remote_ptr = &remote_contents[offset];
-
-      if (memcmp(local_ptr, remote_ptr, kPageSize) != 0) {
-        mapping_data->different_pages++;
-
-        // Count the number of 32-bit integers that are different.
-        for (size_t i = 0; i < kPageSize / sizeof(uint32_t); ++i) {
-          const uint32_t* remote_ptr_int32 = reinterpret_cast<const uint32_t*>(remote_ptr);
-          const uint32_t* local_ptr_int32 = reinterpret_cast<const uint32_t*>(local_ptr);
+    // We treat the image header as part of the memory map for now
+    // If we wanted to change this, we could pass base=start+sizeof(ImageHeader)
+    // But it might still be interesting to see if any of the ImageHeader data mutated
+    const uint8_t* local_begin = reinterpret_cast<const uint8_t*>(&image_header);
+    size_t num_pages = (boot_map.end - boot_map.start) / kPageSize;
+    bool compare_contents = !remote_contents.empty();
+    if (compare_contents) {
+      ComputeDifferentBytes(local_begin, ArrayRef<const uint8_t>(remote_contents), mapping_data);
+    }
 
-          if (remote_ptr_int32[i] != local_ptr_int32[i]) {
-            mapping_data->different_int32s++;
-          }
-        }
-      }
+    // Read the page frame numbers, flags and mapping counts of all pages in bulk rather than
+    // with several reads for each page.
+    // Constants are from https://www.kernel.org/doc/Documentation/vm/pagemap.txt
+    size_t clean_virtual_page_idx_begin = reinterpret_cast<uintptr_t>(local_begin) / kPageSize;
+    std::vector<uint64_t> page_frame_numbers(num_pages);
+    std::vector<uint64_t> clean_page_frame_numbers(num_pages);
+    std::vector<uint64_t> page_flags(num_pages);
+    std::vector<uint64_t> page_counts(num_pages);
+    std::string error_msg;
+    // TODO: The clean page frame numbers need to be from the same process.
+    if (!GetPageFrameNumbers(&image_pagemap_file_,
+                             boot_map.start / kPageSize,
+                             ArrayRef<uint64_t>(page_frame_numbers),
+                             &error_msg) ||
+        !GetPageFrameNumbers(&clean_pagemap_file_,
+                             clean_virtual_page_idx_begin,
+                             ArrayRef<uint64_t>(clean_page_frame_numbers),
+                             &error_msg) ||
+        !GetPageFlagsOrCounts(&kpageflags_file_,
+                              ArrayRef<const uint64_t>(page_frame_numbers),
+                              ArrayRef<uint64_t>(page_flags),
+                              &error_msg) ||
+        !GetPageFlagsOrCounts(&kpagecount_file_,
+                              ArrayRef<const uint64_t>(page_frame_numbers),
+                              ArrayRef<uint64_t>(page_counts),
+                              &error_msg)) {
+      os << error_msg;
+      return false;
     }
 
     std::vector<size_t> private_dirty_pages_for_section(ImageHeader::kSectionCount, 0u);
-
-    // Iterate through one byte at a time.
-    ptrdiff_t page_off_begin = image_header.GetImageBegin() - image_begin;
-    for (uintptr_t begin = boot_map.start; begin != boot_map.end; ++begin) {
-      previous_page_idx = page_idx;
-      ptrdiff_t offset = begin - boot_map.start;
-
-      // We treat the image header as part of the memory map for now
-      // If we wanted to change this, we could pass base=start+sizeof(ImageHeader)
-      // But it might still be interesting to see if any of the ImageHeader data mutated
-      const uint8_t* local_ptr = reinterpret_cast<const uint8_t*>(&image_header) + offset;
-      const uint8_t* remote_ptr = &remote_contents[offset];
-
-      virtual_page_idx = reinterpret_cast<uintptr_t>(local_ptr) / kPageSize;
-
-      // Calculate the page index, relative to the 0th page where the image begins
-      page_idx = (offset + page_off_begin) / kPageSize;
-      if (*local_ptr != *remote_ptr) {
-        // Track number of bytes that are different
-        mapping_data->different_bytes++;
+    for (size_t page = 0; page != num_pages; ++page) {
+      // There must be a page frame at the requested address.
+      CHECK_EQ(page_flags[page] & kPageFlagsNoPageMask, 0u);
+      // The page frame must be memory mapped
+      CHECK_NE(page_flags[page] & kPageFlagsMmapMask, 0u);
+
+      // The page has diverged from the file if it is backed by a different page frame than
+      // the clean mapping of the image in this process.
+      bool is_dirty = page_frame_numbers[page] != clean_page_frame_numbers[page];
+      bool is_private = page_counts[page] == 1u;
+      if (is_dirty) {
+        mapping_data->dirty_pages++;
+        mapping_data->dirty_page_set.insert(mapping_data->dirty_page_set.end(),
+                                            clean_virtual_page_idx_begin + page);
       }
-
-      // Independently count the # of dirty pages on the remote side
-      size_t remote_virtual_page_idx = begin / kPageSize;
-      if (previous_page_idx != page_idx) {
-        uint64_t page_count = 0xC0FFEE;
-        // TODO: virtual_page_idx needs to be from the same process
-        std::string error_msg;
-        int dirtiness = (IsPageDirty(&image_pagemap_file_,     // Image-diff-pid procmap
-                                     &clean_pagemap_file_,     // Self procmap
-                                     &kpageflags_file_,
-                                     &kpagecount_file_,
-                                     remote_virtual_page_idx,  // potentially "dirty" page
-                                     virtual_page_idx,         // true "clean" page
-                                     &page_count,
-                                     &error_msg));
-        if (dirtiness < 0) {
-          os << error_msg;
-          return false;
-        } else if (dirtiness > 0) {
-          mapping_data->dirty_pages++;
-          mapping_data->dirty_page_set.insert(mapping_data->dirty_page_set.end(), virtual_page_idx);
-        }
-
-        bool is_dirty = dirtiness > 0;
-        bool is_private = page_count == 1;
-
-        if (page_count == 1) {
-          mapping_data->private_pages++;
-        }
-
-        if (is_dirty && is_private) {
-          mapping_data->private_dirty_pages++;
-          for (size_t i = 0; i < ImageHeader::kSectionCount; ++i) {
-            const ImageHeader::ImageSections section = static_cast<ImageHeader::ImageSections>(i);
-            if (image_header.GetImageSection(section).Contains(offset)) {
-              ++private_dirty_pages_for_section[i];
-            }
+      if (is_private) {
+        mapping_data->private_pages++;
+      }
+      if (is_dirty && is_private) {
+        mapping_data->private_dirty_pages++;
+        for (size_t i = 0; i < ImageHeader::kSectionCount; ++i) {
+          const ImageHeader::ImageSections section = static_cast<ImageHeader::ImageSections>(i);
+          if (image_header.GetImageSection(section).Contains(page * kPageSize)) {
+            ++private_dirty_pages_for_section[i];
           }
         }
       }
     }
-    mapping_data->false_dirty_pages = mapping_data->dirty_pages - mapping_data->different_pages;
     // Print low-level (bytes, int32s, pages) statistics.
-    os << mapping_data->different_bytes << " differing bytes,\n  "
-       << mapping_data->different_int32s << " differing int32s,\n  "
-       << mapping_data->different_pages << " differing pages,\n  "
-       << mapping_data->dirty_pages << " pages are dirty;\n  "
-       << mapping_data->false_dirty_pages << " pages are false dirty;\n  "
-       << mapping_data->private_pages << " pages are private;\n  "
+    if (compare_contents) {
+      mapping_data->false_dirty_pages = mapping_data->dirty_pages - mapping_data->different_pages;
+      os << mapping_data->different_bytes << " differing bytes,\n  "
+         << mapping_data->different_int32s << " differing int32s,\n  "
+         << mapping_data->different_pages << " differing pages,\n  ";
+    }
+    os << mapping_data->dirty_pages << " pages are dirty;\n  ";
+    if (compare_contents) {
+      os << mapping_data->false_dirty_pages << " pages are false dirty;\n  ";
+    }
+    os << mapping_data->private_pages << " pages are private;\n  "
        << mapping_data->private_dirty_pages << " pages are Private_Dirty\n  "
        << "\n";
 
@@ -1521,6 +1567,14 @@ class ImgDiagDumper {
       return false;
     }
 
+    // Without the contents, only the kernel's view of the dirty pages can be reported.
+    if (dirty_pages_only_) {
+      MappingData mapping_data;
+      os << "Mapping at [" << reinterpret_cast<void*>(boot_map.start) << ", "
+         << reinterpret_cast<void*>(boot_map.end) << ") had:\n  ";
+      return ComputeDirtyBytes(image_header, boot_map, ArrayRef<uint8_t>(), &mapping_data);
+    }
+
     auto read_contents = [&](File* mem_file,
                              /*out*/ MemMap* map,
                              /*out*/ ArrayRef<uint8_t>* contents) {
@@ -1577,7 +1631,7 @@ class ImgDiagDumper {
 
     os << "Mapping at [" << reinterpret_cast<void*>(boot_map.start) << ", "
        << reinterpret_cast<void*>(boot_map.end) << ") had:\n  ";
-    if (!ComputeDirtyBytes(image_header, image_begin, boot_map, remote_contents, &mapping_data)) {
+    if (!ComputeDirtyBytes(image_header, boot_map, remote_contents, &mapping_data)) {
       return false;
     }
     RemoteProcesses remotes;
@@ -1613,18 +1667,6 @@ class ImgDiagDumper {
     return true;
   }
 
-  // Note: On failure, `*page_frame_number` shall be clobbered.
-  static bool GetPageFrameNumber(File* page_map_file,
-                                 size_t virtual_page_index,
-                                 /*out*/ uint64_t* page_frame_number,
-                                 /*out*/ std::string* error_msg) {
-    CHECK(page_frame_number != nullptr);
-    return GetPageFrameNumbers(page_map_file,
-                               virtual_page_index,
-                               ArrayRef<uint64_t>(page_frame_number, 1u),
-                               error_msg);
-  }
-
   // Note: On failure, `page_frame_numbers[.]` shall be clobbered.
   static bool GetPageFrameNumbers(File* page_map_file,
                                   size_t virtual_page_index,
@@ -1688,77 +1730,6 @@ class ImgDiagDumper {
     return true;
   }
 
-  static int IsPageDirty(File* page_map_file,
-                         File* clean_pagemap_file,
-                         File* kpageflags_file,
-                         File* kpagecount_file,
-                         size_t virtual_page_idx,
-                         size_t clean_virtual_page_idx,
-                         // Out parameters:
-                         uint64_t* page_count, std::string* error_msg) {
-    CHECK(page_map_file != nullptr);
-    CHECK(clean_pagemap_file != nullptr);
-    CHECK_NE(page_map_file, clean_pagemap_file);
-    CHECK(kpageflags_file != nullptr);
-    CHECK(kpagecount_file != nullptr);
-    CHECK(page_count != nullptr);
-    CHECK(error_msg != nullptr);
-
-    // Constants are from https://www.kernel.org/doc/Documentation/vm/pagemap.txt
-
-    uint64_t page_frame_number = 0;
-    if (!GetPageFrameNumber(page_map_file, virtual_page_idx, &page_frame_number, error_msg)) {
-      return -1;
-    }
-
-    uint64_t page_frame_number_clean = 0;
-    if (!GetPageFrameNumber(clean_pagemap_file, clean_virtual_page_idx, &page_frame_number_clean,
-                            error_msg)) {
-      return -1;
-    }
-
-    // Read 64-bit entry from /proc/kpageflags to get the dirty bit for a page
-    uint64_t kpage_flags_entry = 0;
-    if (!kpageflags_file->PreadFully(&kpage_flags_entry,
-                                     kPageFlagsEntrySize,
-                                     page_frame_number * kPageFlagsEntrySize)) {
-      *error_msg = StringPrintf("Failed to read the page flags from %s",
-                                kpageflags_file->GetPath().c_str());
-      return -1;
-    }
-
-    // Read 64-bit entyry from /proc/kpagecount to get mapping counts for a page
-    if (!kpagecount_file->PreadFully(page_count /*out*/,
-                                     kPageCountEntrySize,
-                                     page_frame_number * kPageCountEntrySize)) {
-      *error_msg = StringPrintf("Failed to read the page count from %s",
-                                kpagecount_file->GetPath().c_str());
-      return -1;
-    }
-
-    // There must be a page frame at the requested address.
-    CHECK_EQ(kpage_flags_entry & kPageFlagsNoPageMask, 0u);
-    // The page frame must be memory mapped
-    CHECK_NE(kpage_flags_entry & kPageFlagsMmapMask, 0u);
-
-    // Page is dirty, i.e. has diverged from file, if the 4th bit is set to 1
-    bool flags_dirty = (kpage_flags_entry & kPageFlagsDirtyMask) != 0;
-
-    // page_frame_number_clean must come from the *same* process
-    // but a *different* mmap than page_frame_number
-    if (flags_dirty) {
-      // FIXME: This check sometimes fails and the reason is not understood. b/123852774
-      if (page_frame_number != page_frame_number_clean) {
-        LOG(ERROR) << "Check failed: page_frame_number != page_frame_number_clean "
-            << "(page_frame_number=" << page_frame_number
-            << ", page_frame_number_clean=" << page_frame_number_clean << ")"
-            << " count: " << *page_count << " flags: 0x" << std::hex << kpage_flags_entry;
-      }
-    }
-
-    return (page_frame_number != page_frame_number_clean) ? 1 : 0;
-  }
-
   void PrintPidLine(const std::string& kind, pid_t pid) {
     if (pid < 0) {
       *os_ << kind << " DIFF PID: disabled\n\n";
@@ -1797,6 +1768,7 @@ class ImgDiagDumper {
   pid_t image_diff_pid_;  // Dump image diff against boot.art if pid is non-negative
   pid_t zygote_diff_pid_;  // Dump image diff against zygote boot.art if pid is non-negative
   bool dump_dirty_objects_;  // Adds dumping of objects that are dirty.
+  bool dirty_pages_only_;  // Only reads the page maps, not the contents of the remote memory.
   bool zygote_pid_only_;  // The user only specified a pid for the zygote.
 
   // BacktraceMap used for finding the memory mapping of the image file.
@@ -1827,7 +1799,8 @@ static int DumpImage(Runtime* runtime,
                      std::ostream* os,
                      pid_t image_diff_pid,
                      pid_t zygote_diff_pid,
-                     bool dump_dirty_objects) {
+                     bool dump_dirty_objects,
+                     bool dirty_pages_only) {
   ScopedObjectAccess soa(Thread::Current());
   gc::Heap* heap = runtime->GetHeap();
   const std::vector<gc::space::ImageSpace*>& image_spaces = heap->GetBootImageSpaces();
@@ -1835,7 +1808,8 @@ static int DumpImage(Runtime* runtime,
   ImgDiagDumper img_diag_dumper(os,
                                 image_diff_pid,
                                 zygote_diff_pid,
-                                dump_dirty_objects);
+                                dump_dirty_objects,
+                                dirty_pages_only);
   if (!img_diag_dumper.Init()) {
     return EXIT_FAILURE;
   }
@@ -1885,6 +1859,8 @@ struct ImgDiagArgs : public CmdlineArgs {
       }
     } else if (option == "--dump-dirty-objects") {
       dump_dirty_objects_ = true;
+    } else if (option == "--dirty-pages-only") {
+      dirty_pages_only_ = true;
     } else {
       return kParseUnknownArgument;
     }
@@ -1938,6 +1914,8 @@ struct ImgDiagArgs : public CmdlineArgs {
         "against.\n"
         "      Example: --zygote-diff-pid=$(pid zygote)\n"
         "  --dump-dirty-objects: additionally output dirty objects of interest.\n"
+        "  --dirty-pages-only: only report the pages the kernel considers dirty, without\n"
+        "      reading the remote memory or diffing its contents.\n"
         "\n";
 
     return usage;
@@ -1947,6 +1925,7 @@ struct ImgDiagArgs : public CmdlineArgs {
   pid_t image_diff_pid_ = -1;
   pid_t zygote_diff_pid_ = -1;
   bool dump_dirty_objects_ = false;
+  bool dirty_pages_only_ = false;
 };
 
 struct ImgDiagMain : public CmdlineMain<ImgDiagArgs> {
@@ -1957,7 +1936,8 @@ struct ImgDiagMain : public CmdlineMain<ImgDiagArgs> {
                      args_->os_,
                      args_->image_diff_pid_,
                      args_->zygote_diff_pid_,
-                     args_->dump_dirty_objects_) == EXIT_SUCCESS;
+                     args_->dump_dirty_objects_,
+                     args_->dirty_pages_only_) == EXIT_SUCCESS;
   }
 };
 
@@ -106,9 +106,13 @@ Arena* MallocArenaPool::AllocArena(size_t size) {
   Arena* ret = nullptr;
   {
     std::lock_guard<std::mutex> lock(lock_);
-    if (free_arenas_ != nullptr && LIKELY(free_arenas_->Size() >= size)) {
-      ret = free_arenas_;
-      free_arenas_ = free_arenas_->next_;
+    // Take the first free arena that is big enough, not just the head of the list.
+    for (Arena** link = &free_arenas_; *link != nullptr; link = &(*link)->next_) {
+      if (LIKELY((*link)->Size() >= size)) {
+        ret = *link;
+        *link = ret->next_;
+        break;
+      }
     }
   }
   if (ret == nullptr) {
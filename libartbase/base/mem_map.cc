@@ -814,6 +814,49 @@ void MemMap::ReleaseReservedMemory(size_t byte_count) {
   }
 }
 
+bool MemMap::Grow(size_t new_size, /*out*/std::string* error_msg) {
+#if !HAVE_MREMAP_SYSCALL
+  UNUSED(new_size);
+  *error_msg = "Cannot grow the mapping because we are missing the required mremap syscall";
+  return false;
+#else  // !HAVE_MREMAP_SYSCALL
+  CHECK(IsValid());
+  CHECK_GT(new_size, size_);
+  if (reuse_) {
+    *error_msg = "Cannot grow a mapping which is not a real mmap";
+    return false;
+  }
+  // TODO Support redzones.
+  if (redzone_size_ != 0) {
+    *error_msg = "Cannot grow a mapping with redzones";
+    return false;
+  }
+  size_t offset = PointerDiff(BaseBegin(), Begin());
+  size_t new_base_size = RoundUp(offset + new_size, kPageSize);
+  void* actual = mremap(base_begin_, base_size_, new_base_size, MREMAP_MAYMOVE);
+  if (actual == MAP_FAILED) {
+    *error_msg = StringPrintf("Failed to mremap %p from %zu to %zu bytes: %s",
+                              base_begin_,
+                              base_size_,
+                              new_base_size,
+                              strerror(errno));
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> mu(*mem_maps_lock_);
+    auto it = GetGMapsEntry(*this);
+    auto node = gMaps->extract(it);
+    begin_ = reinterpret_cast<uint8_t*>(actual) + offset;
+    size_ = new_size;
+    base_begin_ = actual;
+    base_size_ = new_base_size;
+    node.key() = base_begin_;
+    gMaps->insert(std::move(node));
+  }
+  return true;
+#endif  // !HAVE_MREMAP_SYSCALL
+}
+
 void MemMap::MadviseDontNeedAndZero() {
   if (base_begin_ != nullptr || base_size_ != 0) {
     if (!kMadviseZeroes) {
@@ -248,6 +248,12 @@ class MemMap {
   // Resize the mem-map by unmapping pages at the end. Currently only supports shrinking.
   void SetSize(size_t new_size);
 
+  // Grow the mem-map to `new_size` with mremap, which moves the pages rather than copying them
+  // when the map cannot grow in place. The map may therefore move, and must not be a 'reused'
+  // mapping, have redzones or need to stay in the low 4GB. Returns false and leaves the map
+  // unchanged on failure, including when mremap is not available.
+  bool Grow(size_t new_size, /*out*/std::string* error_msg);
+
   uint8_t* End() const {
     return Begin() + Size();
   }
@@ -319,6 +319,43 @@ TEST_F(MemMapTest, ReplaceMapping_FailureOverlap) {
   ASSERT_EQ(memcmp(source.Begin(), data.data(), data.size()), 0);
   ASSERT_EQ(memcmp(dest.Begin(), dest_data.data(), dest_data.size()), 0);
 }
+
+TEST_F(MemMapTest, Grow) {
+  CommonInit();
+  std::string error_msg;
+  MemMap map = MemMap::MapAnonymous("MapAnonymous-grow",
+                                    kPageSize,
+                                    PROT_READ | PROT_WRITE,
+                                    /*low_4gb=*/ false,
+                                    &error_msg);
+  ASSERT_TRUE(map.IsValid()) << error_msg;
+  // Block growth in place so that the pages have to move.
+  MemMap blocker = MemMap::MapAnonymous("MapAnonymous-grow-blocker",
+                                        map.End(),
+                                        kPageSize,
+                                        PROT_READ,
+                                        /*low_4gb=*/ false,
+                                        /*reuse=*/ false,
+                                        /*reservation=*/ nullptr,
+                                        &error_msg);
+  std::vector<uint8_t> data = RandomData(kPageSize);
+  memcpy(map.Begin(), data.data(), data.size());
+
+  ASSERT_TRUE(map.Grow(3 * kPageSize, &error_msg)) << error_msg;
+  ASSERT_EQ(map.Size(), 3 * kPageSize);
+  ASSERT_EQ(map.BaseSize(), 3 * kPageSize);
+  ASSERT_TRUE(IsAddressMapped(map.Begin()));
+  ASSERT_TRUE(IsAddressMapped(map.End() - 1));
+  ASSERT_EQ(memcmp(map.Begin(), data.data(), data.size()), 0);
+  // The new pages are zeroed and writable.
+  for (size_t i = kPageSize; i != map.Size(); ++i) {
+    ASSERT_EQ(map.Begin()[i], 0u);
+  }
+  map.Begin()[map.Size() - 1] = 1u;
+  if (blocker.IsValid()) {
+    ASSERT_FALSE(map.HasAddress(blocker.Begin()));
+  }
+}
 #endif  // HAVE_MREMAP_SYSCALL
 
 TEST_F(MemMapTest, MapAnonymousEmpty) {
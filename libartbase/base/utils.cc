@@ -23,8 +23,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "android-base/file.h"
 #include "android-base/stringprintf.h"
@@ -47,6 +50,7 @@
 
 #if defined(__linux__)
 #include <linux/unistd.h>
+#include <sched.h>
 #include <sys/syscall.h>
 #include <sys/utsname.h>
 #endif
@@ -356,6 +360,35 @@ bool IsAddressKnownBackedByFileOrShared(const void* addr) {
   return (flags & (1LL << 61)) != 0;
 }
 
+ssize_t GetPrivateAnonymousPageCount(const void* begin, size_t size) {
+  // See IsAddressKnownBackedByFileOrShared() for the pagemap interface.
+  uintptr_t vmstart = reinterpret_cast<uintptr_t>(AlignDown(begin, kPageSize));
+  uintptr_t vmend = RoundUp(reinterpret_cast<uintptr_t>(begin) + size, kPageSize);
+  android::base::unique_fd pagemap(open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC));
+  if (pagemap == -1) {
+    return -1;
+  }
+  ssize_t count = 0;
+  std::vector<uint64_t> entries(std::min<size_t>((vmend - vmstart) / kPageSize, 1024u));
+  for (uintptr_t page = vmstart; page != vmend; ) {
+    size_t num_pages = std::min<size_t>((vmend - page) / kPageSize, entries.size());
+    size_t length = num_pages * sizeof(uint64_t);
+    off_t index = (page / kPageSize) * sizeof(uint64_t);
+    if (pread(pagemap, entries.data(), length, index) != static_cast<ssize_t>(length)) {
+      return -1;
+    }
+    for (size_t i = 0; i != num_pages; ++i) {
+      //  * Bit  61    page is file-page or shared-anon (since 3.5)
+      //  * Bit  63    page present
+      if ((entries[i] & (1ULL << 63)) != 0u && (entries[i] & (1ULL << 61)) == 0u) {
+        ++count;
+      }
+    }
+    page += num_pages * kPageSize;
+  }
+  return count;
+}
+
 int GetTaskCount() {
   DIR* directory = opendir("/proc/self/task");
   if (directory == nullptr) {
@@ -374,4 +407,55 @@ int GetTaskCount() {
   return count;
 }
 
+#if defined(__linux__)
+// Returns the CPU quota of the cgroup of the process in whole CPUs, rounded up,
+// or 0 if the cgroup has no quota.
+static size_t GetCgroupCpuQuota() {
+  int64_t quota = -1;
+  int64_t period = 0;
+  std::string content;
+  if (android::base::ReadFileToString("/sys/fs/cgroup/cpu.max", &content)) {
+    // cgroup v2: "<quota> <period>", where the quota may be "max".
+    std::vector<std::string> fields =
+        android::base::Split(android::base::Trim(content), " ");
+    if (fields.size() == 2u && fields[0] != "max") {
+      quota = strtoll(fields[0].c_str(), nullptr, 10);
+      period = strtoll(fields[1].c_str(), nullptr, 10);
+    }
+  } else if (android::base::ReadFileToString("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", &content)) {
+    // cgroup v1: the quota is -1 when there is no limit.
+    quota = strtoll(content.c_str(), nullptr, 10);
+    if (android::base::ReadFileToString("/sys/fs/cgroup/cpu/cpu.cfs_period_us", &content)) {
+      period = strtoll(content.c_str(), nullptr, 10);
+    }
+  }
+  if (quota <= 0 || period <= 0) {
+    return 0u;
+  }
+  return static_cast<size_t>((quota + period - 1) / period);
+}
+#endif
+
+size_t GetUsableCpuCount() {
+  static const size_t usable_cpu_count = []() {
+    size_t count = std::thread::hardware_concurrency();
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+      size_t affinity_count = static_cast<size_t>(CPU_COUNT(&cpu_set));
+      if (affinity_count != 0u) {
+        count = (count == 0u) ? affinity_count : std::min(count, affinity_count);
+      }
+    }
+    size_t quota = GetCgroupCpuQuota();
+    if (quota != 0u) {
+      count = (count == 0u) ? quota : std::min(count, quota);
+    }
+#endif
+    return std::max<size_t>(count, 1u);
+  }();
+  return usable_cpu_count;
+}
+
 }  // namespace art
@@ -159,9 +159,18 @@ std::string GetProcessStatus(const char* key);
 // following accesses repopulate the memory or return zero.
 bool IsAddressKnownBackedByFileOrShared(const void* addr);
 
+// Return the number of pages in [begin, begin + size) that are present and private anonymous,
+// for example the pages of a private file mapping that were copied on write, or -1 on failure.
+ssize_t GetPrivateAnonymousPageCount(const void* begin, size_t size);
+
 // Returns the number of threads running.
 int GetTaskCount();
 
+// Returns the number of CPUs the process can actually use: the online CPUs,
+// restricted to the affinity mask and to the CPU quota of the process's cgroup
+// (rounded up). Always at least 1. Computed once and cached.
+size_t GetUsableCpuCount();
+
 }  // namespace art
 
 #endif  // ART_LIBARTBASE_BASE_UTILS_H_
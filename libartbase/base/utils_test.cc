@@ -16,6 +16,10 @@
 
 #include "utils.h"
 
+#include <sys/mman.h>
+
+#include <thread>
+
 #include "gtest/gtest.h"
 
 namespace art {
@@ -115,4 +119,28 @@ TEST_F(UtilsTest, GetProcessStatus) {
   EXPECT_EQ("<unknown>", GetProcessStatus("Dummy"));
 }
 
+TEST_F(UtilsTest, GetPrivateAnonymousPageCount) {
+  const size_t size = 4 * kPageSize;
+  void* begin = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(begin, MAP_FAILED);
+  EXPECT_EQ(0, GetPrivateAnonymousPageCount(begin, size));
+  uint8_t* pages = reinterpret_cast<uint8_t*>(begin);
+  pages[0] = 1u;
+  pages[2 * kPageSize + 1] = 1u;
+  EXPECT_EQ(2, GetPrivateAnonymousPageCount(begin, size));
+  EXPECT_EQ(1, GetPrivateAnonymousPageCount(pages + 2 * kPageSize, kPageSize));
+  munmap(begin, size);
+}
+
+TEST_F(UtilsTest, GetUsableCpuCount) {
+  const size_t count = GetUsableCpuCount();
+  EXPECT_GE(count, 1u);
+  const size_t hardware_count = std::thread::hardware_concurrency();
+  if (hardware_count != 0u) {
+    EXPECT_LE(count, hardware_count);
+  }
+  // The value is cached.
+  EXPECT_EQ(count, GetUsableCpuCount());
+}
+
 }  // namespace art
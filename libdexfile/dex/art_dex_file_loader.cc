@@ -18,6 +18,10 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "android-base/stringprintf.h"
 
 #include "base/file_magic.h"
@@ -27,6 +31,7 @@
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/unix_file/fd_file.h"
+#include "base/utils.h"
 #include "base/zip_archive.h"
 #include "dex/compact_dex_file.h"
 #include "dex/dex_file.h"
@@ -386,16 +391,37 @@ std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromZip(
     std::string* error_msg,
     DexFileLoaderErrorCode* error_code) const {
   ScopedTrace trace("Dex file open from Zip Archive " + std::string(location));
+  uint32_t location_checksum;
+  MemMap map = MapOneDexFileFromZip(
+      zip_archive, entry_name, location, &location_checksum, error_msg, error_code);
+  if (!map.IsValid()) {
+    return nullptr;
+  }
+  return OpenOneDexFileFromMap(std::move(map),
+                               location,
+                               location_checksum,
+                               verify,
+                               verify_checksum,
+                               error_msg,
+                               error_code);
+}
+
+MemMap ArtDexFileLoader::MapOneDexFileFromZip(const ZipArchive& zip_archive,
+                                              const char* entry_name,
+                                              const std::string& location,
+                                              /*out*/ uint32_t* location_checksum,
+                                              std::string* error_msg,
+                                              DexFileLoaderErrorCode* error_code) {
   CHECK(!location.empty());
   std::unique_ptr<ZipEntry> zip_entry(zip_archive.Find(entry_name, error_msg));
   if (zip_entry == nullptr) {
     *error_code = DexFileLoaderErrorCode::kEntryNotFound;
-    return nullptr;
+    return MemMap::Invalid();
   }
   if (zip_entry->GetUncompressedLength() == 0) {
     *error_msg = StringPrintf("Dex file '%s' has zero length", location.c_str());
     *error_code = DexFileLoaderErrorCode::kDexFileError;
-    return nullptr;
+    return MemMap::Invalid();
   }
 
   MemMap map;
@@ -427,8 +453,20 @@ std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromZip(
     *error_msg = StringPrintf("Failed to extract '%s' from '%s': %s", entry_name, location.c_str(),
                               error_msg->c_str());
     *error_code = DexFileLoaderErrorCode::kExtractToMemoryError;
-    return nullptr;
+    return MemMap::Invalid();
   }
+  *location_checksum = zip_entry->GetCrc32();
+  return map;
+}
+
+std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromMap(
+    MemMap&& map,
+    const std::string& location,
+    uint32_t location_checksum,
+    bool verify,
+    bool verify_checksum,
+    std::string* error_msg,
+    DexFileLoaderErrorCode* error_code) const {
   VerifyResult verify_result;
   uint8_t* begin = map.Begin();
   size_t size = map.Size();
@@ -437,7 +475,7 @@ std::unique_ptr<const DexFile> ArtDexFileLoader::OpenOneDexFileFromZip(
                                                  /*data_base=*/ nullptr,
                                                  /*data_size=*/ 0u,
                                                  location,
-                                                 zip_entry->GetCrc32(),
+                                                 location_checksum,
                                                  kNoOatDexFile,
                                                  verify,
                                                  verify_checksum,
@@ -496,48 +534,96 @@ bool ArtDexFileLoader::OpenAllDexFilesFromZip(
                                                                 &error_code));
   if (dex_file.get() == nullptr) {
     return false;
-  } else {
-    // Had at least classes.dex.
-    dex_files->push_back(std::move(dex_file));
-
-    // Now try some more.
-
-    // We could try to avoid std::string allocations by working on a char array directly. As we
-    // do not expect a lot of iterations, this seems too involved and brittle.
-
-    for (size_t i = 1; ; ++i) {
-      std::string name = GetMultiDexClassesDexName(i);
-      std::string fake_location = GetMultiDexLocation(i, location.c_str());
-      std::unique_ptr<const DexFile> next_dex_file(OpenOneDexFileFromZip(zip_archive,
-                                                                         name.c_str(),
-                                                                         fake_location,
-                                                                         verify,
-                                                                         verify_checksum,
-                                                                         error_msg,
-                                                                         &error_code));
-      if (next_dex_file.get() == nullptr) {
-        if (error_code != DexFileLoaderErrorCode::kEntryNotFound) {
-          LOG(WARNING) << "Zip open failed: " << *error_msg;
-        }
-        break;
-      } else {
-        dex_files->push_back(std::move(next_dex_file));
-      }
+  }
+  // Had at least classes.dex.
+  dex_files->push_back(std::move(dex_file));
+
+  // Now try some more. The zip archive is read on this thread only, but the checksum and
+  // verification of the extracted multidex files are independent and done in parallel below.
+  struct MultiDexEntry {
+    std::string location;
+    MemMap map;
+    uint32_t location_checksum = 0u;
+    std::unique_ptr<const DexFile> dex_file;
+    std::string error_msg;
+    DexFileLoaderErrorCode error_code = DexFileLoaderErrorCode::kNoError;
+  };
+  std::vector<MultiDexEntry> entries;
+
+  // We could try to avoid std::string allocations by working on a char array directly. As we
+  // do not expect a lot of iterations, this seems too involved and brittle.
+
+  for (size_t i = 1; ; ++i) {
+    std::string name = GetMultiDexClassesDexName(i);
+    entries.emplace_back();
+    MultiDexEntry& entry = entries.back();
+    entry.location = GetMultiDexLocation(i, location.c_str());
+    entry.map = MapOneDexFileFromZip(zip_archive,
+                                     name.c_str(),
+                                     entry.location,
+                                     &entry.location_checksum,
+                                     &entry.error_msg,
+                                     &entry.error_code);
+    if (!entry.map.IsValid()) {
+      break;
+    }
 
-      if (i == kWarnOnManyDexFilesThreshold) {
-        LOG(WARNING) << location << " has in excess of " << kWarnOnManyDexFilesThreshold
-                     << " dex files. Please consider coalescing and shrinking the number to "
-                        " avoid runtime overhead.";
-      }
+    if (i == kWarnOnManyDexFilesThreshold) {
+      LOG(WARNING) << location << " has in excess of " << kWarnOnManyDexFilesThreshold
+                   << " dex files. Please consider coalescing and shrinking the number to "
+                      " avoid runtime overhead.";
+    }
 
-      if (i == std::numeric_limits<size_t>::max()) {
-        LOG(ERROR) << "Overflow in number of dex files!";
-        break;
+    if (i == std::numeric_limits<size_t>::max()) {
+      LOG(ERROR) << "Overflow in number of dex files!";
+      break;
+    }
+  }
+
+  std::atomic<size_t> next_index(0u);
+  auto open_entries = [&]() {
+    for (size_t i = next_index.fetch_add(1u, std::memory_order_relaxed);
+         i < entries.size();
+         i = next_index.fetch_add(1u, std::memory_order_relaxed)) {
+      MultiDexEntry& entry = entries[i];
+      if (entry.map.IsValid()) {
+        entry.dex_file = OpenOneDexFileFromMap(std::move(entry.map),
+                                               entry.location,
+                                               entry.location_checksum,
+                                               verify,
+                                               verify_checksum,
+                                               &entry.error_msg,
+                                               &entry.error_code);
       }
     }
+  };
+  size_t num_mapped = std::count_if(entries.begin(),
+                                    entries.end(),
+                                    [](const MultiDexEntry& entry) { return entry.map.IsValid(); });
+  size_t num_threads = std::min(GetUsableCpuCount(), num_mapped);
+  std::vector<std::thread> helpers;
+  for (size_t i = 1; i < num_threads; ++i) {
+    helpers.emplace_back(open_entries);
+  }
+  open_entries();
+  for (std::thread& helper : helpers) {
+    helper.join();
+  }
 
-    return true;
+  // Keep the dex files up to the first one that failed to open, as if they had been opened
+  // one after another.
+  for (MultiDexEntry& entry : entries) {
+    if (entry.dex_file == nullptr) {
+      *error_msg = entry.error_msg;
+      if (entry.error_code != DexFileLoaderErrorCode::kEntryNotFound) {
+        LOG(WARNING) << "Zip open failed: " << *error_msg;
+      }
+      break;
+    }
+    dex_files->push_back(std::move(entry.dex_file));
   }
+
+  return true;
 }
 
 std::unique_ptr<DexFile> ArtDexFileLoader::OpenCommon(const uint8_t* base,
@@ -137,6 +137,25 @@ class ArtDexFileLoader : public DexFileLoader {
                                                        std::string* error_msg,
                                                        DexFileLoaderErrorCode* error_code) const;
 
+  // Maps or extracts the entry_name in a zip archive and returns its CRC32 in location_checksum.
+  // Returns an invalid map and sets error_code on failure.
+  static MemMap MapOneDexFileFromZip(const ZipArchive& zip_archive,
+                                     const char* entry_name,
+                                     const std::string& location,
+                                     /*out*/ uint32_t* location_checksum,
+                                     std::string* error_msg,
+                                     DexFileLoaderErrorCode* error_code);
+
+  // Opens .dex file from a map returned by MapOneDexFileFromZip(). error_code is undefined when
+  // non-null return.
+  std::unique_ptr<const DexFile> OpenOneDexFileFromMap(MemMap&& map,
+                                                       const std::string& location,
+                                                       uint32_t location_checksum,
+                                                       bool verify,
+                                                       bool verify_checksum,
+                                                       std::string* error_msg,
+                                                       DexFileLoaderErrorCode* error_code) const;
+
   static std::unique_ptr<DexFile> OpenCommon(const uint8_t* base,
                                              size_t size,
                                              const uint8_t* data_base,
@@ -27,6 +27,46 @@ namespace art {
 
 using android::base::StringAppendF;
 
+// The ASCII prefix scans below test a word at a time. The loads use memcpy() since the
+// strings have no particular alignment.
+static constexpr uint64_t kUtf8HighBits = UINT64_C(0x8080808080808080);
+static constexpr uint64_t kUtf16NonAsciiBits = UINT64_C(0xff80ff80ff80ff80);
+static constexpr uint64_t kUtf16LowBits = UINT64_C(0x0001000100010001);
+static constexpr uint64_t kUtf16HighBits = UINT64_C(0x8000800080008000);
+
+size_t CountModifiedUtf8AsciiPrefix(const char* utf8, size_t byte_count) {
+  size_t i = 0u;
+  for (; byte_count - i >= sizeof(uint64_t); i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, utf8 + i, sizeof(word));
+    if ((word & kUtf8HighBits) != 0u) {
+      break;
+    }
+  }
+  while (i != byte_count && static_cast<uint8_t>(utf8[i]) < 0x80u) {
+    ++i;
+  }
+  return i;
+}
+
+size_t CountUtf16AsciiPrefix(const uint16_t* chars, size_t char_count) {
+  static constexpr size_t kCharsPerWord = sizeof(uint64_t) / sizeof(uint16_t);
+  size_t i = 0u;
+  for (; char_count - i >= kCharsPerWord; i += kCharsPerWord) {
+    uint64_t word;
+    memcpy(&word, chars + i, sizeof(word));
+    // With no char above U+007F, subtracting one from each char borrows only from zero chars.
+    if ((word & kUtf16NonAsciiBits) != 0u ||
+        ((word - kUtf16LowBits) & kUtf16HighBits) != 0u) {
+      break;
+    }
+  }
+  while (i != char_count && chars[i] - 1u < 0x7fu) {
+    ++i;
+  }
+  return i;
+}
+
 // This is used only from debugger and test code.
 size_t CountModifiedUtf8Chars(const char* utf8) {
   return CountModifiedUtf8Chars(utf8, strlen(utf8));
@@ -52,12 +92,15 @@ size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count) {
   size_t len = 0;
   const char* end = utf8 + byte_count;
   for (; utf8 < end; ++utf8) {
+    // Skip the one-byte encodings a word at a time.
+    size_t ascii_length = CountModifiedUtf8AsciiPrefix(utf8, end - utf8);
+    len += ascii_length;
+    utf8 += ascii_length;
+    if (utf8 == end) {
+      break;
+    }
     int ic = *utf8;
     len++;
-    if (LIKELY((ic & 0x80) == 0)) {
-      // One-byte encoding.
-      continue;
-    }
     // Two- or three-byte encoding.
     utf8++;
     if ((ic & 0x20) == 0) {
@@ -110,6 +153,14 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
 
   // String contains non-ASCII characters.
   for (const char *p = in_start; p < in_end;) {
+    // Widen runs of ASCII characters directly.
+    const char* ascii_end = p + CountModifiedUtf8AsciiPrefix(p, in_end - p);
+    while (p != ascii_end) {
+      *out_p++ = static_cast<uint8_t>(*p++);
+    }
+    if (p == in_end) {
+      break;
+    }
     const uint32_t ch = GetUtf16FromUtf8(&p);
     const uint16_t leading = GetLeadingUtf16Char(ch);
     const uint16_t trailing = GetTrailingUtf16Char(ch);
@@ -133,7 +184,18 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
   }
 
   // String contains non-ASCII characters.
-  while (char_count--) {
+  while (char_count != 0u) {
+    // Narrow runs of ASCII characters directly.
+    size_t ascii_length = CountUtf16AsciiPrefix(utf16_in, char_count);
+    for (size_t i = 0; i != ascii_length; ++i) {
+      *utf8_out++ = static_cast<char>(utf16_in[i]);
+    }
+    utf16_in += ascii_length;
+    char_count -= ascii_length;
+    if (char_count == 0u) {
+      break;
+    }
+    --char_count;
     const uint16_t ch = *utf16_in++;
     if (ch > 0 && ch <= 0x7f) {
       *utf8_out++ = ch;
@@ -175,7 +237,14 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
 }
 
 int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length) {
-  uint32_t hash = 0;
+  // Hash the leading ASCII chars directly from the bytes. Modified UTF-8 encodes
+  // '\0' with two bytes, so there is no terminator within the ASCII prefix.
+  // A string of `utf16_length` chars has at least as many bytes.
+  size_t ascii_length = CountModifiedUtf8AsciiPrefix(utf8, utf16_length);
+  uint32_t hash =
+      ComputeUtf16Hash(/* hash= */ 0u, reinterpret_cast<const uint8_t*>(utf8), ascii_length);
+  utf8 += ascii_length;
+  utf16_length -= ascii_length;
   while (utf16_length != 0u) {
     const uint32_t pair = GetUtf16FromUtf8(&utf8);
     const uint16_t first = GetLeadingUtf16Char(pair);
@@ -240,11 +309,14 @@ size_t CountUtf8Bytes(const uint16_t* chars, size_t char_count) {
   size_t result = 0;
   const uint16_t *end = chars + char_count;
   while (chars < end) {
-    const uint16_t ch = *chars++;
-    if (LIKELY(ch != 0 && ch < 0x80)) {
-      result++;
-      continue;
+    // Count runs of ASCII characters a word at a time.
+    size_t ascii_length = CountUtf16AsciiPrefix(chars, end - chars);
+    result += ascii_length;
+    chars += ascii_length;
+    if (chars == end) {
+      break;
     }
+    const uint16_t ch = *chars++;
     if (ch < 0x800) {
       result += 2;
       continue;
@@ -38,6 +38,19 @@ namespace art {
 size_t CountModifiedUtf8Chars(const char* utf8);
 size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count);
 
+/*
+ * Returns the number of leading one-byte (ASCII) characters in the given modified UTF-8
+ * string of `byte_count` bytes. Scans a word at a time.
+ */
+size_t CountModifiedUtf8AsciiPrefix(const char* utf8, size_t byte_count);
+
+/*
+ * Returns the number of leading UTF-16 characters in the given string which are encoded
+ * with a single byte in modified UTF-8, i.e. in the range U+0001 - U+007F. Scans a word
+ * at a time.
+ */
+size_t CountUtf16AsciiPrefix(const uint16_t* chars, size_t char_count);
+
 /*
  * Returns the number of modified UTF-8 bytes needed to represent the given
  * UTF-16 string.
@@ -74,15 +87,35 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
                                 const uint16_t* utf16_in, size_t char_count);
 
 /*
- * The java.lang.String hashCode() algorithm.
+ * Continue the java.lang.String hashCode() algorithm from `hash` over `chars`.
+ * Four chars are hashed per step, with the powers of 31, so that the products
+ * do not depend on each other and can be computed in parallel, or in vector
+ * lanes by the C++ compiler.
  */
 template<typename MemoryType>
-int32_t ComputeUtf16Hash(const MemoryType* chars, size_t char_count) {
-  uint32_t hash = 0;
+uint32_t ComputeUtf16Hash(uint32_t hash, const MemoryType* chars, size_t char_count) {
+  constexpr uint32_t k31Pow2 = 31u * 31u;
+  constexpr uint32_t k31Pow3 = k31Pow2 * 31u;
+  constexpr uint32_t k31Pow4 = k31Pow3 * 31u;
+  for (; char_count >= 4u; char_count -= 4u, chars += 4) {
+    hash = hash * k31Pow4 +
+        k31Pow3 * static_cast<uint32_t>(chars[0]) +
+        k31Pow2 * static_cast<uint32_t>(chars[1]) +
+        31u * static_cast<uint32_t>(chars[2]) +
+        static_cast<uint32_t>(chars[3]);
+  }
   while (char_count--) {
     hash = hash * 31 + *chars++;
   }
-  return static_cast<int32_t>(hash);
+  return hash;
+}
+
+/*
+ * The java.lang.String hashCode() algorithm.
+ */
+template<typename MemoryType>
+int32_t ComputeUtf16Hash(const MemoryType* chars, size_t char_count) {
+  return static_cast<int32_t>(ComputeUtf16Hash(/* hash= */ 0u, chars, char_count));
 }
 
 int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length);
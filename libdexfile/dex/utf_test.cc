@@ -17,6 +17,7 @@
 #include "utf.h"
 
 #include <map>
+#include <string>
 #include <vector>
 
 #include <android-base/stringprintf.h>
@@ -380,6 +381,33 @@ TEST_F(UtfTest, ExhaustiveBidirectionalCodePointCheck) {
   }
 }
 
+TEST_F(UtfTest, AsciiPrefix) {
+  // Place a non-ASCII char at every position of strings spanning several words, so that the
+  // word at a time scans find it in every lane and in the tail.
+  static constexpr size_t kLength = 20u;
+  for (uint16_t non_ascii : { 0x0000, 0x0080, 0x0101, 0x0801, 0xd801 }) {
+    for (size_t pos = 0; pos <= kLength; ++pos) {
+      std::vector<uint16_t> utf16(kLength, 'a');
+      if (pos != kLength) {
+        utf16[pos] = non_ascii;
+      }
+      EXPECT_EQ(pos, CountUtf16AsciiPrefix(utf16.data(), utf16.size()));
+
+      size_t byte_count = CountUtf8Bytes(utf16.data(), utf16.size());
+      std::string utf8(byte_count, '\0');
+      ConvertUtf16ToModifiedUtf8(&utf8[0], byte_count, utf16.data(), utf16.size());
+      EXPECT_EQ(pos, CountModifiedUtf8AsciiPrefix(utf8.c_str(), byte_count));
+      EXPECT_EQ(utf16.size(), CountModifiedUtf8Chars(utf8.c_str(), byte_count));
+
+      std::vector<uint16_t> round_trip(utf16.size());
+      ConvertModifiedUtf8ToUtf16(round_trip.data(), round_trip.size(), utf8.c_str(), byte_count);
+      EXPECT_EQ(utf16, round_trip);
+      EXPECT_EQ(ComputeUtf16Hash(utf16.data(), utf16.size()),
+                ComputeUtf16HashFromModifiedUtf8(utf8.c_str(), utf16.size()));
+    }
+  }
+}
+
 TEST_F(UtfTest, NonAscii) {
   const char kNonAsciiCharacter = '\x80';
   const char input[] = { kNonAsciiCharacter, '\0' };
@@ -387,6 +415,38 @@ TEST_F(UtfTest, NonAscii) {
   EXPECT_EQ(static_cast<uint8_t>(kNonAsciiCharacter), hash);
 }
 
+static int32_t ComputeUtf16HashOneCharAtATime(const uint16_t* chars, size_t char_count) {
+  uint32_t hash = 0;
+  while (char_count--) {
+    hash = hash * 31 + *chars++;
+  }
+  return static_cast<int32_t>(hash);
+}
+
+TEST_F(UtfTest, ComputeUtf16Hash) {
+  std::vector<uint16_t> chars;
+  std::vector<uint8_t> compressed_chars;
+  for (size_t length = 0; length != 40u; ++length) {
+    int32_t expected = ComputeUtf16HashOneCharAtATime(chars.data(), chars.size());
+    EXPECT_EQ(expected, ComputeUtf16Hash(chars.data(), chars.size())) << length;
+    EXPECT_EQ(expected, ComputeUtf16Hash(compressed_chars.data(), compressed_chars.size()))
+        << length;
+    // Modified UTF-8 of the same ASCII chars.
+    std::string utf8(compressed_chars.begin(), compressed_chars.end());
+    EXPECT_EQ(expected, ComputeUtf16HashFromModifiedUtf8(utf8.c_str(), chars.size())) << length;
+    chars.push_back('a' + length % 26u);
+    compressed_chars.push_back('a' + length % 26u);
+  }
+
+  // Non-ASCII chars, after and within an ASCII prefix.
+  const uint16_t kChars[] = { 'h', 'e', 'l', 'l', 'o', 0x20ac, 'w', 0x00e9, 'r', 'l', 'd' };
+  const char kUtf8[] = "hello\xe2\x82\xacw\xc3\xa9rld";
+  EXPECT_EQ(ComputeUtf16HashOneCharAtATime(kChars, arraysize(kChars)),
+            ComputeUtf16HashFromModifiedUtf8(kUtf8, arraysize(kChars)));
+  EXPECT_EQ(ComputeUtf16HashOneCharAtATime(kChars, arraysize(kChars)),
+            ComputeUtf16Hash(kChars, arraysize(kChars)));
+}
+
 TEST_F(UtfTest, PrintableStringUtf8) {
   // Note: This is UTF-8, not Modified-UTF-8.
   const uint8_t kTestSequence[] = { 0xf0, 0x90, 0x80, 0x80, 0 };
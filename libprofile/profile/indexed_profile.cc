@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "indexed_profile.h"
+
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+
+#include "base/bit_utils.h"
+#include "base/mman.h"  // For the PROT_* and MAP_* constants.
+#include "base/systrace.h"
+#include "dex/dex_file.h"
+#include "profile_helpers.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+using Hotness = ProfileCompilationInfo::MethodHotness;
+
+const uint8_t IndexedProfile::kMagic[] = { 'p', 'r', 'i', '\0' };
+const uint8_t IndexedProfile::kVersion[] = { '0', '0', '1', '\0' };
+
+static_assert(sizeof(IndexedProfile::kMagic) == 4, "Invalid magic size");
+static_assert(sizeof(IndexedProfile::kVersion) == 4, "Invalid version size");
+
+// Boot profiles have the most flags.
+static constexpr uint32_t kMaxMethodFlags =
+    WhichPowerOf2(static_cast<uint32_t>(Hotness::kFlagLastBoot)) + 1u;
+
+size_t IndexedProfile::GetBitmapSize(uint32_t num_method_flags, uint32_t num_method_ids) {
+  return RoundUp(static_cast<size_t>(num_method_flags) * num_method_ids, kBitsPerByte) /
+      kBitsPerByte;
+}
+
+bool IndexedProfile::Save(const ProfileCompilationInfo& info, int fd) {
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  const uint32_t num_method_flags = WhichPowerOf2(static_cast<uint32_t>(
+      info.IsForBootImage() ? Hotness::kFlagLastBoot : Hotness::kFlagLastRegular)) + 1u;
+
+  // Keep the first dex file data of each base key.
+  std::vector<const ProfileCompilationInfo::DexFileData*> dex_data_list;
+  std::vector<std::string> keys;
+  for (const ProfileCompilationInfo::DexFileData* dex_data : info.info_) {
+    std::string key = ProfileCompilationInfo::GetBaseKeyFromAugmentedKey(dex_data->profile_key);
+    if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+      keys.push_back(std::move(key));
+      dex_data_list.push_back(dex_data);
+    }
+  }
+
+  std::vector<DexFileEntry> entries(dex_data_list.size());
+  const size_t data_offset = sizeof(Header) + entries.size() * sizeof(DexFileEntry);
+  std::vector<uint8_t> data;
+  for (size_t i = 0; i != dex_data_list.size(); ++i) {
+    const ProfileCompilationInfo::DexFileData& dex_data = *dex_data_list[i];
+    const uint32_t num_method_ids = dex_data.num_method_ids;
+    DexFileEntry& entry = entries[i];
+    entry.checksum = dex_data.checksum;
+    entry.num_method_ids = num_method_ids;
+
+    entry.key_offset = data_offset + data.size();
+    entry.key_size = keys[i].size();
+    AddStringToBuffer(&data, keys[i]);
+    data.resize(RoundUp(data.size(), sizeof(uint32_t)), 0u);
+
+    // The hot methods are the keys of the method map, the other flags are in the same order as
+    // in the bitmap of the profile, which starts with kFlagStartup.
+    entry.bitmap_offset = data_offset + data.size();
+    const size_t bitmap_start = data.size();
+    data.resize(bitmap_start + GetBitmapSize(num_method_flags, num_method_ids), 0u);
+    auto set_bit = [&](size_t bit) {
+      data[bitmap_start + bit / kBitsPerByte] |= 1u << (bit % kBitsPerByte);
+    };
+    for (const auto& method_it : dex_data.method_map) {
+      set_bit(method_it.first);
+    }
+    for (size_t bit = 0; bit != (num_method_flags - 1u) * num_method_ids; ++bit) {
+      if (dex_data.method_bitmap.LoadBit(bit)) {
+        set_bit(num_method_ids + bit);
+      }
+    }
+    data.resize(RoundUp(data.size(), sizeof(uint32_t)), 0u);
+
+    // The class set is ordered by type index.
+    entry.classes_offset = data_offset + data.size();
+    entry.num_classes = dex_data.class_set.size();
+    for (const dex::TypeIndex& type_index : dex_data.class_set) {
+      uint16_t index = type_index.index_;
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&index);
+      data.insert(data.end(), bytes, bytes + sizeof(index));
+    }
+    data.resize(RoundUp(data.size(), sizeof(uint32_t)), 0u);
+  }
+  if (data_offset + data.size() > std::numeric_limits<uint32_t>::max()) {
+    LOG(ERROR) << "Indexed profile is too large: " << data_offset + data.size() << " bytes";
+    return false;
+  }
+
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  memcpy(header.version, kVersion, sizeof(kVersion));
+  header.num_dex_files = entries.size();
+  header.num_method_flags = num_method_flags;
+  return WriteBuffer(fd, reinterpret_cast<const uint8_t*>(&header), sizeof(header)) &&
+      WriteBuffer(fd,
+                  reinterpret_cast<const uint8_t*>(entries.data()),
+                  entries.size() * sizeof(DexFileEntry)) &&
+      WriteBuffer(fd, data.data(), data.size());
+}
+
+std::unique_ptr<IndexedProfile> IndexedProfile::Open(int fd,
+                                                     const std::string& location,
+                                                     /*out*/std::string* error_msg) {
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    *error_msg = StringPrintf("Failed to stat %s: %s", location.c_str(), strerror(errno));
+    return nullptr;
+  }
+  if (static_cast<uint64_t>(st.st_size) < sizeof(Header)) {
+    *error_msg = StringPrintf("Indexed profile %s is too small: %" PRId64 " bytes",
+                              location.c_str(),
+                              static_cast<int64_t>(st.st_size));
+    return nullptr;
+  }
+  MemMap map = MemMap::MapFile(static_cast<size_t>(st.st_size),
+                               PROT_READ,
+                               MAP_PRIVATE,
+                               fd,
+                               /*start=*/ 0,
+                               /*low_4gb=*/ false,
+                               location.c_str(),
+                               error_msg);
+  if (!map.IsValid()) {
+    return nullptr;
+  }
+  std::unique_ptr<IndexedProfile> profile(new IndexedProfile(std::move(map)));
+  if (!profile->IsValid(error_msg)) {
+    *error_msg = "Invalid indexed profile " + location + ": " + *error_msg;
+    return nullptr;
+  }
+  return profile;
+}
+
+bool IndexedProfile::IsValid(/*out*/std::string* error_msg) const {
+  const Header* header = GetHeader();
+  if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+    *error_msg = "Bad magic";
+    return false;
+  }
+  if (memcmp(header->version, kVersion, sizeof(kVersion)) != 0) {
+    *error_msg = "Unsupported version";
+    return false;
+  }
+  if (header->num_method_flags == 0u || header->num_method_flags > kMaxMethodFlags) {
+    *error_msg = StringPrintf("Bad number of method flags %u", header->num_method_flags);
+    return false;
+  }
+  const uint64_t size = map_.Size();
+  if (sizeof(Header) + static_cast<uint64_t>(header->num_dex_files) * sizeof(DexFileEntry) >
+          size) {
+    *error_msg = StringPrintf("Truncated dex file entries, %u dex files", header->num_dex_files);
+    return false;
+  }
+  const DexFileEntry* entries = GetDexFileEntries();
+  for (uint32_t i = 0; i != header->num_dex_files; ++i) {
+    const DexFileEntry& entry = entries[i];
+    uint64_t bitmap_size = GetBitmapSize(header->num_method_flags, entry.num_method_ids);
+    if (static_cast<uint64_t>(entry.key_offset) + entry.key_size > size ||
+        static_cast<uint64_t>(entry.bitmap_offset) + bitmap_size > size ||
+        !IsAligned<alignof(uint16_t)>(entry.classes_offset) ||
+        static_cast<uint64_t>(entry.classes_offset) + entry.num_classes * sizeof(uint16_t) >
+            size) {
+      *error_msg = StringPrintf("Truncated data of dex file %u", i);
+      return false;
+    }
+  }
+  return true;
+}
+
+const IndexedProfile::DexFileEntry* IndexedProfile::FindDexFileEntry(
+    const DexFile& dex_file) const {
+  // Same as ProfileCompilationInfo::GetProfileDexFileBaseKey(), without allocating.
+  std::string_view base_key = dex_file.GetLocation();
+  size_t last_sep_index = base_key.find_last_of('/');
+  if (last_sep_index != std::string_view::npos) {
+    base_key.remove_prefix(last_sep_index + 1u);
+  }
+  const DexFileEntry* entries = GetDexFileEntries();
+  for (uint32_t i = 0, num_dex_files = GetHeader()->num_dex_files; i != num_dex_files; ++i) {
+    const DexFileEntry& entry = entries[i];
+    std::string_view key(reinterpret_cast<const char*>(map_.Begin() + entry.key_offset),
+                         entry.key_size);
+    if (key == base_key) {
+      return entry.checksum == dex_file.GetLocationChecksum() ? &entry : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+ProfileCompilationInfo::MethodHotness IndexedProfile::GetMethodHotness(
+    const MethodReference& method_ref) const {
+  Hotness hotness;
+  const DexFileEntry* entry = FindDexFileEntry(*method_ref.dex_file);
+  if (entry == nullptr || method_ref.index >= entry->num_method_ids) {
+    return hotness;
+  }
+  const uint8_t* bitmap = map_.Begin() + entry->bitmap_offset;
+  for (uint32_t i = 0, num_method_flags = GetHeader()->num_method_flags;
+       i != num_method_flags;
+       ++i) {
+    size_t bit = static_cast<size_t>(i) * entry->num_method_ids + method_ref.index;
+    if ((bitmap[bit / kBitsPerByte] & (1u << (bit % kBitsPerByte))) != 0u) {
+      hotness.AddFlag(static_cast<Hotness::Flag>(1u << i));
+    }
+  }
+  return hotness;
+}
+
+bool IndexedProfile::ContainsClass(const DexFile& dex_file, dex::TypeIndex type_idx) const {
+  const DexFileEntry* entry = FindDexFileEntry(dex_file);
+  if (entry == nullptr) {
+    return false;
+  }
+  const uint16_t* classes =
+      reinterpret_cast<const uint16_t*>(map_.Begin() + entry->classes_offset);
+  return std::binary_search(classes, classes + entry->num_classes, type_idx.index_);
+}
+
+}  // namespace art
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_LIBPROFILE_PROFILE_INDEXED_PROFILE_H_
+#define ART_LIBPROFILE_PROFILE_INDEXED_PROFILE_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/mem_map.h"
+#include "dex/dex_file_types.h"
+#include "dex/method_reference.h"
+#include "profile/profile_compilation_info.h"
+
+namespace art {
+
+class DexFile;
+
+/**
+ * Read-only view of the methods and classes of a profile, in an uncompressed format which is
+ * mapped from the file and queried in place. Looking up a method tests bits of a bitmap and
+ * looking up a class is a binary search, so opening the profile does not inflate or parse it.
+ *
+ * The format only keeps what is needed to answer membership queries: the method hotness flags
+ * and the classes of each dex file. Inline caches are only in the regular profile written by
+ * ProfileCompilationInfo::Save, which remains the primary format.
+ *
+ * The file is written and read on the same device, so the data is in native byte order.
+ *
+ * TODO: Like ProfileBootInfo, this is separate from ProfileCompilationInfo so that we can
+ * experiment with it before deciding whether to make it a ProfileCompilationInfo version.
+ */
+class IndexedProfile {
+ public:
+  static const uint8_t kMagic[];
+  static const uint8_t kVersion[];
+
+  // Writes the methods and classes of `info` to `fd`. For each dex location only the first dex
+  // file data is written, which is the one ProfileCompilationInfo looks up without annotation.
+  static bool Save(const ProfileCompilationInfo& info, int fd);
+
+  // Maps the indexed profile in `fd`. Returns null and sets `error_msg` if the file is not a
+  // valid indexed profile.
+  static std::unique_ptr<IndexedProfile> Open(int fd,
+                                              const std::string& location,
+                                              /*out*/std::string* error_msg);
+
+  // Returns the hotness flags of the method. The hotness has no inline caches.
+  ProfileCompilationInfo::MethodHotness GetMethodHotness(const MethodReference& method_ref) const;
+
+  // Returns true if the class is in the profile.
+  bool ContainsClass(const DexFile& dex_file, dex::TypeIndex type_idx) const;
+
+  uint32_t GetNumberOfDexFiles() const {
+    return GetHeader()->num_dex_files;
+  }
+
+ private:
+  struct Header {
+    uint8_t magic[4];
+    uint8_t version[4];
+    uint32_t num_dex_files;
+    // The number of method flags in the bitmaps, including kFlagHot.
+    uint32_t num_method_flags;
+  };
+
+  struct DexFileEntry {
+    uint32_t checksum;
+    uint32_t num_method_ids;
+    // The base profile key of the dex file.
+    uint32_t key_offset;
+    uint32_t key_size;
+    // The bitmap of each flag, in flag order. The bit of a method for the flag `1 << i` is
+    // `i * num_method_ids + method_index`.
+    uint32_t bitmap_offset;
+    // The profiled type indexes, sorted, as uint16_t.
+    uint32_t classes_offset;
+    uint32_t num_classes;
+  };
+
+  explicit IndexedProfile(MemMap&& map) : map_(std::move(map)) {}
+
+  bool IsValid(/*out*/std::string* error_msg) const;
+
+  const Header* GetHeader() const {
+    return reinterpret_cast<const Header*>(map_.Begin());
+  }
+
+  const DexFileEntry* GetDexFileEntries() const {
+    return reinterpret_cast<const DexFileEntry*>(map_.Begin() + sizeof(Header));
+  }
+
+  // Returns the entry of `dex_file`, or null if it is not in the profile or its checksum does
+  // not match.
+  const DexFileEntry* FindDexFileEntry(const DexFile& dex_file) const;
+
+  static size_t GetBitmapSize(uint32_t num_method_flags, uint32_t num_method_ids);
+
+  MemMap map_;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexedProfile);
+};
+
+}  // namespace art
+
+#endif  // ART_LIBPROFILE_PROFILE_INDEXED_PROFILE_H_
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "base/common_art_test.h"
+#include "dex/dex_file.h"
+#include "dex/method_reference.h"
+#include "profile/indexed_profile.h"
+#include "profile/profile_compilation_info.h"
+
+namespace art {
+
+using Hotness = ProfileCompilationInfo::MethodHotness;
+
+class IndexedProfileTest : public CommonArtTest {
+ public:
+  void SetUp() override {
+    CommonArtTest::SetUp();
+    dex1 = fake_dex_storage.AddFakeDex("location1", /* checksum= */ 1, /* num_method_ids= */ 101);
+    dex2 = fake_dex_storage.AddFakeDex("location2", /* checksum= */ 2, /* num_method_ids= */ 102);
+    dex3 = fake_dex_storage.AddFakeDex("location3", /* checksum= */ 3, /* num_method_ids= */ 103);
+    dex1_checksum_missmatch = fake_dex_storage.AddFakeDex(
+        "location1", /* checksum= */ 12, /* num_method_ids= */ 101);
+  }
+
+ protected:
+  void AddMethod(ProfileCompilationInfo* info,
+                 const DexFile* dex,
+                 uint16_t method_idx,
+                 Hotness::Flag flags) {
+    ASSERT_TRUE(info->AddMethod(ProfileMethodInfo(MethodReference(dex, method_idx)), flags));
+  }
+
+  void AddClass(ProfileCompilationInfo* info, const DexFile* dex, dex::TypeIndex type_index) {
+    std::vector<dex::TypeIndex> classes = {type_index};
+    ASSERT_TRUE(info->AddClassesForDex(dex, classes.begin(), classes.end()));
+  }
+
+  std::unique_ptr<IndexedProfile> SaveAndOpen(const ProfileCompilationInfo& info) {
+    ScratchFile file;
+    EXPECT_TRUE(IndexedProfile::Save(info, file.GetFd()));
+    std::string error_msg;
+    std::unique_ptr<IndexedProfile> profile =
+        IndexedProfile::Open(file.GetFd(), file.GetFilename(), &error_msg);
+    EXPECT_TRUE(profile != nullptr) << error_msg;
+    return profile;
+  }
+
+  void ExpectSameMethods(const ProfileCompilationInfo& info,
+                         const IndexedProfile& profile,
+                         const DexFile* dex) {
+    for (uint32_t i = 0; i != dex->NumMethodIds(); ++i) {
+      MethodReference ref(dex, i);
+      EXPECT_EQ(info.GetMethodHotness(ref).GetFlags(), profile.GetMethodHotness(ref).GetFlags())
+          << i;
+    }
+  }
+
+  FakeDexStorage fake_dex_storage;
+  const DexFile* dex1;
+  const DexFile* dex2;
+  const DexFile* dex3;
+  const DexFile* dex1_checksum_missmatch;
+};
+
+TEST_F(IndexedProfileTest, Methods) {
+  ProfileCompilationInfo info;
+  AddMethod(&info, dex1, 1, Hotness::kFlagHot);
+  AddMethod(&info, dex1, 2, Hotness::kFlagStartup);
+  AddMethod(&info, dex1, 3, Hotness::kFlagPostStartup);
+  AddMethod(&info, dex1, 100, static_cast<Hotness::Flag>(Hotness::kFlagHot |
+                                                         Hotness::kFlagStartup |
+                                                         Hotness::kFlagPostStartup));
+  AddMethod(&info, dex2, 0, Hotness::kFlagStartup);
+
+  std::unique_ptr<IndexedProfile> profile = SaveAndOpen(info);
+  ASSERT_TRUE(profile != nullptr);
+  EXPECT_EQ(profile->GetNumberOfDexFiles(), 2u);
+  ExpectSameMethods(info, *profile, dex1);
+  ExpectSameMethods(info, *profile, dex2);
+  EXPECT_TRUE(profile->GetMethodHotness(MethodReference(dex1, 1)).IsHot());
+  EXPECT_TRUE(profile->GetMethodHotness(MethodReference(dex1, 100)).IsPostStartup());
+  EXPECT_FALSE(profile->GetMethodHotness(MethodReference(dex3, 1)).IsInProfile());
+  EXPECT_FALSE(profile->GetMethodHotness(
+      MethodReference(dex1_checksum_missmatch, 1)).IsInProfile());
+}
+
+TEST_F(IndexedProfileTest, BootImageMethods) {
+  ProfileCompilationInfo info(/*for_boot_image=*/ true);
+  AddMethod(&info, dex1, 1, Hotness::kFlagBoot);
+  AddMethod(&info, dex1, 2, static_cast<Hotness::Flag>(Hotness::kFlagHot |
+                                                       Hotness::kFlagStartupMaxBin));
+  AddMethod(&info, dex3, 102, static_cast<Hotness::Flag>(Hotness::kFlag32bit |
+                                                         Hotness::kFlagSensitiveThread));
+
+  std::unique_ptr<IndexedProfile> profile = SaveAndOpen(info);
+  ASSERT_TRUE(profile != nullptr);
+  ExpectSameMethods(info, *profile, dex1);
+  ExpectSameMethods(info, *profile, dex3);
+  EXPECT_TRUE(profile->GetMethodHotness(MethodReference(dex1, 2))
+                  .HasFlagSet(Hotness::kFlagStartupMaxBin));
+}
+
+TEST_F(IndexedProfileTest, Classes) {
+  ProfileCompilationInfo info;
+  AddClass(&info, dex1, dex::TypeIndex(0));
+  AddClass(&info, dex1, dex::TypeIndex(7));
+  AddClass(&info, dex1, dex::TypeIndex(65000));
+  AddClass(&info, dex2, dex::TypeIndex(3));
+
+  std::unique_ptr<IndexedProfile> profile = SaveAndOpen(info);
+  ASSERT_TRUE(profile != nullptr);
+  for (uint16_t i : { 0, 7, 65000 }) {
+    EXPECT_TRUE(profile->ContainsClass(*dex1, dex::TypeIndex(i))) << i;
+  }
+  EXPECT_FALSE(profile->ContainsClass(*dex1, dex::TypeIndex(3)));
+  EXPECT_TRUE(profile->ContainsClass(*dex2, dex::TypeIndex(3)));
+  EXPECT_FALSE(profile->ContainsClass(*dex3, dex::TypeIndex(3)));
+  EXPECT_FALSE(profile->ContainsClass(*dex1_checksum_missmatch, dex::TypeIndex(0)));
+}
+
+TEST_F(IndexedProfileTest, RejectRegularProfile) {
+  ProfileCompilationInfo info;
+  AddMethod(&info, dex1, 1, Hotness::kFlagHot);
+  ScratchFile file;
+  ASSERT_TRUE(info.Save(file.GetFd()));
+  std::string error_msg;
+  EXPECT_TRUE(IndexedProfile::Open(file.GetFd(), file.GetFilename(), &error_msg) == nullptr);
+  EXPECT_FALSE(error_msg.empty());
+}
+
+}  // namespace art
@@ -956,6 +956,7 @@ class ProfileCompilationInfo {
   friend class CompilerDriverProfileTest;
   friend class ProfileAssistantTest;
   friend class Dex2oatLayoutTest;
+  friend class IndexedProfile;
 
   MallocArenaPool default_arena_pool_;
   ArenaAllocator allocator_;
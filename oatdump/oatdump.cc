@@ -23,6 +23,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -674,6 +675,7 @@ class OatDumper {
     {
       os << "OAT FILE STATS:\n";
       VariableIndentationOutputStream vios(&os);
+      AddCodeGapStats();
       stats_.AddBytes(oat_file_.Size());
       DumpStats(vios, "OatFile", stats_, stats_.Value());
     }
@@ -682,6 +684,39 @@ class OatDumper {
     return success;
   }
 
+  // Account for the bytes between the end of one method's code and the header of the next.
+  // These hold the linker's thunks (e.g. branch and Baker read barrier thunks on ARM) plus
+  // code alignment, which cannot be told apart without disassembling the callers.
+  void AddCodeGapStats() {
+    // With a filter we only see some of the methods and the gaps would be meaningless.
+    if (options_.class_filter_[0] != '\0' || options_.method_filter_[0] != '\0') {
+      return;
+    }
+    const size_t alignment = GetInstructionSetAlignment(instruction_set_);
+    uint64_t gap_bytes = 0u;
+    size_t thunk_islands = 0u;
+    for (auto it = code_ranges_.begin(), next = it; it != code_ranges_.end(); it = next) {
+      ++next;
+      if (next == code_ranges_.end()) {
+        break;
+      }
+      uint32_t code_end = it->first + it->second;
+      uint32_t next_header = next->first - sizeof(OatQuickMethodHeader);
+      if (next_header <= code_end) {
+        continue;
+      }
+      uint32_t gap = next_header - code_end;
+      gap_bytes += gap;
+      // Alignment padding alone is always shorter than one alignment unit.
+      if (gap >= alignment) {
+        ++thunk_islands;
+      }
+    }
+    if (gap_bytes != 0u) {
+      stats_.Child("ThunksAndCodeAlignment")->AddBytes(gap_bytes, thunk_islands);
+    }
+  }
+
   size_t ComputeSize(const void* oat_data) {
     if (reinterpret_cast<const uint8_t*>(oat_data) < oat_file_.Begin() ||
         reinterpret_cast<const uint8_t*>(oat_data) > oat_file_.End()) {
@@ -1269,6 +1304,7 @@ class OatDumper {
         uint64_t aligned_code_end = aligned_code_begin + code_size;
         if (AddStatsObject(code)) {
           stats_.Child("Code")->AddBytes(code_size);
+          code_ranges_.emplace(aligned_code_begin, code_size);
         }
 
         if (options_.absolute_addresses_) {
@@ -1777,6 +1813,8 @@ class OatDumper {
   uint32_t resolved_addr2instr_;
   const InstructionSet instruction_set_;
   std::set<uintptr_t> offsets_;
+  // Aligned code offset and size of each distinct compiled method, for AddCodeGapStats().
+  std::map<uint32_t, uint32_t> code_ranges_;
   Disassembler* disassembler_;
   Stats stats_;
   std::unordered_set<const void*> seen_stats_objects_;
@@ -2916,6 +2954,186 @@ static int DumpOat(Runtime* runtime,
   }
 }
 
+// Collects per-package code size statistics without disassembling anything or building the
+// offset tables the full dump needs, so that large boot images can be summarized quickly.
+// Each dex file is scanned independently, which lets the work be spread over several threads.
+class OatStatsDumper {
+ public:
+  OatStatsDumper(const OatFile& oat_file, bool json)
+      : oat_file_(oat_file), json_(json) {}
+
+  bool Dump(std::ostream& os) {
+    // Opening the dex files goes through the shared `opened_dex_files` map, so do it up front.
+    std::vector<std::pair<const OatDexFile*, const DexFile*>> dex_files;
+    for (const OatDexFile* oat_dex_file : oat_file_.GetOatDexFiles()) {
+      std::string error_msg;
+      const DexFile* const dex_file = OpenDexFile(oat_dex_file, &error_msg);
+      if (dex_file == nullptr) {
+        LOG(ERROR) << "Failed to open dex file '" << oat_dex_file->GetDexFileLocation()
+                   << "': " << error_msg;
+        return false;
+      }
+      dex_files.emplace_back(oat_dex_file, dex_file);
+    }
+
+    size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min(num_threads, std::max<size_t>(dex_files.size(), 1u));
+    std::vector<PackageStatsMap> thread_stats(num_threads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t != num_threads; ++t) {
+      threads.emplace_back([&dex_files, &thread_stats, num_threads, t]() {
+        for (size_t i = t; i < dex_files.size(); i += num_threads) {
+          CollectDexFileStats(*dex_files[i].first, *dex_files[i].second, &thread_stats[t]);
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    PackageStatsMap stats;
+    for (const PackageStatsMap& partial : thread_stats) {
+      for (const auto& entry : partial) {
+        stats[entry.first].Add(entry.second);
+      }
+    }
+    if (json_) {
+      DumpJson(os, stats);
+    } else {
+      DumpCsv(os, stats);
+    }
+    os << std::flush;
+    return true;
+  }
+
+ private:
+  struct PackageStats {
+    size_t classes = 0u;
+    size_t compiled_methods = 0u;
+    size_t code_bytes = 0u;
+    size_t stack_map_bytes = 0u;
+    size_t vmap_bytes = 0u;
+
+    void Add(const PackageStats& other) {
+      classes += other.classes;
+      compiled_methods += other.compiled_methods;
+      code_bytes += other.code_bytes;
+      stack_map_bytes += other.stack_map_bytes;
+      vmap_bytes += other.vmap_bytes;
+    }
+  };
+
+  using PackageStatsMap = std::map<std::string, PackageStats>;
+
+  // Returns the dotted package name of a class descriptor such as "Ljava/lang/Object;".
+  static std::string GetPackageName(const char* descriptor) {
+    std::string dot = DescriptorToDot(descriptor);
+    size_t last_dot = dot.rfind('.');
+    return (last_dot == std::string::npos) ? "<default>" : dot.substr(0, last_dot);
+  }
+
+  // Shared (deduplicated) code and CodeInfo is only counted once per dex file, which keeps the
+  // result independent of how the dex files were distributed over threads.
+  static void CollectDexFileStats(const OatDexFile& oat_dex_file,
+                                  const DexFile& dex_file,
+                                  /*out*/ PackageStatsMap* stats) {
+    std::unordered_set<const void*> seen_code;
+    std::unordered_set<const uint8_t*> seen_code_info;
+    for (ClassAccessor accessor : dex_file.GetClasses()) {
+      PackageStats& package_stats = (*stats)[GetPackageName(accessor.GetDescriptor())];
+      ++package_stats.classes;
+      const OatFile::OatClass oat_class = oat_dex_file.GetOatClass(accessor.GetClassDefIndex());
+      for (uint32_t class_method_index = 0;
+           class_method_index < accessor.NumMethods();
+           ++class_method_index) {
+        const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_method_index);
+        const OatQuickMethodHeader* method_header = oat_method.GetOatQuickMethodHeader();
+        if (method_header == nullptr) {
+          continue;
+        }
+        ++package_stats.compiled_methods;
+        if (seen_code.insert(oat_method.GetQuickCode()).second) {
+          package_stats.code_bytes += oat_method.GetQuickCodeSize();
+        }
+        const uint8_t* code_info_data = oat_method.GetVmapTable();
+        if (method_header->IsOptimized() &&
+            code_info_data != nullptr &&
+            seen_code_info.insert(code_info_data).second) {
+          size_t num_bits;
+          CodeInfo code_info(code_info_data, &num_bits);
+          package_stats.vmap_bytes += BitsToBytesRoundUp(num_bits);
+          package_stats.stack_map_bytes +=
+              BitsToBytesRoundUp(code_info.GetStackMaps().DataBitSize());
+        }
+      }
+    }
+  }
+
+  static void DumpCsv(std::ostream& os, const PackageStatsMap& stats) {
+    os << "package,classes,compiled_methods,code_bytes,stack_map_bytes,vmap_bytes\n";
+    for (const auto& entry : stats) {
+      const PackageStats& s = entry.second;
+      os << entry.first << ',' << s.classes << ',' << s.compiled_methods << ',' << s.code_bytes
+         << ',' << s.stack_map_bytes << ',' << s.vmap_bytes << '\n';
+    }
+  }
+
+  void DumpJson(std::ostream& os, const PackageStatsMap& stats) const {
+    PackageStats total;
+    os << "{\n  \"location\": \"" << oat_file_.GetLocation() << "\",\n  \"packages\": [";
+    const char* separator = "\n";
+    for (const auto& entry : stats) {
+      const PackageStats& s = entry.second;
+      total.Add(s);
+      os << separator;
+      separator = ",\n";
+      DumpJsonEntry(os, entry.first, s);
+    }
+    os << "\n  ],\n  \"total\":\n";
+    DumpJsonEntry(os, "*", total);
+    os << "\n}\n";
+  }
+
+  static void DumpJsonEntry(std::ostream& os, const std::string& name, const PackageStats& s) {
+    os << StringPrintf("    {\"package\": \"%s\", \"classes\": %zu, \"compiled_methods\": %zu, "
+                       "\"code_bytes\": %zu, \"stack_map_bytes\": %zu, \"vmap_bytes\": %zu}",
+                       name.c_str(),
+                       s.classes,
+                       s.compiled_methods,
+                       s.code_bytes,
+                       s.stack_map_bytes,
+                       s.vmap_bytes);
+  }
+
+  const OatFile& oat_file_;
+  const bool json_;
+};
+
+static int DumpOatStats(const char* oat_filename,
+                        const char* dex_filename,
+                        bool json,
+                        std::ostream* os) {
+  std::string dex_filename_str((dex_filename != nullptr) ? dex_filename : "");
+  ArrayRef<const std::string> dex_filenames(&dex_filename_str,
+                                            /*size=*/ (dex_filename != nullptr) ? 1u : 0u);
+  std::string error_msg;
+  std::unique_ptr<OatFile> oat_file(OatFile::Open(/*zip_fd=*/ -1,
+                                                  oat_filename,
+                                                  oat_filename,
+                                                  /*executable=*/ false,
+                                                  /*low_4gb=*/ false,
+                                                  dex_filenames,
+                                                  /*reservation=*/ nullptr,
+                                                  &error_msg));
+  if (oat_file == nullptr) {
+    LOG(ERROR) << "Failed to open oat file from '" << oat_filename << "': " << error_msg;
+    return EXIT_FAILURE;
+  }
+
+  OatStatsDumper stats_dumper(*oat_file, json);
+  return stats_dumper.Dump(*os) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 static int SymbolizeOat(const char* oat_filename,
                         const char* dex_filename,
                         std::string& output_name,
@@ -3459,6 +3677,17 @@ struct OatdumpArgs : public CmdlineArgs {
       imt_dump_ = std::string(option.substr(strlen("--dump-imt=")));
     } else if (option == "--dump-imt-stats") {
       imt_stat_dump_ = true;
+    } else if (StartsWith(option, "--stats-only")) {
+      std::string_view format = option.substr(strlen("--stats-only"));
+      if (format.empty() || format == "=csv") {
+        stats_only_json_ = false;
+      } else if (format == "=json") {
+        stats_only_json_ = true;
+      } else {
+        *error_msg = "--stats-only format must be csv or json";
+        return kParseError;
+      }
+      stats_only_ = true;
     } else {
       return kParseUnknownArgument;
     }
@@ -3485,6 +3714,9 @@ struct OatdumpArgs : public CmdlineArgs {
     } else if (image_location_ != nullptr && oat_filename_ != nullptr) {
       *error_msg = "Either --image or --oat-file must be specified but not both";
       return kParseError;
+    } else if (stats_only_ && oat_filename_ == nullptr) {
+      *error_msg = "--stats-only requires --oat-file";
+      return kParseError;
     }
 
     return kParseOk;
@@ -3564,7 +3796,11 @@ struct OatdumpArgs : public CmdlineArgs {
         "      Example: --dump-imt=imt.txt\n"
         "\n"
         "  --dump-imt-stats: output IMT statistics for the given boot image\n"
-        "      Example: --dump-imt-stats"
+        "      Example: --dump-imt-stats\n"
+        "\n"
+        "  --stats-only[=csv|json]: output per-package code, stack map and vmap sizes of\n"
+        "                           the given oat file without dumping or disassembling it.\n"
+        "      Example: --oat-file=/system/framework/arm64/boot.oat --stats-only=json"
         "\n";
 
     return usage;
@@ -3587,6 +3823,8 @@ struct OatdumpArgs : public CmdlineArgs {
   bool list_methods_ = false;
   bool dump_header_only_ = false;
   bool imt_stat_dump_ = false;
+  bool stats_only_ = false;
+  bool stats_only_json_ = false;
   uint32_t addr2instr_ = 0;
   const char* export_dex_location_ = nullptr;
   const char* app_image_ = nullptr;
@@ -3618,7 +3856,8 @@ struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
     return (args_->boot_image_location_ != nullptr ||
             args_->image_location_ != nullptr ||
             !args_->imt_dump_.empty()) &&
-          !args_->symbolize_;
+          !args_->symbolize_ &&
+          !args_->stats_only_;
   }
 
   bool ExecuteWithoutRuntime() override {
@@ -3635,6 +3874,11 @@ struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
       bool no_bits = args_->only_keep_debug_;
       return SymbolizeOat(args_->oat_filename_, args_->dex_filename_, args_->output_name_, no_bits)
           == EXIT_SUCCESS;
+    } else if (args_->stats_only_) {
+      return DumpOatStats(args_->oat_filename_,
+                          args_->dex_filename_,
+                          args_->stats_only_json_,
+                          args_->os_) == EXIT_SUCCESS;
     } else {
       return DumpOat(nullptr,
                      args_->oat_filename_,
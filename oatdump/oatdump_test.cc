@@ -85,6 +85,18 @@ TEST_F(OatDumpTest, TestSymbolizeStatic) {
   ASSERT_TRUE(Exec(kStatic, kModeSymbolize, {}, kListOnly));
 }
 
+TEST_F(OatDumpTest, TestStatsOnly) {
+  TEST_DISABLED_FOR_ARM_AND_ARM64();
+  std::string error_msg;
+  ASSERT_TRUE(Exec(kDynamic, kModeCoreOatStats, {"--stats-only=csv"}, kListOnly));
+}
+TEST_F(OatDumpTest, TestStatsOnlyStatic) {
+  TEST_DISABLED_FOR_ARM_AND_ARM64();
+  TEST_DISABLED_FOR_NON_STATIC_HOST_BUILDS();
+  std::string error_msg;
+  ASSERT_TRUE(Exec(kStatic, kModeCoreOatStats, {"--stats-only=csv"}, kListOnly));
+}
+
 TEST_F(OatDumpTest, TestExportDex) {
   TEST_DISABLED_FOR_ARM_AND_ARM64();
   // Test is failing on target, b/77469384.
@@ -96,6 +96,7 @@ class OatDumpTest : public CommonRuntimeTest {
     kModeAppImage,
     kModeArt,
     kModeSymbolize,
+    kModeCoreOatStats,
   };
 
   // Display style.
@@ -183,6 +184,10 @@ class OatDumpTest : public CommonRuntimeTest {
     if (mode == kModeSymbolize) {
       exec_argv.push_back("--symbolize=" + core_oat_location_);
       exec_argv.push_back("--output=" + core_oat_location_ + ".symbolize");
+    } else if (mode == kModeCoreOatStats) {
+      exec_argv.push_back("--oat-file=" + core_oat_location_);
+      expected_prefixes.push_back("package,classes,compiled_methods,");
+      expected_prefixes.push_back("java.lang,");
     } else {
       expected_prefixes.push_back("LOCATION:");
       expected_prefixes.push_back("MAGIC:");
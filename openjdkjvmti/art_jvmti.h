@@ -32,6 +32,7 @@
 #ifndef ART_OPENJDKJVMTI_ART_JVMTI_H_
 #define ART_OPENJDKJVMTI_ART_JVMTI_H_
 
+#include <atomic>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
@@ -99,6 +100,13 @@ struct ArtJvmTiEnv : public jvmtiEnv {
   std::unordered_set<Breakpoint> breakpoints GUARDED_BY(event_info_mutex_);
   std::unordered_set<const art::ShadowFrame*> notify_frames GUARDED_BY(event_info_mutex_);
 
+  // Methods the MethodEntry and MethodExit events of this env are reported for, or empty if they
+  // are reported for all methods. Set with the com.android.art.method.set_method_entry_exit_filter
+  // extension while neither event is enabled. The flag mirrors !method_entry_exit_filter.empty()
+  // so that other envs can check it without taking event_info_mutex_.
+  std::unordered_set<art::ArtMethod*> method_entry_exit_filter GUARDED_BY(event_info_mutex_);
+  std::atomic<bool> has_method_entry_exit_filter{false};
+
   // RW lock to protect access to all of the event data.
   art::ReaderWriterMutex event_info_mutex_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
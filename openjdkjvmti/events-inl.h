@@ -427,6 +427,41 @@ inline bool EventHandler::ShouldDispatch<ArtJvmtiEvent::kFieldAccess>(
           art::jni::DecodeArtField(field)) != env->access_watched_fields.end();
 }
 
+// Need to give custom specializations for MethodEntry and MethodExit since envs can restrict them
+// to particular methods with the com.android.art.method.set_method_entry_exit_filter extension.
+inline bool IsMethodInEntryExitFilter(ArtJvmTiEnv* env, jmethodID jmethod) {
+  if (!env->has_method_entry_exit_filter.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  art::ReaderMutexLock lk(art::Thread::Current(), env->event_info_mutex_);
+  return env->method_entry_exit_filter.find(art::jni::DecodeArtMethod(jmethod)) !=
+      env->method_entry_exit_filter.end();
+}
+
+template <>
+inline bool EventHandler::ShouldDispatch<ArtJvmtiEvent::kMethodEntry>(
+    ArtJvmTiEnv* env,
+    art::Thread* thread,
+    JNIEnv* jnienv ATTRIBUTE_UNUSED,
+    jthread jni_thread ATTRIBUTE_UNUSED,
+    jmethodID jmethod) const {
+  return ShouldDispatchOnThread<ArtJvmtiEvent::kMethodEntry>(env, thread) &&
+      IsMethodInEntryExitFilter(env, jmethod);
+}
+
+template <>
+inline bool EventHandler::ShouldDispatch<ArtJvmtiEvent::kMethodExit>(
+    ArtJvmTiEnv* env,
+    art::Thread* thread,
+    JNIEnv* jnienv ATTRIBUTE_UNUSED,
+    jthread jni_thread ATTRIBUTE_UNUSED,
+    jmethodID jmethod,
+    jboolean was_popped_by_exception ATTRIBUTE_UNUSED,
+    jvalue val ATTRIBUTE_UNUSED) const {
+  return ShouldDispatchOnThread<ArtJvmtiEvent::kMethodExit>(env, thread) &&
+      IsMethodInEntryExitFilter(env, jmethod);
+}
+
 // Need to give custom specializations for FramePop since it needs to filter out which particular
 // agents get the event. This specialization gets an extra argument so we can determine which (if
 // any) environments have the frame pop.
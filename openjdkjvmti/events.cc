@@ -1184,6 +1184,17 @@ static DeoptRequirement GetDeoptRequirement(ArtJvmtiEvent event, jthread thread)
   }
 }
 
+static bool IsMethodEntryExitEvent(ArtJvmtiEvent event) {
+  return event == ArtJvmtiEvent::kMethodEntry || event == ArtJvmtiEvent::kMethodExit;
+}
+
+// Whether the global 'event' of 'env' only needs the methods in its filter to be deoptimized,
+// rather than all methods, as these are the only methods it's reported for.
+static bool HasDeoptFilter(ArtJvmTiEnv* env, ArtJvmtiEvent event) {
+  return IsMethodEntryExitEvent(event) &&
+      env->has_method_entry_exit_filter.load(std::memory_order_relaxed);
+}
+
 jvmtiError EventHandler::HandleEventDeopt(ArtJvmtiEvent event, jthread thread, bool enable) {
   DeoptRequirement deopt_req = GetDeoptRequirement(event, thread);
   // Make sure we can deopt.
@@ -1227,6 +1238,25 @@ jvmtiError EventHandler::HandleEventDeopt(ArtJvmtiEvent event, jthread thread, b
   return OK;
 }
 
+void EventHandler::HandleFilteredEventDeopt(const std::vector<art::ArtMethod*>& methods,
+                                           bool enable) {
+  // Only the filtered methods are deoptimized, like methods with breakpoints, so only they report
+  // MethodEntry and MethodExit events. Other methods keep running compiled code.
+  art::ScopedObjectAccess soa(art::Thread::Current());
+  DeoptManager* deopt_manager = DeoptManager::Get();
+  if (enable) {
+    deopt_manager->AddDeoptimizationRequester();
+    for (art::ArtMethod* method : methods) {
+      deopt_manager->AddMethodBreakpoint(method);
+    }
+  } else {
+    for (art::ArtMethod* method : methods) {
+      deopt_manager->RemoveMethodBreakpoint(method);
+    }
+    deopt_manager->RemoveDeoptimizationRequester();
+  }
+}
+
 void EventHandler::SetupTraceListener(JvmtiMethodTraceListener* listener,
                                       ArtJvmtiEvent event,
                                       bool enable) {
@@ -1541,6 +1571,11 @@ jvmtiError EventHandler::SetEvent(ArtJvmTiEnv* env,
   // actions depending on if the event is limited to a single thread or global.
   bool old_thread_state;
   bool new_thread_state;
+  // The methods to deoptimize if this enables or disables the global 'event' of an env with a
+  // method filter. Such envs do not count for the global deoptimization state.
+  std::vector<art::ArtMethod*> filtered_methods;
+  bool old_filtered_state = false;
+  bool new_filtered_state = false;
   {
     // From now on we know we cannot get suspended by user-code.
     // NB This does a SuspendCheck (during thread state change) so we need to
@@ -1563,12 +1598,18 @@ jvmtiError EventHandler::SetEvent(ArtJvmTiEnv* env,
     art::WriterMutexLock ei_mu(self, env->event_info_mutex_);
     old_thread_state = GetThreadEventState(event, target);
     old_state = global_mask.Test(event);
+    bool is_filtered = target == nullptr && HasDeoptFilter(env, event);
+    if (is_filtered) {
+      old_filtered_state = env->event_masks.global_event_mask.Test(event);
+      filtered_methods.assign(env->method_entry_exit_filter.begin(),
+                              env->method_entry_exit_filter.end());
+    }
     if (mode == JVMTI_ENABLE) {
       env->event_masks.EnableEvent(env, target, event);
       global_mask.Set(event);
       new_state = true;
-      new_thread_state = true;
-      DCHECK(GetThreadEventState(event, target));
+      new_thread_state = !is_filtered || old_thread_state;
+      DCHECK_EQ(new_thread_state, GetThreadEventState(event, target));
     } else {
       DCHECK_EQ(mode, JVMTI_DISABLE);
 
@@ -1578,12 +1619,18 @@ jvmtiError EventHandler::SetEvent(ArtJvmTiEnv* env,
       new_thread_state = GetThreadEventState(event, target);
       DCHECK(new_state || !new_thread_state);
     }
+    if (is_filtered) {
+      new_filtered_state = env->event_masks.global_event_mask.Test(event);
+    }
   }
   // Handle any special work required for the event type. We still have the
   // user_code_suspend_count_lock_ so there won't be any interleaving here.
   if (new_state != old_state) {
     HandleEventType(event, mode == JVMTI_ENABLE);
   }
+  if (old_filtered_state != new_filtered_state) {
+    HandleFilteredEventDeopt(filtered_methods, new_filtered_state);
+  }
   if (old_thread_state != new_thread_state) {
     return HandleEventDeopt(event, thread, new_thread_state);
   }
@@ -1596,7 +1643,8 @@ bool EventHandler::GetThreadEventState(ArtJvmtiEvent event, art::Thread* thread)
       continue;
     }
     auto& masks = stored_env->event_masks;
-    if (thread == nullptr && masks.global_event_mask.Test(event)) {
+    if (thread == nullptr && masks.global_event_mask.Test(event) &&
+        !HasDeoptFilter(stored_env, event)) {
       return true;
     } else if (thread != nullptr) {
       EventMask* mask =  masks.GetEventMaskOrNull(thread);
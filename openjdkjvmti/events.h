@@ -393,6 +393,9 @@ class EventHandler {
   // Perform deopts required for enabling the event on the given thread. Null thread indicates
   // global event enabled.
   jvmtiError HandleEventDeopt(ArtJvmtiEvent event, jthread thread, bool enable);
+  // Perform deopts required for enabling the global MethodEntry or MethodExit event of an env
+  // with a method filter, which only need the filtered 'methods' to be deoptimized.
+  void HandleFilteredEventDeopt(const std::vector<art::ArtMethod*>& methods, bool enable);
   void HandleLocalAccessCapabilityAdded();
   void HandleBreakpointEventsChanged(bool enable);
 
@@ -63,6 +63,51 @@ void JvmtiWeakTable<T>::AssertLocked() {
   allow_disallow_lock_.AssertHeld(art::Thread::Current());
 }
 
+template <typename T>
+void JvmtiWeakTable<T>::InsertEntry(art::mirror::Object* obj, T tag) {
+  DCHECK(obj != nullptr);
+  DCHECK_LT(num_entries_, entries_.size());
+  const size_t mask = entries_.size() - 1u;
+  size_t index = GetStartIndex(obj);
+  while (!entries_[index].root.IsNull()) {
+    DCHECK(entries_[index].root.template Read<art::kWithoutReadBarrier>() != obj);
+    index = (index + 1u) & mask;
+  }
+  entries_[index].root = art::GcRoot<art::mirror::Object>(obj);
+  entries_[index].tag = tag;
+}
+
+template <typename T>
+void JvmtiWeakTable<T>::EraseEntry(size_t index) {
+  DCHECK_LT(index, entries_.size());
+  DCHECK(!entries_[index].root.IsNull());
+  const size_t mask = entries_.size() - 1u;
+  size_t hole = index;
+  for (size_t i = (index + 1u) & mask; !entries_[i].root.IsNull(); i = (i + 1u) & mask) {
+    // The entry can fill the hole if the hole is between its start index and its index.
+    size_t start = GetStartIndex(entries_[i].root.template Read<art::kWithoutReadBarrier>());
+    if (((i - start) & mask) >= ((i - hole) & mask)) {
+      entries_[hole] = entries_[i];
+      hole = i;
+    }
+  }
+  entries_[hole].root = art::GcRoot<art::mirror::Object>();
+  --num_entries_;
+}
+
+template <typename T>
+void JvmtiWeakTable<T>::Rehash(size_t capacity) {
+  DCHECK(art::IsPowerOfTwo(capacity) || capacity == 0u);
+  DCHECK_LT(num_entries_, std::max<size_t>(capacity, 1u));
+  std::vector<Entry, JvmtiAllocator<Entry>> old_entries(capacity);
+  old_entries.swap(entries_);
+  for (const Entry& entry : old_entries) {
+    if (!entry.root.IsNull()) {
+      InsertEntry(entry.root.template Read<art::kWithoutReadBarrier>(), entry.tag);
+    }
+  }
+}
+
 template <typename T>
 void JvmtiWeakTable<T>::UpdateTableWithReadBarrier() {
   update_since_last_sweep_ = true;
@@ -105,12 +150,12 @@ bool JvmtiWeakTable<T>::RemoveLocked(art::ObjPtr<art::mirror::Object> obj, T* ta
 
 template <typename T>
 bool JvmtiWeakTable<T>::RemoveLocked(art::Thread* self, art::ObjPtr<art::mirror::Object> obj, T* tag) {
-  auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
-  if (it != tagged_objects_.end()) {
+  size_t index = FindEntry(obj.Ptr());
+  if (index != entries_.size()) {
     if (tag != nullptr) {
-      *tag = it->second;
+      *tag = entries_[index].tag;
     }
-    tagged_objects_.erase(it);
+    EraseEntry(index);
     return true;
   }
 
@@ -150,9 +195,9 @@ bool JvmtiWeakTable<T>::SetLocked(art::ObjPtr<art::mirror::Object> obj, T new_ta
 
 template <typename T>
 bool JvmtiWeakTable<T>::SetLocked(art::Thread* self, art::ObjPtr<art::mirror::Object> obj, T new_tag) {
-  auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
-  if (it != tagged_objects_.end()) {
-    it->second = new_tag;
+  size_t index = FindEntry(obj.Ptr());
+  if (index != entries_.size()) {
+    entries_[index].tag = new_tag;
     return true;
   }
 
@@ -170,8 +215,11 @@ bool JvmtiWeakTable<T>::SetLocked(art::Thread* self, art::ObjPtr<art::mirror::Ob
   }
 
   // New element.
-  auto insert_it = tagged_objects_.emplace(art::GcRoot<art::mirror::Object>(obj), new_tag);
-  DCHECK(insert_it.second);
+  if (4u * (num_entries_ + 1u) > 3u * entries_.size()) {
+    Rehash(GetCapacityFor(num_entries_ + 1u));
+  }
+  InsertEntry(obj.Ptr(), new_tag);
+  ++num_entries_;
   return false;
 }
 
@@ -210,38 +258,34 @@ void JvmtiWeakTable<T>::SweepImpl(art::IsMarkedVisitor* visitor) {
 template <typename T>
 template <typename Updater, typename JvmtiWeakTable<T>::TableUpdateNullTarget kTargetNull>
 ALWAYS_INLINE inline void JvmtiWeakTable<T>::UpdateTableWith(Updater& updater) {
-  // We optimistically hope that elements will still be well-distributed when re-inserting them.
-  // So play with the map mechanics, and postpone rehashing. This avoids the need of a side
-  // vector and two passes.
-  float original_max_load_factor = tagged_objects_.max_load_factor();
-  tagged_objects_.max_load_factor(std::numeric_limits<float>::max());
-  // For checking that a max load-factor actually does what we expect.
-  size_t original_bucket_count = tagged_objects_.bucket_count();
-
-  for (auto it = tagged_objects_.begin(); it != tagged_objects_.end();) {
-    DCHECK(!it->first.IsNull());
-    art::mirror::Object* original_obj = it->first.template Read<art::kWithoutReadBarrier>();
-    art::mirror::Object* target_obj = updater(it->first, original_obj);
+  // Update the keys in place, then rebuild the table once if any object moved or was released.
+  // This does a single allocation, and none when nothing changed.
+  bool changed = false;
+  for (Entry& entry : entries_) {
+    if (entry.root.IsNull()) {
+      continue;
+    }
+    art::mirror::Object* original_obj = entry.root.template Read<art::kWithoutReadBarrier>();
+    art::mirror::Object* target_obj = updater(entry.root, original_obj);
     if (original_obj != target_obj) {
       if (kTargetNull == kIgnoreNull && target_obj == nullptr) {
         // Ignore null target, don't do anything.
-      } else {
-        T tag = it->second;
-        it = tagged_objects_.erase(it);
-        if (target_obj != nullptr) {
-          tagged_objects_.emplace(art::GcRoot<art::mirror::Object>(target_obj), tag);
-          DCHECK_EQ(original_bucket_count, tagged_objects_.bucket_count());
-        } else if (kTargetNull == kCallHandleNull) {
-          HandleNullSweep(tag);
+        continue;
+      }
+      if (target_obj == nullptr) {
+        if (kTargetNull == kCallHandleNull) {
+          HandleNullSweep(entry.tag);
         }
-        continue;  // Iterator was implicitly updated by erase.
+        --num_entries_;
       }
+      entry.root = art::GcRoot<art::mirror::Object>(target_obj);
+      changed = true;
     }
-    it++;
   }
 
-  tagged_objects_.max_load_factor(original_max_load_factor);
-  // TODO: consider rehash here.
+  if (changed) {
+    Rehash(GetCapacityFor(num_entries_));
+  }
 }
 
 template <typename T>
@@ -336,8 +380,8 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
   size_t initial_object_size;
   size_t initial_tag_size;
   if (tag_count == 0) {
-    initial_object_size = (object_result_ptr != nullptr) ? tagged_objects_.size() : 0;
-    initial_tag_size = (tag_result_ptr != nullptr) ? tagged_objects_.size() : 0;
+    initial_object_size = (object_result_ptr != nullptr) ? num_entries_ : 0;
+    initial_tag_size = (tag_result_ptr != nullptr) ? num_entries_ : 0;
   } else {
     initial_object_size = initial_tag_size = kDefaultSize;
   }
@@ -347,12 +391,15 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
   ReleasableContainer<T, JvmtiAllocator<T>> selected_tags(allocator, initial_tag_size);
 
   size_t count = 0;
-  for (auto& pair : tagged_objects_) {
+  for (const Entry& entry : entries_) {
+    if (entry.root.IsNull()) {
+      continue;
+    }
     bool select;
     if (tag_count > 0) {
       select = false;
       for (size_t i = 0; i != static_cast<size_t>(tag_count); ++i) {
-        if (tags[i] == pair.second) {
+        if (tags[i] == entry.tag) {
           select = true;
           break;
         }
@@ -362,14 +409,14 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
     }
 
     if (select) {
-      art::ObjPtr<art::mirror::Object> obj = pair.first.template Read<art::kWithReadBarrier>();
+      art::ObjPtr<art::mirror::Object> obj = entry.root.template Read<art::kWithReadBarrier>();
       if (obj != nullptr) {
         count++;
         if (object_result_ptr != nullptr) {
           selected_objects.Pushback(jni_env->AddLocalReference<jobject>(obj));
         }
         if (tag_result_ptr != nullptr) {
-          selected_tags.Pushback(pair.second);
+          selected_tags.Pushback(entry.tag);
         }
       }
     }
@@ -391,9 +438,9 @@ art::ObjPtr<art::mirror::Object> JvmtiWeakTable<T>::Find(T tag) {
   art::MutexLock mu(self, allow_disallow_lock_);
   Wait(self);
 
-  for (auto& pair : tagged_objects_) {
-    if (tag == pair.second) {
-      art::ObjPtr<art::mirror::Object> obj = pair.first.template Read<art::kWithReadBarrier>();
+  for (const Entry& entry : entries_) {
+    if (!entry.root.IsNull() && tag == entry.tag) {
+      art::ObjPtr<art::mirror::Object> obj = entry.root.template Read<art::kWithReadBarrier>();
       if (obj != nullptr) {
         return obj;
       }
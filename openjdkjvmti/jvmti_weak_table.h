@@ -32,8 +32,10 @@
 #ifndef ART_OPENJDKJVMTI_JVMTI_WEAK_TABLE_H_
 #define ART_OPENJDKJVMTI_JVMTI_WEAK_TABLE_H_
 
-#include <unordered_map>
+#include <algorithm>
+#include <vector>
 
+#include "base/bit_utils.h"
 #include "base/globals.h"
 #include "base/macros.h"
 #include "base/mutex.h"
@@ -55,6 +57,7 @@ class JvmtiWeakTable : public art::gc::SystemWeakHolder {
  public:
   JvmtiWeakTable()
       : art::gc::SystemWeakHolder(art::kTaggingLockLevel),
+        num_entries_(0u),
         update_since_last_sweep_(false) {
   }
 
@@ -144,9 +147,9 @@ class JvmtiWeakTable : public art::gc::SystemWeakHolder {
   bool GetTagLocked(art::Thread* self, art::ObjPtr<art::mirror::Object> obj, /* out */ T* result)
       REQUIRES_SHARED(art::Locks::mutator_lock_)
       REQUIRES(allow_disallow_lock_) {
-    auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
-    if (it != tagged_objects_.end()) {
-      *result = it->second;
+    size_t index = FindEntry(obj.Ptr());
+    if (index != entries_.size()) {
+      *result = entries_[index].tag;
       return true;
     }
 
@@ -195,29 +198,71 @@ class JvmtiWeakTable : public art::gc::SystemWeakHolder {
   template <typename Storage, class Allocator = JvmtiAllocator<T>>
   struct ReleasableContainer;
 
-  struct HashGcRoot {
-    size_t operator()(const art::GcRoot<art::mirror::Object>& r) const
-        REQUIRES_SHARED(art::Locks::mutator_lock_) {
-      return reinterpret_cast<uintptr_t>(r.Read<art::kWithoutReadBarrier>());
-    }
+  // An entry of the table, free if `root` is null.
+  struct Entry {
+    art::GcRoot<art::mirror::Object> root;
+    T tag;
   };
 
-  struct EqGcRoot {
-    bool operator()(const art::GcRoot<art::mirror::Object>& r1,
-                    const art::GcRoot<art::mirror::Object>& r2) const
-        REQUIRES_SHARED(art::Locks::mutator_lock_) {
-      return r1.Read<art::kWithoutReadBarrier>() == r2.Read<art::kWithoutReadBarrier>();
+  // The table is at most 3/4 full, and half full after growing or rebuilding it.
+  static size_t GetCapacityFor(size_t num_entries) {
+    static constexpr size_t kMinCapacity = 16u;
+    return num_entries == 0u
+        ? 0u
+        : art::RoundUpToPowerOfTwo(std::max(kMinCapacity, 2u * num_entries));
+  }
+
+  size_t GetStartIndex(art::mirror::Object* obj) const
+      REQUIRES_SHARED(art::Locks::mutator_lock_)
+      REQUIRES(allow_disallow_lock_) {
+    // Mix the address, objects are aligned and usually allocated close to each other.
+    uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(obj)) *
+                    UINT64_C(0x9e3779b97f4a7c15);
+    return static_cast<size_t>(hash >> 32) & (entries_.size() - 1u);
+  }
+
+  // Returns the index of the entry of `obj` in entries_, or entries_.size() if there is none.
+  size_t FindEntry(art::mirror::Object* obj) const
+      REQUIRES_SHARED(art::Locks::mutator_lock_)
+      REQUIRES(allow_disallow_lock_) {
+    if (entries_.empty()) {
+      return 0u;
     }
-  };
+    const size_t mask = entries_.size() - 1u;
+    for (size_t index = GetStartIndex(obj); ; index = (index + 1u) & mask) {
+      const Entry& entry = entries_[index];
+      if (entry.root.IsNull()) {
+        return entries_.size();
+      }
+      if (entry.root.template Read<art::kWithoutReadBarrier>() == obj) {
+        return index;
+      }
+    }
+  }
+
+  // Adds an entry for `obj`, which is not in the table, without checking the load of the table.
+  void InsertEntry(art::mirror::Object* obj, T tag)
+      REQUIRES_SHARED(art::Locks::mutator_lock_)
+      REQUIRES(allow_disallow_lock_);
+
+  // Frees the entry at `index`, moving back the entries following it in their probe sequence so
+  // that there are no tombstones.
+  void EraseEntry(size_t index)
+      REQUIRES_SHARED(art::Locks::mutator_lock_)
+      REQUIRES(allow_disallow_lock_);
+
+  // Reinserts the non-free entries in a table of `capacity` entries.
+  void Rehash(size_t capacity)
+      REQUIRES_SHARED(art::Locks::mutator_lock_)
+      REQUIRES(allow_disallow_lock_);
 
-  using TagAllocator = JvmtiAllocator<std::pair<const art::GcRoot<art::mirror::Object>, T>>;
-  std::unordered_map<art::GcRoot<art::mirror::Object>,
-                     T,
-                     HashGcRoot,
-                     EqGcRoot,
-                     TagAllocator> tagged_objects_
+  // Open-addressing table of the tagged objects, keyed by address with linear probing. The
+  // number of entries is zero or a power of two.
+  std::vector<Entry, JvmtiAllocator<Entry>> entries_
       GUARDED_BY(allow_disallow_lock_)
       GUARDED_BY(art::Locks::mutator_lock_);
+  // The number of non-free entries.
+  size_t num_entries_ GUARDED_BY(allow_disallow_lock_);
   // To avoid repeatedly scanning the whole table, remember if we did that since the last sweep.
   bool update_since_last_sweep_;
 };
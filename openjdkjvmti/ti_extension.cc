@@ -43,6 +43,7 @@
 #include "ti_dump.h"
 #include "ti_heap.h"
 #include "ti_logging.h"
+#include "ti_method.h"
 #include "ti_monitor.h"
 #include "ti_redefine.h"
 #include "ti_search.h"
@@ -178,6 +179,61 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::GetRegionHistogram),
+      "com.android.art.heap.get_region_histogram",
+      "Retrieve the number of regions per live percent bucket (10% each) and per age bucket"
+          " (0, 1, 2-3, 4-7, ... collections) as recorded when the region space last selected"
+          " the regions to evacuate. Regions allocated since the previous GC are not counted.",
+      {
+          { "live_percent_bucket_count", JVMTI_KIND_OUT, JVMTI_TYPE_JINT, false},
+          { "live_percent_regions", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JINT, false},
+          { "age_bucket_count", JVMTI_KIND_OUT, JVMTI_TYPE_JINT, false},
+          { "age_regions", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JINT, false}
+      },
+      { ERR(NULL_POINTER), ERR(NOT_AVAILABLE) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::SetAllocationSamplingInterval),
+      "com.android.art.heap.set_allocation_sampling_interval",
+      "Sample the allocations of each thread on average every 'interval' allocated bytes, or"
+          " stop sampling if 'interval' is 0. The distances between samples are exponentially"
+          " distributed, like those of the SampledObjectAlloc event. Samples are buffered by the"
+          " runtime until retrieved with com.android.art.heap.drain_allocation_samples, and"
+          " dropped while the buffer is full.",
+      {
+          { "interval", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+      },
+      { ERR(ILLEGAL_ARGUMENT) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::DrainAllocationSamples),
+      "com.android.art.heap.drain_allocation_samples",
+      "Remove up to 'max_samples' of the oldest buffered allocation samples. For each sample, the"
+          " class and size of the allocated object are returned in 'classes' and 'sizes', and"
+          " 'frame_counts' frames of the allocating stack, innermost first, are returned in"
+          " 'frames' starting at index (sample index * max_frame_count). The objects themselves"
+          " are not kept alive by sampling.",
+      {
+          { "max_samples", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+          { "sample_count", JVMTI_KIND_OUT, JVMTI_TYPE_JINT, false},
+          { "max_frame_count", JVMTI_KIND_OUT, JVMTI_TYPE_JINT, false},
+          { "classes", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JCLASS, false},
+          { "sizes", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JLONG, false},
+          { "frame_counts", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JINT, false},
+          { "frames", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_CVOID, false},
+      },
+      { ERR(ILLEGAL_ARGUMENT), ERR(NULL_POINTER) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   error = add_extension(
       reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::IterateThroughHeapExt),
       "com.android.art.heap.iterate_through_heap_ext",
@@ -200,6 +256,29 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::IterateThroughHeapParallel),
+      "com.android.art.heap.iterate_through_heap_parallel",
+      "Iterate through a heap. This is equivalent to the standard IterateThroughHeap function,"
+      " except that the heap is split among the runtime's GC threads, so the callbacks may be"
+      " called concurrently from several threads and in no particular order. Callbacks must be"
+      " thread-safe. Returning JVMTI_VISIT_ABORT stops the iteration, but callbacks already"
+      " running on other threads still complete.",
+      {
+          { "heap_filter", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+          { "klass", JVMTI_KIND_IN, JVMTI_TYPE_JCLASS, true},
+          { "callbacks", JVMTI_KIND_IN_PTR, JVMTI_TYPE_CVOID, false},
+          { "user_data", JVMTI_KIND_IN_PTR, JVMTI_TYPE_CVOID, true}
+      },
+      {
+          ERR(MUST_POSSESS_CAPABILITY),
+          ERR(INVALID_CLASS),
+          ERR(NULL_POINTER),
+      });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   error = add_extension(
       reinterpret_cast<jvmtiExtensionFunction>(AllocUtil::GetGlobalJvmtiAllocationState),
       "com.android.art.alloc.get_global_jvmti_allocation_state",
@@ -281,6 +360,68 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  // Lock contention sampling
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(MonitorUtil::SetLockContentionSamplingPeriod),
+      "com.android.art.concurrent.set_lock_contention_sampling_period",
+      "Sample one in 'period' contentions on monitors and on the runtime's internal locks, or"
+          " stop sampling if 'period' is 0. Samples are buffered by the runtime until retrieved"
+          " with com.android.art.concurrent.drain_lock_contention_samples, and dropped while the"
+          " buffer is full.",
+      {
+          { "period", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+      },
+      { ERR(ILLEGAL_ARGUMENT) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(MonitorUtil::DrainLockContentionSamples),
+      "com.android.art.concurrent.drain_lock_contention_samples",
+      "Remove up to 'max_samples' of the oldest buffered lock contention samples. For each"
+          " sample, the method and location of the owner of the monitor when the contention"
+          " started, of the thread that waited for it, and the time waited in nanoseconds are"
+          " returned. The methods are null for contentions on the runtime's internal locks and"
+          " when they are not known.",
+      {
+          { "max_samples", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+          { "sample_count", JVMTI_KIND_OUT, JVMTI_TYPE_JINT, false},
+          { "owner_methods", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JMETHODID, false},
+          { "owner_locations", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JLOCATION, false},
+          { "waiter_methods", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JMETHODID, false},
+          { "waiter_locations", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JLOCATION, false},
+          { "wait_times", JVMTI_KIND_ALLOC_BUF, JVMTI_TYPE_JLONG, false},
+      },
+      { ERR(ILLEGAL_ARGUMENT), ERR(NULL_POINTER) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  // Method entry/exit filter
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(MethodUtil::SetMethodEntryExitFilter),
+      "com.android.art.method.set_method_entry_exit_filter",
+      "Only report the MethodEntry and MethodExit events of this environment for the given"
+          " 'methods', or for all methods if 'method_count' is 0. While a filter is set, enabling"
+          " these events for all threads only deoptimizes the filtered methods, other methods"
+          " keep running compiled code. The filter cannot be changed while either event is"
+          " enabled for all threads.",
+      {
+          { "method_count", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false },
+          { "methods", JVMTI_KIND_IN_BUF, JVMTI_TYPE_JMETHODID, true },
+      },
+      {
+          ERR(MUST_POSSESS_CAPABILITY),
+          ERR(ILLEGAL_ARGUMENT),
+          ERR(NULL_POINTER),
+          ERR(INVALID_METHODID),
+          ERR(NATIVE_METHOD),
+      });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   // GetLastError extension
   error = add_extension(
       reinterpret_cast<jvmtiExtensionFunction>(LogUtil::GetLastError),
@@ -396,6 +537,30 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  // NewStablePrimitiveArray
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::NewStablePrimitiveArray),
+      "com.android.art.heap.new_stable_primitive_array",
+      "Allocates a primitive array of the given array class and length which the GC never moves,"
+      " and returns a local reference to it along with the address of its first element. The"
+      " address stays valid for as long as the array is reachable, so native code can keep it,"
+      " or wrap it with NewDirectByteBuffer, while it holds a global reference to the array. JNI"
+      " accesses to the elements of the array never copy them.",
+      {
+        { "array_class", JVMTI_KIND_IN, JVMTI_TYPE_JCLASS, false },
+        { "length", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false },
+        { "array", JVMTI_KIND_OUT, JVMTI_TYPE_JOBJECT, false },
+        { "data", JVMTI_KIND_OUT, JVMTI_TYPE_CVOID, false },
+      },
+      {
+         ERR(NULL_POINTER),
+         ERR(ILLEGAL_ARGUMENT),
+         ERR(OUT_OF_MEMORY),
+      });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   // These require index-ids and debuggable to function
   art::Runtime* runtime = art::Runtime::Current();
   if (runtime->GetJniIdType() == art::JniIdType::kIndices &&
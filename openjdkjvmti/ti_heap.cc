@@ -16,6 +16,7 @@
 
 #include "ti_heap.h"
 
+#include <atomic>
 #include <ios>
 #include <unordered_map>
 
@@ -33,11 +34,13 @@
 #include "deopt_manager.h"
 #include "dex/primitive.h"
 #include "events-inl.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector_type.h"
 #include "gc/gc_cause.h"
 #include "gc/heap-visit-objects-inl.h"
 #include "gc/heap-inl.h"
 #include "gc/scoped_gc_critical_section.h"
+#include "gc/space/region_space.h"
 #include "gc_root-inl.h"
 #include "handle.h"
 #include "handle_scope.h"
@@ -743,6 +746,7 @@ jvmtiError HeapUtil::IterateOverInstancesOfClass(jvmtiEnv* env,
   return OK;
 }
 
+// If `parallel`, the heap is split among the GC threads and `fn` is called concurrently from them.
 template <typename T>
 static jvmtiError DoIterateThroughHeap(T fn,
                                        jvmtiEnv* env,
@@ -750,7 +754,8 @@ static jvmtiError DoIterateThroughHeap(T fn,
                                        jint heap_filter_int,
                                        jclass klass,
                                        const jvmtiHeapCallbacks* callbacks,
-                                       const void* user_data) {
+                                       const void* user_data,
+                                       bool parallel = false) {
   if (callbacks == nullptr) {
     return ERR(NULL_POINTER);
   }
@@ -758,12 +763,12 @@ static jvmtiError DoIterateThroughHeap(T fn,
   art::Thread* self = art::Thread::Current();
   art::ScopedObjectAccess soa(self);      // Now we know we have the shared lock.
 
-  bool stop_reports = false;
+  std::atomic<bool> stop_reports(false);
   const HeapFilter heap_filter(heap_filter_int);
-  art::ObjPtr<art::mirror::Class> filter_klass = soa.Decode<art::mirror::Class>(klass);
+  art::ObjPtr<art::mirror::Class> filter_klass = nullptr;
   auto visitor = [&](art::mirror::Object* obj) REQUIRES_SHARED(art::Locks::mutator_lock_) {
     // Early return, as we can't really stop visiting.
-    if (stop_reports) {
+    if (stop_reports.load(std::memory_order_relaxed)) {
       return;
     }
 
@@ -801,23 +806,38 @@ static jvmtiError DoIterateThroughHeap(T fn,
       tag_table->Set(obj, tag);
     }
 
-    stop_reports = (ret & JVMTI_VISIT_ABORT) != 0;
+    bool stop = (ret & JVMTI_VISIT_ABORT) != 0;
 
-    if (!stop_reports) {
+    if (!stop) {
       jint string_ret = ReportString(obj, env, tag_table, callbacks, user_data);
-      stop_reports = (string_ret & JVMTI_VISIT_ABORT) != 0;
+      stop = (string_ret & JVMTI_VISIT_ABORT) != 0;
     }
 
-    if (!stop_reports) {
+    if (!stop) {
       jint array_ret = ReportPrimitiveArray(obj, env, tag_table, callbacks, user_data);
-      stop_reports = (array_ret & JVMTI_VISIT_ABORT) != 0;
+      stop = (array_ret & JVMTI_VISIT_ABORT) != 0;
+    }
+
+    if (!stop) {
+      stop = ReportPrimitiveField::Report(obj, tag_table, callbacks, user_data);
     }
 
-    if (!stop_reports) {
-      stop_reports = ReportPrimitiveField::Report(obj, tag_table, callbacks, user_data);
+    if (stop) {
+      stop_reports.store(true, std::memory_order_relaxed);
     }
   };
-  art::Runtime::Current()->GetHeap()->VisitObjects(visitor);
+  if (!parallel) {
+    filter_klass = soa.Decode<art::mirror::Class>(klass);
+    art::Runtime::Current()->GetHeap()->VisitObjects(visitor);
+  } else {
+    art::ScopedThreadSuspension sts(self, art::kWaitingForVisitObjects);
+    // Keep the GC from running, and from using the GC threads, while they visit the heap.
+    art::gc::ScopedGCCriticalSection gcs(
+        self, art::gc::GcCause::kGcCauseDebugger, art::gc::CollectorType::kCollectorTypeDebugger);
+    art::ScopedSuspendAll ssa("IterateThroughHeapParallel");
+    filter_klass = art::ObjPtr<art::mirror::Class>::DownCast(self->DecodeJObject(klass));
+    art::Runtime::Current()->GetHeap()->VisitObjectsPausedParallel(visitor);
+  }
 
   return ERR(NONE);
 }
@@ -1580,6 +1600,123 @@ jvmtiError HeapExtensions::GetHeapName(jvmtiEnv* env, jint heap_id, char** heap_
   }
 }
 
+jvmtiError HeapExtensions::GetRegionHistogram(jvmtiEnv* env,
+                                              jint* live_percent_bucket_count,
+                                              jint** live_percent_regions,
+                                              jint* age_bucket_count,
+                                              jint** age_regions) {
+  if (live_percent_bucket_count == nullptr ||
+      live_percent_regions == nullptr ||
+      age_bucket_count == nullptr ||
+      age_regions == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  art::gc::space::RegionSpace* region_space = art::Runtime::Current()->GetHeap()->GetRegionSpace();
+  if (region_space == nullptr) {
+    return ERR(NOT_AVAILABLE);
+  }
+  using RegionHistogram = art::gc::space::RegionSpace::RegionHistogram;
+  const RegionHistogram histogram = region_space->GetRegionHistogram();
+  jvmtiError error;
+  JvmtiUniquePtr<jint[]> live_percent =
+      AllocJvmtiUniquePtr<jint[]>(env, RegionHistogram::kNumLivePercentBuckets, &error);
+  if (live_percent == nullptr) {
+    return error;
+  }
+  JvmtiUniquePtr<jint[]> ages =
+      AllocJvmtiUniquePtr<jint[]>(env, RegionHistogram::kNumAgeBuckets, &error);
+  if (ages == nullptr) {
+    return error;
+  }
+  for (size_t i = 0; i < RegionHistogram::kNumLivePercentBuckets; ++i) {
+    live_percent[i] = static_cast<jint>(histogram.live_percent_regions[i]);
+  }
+  for (size_t i = 0; i < RegionHistogram::kNumAgeBuckets; ++i) {
+    ages[i] = static_cast<jint>(histogram.age_regions[i]);
+  }
+  *live_percent_bucket_count = RegionHistogram::kNumLivePercentBuckets;
+  *live_percent_regions = live_percent.release();
+  *age_bucket_count = RegionHistogram::kNumAgeBuckets;
+  *age_regions = ages.release();
+  return ERR(NONE);
+}
+
+jvmtiError HeapExtensions::SetAllocationSamplingInterval(jvmtiEnv* env ATTRIBUTE_UNUSED,
+                                                         jint interval) {
+  if (interval < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  art::Runtime::Current()->GetHeap()->SetAllocationSamplingInterval(
+      static_cast<size_t>(interval));
+  return ERR(NONE);
+}
+
+jvmtiError HeapExtensions::DrainAllocationSamples(jvmtiEnv* env,
+                                                  jint max_samples,
+                                                  jint* sample_count,
+                                                  jint* max_frame_count,
+                                                  jclass** classes,
+                                                  jlong** sizes,
+                                                  jint** frame_counts,
+                                                  jvmtiFrameInfo** frames) {
+  if (max_samples < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  if (sample_count == nullptr ||
+      max_frame_count == nullptr ||
+      classes == nullptr ||
+      sizes == nullptr ||
+      frame_counts == nullptr ||
+      frames == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  constexpr size_t kMaxDepth = art::gc::AllocationSample::kMaxStackDepth;
+  size_t capacity =
+      std::min(static_cast<size_t>(max_samples), art::gc::AllocationSampler::kNumSlots);
+  jvmtiError error;
+  JvmtiUniquePtr<jclass[]> out_classes = AllocJvmtiUniquePtr<jclass[]>(env, capacity, &error);
+  if (error != ERR(NONE)) {
+    return error;
+  }
+  JvmtiUniquePtr<jlong[]> out_sizes = AllocJvmtiUniquePtr<jlong[]>(env, capacity, &error);
+  if (error != ERR(NONE)) {
+    return error;
+  }
+  JvmtiUniquePtr<jint[]> out_frame_counts = AllocJvmtiUniquePtr<jint[]>(env, capacity, &error);
+  if (error != ERR(NONE)) {
+    return error;
+  }
+  JvmtiUniquePtr<jvmtiFrameInfo[]> out_frames =
+      AllocJvmtiUniquePtr<jvmtiFrameInfo[]>(env, capacity * kMaxDepth, &error);
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  art::ScopedObjectAccess soa(art::Thread::Current());
+  size_t index = 0;
+  size_t count = art::Runtime::Current()->GetHeap()->DrainAllocationSamples(
+      capacity,
+      [&](const art::gc::AllocationSample& sample) REQUIRES_SHARED(art::Locks::mutator_lock_) {
+        out_classes[index] = soa.AddLocalReference<jclass>(sample.klass.Read());
+        out_sizes[index] = static_cast<jlong>(sample.byte_count);
+        out_frame_counts[index] = static_cast<jint>(sample.depth);
+        for (size_t i = 0; i < sample.depth; ++i) {
+          jvmtiFrameInfo& frame = out_frames[index * kMaxDepth + i];
+          frame.method = art::jni::EncodeArtMethod(sample.frames[i].GetMethod());
+          frame.location = static_cast<jlocation>(sample.frames[i].GetDexPc());
+        }
+        ++index;
+      });
+  DCHECK_EQ(count, index);
+  *sample_count = static_cast<jint>(count);
+  *max_frame_count = static_cast<jint>(kMaxDepth);
+  *classes = out_classes.release();
+  *sizes = out_sizes.release();
+  *frame_counts = out_frame_counts.release();
+  *frames = out_frames.release();
+  return ERR(NONE);
+}
+
 jvmtiError HeapExtensions::IterateThroughHeapExt(jvmtiEnv* env,
                                                  jint heap_filter,
                                                  jclass klass,
@@ -1612,6 +1749,39 @@ jvmtiError HeapExtensions::IterateThroughHeapExt(jvmtiEnv* env,
                               user_data);
 }
 
+jvmtiError HeapExtensions::IterateThroughHeapParallel(jvmtiEnv* env,
+                                                      jint heap_filter,
+                                                      jclass klass,
+                                                      const jvmtiHeapCallbacks* callbacks,
+                                                      const void* user_data) {
+  if (ArtJvmTiEnv::AsArtJvmTiEnv(env)->capabilities.can_tag_objects != 1) {
+    return ERR(MUST_POSSESS_CAPABILITY);
+  }
+
+  auto JvmtiIterateHeap = [](art::mirror::Object* obj ATTRIBUTE_UNUSED,
+                             const jvmtiHeapCallbacks* cb_callbacks,
+                             jlong class_tag,
+                             jlong size,
+                             jlong* tag,
+                             jint length,
+                             void* cb_user_data)
+      REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    return cb_callbacks->heap_iteration_callback(class_tag,
+                                                 size,
+                                                 tag,
+                                                 length,
+                                                 cb_user_data);
+  };
+  return DoIterateThroughHeap(JvmtiIterateHeap,
+                              env,
+                              ArtJvmTiEnv::AsArtJvmTiEnv(env)->object_tag_table.get(),
+                              heap_filter,
+                              klass,
+                              callbacks,
+                              user_data,
+                              /* parallel= */ true);
+}
+
 namespace {
 
 using ObjectPtr = art::ObjPtr<art::mirror::Object>;
@@ -1977,6 +2147,41 @@ jvmtiError HeapExtensions::ChangeArraySize(jvmtiEnv* env, jobject arr, jsize new
   return OK;
 }
 
+jvmtiError HeapExtensions::NewStablePrimitiveArray(jvmtiEnv* env,
+                                                   jclass array_class,
+                                                   jint length,
+                                                   jobject* array,
+                                                   void** data) {
+  if (array_class == nullptr || array == nullptr || data == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  if (length < 0) {
+    JVMTI_LOG(INFO, env) << "Cannot allocate an array of negative length";
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  art::Thread* self = art::Thread::Current();
+  art::ScopedObjectAccess soa(self);
+  art::ObjPtr<art::mirror::Class> klass(soa.Decode<art::mirror::Class>(array_class));
+  if (!klass->IsPrimitiveArray()) {
+    JVMTI_LOG(INFO, env) << klass->PrettyClass() << " is not a primitive array class!";
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  art::ObjPtr<art::mirror::Array> arr =
+      art::Runtime::Current()->GetHeap()->AllocStableArray(self, klass, length);
+  if (arr == nullptr) {
+    self->AssertPendingOOMException();
+    JVMTI_LOG(INFO, env) << "Unable to allocate " << klass->PrettyClass()
+                         << " (length: " << length << ") due to OOME. Error was: "
+                         << self->GetException()->Dump();
+    self->ClearException();
+    return ERR(OUT_OF_MEMORY);
+  }
+  // The array never moves, so its data stays at this address for as long as it is reachable.
+  *data = arr->GetRawData(klass->GetComponentSize(), 0);
+  *array = soa.AddLocalReference<jobject>(arr);
+  return OK;
+}
+
 void HeapExtensions::Register(EventHandler* eh) {
   gEventHandler = eh;
 }
@@ -83,14 +83,42 @@ class HeapExtensions {
   static jvmtiError JNICALL GetObjectHeapId(jvmtiEnv* env, jlong tag, jint* heap_id, ...);
   static jvmtiError JNICALL GetHeapName(jvmtiEnv* env, jint heap_id, char** heap_name, ...);
 
+  static jvmtiError JNICALL GetRegionHistogram(jvmtiEnv* env,
+                                               jint* live_percent_bucket_count,
+                                               jint** live_percent_regions,
+                                               jint* age_bucket_count,
+                                               jint** age_regions);
+
+  static jvmtiError JNICALL SetAllocationSamplingInterval(jvmtiEnv* env, jint interval);
+
+  static jvmtiError JNICALL DrainAllocationSamples(jvmtiEnv* env,
+                                                   jint max_samples,
+                                                   jint* sample_count,
+                                                   jint* max_frame_count,
+                                                   jclass** classes,
+                                                   jlong** sizes,
+                                                   jint** frame_counts,
+                                                   jvmtiFrameInfo** frames);
+
   static jvmtiError JNICALL IterateThroughHeapExt(jvmtiEnv* env,
                                                   jint heap_filter,
                                                   jclass klass,
                                                   const jvmtiHeapCallbacks* callbacks,
                                                   const void* user_data);
+  static jvmtiError JNICALL IterateThroughHeapParallel(jvmtiEnv* env,
+                                                       jint heap_filter,
+                                                       jclass klass,
+                                                       const jvmtiHeapCallbacks* callbacks,
+                                                       const void* user_data);
 
   static jvmtiError JNICALL ChangeArraySize(jvmtiEnv* env, jobject arr, jsize new_size);
 
+  static jvmtiError JNICALL NewStablePrimitiveArray(jvmtiEnv* env,
+                                                    jclass array_class,
+                                                    jint length,
+                                                    jobject* array,
+                                                    void** data);
+
   static void ReplaceReferences(
       art::Thread* self,
       const std::unordered_map<art::ObjPtr<art::mirror::Object>,
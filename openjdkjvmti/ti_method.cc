@@ -33,6 +33,7 @@
 
 #include <initializer_list>
 #include <type_traits>
+#include <unordered_set>
 #include <variant>
 
 #include "android-base/macros.h"
@@ -542,6 +543,51 @@ jvmtiError MethodUtil::IsMethodSynthetic(jvmtiEnv* env, jmethodID m, jboolean* i
   return IsMethodT(env, m, test, is_synthetic_ptr);
 }
 
+jvmtiError MethodUtil::SetMethodEntryExitFilter(jvmtiEnv* jenv,
+                                                jint method_count,
+                                                const jmethodID* methods) {
+  ArtJvmTiEnv* env = ArtJvmTiEnv::AsArtJvmTiEnv(jenv);
+  if (env->capabilities.can_generate_method_entry_events != 1 &&
+      env->capabilities.can_generate_method_exit_events != 1) {
+    return ERR(MUST_POSSESS_CAPABILITY);
+  }
+  if (method_count < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  if (method_count != 0 && methods == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  std::unordered_set<art::ArtMethod*> filter;
+  {
+    art::ScopedObjectAccess soa(art::Thread::Current());
+    for (jint i = 0; i != method_count; ++i) {
+      if (methods[i] == nullptr) {
+        return ERR(INVALID_METHODID);
+      }
+      art::ArtMethod* method = art::jni::DecodeArtMethod(methods[i]);
+      if (method->IsNative()) {
+        return ERR(NATIVE_METHOD);
+      }
+      if (!method->IsInvokable() || method->IsProxyMethod()) {
+        return ERR(INVALID_METHODID);
+      }
+      filter.insert(method);
+    }
+  }
+  art::WriterMutexLock lk(art::Thread::Current(), env->event_info_mutex_);
+  // The methods to deoptimize are only computed when the events are enabled or disabled globally.
+  if (env->event_masks.global_event_mask.Test(ArtJvmtiEvent::kMethodEntry) ||
+      env->event_masks.global_event_mask.Test(ArtJvmtiEvent::kMethodExit)) {
+    JVMTI_LOG(WARNING, env) << "Cannot change the method entry/exit filter while method entry or"
+                            << " exit events are enabled";
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  env->method_entry_exit_filter.swap(filter);
+  env->has_method_entry_exit_filter.store(!env->method_entry_exit_filter.empty(),
+                                          std::memory_order_relaxed);
+  return OK;
+}
+
 class CommonLocalVariableClosure : public art::Closure {
  public:
   // The verifier isn't always able to be as specific as the local-variable-table. We can only get
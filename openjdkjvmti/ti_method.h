@@ -81,6 +81,9 @@ class MethodUtil {
   static jvmtiError IsMethodNative(jvmtiEnv* env, jmethodID method, jboolean* is_native_ptr);
   static jvmtiError IsMethodObsolete(jvmtiEnv* env, jmethodID method, jboolean* is_obsolete_ptr);
   static jvmtiError IsMethodSynthetic(jvmtiEnv* env, jmethodID method, jboolean* is_synthetic_ptr);
+  static jvmtiError SetMethodEntryExitFilter(jvmtiEnv* env,
+                                             jint method_count,
+                                             const jmethodID* methods);
   static jvmtiError GetLocalVariableTable(jvmtiEnv* env,
                                           jmethodID method,
                                           jint* entry_count_ptr,
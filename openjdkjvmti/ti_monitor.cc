@@ -31,6 +31,7 @@
 
 #include "ti_monitor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -38,6 +39,8 @@
 
 #include "art_jvmti.h"
 #include "gc_root-inl.h"
+#include "jni/jni_internal.h"
+#include "lock_contention_sampler.h"
 #include "mirror/object-inl.h"
 #include "monitor.h"
 #include "runtime.h"
@@ -434,4 +437,84 @@ jvmtiError MonitorUtil::GetCurrentContendedMonitor(jvmtiEnv* env ATTRIBUTE_UNUSE
   return OK;
 }
 
+jvmtiError MonitorUtil::SetLockContentionSamplingPeriod(jvmtiEnv* env ATTRIBUTE_UNUSED,
+                                                        jint period) {
+  if (period < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  art::Runtime::Current()->GetLockContentionSampler()->SetSamplingPeriod(
+      static_cast<uint32_t>(period));
+  return OK;
+}
+
+jvmtiError MonitorUtil::DrainLockContentionSamples(jvmtiEnv* env,
+                                                   jint max_samples,
+                                                   jint* sample_count,
+                                                   jmethodID** owner_methods,
+                                                   jlocation** owner_locations,
+                                                   jmethodID** waiter_methods,
+                                                   jlocation** waiter_locations,
+                                                   jlong** wait_times) {
+  if (max_samples < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  if (sample_count == nullptr ||
+      owner_methods == nullptr ||
+      owner_locations == nullptr ||
+      waiter_methods == nullptr ||
+      waiter_locations == nullptr ||
+      wait_times == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  size_t capacity =
+      std::min(static_cast<size_t>(max_samples), art::LockContentionSampler::kNumSlots);
+  jvmtiError error;
+  JvmtiUniquePtr<jmethodID[]> out_owner_methods =
+      AllocJvmtiUniquePtr<jmethodID[]>(env, capacity, &error);
+  if (error != OK) {
+    return error;
+  }
+  JvmtiUniquePtr<jlocation[]> out_owner_locations =
+      AllocJvmtiUniquePtr<jlocation[]>(env, capacity, &error);
+  if (error != OK) {
+    return error;
+  }
+  JvmtiUniquePtr<jmethodID[]> out_waiter_methods =
+      AllocJvmtiUniquePtr<jmethodID[]>(env, capacity, &error);
+  if (error != OK) {
+    return error;
+  }
+  JvmtiUniquePtr<jlocation[]> out_waiter_locations =
+      AllocJvmtiUniquePtr<jlocation[]>(env, capacity, &error);
+  if (error != OK) {
+    return error;
+  }
+  JvmtiUniquePtr<jlong[]> out_wait_times = AllocJvmtiUniquePtr<jlong[]>(env, capacity, &error);
+  if (error != OK) {
+    return error;
+  }
+
+  art::ScopedObjectAccess soa(art::Thread::Current());
+  size_t index = 0;
+  size_t count = art::Runtime::Current()->GetLockContentionSampler()->Drain(
+      soa.Self(),
+      capacity,
+      [&](const art::LockContentionSample& sample) REQUIRES_SHARED(art::Locks::mutator_lock_) {
+        out_owner_methods[index] = art::jni::EncodeArtMethod(sample.owner_method);
+        out_owner_locations[index] = static_cast<jlocation>(sample.owner_dex_pc);
+        out_waiter_methods[index] = art::jni::EncodeArtMethod(sample.waiter_method);
+        out_waiter_locations[index] = static_cast<jlocation>(sample.waiter_dex_pc);
+        out_wait_times[index] = static_cast<jlong>(sample.wait_ns);
+        ++index;
+      });
+  DCHECK_EQ(count, index);
+  *sample_count = static_cast<jint>(count);
+  *owner_methods = out_owner_methods.release();
+  *owner_locations = out_owner_locations.release();
+  *waiter_methods = out_waiter_methods.release();
+  *waiter_locations = out_waiter_locations.release();
+  *wait_times = out_wait_times.release();
+  return OK;
+}
+
 }  // namespace openjdkjvmti
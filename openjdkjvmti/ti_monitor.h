@@ -56,6 +56,17 @@ class MonitorUtil {
   static jvmtiError RawMonitorNotifyAll(jvmtiEnv* env, jrawMonitorID monitor);
 
   static jvmtiError GetCurrentContendedMonitor(jvmtiEnv* env, jthread thr, jobject* monitor);
+
+  static jvmtiError JNICALL SetLockContentionSamplingPeriod(jvmtiEnv* env, jint period);
+
+  static jvmtiError JNICALL DrainLockContentionSamples(jvmtiEnv* env,
+                                                       jint max_samples,
+                                                       jint* sample_count,
+                                                       jmethodID** owner_methods,
+                                                       jlocation** owner_locations,
+                                                       jmethodID** waiter_methods,
+                                                       jlocation** waiter_locations,
+                                                       jlong** wait_times);
 };
 
 }  // namespace openjdkjvmti
@@ -38,6 +38,9 @@
 #include <sstream>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
 
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
@@ -121,6 +124,7 @@
 #include "stack.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "ti_breakpoint.h"
 #include "ti_class_definition.h"
 #include "ti_class_loader.h"
@@ -1610,22 +1614,31 @@ RedefinitionDataIter RedefinitionDataHolder::end() {
 }
 
 bool Redefiner::ClassRedefinition::CheckVerification(const RedefinitionDataIter& iter) {
-  DCHECK_EQ(dex_file_->NumClassDefs(), 1u);
-  art::StackHandleScope<2> hs(driver_->self_);
   std::string error;
+  art::verifier::FailureKind failure = VerifyNewClass(driver_->self_, iter, &error);
+  return HandleVerificationResult(failure, error);
+}
+
+art::verifier::FailureKind Redefiner::ClassRedefinition::VerifyNewClass(
+    art::Thread* self, const RedefinitionDataIter& iter, /*out*/std::string* error) {
+  DCHECK_EQ(dex_file_->NumClassDefs(), 1u);
+  art::StackHandleScope<2> hs(self);
   // TODO Make verification log level lower
-  art::verifier::FailureKind failure =
-      art::verifier::ClassVerifier::VerifyClass(driver_->self_,
-                                                dex_file_.get(),
-                                                hs.NewHandle(iter.GetNewDexCache()),
-                                                hs.NewHandle(GetClassLoader()),
-                                                /*class_def=*/ dex_file_->GetClassDef(0),
-                                                /*callbacks=*/ nullptr,
-                                                /*allow_soft_failures=*/ true,
-                                                /*log_level=*/
-                                                art::verifier::HardFailLogMode::kLogWarning,
-                                                art::Runtime::Current()->GetTargetSdkVersion(),
-                                                &error);
+  return art::verifier::ClassVerifier::VerifyClass(
+      self,
+      dex_file_.get(),
+      hs.NewHandle(iter.GetNewDexCache()),
+      hs.NewHandle(iter.GetMirrorClass()->GetClassLoader()),
+      /*class_def=*/ dex_file_->GetClassDef(0),
+      /*callbacks=*/ nullptr,
+      /*allow_soft_failures=*/ true,
+      /*log_level=*/ art::verifier::HardFailLogMode::kLogWarning,
+      art::Runtime::Current()->GetTargetSdkVersion(),
+      error);
+}
+
+bool Redefiner::ClassRedefinition::HandleVerificationResult(art::verifier::FailureKind failure,
+                                                             const std::string& error) {
   switch (failure) {
     case art::verifier::FailureKind::kNoFailure:
       // TODO It is possible that by doing redefinition previous NO_COMPILE verification failures
@@ -2242,8 +2255,45 @@ void Redefiner::ReleaseAllDexFiles() {
 }
 
 bool Redefiner::CheckAllClassesAreVerified(RedefinitionDataHolder& holder) {
+  // Verification of many classes is the longest part of the redefinition that happens before
+  // suspending all threads, so spread it over a thread pool. Structural redefinitions pause class
+  // loading on other threads, which the verifier may need, so they are always verified here.
+  size_t num_threads = std::min(static_cast<size_t>(holder.Length()),
+                                static_cast<size_t>(sysconf(_SC_NPROCESSORS_CONF)));
+  bool has_structural = std::any_of(holder.begin(), holder.end(), [](auto r)
+      REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    return r.GetRedefinition().IsStructuralRedefinition();
+  });
+  if (num_threads < kMinParallelVerifications || has_structural) {
+    for (RedefinitionDataIter data = holder.begin(); data != holder.end(); ++data) {
+      if (!data.GetRedefinition().CheckVerification(data)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<art::verifier::FailureKind> failures(holder.Length());
+  std::vector<std::string> errors(holder.Length());
+  {
+    // The workers need peers since the verifier may call into class loaders.
+    art::ScopedThreadSuspension sts(self_, art::ThreadState::kNative);
+    art::ThreadPool pool("Redefinition verification", num_threads, /*create_peers=*/ true);
+    for (size_t i = 0; i != failures.size(); ++i) {
+      pool.AddTask(self_, new art::FunctionTask([&, i](art::Thread* self) {
+        art::ScopedObjectAccess soa(self);
+        RedefinitionDataIter data(static_cast<int32_t>(i), holder);
+        failures[i] = data.GetRedefinition().VerifyNewClass(self, data, &errors[i]);
+      }));
+    }
+    pool.StartWorkers(self_);
+    pool.Wait(self_, /*do_work=*/ false, /*may_hold_locks=*/ false);
+    pool.StopWorkers(self_);
+  }
+  // Report the failure of the first class in redefinition order, as if verifying sequentially.
   for (RedefinitionDataIter data = holder.begin(); data != holder.end(); ++data) {
-    if (!data.GetRedefinition().CheckVerification(data)) {
+    size_t i = static_cast<size_t>(data.GetIndex());
+    if (!data.GetRedefinition().HandleVerificationResult(failures[i], errors[i])) {
       return false;
     }
   }
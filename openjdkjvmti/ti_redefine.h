@@ -50,6 +50,7 @@
 #include "mirror/class.h"
 #include "mirror/dex_cache.h"
 #include "obj_ptr.h"
+#include "verifier/verifier_enums.h"
 
 namespace art {
 class ClassAccessor;
@@ -113,6 +114,9 @@ class Redefiner {
                                                     jint data_size);
 
  private:
+  // Redefinitions of fewer classes are verified on the calling thread.
+  static constexpr size_t kMinParallelVerifications = 4u;
+
   class ClassRedefinition {
    public:
     ClassRedefinition(Redefiner* driver,
@@ -206,6 +210,16 @@ class Redefiner {
     bool CheckVerification(const RedefinitionDataIter& holder)
         REQUIRES_SHARED(art::Locks::mutator_lock_);
 
+    // Verifies the new class on `self`, which may be any attached thread. Does not record
+    // failures, see HandleVerificationResult.
+    art::verifier::FailureKind VerifyNewClass(art::Thread* self,
+                                              const RedefinitionDataIter& iter,
+                                              /*out*/std::string* error)
+        REQUIRES_SHARED(art::Locks::mutator_lock_);
+
+    // Records the result of VerifyNewClass. Returns false if the redefinition must fail.
+    bool HandleVerificationResult(art::verifier::FailureKind failure, const std::string& error);
+
     // Preallocates all needed allocations in klass so that we can pause execution safely.
     bool EnsureClassAllocationsFinished(/*out*/RedefinitionDataIter* data)
         REQUIRES_SHARED(art::Locks::mutator_lock_);
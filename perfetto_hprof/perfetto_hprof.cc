@@ -21,6 +21,7 @@
 #include <android-base/logging.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <poll.h>
 #include <sched.h>
 #include <signal.h>
 #include <sys/socket.h>
@@ -31,8 +32,14 @@
 #include <thread>
 #include <time.h>
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <type_traits>
+#include <unordered_map>
 
+#include "base/systrace.h"
+#include "base/time_utils.h"
 #include "gc/heap-visit-objects-inl.h"
 #include "gc/heap.h"
 #include "gc/scoped_gc_critical_section.h"
@@ -61,6 +68,10 @@
 //   g_signal_pipe_fds.
 // * perfetto producer thread: once the signal is received, the app forks. In the newly forked
 //   child, the Perfetto Client API spawns a thread to communicate with traced.
+//
+// Sending the signal with sigqueue and a positive value instead makes the listener thread
+// summarize the heap per class every that many milliseconds, in process and without a fork, until
+// the signal is sent with kStopClassSummaries. See DumpClassSummary.
 
 namespace perfetto_hprof {
 
@@ -71,7 +82,12 @@ constexpr time_t kWatchdogTimeoutSec = 120;
 // submessages can be up to 100k here for a 500k chunk size.
 // DropBox has a 500k chunk limit, and each chunk needs to parse as a proto.
 constexpr uint32_t kPacketSizeThreshold = 400000;
-constexpr char kByte[1] = {'x'};
+// Signal value that stops periodic class summaries.
+constexpr int32_t kStopClassSummaries = -1;
+// Signal value that requests a full heap dump.
+constexpr int32_t kFullHeapDump = 0;
+// Number of classes, by retained size estimate, reported by a class summary.
+constexpr size_t kMaxSummaryClasses = 64;
 static art::Mutex& GetStateMutex() {
   static art::Mutex state_mutex("perfetto_hprof_state_mutex", art::LockLevel::kGenericBottomLock);
   return state_mutex;
@@ -456,6 +472,140 @@ void DumpSmaps(JavaHprofDataSource::TraceContext* ctx) {
   }
 }
 
+// Per class totals of a class summary.
+struct ClassSummary {
+  uint64_t instances = 0;
+  uint64_t shallow_bytes = 0;
+  // Shallow bytes plus the bytes of the arrays directly referenced by the instances. Such arrays
+  // are almost always owned by their referrer (ArrayList.elementData, HashMap.table, ...).
+  uint64_t retained_bytes_estimate = 0;
+
+  void Add(const ClassSummary& other) {
+    instances += other.instances;
+    shallow_bytes += other.shallow_bytes;
+    retained_bytes_estimate += other.retained_bytes_estimate;
+  }
+
+  bool operator==(const ClassSummary& other) const {
+    return instances == other.instances &&
+        shallow_bytes == other.shallow_bytes &&
+        retained_bytes_estimate == other.retained_bytes_estimate;
+  }
+};
+
+class ReferredArraysSizer {
+ public:
+  explicit ReferredArraysSizer(uint64_t* bytes) : bytes_(bytes) {}
+
+  // For art::mirror::Object::VisitReferences.
+  void operator()(art::ObjPtr<art::mirror::Object> obj, art::MemberOffset offset,
+                  bool is_static ATTRIBUTE_UNUSED) const
+      REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    art::mirror::Object* ref = obj->GetFieldObject<art::mirror::Object>(offset);
+    if (ref != nullptr && ref->IsArrayInstance()) {
+      *bytes_ += ref->SizeOf();
+    }
+  }
+
+  void VisitRootIfNonNull(art::mirror::CompressedReference<art::mirror::Object>* root
+                              ATTRIBUTE_UNUSED) const {}
+  void VisitRoot(art::mirror::CompressedReference<art::mirror::Object>* root
+                     ATTRIBUTE_UNUSED) const {}
+
+ private:
+  uint64_t* bytes_;
+};
+
+int32_t ToCounterValue(uint64_t value) {
+  return static_cast<int32_t>(std::min<uint64_t>(value, std::numeric_limits<int32_t>::max()));
+}
+
+void ReportClassSummary(const std::string& class_name, const ClassSummary& summary) {
+  art::ATraceIntegerValue(("java_heap_count:" + class_name).c_str(),
+                          ToCounterValue(summary.instances));
+  art::ATraceIntegerValue(("java_heap_retained_kb:" + class_name).c_str(),
+                          ToCounterValue(summary.retained_bytes_estimate / art::KB));
+}
+
+// Summarize the heap per class in a single pause, which only aggregates counts instead of
+// recording the object graph like a full dump does. The top kMaxSummaryClasses classes are
+// reported as trace counters, and only when their totals differ from the previous summary in
+// `reported`, which is updated. Does nothing when tracing is disabled, as nobody would see the
+// counters.
+void DumpClassSummary(art::Thread* self, std::map<std::string, ClassSummary>* reported) {
+  if (!art::ATraceEnabled()) {
+    return;
+  }
+  uint64_t start_ns = art::NanoTime();
+  std::map<art::RootType, std::vector<art::mirror::Object*>> root_objects;
+  std::map<std::string, ClassSummary> summaries;
+  {
+    art::gc::ScopedGCCriticalSection gcs(self, art::gc::kGcCauseHprof,
+                                         art::gc::kCollectorTypeHprof);
+    art::ScopedSuspendAll ssa(__FUNCTION__, /* long_suspend=*/ true);
+
+    RootFinder rcf(&root_objects);
+    art::Runtime::Current()->VisitRoots(&rcf);
+
+    std::unordered_map<art::mirror::Class*, ClassSummary> by_class;
+    art::Runtime::Current()->GetHeap()->VisitObjectsPaused(
+        [&by_class](art::mirror::Object* obj) REQUIRES_SHARED(art::Locks::mutator_lock_) {
+          uint64_t size = obj->SizeOf();
+          uint64_t referred_array_bytes = 0;
+          if (!obj->IsArrayInstance()) {
+            ReferredArraysSizer sizer(&referred_array_bytes);
+            obj->VisitReferences(sizer, art::VoidFunctor());
+          }
+          ClassSummary& summary = by_class[obj->GetClass()];
+          summary.instances++;
+          summary.shallow_bytes += size;
+          summary.retained_bytes_estimate += size + referred_array_bytes;
+        });
+    // Classes can move once the mutators resume, so key the summary by name. Classes of the
+    // same name in different class loaders are summarized together.
+    for (const auto& p : by_class) {
+      summaries[PrettyType(p.first)].Add(p.second);
+    }
+  }
+
+  std::vector<std::pair<uint64_t, const std::string*>> by_retained_size;
+  by_retained_size.reserve(summaries.size());
+  for (const auto& p : summaries) {
+    by_retained_size.emplace_back(p.second.retained_bytes_estimate, &p.first);
+  }
+  size_t num_reported = std::min(kMaxSummaryClasses, by_retained_size.size());
+  std::partial_sort(by_retained_size.begin(),
+                    by_retained_size.begin() + num_reported,
+                    by_retained_size.end(),
+                    std::greater<std::pair<uint64_t, const std::string*>>());
+
+  std::map<std::string, ClassSummary> now_reported;
+  for (size_t i = 0; i < num_reported; ++i) {
+    const std::string& class_name = *by_retained_size[i].second;
+    const ClassSummary& summary = summaries[class_name];
+    auto it = reported->find(class_name);
+    if (it == reported->end() || !(it->second == summary)) {
+      ReportClassSummary(class_name, summary);
+    }
+    now_reported.emplace(class_name, summary);
+  }
+  // Reset the counters of classes that dropped out of the summary, so they do not look current.
+  for (const auto& p : *reported) {
+    if (now_reported.find(p.first) == now_reported.end()) {
+      ReportClassSummary(p.first, ClassSummary());
+    }
+  }
+  reported->swap(now_reported);
+
+  size_t num_roots = 0;
+  for (const auto& p : root_objects) {
+    num_roots += p.second.size();
+  }
+  art::ATraceIntegerValue("java_heap_roots", ToCounterValue(num_roots));
+  VLOG(heap) << "class summary of " << summaries.size() << " classes and " << num_roots
+             << " roots took " << art::PrettyDuration(art::NanoTime() - start_ns);
+}
+
 uint64_t GetObjectId(const art::mirror::Object* obj) {
   return reinterpret_cast<uint64_t>(obj) / std::alignment_of<art::mirror::Object>::value;
 }
@@ -686,8 +836,9 @@ extern "C" bool ArtPlugin_Initialize() {
 
   struct sigaction act = {};
   act.sa_flags = SA_SIGINFO | SA_RESTART;
-  act.sa_sigaction = [](int, siginfo_t*, void*) {
-    if (write(g_signal_pipe_fds[1], kByte, sizeof(kByte)) == -1) {
+  act.sa_sigaction = [](int, siginfo_t* info, void*) {
+    int32_t request = (info->si_code == SI_QUEUE) ? info->si_value.sival_int : kFullHeapDump;
+    if (write(g_signal_pipe_fds[1], &request, sizeof(request)) == -1) {
       PLOG(ERROR) << "Failed to trigger heap dump";
     }
   };
@@ -730,11 +881,28 @@ extern "C" bool ArtPlugin_Initialize() {
         GetStateCV().Broadcast(self);
       }
     }
-    char buf[1];
+    int32_t summary_interval_ms = 0;
+    uint64_t next_summary_ms = 0;
+    std::map<std::string, ClassSummary> reported_summaries;
     for (;;) {
+      if (summary_interval_ms > 0) {
+        uint64_t now_ms = art::MilliTime();
+        if (now_ms >= next_summary_ms) {
+          DumpClassSummary(self, &reported_summaries);
+          next_summary_ms = art::MilliTime() + summary_interval_ms;
+          continue;
+        }
+        struct pollfd pfd = {g_signal_pipe_fds[0], POLLIN, 0};
+        int res = poll(&pfd, 1, static_cast<int>(next_summary_ms - now_ms));
+        if (res == 0 || (res == -1 && errno == EINTR)) {
+          continue;
+        }
+      }
+
+      int32_t request;
       int res;
       do {
-        res = read(g_signal_pipe_fds[0], buf, sizeof(buf));
+        res = read(g_signal_pipe_fds[0], &request, sizeof(request));
       } while (res == -1 && errno == EINTR);
 
       if (res <= 0) {
@@ -745,7 +913,17 @@ extern "C" bool ArtPlugin_Initialize() {
         return;
       }
 
-      perfetto_hprof::DumpPerfetto(self);
+      if (request == kFullHeapDump) {
+        perfetto_hprof::DumpPerfetto(self);
+      } else if (request == kStopClassSummaries) {
+        LOG(INFO) << "stopping class summaries";
+        summary_interval_ms = 0;
+        reported_summaries.clear();
+      } else if (request > 0) {
+        LOG(INFO) << "summarizing classes every " << request << "ms";
+        summary_interval_ms = request;
+        next_summary_ms = 0;
+      }
     }
   });
   th.detach();
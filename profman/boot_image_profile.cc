@@ -16,8 +16,13 @@
 
 #include "boot_image_profile.h"
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <memory>
 #include <set>
+#include <thread>
+#include <vector>
 
 #include "android-base/file.h"
 #include "base/unix_file/fd_file.h"
@@ -208,15 +213,46 @@ bool GenerateBootImageProfile(
 
   bool generate_preloaded_classes = !preloaded_classes_out_path.empty();
 
-  std::unique_ptr<FlattenProfileData> flattend_data(new FlattenProfileData());
-  for (const std::string& profile_file : profile_files) {
-    ProfileCompilationInfo profile;
-    if (!profile.Load(profile_file, /*clear_if_invalid=*/ false)) {
-      LOG(ERROR) << "Profile is not a valid: " << profile_file;
-      return false;
+  // Loading the profiles and extracting their data scans all the methods of the dex files for
+  // each profile, so spread the profiles over threads. Each thread flattens a contiguous range
+  // of the profiles, and the partial data is merged in order.
+  size_t num_threads = std::min(
+      std::max<size_t>(profile_files.size(), 1u),
+      static_cast<size_t>(std::max<long>(sysconf(_SC_NPROCESSORS_CONF), 1)));
+  size_t profiles_per_thread = (profile_files.size() + num_threads - 1u) / num_threads;
+  std::vector<std::unique_ptr<FlattenProfileData>> partial_data(num_threads);
+  std::unique_ptr<bool[]> loaded(new bool[num_threads]);
+  auto flatten_range = [&](size_t t) {
+    partial_data[t].reset(new FlattenProfileData());
+    loaded[t] = true;
+    size_t begin = std::min(t * profiles_per_thread, profile_files.size());
+    size_t end = std::min(begin + profiles_per_thread, profile_files.size());
+    for (size_t i = begin; i != end; ++i) {
+      ProfileCompilationInfo profile;
+      if (!profile.Load(profile_files[i], /*clear_if_invalid=*/ false)) {
+        LOG(ERROR) << "Profile is not a valid: " << profile_files[i];
+        loaded[t] = false;
+        return;
+      }
+      std::unique_ptr<FlattenProfileData> currentData = profile.ExtractProfileData(dex_files);
+      partial_data[t]->MergeData(*currentData);
     }
-    std::unique_ptr<FlattenProfileData> currentData = profile.ExtractProfileData(dex_files);
-    flattend_data->MergeData(*currentData);
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(flatten_range, t);
+  }
+  flatten_range(0u);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  if (!std::all_of(loaded.get(), loaded.get() + num_threads, [](bool b) { return b; })) {
+    return false;
+  }
+  std::unique_ptr<FlattenProfileData> flattend_data = std::move(partial_data[0]);
+  for (size_t t = 1; t < num_threads; t++) {
+    flattend_data->MergeData(*partial_data[t]);
+    partial_data[t].reset();
   }
 
   // We want the output sorted by the method/class name.
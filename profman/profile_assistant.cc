@@ -16,6 +16,13 @@
 
 #include "profile_assistant.h"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "base/os.h"
 #include "base/unix_file/fd_file.h"
 
@@ -28,33 +35,18 @@ static constexpr const uint32_t kMinNewMethodsPercentChangeForCompilation = 2;
 static constexpr const uint32_t kMinNewClassesForCompilation = 50;
 static constexpr const uint32_t kMinNewClassesPercentChangeForCompilation = 2;
 
+// Minimum number of current profiles loaded by each merging thread.
+static constexpr size_t kMinProfilesPerThread = 4u;
 
-ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfilesInternal(
-        const std::vector<ScopedFlock>& profile_files,
-        const ScopedFlock& reference_profile_file,
-        const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn,
-        const Options& options) {
-  DCHECK(!profile_files.empty());
-
-  ProfileCompilationInfo info(options.IsBootImageMerge());
-
-  // Load the reference profile.
-  if (!info.Load(reference_profile_file->Fd(), /*merge_classes=*/ true, filter_fn)) {
-    LOG(WARNING) << "Could not load reference profile file";
-    return kErrorBadProfiles;
-  }
-
-  if (options.IsBootImageMerge() && !info.IsForBootImage()) {
-    LOG(WARNING) << "Requested merge for boot image profile but the reference profile is regular.";
-    return kErrorBadProfiles;
-  }
-
-  // Store the current state of the reference profile before merging with the current profiles.
-  uint32_t number_of_methods = info.GetNumberOfMethods();
-  uint32_t number_of_classes = info.GetNumberOfResolvedClasses();
-
-  // Merge all current profiles.
-  for (size_t i = 0; i < profile_files.size(); i++) {
+ProfileAssistant::ProcessingResult ProfileAssistant::MergeProfiles(
+    const std::vector<ScopedFlock>& profile_files,
+    size_t begin,
+    size_t end,
+    const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn,
+    const Options& options,
+    /*inout*/ProfileCompilationInfo* info,
+    /*out*/size_t* error_index) {
+  for (size_t i = begin; i < end; i++) {
     ProfileCompilationInfo cur_info;
     if (!cur_info.Load(profile_files[i]->Fd(), /*merge_classes=*/ true, filter_fn)) {
       LOG(WARNING) << "Could not load profile file at index " << i;
@@ -64,6 +56,7 @@ ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfilesInternal(
         // cleared lazily.
         continue;
       }
+      *error_index = i;
       return kErrorBadProfiles;
     }
 
@@ -71,22 +64,106 @@ ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfilesInternal(
     // This may happen during profile analysis if one profile is regular and
     // the other one is for the boot image. For example when switching on-off
     // the boot image profiles.
-    if (!info.SameVersion(cur_info)) {
+    if (!info->SameVersion(cur_info)) {
       if (options.IsForceMerge()) {
         // If we have to merge forcefully, ignore the current profile and
         // continue to the next one.
         continue;
       } else {
         // Otherwise, return an error.
+        *error_index = i;
         return kErrorDifferentVersions;
       }
     }
 
-    if (!info.MergeWith(cur_info)) {
+    if (!info->MergeWith(cur_info)) {
       LOG(WARNING) << "Could not merge profile file at index " << i;
+      *error_index = i;
       return kErrorBadProfiles;
     }
   }
+  return kSuccess;
+}
+
+
+ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfilesInternal(
+        const std::vector<ScopedFlock>& profile_files,
+        const ScopedFlock& reference_profile_file,
+        const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn,
+        const Options& options) {
+  DCHECK(!profile_files.empty());
+
+  ProfileCompilationInfo info(options.IsBootImageMerge());
+
+  // Load the reference profile.
+  if (!info.Load(reference_profile_file->Fd(), /*merge_classes=*/ true, filter_fn)) {
+    LOG(WARNING) << "Could not load reference profile file";
+    return kErrorBadProfiles;
+  }
+
+  if (options.IsBootImageMerge() && !info.IsForBootImage()) {
+    LOG(WARNING) << "Requested merge for boot image profile but the reference profile is regular.";
+    return kErrorBadProfiles;
+  }
+
+  // Store the current state of the reference profile before merging with the current profiles.
+  uint32_t number_of_methods = info.GetNumberOfMethods();
+  uint32_t number_of_classes = info.GetNumberOfResolvedClasses();
+
+  // Merge all current profiles. Each thread loads and merges a contiguous range of the profiles,
+  // the first one directly into the reference profile. The partial results are then merged
+  // pairwise, so that the data is merged in the same order as when merging one profile at a time.
+  size_t num_threads = std::min(
+      std::max<size_t>(profile_files.size() / kMinProfilesPerThread, 1u),
+      static_cast<size_t>(std::max<long>(sysconf(_SC_NPROCESSORS_CONF), 1)));
+  size_t profiles_per_thread = (profile_files.size() + num_threads - 1u) / num_threads;
+  std::vector<std::unique_ptr<ProfileCompilationInfo>> partial_infos(num_threads);
+  std::vector<ProfileCompilationInfo*> infos(num_threads, &info);
+  for (size_t t = 1; t < num_threads; t++) {
+    partial_infos[t].reset(new ProfileCompilationInfo(info.IsForBootImage()));
+    infos[t] = partial_infos[t].get();
+  }
+  std::vector<ProcessingResult> results(num_threads, kSuccess);
+  std::vector<size_t> error_indexes(num_threads, 0u);
+  auto merge_range = [&](size_t t) {
+    size_t begin = std::min(t * profiles_per_thread, profile_files.size());
+    size_t end = std::min(begin + profiles_per_thread, profile_files.size());
+    results[t] =
+        MergeProfiles(profile_files, begin, end, filter_fn, options, infos[t], &error_indexes[t]);
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(merge_range, t);
+  }
+  merge_range(0u);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  // Report the error of the first profile which failed, as when merging sequentially.
+  for (size_t t = 0; t < num_threads; t++) {
+    if (results[t] != kSuccess) {
+      return results[t];
+    }
+  }
+  for (size_t stride = 1; stride < num_threads; stride *= 2) {
+    threads.clear();
+    for (size_t t = 0; t + stride < num_threads; t += 2 * stride) {
+      threads.emplace_back([&, t, stride]() {
+        if (!infos[t]->MergeWith(*infos[t + stride])) {
+          LOG(WARNING) << "Could not merge profile files from index "
+                       << (t + stride) * profiles_per_thread;
+          results[t] = kErrorBadProfiles;
+        }
+        partial_infos[t + stride].reset();
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+  if (std::find(results.begin(), results.end(), kErrorBadProfiles) != results.end()) {
+    return kErrorBadProfiles;
+  }
 
   // If we perform a forced merge do not analyze the difference between profiles.
   if (!options.IsForceMerge()) {
@@ -100,6 +100,17 @@ class ProfileAssistant {
       const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn,
       const Options& options);
 
+  // Loads the profiles in [begin, end) of `profile_files` and merges them into `info`. On
+  // failure, sets `error_index` to the index of the profile which could not be merged.
+  static ProcessingResult MergeProfiles(
+      const std::vector<ScopedFlock>& profile_files,
+      size_t begin,
+      size_t end,
+      const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn,
+      const Options& options,
+      /*inout*/ProfileCompilationInfo* info,
+      /*out*/size_t* error_index);
+
   DISALLOW_COPY_AND_ASSIGN(ProfileAssistant);
 };
 
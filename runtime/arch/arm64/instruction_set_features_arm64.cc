@@ -119,6 +119,16 @@ Arm64FeaturesUniquePtr Arm64InstructionSetFeatures::FromVariant(
   // Currently there are no cpu variants which support SVE.
   bool has_sve = false;
 
+  static const char* arm64_in_order_variants[] = {
+      "cortex-a35",
+      "cortex-a53",
+      "cortex-a55",
+  };
+
+  bool is_in_order = FindVariantInArray(arm64_in_order_variants,
+                                        arraysize(arm64_in_order_variants),
+                                        variant);
+
   if (!needs_a53_835769_fix) {
     // Check to see if this is an expected variant.
     static const char* arm64_known_variants[] = {
@@ -147,7 +157,8 @@ Arm64FeaturesUniquePtr Arm64InstructionSetFeatures::FromVariant(
                                                                 has_lse,
                                                                 has_fp16,
                                                                 has_dotprod,
-                                                                has_sve));
+                                                                has_sve,
+                                                                is_in_order));
 }
 
 Arm64FeaturesUniquePtr Arm64InstructionSetFeatures::FromBitmap(uint32_t bitmap) {
@@ -395,7 +406,8 @@ Arm64InstructionSetFeatures::AddFeaturesFromSplitString(
                                       has_lse,
                                       has_fp16,
                                       has_dotprod,
-                                      has_sve));
+                                      has_sve,
+                                      is_in_order_));
 }
 
 std::unique_ptr<const InstructionSetFeatures>
@@ -409,7 +421,8 @@ Arm64InstructionSetFeatures::AddRuntimeDetectedFeatures(
                                       arm64_features->has_lse_,
                                       arm64_features->has_fp16_,
                                       arm64_features->has_dotprod_,
-                                      arm64_features->has_sve_));
+                                      arm64_features->has_sve_,
+                                      is_in_order_));
 }
 
 }  // namespace art
@@ -94,6 +94,12 @@ class Arm64InstructionSetFeatures final : public InstructionSetFeatures {
     return has_sve_;
   }
 
+  // Is the variant an in-order core, like the Cortex-A55? This only tunes the generated code,
+  // so it is neither encoded in the bitmap nor compared by Equals.
+  bool IsInOrder() const {
+    return is_in_order_;
+  }
+
   virtual ~Arm64InstructionSetFeatures() {}
 
  protected:
@@ -112,7 +118,8 @@ class Arm64InstructionSetFeatures final : public InstructionSetFeatures {
                               bool has_lse,
                               bool has_fp16,
                               bool has_dotprod,
-                              bool has_sve)
+                              bool has_sve,
+                              bool is_in_order = false)
       : InstructionSetFeatures(),
         fix_cortex_a53_835769_(needs_a53_835769_fix),
         fix_cortex_a53_843419_(needs_a53_843419_fix),
@@ -120,7 +127,8 @@ class Arm64InstructionSetFeatures final : public InstructionSetFeatures {
         has_lse_(has_lse),
         has_fp16_(has_fp16),
         has_dotprod_(has_dotprod),
-        has_sve_(has_sve) {
+        has_sve_(has_sve),
+        is_in_order_(is_in_order) {
   }
 
   // Bitmap positions for encoding features as a bitmap.
@@ -140,6 +148,7 @@ class Arm64InstructionSetFeatures final : public InstructionSetFeatures {
   const bool has_fp16_;     // ARMv8.2 FP16 extensions.
   const bool has_dotprod_;  // optional in ARMv8.2, mandatory in ARMv8.4.
   const bool has_sve_;      // optional in ARMv8.2.
+  const bool is_in_order_;  // instruction scheduling hint from the variant.
 
   DISALLOW_COPY_AND_ASSIGN(Arm64InstructionSetFeatures);
 };
@@ -88,6 +88,7 @@ enum LockLevel : uint8_t {
   kJitDebugInterfaceLock,
   kBumpPointerSpaceBlockLock,
   kArenaPoolLock,
+  kInternTableShardLock,
   kInternTableLock,
   kOatFileSecondaryLookupLock,
   kHostDlOpenHandlesLock,
@@ -299,8 +300,9 @@ class Locks {
   // Guards dlopen_handles_ in DlOpenOatFile.
   static Mutex* host_dlopen_handles_lock_ ACQUIRED_AFTER(verifier_deps_lock_);
 
-  // Guards intern table.
-  static Mutex* intern_table_lock_ ACQUIRED_AFTER(host_dlopen_handles_lock_);
+  // Guards intern table. Held shared with the lock of a shard to intern strings in the shard, and
+  // exclusively to access all shards.
+  static ReaderWriterMutex* intern_table_lock_ ACQUIRED_AFTER(host_dlopen_handles_lock_);
 
   // Guards reference processor.
   static Mutex* reference_processor_lock_ ACQUIRED_AFTER(intern_table_lock_);
@@ -320,14 +322,10 @@ class Locks {
   // Guards soft references queue.
   static Mutex* reference_queue_soft_references_lock_ ACQUIRED_AFTER(reference_queue_phantom_references_lock_);
 
-  // Guard accesses to the JNI Global Reference table.
-  static ReaderWriterMutex* jni_globals_lock_ ACQUIRED_AFTER(reference_queue_soft_references_lock_);
-
-  // Guard accesses to the JNI Weak Global Reference table.
-  static Mutex* jni_weak_globals_lock_ ACQUIRED_AFTER(jni_globals_lock_);
-
-  // Guard accesses to the JNI function table override.
-  static Mutex* jni_function_table_lock_ ACQUIRED_AFTER(jni_weak_globals_lock_);
+  // Guard accesses to the JNI function table override. The JNI global and weak global reference
+  // tables are guarded by the locks of their shards in JavaVMExt, at kJniGlobalsLock and
+  // kJniWeakGlobalsLock.
+  static Mutex* jni_function_table_lock_ ACQUIRED_AFTER(reference_queue_soft_references_lock_);
 
   // Guard accesses to the Thread::custom_tls_. We use this to allow the TLS of other threads to be
   // read (the reader must hold the ThreadListLock or have some other way of ensuring the thread
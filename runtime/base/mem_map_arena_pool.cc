@@ -105,9 +105,15 @@ Arena* MemMapArenaPool::AllocArena(size_t size) {
   Arena* ret = nullptr;
   {
     std::lock_guard<std::mutex> lock(lock_);
-    if (free_arenas_ != nullptr && LIKELY(free_arenas_->Size() >= size)) {
-      ret = free_arenas_;
-      free_arenas_ = free_arenas_->next_;
+    // Take the first free arena that is big enough. Most arenas have the default size,
+    // so this usually stops at the head, but a bigger request should not force a new
+    // allocation while a suitable arena sits further down the list.
+    for (Arena** link = &free_arenas_; *link != nullptr; link = &(*link)->next_) {
+      if (LIKELY((*link)->Size() >= size)) {
+        ret = *link;
+        *link = ret->next_;
+        break;
+      }
     }
   }
   if (ret == nullptr) {
@@ -119,10 +125,25 @@ Arena* MemMapArenaPool::AllocArena(size_t size) {
 
 void MemMapArenaPool::TrimMaps() {
   ScopedTrace trace(__PRETTY_FUNCTION__);
-  std::lock_guard<std::mutex> lock(lock_);
-  for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
+  // Detach the free arenas and madvise them without holding the lock, so that compiler
+  // threads allocating or freeing arenas do not wait for the system calls.
+  Arena* first;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    first = free_arenas_;
+    free_arenas_ = nullptr;
+  }
+  if (first == nullptr) {
+    return;
+  }
+  Arena* last = first;
+  for (Arena* arena = first; arena != nullptr; arena = arena->next_) {
     arena->Release();
+    last = arena;
   }
+  std::lock_guard<std::mutex> lock(lock_);
+  last->next_ = free_arenas_;
+  free_arenas_ = first;
 }
 
 size_t MemMapArenaPool::GetBytesAllocated() const {
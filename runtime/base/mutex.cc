@@ -28,7 +28,9 @@
 #include "base/systrace.h"
 #include "base/time_utils.h"
 #include "base/value_object.h"
+#include "lock_contention_sampler.h"
 #include "mutex-inl.h"
+#include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
 
@@ -151,6 +153,17 @@ class ScopedAllMutexesLock final {
   const BaseMutex* const mutex_;
 };
 
+// Returns the sampler to record this contention on `mutex` into, or null. Monitor locks are
+// sampled by Monitor, which knows the Java methods involved.
+static LockContentionSampler* GetContentionSampler(BaseMutex* mutex) {
+  Runtime* runtime = Runtime::Current();
+  if (runtime == nullptr || mutex->GetLevel() == kMonitorLock) {
+    return nullptr;
+  }
+  LockContentionSampler* sampler = runtime->GetLockContentionSampler();
+  return (sampler != nullptr && sampler->ShouldSample()) ? sampler : nullptr;
+}
+
 // Scoped class that generates events at the beginning and end of lock contention.
 class ScopedContentionRecorder final : public ValueObject {
  public:
@@ -158,7 +171,12 @@ class ScopedContentionRecorder final : public ValueObject {
       : mutex_(kLogLockContentions ? mutex : nullptr),
         blocked_tid_(kLogLockContentions ? blocked_tid : 0),
         owner_tid_(kLogLockContentions ? owner_tid : 0),
-        start_nano_time_(kLogLockContentions ? NanoTime() : 0) {
+        start_nano_time_(kLogLockContentions ? NanoTime() : 0),
+        sampler_(GetContentionSampler(mutex)),
+        sampled_name_(mutex->GetName()),
+        sampled_blocked_tid_(static_cast<pid_t>(blocked_tid)),
+        sampled_owner_tid_(static_cast<pid_t>(owner_tid)),
+        sampled_start_nano_time_(sampler_ != nullptr ? NanoTime() : 0) {
     if (ATraceEnabled()) {
       std::string msg = StringPrintf("Lock contention on %s (owner tid: %" PRIu64 ")",
                                      mutex->GetName(), owner_tid);
@@ -172,6 +190,12 @@ class ScopedContentionRecorder final : public ValueObject {
       uint64_t end_nano_time = NanoTime();
       mutex_->RecordContention(blocked_tid_, owner_tid_, end_nano_time - start_nano_time_);
     }
+    if (sampler_ != nullptr) {
+      sampler_->RecordLockContention(sampled_name_,
+                                     sampled_blocked_tid_,
+                                     sampled_owner_tid_,
+                                     NanoTime() - sampled_start_nano_time_);
+    }
   }
 
  private:
@@ -179,6 +203,11 @@ class ScopedContentionRecorder final : public ValueObject {
   const uint64_t blocked_tid_;
   const uint64_t owner_tid_;
   const uint64_t start_nano_time_;
+  LockContentionSampler* const sampler_;
+  const char* const sampled_name_;
+  const pid_t sampled_blocked_tid_;
+  const pid_t sampled_owner_tid_;
+  const uint64_t sampled_start_nano_time_;
 };
 
 BaseMutex::BaseMutex(const char* name, LockLevel level)
@@ -522,12 +551,11 @@ bool Mutex::ExclusiveTryLock(Thread* self) {
   return true;
 }
 
-bool Mutex::ExclusiveTryLockWithSpinning(Thread* self) {
+bool Mutex::ExclusiveTryLockWithSpinning(Thread* self, int max_spins) {
   // Spin a small number of times, since this affects our ability to respond to suspension
   // requests. We spin repeatedly only if the mutex repeatedly becomes available and unavailable
   // in rapid succession, and then we will typically not spin for the maximal period.
-  const int kMaxSpins = 5;
-  for (int i = 0; i < kMaxSpins; ++i) {
+  for (int i = 0; i < max_spins; ++i) {
     if (ExclusiveTryLock(self)) {
       return true;
     }
@@ -79,6 +79,10 @@ class BaseMutex {
     return name_;
   }
 
+  LockLevel GetLevel() const {
+    return level_;
+  }
+
   virtual bool IsMutex() const { return false; }
   virtual bool IsReaderWriterMutex() const { return false; }
   virtual bool IsMutatorMutex() const { return false; }
@@ -183,8 +187,11 @@ class LOCKABLE Mutex : public BaseMutex {
   // Returns true if acquires exclusive access, false otherwise.
   bool ExclusiveTryLock(Thread* self) TRY_ACQUIRE(true);
   bool TryLock(Thread* self) TRY_ACQUIRE(true) { return ExclusiveTryLock(self); }
-  // Equivalent to ExclusiveTryLock, but retry for a short period before giving up.
-  bool ExclusiveTryLockWithSpinning(Thread* self) TRY_ACQUIRE(true);
+  // Equivalent to ExclusiveTryLock, but retry for a short period before giving up. The period
+  // is up to `max_spins` brief waits for the mutex to be released.
+  bool ExclusiveTryLockWithSpinning(Thread* self, int max_spins = kDefaultMaxSpins)
+      TRY_ACQUIRE(true);
+  static constexpr int kDefaultMaxSpins = 5;
 
   // Release exclusive access.
   void ExclusiveUnlock(Thread* self) RELEASE();
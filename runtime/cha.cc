@@ -212,7 +212,7 @@ class CHAStackVisitor final  : public StackVisitor {
       // This compiled version doesn't have should_deoptimize flag. Skip.
       return true;
     }
-    auto it = std::find(method_headers_.begin(), method_headers_.end(), method_header);
+    auto it = method_headers_.find(const_cast<OatQuickMethodHeader*>(method_header));
     if (it == method_headers_.end()) {
       // Not in the list of method headers that should be deoptimized.
       return true;
@@ -668,13 +668,16 @@ void ClassHierarchyAnalysis::InvalidateSingleImplementationMethods(
           for (const auto& dependent : GetDependents(invalidated)) {
             ArtMethod* method = dependent.first;;
             OatQuickMethodHeader* method_header = dependent.second;
+            if (!dependent_method_headers.insert(method_header).second) {
+              // Already invalidated because of another method of `invalidated_single_impl_methods`.
+              continue;
+            }
             VLOG(class_linker) << "CHA invalidated compiled code for " << method->PrettyMethod();
             DCHECK(runtime->UseJitCompilation());
             // We need to call JitCodeCache::InvalidateCompiledCodeFor but we cannot do it here
             // since it would run into problems with lock-ordering. We don't want to re-order the
             // locks since that would make code-commit racy.
             headers.push_back({method, method_header});
-            dependent_method_headers.insert(method_header);
           }
           RemoveAllDependenciesFor(invalidated);
         }
@@ -697,7 +700,8 @@ void ClassHierarchyAnalysis::InvalidateSingleImplementationMethods(
     }
     // Deoptimze compiled code on stack that should have been invalidated.
     CHACheckpoint checkpoint(dependent_method_headers);
-    size_t threads_running_checkpoint = runtime->GetThreadList()->RunCheckpoint(&checkpoint);
+    size_t threads_running_checkpoint = runtime->GetThreadList()->RunCheckpoint(
+        &checkpoint, /* callback= */ nullptr, ThreadList::MayRunManagedCode);
     if (threads_running_checkpoint != 0) {
       checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
     }
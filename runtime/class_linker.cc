@@ -42,6 +42,7 @@
 #include "base/file_utils.h"
 #include "base/leb128.h"
 #include "base/logging.h"
+#include "base/membarrier.h"
 #include "base/mutex-inl.h"
 #include "base/os.h"
 #include "base/quasi_atomic.h"
@@ -57,11 +58,13 @@
 #include "cha.h"
 #include "class_linker-inl.h"
 #include "class_loader_utils.h"
+#include "class_path_index.h"
 #include "class_root.h"
 #include "class_table-inl.h"
 #include "compiler_callbacks.h"
 #include "debug_print.h"
 #include "debugger.h"
+#include "descriptor_bloom_filter.h"
 #include "dex/class_accessor-inl.h"
 #include "dex/descriptors_names.h"
 #include "dex/dex_file-inl.h"
@@ -86,6 +89,7 @@
 #include "image-inl.h"
 #include "imt_conflict_table.h"
 #include "imtable-inl.h"
+#include "index_bss_mapping.h"
 #include "intern_table-inl.h"
 #include "interpreter/interpreter.h"
 #include "jit/debugger_interface.h"
@@ -140,6 +144,7 @@
 #include "thread-inl.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "transaction.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
@@ -298,7 +303,23 @@ class ClassLinker::VisiblyInitializedCallback final
 
   void MakeVisible(Thread* self) {
     DCHECK_EQ(thread_visibility_counter_.load(std::memory_order_relaxed), 0);
+    uint64_t start_ns = NanoTime();
+    if (class_linker_->visibly_initialize_classes_with_membarrier_ &&
+        art::membarrier(MembarrierCommand::kPrivateExpedited) == 0) {
+      // All running threads of this process have executed a memory barrier, so we do not
+      // need to wait for a checkpoint before marking the classes as visibly initialized.
+      class_linker_->visibly_initialized_membarrier_batches_.fetch_add(
+          1u, std::memory_order_relaxed);
+      class_linker_->visibly_initialized_time_ns_.fetch_add(
+          NanoTime() - start_ns, std::memory_order_relaxed);
+      MarkVisiblyInitialized(self);
+      return;
+    }
+    class_linker_->visibly_initialized_checkpoint_batches_.fetch_add(
+        1u, std::memory_order_relaxed);
     size_t count = Runtime::Current()->GetThreadList()->RunCheckpoint(this);
+    class_linker_->visibly_initialized_time_ns_.fetch_add(
+        NanoTime() - start_ns, std::memory_order_relaxed);
     AdjustThreadVisibilityCounter(self, count);
   }
 
@@ -312,23 +333,29 @@ class ClassLinker::VisiblyInitializedCallback final
     ssize_t old = thread_visibility_counter_.fetch_add(adjustment, std::memory_order_relaxed);
     if (old + adjustment == 0) {
       // All threads passed the checkpoint. Mark classes as visibly initialized.
-      {
-        ScopedObjectAccess soa(self);
-        StackHandleScope<1u> hs(self);
-        MutableHandle<mirror::Class> klass = hs.NewHandle<mirror::Class>(nullptr);
-        JavaVMExt* vm = self->GetJniEnv()->GetVm();
-        for (size_t i = 0, num = num_classes_; i != num; ++i) {
-          klass.Assign(ObjPtr<mirror::Class>::DownCast(self->DecodeJObject(classes_[i])));
-          vm->DeleteWeakGlobalRef(self, classes_[i]);
-          if (klass != nullptr) {
-            mirror::Class::SetStatus(klass, ClassStatus::kVisiblyInitialized, self);
-            class_linker_->FixupStaticTrampolines(klass.Get());
-          }
+      MarkVisiblyInitialized(self);
+    }
+  }
+
+  void MarkVisiblyInitialized(Thread* self) {
+    {
+      ScopedObjectAccess soa(self);
+      StackHandleScope<1u> hs(self);
+      MutableHandle<mirror::Class> klass = hs.NewHandle<mirror::Class>(nullptr);
+      JavaVMExt* vm = self->GetJniEnv()->GetVm();
+      for (size_t i = 0, num = num_classes_; i != num; ++i) {
+        klass.Assign(ObjPtr<mirror::Class>::DownCast(self->DecodeJObject(classes_[i])));
+        vm->DeleteWeakGlobalRef(self, classes_[i]);
+        if (klass != nullptr) {
+          mirror::Class::SetStatus(klass, ClassStatus::kVisiblyInitialized, self);
+          class_linker_->FixupStaticTrampolines(klass.Get());
         }
-        num_classes_ = 0u;
       }
-      class_linker_->VisiblyInitializedCallbackDone(self, this);
+      class_linker_->visibly_initialized_classes_.fetch_add(num_classes_,
+                                                            std::memory_order_relaxed);
+      num_classes_ = 0u;
     }
+    class_linker_->VisiblyInitializedCallbackDone(self, this);
   }
 
   static constexpr size_t kMaxClasses = 16;
@@ -348,6 +375,15 @@ class ClassLinker::VisiblyInitializedCallback final
   std::forward_list<Barrier*> barriers_;
 };
 
+static bool RegisterMembarrierForVisiblyInitialized() {
+  if (kRuntimeISA == InstructionSet::kX86 || kRuntimeISA == InstructionSet::kX86_64) {
+    return false;  // Not needed, classes skip the initialized status.
+  }
+  // MEMBARRIER_CMD_PRIVATE_EXPEDITED issues a memory barrier on all running threads of
+  // the process, which is all we need from the checkpoint in `MakeVisible()`.
+  return art::membarrier(MembarrierCommand::kRegisterPrivateExpedited) == 0;
+}
+
 void ClassLinker::MakeInitializedClassesVisiblyInitialized(Thread* self, bool wait) {
   if (kRuntimeISA == InstructionSet::kX86 || kRuntimeISA == InstructionSet::kX86_64) {
     return;  // Nothing to do. Thanks to the x86 memory model classes skip the initialized status.
@@ -621,8 +657,14 @@ static void ShuffleForward(size_t* current_field_idx,
 }
 
 ClassLinker::ClassLinker(InternTable* intern_table, bool fast_class_not_found_exceptions)
-    : boot_class_table_(new ClassTable()),
+    : boot_class_path_filter_(nullptr),
+      boot_class_table_(new ClassTable()),
       failed_dex_cache_class_lookups_(0),
+      dex_cache_string_misses_(0u),
+      dex_cache_type_misses_(0u),
+      dex_cache_field_misses_(0u),
+      dex_cache_method_misses_(0u),
+      dex_cache_method_type_misses_(0u),
       class_roots_(nullptr),
       find_array_class_cache_next_victim_(0),
       init_done_(false),
@@ -638,6 +680,11 @@ ClassLinker::ClassLinker(InternTable* intern_table, bool fast_class_not_found_ex
       image_pointer_size_(kRuntimePointerSize),
       visibly_initialized_callback_lock_("visibly initialized callback lock"),
       visibly_initialized_callback_(nullptr),
+      visibly_initialize_classes_with_membarrier_(RegisterMembarrierForVisiblyInitialized()),
+      visibly_initialized_membarrier_batches_(0u),
+      visibly_initialized_checkpoint_batches_(0u),
+      visibly_initialized_classes_(0u),
+      visibly_initialized_time_ns_(0u),
       cha_(Runtime::Current()->IsAotCompiler() ? nullptr : new ClassHierarchyAnalysis()) {
   // For CHA disabled during Aot, see b/34193647.
 
@@ -1445,24 +1492,16 @@ size_t CountInternedStringReferences(gc::space::ImageSpace& space,
   return visitor.GetCount();
 }
 
+// Visits the string references in [begin, end) of the image string reference offsets.
 template <typename Visitor>
 static void VisitInternedStringReferences(
     gc::space::ImageSpace* space,
+    const AppImageReferenceOffsetInfo* sro_base,
+    size_t begin,
+    size_t end,
     bool use_preresolved_strings,
     const Visitor& visitor) REQUIRES_SHARED(Locks::mutator_lock_) {
-  const uint8_t* target_base = space->Begin();
-  const ImageSection& sro_section =
-      space->GetImageHeader().GetImageStringReferenceOffsetsSection();
-  const size_t num_string_offsets = sro_section.Size() / sizeof(AppImageReferenceOffsetInfo);
-
-  VLOG(image)
-      << "ClassLinker:AppImage:InternStrings:imageStringReferenceOffsetCount = "
-      << num_string_offsets;
-
-  const auto* sro_base =
-      reinterpret_cast<const AppImageReferenceOffsetInfo*>(target_base + sro_section.Offset());
-
-  for (size_t offset_index = 0; offset_index < num_string_offsets; ++offset_index) {
+  for (size_t offset_index = begin; offset_index < end; ++offset_index) {
     uint32_t base_offset = sro_base[offset_index].first;
 
     if (HasDexCacheStringNativeRefTag(base_offset)) {
@@ -1538,6 +1577,49 @@ static void VisitInternedStringReferences(
   }
 }
 
+// Visits the string references recorded in the image. When a thread pool is given, the
+// references are visited in parallel, so the visitor must then be safe to call concurrently.
+template <typename Visitor>
+static void VisitInternedStringReferences(
+    gc::space::ImageSpace* space,
+    bool use_preresolved_strings,
+    const Visitor& visitor,
+    ThreadPool* thread_pool = nullptr) REQUIRES_SHARED(Locks::mutator_lock_) {
+  const uint8_t* target_base = space->Begin();
+  const ImageSection& sro_section =
+      space->GetImageHeader().GetImageStringReferenceOffsetsSection();
+  const size_t num_string_offsets = sro_section.Size() / sizeof(AppImageReferenceOffsetInfo);
+
+  VLOG(image)
+      << "ClassLinker:AppImage:InternStrings:imageStringReferenceOffsetCount = "
+      << num_string_offsets;
+
+  const auto* sro_base =
+      reinterpret_cast<const AppImageReferenceOffsetInfo*>(target_base + sro_section.Offset());
+
+  static constexpr size_t kOffsetsPerTask = 4096u;
+  if (thread_pool == nullptr || num_string_offsets < 2u * kOffsetsPerTask) {
+    VisitInternedStringReferences(
+        space, sro_base, /*begin=*/ 0u, num_string_offsets, use_preresolved_strings, visitor);
+    return;
+  }
+
+  Thread* const self = Thread::Current();
+  std::vector<Task*> tasks;
+  tasks.reserve(RoundUp(num_string_offsets, kOffsetsPerTask) / kOffsetsPerTask);
+  for (size_t begin = 0; begin < num_string_offsets; begin += kOffsetsPerTask) {
+    size_t end = std::min(begin + kOffsetsPerTask, num_string_offsets);
+    tasks.push_back(new FunctionTask([=, &visitor](Thread* worker) {
+      ScopedObjectAccess soa(worker);
+      VisitInternedStringReferences(space, sro_base, begin, end, use_preresolved_strings, visitor);
+    }));
+  }
+  thread_pool->AddTasks(self, tasks);
+  // Go to native since we don't want to suspend while holding the mutator lock.
+  ScopedThreadSuspension sts(self, kNative);
+  thread_pool->Wait(self, /*do_work=*/ true, /*may_hold_locks=*/ false);
+}
+
 static void VerifyInternedStringReferences(gc::space::ImageSpace* space)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   InternTable::UnorderedSet image_interns;
@@ -1742,9 +1824,15 @@ void AppImageLoadingHelper::HandleAppImageStrings(gc::space::ImageSpace* space)
       }
     }
   };
+  uint64_t start_time = NanoTime();
   intern_table->AddImageStringsToTable(space, func);
+  VLOG(image) << "AppImage:Adding interned strings took "
+              << PrettyDuration(NanoTime() - start_time);
   if (!intern_remap.empty()) {
     VLOG(image) << "AppImage:conflictingInternStrings = " << intern_remap.size();
+    start_time = NanoTime();
+    // The remap is only read from here on, so the references can be updated in parallel.
+    Runtime::ScopedThreadPoolUsage stpu;
     VisitInternedStringReferences(
         space,
         load_startup_cache,
@@ -1754,7 +1842,10 @@ void AppImageLoadingHelper::HandleAppImageStrings(gc::space::ImageSpace* space)
             return ObjPtr<mirror::String>(it->second);
           }
           return str;
-        });
+        },
+        stpu.GetThreadPool());
+    VLOG(image) << "AppImage:Remapping conflicting strings took "
+                << PrettyDuration(NanoTime() - start_time);
   }
 }
 
@@ -1999,6 +2090,47 @@ static void VerifyAppImage(const ImageHeader& header,
   }
 }
 
+// Store the classes resolved in `dex_cache` in the .bss type entries of its dex file in
+// `oat_file`. The .bss entries hold the class that the dex cache would resolve the type to, so the
+// compiled code gets the same class as if it had called the runtime. Returns the number of entries
+// filled.
+static size_t FillTypeBssEntriesFromDexCache(const OatFile* oat_file,
+                                             ObjPtr<mirror::DexCache> dex_cache)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  const DexFile* dex_file = dex_cache->GetDexFile();
+  const OatDexFile* oat_dex_file = dex_file->GetOatDexFile();
+  if (oat_dex_file == nullptr ||
+      oat_dex_file->GetOatFile() != oat_file ||
+      oat_dex_file->GetTypeBssMapping() == nullptr) {
+    return 0u;
+  }
+  size_t filled_entries = 0u;
+  mirror::TypeDexCacheType* const types = dex_cache->GetResolvedTypes();
+  for (size_t i = 0, num_types = dex_cache->NumResolvedTypes(); i != num_types; ++i) {
+    mirror::TypeDexCachePair pair = types[i].load(std::memory_order_relaxed);
+    ObjPtr<mirror::Class> klass = pair.object.Read();
+    if (klass == nullptr) {
+      continue;
+    }
+    DCHECK_LT(pair.index, dex_file->NumTypeIds());
+    size_t bss_offset = IndexBssMappingLookup::GetBssOffset(oat_dex_file->GetTypeBssMapping(),
+                                                            pair.index,
+                                                            dex_file->NumTypeIds(),
+                                                            sizeof(GcRoot<mirror::Class>));
+    if (bss_offset == IndexBssMappingLookup::npos) {
+      continue;
+    }
+    DCHECK_ALIGNED(bss_offset, sizeof(GcRoot<mirror::Class>));
+    GcRoot<mirror::Class>* slot = reinterpret_cast<GcRoot<mirror::Class>*>(
+        const_cast<uint8_t*>(oat_file->BssBegin() + bss_offset));
+    if (slot->IsNull()) {
+      *slot = GcRoot<mirror::Class>(klass);
+      ++filled_entries;
+    }
+  }
+  return filled_entries;
+}
+
 bool ClassLinker::AddImageSpace(
     gc::space::ImageSpace* space,
     Handle<mirror::ClassLoader> class_loader,
@@ -2115,34 +2247,32 @@ bool ClassLinker::AddImageSpace(
     }
   }
 
+  // The method fixups below only depend on the method itself, so do them in a single walk
+  // over the methods of the image.
   // Set entry point to interpreter if in InterpretOnly mode.
-  if (!runtime->IsAotCompiler() && runtime->GetInstrumentation()->InterpretOnly()) {
-    // Set image methods' entry point to interpreter.
+  const bool interpret_only =
+      !runtime->IsAotCompiler() && runtime->GetInstrumentation()->InterpretOnly();
+  const bool can_use_nterp = interpreter::CanRuntimeUseNterp();
+  const bool verification_soft_fail = runtime->IsVerificationSoftFail();
+  if (interpret_only || can_use_nterp || verification_soft_fail) {
     header.VisitPackedArtMethods([&](ArtMethod& method) REQUIRES_SHARED(Locks::mutator_lock_) {
-      if (!method.IsRuntimeMethod()) {
+      // Set image methods' entry point to interpreter.
+      if (interpret_only && !method.IsRuntimeMethod()) {
         DCHECK(method.GetDeclaringClass() != nullptr);
         if (!method.IsNative() && !method.IsResolutionMethod()) {
           method.SetEntryPointFromQuickCompiledCodePtrSize(GetQuickToInterpreterBridge(),
                                                             image_pointer_size_);
         }
       }
-    }, space->Begin(), image_pointer_size_);
-  }
-
-  if (interpreter::CanRuntimeUseNterp()) {
-    // Set image methods' entry point that point to the interpreter bridge to the nterp entry point.
-    header.VisitPackedArtMethods([&](ArtMethod& method) REQUIRES_SHARED(Locks::mutator_lock_) {
-      if (IsQuickToInterpreterBridge(method.GetEntryPointFromQuickCompiledCode()) &&
+      // Set image methods' entry point that point to the interpreter bridge to the nterp entry
+      // point.
+      if (can_use_nterp &&
+          IsQuickToInterpreterBridge(method.GetEntryPointFromQuickCompiledCode()) &&
           interpreter::CanMethodUseNterp(&method)) {
         method.SetEntryPointFromQuickCompiledCodePtrSize(interpreter::GetNterpEntryPoint(),
                                                          image_pointer_size_);
       }
-    }, space->Begin(), image_pointer_size_);
-  }
-
-  if (runtime->IsVerificationSoftFail()) {
-    header.VisitPackedArtMethods([&](ArtMethod& method) REQUIRES_SHARED(Locks::mutator_lock_) {
-      if (!method.IsNative() && method.IsInvokable()) {
+      if (verification_soft_fail && !method.IsNative() && method.IsInvokable()) {
         method.ClearSkipAccessChecks();
       }
     }, space->Begin(), image_pointer_size_);
@@ -2167,8 +2297,11 @@ bool ClassLinker::AddImageSpace(
     VLOG(image) << "Adding class table classes took " << PrettyDuration(NanoTime() - start_time2);
   }
   if (app_image) {
+    uint64_t phase_start_time = NanoTime();
     AppImageLoadingHelper::Update(this, space, class_loader, dex_caches, &temp_set);
+    VLOG(image) << "AppImage:Updating took " << PrettyDuration(NanoTime() - phase_start_time);
 
+    phase_start_time = NanoTime();
     {
       ScopedTrace trace("AppImage:UpdateClassLoaders");
       // Update class loader and resolved strings. If added_class_table is false, the resolved
@@ -2186,6 +2319,8 @@ bool ClassLinker::AddImageSpace(
         }
       }
     }
+    VLOG(image) << "AppImage:UpdateClassLoaders took "
+                << PrettyDuration(NanoTime() - phase_start_time);
 
     if (kBitstringSubtypeCheckEnabled) {
       // Every class in the app image has initially SubtypeCheckInfo in the
@@ -2209,11 +2344,28 @@ bool ClassLinker::AddImageSpace(
   if (!oat_file->GetBssGcRoots().empty()) {
     // Insert oat file to class table for visiting .bss GC roots.
     class_table->InsertOatFile(oat_file);
+    if (app_image && oat_file->IsExecutable()) {
+      // The compiled code loads classes from .bss entries and only calls the runtime when the
+      // entry is null. Fill the entries of the classes that are already resolved, mostly
+      // initialized, in the app image so that they do not take the slow path once per entry.
+      ScopedTrace trace("AppImage:FillTypeBssEntries");
+      size_t filled_entries = 0u;
+      for (auto dex_cache : dex_caches.Iterate<mirror::DexCache>()) {
+        filled_entries += FillTypeBssEntriesFromDexCache(oat_file, dex_cache);
+      }
+      if (filled_entries != 0u) {
+        // We need a write barrier for the class loader that holds the GC roots in the .bss.
+        WriteBarrier::ForEveryFieldWrite(class_loader.Get());
+      }
+      VLOG(image) << "AppImage:FillTypeBssEntries filled " << filled_entries << " entries";
+    }
   }
 
   if (added_class_table) {
+    uint64_t phase_start_time = NanoTime();
     WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
     class_table->AddClassSet(std::move(temp_set));
+    VLOG(image) << "Adding class set took " << PrettyDuration(NanoTime() - phase_start_time);
   }
 
   if (kIsDebugBuild && app_image) {
@@ -2902,7 +3054,9 @@ ObjPtr<mirror::Class> ClassLinker::FindClassInBootClassLoaderClassPath(Thread* s
                                                                        const char* descriptor,
                                                                        size_t hash) {
   ObjPtr<mirror::Class> result = nullptr;
-  ClassPathEntry pair = FindInClassPath(descriptor, hash, boot_class_path_);
+  ClassPathEntry pair = MayBeInBootClassPath(hash)
+      ? FindInClassPath(descriptor, hash, boot_class_path_)
+      : ClassPathEntry(nullptr, nullptr);
   if (pair.second != nullptr) {
     ObjPtr<mirror::Class> klass = LookupClass(self, descriptor, hash, nullptr);
     if (klass != nullptr) {
@@ -2956,10 +3110,53 @@ ObjPtr<mirror::Class> ClassLinker::FindClassInBaseDexClassLoaderClassPath(
     return true;  // Continue with the next DexFile.
   };
 
-  VisitClassLoaderDexFiles(soa, class_loader, define_class);
+  const ClassPathIndex* class_path_index = GetClassPathIndex(soa, class_loader);
+  if (class_path_index != nullptr) {
+    class_path_index->VisitCandidates(static_cast<uint32_t>(hash), define_class);
+  } else {
+    VisitClassLoaderDexFiles(soa, class_loader, define_class);
+  }
   return ret;
 }
 
+const ClassPathIndex* ClassLinker::GetClassPathIndex(ScopedObjectAccessAlreadyRunnable& soa,
+                                                     Handle<mirror::ClassLoader> class_loader) {
+  ClassTable* const class_table = ClassTableForClassLoader(class_loader.Get());
+  if (class_table == nullptr) {
+    return nullptr;
+  }
+  // Check that the dex files of the class loader did not change since they were indexed.
+  const ClassPathIndex* class_path_index = class_table->GetClassPathIndex();
+  bool up_to_date = (class_path_index != nullptr);
+  size_t num_dex_files = 0u;
+  VisitClassLoaderDexFiles(soa,
+                           class_loader,
+                           [&](const DexFile* dex_file) REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (up_to_date &&
+        (num_dex_files == class_path_index->GetDexFiles().size() ||
+         class_path_index->GetDexFiles()[num_dex_files] != dex_file)) {
+      up_to_date = false;
+    }
+    ++num_dex_files;
+    return true;  // Continue with the next DexFile.
+  });
+  if (up_to_date && num_dex_files == class_path_index->GetDexFiles().size()) {
+    return class_path_index;
+  }
+  if (num_dex_files < ClassPathIndex::kMinDexFiles) {
+    return nullptr;
+  }
+  std::vector<const DexFile*> dex_files;
+  dex_files.reserve(num_dex_files);
+  VisitClassLoaderDexFiles(soa,
+                           class_loader,
+                           [&](const DexFile* dex_file) REQUIRES_SHARED(Locks::mutator_lock_) {
+    dex_files.push_back(dex_file);
+    return true;  // Continue with the next DexFile.
+  });
+  return class_table->SetClassPathIndex(std::make_unique<ClassPathIndex>(std::move(dex_files)));
+}
+
 ObjPtr<mirror::Class> ClassLinker::FindClass(Thread* self,
                                              const char* descriptor,
                                              Handle<mirror::ClassLoader> class_loader) {
@@ -2981,7 +3178,9 @@ ObjPtr<mirror::Class> ClassLinker::FindClass(Thread* self,
   // Class is not yet loaded.
   if (descriptor[0] != '[' && class_loader == nullptr) {
     // Non-array class and the boot class loader, search the boot class path.
-    ClassPathEntry pair = FindInClassPath(descriptor, hash, boot_class_path_);
+    ClassPathEntry pair = MayBeInBootClassPath(hash)
+        ? FindInClassPath(descriptor, hash, boot_class_path_)
+        : ClassPathEntry(nullptr, nullptr);
     if (pair.second != nullptr) {
       return DefineClass(self,
                          descriptor,
@@ -3951,11 +4150,42 @@ void ClassLinker::AppendToBootClassPath(const DexFile* dex_file,
                                         ObjPtr<mirror::DexCache> dex_cache) {
   CHECK(dex_file != nullptr);
   CHECK(dex_cache != nullptr) << dex_file->GetLocation();
+  AddToBootClassPathFilter(*dex_file);
   boot_class_path_.push_back(dex_file);
   WriterMutexLock mu(Thread::Current(), *Locks::dex_lock_);
   RegisterDexFileLocked(*dex_file, dex_cache, /* class_loader= */ nullptr);
 }
 
+static void AddClassDescriptorsToFilter(const DexFile& dex_file, DescriptorBloomFilter* filter) {
+  for (uint32_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+    const dex::ClassDef& class_def = dex_file.GetClassDef(i);
+    filter->Add(ComputeModifiedUtf8Hash(dex_file.GetClassDescriptor(class_def)));
+  }
+}
+
+void ClassLinker::AddToBootClassPathFilter(const DexFile& dex_file) {
+  DescriptorBloomFilter* filter =
+      boot_class_path_filters_.empty() ? nullptr : boot_class_path_filters_.back().get();
+  size_t num_classes = dex_file.NumClassDefs() + ((filter != nullptr) ? filter->Size() : 0u);
+  if (filter == nullptr || num_classes > filter->GetCapacity()) {
+    // Make room for twice as many classes, so that appending the boot class path dex files one
+    // by one only rebuilds the filter a few times.
+    ScopedTrace trace("Rebuild boot class path filter");
+    boot_class_path_filters_.push_back(std::make_unique<DescriptorBloomFilter>(2u * num_classes));
+    filter = boot_class_path_filters_.back().get();
+    for (const DexFile* boot_dex_file : boot_class_path_) {
+      AddClassDescriptorsToFilter(*boot_dex_file, filter);
+    }
+  }
+  AddClassDescriptorsToFilter(dex_file, filter);
+  boot_class_path_filter_.store(filter, std::memory_order_release);
+}
+
+bool ClassLinker::MayBeInBootClassPath(size_t hash) const {
+  const DescriptorBloomFilter* filter = boot_class_path_filter_.load(std::memory_order_acquire);
+  return filter == nullptr || filter->MayContain(static_cast<uint32_t>(hash));
+}
+
 void ClassLinker::RegisterDexFileLocked(const DexFile& dex_file,
                                         ObjPtr<mirror::DexCache> dex_cache,
                                         ObjPtr<mirror::ClassLoader> class_loader) {
@@ -4177,6 +4407,18 @@ ObjPtr<mirror::DexCache> ClassLinker::RegisterDexFile(const DexFile& dex_file,
   return h_dex_cache.Get();
 }
 
+void ClassLinker::MadviseAppDexFiles(Thread* self, MadviseState state) {
+  ReaderMutexLock mu(self, *Locks::dex_lock_);
+  for (const DexCacheData& data : dex_caches_) {
+    // Skip the dex files of unloaded class loaders, they may already be closed.
+    if (data.IsValid() &&
+        data.class_table != boot_class_table_.get() &&
+        !self->IsJWeakCleared(data.weak_root)) {
+      OatDexFile::MadviseDexFile(*data.dex_file, state);
+    }
+  }
+}
+
 bool ClassLinker::IsDexFileRegistered(Thread* self, const DexFile& dex_file) {
   ReaderMutexLock mu(self, *Locks::dex_lock_);
   return DecodeDexCacheLocked(self, FindDexCacheDataLocked(dex_file)) != nullptr;
@@ -4200,6 +4442,21 @@ ObjPtr<mirror::DexCache> ClassLinker::FindDexCache(Thread* self, const DexFile&
   UNREACHABLE();
 }
 
+ObjPtr<mirror::DexCache> ClassLinker::FindDexCache(Thread* self, const OatDexFile& oat_dex_file) {
+  ReaderMutexLock mu(self, *Locks::dex_lock_);
+  for (const DexCacheData& data : dex_caches_) {
+    // Avoid decoding (and read barriers) other unrelated dex caches.
+    if (data.dex_file->GetOatDexFile() == &oat_dex_file) {
+      ObjPtr<mirror::DexCache> dex_cache = DecodeDexCacheLocked(self, &data);
+      if (dex_cache != nullptr) {
+        return dex_cache;
+      }
+    }
+  }
+  LOG(FATAL) << "Failed to find DexCache for OatDexFile " << oat_dex_file.GetDexFileLocation();
+  UNREACHABLE();
+}
+
 ClassTable* ClassLinker::FindClassTable(Thread* self, ObjPtr<mirror::DexCache> dex_cache) {
   const DexFile* dex_file = dex_cache->GetDexFile();
   DCHECK(dex_file != nullptr);
@@ -4432,9 +4689,30 @@ ObjPtr<mirror::Class> ClassLinker::InsertClass(const char* descriptor,
     }
     LOG(INFO) << "Loaded class " << descriptor << source;
   }
+  Thread* const self = Thread::Current();
+  const ObjPtr<mirror::ClassLoader> class_loader = klass->GetClassLoader();
+  bool inserted = false;
   {
-    WriterMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
-    const ObjPtr<mirror::ClassLoader> class_loader = klass->GetClassLoader();
+    // Inserting into an existing class table only needs the lock of that table, so that threads
+    // defining classes in different class loaders do not contend. Creating the class table and
+    // logging the new roots for the GC still need the classes lock exclusively.
+    ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
+    ClassTable* const class_table = ClassTableForClassLoader(class_loader);
+    if (class_table != nullptr && !log_new_roots_) {
+      VerifyObject(klass);
+      ObjPtr<mirror::Class> existing = class_table->TryInsertWithHash(klass, hash);
+      if (existing != klass) {
+        return existing;
+      }
+      if (class_loader != nullptr) {
+        // This is necessary because we need to have the card dirtied for remembered sets.
+        WriteBarrier::ForEveryFieldWrite(class_loader);
+      }
+      inserted = true;
+    }
+  }
+  if (!inserted) {
+    WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
     ClassTable* const class_table = InsertClassTableForClassLoader(class_loader);
     ObjPtr<mirror::Class> existing = class_table->Lookup(descriptor, hash);
     if (existing != nullptr) {
@@ -6098,19 +6376,38 @@ bool ClassLinker::LinkClass(Thread* self,
     FixupTemporaryDeclaringClass(klass.Get(), h_new_class.Get());
 
     if (LIKELY(descriptor != nullptr)) {
-      WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
       const ObjPtr<mirror::ClassLoader> class_loader = h_new_class.Get()->GetClassLoader();
-      ClassTable* const table = InsertClassTableForClassLoader(class_loader);
-      const ObjPtr<mirror::Class> existing =
-          table->UpdateClass(descriptor, h_new_class.Get(), ComputeModifiedUtf8Hash(descriptor));
-      if (class_loader != nullptr) {
-        // We updated the class in the class table, perform the write barrier so that the GC knows
-        // about the change.
-        WriteBarrier::ForEveryFieldWrite(class_loader);
+      const size_t hash = ComputeModifiedUtf8Hash(descriptor);
+      bool updated = false;
+      {
+        // The class table already holds the temporary class, so updating it only needs the lock
+        // of the table, unless the new roots are logged for the GC. See InsertClass.
+        ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
+        if (!log_new_roots_) {
+          ClassTable* const table = ClassTableForClassLoader(class_loader);
+          const ObjPtr<mirror::Class> existing =
+              table->UpdateClass(descriptor, h_new_class.Get(), hash);
+          if (class_loader != nullptr) {
+            WriteBarrier::ForEveryFieldWrite(class_loader);
+          }
+          CHECK_EQ(existing, klass.Get());
+          updated = true;
+        }
       }
-      CHECK_EQ(existing, klass.Get());
-      if (log_new_roots_) {
-        new_class_roots_.push_back(GcRoot<mirror::Class>(h_new_class.Get()));
+      if (!updated) {
+        WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
+        ClassTable* const table = InsertClassTableForClassLoader(class_loader);
+        const ObjPtr<mirror::Class> existing =
+            table->UpdateClass(descriptor, h_new_class.Get(), hash);
+        if (class_loader != nullptr) {
+          // We updated the class in the class table, perform the write barrier so that the GC
+          // knows about the change.
+          WriteBarrier::ForEveryFieldWrite(class_loader);
+        }
+        CHECK_EQ(existing, klass.Get());
+        if (log_new_roots_) {
+          new_class_roots_.push_back(GcRoot<mirror::Class>(h_new_class.Get()));
+        }
       }
     }
 
@@ -8584,6 +8881,7 @@ ObjPtr<mirror::String> ClassLinker::DoResolveString(dex::StringIndex string_idx,
 
 ObjPtr<mirror::String> ClassLinker::DoResolveString(dex::StringIndex string_idx,
                                                     Handle<mirror::DexCache> dex_cache) {
+  dex_cache_string_misses_.fetch_add(1u, std::memory_order_relaxed);
   const DexFile& dex_file = *dex_cache->GetDexFile();
   uint32_t utf16_length;
   const char* utf8_data = dex_file.StringDataAndUtf16LengthByIdx(string_idx, &utf16_length);
@@ -8660,6 +8958,7 @@ template ObjPtr<mirror::Class> ClassLinker::DoResolveType(dex::TypeIndex type_id
 ObjPtr<mirror::Class> ClassLinker::DoResolveType(dex::TypeIndex type_idx,
                                                  Handle<mirror::DexCache> dex_cache,
                                                  Handle<mirror::ClassLoader> class_loader) {
+  dex_cache_type_misses_.fetch_add(1u, std::memory_order_relaxed);
   Thread* self = Thread::Current();
   const char* descriptor = dex_cache->GetDexFile()->StringByTypeIdx(type_idx);
   ObjPtr<mirror::Class> resolved = FindClass(self, descriptor, class_loader);
@@ -8777,6 +9076,9 @@ ArtMethod* ClassLinker::ResolveMethod(uint32_t method_idx,
     DCHECK(resolved->GetDeclaringClassUnchecked() != nullptr) << resolved->GetDexMethodIndex();
     return resolved;
   }
+  if (!valid_dex_cache_method) {
+    dex_cache_method_misses_.fetch_add(1u, std::memory_order_relaxed);
+  }
   const DexFile& dex_file = *dex_cache->GetDexFile();
   const dex::MethodId& method_id = dex_file.GetMethodId(method_idx);
   ObjPtr<mirror::Class> klass = nullptr;
@@ -8916,6 +9218,7 @@ ArtField* ClassLinker::ResolveField(uint32_t field_idx,
   if (resolved != nullptr) {
     return resolved;
   }
+  dex_cache_field_misses_.fetch_add(1u, std::memory_order_relaxed);
   const DexFile& dex_file = *dex_cache->GetDexFile();
   const dex::FieldId& field_id = dex_file.GetFieldId(field_idx);
   ObjPtr<mirror::Class> klass = ResolveType(field_id.class_idx_, dex_cache, class_loader);
@@ -8942,6 +9245,7 @@ ArtField* ClassLinker::ResolveFieldJLS(uint32_t field_idx,
   if (resolved != nullptr) {
     return resolved;
   }
+  dex_cache_field_misses_.fetch_add(1u, std::memory_order_relaxed);
   const DexFile& dex_file = *dex_cache->GetDexFile();
   const dex::FieldId& field_id = dex_file.GetFieldId(field_idx);
   ObjPtr<mirror::Class> klass = ResolveType(field_id.class_idx_, dex_cache, class_loader);
@@ -9032,6 +9336,7 @@ ObjPtr<mirror::MethodType> ClassLinker::ResolveMethodType(
   if (resolved != nullptr) {
     return resolved;
   }
+  dex_cache_method_type_misses_.fetch_add(1u, std::memory_order_relaxed);
 
   StackHandleScope<4> hs(self);
 
@@ -9467,6 +9772,20 @@ void ClassLinker::DumpForSigQuit(std::ostream& os) {
   ReaderMutexLock mu(soa.Self(), *Locks::classlinker_classes_lock_);
   os << "Zygote loaded classes=" << NumZygoteClasses() << " post zygote classes="
      << NumNonZygoteClasses() << "\n";
+  os << "Dex cache misses: strings=" << dex_cache_string_misses_.load(std::memory_order_relaxed)
+     << " types=" << dex_cache_type_misses_.load(std::memory_order_relaxed)
+     << " fields=" << dex_cache_field_misses_.load(std::memory_order_relaxed)
+     << " methods=" << dex_cache_method_misses_.load(std::memory_order_relaxed)
+     << " method types=" << dex_cache_method_type_misses_.load(std::memory_order_relaxed)
+     << "\n";
+  os << "Visibly initialized classes: "
+     << visibly_initialized_classes_.load(std::memory_order_relaxed)
+     << " membarrier batches="
+     << visibly_initialized_membarrier_batches_.load(std::memory_order_relaxed)
+     << " checkpoint batches="
+     << visibly_initialized_checkpoint_batches_.load(std::memory_order_relaxed)
+     << " time=" << PrettyDuration(visibly_initialized_time_ns_.load(std::memory_order_relaxed))
+     << "\n";
   ReaderMutexLock mu2(soa.Self(), *Locks::dex_lock_);
   os << "Dumping registered class loaders\n";
   size_t class_loader_index = 0;
@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_CLASS_LINKER_H_
 #define ART_RUNTIME_CLASS_LINKER_H_
 
+#include <atomic>
 #include <list>
 #include <set>
 #include <string>
@@ -78,6 +79,8 @@ using MethodDexCacheType = std::atomic<MethodDexCachePair>;
 class ArtField;
 class ArtMethod;
 class ClassHierarchyAnalysis;
+class ClassPathIndex;
+class DescriptorBloomFilter;
 enum class ClassRoot : uint32_t;
 class ClassTable;
 class DexFile;
@@ -87,7 +90,9 @@ template<typename T> class LengthPrefixedArray;
 template<class T> class MutableHandle;
 class InternTable;
 class LinearAlloc;
+enum class MadviseState : uint8_t;
 class OatFile;
+class OatDexFile;
 template<class T> class ObjectLock;
 class Runtime;
 class ScopedObjectAccessAlreadyRunnable;
@@ -464,6 +469,11 @@ class ClassLinker {
     return boot_class_path_;
   }
 
+  // Madvise the registered dex files that are not in the boot class path to `state`.
+  void MadviseAppDexFiles(Thread* self, MadviseState state)
+      REQUIRES(!Locks::dex_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void VisitClasses(ClassVisitor* visitor)
       REQUIRES(!Locks::classlinker_classes_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -492,6 +502,10 @@ class ClassLinker {
   ObjPtr<mirror::DexCache> FindDexCache(Thread* self, const DexFile& dex_file)
       REQUIRES(!Locks::dex_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
+  // Find the dex cache of the dex file opened from `oat_dex_file`.
+  ObjPtr<mirror::DexCache> FindDexCache(Thread* self, const OatDexFile& oat_dex_file)
+      REQUIRES(!Locks::dex_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
   ClassTable* FindClassTable(Thread* self, ObjPtr<mirror::DexCache> dex_cache)
       REQUIRES(!Locks::dex_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -994,6 +1008,18 @@ class ClassLinker {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::dex_lock_);
 
+  // Returns the index of the class path of `class_loader`, rebuilt if its dex files changed, or
+  // null if its class path is too short to be indexed or it has no class table yet.
+  const ClassPathIndex* GetClassPathIndex(ScopedObjectAccessAlreadyRunnable& soa,
+                                          Handle<mirror::ClassLoader> class_loader)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Returns false if no class with the descriptor hash `hash` is defined in the boot class path.
+  bool MayBeInBootClassPath(size_t hash) const;
+
+  // Adds the classes of `dex_file` to the filter of the boot class path, before appending it.
+  void AddToBootClassPathFilter(const DexFile& dex_file);
+
   // Finds the class in the boot class loader.
   // If the class is found the method returns the resolved class. Otherwise it returns null.
   ObjPtr<mirror::Class> FindClassInBootClassLoaderClassPath(Thread* self,
@@ -1384,6 +1410,12 @@ class ClassLinker {
 
   std::vector<const DexFile*> boot_class_path_;
   std::vector<std::unique_ptr<const DexFile>> boot_dex_files_;
+  // Filter of the descriptors of the classes defined in `boot_class_path_`, to skip searching it
+  // for the classes of other class loaders, which are first looked up in the boot class loader.
+  // It is replaced by a larger filter when appended dex files exceed its capacity. Lookups may
+  // still read the previous filters, so they are kept in `boot_class_path_filters_`.
+  std::atomic<const DescriptorBloomFilter*> boot_class_path_filter_;
+  std::vector<std::unique_ptr<DescriptorBloomFilter>> boot_class_path_filters_;
 
   // JNI weak globals and side data to allow dex caches to get unloaded. We lazily delete weak
   // globals when we register new dex files.
@@ -1408,6 +1440,14 @@ class ClassLinker {
   // the classes into the class_table_ to avoid dex cache based searches.
   Atomic<uint32_t> failed_dex_cache_class_lookups_;
 
+  // Number of resolutions that missed the dex cache and went through the slow path, by kind of
+  // dex cache entry. Dumped on SIGQUIT to help tune the dex cache sizes.
+  Atomic<uint64_t> dex_cache_string_misses_;
+  Atomic<uint64_t> dex_cache_type_misses_;
+  Atomic<uint64_t> dex_cache_field_misses_;
+  Atomic<uint64_t> dex_cache_method_misses_;
+  Atomic<uint64_t> dex_cache_method_type_misses_;
+
   // Well known mirror::Class roots.
   GcRoot<mirror::ObjectArray<mirror::Class>> class_roots_;
 
@@ -1442,6 +1482,14 @@ class ClassLinker {
       GUARDED_BY(visibly_initialized_callback_lock_);
   IntrusiveForwardList<VisiblyInitializedCallback> running_visibly_initialized_callbacks_
       GUARDED_BY(visibly_initialized_callback_lock_);
+  // Whether we can publish the visibly initialized status with membarrier(2) instead of
+  // running a checkpoint.
+  const bool visibly_initialize_classes_with_membarrier_;
+  // Statistics for `DumpForSigQuit()`.
+  Atomic<uint64_t> visibly_initialized_membarrier_batches_;
+  Atomic<uint64_t> visibly_initialized_checkpoint_batches_;
+  Atomic<uint64_t> visibly_initialized_classes_;
+  Atomic<uint64_t> visibly_initialized_time_ns_;
 
   std::unique_ptr<ClassHierarchyAnalysis> cha_;
 
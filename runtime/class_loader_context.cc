@@ -409,6 +409,7 @@ bool ClassLoaderContext::OpenDexFiles(InstructionSet isa,
   }
 
   dex_files_open_attempted_ = true;
+  last_verification_.reset();
   // Assume we can open all dex files. If not, we will set this to false as we go.
   dex_files_open_result_ = true;
 
@@ -532,6 +533,7 @@ bool ClassLoaderContext::RemoveLocationsFromClassPaths(
     const dchecked_vector<std::string>& locations) {
   CHECK(!dex_files_open_attempted_)
       << "RemoveLocationsFromClasspaths cannot be call after OpenDexFiles";
+  last_verification_.reset();
 
   if (class_loader_chain_ == nullptr) {
     return false;
@@ -1235,6 +1237,22 @@ ClassLoaderContext::VerificationResult ClassLoaderContext::VerifyClassLoaderCont
     DCHECK(dex_files_open_result_);
   }
 
+  if (last_verification_.has_value() &&
+      last_verification_->verify_names == verify_names &&
+      last_verification_->verify_checksums == verify_checksums &&
+      last_verification_->context_spec == context_spec) {
+    return last_verification_->result;
+  }
+  VerificationResult result =
+      VerifyClassLoaderContextMatchUncached(context_spec, verify_names, verify_checksums);
+  last_verification_ = LastVerification{context_spec, verify_names, verify_checksums, result};
+  return result;
+}
+
+ClassLoaderContext::VerificationResult ClassLoaderContext::VerifyClassLoaderContextMatchUncached(
+    const std::string& context_spec,
+    bool verify_names,
+    bool verify_checksums) const {
   ClassLoaderContext expected_context;
   if (!expected_context.Parse(context_spec, verify_checksums)) {
     LOG(WARNING) << "Invalid class loader context: " << context_spec;
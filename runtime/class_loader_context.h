@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_CLASS_LOADER_CONTEXT_H_
 #define ART_RUNTIME_CLASS_LOADER_CONTEXT_H_
 
+#include <optional>
 #include <string>
 #include <vector>
 #include <set>
@@ -163,6 +164,9 @@ class ClassLoaderContext {
   // This should be called after OpenDexFiles().
   // Names are only verified if verify_names is true.
   // Checksums are only verified if verify_checksums is true.
+  // The result of the last verification is remembered, so verifying the same
+  // spec again (e.g. for the odex and the oat file of one dex location) does
+  // not parse it a second time.
   VerificationResult VerifyClassLoaderContextMatch(const std::string& context_spec,
                                                    bool verify_names = true,
                                                    bool verify_checksums = true) const;
@@ -326,6 +330,10 @@ class ClassLoaderContext {
                                 ClassLoaderInfo* stored_info,
                                 std::ostringstream& out) const;
 
+  VerificationResult VerifyClassLoaderContextMatchUncached(const std::string& context_spec,
+                                                           bool verify_names,
+                                                           bool verify_checksums) const;
+
   bool ClassLoaderInfoMatch(const ClassLoaderInfo& info,
                             const ClassLoaderInfo& expected_info,
                             const std::string& context_spec,
@@ -363,6 +371,16 @@ class ClassLoaderContext {
   // which will release their ownership in the destructor based on this flag.
   const bool owns_the_dex_files_;
 
+  // The arguments and result of the last VerifyClassLoaderContextMatch() call.
+  // Cleared whenever the class paths of the context change.
+  struct LastVerification {
+    std::string context_spec;
+    bool verify_names;
+    bool verify_checksums;
+    VerificationResult result;
+  };
+  mutable std::optional<LastVerification> last_verification_;
+
   friend class ClassLoaderContextTest;
 
   DISALLOW_COPY_AND_ASSIGN(ClassLoaderContext);
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_path_index.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <android-base/logging.h>
+
+#include "base/bit_utils.h"
+#include "base/casts.h"
+#include "base/systrace.h"
+#include "dex/dex_file-inl.h"
+#include "dex/utf.h"
+
+namespace art {
+
+ClassPathIndex::ClassPathIndex(std::vector<const DexFile*>&& dex_files)
+    : dex_files_(std::move(dex_files)) {
+  ScopedTrace trace("Index class path");
+  CHECK_LE(dex_files_.size(), std::numeric_limits<uint16_t>::max());
+  size_t num_classes = 0u;
+  for (const DexFile* dex_file : dex_files_) {
+    num_classes += dex_file->NumClassDefs();
+  }
+  // Two classes per bucket on average keeps the index at about four bytes per class.
+  const size_t num_buckets = RoundUpToPowerOfTwo(std::max<size_t>(num_classes / 2u, 1u));
+  bucket_mask_ = dchecked_integral_cast<uint32_t>(num_buckets - 1u);
+
+  // Collect the (bucket, dex file index) pairs and sort them, which also orders the candidates
+  // of each bucket by class path order.
+  std::vector<uint64_t> pairs;
+  pairs.reserve(num_classes);
+  for (size_t dex_file_index = 0; dex_file_index != dex_files_.size(); ++dex_file_index) {
+    const DexFile* dex_file = dex_files_[dex_file_index];
+    for (uint32_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+      const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+      uint64_t bucket = GetBucket(ComputeModifiedUtf8Hash(descriptor));
+      pairs.push_back((bucket << 32) | dex_file_index);
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  bucket_starts_.resize(num_buckets + 1u, 0u);
+  candidates_.reserve(pairs.size());
+  for (uint64_t pair : pairs) {
+    ++bucket_starts_[(pair >> 32) + 1u];
+    candidates_.push_back(static_cast<uint16_t>(pair));
+  }
+  for (size_t bucket = 0; bucket != num_buckets; ++bucket) {
+    bucket_starts_[bucket + 1u] += bucket_starts_[bucket];
+  }
+  DCHECK_EQ(bucket_starts_.back(), candidates_.size());
+}
+
+}  // namespace art
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CLASS_PATH_INDEX_H_
+#define ART_RUNTIME_CLASS_PATH_INDEX_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/macros.h"
+
+namespace art {
+
+class DexFile;
+
+// Index of the classes defined in the dex files of a class path, so that looking up a class does
+// not search the type lookup table of every dex file. Classes are hashed by descriptor to buckets
+// which list, in class path order, the dex files defining a class hashed to the bucket. Looking
+// up a class only searches these candidates, there is usually a single one.
+class ClassPathIndex {
+ public:
+  // Class paths with fewer dex files are searched directly.
+  static constexpr size_t kMinDexFiles = 4u;
+
+  explicit ClassPathIndex(std::vector<const DexFile*>&& dex_files);
+
+  // Returns the indexed dex files, in class path order.
+  const std::vector<const DexFile*>& GetDexFiles() const {
+    return dex_files_;
+  }
+
+  // Calls `visitor` on the dex files which may define the class with the descriptor hash `hash`,
+  // in class path order, until it returns false. Returns false if `visitor` did.
+  template <typename Visitor>
+  bool VisitCandidates(uint32_t hash, const Visitor& visitor) const {
+    const uint32_t bucket = GetBucket(hash);
+    for (uint32_t i = bucket_starts_[bucket], end = bucket_starts_[bucket + 1u]; i != end; ++i) {
+      if (!visitor(dex_files_[candidates_[i]])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  uint32_t GetBucket(uint32_t hash) const {
+    // Mix the hash, the low bits of the descriptor hashes of similar names are close.
+    return static_cast<uint32_t>((static_cast<uint64_t>(hash) * UINT64_C(0x9e3779b97f4a7c15)) >>
+                                 32) & bucket_mask_;
+  }
+
+  const std::vector<const DexFile*> dex_files_;
+  uint32_t bucket_mask_;
+  // Start of the candidates of each bucket in `candidates_`, with a final end marker.
+  std::vector<uint32_t> bucket_starts_;
+  // Indexes in `dex_files_`, in increasing order for each bucket.
+  std::vector<uint16_t> candidates_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClassPathIndex);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CLASS_PATH_INDEX_H_
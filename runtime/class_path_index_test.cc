@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_path_index.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "common_runtime_test.h"
+#include "dex/dex_file-inl.h"
+#include "dex/utf.h"
+
+namespace art {
+
+class ClassPathIndexTest : public CommonRuntimeTest {};
+
+TEST_F(ClassPathIndexTest, VisitCandidates) {
+  std::vector<std::unique_ptr<const DexFile>> owned_dex_files = OpenTestDexFiles("MultiDex");
+  for (const char* name : { "Nested", "Statics", "XandY" }) {
+    owned_dex_files.push_back(OpenTestDexFile(name));
+  }
+  std::vector<const DexFile*> dex_files;
+  for (const std::unique_ptr<const DexFile>& dex_file : owned_dex_files) {
+    dex_files.push_back(dex_file.get());
+  }
+  ASSERT_GE(dex_files.size(), ClassPathIndex::kMinDexFiles);
+  std::vector<const DexFile*> indexed_dex_files = dex_files;
+  ClassPathIndex index(std::move(indexed_dex_files));
+  EXPECT_EQ(index.GetDexFiles(), dex_files);
+
+  for (const DexFile* dex_file : dex_files) {
+    for (uint32_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+      const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+      // The defining dex file is a candidate, and candidates are in class path order.
+      std::vector<const DexFile*> candidates;
+      index.VisitCandidates(ComputeModifiedUtf8Hash(descriptor), [&](const DexFile* candidate) {
+        candidates.push_back(candidate);
+        return true;
+      });
+      EXPECT_TRUE(std::find(candidates.begin(), candidates.end(), dex_file) != candidates.end())
+          << descriptor;
+      for (size_t j = 1; j < candidates.size(); ++j) {
+        EXPECT_LT(std::find(dex_files.begin(), dex_files.end(), candidates[j - 1u]),
+                  std::find(dex_files.begin(), dex_files.end(), candidates[j]));
+      }
+      // The visit stops when the visitor returns false.
+      size_t num_visited = 0u;
+      EXPECT_FALSE(index.VisitCandidates(ComputeModifiedUtf8Hash(descriptor),
+                                         [&](const DexFile* candidate ATTRIBUTE_UNUSED) {
+        ++num_visited;
+        return false;
+      }));
+      EXPECT_EQ(num_visited, 1u);
+    }
+  }
+}
+
+}  // namespace art
@@ -17,20 +17,47 @@
 #include "class_table-inl.h"
 
 #include "base/stl_util.h"
+#include "class_path_index.h"
 #include "mirror/class-inl.h"
 #include "oat_file.h"
 
 namespace art {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock),
+      frozen_sets_(nullptr),
+      class_path_index_(nullptr) {
   Runtime* const runtime = Runtime::Current();
   classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
                               runtime->GetHashTableMaxLoadFactor()));
 }
 
+ClassTable::~ClassTable() {}
+
+const ClassPathIndex* ClassTable::SetClassPathIndex(
+    std::unique_ptr<ClassPathIndex> class_path_index) {
+  WriterMutexLock mu(Thread::Current(), lock_);
+  const ClassPathIndex* result = class_path_index.get();
+  class_path_index_versions_.push_back(std::move(class_path_index));
+  class_path_index_.store(result, std::memory_order_release);
+  return result;
+}
+
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
   classes_.push_back(ClassSet());
+  PublishFrozenSetsLocked();
+}
+
+void ClassTable::PublishFrozenSetsLocked() {
+  std::unique_ptr<FrozenSets> frozen_sets(new FrozenSets());
+  frozen_sets->reserve(classes_.size() - 1u);
+  for (size_t i = 0; i < classes_.size() - 1u; ++i) {
+    frozen_sets->push_back(&classes_[i]);
+  }
+  // Release the contents of the frozen sets along with the vector.
+  frozen_sets_.store(frozen_sets.get(), std::memory_order_release);
+  frozen_sets_versions_.push_back(std::move(frozen_sets));
 }
 
 bool ClassTable::Contains(ObjPtr<mirror::Class> klass) {
@@ -117,7 +144,26 @@ size_t ClassTable::NumReferencedNonZygoteClasses() const {
 
 ObjPtr<mirror::Class> ClassTable::Lookup(const char* descriptor, size_t hash) {
   DescriptorHashPair pair(descriptor, hash);
+  // Most lookups find boot image and zygote classes, which are in the frozen sets.
+  const FrozenSets* frozen_sets = frozen_sets_.load(std::memory_order_acquire);
+  if (frozen_sets != nullptr) {
+    for (const ClassSet* class_set : *frozen_sets) {
+      auto it = class_set->FindWithHash(pair, hash);
+      if (it != class_set->end()) {
+        return it->Read();
+      }
+    }
+  }
   ReaderMutexLock mu(Thread::Current(), lock_);
+  if (frozen_sets_.load(std::memory_order_relaxed) == frozen_sets) {
+    ClassSet& class_set = classes_.back();
+    auto it = class_set.FindWithHash(pair, hash);
+    if (it != class_set.end()) {
+      return it->Read();
+    }
+    return nullptr;
+  }
+  // The frozen sets changed since they were searched, search all the sets again.
   for (ClassSet& class_set : classes_) {
     auto it = class_set.FindWithHash(pair, hash);
     if (it != class_set.end()) {
@@ -128,15 +174,19 @@ ObjPtr<mirror::Class> ClassTable::Lookup(const char* descriptor, size_t hash) {
 }
 
 ObjPtr<mirror::Class> ClassTable::TryInsert(ObjPtr<mirror::Class> klass) {
-  TableSlot slot(klass);
+  return TryInsertWithHash(klass, TableSlot::HashDescriptor(klass));
+}
+
+ObjPtr<mirror::Class> ClassTable::TryInsertWithHash(ObjPtr<mirror::Class> klass, size_t hash) {
+  TableSlot slot(klass, hash);
   WriterMutexLock mu(Thread::Current(), lock_);
   for (ClassSet& class_set : classes_) {
-    auto it = class_set.find(slot);
+    auto it = class_set.FindWithHash(slot, hash);
     if (it != class_set.end()) {
       return it->Read();
     }
   }
-  classes_.back().insert(slot);
+  classes_.back().InsertWithHash(slot, hash);
   return klass;
 }
 
@@ -283,7 +333,8 @@ size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.insert(classes_.begin(), std::move(set));
+  classes_.push_front(std::move(set));
+  PublishFrozenSetsLocked();
 }
 
 void ClassTable::ClearStrongRoots() {
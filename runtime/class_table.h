@@ -17,6 +17,9 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,6 +33,7 @@
 
 namespace art {
 
+class ClassPathIndex;
 class OatFile;
 
 namespace linker {
@@ -137,6 +141,7 @@ class ClassTable {
                   TrackingAllocator<TableSlot, kAllocatorTagClassTable>> ClassSet;
 
   ClassTable();
+  ~ClassTable();
 
   // Used by image writer for checking.
   bool Contains(ObjPtr<mirror::Class> klass)
@@ -199,7 +204,9 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Return the first class that matches the descriptor. Returns null if there are none.
+  // Return the first class that matches the descriptor. Returns null if there are none. The
+  // frozen snapshots are searched without taking `lock_`, only a miss in them takes it to search
+  // the latest class set.
   ObjPtr<mirror::Class> Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -215,6 +222,12 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Same as TryInsert, with the hash of the descriptor of `klass` already computed. The lookup
+  // and the insertion are done under the same lock, so concurrent callers agree on the class.
+  ObjPtr<mirror::Class> TryInsertWithHash(ObjPtr<mirror::Class> klass, size_t hash)
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void Insert(ObjPtr<mirror::Class> klass)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -223,7 +236,8 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Returns true if the class was found and removed, false otherwise.
+  // Returns true if the class was found and removed, false otherwise. Removing a class from a
+  // frozen snapshot must not race with lookups.
   bool Remove(const char* descriptor)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -264,6 +278,16 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Returns the index of the class path of the class loader, or null if there is none.
+  const ClassPathIndex* GetClassPathIndex() const {
+    return class_path_index_.load(std::memory_order_acquire);
+  }
+
+  // Replaces the index of the class path of the class loader. The previous index is kept until
+  // the table is deleted since lookups may still use it.
+  const ClassPathIndex* SetClassPathIndex(std::unique_ptr<ClassPathIndex> class_path_index)
+      REQUIRES(!lock_);
+
   ReaderWriterMutex& GetLock() {
     return lock_;
   }
@@ -283,10 +307,26 @@ class ClassTable {
       REQUIRES(lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Publishes the class sets other than the latest one to the lock-free lookups.
+  void PublishFrozenSetsLocked() REQUIRES(lock_);
+
+  using FrozenSets = std::vector<const ClassSet*>;
+
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
-  // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // We have several class sets to help prevent dirty pages after the zygote forks by calling
+  // FreezeSnapshot. Only the last one is modified, the others are frozen. A deque keeps the frozen
+  // sets in place when sets are added at either end.
+  std::deque<ClassSet> classes_ GUARDED_BY(lock_);
+  // The frozen class sets, in lookup order, read by lookups without `lock_`. A new vector is
+  // published when the frozen sets change, the previous ones are kept in `frozen_sets_versions_`
+  // until the table is deleted since lookups may still read them. This only happens when an image
+  // is loaded and when the zygote forks, so there are few versions.
+  std::atomic<const FrozenSets*> frozen_sets_;
+  std::vector<std::unique_ptr<const FrozenSets>> frozen_sets_versions_ GUARDED_BY(lock_);
+  // Index of the dex files of the class loader, replaced when the class path changes.
+  std::atomic<const ClassPathIndex*> class_path_index_;
+  std::vector<std::unique_ptr<ClassPathIndex>> class_path_index_versions_ GUARDED_BY(lock_);
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
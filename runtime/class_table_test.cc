@@ -156,6 +156,25 @@ TEST_F(ClassTableTest, ClassTable) {
   EXPECT_TRUE(table2.Contains(h_X.Get()));
   EXPECT_TRUE(table2.Contains(h_Y.Get()));
 
+  // Test that TryInsertWithHash does not insert classes already in a frozen snapshot.
+  ClassTable table3;
+  const uint32_t hash_x = ComputeModifiedUtf8Hash(descriptor_x);
+  EXPECT_OBJ_PTR_EQ(table3.TryInsertWithHash(h_X.Get(), hash_x), h_X.Get());
+  table3.FreezeSnapshot();
+  EXPECT_OBJ_PTR_EQ(table3.TryInsertWithHash(h_X.Get(), hash_x), h_X.Get());
+  EXPECT_EQ(table3.NumZygoteClasses(class_loader.Get()), 1u);
+  EXPECT_EQ(table3.NumNonZygoteClasses(class_loader.Get()), 0u);
+
+  // Test lookups in the frozen snapshot and in the latest class set.
+  const uint32_t hash_y = ComputeModifiedUtf8Hash(descriptor_y);
+  EXPECT_OBJ_PTR_EQ(table3.Lookup(descriptor_x, hash_x), h_X.Get());
+  EXPECT_TRUE(table3.Lookup(descriptor_y, hash_y) == nullptr);
+  table3.InsertWithHash(h_Y.Get(), hash_y);
+  EXPECT_OBJ_PTR_EQ(table3.Lookup(descriptor_y, hash_y), h_Y.Get());
+  table3.ReadFromMemory(&buffer[0]);
+  EXPECT_OBJ_PTR_EQ(table3.Lookup(descriptor_x, hash_x), h_X.Get());
+  EXPECT_OBJ_PTR_EQ(table3.Lookup(descriptor_y, hash_y), h_Y.Get());
+
   // TODO: Add tests for UpdateClass, InsertOatFile.
 }
 
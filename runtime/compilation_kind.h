@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_COMPILATION_KIND_H_
+#define ART_RUNTIME_COMPILATION_KIND_H_
+
+#include <iosfwd>
+#include <stddef.h>
+
+namespace art {
+
+// The tiers of JIT compilation, from the cheapest to compile to the fastest code.
+enum class CompilationKind {
+  // Code with hotness counters and inline caches, compiled without optimizations.
+  kBaseline,
+  // Like baseline, but compiled with the cheaper optimizations, inlining only trivial callees.
+  kBaselinePlus,
+  // Fully optimized code.
+  kOptimized,
+  // Fully optimized code, with entries for on-stack replacement from the interpreter.
+  kOsr,
+  kLast = kOsr,
+};
+
+static constexpr size_t kNumberOfCompilationKinds = static_cast<size_t>(CompilationKind::kLast) + 1;
+
+std::ostream& operator<<(std::ostream& os, const CompilationKind& rhs);
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_COMPILATION_KIND_H_
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_DESCRIPTOR_BLOOM_FILTER_H_
+#define ART_RUNTIME_DESCRIPTOR_BLOOM_FILTER_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include <android-base/logging.h>
+
+#include "base/bit_utils.h"
+#include "base/macros.h"
+
+namespace art {
+
+// Bloom filter of the hashes of class descriptors, used to skip searching a class path for a
+// class which is not defined in it. A miss is definitive, a hit may be a false positive. Hashes
+// can be added while other threads query the filter, a query racing with the addition of a hash
+// may miss it.
+class DescriptorBloomFilter {
+ public:
+  // Number of bits set per descriptor.
+  static constexpr size_t kNumHashes = 3u;
+  // Minimum number of bits per descriptor within the capacity of the filter, for a false positive
+  // rate of at most 3%.
+  static constexpr size_t kMinBitsPerDescriptor = 8u;
+
+  // Creates a filter for at least `capacity` descriptors.
+  explicit DescriptorBloomFilter(size_t capacity)
+      : num_bits_(RoundUpToPowerOfTwo(std::max(capacity * kMinBitsPerDescriptor, kBitsPerWord))),
+        words_(new std::atomic<uint64_t>[num_bits_ / kBitsPerWord]()),
+        size_(0u) {
+    DCHECK_GE(num_bits_, kBitsPerWord);
+  }
+
+  // Returns the number of descriptors the filter holds without exceeding its false positive rate.
+  size_t GetCapacity() const {
+    return num_bits_ / kMinBitsPerDescriptor;
+  }
+
+  // Returns the number of descriptors added.
+  size_t Size() const {
+    return size_;
+  }
+
+  // Adds the descriptor with the modified UTF-8 hash `hash`. Not thread safe with other adds.
+  void Add(uint32_t hash) {
+    uint32_t h1;
+    uint32_t h2;
+    Hash(hash, &h1, &h2);
+    for (size_t i = 0; i != kNumHashes; ++i) {
+      size_t bit = (h1 + i * h2) & (num_bits_ - 1u);
+      words_[bit / kBitsPerWord].fetch_or(UINT64_C(1) << (bit % kBitsPerWord),
+                                          std::memory_order_relaxed);
+    }
+    ++size_;
+  }
+
+  // Returns false if the descriptor with the modified UTF-8 hash `hash` was definitely not added.
+  bool MayContain(uint32_t hash) const {
+    uint32_t h1;
+    uint32_t h2;
+    Hash(hash, &h1, &h2);
+    for (size_t i = 0; i != kNumHashes; ++i) {
+      size_t bit = (h1 + i * h2) & (num_bits_ - 1u);
+      uint64_t word = words_[bit / kBitsPerWord].load(std::memory_order_relaxed);
+      if ((word & (UINT64_C(1) << (bit % kBitsPerWord))) == 0u) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static constexpr size_t kBitsPerWord = BitSizeOf<uint64_t>();
+
+  // Derives the two hashes of the double hashing from the descriptor hash. The descriptor hash is
+  // mixed first since similar descriptors have similar low bits.
+  static void Hash(uint32_t hash, /*out*/ uint32_t* h1, /*out*/ uint32_t* h2) {
+    uint64_t mixed = static_cast<uint64_t>(hash) * UINT64_C(0x9e3779b97f4a7c15);
+    *h1 = static_cast<uint32_t>(mixed >> 32);
+    *h2 = static_cast<uint32_t>(mixed) | 1u;
+  }
+
+  const size_t num_bits_;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(DescriptorBloomFilter);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_DESCRIPTOR_BLOOM_FILTER_H_
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "descriptor_bloom_filter.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "dex/utf.h"
+
+namespace art {
+
+static uint32_t HashOf(size_t i) {
+  std::string descriptor = "Lcom/example/Class" + std::to_string(i) + ";";
+  return ComputeModifiedUtf8Hash(descriptor.c_str());
+}
+
+TEST(DescriptorBloomFilterTest, Capacity) {
+  DescriptorBloomFilter empty_filter(0u);
+  EXPECT_GE(empty_filter.GetCapacity(), 1u);
+  EXPECT_EQ(empty_filter.Size(), 0u);
+  EXPECT_FALSE(empty_filter.MayContain(HashOf(0u)));
+
+  DescriptorBloomFilter filter(1000u);
+  EXPECT_GE(filter.GetCapacity(), 1000u);
+  EXPECT_LT(filter.GetCapacity(), 2000u);
+}
+
+TEST(DescriptorBloomFilterTest, NoFalseNegatives) {
+  static constexpr size_t kNumDescriptors = 10000u;
+  DescriptorBloomFilter filter(kNumDescriptors);
+  for (size_t i = 0; i != kNumDescriptors; ++i) {
+    filter.Add(HashOf(i));
+  }
+  EXPECT_EQ(filter.Size(), kNumDescriptors);
+  for (size_t i = 0; i != kNumDescriptors; ++i) {
+    EXPECT_TRUE(filter.MayContain(HashOf(i))) << i;
+  }
+  // Descriptors which were not added are mostly rejected.
+  size_t false_positives = 0u;
+  for (size_t i = kNumDescriptors; i != 2u * kNumDescriptors; ++i) {
+    if (filter.MayContain(HashOf(i))) {
+      ++false_positives;
+    }
+  }
+  EXPECT_LT(false_positives, kNumDescriptors * 5u / 100u);
+}
+
+}  // namespace art
@@ -115,30 +115,24 @@ bool ElfFileImpl<ElfTypes>::Setup(File* file,
   }
 
   if (program_header_only_) {
-    // first just map ELF header to get program header size information
-    size_t elf_header_size = sizeof(Elf_Ehdr);
-    if (!SetMap(file,
-                MemMap::MapFile(elf_header_size,
-                                prot,
-                                flags,
-                                file->Fd(),
-                                0,
-                                low_4gb,
-                                file->GetPath().c_str(),
-                                error_msg),
-                error_msg)) {
+    // Read the ELF header to get the program header size information, so that the ELF and
+    // program headers can be mapped at once.
+    Elf_Ehdr elf_header;
+    if (!file->PreadFully(&elf_header, sizeof(elf_header), /* offset= */ 0)) {
+      *error_msg = StringPrintf("Failed to read ELF header from '%s': %s",
+                                file->GetPath().c_str(), strerror(errno));
       return false;
     }
-    // then remap to cover program header
-    size_t program_header_size = header_->e_phoff + (header_->e_phentsize * header_->e_phnum);
+    size_t program_header_size =
+        elf_header.e_phoff + (elf_header.e_phentsize * elf_header.e_phnum);
     if (file_length < program_header_size) {
       *error_msg = StringPrintf("File size of %zd bytes not large enough to contain ELF program "
                                 "header of %zd bytes: '%s'", file_length,
-                                sizeof(Elf_Ehdr), file->GetPath().c_str());
+                                program_header_size, file->GetPath().c_str());
       return false;
     }
     if (!SetMap(file,
-                MemMap::MapFile(program_header_size,
+                MemMap::MapFile(std::max(program_header_size, sizeof(Elf_Ehdr)),
                                 prot,
                                 flags,
                                 file->Fd(),
@@ -1702,18 +1696,13 @@ ElfFile* ElfFile::Open(File* file,
                               file->GetPath().c_str());
     return nullptr;
   }
-  MemMap map = MemMap::MapFile(EI_NIDENT,
-                               PROT_READ,
-                               MAP_PRIVATE,
-                               file->Fd(),
-                               0,
-                               low_4gb,
-                               file->GetPath().c_str(),
-                               error_msg);
-  if (!map.IsValid() || map.Size() != EI_NIDENT) {
+  // Read the identification bytes instead of mapping them, the ELF file maps its headers itself.
+  uint8_t header[EI_NIDENT];
+  if (!file->PreadFully(header, EI_NIDENT, /* offset= */ 0)) {
+    *error_msg = StringPrintf("Failed to read ELF identification from %s: %s",
+                              file->GetPath().c_str(), strerror(errno));
     return nullptr;
   }
-  uint8_t* header = map.Begin();
   if (header[EI_CLASS] == ELFCLASS64) {
     ElfFileImpl64* elf_file_impl = ElfFileImpl64::Open(file,
                                                        writable,
@@ -1751,18 +1740,12 @@ ElfFile* ElfFile::Open(File* file, int mmap_prot, int mmap_flags, /*out*/std::st
                               file->GetPath().c_str());
     return nullptr;
   }
-  MemMap map = MemMap::MapFile(EI_NIDENT,
-                               PROT_READ,
-                               MAP_PRIVATE,
-                               file->Fd(),
-                               /* start= */ 0,
-                               low_4gb,
-                               file->GetPath().c_str(),
-                               error_msg);
-  if (!map.IsValid() || map.Size() != EI_NIDENT) {
+  uint8_t header[EI_NIDENT];
+  if (!file->PreadFully(header, EI_NIDENT, /* offset= */ 0)) {
+    *error_msg = StringPrintf("Failed to read ELF identification from %s: %s",
+                              file->GetPath().c_str(), strerror(errno));
     return nullptr;
   }
-  uint8_t* header = map.Begin();
   if (header[EI_CLASS] == ELFCLASS64) {
     ElfFileImpl64* elf_file_impl = ElfFileImpl64::Open(file,
                                                        mmap_prot,
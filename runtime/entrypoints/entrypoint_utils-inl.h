@@ -39,6 +39,7 @@
 #include "mirror/object-inl.h"
 #include "mirror/throwable.h"
 #include "nth_caller_visitor.h"
+#include "oat_file.h"
 #include "reflective_handle_scope-inl.h"
 #include "runtime.h"
 #include "stack_map.h"
@@ -47,6 +48,25 @@
 
 namespace art {
 
+// Returns the dex cache to resolve the method index of `inline_info` in. Methods inlined
+// from another dex file of the oat file of `outer_method` record the index of that dex file.
+inline ObjPtr<mirror::DexCache> GetInlinedMethodDexCache(ArtMethod* outer_method,
+                                                         const CodeInfo& code_info,
+                                                         InlineInfo inline_info)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  uint32_t dex_file_index = code_info.GetDexFileIndexOf(inline_info);
+  if (dex_file_index == MethodInfo::kSameDexFile) {
+    return outer_method->GetDexCache();
+  }
+  const OatDexFile* outer_oat_dex_file = outer_method->GetDexFile()->GetOatDexFile();
+  DCHECK(outer_oat_dex_file != nullptr);
+  const std::vector<const OatDexFile*>& oat_dex_files =
+      outer_oat_dex_file->GetOatFile()->GetOatDexFiles();
+  DCHECK_LT(dex_file_index, oat_dex_files.size());
+  return Runtime::Current()->GetClassLinker()->FindDexCache(Thread::Current(),
+                                                            *oat_dex_files[dex_file_index]);
+}
+
 inline ArtMethod* GetResolvedMethod(ArtMethod* outer_method,
                                     const CodeInfo& code_info,
                                     const BitTableRange<InlineInfo>& inline_infos)
@@ -81,21 +101,24 @@ inline ArtMethod* GetResolvedMethod(ArtMethod* outer_method,
     DCHECK(!inline_info.EncodesArtMethod());
     DCHECK_NE(inline_info.GetDexPc(), static_cast<uint32_t>(-1));
     uint32_t method_index = code_info.GetMethodIndexOf(inline_info);
+    ObjPtr<mirror::DexCache> dex_cache =
+        GetInlinedMethodDexCache(outer_method, code_info, inline_info);
     ArtMethod* inlined_method = class_linker->LookupResolvedMethod(method_index,
-                                                                   method->GetDexCache(),
+                                                                   dex_cache,
                                                                    method->GetClassLoader());
     if (UNLIKELY(inlined_method == nullptr)) {
       LOG(FATAL) << "Could not find an inlined method from an .oat file: "
-                 << method->GetDexFile()->PrettyMethod(method_index) << " . "
+                 << dex_cache->GetDexFile()->PrettyMethod(method_index) << " . "
                  << "This must be due to duplicate classes or playing wrongly with class loaders";
       UNREACHABLE();
     }
     DCHECK(!inlined_method->IsRuntimeMethod());
-    if (UNLIKELY(inlined_method->GetDexFile() != method->GetDexFile())) {
-      // TODO: We could permit inlining within a multi-dex oat file and the boot image,
-      // even going back from boot image methods to the same oat file. However, this is
-      // not currently implemented in the compiler. Therefore crossing dex file boundary
-      // indicates that the inlined definition is not the same as the one used at runtime.
+    if (UNLIKELY(inlined_method->GetDexFile() != dex_cache->GetDexFile())) {
+      // TODO: We could permit inlining from the boot image, even going back from boot image
+      // methods to the same oat file. However, this is not currently implemented in the
+      // compiler, which only inlines across the dex files of the same oat file. Therefore
+      // crossing dex file boundary indicates that the inlined definition is not the same
+      // as the one used at runtime.
       bool target_sdk_at_least_p =
           IsSdkVersionSetAndAtLeast(Runtime::Current()->GetTargetSdkVersion(), SdkVersion::kP);
       LOG(target_sdk_at_least_p ? FATAL : WARNING)
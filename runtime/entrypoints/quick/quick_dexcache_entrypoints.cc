@@ -78,10 +78,13 @@ static void StoreObjectInBss(ArtMethod* outer_method,
 }
 
 static inline void StoreTypeInBss(ArtMethod* outer_method,
+                                  ArtMethod* caller,
                                   dex::TypeIndex type_idx,
                                   ObjPtr<mirror::Class> resolved_type)
     REQUIRES_SHARED(Locks::mutator_lock_) {
-  const DexFile* dex_file = outer_method->GetDexFile();
+  // The .bss mappings are keyed by the dex file of the instruction, which may be another
+  // dex file of the oat file of the outer method.
+  const DexFile* dex_file = caller->GetDexFile();
   DCHECK(dex_file != nullptr);
   const OatDexFile* oat_dex_file = dex_file->GetOatDexFile();
   if (oat_dex_file != nullptr) {
@@ -96,10 +99,11 @@ static inline void StoreTypeInBss(ArtMethod* outer_method,
 }
 
 static inline void StoreStringInBss(ArtMethod* outer_method,
+                                    ArtMethod* caller,
                                     dex::StringIndex string_idx,
                                     ObjPtr<mirror::String> resolved_string)
     REQUIRES_SHARED(Locks::mutator_lock_) {
-  const DexFile* dex_file = outer_method->GetDexFile();
+  const DexFile* dex_file = caller->GetDexFile();
   DCHECK(dex_file != nullptr);
   const OatDexFile* oat_dex_file = dex_file->GetOatDexFile();
   if (oat_dex_file != nullptr) {
@@ -116,9 +120,10 @@ static inline void StoreStringInBss(ArtMethod* outer_method,
 static ALWAYS_INLINE bool CanReferenceBss(ArtMethod* outer_method, ArtMethod* caller)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   // .bss references are used only for AOT-compiled code and only when the instruction
-  // originates from the outer method's dex file and the type or string index is tied to
-  // that dex file. As we do not want to check if the call is coming from AOT-compiled
-  // code (that could be expensive), simply check if the caller has the same dex file.
+  // originates from a dex file of the outer method's oat file and the type or string index
+  // is tied to that dex file. As we do not want to check if the call is coming from
+  // AOT-compiled code (that could be expensive), simply check if the caller has the same
+  // dex file, or another dex file of the same oat file.
   //
   // If we've accepted running AOT-compiled code despite the runtime class loader
   // resolving the caller to a different dex file, this check shall prevent us from
@@ -126,10 +131,19 @@ static ALWAYS_INLINE bool CanReferenceBss(ArtMethod* outer_method, ArtMethod* ca
   // but correct; we do not really care that much about performance in this odd case.
   //
   // JIT can inline throwing instructions across dex files and this check prevents
-  // looking up the index in the wrong dex file in that case. If the caller and outer
-  // method have the same dex file, we may or may not find a .bss slot to update;
-  // if we do, this can still benefit AOT-compiled code executed later.
-  return outer_method->GetDexFile() == caller->GetDexFile();
+  // looking up the index in a dex file of another oat file in that case. Otherwise, we
+  // may or may not find a .bss slot to update; if we do, this can still benefit
+  // AOT-compiled code executed later.
+  const DexFile* outer_dex_file = outer_method->GetDexFile();
+  const DexFile* caller_dex_file = caller->GetDexFile();
+  if (LIKELY(outer_dex_file == caller_dex_file)) {
+    return true;
+  }
+  const OatDexFile* outer_oat_dex_file = outer_dex_file->GetOatDexFile();
+  const OatDexFile* caller_oat_dex_file = caller_dex_file->GetOatDexFile();
+  return outer_oat_dex_file != nullptr &&
+         caller_oat_dex_file != nullptr &&
+         outer_oat_dex_file->GetOatFile() == caller_oat_dex_file->GetOatFile();
 }
 
 extern "C" mirror::Class* artInitializeStaticStorageFromCode(mirror::Class* klass, Thread* self)
@@ -163,7 +177,7 @@ extern "C" mirror::Class* artResolveTypeFromCode(uint32_t type_idx, Thread* self
                                                         /* can_run_clinit= */ false,
                                                         /* verify_access= */ false);
   if (LIKELY(result != nullptr) && CanReferenceBss(caller_and_outer.outer_method, caller)) {
-    StoreTypeInBss(caller_and_outer.outer_method, dex::TypeIndex(type_idx), result);
+    StoreTypeInBss(caller_and_outer.outer_method, caller, dex::TypeIndex(type_idx), result);
   }
   return result.Ptr();
 }
@@ -214,7 +228,8 @@ extern "C" mirror::String* artResolveStringFromCode(int32_t string_idx, Thread*
   ObjPtr<mirror::String> result =
       Runtime::Current()->GetClassLinker()->ResolveString(dex::StringIndex(string_idx), caller);
   if (LIKELY(result != nullptr) && CanReferenceBss(caller_and_outer.outer_method, caller)) {
-    StoreStringInBss(caller_and_outer.outer_method, dex::StringIndex(string_idx), result);
+    StoreStringInBss(
+        caller_and_outer.outer_method, caller, dex::StringIndex(string_idx), result);
   }
   return result.Ptr();
 }
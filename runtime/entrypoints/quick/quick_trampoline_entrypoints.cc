@@ -1199,7 +1199,8 @@ static void DumpB74410240DebugData(ArtMethod** sp) REQUIRES_SHARED(Locks::mutato
         caller = jni::DecodeArtMethod(WellKnownClasses::java_lang_String_charAt);
         CHECK_EQ(caller->GetDexMethodIndex(), method_index);
       } else {
-        ObjPtr<mirror::DexCache> dex_cache = caller->GetDexCache();
+        ObjPtr<mirror::DexCache> dex_cache =
+            GetInlinedMethodDexCache(outer_method, code_info, inline_info);
         ObjPtr<mirror::ClassLoader> class_loader = caller->GetClassLoader();
         caller = class_linker->LookupResolvedMethod(method_index, dex_cache, class_loader);
         CHECK(caller != nullptr);
@@ -25,9 +25,12 @@
 #include "base/safe_copy.h"
 #include "base/stl_util.h"
 #include "dex/dex_file_types.h"
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
 #include "mirror/class.h"
 #include "mirror/object_reference.h"
 #include "oat_quick_method_header.h"
+#include "runtime.h"
 #include "sigchain.h"
 #include "thread-current-inl.h"
 #include "verify_object-inl.h"
@@ -263,6 +266,50 @@ void FaultManager::RemoveHandler(FaultHandler* handler) {
   LOG(FATAL) << "Attempted to remove non existent handler " << handler;
 }
 
+void FaultManager::AddGeneratedCodeRange(const void* begin, size_t size) {
+  uintptr_t range_begin = reinterpret_cast<uintptr_t>(begin);
+  DCHECK_NE(range_begin, 0u);
+  DCHECK_NE(size, 0u);
+  for (GeneratedCodeRange& range : generated_code_ranges_) {
+    // Claim a free slot through its `begin`, then publish the range through its `end`.
+    if (range.begin.CompareAndSetStrongRelaxed(0u, range_begin)) {
+      range.end.store(range_begin + size, std::memory_order_release);
+      return;
+    }
+  }
+  VLOG(signals) << "No room to record generated code at " << begin;
+}
+
+void FaultManager::RemoveGeneratedCodeRange(const void* begin, size_t size) {
+  uintptr_t range_begin = reinterpret_cast<uintptr_t>(begin);
+  for (GeneratedCodeRange& range : generated_code_ranges_) {
+    if (range.begin.load(std::memory_order_relaxed) == range_begin &&
+        range.end.load(std::memory_order_relaxed) == range_begin + size) {
+      range.end.store(0u, std::memory_order_relaxed);
+      range.begin.store(0u, std::memory_order_release);
+      return;
+    }
+  }
+  // The range was dropped by AddGeneratedCodeRange().
+}
+
+bool FaultManager::IsInKnownGeneratedCode(uintptr_t return_pc) {
+  // A return pc may point right after the last instruction of a range.
+  for (const GeneratedCodeRange& range : generated_code_ranges_) {
+    uintptr_t end = range.end.load(std::memory_order_acquire);
+    if (end != 0u && range.begin.load(std::memory_order_relaxed) <= return_pc && return_pc <= end) {
+      return true;
+    }
+  }
+  if (OatQuickMethodHeader::NterpMethodHeader != nullptr &&
+      OatQuickMethodHeader::NterpMethodHeader->Contains(return_pc)) {
+    return true;
+  }
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  return jit != nullptr &&
+      jit->GetCodeCache()->ContainsPc(reinterpret_cast<const void*>(return_pc));
+}
+
 // This function is called within the signal handler.  It checks that
 // the mutator_lock is held (shared).  No annotalysis is done.
 bool FaultManager::IsInGeneratedCode(siginfo_t* siginfo, void* context, bool check_dex_pc) {
@@ -307,24 +354,29 @@ bool FaultManager::IsInGeneratedCode(siginfo_t* siginfo, void* context, bool che
     return false;
   }
 
-  // Verify that the potential method is indeed a method.
-  // TODO: check the GC maps to make sure it's an object.
-  // Check that the class pointer inside the object is not null and is aligned.
-  // No read barrier because method_obj may not be a real object.
-  mirror::Class* cls = SafeGetDeclaringClass(method_obj);
-  if (cls == nullptr) {
-    VLOG(signals) << "not a class";
-    return false;
-  }
+  // Managed code keeps its ArtMethod* at the bottom of the frame, or in the first argument
+  // register before the frame is set up, so faults in code we know about can skip the checks
+  // below. Each SafeCopy() is a syscall.
+  if (!IsInKnownGeneratedCode(return_pc)) {
+    // Verify that the potential method is indeed a method.
+    // TODO: check the GC maps to make sure it's an object.
+    // Check that the class pointer inside the object is not null and is aligned.
+    // No read barrier because method_obj may not be a real object.
+    mirror::Class* cls = SafeGetDeclaringClass(method_obj);
+    if (cls == nullptr) {
+      VLOG(signals) << "not a class";
+      return false;
+    }
 
-  if (!IsAligned<kObjectAlignment>(cls)) {
-    VLOG(signals) << "not aligned";
-    return false;
-  }
+    if (!IsAligned<kObjectAlignment>(cls)) {
+      VLOG(signals) << "not aligned";
+      return false;
+    }
 
-  if (!SafeVerifyClassClass(cls)) {
-    VLOG(signals) << "not a class class";
-    return false;
+    if (!SafeVerifyClassClass(cls)) {
+      VLOG(signals) << "not a class class";
+      return false;
+    }
   }
 
   const OatQuickMethodHeader* method_header = method_obj->GetOatQuickMethodHeader(return_pc);
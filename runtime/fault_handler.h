@@ -23,6 +23,7 @@
 
 #include <vector>
 
+#include "base/atomic.h"
 #include "base/locks.h"  // For annotalysis.
 #include "runtime_globals.h"  // For CanDoImplicitNullCheckOn.
 
@@ -51,6 +52,12 @@ class FaultManager {
   void AddHandler(FaultHandler* handler, bool generated_code);
   void RemoveHandler(FaultHandler* handler);
 
+  // Record the `size` bytes of compiled code at `begin`, so that faults in it are recognized
+  // without first validating the faulting method. A range is only removed once no thread can
+  // run its code anymore. Ranges that do not fit are dropped, faults in them take the slow path.
+  void AddGeneratedCodeRange(const void* begin, size_t size);
+  void RemoveGeneratedCodeRange(const void* begin, size_t size);
+
   // Note that the following two functions are called in the context of a signal handler.
   // The IsInGeneratedCode() function checks that the mutator lock is held before it
   // calls GetMethodAndReturnPCAndSP().
@@ -70,6 +77,21 @@ class FaultManager {
   bool HandleFaultByOtherHandlers(int sig, siginfo_t* info, void* context)
                                   NO_THREAD_SAFETY_ANALYSIS;
 
+  // Whether the return pc of a fault is in code known to hold managed frames: a range recorded
+  // with AddGeneratedCodeRange(), the JIT code cache or nterp. Lock free, called by the signal
+  // handler.
+  bool IsInKnownGeneratedCode(uintptr_t return_pc) NO_THREAD_SAFETY_ANALYSIS;
+
+  // An unused slot has a zero `end`. The `end` is published last, so a reader seeing a non-zero
+  // `end` also sees the matching `begin`.
+  struct GeneratedCodeRange {
+    Atomic<uintptr_t> begin;
+    Atomic<uintptr_t> end;
+  };
+  // Enough for a multi-image boot class path and the oat files of an app.
+  static constexpr size_t kMaxGeneratedCodeRanges = 64u;
+  GeneratedCodeRange generated_code_ranges_[kMaxGeneratedCodeRanges];
+
   std::vector<FaultHandler*> generated_code_handlers_;
   std::vector<FaultHandler*> other_handlers_;
   struct sigaction oldaction_;
@@ -83,10 +83,14 @@ inline size_t CardTable::Scan(ContinuousSpaceBitmap* bitmap,
   uintptr_t* word_end = reinterpret_cast<uintptr_t*>(aligned_end);
   for (uintptr_t* word_cur = reinterpret_cast<uintptr_t*>(card_cur); word_cur < word_end;
       ++word_cur) {
-    while (LIKELY(*word_cur == 0)) {
-      ++word_cur;
+    if (LIKELY(*word_cur == 0)) {
+      // Skip the run of clean cards with the vectorized search.
+      word_cur = AlignDown(
+          reinterpret_cast<uintptr_t*>(
+              FindNonCleanCard(reinterpret_cast<uint8_t*>(word_cur), aligned_end)),
+          sizeof(uintptr_t));
       if (UNLIKELY(word_cur >= word_end)) {
-        goto exit_for;
+        break;
       }
     }
 
@@ -107,7 +111,6 @@ inline size_t CardTable::Scan(ContinuousSpaceBitmap* bitmap,
       start += kCardSize;
     }
   }
-  exit_for:
 
   // Handle any unaligned cards at the end.
   card_cur = reinterpret_cast<uint8_t*>(word_end);
@@ -179,6 +182,16 @@ inline void CardTable::ModifyCardsAtomic(uint8_t* scan_begin,
 
   // TODO: Parallelize.
   while (word_cur < word_end) {
+    if (*word_cur == 0) {
+      // Most cards are clean, skip them without going through the visitor.
+      word_cur = AlignDown(
+          reinterpret_cast<uintptr_t*>(
+              FindNonCleanCard(reinterpret_cast<uint8_t*>(word_cur), card_end)),
+          sizeof(uintptr_t));
+      if (word_cur >= word_end) {
+        break;
+      }
+    }
     while (true) {
       expected_word = *word_cur;
       static_assert(kCardClean == 0);
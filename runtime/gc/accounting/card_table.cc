@@ -18,6 +18,13 @@
 
 #include <sys/mman.h>
 
+#if defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "base/bit_utils.h"
 #include "base/mem_map.h"
 #include "base/systrace.h"
 #include "base/utils.h"
@@ -132,6 +139,130 @@ void CardTable::CheckAddrIsInCardTable(const uint8_t* addr) const {
       << " addr: " << reinterpret_cast<const void*>(addr);
 }
 
+static uint8_t* FindNonCleanCardScalar(uint8_t* card_cur, uint8_t* card_end) {
+  static_assert(kCardClean == 0, "kCardClean must be 0");
+  while (!IsAligned<sizeof(uintptr_t)>(card_cur) && card_cur < card_end) {
+    if (*card_cur != CardTable::kCardClean) {
+      return card_cur;
+    }
+    ++card_cur;
+  }
+  while (card_cur + sizeof(uintptr_t) <= card_end &&
+         *reinterpret_cast<uintptr_t*>(card_cur) == 0) {
+    card_cur += sizeof(uintptr_t);
+  }
+  while (card_cur < card_end && *card_cur == CardTable::kCardClean) {
+    ++card_cur;
+  }
+  return card_cur;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+static uint8_t* FindNonCleanCardSse2(uint8_t* card_cur, uint8_t* card_end) {
+  const __m128i clean = _mm_setzero_si128();
+  for (; card_cur + sizeof(__m128i) <= card_end; card_cur += sizeof(__m128i)) {
+    __m128i cards = _mm_loadu_si128(reinterpret_cast<const __m128i*>(card_cur));
+    uint32_t clean_mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(cards, clean)));
+    if (clean_mask != 0xFFFFu) {
+      return card_cur + CTZ(~clean_mask);
+    }
+  }
+  return FindNonCleanCardScalar(card_cur, card_end);
+}
+
+__attribute__((target("avx2")))
+static uint8_t* FindNonCleanCardAvx2(uint8_t* card_cur, uint8_t* card_end) {
+  const __m256i clean = _mm256_setzero_si256();
+  for (; card_cur + sizeof(__m256i) <= card_end; card_cur += sizeof(__m256i)) {
+    __m256i cards = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(card_cur));
+    uint32_t clean_mask =
+        static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(cards, clean)));
+    if (clean_mask != 0xFFFFFFFFu) {
+      return card_cur + CTZ(~clean_mask);
+    }
+  }
+  return FindNonCleanCardSse2(card_cur, card_end);
+}
+#endif
+
+#if defined(__aarch64__)
+static uint8_t* FindNonCleanCardNeon(uint8_t* card_cur, uint8_t* card_end) {
+  for (; card_cur + sizeof(uint8x16_t) <= card_end; card_cur += sizeof(uint8x16_t)) {
+    uint8x16_t cards = vld1q_u8(card_cur);
+    if (vmaxvq_u8(cards) != CardTable::kCardClean) {
+      // Narrow each byte to a nibble so that the position of the first non-clean card can be
+      // found with a single CTZ on the 64-bit result.
+      uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(vtstq_u8(cards, cards)), 4);
+      uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+      return card_cur + CTZ(mask) / 4;
+    }
+  }
+  return FindNonCleanCardScalar(card_cur, card_end);
+}
+#endif
+
+bool CardTable::IsScanKernelSupported(ScanKernel kernel) {
+  switch (kernel) {
+    case ScanKernel::kScalar:
+      return true;
+    case ScanKernel::kSse2:
+#if defined(__i386__) || defined(__x86_64__)
+      return true;
+#else
+      return false;
+#endif
+    case ScanKernel::kAvx2:
+#if defined(__i386__) || defined(__x86_64__)
+      return __builtin_cpu_supports("avx2");
+#else
+      return false;
+#endif
+    case ScanKernel::kNeon:
+#if defined(__aarch64__)
+      return true;
+#else
+      return false;
+#endif
+  }
+}
+
+uint8_t* CardTable::FindNonCleanCard(ScanKernel kernel, uint8_t* card_begin, uint8_t* card_end) {
+  DCHECK(IsScanKernelSupported(kernel));
+  switch (kernel) {
+#if defined(__i386__) || defined(__x86_64__)
+    case ScanKernel::kSse2:
+      return FindNonCleanCardSse2(card_begin, card_end);
+    case ScanKernel::kAvx2:
+      return FindNonCleanCardAvx2(card_begin, card_end);
+#endif
+#if defined(__aarch64__)
+    case ScanKernel::kNeon:
+      return FindNonCleanCardNeon(card_begin, card_end);
+#endif
+    default:
+      return FindNonCleanCardScalar(card_begin, card_end);
+  }
+}
+
+using FindNonCleanCardFn = uint8_t* (*)(uint8_t*, uint8_t*);
+
+static FindNonCleanCardFn SelectFindNonCleanCard() {
+#if defined(__i386__) || defined(__x86_64__)
+  return CardTable::IsScanKernelSupported(CardTable::ScanKernel::kAvx2)
+      ? FindNonCleanCardAvx2
+      : FindNonCleanCardSse2;
+#elif defined(__aarch64__)
+  return FindNonCleanCardNeon;
+#else
+  return FindNonCleanCardScalar;
+#endif
+}
+
+uint8_t* CardTable::FindNonCleanCard(uint8_t* card_begin, uint8_t* card_end) {
+  static const FindNonCleanCardFn find_non_clean_card = SelectFindNonCleanCard();
+  return find_non_clean_card(card_begin, card_end);
+}
+
 void CardTable::VerifyCardTable() {
   UNIMPLEMENTED(WARNING) << "Card table verification";
 }
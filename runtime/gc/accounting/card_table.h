@@ -142,6 +142,23 @@ class CardTable {
 
   bool AddrIsInCardTable(const void* addr) const;
 
+  // Implementations of the clean card search. kScalar is always available, the others depend on
+  // the instruction set the runtime was built for and, for kAvx2, on the CPU we run on.
+  enum class ScanKernel {
+    kScalar,
+    kSse2,
+    kAvx2,
+    kNeon,
+  };
+
+  // Returns the first card in [card_begin, card_end) that is not kCardClean, or card_end if all
+  // the cards are clean. Uses the fastest kernel supported by the CPU.
+  static uint8_t* FindNonCleanCard(uint8_t* card_begin, uint8_t* card_end);
+
+  // Same as FindNonCleanCard but with an explicit kernel, which must be supported. For testing.
+  static uint8_t* FindNonCleanCard(ScanKernel kernel, uint8_t* card_begin, uint8_t* card_end);
+  static bool IsScanKernelSupported(ScanKernel kernel);
+
  private:
   CardTable(MemMap&& mem_map, uint8_t* biased_begin, size_t offset);
 
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "base/atomic.h"
+#include "base/time_utils.h"
 #include "base/utils.h"
 #include "common_runtime_test.h"
 #include "handle_scope-inl.h"
@@ -145,6 +146,74 @@ TEST_F(CardTableTest, TestModifyCardsAtomic) {
   }
 }
 
+static constexpr CardTable::ScanKernel kScanKernels[] = {
+    CardTable::ScanKernel::kScalar,
+    CardTable::ScanKernel::kSse2,
+    CardTable::ScanKernel::kAvx2,
+    CardTable::ScanKernel::kNeon,
+};
+
+TEST_F(CardTableTest, TestFindNonCleanCard) {
+  CommonSetup();
+  uint8_t* const card_begin = card_table_->CardFromAddr(HeapBegin());
+  uint8_t* const card_end = card_table_->CardFromAddr(HeapLimit());
+  // Dirty a single card at various positions and search from unaligned starts.
+  for (size_t dirty = 0; dirty < static_cast<size_t>(card_end - card_begin); dirty += 7) {
+    card_begin[dirty] = CardTable::kCardDirty;
+    for (size_t start = 0; start < 72; start += 5) {
+      uint8_t* expected = start <= dirty ? card_begin + dirty : card_end;
+      for (CardTable::ScanKernel kernel : kScanKernels) {
+        if (!CardTable::IsScanKernelSupported(kernel)) {
+          continue;
+        }
+        EXPECT_EQ(expected, CardTable::FindNonCleanCard(kernel, card_begin + start, card_end))
+            << "kernel " << static_cast<int>(kernel) << " dirty " << dirty << " start " << start;
+      }
+      EXPECT_EQ(expected, CardTable::FindNonCleanCard(card_begin + start, card_end));
+    }
+    card_begin[dirty] = CardTable::kCardClean;
+  }
+  // An empty range and an all clean range.
+  for (CardTable::ScanKernel kernel : kScanKernels) {
+    if (CardTable::IsScanKernelSupported(kernel)) {
+      EXPECT_EQ(card_begin, CardTable::FindNonCleanCard(kernel, card_begin, card_begin));
+      EXPECT_EQ(card_end, CardTable::FindNonCleanCard(kernel, card_begin, card_end));
+    }
+  }
+}
+
+// Compares the time each kernel takes to find the dirty cards of a sparse card table.
+TEST_F(CardTableTest, BenchmarkFindNonCleanCard) {
+  CommonSetup();
+  uint8_t* const card_begin = card_table_->CardFromAddr(HeapBegin());
+  uint8_t* const card_end = card_table_->CardFromAddr(HeapLimit());
+  static constexpr size_t kDirtyCardStride = 509;
+  static constexpr size_t kIterations = 200;
+  size_t num_dirty = 0;
+  for (uint8_t* card = card_begin; card < card_end; card += kDirtyCardStride) {
+    *card = CardTable::kCardDirty;
+    ++num_dirty;
+  }
+  for (CardTable::ScanKernel kernel : kScanKernels) {
+    if (!CardTable::IsScanKernelSupported(kernel)) {
+      continue;
+    }
+    size_t found = 0;
+    const uint64_t start_time = NanoTime();
+    for (size_t i = 0; i < kIterations; ++i) {
+      for (uint8_t* card = CardTable::FindNonCleanCard(kernel, card_begin, card_end);
+           card < card_end;
+           card = CardTable::FindNonCleanCard(kernel, card + 1, card_end)) {
+        ++found;
+      }
+    }
+    const uint64_t duration = NanoTime() - start_time;
+    EXPECT_EQ(num_dirty * kIterations, found);
+    LOG(INFO) << "Kernel " << static_cast<int>(kernel) << " scanned " << kIterations << "x"
+              << (card_end - card_begin) << " cards in " << PrettyDuration(duration);
+  }
+}
+
 // TODO: Add test for CardTable::Scan.
 }  // namespace accounting
 }  // namespace gc
@@ -59,6 +59,31 @@ class RememberedSet {
       REQUIRES(Locks::heap_bitmap_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Visit the cards in the set, the cards for which the visitor returns false are removed.
+  template <typename Visitor>
+  void FilterCards(const Visitor& visitor) {
+    for (auto it = dirty_cards_.begin(); it != dirty_cards_.end();) {
+      if (visitor(*it)) {
+        ++it;
+      } else {
+        it = dirty_cards_.erase(it);
+      }
+    }
+  }
+
+  bool ContainsCard(uint8_t* card) const {
+    return dirty_cards_.find(card) != dirty_cards_.end();
+  }
+
+  size_t NumCards() const {
+    return dirty_cards_.size();
+  }
+
+  // Remove all the cards from the set.
+  void Reset() {
+    dirty_cards_.clear();
+  }
+
   void Dump(std::ostream& os);
 
   space::ContinuousSpace* GetSpace() {
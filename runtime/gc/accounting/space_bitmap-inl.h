@@ -120,6 +120,13 @@ inline void SpaceBitmap<kAlignment>::VisitMarkedRange(uintptr_t visit_begin,
 
     // Traverse the middle, full part.
     for (size_t i = index_start + 1; i < index_end; ++i) {
+      // Skip whole empty chunks at a time, sparse bitmaps are mostly zero words.
+      while (i + kWordsPerChunk <= index_end && OrChunk(&bitmap_begin_[i]) == 0) {
+        i += kWordsPerChunk;
+      }
+      if (i == index_end) {
+        break;
+      }
       uintptr_t w = bitmap_begin_[i].load(std::memory_order_relaxed);
       if (w != 0) {
         const uintptr_t ptr_base = IndexToOffset(i) + heap_begin_;
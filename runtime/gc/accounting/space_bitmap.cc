@@ -168,7 +168,7 @@ void SpaceBitmap<kAlignment>::SweepWalk(const SpaceBitmap<kAlignment>& live_bitm
     return;
   }
 
-  size_t buffer_size = sizeof(intptr_t) * kBitsPerIntPtrT;
+  size_t buffer_size = kSweepBatchSize;
   Atomic<uintptr_t>* live = live_bitmap.bitmap_begin_;
   Atomic<uintptr_t>* mark = mark_bitmap.bitmap_begin_;
   const size_t start = OffsetToIndex(sweep_begin - live_bitmap.heap_begin_);
@@ -191,6 +191,13 @@ void SpaceBitmap<kAlignment>::SweepWalk(const SpaceBitmap<kAlignment>& live_bitm
   mirror::Object** pointer_end = cur_pointer + (buffer_size - kBitsPerIntPtrT);
 
   for (size_t i = start; i <= end; i++) {
+    // Skip chunks without live objects at once.
+    while (i + kWordsPerChunk <= end + 1 && OrChunk(&live[i]) == 0) {
+      i += kWordsPerChunk;
+    }
+    if (i > end) {
+      break;
+    }
     uintptr_t garbage =
         live[i].load(std::memory_order_relaxed) & ~mark[i].load(std::memory_order_relaxed);
     if (UNLIKELY(garbage != 0)) {
@@ -152,7 +152,10 @@ class SpaceBitmap {
 
   // Walk through the bitmaps in increasing address order, and find the object pointers that
   // correspond to garbage objects.  Call <callback> zero or more times with lists of these object
-  // pointers. The callback is not permitted to increase the max of either bitmap.
+  // pointers. The callback is not permitted to increase the max of either bitmap. Pointers are
+  // handed out in batches of up to kSweepBatchSize so that sweepers such as RosAlloc::BulkFree
+  // can amortize their locking.
+  static constexpr size_t kSweepBatchSize = 4 * KB;
   static void SweepWalk(const SpaceBitmap& live, const SpaceBitmap& mark, uintptr_t base,
                         uintptr_t max, SweepCallback* thunk, void* arg);
 
@@ -241,6 +244,20 @@ class SpaceBitmap {
   template<bool kSetBit>
   bool Modify(const mirror::Object* obj);
 
+  // Number of bitmap words (256 bits) that scanning loops test at once to skip empty parts of
+  // sparse bitmaps.
+  static constexpr size_t kWordsPerChunk = 256 / kBitsPerIntPtrT;
+
+  // Returns the OR of the kWordsPerChunk words starting at `words`. The loads are independent so
+  // the compiler can combine them into vector loads.
+  static ALWAYS_INLINE uintptr_t OrChunk(const Atomic<uintptr_t>* words) {
+    uintptr_t result = 0;
+    for (size_t i = 0; i < kWordsPerChunk; ++i) {
+      result |= words[i].load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
   // Backing storage for bitmap.
   MemMap mem_map_;
 
@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "base/mutex.h"
+#include "base/time_utils.h"
 #include "common_runtime_test.h"
 #include "runtime_globals.h"
 #include "space_bitmap-inl.h"
@@ -257,6 +258,98 @@ TEST_F(SpaceBitmapTest, OrderPageAlignment) {
   RunTestOrder<kPageSize>();
 }
 
+struct SweepCounts {
+  size_t objects = 0;
+  size_t max_batch = 0;
+  const ContinuousSpaceBitmap* mark_bitmap = nullptr;
+};
+
+static void CountSweptObjects(size_t ptr_count, mirror::Object** ptrs, void* arg) {
+  SweepCounts* counts = reinterpret_cast<SweepCounts*>(arg);
+  for (size_t i = 0; i < ptr_count; ++i) {
+    EXPECT_FALSE(counts->mark_bitmap->Test(ptrs[i]));
+  }
+  counts->objects += ptr_count;
+  counts->max_batch = std::max(counts->max_batch, ptr_count);
+}
+
+TEST_F(SpaceBitmapTest, SweepWalk) {
+  uint8_t* heap_begin = reinterpret_cast<uint8_t*>(0x10000000);
+  size_t heap_capacity = 16 * MB;
+  ContinuousSpaceBitmap live_bitmap(
+      ContinuousSpaceBitmap::Create("live bitmap", heap_begin, heap_capacity));
+  ContinuousSpaceBitmap mark_bitmap(
+      ContinuousSpaceBitmap::Create("mark bitmap", heap_begin, heap_capacity));
+  RandGen r(0x1234);
+  size_t garbage = 0;
+  // Sparse clusters of objects separated by large empty parts of the bitmap.
+  for (int i = 0; i < 1000; ++i) {
+    const size_t cluster = RoundDown(r.next() % heap_capacity, kObjectAlignment);
+    for (size_t j = 0; j < 20 && cluster + j * kObjectAlignment < heap_capacity; ++j) {
+      mirror::Object* obj =
+          reinterpret_cast<mirror::Object*>(heap_begin + cluster + j * kObjectAlignment);
+      if (live_bitmap.Set(obj)) {
+        continue;
+      }
+      if (r.next() % 2 == 0) {
+        mark_bitmap.Set(obj);
+      } else {
+        ++garbage;
+      }
+    }
+  }
+  SweepCounts counts;
+  counts.mark_bitmap = &mark_bitmap;
+  ContinuousSpaceBitmap::SweepWalk(live_bitmap,
+                                   mark_bitmap,
+                                   reinterpret_cast<uintptr_t>(heap_begin),
+                                   reinterpret_cast<uintptr_t>(heap_begin) + heap_capacity,
+                                   &CountSweptObjects,
+                                   &counts);
+  EXPECT_EQ(garbage, counts.objects);
+  EXPECT_LE(counts.max_batch, ContinuousSpaceBitmap::kSweepBatchSize);
+}
+
+// Times VisitMarkedRange and SweepWalk over a sparse bitmap, where most of the time is spent on
+// empty words.
+TEST_F(SpaceBitmapTest, BenchmarkSparseScan) {
+  uint8_t* heap_begin = reinterpret_cast<uint8_t*>(0x10000000);
+  size_t heap_capacity = 64 * MB;
+  ContinuousSpaceBitmap live_bitmap(
+      ContinuousSpaceBitmap::Create("live bitmap", heap_begin, heap_capacity));
+  ContinuousSpaceBitmap mark_bitmap(
+      ContinuousSpaceBitmap::Create("mark bitmap", heap_begin, heap_capacity));
+  static constexpr size_t kObjectStride = 64 * KB + kObjectAlignment;
+  size_t num_objects = 0;
+  for (size_t offset = 0; offset < heap_capacity; offset += kObjectStride) {
+    live_bitmap.Set(reinterpret_cast<mirror::Object*>(heap_begin + offset));
+    ++num_objects;
+  }
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(heap_begin);
+  const uintptr_t end = begin + heap_capacity;
+  static constexpr size_t kIterations = 20;
+
+  size_t visited = 0;
+  uint64_t start_time = NanoTime();
+  for (size_t i = 0; i < kIterations; ++i) {
+    live_bitmap.VisitMarkedRange(begin, end, [&visited](mirror::Object* obj ATTRIBUTE_UNUSED) {
+      ++visited;
+    });
+  }
+  EXPECT_EQ(num_objects * kIterations, visited);
+  LOG(INFO) << "VisitMarkedRange: " << PrettyDuration((NanoTime() - start_time) / kIterations);
+
+  SweepCounts counts;
+  counts.mark_bitmap = &mark_bitmap;
+  start_time = NanoTime();
+  for (size_t i = 0; i < kIterations; ++i) {
+    ContinuousSpaceBitmap::SweepWalk(
+        live_bitmap, mark_bitmap, begin, end, &CountSweptObjects, &counts);
+  }
+  EXPECT_EQ(num_objects * kIterations, counts.objects);
+  LOG(INFO) << "SweepWalk: " << PrettyDuration((NanoTime() - start_time) / kIterations);
+}
+
 }  // namespace accounting
 }  // namespace gc
 }  // namespace art
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <cmath>
+
+#include "art_method-inl.h"
+#include "base/enums.h"
+#include "base/time_utils.h"
+#include "gc_root-inl.h"
+#include "handle_scope-inl.h"
+#include "mirror/object-inl.h"
+#include "obj_ptr-inl.h"
+#include "stack.h"
+#include "thread.h"
+
+namespace art {
+namespace gc {
+
+AllocationSampler::AllocationSampler()
+    : slots_(new Slot[kNumSlots]),
+      enqueue_position_(0),
+      dequeue_position_(0),
+      dropped_samples_(0) {
+  for (size_t i = 0; i < kNumSlots; ++i) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+size_t AllocationSampler::NextSampleDistance(Thread* self, size_t interval) {
+  // xorshift64*, seeded per thread on first use.
+  uint64_t* state = self->GetAllocationSampleRandomState();
+  if (UNLIKELY(*state == 0)) {
+    *state = (static_cast<uint64_t>(self->GetTid()) << 32) ^ NanoTime() ^ 0x9e3779b97f4a7c15;
+  }
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  uint64_t random = *state * UINT64_C(0x2545f4914f6cdd1d);
+  // A uniform value in (0, 1], from the top 53 bits.
+  double uniform =
+      (static_cast<double>(random >> 11) + 1.0) / static_cast<double>(UINT64_C(1) << 53);
+  double distance = -std::log(uniform) * static_cast<double>(interval);
+  return static_cast<size_t>(distance) + 1;
+}
+
+void AllocationSampler::RecordSample(Thread* self, ObjPtr<mirror::Object>* obj, size_t byte_count) {
+  // Claim a slot before the stack walk, so that a full buffer costs nothing more.
+  size_t position = enqueue_position_.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &slots_[position % kNumSlots];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence == position) {
+      if (enqueue_position_.compare_exchange_weak(
+              position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < position) {
+      // The slot still holds the sample of the previous lap, the buffer is full.
+      dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else {
+      position = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+
+  AllocationSample& sample = slot->sample;
+  sample.byte_count = byte_count;
+  sample.tid = self->GetTid();
+  sample.depth = 0;
+  {
+    StackHandleScope<1> hs(self);
+    auto obj_wrapper = hs.NewHandleWrapper(obj);
+    StackVisitor::WalkStack(
+        [&](const art::StackVisitor* stack_visitor) REQUIRES_SHARED(Locks::mutator_lock_) {
+          if (sample.depth >= AllocationSample::kMaxStackDepth) {
+            return false;
+          }
+          ArtMethod* m = stack_visitor->GetMethod();
+          // m may be null if we have inlined methods of unresolved classes. b/27858645
+          if (m != nullptr && !m->IsRuntimeMethod()) {
+            m = m->GetInterfaceMethodIfProxy(kRuntimePointerSize);
+            sample.frames[sample.depth++] =
+                AllocRecordStackTraceElement(m, stack_visitor->GetDexPc());
+          }
+          return true;
+        },
+        self,
+        /* context= */ nullptr,
+        art::StackVisitor::StackWalkKind::kIncludeInlinedFrames);
+  }
+  sample.klass = GcRoot<mirror::Class>((*obj)->GetClass());
+  // Publish the sample to the consumer and the GC.
+  slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void AllocationSampler::VisitRoots(RootVisitor* visitor) {
+  BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(visitor, RootInfo(kRootDebugger));
+  // Only the consumer frees slots, and it holds the alloc tracker lock, so the published samples
+  // seen here stay published during the visit. Samples still being recorded are skipped, their
+  // class is read after the thread roots were visited.
+  size_t end = enqueue_position_.load(std::memory_order_acquire);
+  for (size_t position = dequeue_position_; position != end; ++position) {
+    Slot& slot = slots_[position % kNumSlots];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+      continue;
+    }
+    AllocationSample& sample = slot.sample;
+    buffered_visitor.VisitRootIfNonNull(sample.klass);
+    for (size_t i = 0; i < sample.depth; ++i) {
+      sample.frames[i].GetMethod()->VisitRoots(buffered_visitor, kRuntimePointerSize);
+    }
+  }
+}
+
+}  // namespace gc
+}  // namespace art
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+#define ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+
+#include <atomic>
+#include <memory>
+
+#include "allocation_record.h"
+#include "base/mutex.h"
+#include "gc_root.h"
+#include "obj_ptr.h"
+
+namespace art {
+
+class RootVisitor;
+class Thread;
+
+namespace mirror {
+class Class;
+class Object;
+}  // namespace mirror
+
+namespace gc {
+
+// A sampled allocation, with the innermost frames of the allocating thread's stack.
+struct AllocationSample {
+  static constexpr size_t kMaxStackDepth = 8;
+
+  GcRoot<mirror::Class> klass;
+  size_t byte_count;
+  pid_t tid;
+  uint32_t depth;
+  AllocRecordStackTraceElement frames[kMaxStackDepth];
+};
+
+// Records a sample of the allocations, taken on average every `interval` allocated bytes of each
+// thread. Unlike AllocRecordObjectMap, recording a sample takes no lock: samples go to a bounded
+// ring buffer, and are dropped while it is full. A single consumer drains the buffer, under the
+// alloc tracker lock, which also excludes the GC visiting the buffered classes and methods.
+class AllocationSampler {
+ public:
+  static constexpr size_t kNumSlots = 1024;
+
+  AllocationSampler();
+
+  // Returns the number of bytes the thread allocates until its next sample. The distances between
+  // samples are exponentially distributed with a mean of `interval`, so that the sampled
+  // allocations do not depend on allocation patterns.
+  static size_t NextSampleDistance(Thread* self, size_t interval);
+
+  // Records a sample of the allocation of `obj`, unless the ring buffer is full.
+  void RecordSample(Thread* self, ObjPtr<mirror::Object>* obj, size_t byte_count)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Removes up to `max_samples` samples from the ring buffer, oldest first, and calls `visitor`
+  // on each of them. Returns the number of samples visited.
+  template <typename Visitor>
+  size_t Drain(size_t max_samples, const Visitor& visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(Locks::alloc_tracker_lock_);
+
+  // Visits the classes of the buffered samples and the methods in their stacks as roots, so that
+  // they stay valid until the samples are drained.
+  void VisitRoots(RootVisitor* visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(Locks::alloc_tracker_lock_);
+
+  // Number of samples lost because the ring buffer was full.
+  size_t GetDroppedSamples() const {
+    return dropped_samples_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Slot {
+    // Equal to the position of the slot in the sequence of samples when it is free to record that
+    // sample, and to the position plus one once the sample is recorded.
+    std::atomic<size_t> sequence;
+    AllocationSample sample;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  // Position of the next sample to record.
+  std::atomic<size_t> enqueue_position_;
+  // Position of the next sample to drain.
+  size_t dequeue_position_ GUARDED_BY(Locks::alloc_tracker_lock_);
+  std::atomic<size_t> dropped_samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampler);
+};
+
+template <typename Visitor>
+inline size_t AllocationSampler::Drain(size_t max_samples, const Visitor& visitor) {
+  size_t count = 0;
+  for (; count < max_samples; ++count) {
+    Slot& slot = slots_[dequeue_position_ % kNumSlots];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_position_ + 1) {
+      break;
+    }
+    visitor(slot.sample);
+    // Hand the slot back to the producers for the sample one lap ahead.
+    slot.sequence.store(dequeue_position_ + kNumSlots, std::memory_order_release);
+    ++dequeue_position_;
+  }
+  return count;
+}
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
@@ -30,6 +30,7 @@
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/accounting/mod_union_table-inl.h"
 #include "gc/accounting/read_barrier_table.h"
+#include "gc/accounting/remembered_set.h"
 #include "gc/accounting/space_bitmap-inl.h"
 #include "gc/gc_pause_listener.h"
 #include "gc/reference_processor.h"
@@ -45,6 +46,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -66,12 +68,17 @@ static constexpr size_t kReadBarrierMarkStackSize = 512 * KB;
 static constexpr size_t kSweepArrayChunkFreeSize = 1024;
 // Verify that there are no missing card marks.
 static constexpr bool kVerifyNoMissingCardMarks = kIsDebugBuild;
+// Minimum size of the GC mark stack, at the start of the marking phase's mark stack processing,
+// for which parallel marking is used.
+static constexpr size_t kMinimumParallelMarkingStackSize = 128;
 
 ConcurrentCopying::ConcurrentCopying(Heap* heap,
                                      bool young_gen,
                                      bool use_generational_cc,
                                      const std::string& name_prefix,
-                                     bool measure_read_barrier_slow_path)
+                                     bool measure_read_barrier_slow_path,
+                                     bool use_parallel_marking,
+                                     bool use_parallel_evacuation)
     : GarbageCollector(heap,
                        name_prefix + (name_prefix.empty() ? "" : " ") +
                        "concurrent copying"),
@@ -117,7 +124,11 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap,
       gc_grays_immune_objects_(false),
       immune_gray_stack_lock_("concurrent copying immune gray stack lock",
                               kMarkSweepMarkStackLock),
-      num_bytes_allocated_before_gc_(0) {
+      num_bytes_allocated_before_gc_(0),
+      use_parallel_marking_(use_parallel_marking),
+      parallel_marking_active_workers_(0),
+      use_parallel_evacuation_(use_parallel_evacuation),
+      parallel_evacuated_objects_(0) {
   static_assert(space::RegionSpace::kRegionSize == accounting::ReadBarrierTable::kRegionSize,
                 "The region space size and the read barrier table region size must match");
   CHECK(use_generational_cc_ || !young_gen_);
@@ -275,6 +286,7 @@ class ConcurrentCopying::ActivateReadBarrierEntrypointsCallback : public Closure
 };
 
 void ConcurrentCopying::ActivateReadBarrierEntrypoints() {
+  ScopedTrace tr(__FUNCTION__);
   Thread* const self = Thread::Current();
   ActivateReadBarrierEntrypointsCheckpoint checkpoint(this);
   ThreadList* thread_list = Runtime::Current()->GetThreadList();
@@ -333,12 +345,18 @@ void ConcurrentCopying::BindBitmaps() {
           DCHECK_EQ(space->GetGcRetentionPolicy(), space::kGcRetentionPolicyAlwaysCollect);
           space->AsContinuousMemMapAllocSpace()->BindLiveToMarkBitmap();
         }
+        accounting::RememberedSet* rem_set = GetYoungGenRememberedSet(space);
         if (young_gen_) {
-          // Age all of the cards for the region space so that we know which evac regions to scan.
-          heap_->GetCardTable()->ModifyCardsAtomic(space->Begin(),
-                                                   space->End(),
-                                                   AgeCardVisitor(),
-                                                   VoidFunctor());
+          // With a remembered set, the cards are aged when they are added to the set in
+          // ScanRememberedSet.
+          if (rem_set == nullptr) {
+            // Age all of the cards for the region space so that we know which evac regions to
+            // scan.
+            heap_->GetCardTable()->ModifyCardsAtomic(space->Begin(),
+                                                     space->End(),
+                                                     AgeCardVisitor(),
+                                                     VoidFunctor());
+          }
         } else {
           // In a full-heap GC cycle, the card-table corresponding to region-space and
           // non-moving space can be cleared, because this cycle only needs to
@@ -348,6 +366,10 @@ void ConcurrentCopying::BindBitmaps() {
           // be captured after the thread-flip of this GC cycle, as that is when
           // the young-gen for the next GC cycle starts getting populated.
           heap_->GetCardTable()->ClearCardRange(space->Begin(), space->Limit());
+          if (rem_set != nullptr) {
+            // Every object is old after a full-heap GC cycle.
+            rem_set->Reset();
+          }
         }
       } else {
         if (space == region_space_) {
@@ -443,6 +465,13 @@ class ConcurrentCopying::ThreadFlipVisitor : public Closure, public RootVisitor
     CHECK(thread == self || thread->IsSuspended() || thread->GetState() == kWaitingPerformingGc)
         << thread->GetState() << " thread " << thread << " self " << self;
     thread->SetIsGcMarkingAndUpdateEntrypoints(true);
+    if (use_tlab_) {
+      Heap::UpdateTlabSizeHintAtGc(thread);
+    }
+    if (Heap::kBufferNativeAllocations) {
+      // This GC already accounts for the flushed bytes, no need to check for a native GC.
+      concurrent_copying_->heap_->FlushNativeAllocationBuffer(thread);
+    }
     if (use_tlab_ && thread->HasTlab()) {
       // We should not reuse the partially utilized TLABs revoked here as they
       // are going to be part of from-space.
@@ -709,12 +738,23 @@ class ConcurrentCopying::VerifyNoMissingCardMarkVisitor {
 };
 
 void ConcurrentCopying::VerifyNoMissingCardMarks() {
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  accounting::RememberedSet* const region_space_rem_set = GetYoungGenRememberedSet(region_space_);
+  accounting::RememberedSet* const non_moving_space_rem_set =
+      GetYoungGenRememberedSet(heap_->non_moving_space_);
+  auto is_remembered = [&](mirror::Object* obj) {
+    accounting::RememberedSet* rem_set = region_space_->HasAddress(obj)
+        ? region_space_rem_set
+        : (heap_->non_moving_space_->HasAddress(obj) ? non_moving_space_rem_set : nullptr);
+    return rem_set != nullptr && rem_set->ContainsCard(card_table->CardFromAddr(obj));
+  };
   auto visitor = [&](mirror::Object* obj)
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_) {
     // Objects on clean cards should never have references to newly allocated regions. Note
-    // that aged cards are also not clean.
-    if (heap_->GetCardTable()->GetCard(obj) == gc::accounting::CardTable::kCardClean) {
+    // that aged cards are also not clean, and that remembered cards may be clean.
+    if (card_table->GetCard(obj) == gc::accounting::CardTable::kCardClean &&
+        !is_remembered(obj)) {
       VerifyNoMissingCardMarkVisitor internal_visitor(this, /*holder=*/ obj);
       obj->VisitReferences</*kVisitNativeRoots=*/true, kVerifyNone, kWithoutReadBarrier>(
           internal_visitor, internal_visitor);
@@ -1073,15 +1113,180 @@ void ConcurrentCopying::CaptureThreadRootsForMarking() {
   }
 }
 
+// A work-stealing queue used by the parallel marking mode. Each parallel marking worker owns one
+// queue, publishes surplus work to it and refills from it; idle workers steal from the queues of
+// other workers.
+struct ConcurrentCopying::ParallelMarkQueue {
+  static constexpr size_t kInitialCapacity = 16 * KB;
+
+  ParallelMarkQueue()
+      : lock("concurrent copying parallel mark queue lock", kMarkSweepMarkStackLock),
+        stack(accounting::ObjectStack::Create("concurrent copying parallel mark queue",
+                                              kInitialCapacity,
+                                              kInitialCapacity)),
+        size(0) {}
+
+  Mutex lock;
+  std::unique_ptr<accounting::ObjectStack> stack GUARDED_BY(lock);
+  // Copy of `stack->Size()` that can be read without holding `lock`. Used as a hint by idle
+  // workers looking for work and for termination detection.
+  Atomic<size_t> size;
+};
+
+class ConcurrentCopying::ParallelMarkingTask : public Task {
+ public:
+  ParallelMarkingTask(ConcurrentCopying* concurrent_copying, size_t index)
+      : concurrent_copying_(concurrent_copying),
+        index_(index),
+        local_pos_(0),
+        marked_objects_(0),
+        steals_(0) {}
+
+  ALWAYS_INLINE void MarkStackPush(mirror::Object* ref) REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (UNLIKELY(local_pos_ == kLocalSize)) {
+      // Local buffer overflow, publish the older half so that idle workers can steal it.
+      Publish(Thread::Current(), kLocalSize / 2);
+    }
+    DCHECK_LT(local_pos_, kLocalSize);
+    local_[local_pos_++].Assign(ref);
+  }
+
+  void Run(Thread* self) override REQUIRES_SHARED(Locks::mutator_lock_) {
+    ScopedTrace trace("ParallelMarkingTask");
+    ParallelMarkQueue* own_queue = concurrent_copying_->parallel_mark_queues_[index_].get();
+    do {
+      while (local_pos_ != 0 || TakeFrom(self, own_queue)) {
+        mirror::Object* ref = local_[--local_pos_].AsMirrorPtr();
+        concurrent_copying_->AddLiveBytesAndScanRef</*kParallel=*/ true>(ref, this);
+        ++marked_objects_;
+      }
+    } while (Steal(self) || WaitForWork(self));
+    DCHECK_EQ(local_pos_, 0u);
+  }
+
+  size_t GetMarkedObjects() const {
+    return marked_objects_;
+  }
+
+  size_t GetSteals() const {
+    return steals_;
+  }
+
+ private:
+  // Size of the local buffer that the worker pushes onto and pops from without synchronization.
+  static constexpr size_t kLocalSize = 512;
+
+  // Move the `count` oldest references of the local buffer to this worker's queue.
+  void Publish(Thread* self, size_t count) REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK_LE(count, local_pos_);
+    ParallelMarkQueue* queue = concurrent_copying_->parallel_mark_queues_[index_].get();
+    {
+      MutexLock mu(self, queue->lock);
+      accounting::ObjectStack* stack = queue->stack.get();
+      if (UNLIKELY(stack->Size() + count > stack->Capacity())) {
+        std::vector<StackReference<mirror::Object>> temp(stack->Begin(), stack->End());
+        stack->Resize(std::max(stack->Capacity() * 2, stack->Size() + count));
+        for (auto& ref : temp) {
+          stack->PushBack(ref.AsMirrorPtr());
+        }
+      }
+      for (size_t i = 0; i < count; ++i) {
+        stack->PushBack(local_[i].AsMirrorPtr());
+      }
+      queue->size.store(stack->Size(), std::memory_order_relaxed);
+    }
+    std::copy(local_ + count, local_ + local_pos_, local_);
+    local_pos_ -= count;
+  }
+
+  // Move up to half of the local buffer's worth of references from `queue` to the (empty) local
+  // buffer. Returns false if `queue` was empty.
+  bool TakeFrom(Thread* self, ParallelMarkQueue* queue) REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK_EQ(local_pos_, 0u);
+    if (queue->size.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    MutexLock mu(self, queue->lock);
+    accounting::ObjectStack* stack = queue->stack.get();
+    // Take at most half of the queue when stealing, so that the owner keeps some of its work.
+    size_t available = stack->Size();
+    if (queue != concurrent_copying_->parallel_mark_queues_[index_].get()) {
+      available = (available + 1) / 2;
+    }
+    size_t count = std::min(available, kLocalSize / 2);
+    std::copy(stack->End() - count, stack->End(), local_);
+    stack->PopBackCount(count);
+    queue->size.store(stack->Size(), std::memory_order_relaxed);
+    local_pos_ = count;
+    return count != 0;
+  }
+
+  // Try to steal work from other workers' queues. Returns false if all of them were empty.
+  bool Steal(Thread* self) REQUIRES_SHARED(Locks::mutator_lock_) {
+    const size_t num_queues = concurrent_copying_->parallel_mark_queues_.size();
+    for (size_t i = 1; i < num_queues; ++i) {
+      ParallelMarkQueue* victim =
+          concurrent_copying_->parallel_mark_queues_[(index_ + i) % num_queues].get();
+      if (TakeFrom(self, victim)) {
+        ++steals_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Called when this worker has no work left. Wait until either some other worker publishes work,
+  // which is then stolen and true is returned, or all workers are idle, in which case there is no
+  // work left anywhere and false is returned.
+  bool WaitForWork(Thread* self) REQUIRES_SHARED(Locks::mutator_lock_) {
+    Atomic<size_t>& active_workers = concurrent_copying_->parallel_marking_active_workers_;
+    active_workers.fetch_sub(1, std::memory_order_seq_cst);
+    while (true) {
+      bool has_work = false;
+      for (auto& queue : concurrent_copying_->parallel_mark_queues_) {
+        if (queue->size.load(std::memory_order_relaxed) != 0) {
+          has_work = true;
+          break;
+        }
+      }
+      if (has_work) {
+        // Become active before stealing so that no other worker concludes that marking is done
+        // while we hold the stolen references.
+        active_workers.fetch_add(1, std::memory_order_seq_cst);
+        if (Steal(self)) {
+          return true;
+        }
+        active_workers.fetch_sub(1, std::memory_order_seq_cst);
+      } else if (active_workers.load(std::memory_order_seq_cst) == 0) {
+        // No worker can publish more work, and all queues are empty.
+        return false;
+      } else {
+        sched_yield();
+      }
+    }
+  }
+
+  ConcurrentCopying* const concurrent_copying_;
+  const size_t index_;
+  StackReference<mirror::Object> local_[kLocalSize];
+  size_t local_pos_;
+  size_t marked_objects_;
+  size_t steals_;
+};
+
 // Used to scan ref fields of an object.
-template <bool kHandleInterRegionRefs>
+template <bool kHandleInterRegionRefs, bool kParallel>
 class ConcurrentCopying::ComputeLiveBytesAndMarkRefFieldsVisitor {
  public:
   explicit ComputeLiveBytesAndMarkRefFieldsVisitor(ConcurrentCopying* collector,
-                                                   size_t obj_region_idx)
+                                                   size_t obj_region_idx,
+                                                   ParallelMarkingTask* task = nullptr)
       : collector_(collector),
       obj_region_idx_(obj_region_idx),
-      contains_inter_region_idx_(false) {}
+      task_(task),
+      contains_inter_region_idx_(false) {
+    DCHECK_EQ(kParallel, task != nullptr);
+  }
 
   void operator()(mirror::Object* obj, MemberOffset offset, bool /* is_static */) const
       ALWAYS_INLINE
@@ -1132,7 +1337,11 @@ class ConcurrentCopying::ComputeLiveBytesAndMarkRefFieldsVisitor {
       // Nothing to do.
       return;
     }
-    if (!collector_->TestAndSetMarkBitForRef(ref)) {
+    if (kParallel) {
+      if (!collector_->TestAndSetMarkBitForRef</*kAtomic=*/ true>(ref)) {
+        task_->MarkStackPush(ref);
+      }
+    } else if (!collector_->TestAndSetMarkBitForRef(ref)) {
       collector_->PushOntoLocalMarkStack(ref);
     }
     if (kHandleInterRegionRefs && !contains_inter_region_idx_) {
@@ -1148,10 +1357,12 @@ class ConcurrentCopying::ComputeLiveBytesAndMarkRefFieldsVisitor {
 
   ConcurrentCopying* const collector_;
   const size_t obj_region_idx_;
+  ParallelMarkingTask* const task_;
   mutable bool contains_inter_region_idx_;
 };
 
-void ConcurrentCopying::AddLiveBytesAndScanRef(mirror::Object* ref) {
+template <bool kParallel>
+void ConcurrentCopying::AddLiveBytesAndScanRef(mirror::Object* ref, ParallelMarkingTask* task) {
   DCHECK(ref != nullptr);
   DCHECK(!immune_spaces_.ContainsObject(ref));
   DCHECK(TestMarkBitmapForRef(ref));
@@ -1164,11 +1375,15 @@ void ConcurrentCopying::AddLiveBytesAndScanRef(mirror::Object* ref) {
       // to update live_bytes_.
       size_t obj_size = ref->SizeOf<kDefaultVerifyFlags>();
       size_t alloc_size = RoundUp(obj_size, space::RegionSpace::kAlignment);
-      region_space_->AddLiveBytes(ref, alloc_size);
+      if (kParallel) {
+        region_space_->AtomicAddLiveBytes(ref, alloc_size);
+      } else {
+        region_space_->AddLiveBytes(ref, alloc_size);
+      }
     }
   }
-  ComputeLiveBytesAndMarkRefFieldsVisitor</*kHandleInterRegionRefs*/ true>
-      visitor(this, obj_region_idx);
+  ComputeLiveBytesAndMarkRefFieldsVisitor</*kHandleInterRegionRefs*/ true, kParallel>
+      visitor(this, obj_region_idx, task);
   ref->VisitReferences</*kVisitNativeRoots=*/ true, kDefaultVerifyFlags, kWithoutReadBarrier>(
       visitor, visitor);
   // Mark the corresponding card dirty if the object contains any
@@ -1181,7 +1396,13 @@ void ConcurrentCopying::AddLiveBytesAndScanRef(mirror::Object* ref) {
       // only class object reference, which is either in some immune-space, or
       // in non-moving-space.
       DCHECK(heap_->non_moving_space_->HasAddress(ref));
-      non_moving_space_inter_region_bitmap_.Set(ref);
+      if (kParallel) {
+        non_moving_space_inter_region_bitmap_.AtomicTestAndSet(ref);
+      } else {
+        non_moving_space_inter_region_bitmap_.Set(ref);
+      }
+    } else if (kParallel) {
+      region_space_inter_region_bitmap_.AtomicTestAndSet(ref);
     } else {
       region_space_inter_region_bitmap_.Set(ref);
     }
@@ -1258,12 +1479,18 @@ void ConcurrentCopying::PushOntoLocalMarkStack(mirror::Object* ref) {
 }
 
 void ConcurrentCopying::ProcessMarkStackForMarkingAndComputeLiveBytes() {
-  // Process thread-local mark stack containing thread roots
+  const size_t thread_count = use_parallel_marking_ ? GetConcurrentThreadCount() : 1;
+  // Process thread-local mark stack containing thread roots. In the parallel mode, the thread
+  // roots are moved to the GC mark stack and distributed among the workers below.
   ProcessThreadLocalMarkStacks(/* disable_weak_ref_access */ false,
                                /* checkpoint_callback */ nullptr,
-                               [this] (mirror::Object* ref)
+                               [this, thread_count] (mirror::Object* ref)
                                    REQUIRES_SHARED(Locks::mutator_lock_) {
-                                 AddLiveBytesAndScanRef(ref);
+                                 if (thread_count > 1) {
+                                   PushOntoLocalMarkStack(ref);
+                                 } else {
+                                   AddLiveBytesAndScanRef(ref);
+                                 }
                                });
   {
     MutexLock mu(thread_running_gc_, mark_stack_lock_);
@@ -1272,12 +1499,142 @@ void ConcurrentCopying::ProcessMarkStackForMarkingAndComputeLiveBytes() {
     CHECK_EQ(pooled_mark_stacks_.size(), kMarkStackPoolSize);
   }
 
+  if (thread_count > 1 && gc_mark_stack_->Size() >= kMinimumParallelMarkingStackSize) {
+    ProcessMarkStackForMarkingParallel(thread_count);
+  }
   while (!gc_mark_stack_->IsEmpty()) {
     mirror::Object* ref = gc_mark_stack_->PopBack();
     AddLiveBytesAndScanRef(ref);
   }
 }
 
+size_t ConcurrentCopying::GetConcurrentThreadCount() const {
+  // Like MarkSweep, use less threads if we are in a background state (non jank perceptible) since
+  // we want to leave more CPU time for the foreground apps.
+  if (heap_->GetThreadPool() == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return heap_->ClampGcThreadCount(heap_->GetConcGCThreadCount() + 1);
+}
+
+class ConcurrentCopying::ParallelEvacuationTask : public Task {
+ public:
+  ParallelEvacuationTask(ConcurrentCopying* concurrent_copying,
+                         const std::vector<std::pair<uint8_t*, uint8_t*>>* ranges,
+                         Atomic<size_t>* next_range)
+      : concurrent_copying_(concurrent_copying),
+        ranges_(ranges),
+        next_range_(next_range),
+        evacuated_objects_(0) {}
+
+  // Like a mutator read barrier, copying an object installs the forwarding pointer with a CAS on
+  // its lock word (see ConcurrentCopying::Copy) and pushes the copy onto this thread's mark stack
+  // so that it gets scanned by the GC thread later.
+  void Run(Thread* self) override REQUIRES_SHARED(Locks::mutator_lock_) {
+    ScopedTrace trace("ParallelEvacuationTask");
+    accounting::ContinuousSpaceBitmap* bitmap = concurrent_copying_->region_space_bitmap_;
+    while (true) {
+      size_t index = next_range_->fetch_add(1, std::memory_order_relaxed);
+      if (index >= ranges_->size()) {
+        break;
+      }
+      const std::pair<uint8_t*, uint8_t*>& range = (*ranges_)[index];
+      bitmap->VisitMarkedRange(
+          reinterpret_cast<uintptr_t>(range.first),
+          reinterpret_cast<uintptr_t>(range.second),
+          [this, self](mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+            if (concurrent_copying_->GetFwdPtr(obj) == nullptr) {
+              concurrent_copying_->Mark(self, obj);
+              ++evacuated_objects_;
+            }
+          });
+    }
+  }
+
+  size_t GetEvacuatedObjects() const {
+    return evacuated_objects_;
+  }
+
+ private:
+  ConcurrentCopying* const concurrent_copying_;
+  const std::vector<std::pair<uint8_t*, uint8_t*>>* const ranges_;
+  Atomic<size_t>* const next_range_;
+  size_t evacuated_objects_;
+};
+
+void ConcurrentCopying::EvacuateFromSpaceParallel(size_t thread_count) {
+  TimingLogger::ScopedTiming split("EvacuateFromSpaceParallel", GetTimings());
+  Thread* const self = Thread::Current();
+  DCHECK_EQ(self, thread_running_gc_);
+  DCHECK_EQ(mark_stack_mode_.load(std::memory_order_relaxed), kMarkStackModeThreadLocal);
+  std::vector<std::pair<uint8_t*, uint8_t*>> ranges;
+  region_space_->GetFromSpaceRegionRanges(&ranges);
+  if (ranges.empty()) {
+    return;
+  }
+  ThreadPool* thread_pool = heap_->GetThreadPool();
+  DCHECK(thread_pool != nullptr);
+  thread_count = std::min({thread_count, thread_pool->GetThreadCount() + 1, ranges.size()});
+  Atomic<size_t> next_range(0);
+  std::vector<std::unique_ptr<ParallelEvacuationTask>> tasks;
+  for (size_t i = 0; i < thread_count; ++i) {
+    tasks.emplace_back(new ParallelEvacuationTask(this, &ranges, &next_range));
+    thread_pool->AddTask(self, tasks.back().get());
+  }
+  // The workers stay in the native state and rely on the GC thread holding the mutator lock, as
+  // in MarkSweep::ProcessMarkStackParallel. Their thread-local mark stacks are revoked on their
+  // behalf by the next mark stack checkpoint.
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ true);
+  thread_pool->StopWorkers(self);
+  for (auto& task : tasks) {
+    parallel_evacuated_objects_ += task->GetEvacuatedObjects();
+  }
+}
+
+void ConcurrentCopying::ProcessMarkStackForMarkingParallel(size_t thread_count) {
+  TimingLogger::ScopedTiming split("ProcessMarkStackForMarkingParallel", GetTimings());
+  Thread* const self = Thread::Current();
+  DCHECK_EQ(self, thread_running_gc_);
+  ThreadPool* thread_pool = heap_->GetThreadPool();
+  DCHECK(thread_pool != nullptr);
+  thread_count = std::min(thread_count, thread_pool->GetThreadCount() + 1);
+  while (parallel_mark_queues_.size() < thread_count) {
+    parallel_mark_queues_.emplace_back(new ParallelMarkQueue());
+    parallel_marked_objects_.push_back(0u);
+    parallel_mark_steals_.push_back(0u);
+  }
+  // Only use the first `thread_count` queues; the other ones stay empty.
+  std::vector<std::unique_ptr<ParallelMarkingTask>> tasks;
+  for (size_t i = 0; i < thread_count; ++i) {
+    tasks.emplace_back(new ParallelMarkingTask(this, i));
+  }
+  // Distribute the GC mark stack round-robin among the worker queues.
+  {
+    size_t i = 0;
+    for (StackReference<mirror::Object>* p = gc_mark_stack_->Begin();
+         p != gc_mark_stack_->End(); ++p, i = (i + 1) % thread_count) {
+      tasks[i]->MarkStackPush(p->AsMirrorPtr());
+    }
+    gc_mark_stack_->Reset();
+  }
+  parallel_marking_active_workers_.store(thread_count, std::memory_order_seq_cst);
+  for (auto& task : tasks) {
+    thread_pool->AddTask(self, task.get());
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ true);
+  thread_pool->StopWorkers(self);
+  CHECK_EQ(parallel_marking_active_workers_.load(std::memory_order_seq_cst), 0u);
+  for (size_t i = 0; i < thread_count; ++i) {
+    DCHECK_EQ(parallel_mark_queues_[i]->size.load(std::memory_order_relaxed), 0u);
+    parallel_marked_objects_[i] += tasks[i]->GetMarkedObjects();
+    parallel_mark_steals_[i] += tasks[i]->GetSteals();
+  }
+}
+
 class ConcurrentCopying::ImmuneSpaceCaptureRefsVisitor {
  public:
   explicit ImmuneSpaceCaptureRefsVisitor(ConcurrentCopying* cc) : collector_(cc) {}
@@ -1430,6 +1787,102 @@ void ConcurrentCopying::ScanDirtyObject(mirror::Object* obj) {
   }
 }
 
+// Checks whether an object references a region allocated since the flip. These objects are young
+// in the next young-generation collection.
+class ConcurrentCopying::NewlyAllocatedRefVisitor {
+ public:
+  explicit NewlyAllocatedRefVisitor(ConcurrentCopying* cc)
+      : cc_(cc), references_newly_allocated_(false) {}
+
+  void operator()(ObjPtr<mirror::Object> obj,
+                  MemberOffset offset,
+                  bool is_static ATTRIBUTE_UNUSED) const
+      REQUIRES_SHARED(Locks::mutator_lock_) ALWAYS_INLINE {
+    CheckReference(
+        obj->GetFieldObject<mirror::Object, kVerifyNone, kWithoutReadBarrier>(offset));
+  }
+
+  void operator()(ObjPtr<mirror::Class> klass ATTRIBUTE_UNUSED,
+                  ObjPtr<mirror::Reference> ref) const
+      REQUIRES_SHARED(Locks::mutator_lock_) ALWAYS_INLINE {
+    CheckReference(ref->GetReferent<kWithoutReadBarrier>());
+  }
+
+  void VisitRootIfNonNull(mirror::CompressedReference<mirror::Object>* root) const
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (!root->IsNull()) {
+      VisitRoot(root);
+    }
+  }
+
+  void VisitRoot(mirror::CompressedReference<mirror::Object>* root) const
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    CheckReference(root->AsMirrorPtr());
+  }
+
+  bool ReferencesNewlyAllocated() const {
+    return references_newly_allocated_;
+  }
+
+ private:
+  void CheckReference(mirror::Object* ref) const REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (!references_newly_allocated_ &&
+        ref != nullptr &&
+        cc_->region_space_->IsInNewlyAllocatedRegion(ref)) {
+      references_newly_allocated_ = true;
+    }
+  }
+
+  ConcurrentCopying* const cc_;
+  mutable bool references_newly_allocated_;
+};
+
+accounting::RememberedSet* ConcurrentCopying::GetYoungGenRememberedSet(
+    space::ContinuousSpace* space) {
+  if (!heap_->UseGenerationalCCRememberedSet()) {
+    return nullptr;
+  }
+  return heap_->FindRememberedSetFromSpace(space);
+}
+
+void ConcurrentCopying::ScanRememberedSet(space::ContinuousSpace* space,
+                                          accounting::RememberedSet* rem_set) {
+  DCHECK(young_gen_);
+  TimingLogger::ScopedTiming split("ScanRememberedSet", GetTimings());
+  // Age the cards dirtied since the last scan and add them to the cards remembered from previous
+  // collections. Cards that were aged by the last scan are cleared, the cards among them that
+  // still matter were kept in the set.
+  rem_set->ClearCards();
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  accounting::ContinuousSpaceBitmap* const bitmap = space->GetMarkBitmap();
+  rem_set->FilterCards([&](uint8_t* card) REQUIRES(Locks::heap_bitmap_lock_)
+                           REQUIRES_SHARED(Locks::mutator_lock_) {
+    uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card));
+    if (space == region_space_ &&
+        !region_space_->IsInUnevacFromSpace(reinterpret_cast<mirror::Object*>(start))) {
+      // Evacuated regions are reclaimed and regions allocated since the flip hold young
+      // objects. Neither needs a remembered card.
+      return false;
+    }
+    NewlyAllocatedRefVisitor ref_visitor(this);
+    bitmap->VisitMarkedRange(
+        start,
+        start + accounting::CardTable::kCardSize,
+        [&](mirror::Object* obj) REQUIRES(Locks::heap_bitmap_lock_)
+            REQUIRES_SHARED(Locks::mutator_lock_) {
+          // Don't push or gray unevac refs.
+          ScanDirtyObject</*kNoUnEvac*/ true>(obj);
+          if (!ref_visitor.ReferencesNewlyAllocated()) {
+            obj->VisitReferences</*kVisitNativeRoots=*/ true, kVerifyNone, kWithoutReadBarrier>(
+                ref_visitor, ref_visitor);
+          }
+        });
+    // Keep the card if one of its objects was handed a reference to a young object after the
+    // flip. The card may be clean by the next collection.
+    return ref_visitor.ReferencesNewlyAllocated();
+  });
+}
+
 // Concurrently mark roots that are guarded by read barriers and process the mark stack.
 void ConcurrentCopying::CopyingPhase() {
   TimingLogger::ScopedTiming split("CopyingPhase", GetTimings());
@@ -1443,6 +1896,15 @@ void ConcurrentCopying::CopyingPhase() {
     CHECK(weak_ref_access_enabled_);
   }
 
+  // The marking phase of 2-phase full heap CC left the reachable from-space objects marked in the
+  // region space bitmap. Copy them in parallel now, rather than one at a time as they are reached.
+  if (use_parallel_evacuation_ && use_generational_cc_ && !young_gen_ && !force_evacuate_all_) {
+    const size_t thread_count = GetConcurrentThreadCount();
+    if (thread_count > 1) {
+      EvacuateFromSpaceParallel(thread_count);
+    }
+  }
+
   // Scan immune spaces.
   // Update all the fields in the immune spaces first without graying the objects so that we
   // minimize dirty pages in the immune spaces. Note mutators can concurrently access and gray some
@@ -1480,6 +1942,11 @@ void ConcurrentCopying::CopyingPhase() {
       //   which is an immune space.
       // - In the case where we run without a boot image, these classes are allocated in the
       //   non-moving space (see art::ClassLinker::InitWithoutImage).
+      accounting::RememberedSet* rem_set = GetYoungGenRememberedSet(space);
+      if (young_gen_ && rem_set != nullptr) {
+        ScanRememberedSet(space, rem_set);
+        continue;
+      }
       card_table->Scan<false>(
           space->GetMarkBitmap(),
           space->Begin(),
@@ -1774,6 +2241,7 @@ void ConcurrentCopying::DisableMarking() {
 }
 
 void ConcurrentCopying::IssueEmptyCheckpoint() {
+  ScopedTrace tr(__FUNCTION__);
   Thread* self = Thread::Current();
   ThreadList* thread_list = Runtime::Current()->GetThreadList();
   // Release locks then wait for all mutator threads to pass the barrier.
@@ -2034,6 +2502,7 @@ class ConcurrentCopying::AssertToSpaceInvariantFieldVisitor {
 
 void ConcurrentCopying::RevokeThreadLocalMarkStacks(bool disable_weak_ref_access,
                                                     Closure* checkpoint_callback) {
+  ScopedTrace tr(__FUNCTION__);
   Thread* self = Thread::Current();
   RevokeThreadLocalMarkStackCheckpoint check_point(this, disable_weak_ref_access);
   ThreadList* thread_list = Runtime::Current()->GetThreadList();
@@ -2725,6 +3194,10 @@ void ConcurrentCopying::ReclaimPhase() {
     cumulative_bytes_moved_.fetch_add(to_bytes, std::memory_order_relaxed);
     uint64_t to_objects = objects_moved_.load(std::memory_order_relaxed) + objects_moved_gc_thread_;
     cumulative_objects_moved_.fetch_add(to_objects, std::memory_order_relaxed);
+    if (UNLIKELY(ATraceEnabled())) {
+      ATraceIntegerValue("GC copied (KB)", static_cast<int32_t>(to_bytes / KB));
+      ATraceIntegerValue("GC copied objects", static_cast<int32_t>(to_objects));
+    }
     if (kEnableFromSpaceAccountingCheck) {
       CHECK_EQ(from_space_num_objects_at_first_pause_, from_objects + unevac_from_objects);
       CHECK_EQ(from_space_num_bytes_at_first_pause_, from_bytes + unevac_from_bytes);
@@ -3863,6 +4336,14 @@ void ConcurrentCopying::DumpPerformanceInfo(std::ostream& os) {
      << ") / " << region_space_->GetNumRegions() / 2 << " ("
      << PrettySize(region_space_->GetNumRegions() * space::RegionSpace::kRegionSize / 2)
      << ")\n";
+
+  if (parallel_evacuated_objects_ != 0) {
+    os << "Cumulative objects evacuated in parallel " << parallel_evacuated_objects_ << "\n";
+  }
+  for (size_t i = 0; i < parallel_marked_objects_.size(); ++i) {
+    os << "Parallel marking worker " << i << ": " << parallel_marked_objects_[i]
+       << " objects marked, " << parallel_mark_steals_[i] << " steals\n";
+  }
 }
 
 }  // namespace collector
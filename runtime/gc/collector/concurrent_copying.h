@@ -47,6 +47,7 @@ template <size_t kAlignment> class SpaceBitmap;
 typedef SpaceBitmap<kObjectAlignment> ContinuousSpaceBitmap;
 class HeapBitmap;
 class ReadBarrierTable;
+class RememberedSet;
 }  // namespace accounting
 
 namespace space {
@@ -71,7 +72,9 @@ class ConcurrentCopying : public GarbageCollector {
                     bool young_gen,
                     bool use_generational_cc,
                     const std::string& name_prefix = "",
-                    bool measure_read_barrier_slow_path = false);
+                    bool measure_read_barrier_slow_path = false,
+                    bool use_parallel_marking = false,
+                    bool use_parallel_evacuation = false);
   ~ConcurrentCopying();
 
   void RunPhases() override
@@ -158,6 +161,10 @@ class ConcurrentCopying : public GarbageCollector {
   void AssertNoThreadMarkStackMapping(Thread* thread) REQUIRES(!mark_stack_lock_);
 
  private:
+  class ParallelEvacuationTask;
+  class ParallelMarkingTask;
+  struct ParallelMarkQueue;
+
   void PushOntoMarkStack(Thread* const self, mirror::Object* obj)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
@@ -215,6 +222,16 @@ class ConcurrentCopying : public GarbageCollector {
   void VerifyNoMissingCardMarks()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
+  // Returns the remembered set used by young-generation collections for `space`, or null if
+  // young-generation collections scan the aged cards of the space.
+  accounting::RememberedSet* GetYoungGenRememberedSet(space::ContinuousSpace* space);
+  // Scan the objects on the cards of `rem_set` and on the cards dirtied since the last
+  // collection. Only the cards that still hold references to the young generation of the next
+  // collection are kept in `rem_set`.
+  void ScanRememberedSet(space::ContinuousSpace* space, accounting::RememberedSet* rem_set)
+      REQUIRES(Locks::heap_bitmap_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
   template <typename Processor>
   size_t ProcessThreadLocalMarkStacks(bool disable_weak_ref_access,
                                       Closure* checkpoint_callback,
@@ -316,13 +333,29 @@ class ConcurrentCopying : public GarbageCollector {
   void ActivateReadBarrierEntrypoints();
 
   void CaptureThreadRootsForMarking() REQUIRES_SHARED(Locks::mutator_lock_);
-  void AddLiveBytesAndScanRef(mirror::Object* ref) REQUIRES_SHARED(Locks::mutator_lock_);
+  // Add the live bytes of `ref` to its region and mark its reference fields. If `kParallel`, the
+  // mark bits and live bytes are updated atomically and newly marked references are pushed onto
+  // `task`'s work-stealing queue instead of the GC mark stack.
+  template <bool kParallel = false>
+  void AddLiveBytesAndScanRef(mirror::Object* ref, ParallelMarkingTask* task = nullptr)
+      REQUIRES_SHARED(Locks::mutator_lock_);
   bool TestMarkBitmapForRef(mirror::Object* ref) REQUIRES_SHARED(Locks::mutator_lock_);
   template <bool kAtomic = false>
   bool TestAndSetMarkBitForRef(mirror::Object* ref) REQUIRES_SHARED(Locks::mutator_lock_);
   void PushOntoLocalMarkStack(mirror::Object* ref) REQUIRES_SHARED(Locks::mutator_lock_);
   void ProcessMarkStackForMarkingAndComputeLiveBytes() REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
+  // Returns the number of threads (including the GC thread) to use for concurrent parallel work,
+  // or 1 if the heap thread pool should not be used.
+  size_t GetConcurrentThreadCount() const;
+  // Drain the GC mark stack during the marking phase with `thread_count` work-stealing workers.
+  void ProcessMarkStackForMarkingParallel(size_t thread_count)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  // Copy the objects marked during the marking phase out of the from-space regions with
+  // `thread_count` threads, each claiming whole regions.
+  void EvacuateFromSpaceParallel(size_t thread_count)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_, !skipped_blocks_lock_, !immune_gray_stack_lock_);
 
   void RemoveThreadMarkStackMapping(Thread* thread, accounting::ObjectStack* tl_mark_stack)
       REQUIRES(mark_stack_lock_);
@@ -477,6 +510,24 @@ class ConcurrentCopying : public GarbageCollector {
   // Use signed because after_gc may be larger than before_gc.
   int64_t num_bytes_allocated_before_gc_;
 
+  // If true, the marking phase of full-heap generational CC drains the mark stack with the heap
+  // thread pool, using one work-stealing queue per worker.
+  const bool use_parallel_marking_;
+  // The work-stealing queues, indexed by worker. Only resized by the GC thread, between uses.
+  std::vector<std::unique_ptr<ParallelMarkQueue>> parallel_mark_queues_;
+  // Number of parallel marking workers that may still produce work, for termination detection.
+  Atomic<size_t> parallel_marking_active_workers_;
+  // Cumulative number of objects scanned and queues stolen from, per parallel marking worker.
+  // Only updated by the GC thread after the workers finish.
+  std::vector<uint64_t> parallel_marked_objects_;
+  std::vector<uint64_t> parallel_mark_steals_;
+
+  // If true, the copying phase of full-heap generational CC evacuates the objects marked during
+  // the marking phase with the heap thread pool before processing the mark stack.
+  const bool use_parallel_evacuation_;
+  // Cumulative number of objects copied by parallel evacuation. Informative only.
+  uint64_t parallel_evacuated_objects_;
+
   class ActivateReadBarrierEntrypointsCallback;
   class ActivateReadBarrierEntrypointsCheckpoint;
   class AssertToSpaceInvariantFieldVisitor;
@@ -490,6 +541,7 @@ class ConcurrentCopying : public GarbageCollector {
   template <bool kConcurrent> class GrayImmuneObjectVisitor;
   class ImmuneSpaceScanObjVisitor;
   class LostCopyVisitor;
+  class NewlyAllocatedRefVisitor;
   template <bool kNoUnEvac> class RefFieldsVisitor;
   class RevokeThreadLocalMarkStackCheckpoint;
   class ScopedGcGraysImmuneObjects;
@@ -501,7 +553,8 @@ class ConcurrentCopying : public GarbageCollector {
   class ImmuneSpaceCaptureRefsVisitor;
   template <bool kAtomicTestAndSet = false> class CaptureRootsForMarkingVisitor;
   class CaptureThreadRootsForMarkingAndCheckpoint;
-  template <bool kHandleInterRegionRefs> class ComputeLiveBytesAndMarkRefFieldsVisitor;
+  template <bool kHandleInterRegionRefs, bool kParallel = false>
+  class ComputeLiveBytesAndMarkRefFieldsVisitor;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(ConcurrentCopying);
 };
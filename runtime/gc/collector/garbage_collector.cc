@@ -144,7 +144,10 @@ uint64_t GarbageCollector::ExtractRssFromMincore(
 }
 
 void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
-  ScopedTrace trace(android::base::StringPrintf("%s %s GC", PrettyCause(gc_cause), GetName()));
+  // Only format the name when tracing, phases and counters below use constant names.
+  ScopedTrace trace([&]() {
+    return android::base::StringPrintf("%s %s GC", PrettyCause(gc_cause), GetName());
+  });
   Thread* self = Thread::Current();
   uint64_t start_time = NanoTime();
   uint64_t thread_cpu_start_time = ThreadCpuNanoTime();
@@ -166,6 +169,13 @@ void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
   total_freed_bytes_ += freed_bytes;
   // Rounding negative freed bytes to 0 as we are not interested in such corner cases.
   freed_bytes_histogram_.AddValue(std::max<int64_t>(freed_bytes / KB, 0));
+  if (UNLIKELY(ATraceEnabled())) {
+    ATraceIntegerValue("GC freed (KB)",
+                       static_cast<int32_t>(std::max<int64_t>(freed_bytes / KB, 0)));
+    ATraceIntegerValue("GC freed objects",
+                       static_cast<int32_t>(current_iteration->GetFreedObjects() +
+                                            current_iteration->GetFreedLargeObjects()));
+  }
   uint64_t end_time = NanoTime();
   uint64_t thread_cpu_end_time = ThreadCpuNanoTime();
   total_thread_cpu_time_ns_ += thread_cpu_end_time - thread_cpu_start_time;
@@ -856,6 +856,7 @@ class MarkSweep::CardScanTask : public MarkStackTask<false> {
   }
 
   void Run(Thread* self) override NO_THREAD_SAFETY_ANALYSIS {
+    ScopedTrace trace("CardScanTask");
     ScanObjectParallelVisitor visitor(this);
     accounting::CardTable* card_table = mark_sweep_->GetHeap()->GetCardTable();
     size_t cards_scanned = clear_card_
@@ -874,7 +875,8 @@ size_t MarkSweep::GetThreadCount(bool paused) const {
   if (heap_->GetThreadPool() == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
     return 1;
   }
-  return (paused ? heap_->GetParallelGCThreadCount() : heap_->GetConcGCThreadCount()) + 1;
+  return heap_->ClampGcThreadCount(
+      (paused ? heap_->GetParallelGCThreadCount() : heap_->GetConcGCThreadCount()) + 1);
 }
 
 void MarkSweep::ScanGrayObjects(bool paused, uint8_t minimum_age) {
@@ -1014,6 +1016,7 @@ class MarkSweep::RecursiveMarkTask : public MarkStackTask<false> {
 
   // Scans all of the objects
   void Run(Thread* self) override NO_THREAD_SAFETY_ANALYSIS {
+    ScopedTrace trace("RecursiveMarkTask");
     ScanObjectParallelVisitor visitor(this);
     bitmap_->VisitMarkedRange(begin_, end_, visitor);
     // Finish by emptying our local mark stack.
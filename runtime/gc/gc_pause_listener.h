@@ -17,15 +17,38 @@
 #ifndef ART_RUNTIME_GC_GC_PAUSE_LISTENER_H_
 #define ART_RUNTIME_GC_GC_PAUSE_LISTENER_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/macros.h"
+#include "gc/collector/gc_type.h"
+
 namespace art {
 namespace gc {
 
+// What the heap decided for the next collection when pause-time or GC CPU targets are set.
+struct GcSchedulingDecision {
+  // Longest pause of the last collection.
+  uint64_t last_max_pause_ns;
+  // GC CPU time divided by wall time since the previous collection.
+  double gc_cpu_fraction;
+  // Type of the next collection.
+  collector::GcType next_gc_type;
+  // Bytes allocated at which the next concurrent collection starts.
+  size_t concurrent_start_bytes;
+  // Maximum number of GC threads, including the GC thread itself.
+  size_t max_gc_threads;
+};
+
 class GcPauseListener {
  public:
   virtual ~GcPauseListener() {}
 
   virtual void StartPause() = 0;
   virtual void EndPause() = 0;
+
+  // Called after each collection when Heap::HasGcSchedulingTargets().
+  virtual void OnGcSchedulingDecision(const GcSchedulingDecision& decision ATTRIBUTE_UNUSED) {}
 };
 
 }  // namespace gc
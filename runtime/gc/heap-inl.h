@@ -25,6 +25,7 @@
 #include "gc/accounting/atomic_stack.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/allocation_record.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector/semi_space.h"
 #include "gc/space/bump_pointer_space-inl.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -221,6 +222,10 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
       DCHECK(allocation_records_ != nullptr);
       allocation_records_->RecordAllocation(self, &obj, bytes_allocated);
     }
+    if (UNLIKELY(IsAllocationSamplingEnabled()) &&
+        self->CountDownAllocationSample(bytes_allocated)) {
+      SampleAllocation(self, &obj, bytes_allocated);
+    }
     AllocationListener* l = alloc_listener_.load(std::memory_order_seq_cst);
     if (l != nullptr) {
       // Same as above. We assume that a listener that was once stored will never be deleted.
@@ -254,8 +259,22 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
   return obj.Ptr();
 }
 
-// The size of a thread-local allocation stack in the number of references.
+// The initial and maximum size of a thread-local allocation stack segment in the number of
+// references. Threads that refill their segment often get bigger ones, see
+// Heap::PushOnThreadLocalAllocationStackWithInternalGC.
 static constexpr size_t kThreadLocalAllocationStackSize = 128;
+static constexpr size_t kMaxThreadLocalAllocationStackSize = 4 * KB;
+// Number of refills between two revocations after which the segment size doubles.
+static constexpr size_t kThreadLocalAllocationStackRefillsToGrow = 4;
+
+template <typename Visitor>
+inline size_t Heap::DrainAllocationSamples(size_t max_samples, const Visitor& visitor) {
+  MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
+  if (allocation_sampler_ == nullptr) {
+    return 0u;
+  }
+  return allocation_sampler_->Drain(max_samples, visitor);
+}
 
 inline void Heap::PushOnAllocationStack(Thread* self, ObjPtr<mirror::Object>* obj) {
   if (kUseThreadLocalAllocationStack) {
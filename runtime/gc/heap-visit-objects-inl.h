@@ -28,6 +28,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace gc {
@@ -76,6 +77,40 @@ inline void Heap::VisitObjectsPaused(Visitor&& visitor) {
   VisitObjectsInternal(visitor);
 }
 
+template <typename Visitor>
+void Heap::VisitObjectsPausedParallel(Visitor&& visitor) {
+  // Regions are visited in batches, as the non-free regions may be anywhere in the region space.
+  static constexpr size_t kRegionsPerTask = 32u;
+  Thread* self = Thread::Current();
+  Locks::mutator_lock_->AssertExclusiveHeld(self);
+  size_t thread_count = 1;
+  if (thread_pool_ != nullptr && region_space_ != nullptr) {
+    thread_count = std::min(ClampGcThreadCount(parallel_gc_threads_ + 1),
+                            thread_pool_->GetThreadCount() + 1);
+  }
+  if (thread_count <= 1) {
+    VisitObjectsPaused(visitor);
+    return;
+  }
+  // The tasks run in the native state and rely on this thread holding the mutator lock, like the
+  // GC tasks.
+  thread_pool_->AddTask(self, new FunctionTask([this, &visitor](Thread*) NO_THREAD_SAFETY_ANALYSIS {
+    VisitObjectsInternal(visitor);
+  }));
+  const size_t num_regions = region_space_->GetNumRegions();
+  for (size_t begin = 0; begin < num_regions; begin += kRegionsPerTask) {
+    const size_t end = std::min(begin + kRegionsPerTask, num_regions);
+    thread_pool_->AddTask(
+        self, new FunctionTask([this, &visitor, begin, end](Thread*) NO_THREAD_SAFETY_ANALYSIS {
+          region_space_->WalkRegions(visitor, begin, end);
+        }));
+  }
+  thread_pool_->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool_->StartWorkers(self);
+  thread_pool_->Wait(self, /* do_work= */ true, /* may_hold_locks= */ true);
+  thread_pool_->StopWorkers(self);
+}
+
 // Visit objects in the region spaces.
 template <typename Visitor>
 inline void Heap::VisitObjectsInternalRegionSpace(Visitor&& visitor) {
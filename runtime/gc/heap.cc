@@ -16,6 +16,9 @@
 
 #include "heap.h"
 
+#include <sys/mman.h>
+
+#include <cinttypes>
 #include <limits>
 #include "android-base/thread_annotations.h"
 #if defined(__BIONIC__) || defined(__GLIBC__)
@@ -24,7 +27,9 @@
 #include <memory>
 #include <vector>
 
+#include "android-base/file.h"
 #include "android-base/stringprintf.h"
+#include "android-base/strings.h"
 
 #include "allocation_listener.h"
 #include "art_field-inl.h"
@@ -81,6 +86,7 @@
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
 #include "jni/java_vm_ext.h"
+#include "mirror/array-alloc-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/executable-inl.h"
 #include "mirror/field.h"
@@ -96,6 +102,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "verify_object-inl.h"
 #include "well_known_classes.h"
 
@@ -108,6 +115,10 @@ DEFINE_RUNTIME_DEBUG_FLAG(Heap, kStressCollectorTransition);
 // Minimum amount of remaining bytes before a concurrent GC is triggered.
 static constexpr size_t kMinConcurrentRemainingBytes = 128 * KB;
 static constexpr size_t kMaxConcurrentRemainingBytes = 512 * KB;
+// Size of a transparent huge page on the architectures we support.
+static constexpr size_t kHugePageSize = 2 * MB;
+// Minimum number of allocation stack entries for MarkAllocStack to use the GC thread pool.
+static constexpr size_t kMinParallelMarkAllocStackSize = 64 * KB;
 // Sticky GC throughput adjustment, divided by 4. Increasing this causes sticky GC to occur more
 // relative to partial/full GC. This may be desirable since sticky GCs interfere less with mutator
 // threads (lower pauses, use less memory bandwidth).
@@ -151,6 +162,10 @@ static constexpr bool kLogAllGCs = false;
 // allocate with relaxed ergonomics for that long.
 static constexpr size_t kPostForkMaxHeapDurationMS = 2000;
 
+// Share of time (in percent, averaged over 10s) some task must have stalled on memory for a
+// heap trim to skip the usual kHeapTrimWait delay.
+static constexpr double kMemoryPressureTrimThreshold = 10.0;
+
 #if defined(__LP64__) || !defined(ADDRESS_SANITIZER)
 // 300 MB (0x12c00000) - (default non-moving space capacity).
 uint8_t* const Heap::kPreferredAllocSpaceBegin =
@@ -241,6 +256,17 @@ Heap::Heap(size_t initial_size,
            bool measure_gc_performance,
            bool use_homogeneous_space_compaction_for_oom,
            bool use_generational_cc,
+           bool use_parallel_cc_marking,
+           bool use_parallel_cc_evacuation,
+           bool numa_aware_heap,
+           bool trim_non_moving_space,
+           bool use_huge_pages,
+           bool use_parallel_reference_processing,
+           bool use_parallel_system_weak_sweeping,
+           bool use_generational_cc_remembered_set,
+           uint64_t gc_pause_target_ns,
+           double gc_cpu_fraction_target,
+           size_t region_evacuation_copy_budget,
            uint64_t min_interval_homogeneous_space_compaction_by_oom,
            bool dump_region_info_before_gc,
            bool dump_region_info_after_gc,
@@ -335,6 +361,19 @@ Heap::Heap(size_t initial_size,
       pending_heap_trim_(nullptr),
       use_homogeneous_space_compaction_for_oom_(use_homogeneous_space_compaction_for_oom),
       use_generational_cc_(use_generational_cc),
+      trim_non_moving_space_(trim_non_moving_space),
+      non_moving_space_trims_(0U),
+      non_moving_space_trimmed_bytes_(0U),
+      gc_pause_target_ns_(gc_pause_target_ns),
+      gc_cpu_fraction_target_(gc_cpu_fraction_target),
+      gc_scheduling_max_threads_(0U),
+      last_gc_scheduling_cpu_time_ns_(0U),
+      last_gc_scheduling_time_ns_(NanoTime()),
+      use_huge_pages_(use_huge_pages),
+      use_parallel_reference_processing_(use_parallel_reference_processing),
+      use_parallel_system_weak_sweeping_(use_parallel_system_weak_sweeping),
+      use_generational_cc_remembered_set_(use_generational_cc &&
+                                          use_generational_cc_remembered_set),
       running_collection_is_blocking_(false),
       blocking_gc_count_(0U),
       blocking_gc_time_(0U),
@@ -347,6 +386,7 @@ Heap::Heap(size_t initial_size,
                                         kGcCountRateMaxBucketCount),
       alloc_tracking_enabled_(false),
       alloc_record_depth_(AllocRecordObjectMap::kDefaultAllocStackDepth),
+      allocation_sampling_interval_(0u),
       backtrace_lock_(nullptr),
       seen_backtrace_count_(0u),
       unique_backtrace_count_(0u),
@@ -554,8 +594,22 @@ Heap::Heap(size_t initial_size,
     MemMap region_space_mem_map =
         space::RegionSpace::CreateMemMap(kRegionSpaceName, capacity_ * 2, request_begin);
     CHECK(region_space_mem_map.IsValid()) << "No region space mem map";
-    region_space_ = space::RegionSpace::Create(
-        kRegionSpaceName, std::move(region_space_mem_map), use_generational_cc_);
+    region_space_ = space::RegionSpace::Create(kRegionSpaceName,
+                                               std::move(region_space_mem_map),
+                                               use_generational_cc_,
+                                               numa_aware_heap);
+    if (region_evacuation_copy_budget != 0U) {
+      region_space_->SetEvacuationPolicy(space::RegionSpace::EvacuationPolicy::kCopyBudget,
+                                         region_evacuation_copy_budget);
+    }
+    if (use_huge_pages_) {
+      AdviseHugePages(region_space_->GetMemMap()->Begin(),
+                      region_space_->GetMemMap()->Size(),
+                      kRegionSpaceName);
+      AdviseHugePages(region_space_->GetMarkBitmap()->Begin(),
+                      region_space_->GetMarkBitmap()->Size(),
+                      "region space bitmap");
+    }
     AddSpace(region_space_);
   } else if (IsMovingGc(foreground_collector_type_)) {
     // Create bump pointer spaces.
@@ -630,6 +684,9 @@ Heap::Heap(size_t initial_size,
   card_table_.reset(accounting::CardTable::Create(reinterpret_cast<uint8_t*>(kMinHeapAddress),
                                                   4 * GB - kMinHeapAddress));
   CHECK(card_table_.get() != nullptr) << "Failed to create card table";
+  if (use_huge_pages_) {
+    AdviseHugePages(card_table_->MemMapBegin(), card_table_->MemMapSize(), "card table");
+  }
   if (foreground_collector_type_ == kCollectorTypeCC && kUseTableLookupReadBarrier) {
     rb_table_.reset(new accounting::ReadBarrierTable());
     DCHECK(rb_table_->IsAllCleared());
@@ -699,14 +756,18 @@ Heap::Heap(size_t initial_size,
                                                                        /*young_gen=*/false,
                                                                        use_generational_cc_,
                                                                        "",
-                                                                       measure_gc_performance);
+                                                                       measure_gc_performance,
+                                                                       use_parallel_cc_marking,
+                                                                       use_parallel_cc_evacuation);
       if (use_generational_cc_) {
         young_concurrent_copying_collector_ = new collector::ConcurrentCopying(
             this,
             /*young_gen=*/true,
             use_generational_cc_,
             "young",
-            measure_gc_performance);
+            measure_gc_performance,
+            use_parallel_cc_marking,
+            use_parallel_cc_evacuation);
       }
       active_concurrent_copying_collector_ = concurrent_copying_collector_;
       DCHECK(region_space_ != nullptr);
@@ -716,6 +777,15 @@ Heap::Heap(size_t initial_size,
         // At this point, non-moving space should be created.
         DCHECK(non_moving_space_ != nullptr);
         concurrent_copying_collector_->CreateInterRegionRefBitmaps();
+        if (use_generational_cc_remembered_set_) {
+          // Shared by the young and the full collector, the latter empties them.
+          AddRememberedSet(
+              new accounting::RememberedSet("Region space remembered set", this, region_space_));
+          if (FindRememberedSetFromSpace(non_moving_space_) == nullptr) {
+            AddRememberedSet(new accounting::RememberedSet(
+                "Non-moving space remembered set", this, non_moving_space_));
+          }
+        }
       }
       garbage_collectors_.push_back(concurrent_copying_collector_);
       if (use_generational_cc_) {
@@ -845,6 +915,16 @@ void Heap::CreateMainMallocSpace(MemMap&& mem_map,
   VLOG(heap) << "Created main space " << main_space_;
 }
 
+ObjPtr<mirror::Array> Heap::AllocStableArray(Thread* self,
+                                             ObjPtr<mirror::Class> array_class,
+                                             int32_t length) {
+  DCHECK(array_class->IsPrimitiveArray());
+  AllocatorType allocator =
+      (large_object_space_ != nullptr) ? kAllocatorTypeLOS : GetCurrentNonMovingAllocator();
+  return mirror::Array::Alloc(
+      self, array_class, length, array_class->GetComponentSizeShift(), allocator);
+}
+
 void Heap::ChangeAllocator(AllocatorType allocator) {
   if (current_allocator_ != allocator) {
     // These two allocators are only used internally and don't have any entrypoints.
@@ -887,6 +967,29 @@ void Heap::DecrementDisableMovingGC(Thread* self) {
   --disable_moving_gc_count_;
 }
 
+void Heap::PinObject(Thread* self, ObjPtr<mirror::Object> obj) {
+  if (!kUseReadBarrier) {
+    IncrementDisableMovingGC(self);
+  } else if (region_space_ != nullptr && region_space_->HasAddress(obj.Ptr())) {
+    // The thread is runnable, so the region of `obj` cannot become from-space until it is pinned.
+    region_space_->PinObject(obj.Ptr());
+  } else {
+    // For the CC collector, we only need to wait for the thread flip rather than the whole GC
+    // to occur thanks to the to-space invariant.
+    IncrementDisableThreadFlip(self);
+  }
+}
+
+void Heap::UnpinObject(Thread* self, ObjPtr<mirror::Object> obj) {
+  if (!kUseReadBarrier) {
+    DecrementDisableMovingGC(self);
+  } else if (region_space_ != nullptr && region_space_->HasAddress(obj.Ptr())) {
+    region_space_->UnpinObject(obj.Ptr());
+  } else {
+    DecrementDisableThreadFlip(self);
+  }
+}
+
 void Heap::IncrementDisableThreadFlip(Thread* self) {
   // Supposed to be called by mutators. If thread_flip_running_ is true, block. Otherwise, go ahead.
   CHECK(kUseReadBarrier);
@@ -1026,6 +1129,62 @@ void Heap::MarkAllocStackAsLive(accounting::ObjectStack* stack) {
                  stack);
 }
 
+void Heap::AdviseHugePages(void* begin, size_t size, const char* name) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // Only whole huge pages can be backed by one; the region size divides the huge page size so
+  // the aligned part of the region space still starts on a region boundary.
+  static_assert(kHugePageSize % space::RegionSpace::kRegionSize == 0,
+                "Regions must not straddle huge pages");
+  uint8_t* aligned_begin = AlignUp(reinterpret_cast<uint8_t*>(begin), kHugePageSize);
+  uint8_t* aligned_end = AlignDown(reinterpret_cast<uint8_t*>(begin) + size, kHugePageSize);
+  if (aligned_begin >= aligned_end) {
+    VLOG(heap) << name << " is too small for huge pages";
+    return;
+  }
+  if (madvise(aligned_begin, aligned_end - aligned_begin, MADV_HUGEPAGE) != 0) {
+    PLOG(WARNING) << "Failed to use huge pages for " << name << ", using normal pages";
+    return;
+  }
+  huge_page_ranges_.emplace_back(aligned_begin, aligned_end);
+#else
+  UNUSED(begin, size);
+  LOG(WARNING) << "Huge pages not supported, using normal pages for " << name;
+#endif
+}
+
+// Returns the number of bytes of the given ranges that are backed by huge pages according to
+// /proc/self/smaps.
+static size_t GetAnonHugePageBytes(const std::vector<std::pair<uint8_t*, uint8_t*>>& ranges) {
+  size_t huge_page_bytes = 0;
+#if defined(__linux__)
+  std::string smaps;
+  if (!android::base::ReadFileToString("/proc/self/smaps", &smaps)) {
+    return 0;
+  }
+  bool in_range = false;
+  for (const std::string& line : android::base::Split(smaps, "\n")) {
+    uintptr_t start;
+    uintptr_t end;
+    size_t kb;
+    if (sscanf(line.c_str(), "%" SCNxPTR "-%" SCNxPTR " ", &start, &end) == 2) {
+      in_range = false;
+      for (const std::pair<uint8_t*, uint8_t*>& range : ranges) {
+        if (start < reinterpret_cast<uintptr_t>(range.second) &&
+            end > reinterpret_cast<uintptr_t>(range.first)) {
+          in_range = true;
+          break;
+        }
+      }
+    } else if (in_range && sscanf(line.c_str(), "AnonHugePages: %zu kB", &kb) == 1) {
+      huge_page_bytes += kb * KB;
+    }
+  }
+#else
+  UNUSED(ranges);
+#endif
+  return huge_page_bytes;
+}
+
 void Heap::DeleteThreadPool() {
   thread_pool_.reset(nullptr);
 }
@@ -1192,6 +1351,25 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
     }
   }
 
+  if (!huge_page_ranges_.empty()) {
+    size_t advised_bytes = 0;
+    for (const std::pair<uint8_t*, uint8_t*>& range : huge_page_ranges_) {
+      advised_bytes += range.second - range.first;
+    }
+    os << "Huge pages advised: " << PrettySize(advised_bytes)
+       << " backed: " << PrettySize(GetAnonHugePageBytes(huge_page_ranges_)) << "\n";
+  }
+
+  if (region_space_ != nullptr) {
+    region_space_->DumpRegionHistogram(os);
+  }
+
+  const size_t non_moving_space_trims = non_moving_space_trims_.load(std::memory_order_relaxed);
+  if (non_moving_space_trims != 0U) {
+    os << "Non-moving space trims: " << non_moving_space_trims << " released: "
+       << PrettySize(non_moving_space_trimmed_bytes_.load(std::memory_order_relaxed)) << "\n";
+  }
+
   if (kDumpRosAllocStatsOnSigQuit && rosalloc_space_ != nullptr) {
     rosalloc_space_->DumpStats(os);
   }
@@ -1427,9 +1605,9 @@ void Heap::DoPendingCollectorTransition() {
 
 void Heap::Trim(Thread* self) {
   Runtime* const runtime = Runtime::Current();
-  if (!CareAboutPauseTimes()) {
-    // Deflate the monitors, this can cause a pause but shouldn't matter since we don't care
-    // about pauses.
+  // Deflate the monitors, this can cause a pause but shouldn't matter since we don't care
+  // about pauses. Still skip the pause when no monitor could be deflated.
+  if (!CareAboutPauseTimes() && runtime->GetMonitorList()->HasIdleMonitors()) {
     ScopedTrace trace("Deflating monitors");
     // Avoid race conditions on the lock word for CC.
     ScopedGCCriticalSection gcs(self, kGcCauseTrim, kCollectorTypeHeapTrim);
@@ -1503,10 +1681,19 @@ void Heap::TrimSpaces(Thread* self) {
     for (const auto& space : continuous_spaces_) {
       if (space->IsMallocSpace()) {
         gc::space::MallocSpace* malloc_space = space->AsMallocSpace();
-        if (malloc_space->IsRosAllocSpace() || !CareAboutPauseTimes()) {
+        const bool is_non_moving_space = malloc_space == non_moving_space_;
+        if (malloc_space->IsRosAllocSpace() ||
+            !CareAboutPauseTimes() ||
+            (trim_non_moving_space_ && is_non_moving_space)) {
           // Don't trim dlmalloc spaces if we care about pauses since this can hold the space lock
-          // for a long period of time.
-          managed_reclaimed += malloc_space->Trim();
+          // for a long period of time. The non-moving space is an exception when requested: only
+          // the rare non-movable allocations contend on its lock.
+          const size_t reclaimed = malloc_space->Trim();
+          managed_reclaimed += reclaimed;
+          if (is_non_moving_space) {
+            non_moving_space_trims_.fetch_add(1U, std::memory_order_relaxed);
+            non_moving_space_trimmed_bytes_.fetch_add(reclaimed, std::memory_order_relaxed);
+          }
         }
         total_alloc_space_size += malloc_space->Size();
       }
@@ -2476,28 +2663,102 @@ void Heap::FlushAllocStack() {
   allocation_stack_->Reset();
 }
 
-void Heap::MarkAllocStack(accounting::ContinuousSpaceBitmap* bitmap1,
-                          accounting::ContinuousSpaceBitmap* bitmap2,
-                          accounting::LargeObjectBitmap* large_objects,
-                          accounting::ObjectStack* stack) {
-  DCHECK(bitmap1 != nullptr);
-  DCHECK(bitmap2 != nullptr);
-  const auto* limit = stack->End();
-  for (auto* it = stack->Begin(); it != limit; ++it) {
+// Marks the objects of [begin, end) in the bitmap of the space containing them. kAtomic must be
+// set when other threads may be setting bits in the same bitmap words.
+template <bool kAtomic>
+static void MarkAllocStackRange(accounting::ContinuousSpaceBitmap* bitmap1,
+                                accounting::ContinuousSpaceBitmap* bitmap2,
+                                accounting::LargeObjectBitmap* large_objects,
+                                StackReference<mirror::Object>* begin,
+                                StackReference<mirror::Object>* end)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  for (auto* it = begin; it != end; ++it) {
     const mirror::Object* obj = it->AsMirrorPtr();
     if (!kUseThreadLocalAllocationStack || obj != nullptr) {
       if (bitmap1->HasAddress(obj)) {
-        bitmap1->Set(obj);
+        if (kAtomic) {
+          bitmap1->AtomicTestAndSet(obj);
+        } else {
+          bitmap1->Set(obj);
+        }
       } else if (bitmap2->HasAddress(obj)) {
-        bitmap2->Set(obj);
+        if (kAtomic) {
+          bitmap2->AtomicTestAndSet(obj);
+        } else {
+          bitmap2->Set(obj);
+        }
       } else {
         DCHECK(large_objects != nullptr);
-        large_objects->Set(obj);
+        if (kAtomic) {
+          large_objects->AtomicTestAndSet(obj);
+        } else {
+          large_objects->Set(obj);
+        }
       }
     }
   }
 }
 
+class MarkAllocStackTask : public Task {
+ public:
+  MarkAllocStackTask(accounting::ContinuousSpaceBitmap* bitmap1,
+                     accounting::ContinuousSpaceBitmap* bitmap2,
+                     accounting::LargeObjectBitmap* large_objects,
+                     StackReference<mirror::Object>* begin,
+                     StackReference<mirror::Object>* end)
+      : bitmap1_(bitmap1), bitmap2_(bitmap2), large_objects_(large_objects), begin_(begin),
+        end_(end) {}
+
+  // Runs in the native state and relies on the GC thread holding the mutator lock, like the
+  // MarkSweep marking tasks.
+  void Run(Thread* self ATTRIBUTE_UNUSED) override NO_THREAD_SAFETY_ANALYSIS {
+    MarkAllocStackRange</*kAtomic=*/ true>(bitmap1_, bitmap2_, large_objects_, begin_, end_);
+  }
+
+ private:
+  accounting::ContinuousSpaceBitmap* const bitmap1_;
+  accounting::ContinuousSpaceBitmap* const bitmap2_;
+  accounting::LargeObjectBitmap* const large_objects_;
+  StackReference<mirror::Object>* const begin_;
+  StackReference<mirror::Object>* const end_;
+};
+
+void Heap::MarkAllocStack(accounting::ContinuousSpaceBitmap* bitmap1,
+                          accounting::ContinuousSpaceBitmap* bitmap2,
+                          accounting::LargeObjectBitmap* large_objects,
+                          accounting::ObjectStack* stack) {
+  DCHECK(bitmap1 != nullptr);
+  DCHECK(bitmap2 != nullptr);
+  // With many allocating threads the stack is made of many thread-local segments; split it among
+  // the GC threads.
+  const size_t stack_size = stack->Size();
+  size_t thread_count = 1;
+  if (thread_pool_ != nullptr &&
+      stack_size >= kMinParallelMarkAllocStackSize &&
+      Runtime::Current()->InJankPerceptibleProcessState()) {
+    thread_count = std::min(ClampGcThreadCount(parallel_gc_threads_ + 1),
+                            thread_pool_->GetThreadCount() + 1);
+  }
+  if (thread_count <= 1) {
+    MarkAllocStackRange</*kAtomic=*/ false>(
+        bitmap1, bitmap2, large_objects, stack->Begin(), stack->End());
+    return;
+  }
+  Thread* self = Thread::Current();
+  const size_t delta = RoundUp(stack_size, thread_count) / thread_count;
+  std::vector<std::unique_ptr<MarkAllocStackTask>> tasks;
+  for (StackReference<mirror::Object>* begin = stack->Begin(); begin < stack->End();
+       begin += delta) {
+    StackReference<mirror::Object>* end = std::min(begin + delta, stack->End());
+    tasks.emplace_back(new MarkAllocStackTask(bitmap1, bitmap2, large_objects, begin, end));
+    thread_pool_->AddTask(self, tasks.back().get());
+  }
+  thread_pool_->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool_->StartWorkers(self);
+  thread_pool_->Wait(self, /* do_work= */ true, /* may_hold_locks= */ true);
+  thread_pool_->StopWorkers(self);
+}
+
 void Heap::SwapSemiSpaces() {
   CHECK(bump_pointer_space_ != nullptr);
   CHECK(temp_space_ != nullptr);
@@ -2563,7 +2824,12 @@ size_t Heap::GetNativeBytes() {
   // disable GC triggering based on malloc().
   malloc_bytes = 1000;
 #endif
-  return malloc_bytes + native_bytes_registered_.load(std::memory_order_relaxed);
+  size_t registered_bytes = native_bytes_registered_.load(std::memory_order_relaxed);
+  if (kBufferNativeAllocations && registered_bytes > std::numeric_limits<size_t>::max() / 2) {
+    // Frees flushed ahead of the allocations they match, still buffered in another thread.
+    registered_bytes = 0;
+  }
+  return malloc_bytes + registered_bytes;
   // An alternative would be to get RSS from /proc/self/statm. Empirically, that's no
   // more expensive, and it would allow us to count memory allocated by means other than malloc.
   // However it would change as pages are unmapped and remapped due to memory pressure, among
@@ -2675,6 +2941,9 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
   SelfDeletingTask* clear = reference_processor_->CollectClearedReferences(self);
   // Grow the heap so that we know when to perform the next GC.
   GrowForUtilization(collector, bytes_allocated_before_gc);
+  if (HasGcSchedulingTargets()) {
+    ApplyGcSchedulingTargets(collector);
+  }
   LogGC(gc_cause, collector);
   FinishGC(self, gc_type);
   // Actually enqueue all cleared references. Do this after the GC has officially finished since
@@ -3023,8 +3292,16 @@ void Heap::PushOnThreadLocalAllocationStackWithInternalGC(Thread* self,
   DCHECK(!self->PushOnThreadLocalAllocationStack(obj->Ptr()));
   StackReference<mirror::Object>* start_address;
   StackReference<mirror::Object>* end_address;
-  while (!allocation_stack_->AtomicBumpBack(kThreadLocalAllocationStackSize, &start_address,
-                                            &end_address)) {
+  // Each refill is a CAS on the shared allocation stack. Reserve bigger segments for threads that
+  // come back often so that they contend less.
+  size_t chunk_size = std::max(self->GetThreadLocalAllocationStackChunkSize(),
+                               kThreadLocalAllocationStackSize);
+  if (self->RecordThreadLocalAllocationStackRefill() %
+          kThreadLocalAllocationStackRefillsToGrow == 0) {
+    chunk_size = std::min(2 * chunk_size, kMaxThreadLocalAllocationStackSize);
+  }
+  self->SetThreadLocalAllocationStackChunkSize(chunk_size);
+  while (!allocation_stack_->AtomicBumpBack(chunk_size, &start_address, &end_address)) {
     // TODO: Add handle VerifyObject.
     StackHandleScope<1> hs(self);
     HandleWrapperObjPtr<mirror::Object> wrapper(hs.NewHandleWrapper(obj));
@@ -3612,6 +3889,74 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
   }
 }
 
+void Heap::ApplyGcSchedulingTargets(collector::GarbageCollector* collector_ran) {
+  const std::vector<uint64_t>& pause_times = current_gc_iteration_.GetPauseTimes();
+  const uint64_t max_pause_ns =
+      pause_times.empty() ? 0U : *std::max_element(pause_times.begin(), pause_times.end());
+  const uint64_t now = NanoTime();
+  const uint64_t gc_cpu_time_ns = GetTotalGcCpuTime();
+  const uint64_t wall_time_ns = now - last_gc_scheduling_time_ns_;
+  const double gc_cpu_fraction = wall_time_ns == 0U
+      ? 0.0
+      : static_cast<double>(gc_cpu_time_ns - last_gc_scheduling_cpu_time_ns_) / wall_time_ns;
+  last_gc_scheduling_time_ns_ = now;
+  last_gc_scheduling_cpu_time_ns_ = gc_cpu_time_ns;
+
+  const bool over_pause_target = gc_pause_target_ns_ != 0 && max_pause_ns > gc_pause_target_ns_;
+  const bool over_cpu_target =
+      gc_cpu_fraction_target_ != 0.0 && gc_cpu_fraction > gc_cpu_fraction_target_;
+  const size_t max_threads = std::max(parallel_gc_threads_, conc_gc_threads_) + 1;
+  GcSchedulingDecision decision;
+  {
+    MutexLock mu(Thread::Current(), process_state_update_lock_);
+    // Pauses grow with the amount of heap a collection covers, so if a non sticky collection
+    // missed the pause target prefer a sticky one next, unless sticky collections are not keeping
+    // up with the allocations.
+    if (over_pause_target &&
+        collector_ran->GetGcType() != collector::kGcTypeSticky &&
+        FindCollectorByGcType(collector::kGcTypeSticky) != nullptr &&
+        (!IsGcConcurrent() || GetBytesAllocated() <= concurrent_start_bytes_)) {
+      next_gc_type_ = collector::kGcTypeSticky;
+    }
+    // Collecting later means collecting less often; move the trigger towards the footprint in
+    // proportion to how much the CPU target was exceeded.
+    if (over_cpu_target && IsGcConcurrent()) {
+      const size_t target_footprint = target_footprint_.load(std::memory_order_relaxed);
+      if (concurrent_start_bytes_ + kMinConcurrentRemainingBytes < target_footprint) {
+        const size_t headroom = target_footprint - kMinConcurrentRemainingBytes -
+            concurrent_start_bytes_;
+        const double excess = std::min(gc_cpu_fraction / gc_cpu_fraction_target_ - 1.0, 1.0);
+        concurrent_start_bytes_ += static_cast<size_t>(headroom * excess / 2);
+      }
+    }
+    decision.last_max_pause_ns = max_pause_ns;
+    decision.gc_cpu_fraction = gc_cpu_fraction;
+    decision.next_gc_type = next_gc_type_;
+    decision.concurrent_start_bytes = concurrent_start_bytes_;
+  }
+  // Use every GC thread when pauses are too long and a single one when GC uses too much CPU.
+  if (over_pause_target) {
+    decision.max_gc_threads = max_threads;
+  } else if (over_cpu_target) {
+    decision.max_gc_threads = 1U;
+  } else {
+    decision.max_gc_threads = gc_scheduling_max_threads_.load(std::memory_order_relaxed);
+    if (decision.max_gc_threads == 0U) {
+      decision.max_gc_threads = max_threads;
+    }
+  }
+  gc_scheduling_max_threads_.store(decision.max_gc_threads, std::memory_order_relaxed);
+  VLOG(heap) << "GC scheduling: max pause " << PrettyDuration(max_pause_ns)
+             << " GC CPU fraction " << gc_cpu_fraction
+             << " next GC type " << decision.next_gc_type
+             << " concurrent start bytes " << PrettySize(decision.concurrent_start_bytes)
+             << " max GC threads " << decision.max_gc_threads;
+  GcPauseListener* pause_listener = GetGcPauseListener();
+  if (pause_listener != nullptr) {
+    pause_listener->OnGcSchedulingDecision(decision);
+  }
+}
+
 void Heap::ClampGrowthLimit() {
   // Use heap bitmap lock to guard against races with BindLiveToMarkBitmap.
   ScopedObjectAccess soa(Thread::Current());
@@ -3807,19 +4152,40 @@ void Heap::RequestTrim(Thread* self) {
   // to utilization (which is probably inversely proportional to how much benefit we can expect).
   // We could try mincore(2) but that's only a measure of how many pages we haven't given away,
   // not how much use we're making of those pages.
+  // When the system is short of memory, give the pages back right away rather than after the
+  // usual delay, as holding on to them may get the process killed.
+  const uint64_t delta_time = IsUnderMemoryPressure() ? 0u : kHeapTrimWait;
   HeapTrimTask* added_task = nullptr;
   {
     MutexLock mu(self, *pending_task_lock_);
     if (pending_heap_trim_ != nullptr) {
-      // Already have a heap trim request in task processor, ignore this request.
+      // Already have a heap trim request in task processor, ignore this request unless it
+      // needs to run sooner.
+      if (delta_time == 0u) {
+        task_processor_->UpdateTargetRunTime(self, pending_heap_trim_, NanoTime());
+      }
       return;
     }
-    added_task = new HeapTrimTask(kHeapTrimWait);
+    added_task = new HeapTrimTask(delta_time);
     pending_heap_trim_ = added_task;
   }
   task_processor_->AddTask(self, added_task);
 }
 
+bool Heap::IsUnderMemoryPressure() {
+  // The first line of the PSI file is "some avg10=<percent> avg60=... total=...".
+  std::string pressure;
+  if (!android::base::ReadFileToString("/proc/pressure/memory", &pressure)) {
+    return false;
+  }
+  size_t pos = pressure.find("avg10=");
+  if (!android::base::StartsWith(pressure, "some ") || pos == std::string::npos) {
+    return false;
+  }
+  double avg10 = strtod(pressure.c_str() + pos + strlen("avg10="), nullptr);
+  return avg10 >= kMemoryPressureTrimThreshold;
+}
+
 void Heap::IncrementNumberOfBytesFreedRevoke(size_t freed_bytes_revoke) {
   size_t previous_num_bytes_freed_revoke =
       num_bytes_freed_revoke_.fetch_add(freed_bytes_revoke, std::memory_order_relaxed);
@@ -3831,6 +4197,9 @@ void Heap::IncrementNumberOfBytesFreedRevoke(size_t freed_bytes_revoke) {
 }
 
 void Heap::RevokeThreadLocalBuffers(Thread* thread) {
+  if (kBufferNativeAllocations) {
+    FlushNativeAllocationBuffer(thread);
+  }
   if (rosalloc_space_ != nullptr) {
     size_t freed_bytes_revoke = rosalloc_space_->RevokeThreadLocalBuffers(thread);
     if (freed_bytes_revoke > 0U) {
@@ -3957,6 +4326,18 @@ void Heap::NotifyNativeAllocations(JNIEnv* env) {
 void Heap::RegisterNativeAllocation(JNIEnv* env, size_t bytes) {
   // Cautiously check for a wrapped negative bytes argument.
   DCHECK(sizeof(size_t) < 8 || bytes < (std::numeric_limits<size_t>::max() / 2));
+  if (kBufferNativeAllocations && bytes <= kCheckImmediatelyThreshold) {
+    Thread* self = ThreadForEnv(env);
+    ssize_t buffered_bytes = self->AddNativeBytesBuffered(static_cast<ssize_t>(bytes));
+    uint32_t buffered_allocations = self->RecordNativeAllocationBuffered();
+    if (buffered_bytes >= static_cast<ssize_t>(kNativeAllocationBufferBytes) ||
+        buffered_allocations >= kNotifyNativeInterval) {
+      if (FlushNativeAllocationBuffer(self)) {
+        CheckGCForNative(self);
+      }
+    }
+    return;
+  }
   native_bytes_registered_.fetch_add(bytes, std::memory_order_relaxed);
   uint32_t objects_notified =
       native_objects_notified_.fetch_add(1, std::memory_order_relaxed);
@@ -3966,7 +4347,15 @@ void Heap::RegisterNativeAllocation(JNIEnv* env, size_t bytes) {
   }
 }
 
-void Heap::RegisterNativeFree(JNIEnv*, size_t bytes) {
+void Heap::RegisterNativeFree(JNIEnv* env, size_t bytes) {
+  if (kBufferNativeAllocations && bytes <= kCheckImmediatelyThreshold) {
+    Thread* self = ThreadForEnv(env);
+    if (self->AddNativeBytesBuffered(-static_cast<ssize_t>(bytes)) <=
+            -static_cast<ssize_t>(kNativeAllocationBufferBytes)) {
+      FlushNativeAllocationBuffer(self);
+    }
+    return;
+  }
   size_t allocated;
   size_t new_freed_bytes;
   do {
@@ -3979,6 +4368,24 @@ void Heap::RegisterNativeFree(JNIEnv*, size_t bytes) {
                                                               allocated - new_freed_bytes));
 }
 
+bool Heap::FlushNativeAllocationBuffer(Thread* thread) {
+  ssize_t bytes;
+  uint32_t allocations;
+  thread->TakeNativeAllocationBuffer(&bytes, &allocations);
+  if (bytes != 0) {
+    // A negative balance wraps around. The counter may transiently go below zero when frees are
+    // flushed before the matching allocations, see GetNativeBytes.
+    native_bytes_registered_.fetch_add(static_cast<size_t>(bytes), std::memory_order_relaxed);
+  }
+  if (allocations == 0u) {
+    return false;
+  }
+  uint32_t objects_notified =
+      native_objects_notified_.fetch_add(allocations, std::memory_order_relaxed);
+  return objects_notified / kNotifyNativeInterval !=
+      (objects_notified + allocations) / kNotifyNativeInterval;
+}
+
 size_t Heap::GetTotalMemory() const {
   return std::max(target_footprint_.load(std::memory_order_relaxed), GetBytesAllocated());
 }
@@ -4047,6 +4454,47 @@ void Heap::VisitAllocationRecords(RootVisitor* visitor) const {
       GetAllocationRecords()->VisitRoots(visitor);
     }
   }
+  MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
+  if (allocation_sampler_ != nullptr) {
+    allocation_sampler_->VisitRoots(visitor);
+  }
+}
+
+void Heap::SetAllocationSamplingInterval(size_t interval) {
+  Thread* self = Thread::Current();
+  size_t old_interval;
+  {
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    if (interval != 0u && allocation_sampler_ == nullptr) {
+      allocation_sampler_.reset(new AllocationSampler());
+    }
+    old_interval = allocation_sampling_interval_.exchange(interval, std::memory_order_relaxed);
+  }
+  // Sampling happens in the instrumented allocation path.
+  if (old_interval == 0u && interval != 0u) {
+    LOG(INFO) << "Enabling allocation sampling every " << PrettySize(interval);
+    Runtime::Current()->GetInstrumentation()->InstrumentQuickAllocEntryPoints();
+  } else if (old_interval != 0u && interval == 0u) {
+    LOG(INFO) << "Disabling allocation sampling";
+    Runtime::Current()->GetInstrumentation()->UninstrumentQuickAllocEntryPoints();
+  }
+}
+
+void Heap::SampleAllocation(Thread* self, ObjPtr<mirror::Object>* obj, size_t byte_count) {
+  size_t interval = allocation_sampling_interval_.load(std::memory_order_relaxed);
+  if (interval == 0u) {
+    return;  // Disabled concurrently.
+  }
+  // A thread that never picked a sample distance before has not counted down to a sample yet.
+  if (*self->GetAllocationSampleRandomState() != 0u) {
+    allocation_sampler_->RecordSample(self, obj, byte_count);
+  }
+  self->SetAllocationSampleDistance(AllocationSampler::NextSampleDistance(self, interval));
+}
+
+size_t Heap::GetDroppedAllocationSamples() {
+  MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
+  return allocation_sampler_ == nullptr ? 0u : allocation_sampler_->GetDroppedSamples();
 }
 
 void Heap::SweepAllocationRecords(IsMarkedVisitor* visitor) const {
@@ -4166,6 +4614,24 @@ void Heap::RemoveGcPauseListener() {
   gc_pause_listener_.store(nullptr, std::memory_order_relaxed);
 }
 
+size_t Heap::GetRegionTlabSize(Thread* self) {
+  const size_t hint = self->GetTlabSizeHint();
+  return (kUseAdaptiveTlabSizing && hint != 0) ? hint : kPartialTlabSize;
+}
+
+void Heap::UpdateTlabSizeHintAtGc(Thread* thread) {
+  if (!kUseAdaptiveTlabSizing) {
+    return;
+  }
+  const size_t tlab_size = GetRegionTlabSize(thread);
+  if (tlab_size > kPartialTlabSize && thread->GetTlabBytesSinceGc() < tlab_size) {
+    // The thread did not fill even one TLAB since the last GC, so a big TLAB mostly ends up as
+    // to-space waste. Halve it.
+    thread->SetTlabSizeHint(std::max(tlab_size / 2, kPartialTlabSize));
+  }
+  thread->ResetTlabRefillStats();
+}
+
 mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
                                        size_t alloc_size,
                                        bool grow,
@@ -4180,7 +4646,7 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
     const size_t min_expand_size = alloc_size - self->TlabSize();
     const size_t expand_bytes = std::max(
         min_expand_size,
-        std::min(self->TlabRemainingCapacity() - self->TlabSize(), kPartialTlabSize));
+        std::min(self->TlabRemainingCapacity() - self->TlabSize(), GetRegionTlabSize(self)));
     if (UNLIKELY(IsOutOfMemoryOnAllocation(allocator_type, expand_bytes, grow))) {
       return nullptr;
     }
@@ -4208,7 +4674,7 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
                                             space::RegionSpace::kRegionSize,
                                             grow))) {
         const size_t new_tlab_size = kUsePartialTlabs
-            ? std::max(alloc_size, kPartialTlabSize)
+            ? std::max(alloc_size, GetRegionTlabSize(self))
             : gc::space::RegionSpace::kRegionSize;
         // Try to allocate a tlab.
         if (!region_space_->AllocNewTlab(self, new_tlab_size, bytes_tl_bulk_allocated)) {
@@ -4218,6 +4684,17 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
                                                        usable_size,
                                                        bytes_tl_bulk_allocated);
         }
+        if (kUsePartialTlabs && kUseAdaptiveTlabSizing) {
+          // Each refill takes the region lock. A thread that refills often gets a bigger TLAB
+          // so that it comes back less frequently; the unused tail is returned to the partial
+          // TLAB pool on revocation.
+          self->RecordTlabRefill(*bytes_tl_bulk_allocated);
+          if (self->GetTlabRefillsSinceGc() >= kAdaptiveTlabGrowRefills) {
+            self->SetTlabSizeHint(std::min(2 * GetRegionTlabSize(self),
+                                           gc::space::RegionSpace::kRegionSize));
+            self->ResetTlabRefillStats();
+          }
+        }
         // Fall-through to using the TLAB below.
       } else {
         // Check OOME for a non-tlab allocation.
@@ -67,6 +67,7 @@ class Object;
 namespace gc {
 
 class AllocationListener;
+class AllocationSampler;
 class AllocRecordObjectMap;
 class GcPauseListener;
 class HeapTask;
@@ -132,6 +133,10 @@ class Heap {
   // How much we grow the TLAB if we can do it.
   static constexpr size_t kPartialTlabSize = 16 * KB;
   static constexpr bool kUsePartialTlabs = true;
+  // Whether region TLAB sizes adapt to each thread's allocation rate between GCs.
+  static constexpr bool kUseAdaptiveTlabSizing = true;
+  // Number of region TLAB refills between two GCs after which a thread's TLAB size doubles.
+  static constexpr size_t kAdaptiveTlabGrowRefills = 4;
 
   static constexpr size_t kDefaultStartingSize = kPageSize;
   static constexpr size_t kDefaultInitialSize = 2 * MB;
@@ -176,6 +181,13 @@ class Heap {
   // make it safe to allocate that many bytes between checks.
   static constexpr size_t kCheckImmediatelyThreshold = 300000;
 
+  // Whether registered native allocations and frees smaller than kCheckImmediatelyThreshold are
+  // accumulated per thread instead of updating the shared counters on every call. A thread
+  // flushes its buffer once it holds kNativeAllocationBufferBytes in either direction or
+  // kNotifyNativeInterval allocations, when it exits, and at the thread flip of CC.
+  static constexpr bool kBufferNativeAllocations = true;
+  static constexpr size_t kNativeAllocationBufferBytes = 64 * KB;
+
   // How often we allow heap trimming to happen (nanoseconds).
   static constexpr uint64_t kHeapTrimWait = MsToNs(5000);
   // How long we wait after a transition request to perform a collector transition (nanoseconds).
@@ -221,6 +233,17 @@ class Heap {
        bool measure_gc_performance,
        bool use_homogeneous_space_compaction,
        bool use_generational_cc,
+       bool use_parallel_cc_marking,
+       bool use_parallel_cc_evacuation,
+       bool numa_aware_heap,
+       bool trim_non_moving_space,
+       bool use_huge_pages,
+       bool use_parallel_reference_processing,
+       bool use_parallel_system_weak_sweeping,
+       bool use_generational_cc_remembered_set,
+       uint64_t gc_pause_target_ns,
+       double gc_cpu_fraction_target,
+       size_t region_evacuation_copy_budget,
        uint64_t min_interval_homogeneous_space_compaction_by_oom,
        bool dump_region_info_before_gc,
        bool dump_region_info_after_gc,
@@ -286,6 +309,19 @@ class Heap {
     return current_non_moving_allocator_;
   }
 
+  // Allocates a primitive array which never moves, so that JNI returns pointers to its data
+  // without copying it nor pinning it. The array goes to the large object space, where objects
+  // start at page boundaries, or to the non-moving space if there is no large object space.
+  ObjPtr<mirror::Array> AllocStableArray(Thread* self,
+                                         ObjPtr<mirror::Class> array_class,
+                                         int32_t length)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!*gc_complete_lock_,
+               !*pending_task_lock_,
+               !*backtrace_lock_,
+               !process_state_update_lock_,
+               !Roles::uninterruptible_);
+
   // Visit all of the live objects in the heap.
   template <typename Visitor>
   ALWAYS_INLINE void VisitObjects(Visitor&& visitor)
@@ -294,6 +330,12 @@ class Heap {
   template <typename Visitor>
   ALWAYS_INLINE void VisitObjectsPaused(Visitor&& visitor)
       REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_, !*gc_complete_lock_);
+  // Like VisitObjectsPaused, but splits the heap among the GC threads, so `visitor` may be called
+  // concurrently from several threads. The caller must also prevent GCs, e.g. with a
+  // ScopedGCCriticalSection, as the GC threads are used.
+  template <typename Visitor>
+  void VisitObjectsPausedParallel(Visitor&& visitor)
+      REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_, !*gc_complete_lock_);
 
   void VisitReflectiveTargets(ReflectiveValueVisitor* visitor)
       REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_, !*gc_complete_lock_);
@@ -306,6 +348,10 @@ class Heap {
   void RegisterNativeAllocation(JNIEnv* env, size_t bytes)
       REQUIRES(!*gc_complete_lock_, !*pending_task_lock_, !process_state_update_lock_);
   void RegisterNativeFree(JNIEnv* env, size_t bytes);
+  // Add the native allocations buffered by `thread` to the heap counters. Returns true if the
+  // allocations crossed a multiple of kNotifyNativeInterval, i.e. a GC check is due. Must be
+  // called by `thread` or while it is suspended.
+  bool FlushNativeAllocationBuffer(Thread* thread);
 
   // Notify the garbage collector of malloc allocations that might be reclaimable
   // as a result of Java garbage collection. Each such call represents approximately
@@ -366,6 +412,15 @@ class Heap {
   // Temporarily disable thread flip for JNI critical calls.
   void IncrementDisableThreadFlip(Thread* self) REQUIRES(!*thread_flip_lock_);
   void DecrementDisableThreadFlip(Thread* self) REQUIRES(!*thread_flip_lock_);
+  // Keep a movable object in place for a JNI critical section, until UnpinObject. With the CC
+  // collector this pins the region of the object, without blocking the thread flip. Otherwise it
+  // disables moving GC, and the object may have moved when this returns.
+  void PinObject(Thread* self, ObjPtr<mirror::Object> obj)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!*gc_complete_lock_, !*thread_flip_lock_);
+  void UnpinObject(Thread* self, ObjPtr<mirror::Object> obj)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!*gc_complete_lock_, !*thread_flip_lock_);
   void ThreadFlipBegin(Thread* self) REQUIRES(!*thread_flip_lock_);
   void ThreadFlipEnd(Thread* self) REQUIRES(!*thread_flip_lock_);
 
@@ -640,6 +695,10 @@ class Heap {
   void Trim(Thread* self) REQUIRES(!*gc_complete_lock_);
 
   void RevokeThreadLocalBuffers(Thread* thread);
+
+  // Called for each thread at the start of a GC to shrink the TLAB size hint of threads that
+  // allocated less than one TLAB worth of memory since the previous GC.
+  static void UpdateTlabSizeHintAtGc(Thread* thread);
   void RevokeRosAllocThreadLocalBuffers(Thread* thread);
   void RevokeAllThreadLocalBuffers();
   void AssertThreadLocalBuffersAreRevoked(Thread* thread);
@@ -770,6 +829,29 @@ class Heap {
   size_t GetConcGCThreadCount() const {
     return conc_gc_threads_;
   }
+
+  bool UseParallelReferenceProcessing() const {
+    return use_parallel_reference_processing_;
+  }
+
+  bool UseParallelSystemWeakSweeping() const {
+    return use_parallel_system_weak_sweeping_;
+  }
+
+  bool UseGenerationalCCRememberedSet() const {
+    return use_generational_cc_remembered_set_;
+  }
+
+  // Returns true if a pause-time or GC CPU fraction target was given.
+  bool HasGcSchedulingTargets() const {
+    return gc_pause_target_ns_ != 0 || gc_cpu_fraction_target_ != 0.0;
+  }
+  // Limits a collector's thread count (including the GC thread) to what the scheduling targets
+  // allow.
+  size_t ClampGcThreadCount(size_t thread_count) const {
+    const size_t max_threads = gc_scheduling_max_threads_.load(std::memory_order_relaxed);
+    return max_threads != 0 ? std::min(thread_count, max_threads) : thread_count;
+  }
   accounting::ModUnionTable* FindModUnionTableFromSpace(space::Space* space);
   void AddModUnionTable(accounting::ModUnionTable* mod_union_table);
 
@@ -892,6 +974,29 @@ class Heap {
   void BroadcastForNewAllocationRecords() const
       REQUIRES(!Locks::alloc_tracker_lock_);
 
+  // Allocation sampling support. A sampling interval of 0 disables sampling, otherwise each thread
+  // records a sample on average every `interval` allocated bytes, see AllocationSampler.
+  bool IsAllocationSamplingEnabled() const {
+    return allocation_sampling_interval_.load(std::memory_order_relaxed) != 0;
+  }
+
+  size_t GetAllocationSamplingInterval() const {
+    return allocation_sampling_interval_.load(std::memory_order_relaxed);
+  }
+
+  void SetAllocationSamplingInterval(size_t interval)
+      REQUIRES(!Locks::alloc_tracker_lock_, !Locks::mutator_lock_);
+
+  // Removes up to `max_samples` of the oldest allocation samples and calls `visitor` on each of
+  // them. The visitor runs with the alloc tracker lock held. Returns the number of samples.
+  template <typename Visitor>
+  size_t DrainAllocationSamples(size_t max_samples, const Visitor& visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::alloc_tracker_lock_);
+
+  // Number of allocation samples dropped because they were not drained fast enough.
+  size_t GetDroppedAllocationSamples() REQUIRES(!Locks::alloc_tracker_lock_);
+
   void DisableGCForShutdown() REQUIRES(!*gc_complete_lock_);
 
   // Create a new alloc space and compact default alloc space to it.
@@ -1049,6 +1154,9 @@ class Heap {
                                               size_t* bytes_tl_bulk_allocated)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Returns the size of the next region TLAB for the thread, as adjusted by its allocation rate.
+  static size_t GetRegionTlabSize(Thread* self);
+
   mirror::Object* AllocWithNewTLAB(Thread* self,
                                    size_t alloc_size,
                                    bool grow,
@@ -1127,6 +1235,15 @@ class Heap {
   // the target utilization ratio.  This should only be called immediately after a full garbage
   // collection. bytes_allocated_before_gc is used to measure bytes / second for the period which
   // the GC was run.
+  // Advise the kernel to back [begin, begin + size) with transparent huge pages. Falls back to
+  // normal pages, with a warning, if that is not supported.
+  void AdviseHugePages(void* begin, size_t size, const char* name);
+
+  // Adjust the next GC type, the concurrent GC trigger and the GC thread count from the pause
+  // times of the collector that just ran and the GC CPU usage, if scheduling targets are set.
+  void ApplyGcSchedulingTargets(collector::GarbageCollector* collector_ran)
+      REQUIRES(!process_state_update_lock_);
+
   void GrowForUtilization(collector::GarbageCollector* collector_ran,
                           size_t bytes_allocated_before_gc = 0)
       REQUIRES(!process_state_update_lock_);
@@ -1146,6 +1263,10 @@ class Heap {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Push an object onto the allocation stack.
+  // Records a sample of the allocation of `obj` and picks the thread's next sample.
+  void SampleAllocation(Thread* self, ObjPtr<mirror::Object>* obj, size_t byte_count)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void PushOnAllocationStack(Thread* self, ObjPtr<mirror::Object>* obj)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!*gc_complete_lock_, !*pending_task_lock_, !process_state_update_lock_);
@@ -1158,6 +1279,8 @@ class Heap {
 
   void ClearConcurrentGCRequest();
   void ClearPendingTrim(Thread* self) REQUIRES(!*pending_task_lock_);
+  // Returns whether the kernel's pressure stall information reports memory pressure.
+  static bool IsUnderMemoryPressure();
   void ClearPendingCollectorTransition(Thread* self) REQUIRES(!*pending_task_lock_);
 
   // What kind of concurrency behavior is the runtime after? Currently true for concurrent mark
@@ -1549,6 +1672,45 @@ class Heap {
   // for major collections. Set in Heap constructor.
   const bool use_generational_cc_;
 
+  // If true, release free pages of a malloc non-moving space during heap trims even when we care
+  // about pause times. Objects in the non-moving space are never compacted, so this is the only
+  // way to give back memory lost to fragmentation there. Set in Heap constructor.
+  const bool trim_non_moving_space_;
+
+  // Number of heap trim passes over the non-moving space and bytes they released.
+  Atomic<size_t> non_moving_space_trims_;
+  Atomic<uint64_t> non_moving_space_trimmed_bytes_;
+
+  // Pause-time and GC CPU targets, 0 if not set. When set, ApplyGcSchedulingTargets adjusts the
+  // next GC type, the concurrent GC trigger and the GC thread count after each collection.
+  const uint64_t gc_pause_target_ns_;
+  const double gc_cpu_fraction_target_;
+
+  // Maximum number of GC threads picked by ApplyGcSchedulingTargets, 0 for no limit.
+  Atomic<size_t> gc_scheduling_max_threads_;
+
+  // Total GC CPU time and time at the end of the previous collection, for the GC CPU fraction.
+  uint64_t last_gc_scheduling_cpu_time_ns_;
+  uint64_t last_gc_scheduling_time_ns_;
+
+  // If true, ask for transparent huge pages for the region space, its mark bitmap and the card
+  // table. The ranges that were advised successfully are kept for the SIGQUIT dump.
+  const bool use_huge_pages_;
+  std::vector<std::pair<uint8_t*, uint8_t*>> huge_page_ranges_;
+
+  // If true, ReferenceProcessor clears the white referents of large reference queues on the heap
+  // thread pool. Set in Heap constructor.
+  const bool use_parallel_reference_processing_;
+
+  // If true, system weaks swept while mutators are running are swept concurrently on the thread
+  // pool, one task per system weak holder. Set in Heap constructor.
+  const bool use_parallel_system_weak_sweeping_;
+
+  // If true, young-generation CC collections scan the cards kept in the region space and
+  // non-moving space remembered sets instead of all the aged cards. Only set together with
+  // use_generational_cc_. Set in Heap constructor.
+  const bool use_generational_cc_remembered_set_;
+
   // True if the currently running collection has made some thread wait.
   bool running_collection_is_blocking_ GUARDED_BY(gc_complete_lock_);
   // The number of blocking GC runs.
@@ -1578,6 +1740,11 @@ class Heap {
   std::unique_ptr<AllocRecordObjectMap> allocation_records_;
   size_t alloc_record_depth_;
 
+  // Allocation sampling support. The sampler is created the first time sampling is enabled and
+  // lives as long as the heap, so that allocating threads can use it without a lock.
+  Atomic<size_t> allocation_sampling_interval_;
+  std::unique_ptr<AllocationSampler> allocation_sampler_;
+
   // GC stress related data structures.
   Mutex* backtrace_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   // Debugging variables, seen backtraces vs unique backtraces.
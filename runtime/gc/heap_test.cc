@@ -18,7 +18,10 @@
 #include "common_runtime_test.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/heap-inl.h"
+#include "gc/space/large_object_space.h"
 #include "handle_scope-inl.h"
+#include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/object_array-alloc-inl.h"
@@ -99,6 +102,54 @@ TEST_F(HeapTest, DumpGCPerformanceOnShutdown) {
   Runtime::Current()->SetDumpGCPerformanceOnShutdown(true);
 }
 
+TEST_F(HeapTest, AllocationSampling) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  heap->SetAllocationSamplingInterval(256);
+  ScopedObjectAccess soa(Thread::Current());
+  for (size_t i = 0; i < 1024; ++i) {
+    mirror::String::AllocFromModifiedUtf8(soa.Self(), "hello, world!");
+  }
+  size_t string_samples = 0;
+  size_t samples = heap->DrainAllocationSamples(
+      AllocationSampler::kNumSlots,
+      [&](const AllocationSample& sample) REQUIRES_SHARED(Locks::mutator_lock_) {
+        EXPECT_GT(sample.byte_count, 0u);
+        EXPECT_LE(sample.depth, AllocationSample::kMaxStackDepth);
+        if (sample.klass.Read()->IsStringClass()) {
+          ++string_samples;
+        }
+      });
+  // 1024 strings of at least 32 bytes each make about 128 samples.
+  EXPECT_GT(samples, 0u);
+  EXPECT_GT(string_samples, 0u);
+  EXPECT_EQ(heap->DrainAllocationSamples(AllocationSampler::kNumSlots,
+                                         [](const AllocationSample&) {}),
+            0u);
+  ScopedThreadSuspension sts(soa.Self(), kNative);
+  heap->SetAllocationSamplingInterval(0);
+}
+
+TEST_F(HeapTest, AllocStableArray) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::Class> array_class(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[F")));
+  ASSERT_TRUE(array_class != nullptr);
+  Handle<mirror::Array> array(
+      hs.NewHandle(heap->AllocStableArray(soa.Self(), array_class.Get(), 1024)));
+  ASSERT_TRUE(array != nullptr);
+  EXPECT_EQ(array->GetLength(), 1024);
+  EXPECT_FALSE(heap->IsMovableObject(array.Get()));
+  if (heap->GetLargeObjectsSpace() != nullptr) {
+    EXPECT_TRUE(heap->GetLargeObjectsSpace()->Contains(array.Get()));
+    EXPECT_TRUE(IsAligned<kPageSize>(array.Get()));
+  }
+  void* data = array->GetRawData(sizeof(float), 0);
+  heap->CollectGarbage(/* clear_soft_references= */ false);
+  EXPECT_EQ(array->GetRawData(sizeof(float), 0), data);
+}
+
 class ZygoteHeapTest : public CommonRuntimeTest {
   void SetUpRuntimeOptions(RuntimeOptions* options) override {
     CommonRuntimeTest::SetUpRuntimeOptions(options);
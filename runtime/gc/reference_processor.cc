@@ -190,8 +190,14 @@ void ReferenceProcessor::ProcessReferences(bool concurrent,
     }
   }
   // Clear all remaining soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences(&soft_reference_queue_,
+                       concurrent ? "ClearWhiteSoftReferences" : "(Paused)ClearWhiteSoftReferences",
+                       timings,
+                       collector);
+  ClearWhiteReferences(&weak_reference_queue_,
+                       concurrent ? "ClearWhiteWeakReferences" : "(Paused)ClearWhiteWeakReferences",
+                       timings,
+                       collector);
   {
     TimingLogger::ScopedTiming t2(concurrent ? "EnqueueFinalizerReferences" :
         "(Paused)EnqueueFinalizerReferences", timings);
@@ -205,11 +211,23 @@ void ReferenceProcessor::ProcessReferences(bool concurrent,
       StopPreservingReferences(self);
     }
   }
-  // Clear all finalizer referent reachable soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  // Clear all finalizer referent reachable soft and weak references with white referents. Each
+  // queue is done before the next one starts so the ordering between queue kinds is the same
+  // whether or not the queues are processed in parallel.
+  ClearWhiteReferences(&soft_reference_queue_,
+                       concurrent ? "ClearWhiteSoftReferences" : "(Paused)ClearWhiteSoftReferences",
+                       timings,
+                       collector);
+  ClearWhiteReferences(&weak_reference_queue_,
+                       concurrent ? "ClearWhiteWeakReferences" : "(Paused)ClearWhiteWeakReferences",
+                       timings,
+                       collector);
   // Clear all phantom references with white referents.
-  phantom_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences(
+      &phantom_reference_queue_,
+      concurrent ? "ClearWhitePhantomReferences" : "(Paused)ClearWhitePhantomReferences",
+      timings,
+      collector);
   // At this point all reference queues other than the cleared references should be empty.
   DCHECK(soft_reference_queue_.IsEmpty());
   DCHECK(weak_reference_queue_.IsEmpty());
@@ -229,6 +247,28 @@ void ReferenceProcessor::ProcessReferences(bool concurrent,
   }
 }
 
+void ReferenceProcessor::ClearWhiteReferences(ReferenceQueue* queue,
+                                              const char* timing_name,
+                                              TimingLogger* timings,
+                                              collector::GarbageCollector* collector) {
+  TimingLogger::ScopedTiming t(timing_name, timings);
+  Runtime* const runtime = Runtime::Current();
+  Heap* const heap = runtime->GetHeap();
+  // Transactions record each cleared referent, which is not thread safe.
+  if (!heap->UseParallelReferenceProcessing() ||
+      heap->GetThreadPool() == nullptr ||
+      runtime->IsActiveTransaction()) {
+    queue->ClearWhiteReferences(&cleared_references_, collector);
+    return;
+  }
+  // Like MarkSweep, use less threads if we are in a background state.
+  const size_t thread_count = runtime->InJankPerceptibleProcessState()
+      ? heap->ClampGcThreadCount(heap->GetParallelGCThreadCount() + 1)
+      : 1u;
+  queue->ClearWhiteReferencesParallel(
+      &cleared_references_, collector, heap->GetThreadPool(), thread_count);
+}
+
 // Process the "referent" field in a java.lang.ref.Reference.  If the referent has not yet been
 // marked, put it on the appropriate list in the heap for later processing.
 void ReferenceProcessor::DelayReferenceReferent(ObjPtr<mirror::Class> klass,
@@ -152,6 +152,91 @@ void ReferenceQueue::ClearWhiteReferences(ReferenceQueue* cleared_references,
   }
 }
 
+// Minimum number of references for ClearWhiteReferencesParallel to use more than one thread.
+static constexpr size_t kMinParallelReferences = 4 * KB;
+
+// Returns true if the referent of `ref` is white, in which case it is cleared.
+static bool ClearWhiteReferent(ObjPtr<mirror::Reference> ref,
+                               collector::GarbageCollector* collector)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
+  // do_atomic_update is false because this happens during the reference processing phase where
+  // Reference.clear() would block.
+  if (collector->IsNullOrMarkedHeapReference(referent_addr, /*do_atomic_update=*/false)) {
+    return false;
+  }
+  ref->ClearReferent<false>();
+  return true;
+}
+
+class ClearWhiteReferencesTask : public Task {
+ public:
+  ClearWhiteReferencesTask(collector::GarbageCollector* collector,
+                           const ObjPtr<mirror::Reference>* begin,
+                           const ObjPtr<mirror::Reference>* end)
+      : collector_(collector), begin_(begin), end_(end) {}
+
+  // Runs in the native state and relies on the GC thread holding the mutator lock, like the
+  // MarkSweep marking tasks. Only touches the references of its own chunk.
+  void Run(Thread* self ATTRIBUTE_UNUSED) override NO_THREAD_SAFETY_ANALYSIS {
+    for (const ObjPtr<mirror::Reference>* it = begin_; it != end_; ++it) {
+      if (ClearWhiteReferent(*it, collector_)) {
+        cleared_.push_back(*it);
+      }
+      ReferenceQueue::DisableReadBarrierForReference(*it);
+    }
+  }
+
+  const std::vector<ObjPtr<mirror::Reference>>& GetCleared() const {
+    return cleared_;
+  }
+
+ private:
+  collector::GarbageCollector* const collector_;
+  const ObjPtr<mirror::Reference>* const begin_;
+  const ObjPtr<mirror::Reference>* const end_;
+  std::vector<ObjPtr<mirror::Reference>> cleared_;
+};
+
+void ReferenceQueue::ClearWhiteReferencesParallel(ReferenceQueue* cleared_references,
+                                                  collector::GarbageCollector* collector,
+                                                  ThreadPool* thread_pool,
+                                                  size_t thread_count) {
+  DCHECK(!Runtime::Current()->IsActiveTransaction());
+  std::vector<ObjPtr<mirror::Reference>> refs;
+  while (!IsEmpty()) {
+    refs.push_back(DequeuePendingReference());
+  }
+  if (refs.size() < kMinParallelReferences || thread_count <= 1) {
+    for (ObjPtr<mirror::Reference> ref : refs) {
+      if (ClearWhiteReferent(ref, collector)) {
+        cleared_references->EnqueueReference(ref);
+      }
+      DisableReadBarrierForReference(ref);
+    }
+    return;
+  }
+  Thread* self = Thread::Current();
+  thread_count = std::min(thread_count, thread_pool->GetThreadCount() + 1);
+  const size_t chunk_size = RoundUp(refs.size(), thread_count) / thread_count;
+  std::vector<std::unique_ptr<ClearWhiteReferencesTask>> tasks;
+  for (size_t i = 0; i < refs.size(); i += chunk_size) {
+    const size_t end = std::min(i + chunk_size, refs.size());
+    tasks.emplace_back(new ClearWhiteReferencesTask(collector, &refs[i], refs.data() + end));
+    thread_pool->AddTask(self, tasks.back().get());
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ true);
+  thread_pool->StopWorkers(self);
+  // The cleared references queue is a single linked list, fill it from the GC thread.
+  for (const std::unique_ptr<ClearWhiteReferencesTask>& task : tasks) {
+    for (ObjPtr<mirror::Reference> ref : task->GetCleared()) {
+      cleared_references->EnqueueReference(ref);
+    }
+  }
+}
+
 void ReferenceQueue::EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
                                                 collector::GarbageCollector* collector) {
   while (!IsEmpty()) {
@@ -74,7 +74,7 @@ class ReferenceQueue {
   // If applicable, disable the read barrier for the reference after its referent is handled (see
   // ConcurrentCopying::ProcessMarkStackRef.) This must be called for a reference that's dequeued
   // from pending queue (DequeuePendingReference).
-  void DisableReadBarrierForReference(ObjPtr<mirror::Reference> ref)
+  static void DisableReadBarrierForReference(ObjPtr<mirror::Reference> ref)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Enqueues finalizer references with white referents.  White referents are blackened, moved to
@@ -95,6 +95,14 @@ class ReferenceQueue {
                             collector::GarbageCollector* collector)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Same as ClearWhiteReferences but the referents are tested and cleared in chunks by up to
+  // `thread_count` threads of `thread_pool`. Must not be used in transaction mode.
+  void ClearWhiteReferencesParallel(ReferenceQueue* cleared_references,
+                                    collector::GarbageCollector* collector,
+                                    ThreadPool* thread_pool,
+                                    size_t thread_count)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void Dump(std::ostream& os) const REQUIRES_SHARED(Locks::mutator_lock_);
   size_t GetLength() const REQUIRES_SHARED(Locks::mutator_lock_);
 
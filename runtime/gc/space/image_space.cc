@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <random>
 
 #include "android-base/stringprintf.h"
@@ -1209,15 +1210,18 @@ class ImageSpace::Loader {
         Thread* const self = Thread::Current();
         static constexpr size_t kMinBlocks = 2u;
         const bool use_parallel = pool != nullptr && image_header.GetBlockCount() >= kMinBlocks;
+        // Blocks may fail on different threads, only the first failure sets the error message.
+        std::atomic<bool> failed(false);
         for (const ImageHeader::Block& block : image_header.GetBlocks(temp_map.Begin())) {
           auto function = [&](Thread*) {
             const uint64_t start2 = NanoTime();
             ScopedTrace trace("LZ4 decompress block");
+            std::string block_error_msg;
             bool result = block.Decompress(/*out_ptr=*/map.Begin(),
                                            /*in_ptr=*/temp_map.Begin(),
-                                           error_msg);
-            if (!result && error_msg != nullptr) {
-              *error_msg = "Failed to decompress image block " + *error_msg;
+                                           &block_error_msg);
+            if (!result && !failed.exchange(true) && error_msg != nullptr) {
+              *error_msg = "Failed to decompress image block " + block_error_msg;
             }
             VLOG(image) << "Decompress block " << block.GetDataSize() << " -> "
                         << block.GetImageSize() << " in " << PrettyDuration(NanoTime() - start2);
@@ -1234,6 +1238,9 @@ class ImageSpace::Loader {
           ScopedThreadSuspension sts(Thread::Current(), kNative);
           pool->Wait(self, true, false);
         }
+        if (failed.load()) {
+          return MemMap::Invalid();
+        }
         const uint64_t time = NanoTime() - start;
         // Add one 1 ns to prevent possible divide by 0.
         VLOG(image) << "Decompressing image took " << PrettyDuration(time) << " ("
@@ -2993,6 +3000,24 @@ class ImageSpace::BootImageLoader {
       DCHECK_EQ(base_diff64, 0);
     }
 
+    // Relocation writes to almost every page of the image. Count the pages it dirties,
+    // i.e. copies out of the image file, when the startup timings are logged.
+    auto count_dirty_pages = [&spaces]() {
+      ssize_t count = 0;
+      for (const std::unique_ptr<ImageSpace>& space : spaces) {
+        ssize_t space_count =
+            GetPrivateAnonymousPageCount(space->GetMemMap()->Begin(), space->GetMemMap()->Size());
+        if (space_count < 0) {
+          return space_count;
+        }
+        count += space_count;
+      }
+      return count;
+    };
+    const bool log_relocation = VLOG_IS_ON(image);
+    ssize_t dirty_pages_before = log_relocation ? count_dirty_pages() : 0;
+    uint64_t start_time = log_relocation ? NanoTime() : 0u;
+
     ArrayRef<const std::unique_ptr<ImageSpace>> spaces_ref(spaces);
     PointerSize pointer_size = first_space_header.GetPointerSize();
     if (pointer_size == PointerSize::k64) {
@@ -3000,6 +3025,17 @@ class ImageSpace::BootImageLoader {
     } else {
       DoRelocateSpaces<PointerSize::k32>(spaces_ref, base_diff64);
     }
+
+    if (log_relocation) {
+      uint64_t relocation_time = NanoTime() - start_time;
+      ssize_t dirty_pages_after = count_dirty_pages();
+      LOG(INFO) << "Relocating " << spaces.size() << " boot image spaces by " << base_diff64
+          << " took " << PrettyDuration(relocation_time) << " and dirtied "
+          << ((dirty_pages_before >= 0 && dirty_pages_after >= 0)
+                  ? std::to_string(dirty_pages_after - dirty_pages_before)
+                  : std::string("an unknown number of"))
+          << " pages";
+    }
   }
 
   void DeduplicateInternedStrings(ArrayRef<const std::unique_ptr<ImageSpace>> spaces,
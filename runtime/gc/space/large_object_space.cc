@@ -19,6 +19,7 @@
 #include <sys/mman.h>
 
 #include <memory>
+#include <vector>
 
 #include <android-base/logging.h>
 
@@ -83,6 +84,11 @@ class MemoryToolLargeObjectMapSpace final : public LargeObjectMapSpace {
     return LargeObjectMapSpace::Free(self, object_with_rdz);
   }
 
+  size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) override {
+    // Free one object at a time so that Free() adjusts for the red zones.
+    return LargeObjectSpace::FreeList(self, num_ptrs, ptrs);
+  }
+
   bool Contains(const mirror::Object* obj) const override {
     return LargeObjectMapSpace::Contains(ObjectWithRedzone(obj));
   }
@@ -188,21 +194,46 @@ void LargeObjectMapSpace::SetAllLargeObjectsAsZygoteObjects(Thread* self, bool s
   }
 }
 
-size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
-  MutexLock mu(self, lock_);
+MemMap LargeObjectMapSpace::RemoveLocked(Thread* self, mirror::Object* ptr) {
   auto it = large_objects_.find(ptr);
   if (UNLIKELY(it == large_objects_.end())) {
     ScopedObjectAccess soa(self);
     Runtime::Current()->GetHeap()->DumpSpaces(LOG_STREAM(FATAL_WITHOUT_ABORT));
     LOG(FATAL) << "Attempted to free large object " << ptr << " which was not live";
   }
-  const size_t map_size = it->second.mem_map.BaseSize();
-  DCHECK_GE(num_bytes_allocated_, map_size);
-  size_t allocation_size = map_size;
-  num_bytes_allocated_ -= allocation_size;
-  --num_objects_allocated_;
+  MemMap mem_map = std::move(it->second.mem_map);
   large_objects_.erase(it);
-  return allocation_size;
+  DCHECK_GE(num_bytes_allocated_, mem_map.BaseSize());
+  num_bytes_allocated_ -= mem_map.BaseSize();
+  --num_objects_allocated_;
+  return mem_map;
+}
+
+size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
+  MemMap mem_map;
+  {
+    MutexLock mu(self, lock_);
+    mem_map = RemoveLocked(self, ptr);
+  }
+  // The mapping is released when `mem_map` goes out of scope. Do the munmap()
+  // outside of lock_ so that it does not hold up allocations, as Alloc() also
+  // maps memory before taking the lock.
+  return mem_map.BaseSize();
+}
+
+size_t LargeObjectMapSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) {
+  std::vector<MemMap> mem_maps;
+  mem_maps.reserve(num_ptrs);
+  size_t total = 0;
+  {
+    MutexLock mu(self, lock_);
+    for (size_t i = 0; i < num_ptrs; ++i) {
+      mem_maps.push_back(RemoveLocked(self, ptrs[i]));
+      total += mem_maps.back().BaseSize();
+    }
+  }
+  // `mem_maps` unmaps the objects when it goes out of scope.
+  return total;
 }
 
 size_t LargeObjectMapSpace::AllocationSize(mirror::Object* obj, size_t* usable_size) {
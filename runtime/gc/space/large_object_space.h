@@ -159,6 +159,10 @@ class LargeObjectMapSpace : public LargeObjectSpace {
                         size_t* usable_size, size_t* bytes_tl_bulk_allocated) override
       REQUIRES(!lock_);
   size_t Free(Thread* self, mirror::Object* ptr) override REQUIRES(!lock_);
+  // Frees the whole batch under one acquisition of lock_ and unmaps the
+  // objects once the lock has been released.
+  size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) override
+      REQUIRES(!lock_);
   void Walk(DlMallocSpace::WalkCallback, void* arg) override REQUIRES(!lock_);
   // TODO: disabling thread safety analysis as this may be called when we already hold lock_.
   bool Contains(const mirror::Object* obj) const override NO_THREAD_SAFETY_ANALYSIS;
@@ -178,6 +182,10 @@ class LargeObjectMapSpace : public LargeObjectSpace {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Removes `ptr` from the space and returns its memory map. The memory is
+  // unmapped when the returned map is destroyed.
+  MemMap RemoveLocked(Thread* self, mirror::Object* ptr) REQUIRES(lock_);
+
   AllocationTrackingSafeMap<mirror::Object*, LargeObject, kAllocatorTagLOSMaps> large_objects_
       GUARDED_BY(lock_);
 };
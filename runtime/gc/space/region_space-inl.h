@@ -233,7 +233,14 @@ inline void RegionSpace::WalkInternal(Visitor&& visitor) {
   // issues (the classloader classes lock and the monitor lock). We
   // call this with threads suspended.
   Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
-  for (size_t i = 0; i < num_regions_; ++i) {
+  WalkRegionsInternal<kToSpaceOnly>(visitor, 0u, num_regions_);
+}
+
+template<bool kToSpaceOnly, typename Visitor>
+inline void RegionSpace::WalkRegionsInternal(Visitor&& visitor, size_t begin, size_t end) {
+  DCHECK_LE(begin, end);
+  DCHECK_LE(end, num_regions_);
+  for (size_t i = begin; i < end; ++i) {
     Region* r = &regions_[i];
     if (r->IsFree() || (kToSpaceOnly && !r->IsInToSpace())) {
       continue;
@@ -303,6 +310,10 @@ template <typename Visitor>
 inline void RegionSpace::WalkToSpace(Visitor&& visitor) {
   WalkInternal</* kToSpaceOnly= */ true>(visitor);
 }
+template <typename Visitor>
+inline void RegionSpace::WalkRegions(Visitor&& visitor, size_t begin, size_t end) {
+  WalkRegionsInternal</* kToSpaceOnly= */ false>(visitor, begin, end);
+}
 
 inline mirror::Object* RegionSpace::GetNextObject(mirror::Object* obj) {
   const uintptr_t position = reinterpret_cast<uintptr_t>(obj) + obj->SizeOf();
@@ -13,8 +13,16 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
 #include <deque>
 
+#if defined(__linux__)
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "bump_pointer_space-inl.h"
 #include "bump_pointer_space.h"
 #include "base/dumpable.h"
@@ -47,6 +55,38 @@ static constexpr uint32_t kPoisonDeadObject = 0xBADDB01D;  // "BADDROID"
 // Whether we check a region's live bytes count against the region bitmap.
 static constexpr bool kCheckLiveBytesAgainstRegionBitmap = kIsDebugBuild;
 
+// Maximum number of NUMA nodes supported by the NUMA-aware mode.
+static constexpr size_t kMaxNumaNodes = 64;
+
+// Return the number of NUMA nodes of the system, or 1 if it cannot be determined.
+static size_t GetNumaNodeCount() {
+  size_t count = 0;
+#if defined(__linux__)
+  DIR* dir = opendir("/sys/devices/system/node");
+  if (dir != nullptr) {
+    while (dirent* entry = readdir(dir)) {
+      if (strncmp(entry->d_name, "node", 4) == 0 && isdigit(entry->d_name[4])) {
+        ++count;
+      }
+    }
+    closedir(dir);
+  }
+#endif
+  return std::min(std::max(count, static_cast<size_t>(1)), kMaxNumaNodes);
+}
+
+// Return the NUMA node of the CPU the calling thread is running on.
+static size_t GetCurrentNumaNode() {
+#if defined(__linux__)
+  unsigned cpu;
+  unsigned node;
+  if (syscall(__NR_getcpu, &cpu, &node, nullptr) == 0) {
+    return node;
+  }
+#endif
+  return 0;
+}
+
 MemMap RegionSpace::CreateMemMap(const std::string& name,
                                  size_t capacity,
                                  uint8_t* requested_begin) {
@@ -95,11 +135,14 @@ MemMap RegionSpace::CreateMemMap(const std::string& name,
 }
 
 RegionSpace* RegionSpace::Create(
-    const std::string& name, MemMap&& mem_map, bool use_generational_cc) {
-  return new RegionSpace(name, std::move(mem_map), use_generational_cc);
+    const std::string& name, MemMap&& mem_map, bool use_generational_cc, bool numa_aware) {
+  return new RegionSpace(name, std::move(mem_map), use_generational_cc, numa_aware);
 }
 
-RegionSpace::RegionSpace(const std::string& name, MemMap&& mem_map, bool use_generational_cc)
+RegionSpace::RegionSpace(const std::string& name,
+                         MemMap&& mem_map,
+                         bool use_generational_cc,
+                         bool numa_aware)
     : ContinuousMemMapAllocSpace(name,
                                  std::move(mem_map),
                                  mem_map.Begin(),
@@ -116,7 +159,11 @@ RegionSpace::RegionSpace(const std::string& name, MemMap&& mem_map, bool use_gen
       non_free_region_index_limit_(0U),
       current_region_(&full_region_),
       evac_region_(nullptr),
-      cyclic_alloc_region_index_(0U) {
+      cyclic_alloc_region_index_(0U),
+      num_numa_nodes_(numa_aware ? GetNumaNodeCount() : 1U),
+      regions_per_numa_node_(RoundUp(num_regions_, num_numa_nodes_) / num_numa_nodes_),
+      evacuation_policy_(EvacuationPolicy::kLivePercentThreshold),
+      evacuation_copy_budget_(0U) {
   CHECK_ALIGNED(mem_map_.Size(), kRegionSize);
   CHECK_ALIGNED(mem_map_.Begin(), kRegionSize);
   DCHECK_GT(num_regions_, 0U);
@@ -142,10 +189,35 @@ RegionSpace::RegionSpace(const std::string& name, MemMap&& mem_map, bool use_gen
   DCHECK(full_region_.IsAllocated());
   size_t ignored;
   DCHECK(full_region_.Alloc(kAlignment, &ignored, nullptr, &ignored) == nullptr);
+  if (num_numa_nodes_ > 1) {
+    BindRegionsToNumaNodes();
+  }
   // Protect the whole region space from the start.
   Protect();
 }
 
+void RegionSpace::BindRegionsToNumaNodes() {
+#if defined(__linux__)
+  // The pages are not touched yet, so setting a preferred node makes them get allocated there on
+  // first touch while still allowing the kernel to fall back to other nodes under pressure.
+  for (size_t node = 0; node < num_numa_nodes_; ++node) {
+    size_t begin = node * regions_per_numa_node_;
+    size_t end = std::min(begin + regions_per_numa_node_, num_regions_);
+    if (begin >= end) {
+      break;
+    }
+    unsigned long node_mask = 1UL << node;  // NOLINT(runtime/int)
+    uint8_t* addr = regions_[begin].Begin();
+    size_t length = (end - begin) * kRegionSize;
+    if (syscall(__NR_mbind, addr, length, MPOL_PREFERRED, &node_mask, kMaxNumaNodes, 0) != 0) {
+      PLOG(WARNING) << "Failed to bind region space range " << reinterpret_cast<void*>(addr)
+                    << "+" << PrettySize(length) << " to NUMA node " << node;
+    }
+  }
+  VLOG(heap) << "Region space partitioned among " << num_numa_nodes_ << " NUMA nodes";
+#endif
+}
+
 size_t RegionSpace::FromSpaceSize() {
   uint64_t num_regions = 0;
   MutexLock mu(Thread::Current(), region_lock_);
@@ -158,6 +230,16 @@ size_t RegionSpace::FromSpaceSize() {
   return num_regions * kRegionSize;
 }
 
+void RegionSpace::GetFromSpaceRegionRanges(std::vector<std::pair<uint8_t*, uint8_t*>>* ranges) {
+  MutexLock mu(Thread::Current(), region_lock_);
+  for (size_t i = 0; i < num_regions_; ++i) {
+    Region* r = &regions_[i];
+    if (r->IsInFromSpace() && !r->IsLargeTail()) {
+      ranges->emplace_back(r->Begin(), r->Top());
+    }
+  }
+}
+
 size_t RegionSpace::UnevacFromSpaceSize() {
   uint64_t num_regions = 0;
   MutexLock mu(Thread::Current(), region_lock_);
@@ -189,8 +271,8 @@ void RegionSpace::Region::SetAsUnevacFromSpace(bool clear_live_bytes) {
   type_ = RegionType::kRegionTypeUnevacFromSpace;
   if (IsNewlyAllocated()) {
     // A newly allocated region set as unevac from-space must be
-    // a large or large tail region.
-    DCHECK(IsLarge() || IsLargeTail()) << static_cast<uint>(state_);
+    // a large or large tail region, or a pinned region.
+    DCHECK(IsLarge() || IsLargeTail() || IsPinned()) << static_cast<uint>(state_);
     // Always clear the live bytes of a newly allocated (large or
     // large tail) region.
     clear_live_bytes = true;
@@ -350,6 +432,12 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table,
   const size_t iter_limit = kUseTableLookupReadBarrier
       ? num_regions_
       : std::min(num_regions_, non_free_region_index_limit_);
+  // Only the live percent mode has liveness information to select regions with.
+  const bool select_by_live_bytes = (evac_mode == kEvacModeLivePercentNewlyAllocated);
+  std::vector<bool> budget_candidates;
+  if (select_by_live_bytes) {
+    SelectEvacuationCandidates(iter_limit, &budget_candidates);
+  }
   for (size_t i = 0; i < iter_limit; ++i) {
     Region* r = &regions_[i];
     RegionState state = r->State();
@@ -362,6 +450,30 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table,
                type == RegionType::kRegionTypeToSpace);
         bool should_evacuate = r->ShouldBeEvacuated(evac_mode);
         bool is_newly_allocated = r->IsNewlyAllocated();
+        if (select_by_live_bytes &&
+            state == RegionState::kRegionStateAllocated &&
+            !is_newly_allocated &&
+            r->LiveBytes() != static_cast<size_t>(-1)) {
+          if (!budget_candidates.empty()) {
+            should_evacuate = budget_candidates[i];
+          }
+          if (should_evacuate && !r->IsPinned()) {
+            ++region_histogram_.evacuated_regions;
+            region_histogram_.evacuated_live_bytes += r->LiveBytes();
+          }
+        }
+        if (UNLIKELY(r->IsPinned())) {
+          // Objects in JNI critical sections must stay in place, even if the evacuation is forced.
+          should_evacuate = false;
+          // As for newly allocated large regions below, the objects may have been marked without
+          // their live bytes being counted.
+          if (use_generational_cc_ &&
+              is_newly_allocated &&
+              state == RegionState::kRegionStateAllocated) {
+            GetMarkBitmap()->ClearRange(reinterpret_cast<mirror::Object*>(r->Begin()),
+                                        reinterpret_cast<mirror::Object*>(r->Top()));
+          }
+        }
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
@@ -411,6 +523,74 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table,
   evac_region_ = &full_region_;
 }
 
+void RegionSpace::SelectEvacuationCandidates(size_t iter_limit,
+                                             /* out */ std::vector<bool>* budget_candidates) {
+  RegionHistogram histogram;
+  // Live bytes and index of the regions the copy budget is spent on.
+  std::vector<std::pair<size_t, size_t>> candidates;
+  for (size_t i = 0; i < iter_limit; ++i) {
+    Region* r = &regions_[i];
+    // Large regions are only evacuated when they are dead, see Region::ShouldBeEvacuated.
+    if (!r->IsAllocated() || r->IsNewlyAllocated() ||
+        r->LiveBytes() == static_cast<size_t>(-1)) {
+      continue;
+    }
+    const size_t live_bytes = r->LiveBytes();
+    DCHECK_LE(live_bytes, kRegionSize);
+    const size_t live_percent_bucket = std::min(
+        live_bytes * RegionHistogram::kNumLivePercentBuckets / kRegionSize,
+        RegionHistogram::kNumLivePercentBuckets - 1);
+    ++histogram.live_percent_regions[live_percent_bucket];
+    const uint32_t age = time_ - r->alloc_time_;
+    const size_t age_bucket =
+        std::min<size_t>(MinimumBitsToStore(age), RegionHistogram::kNumAgeBuckets - 1);
+    ++histogram.age_regions[age_bucket];
+    if (evacuation_policy_ == EvacuationPolicy::kCopyBudget) {
+      candidates.emplace_back(live_bytes, i);
+    }
+  }
+  region_histogram_ = histogram;
+  if (evacuation_policy_ == EvacuationPolicy::kCopyBudget) {
+    budget_candidates->assign(iter_limit, false);
+    std::sort(candidates.begin(), candidates.end());
+    size_t remaining_budget = evacuation_copy_budget_;
+    for (const std::pair<size_t, size_t>& candidate : candidates) {
+      if (candidate.first > remaining_budget) {
+        break;
+      }
+      remaining_budget -= candidate.first;
+      (*budget_candidates)[candidate.second] = true;
+    }
+  }
+}
+
+RegionSpace::RegionHistogram RegionSpace::GetRegionHistogram() {
+  MutexLock mu(Thread::Current(), region_lock_);
+  return region_histogram_;
+}
+
+void RegionSpace::DumpRegionHistogram(std::ostream& os) {
+  const RegionHistogram histogram = GetRegionHistogram();
+  os << "Region live percent histogram:";
+  for (size_t i = 0; i < RegionHistogram::kNumLivePercentBuckets; ++i) {
+    os << " " << i * 100 / RegionHistogram::kNumLivePercentBuckets << "%:"
+       << histogram.live_percent_regions[i];
+  }
+  os << "\nRegion age histogram:";
+  for (size_t i = 0; i < RegionHistogram::kNumAgeBuckets; ++i) {
+    if (i <= 1u) {
+      os << " " << i;
+    } else if (i + 1 < RegionHistogram::kNumAgeBuckets) {
+      os << " " << (1u << (i - 1)) << "-" << ((1u << i) - 1);
+    } else {
+      os << " " << (1u << (i - 1)) << "+";
+    }
+    os << ":" << histogram.age_regions[i];
+  }
+  os << "\nEvacuated regions: " << histogram.evacuated_regions
+     << " live bytes: " << PrettySize(histogram.evacuated_live_bytes) << "\n";
+}
+
 static void ZeroAndProtectRegion(uint8_t* begin, uint8_t* end) {
   ZeroAndReleasePages(begin, end - begin);
   if (kProtectClearedRegions) {
@@ -819,6 +999,21 @@ void RegionSpace::DumpRegions(std::ostream& os) {
   for (size_t i = 0; i < num_regions_; ++i) {
     regions_[i].Dump(os);
   }
+  if (num_numa_nodes_ > 1) {
+    std::vector<size_t> num_regions(num_numa_nodes_, 0u);
+    std::vector<size_t> num_non_free_regions(num_numa_nodes_, 0u);
+    for (size_t i = 0; i < num_regions_; ++i) {
+      size_t node = NumaNodeForRegion(i);
+      ++num_regions[node];
+      if (!regions_[i].IsFree()) {
+        ++num_non_free_regions[node];
+      }
+    }
+    for (size_t node = 0; node < num_numa_nodes_; ++node) {
+      os << "NUMA node " << node << ": " << num_non_free_regions[node] << " non-free regions of "
+         << num_regions[node] << "\n";
+    }
+  }
 }
 
 void RegionSpace::DumpNonFreeRegions(std::ostream& os) {
@@ -1001,6 +1196,7 @@ size_t RegionSpace::AllocationSizeNonvirtual(mirror::Object* obj, size_t* usable
 }
 
 void RegionSpace::Region::Clear(bool zero_and_release_pages) {
+  DCHECK(!IsPinned());
   top_.store(begin_, std::memory_order_relaxed);
   state_ = RegionState::kRegionStateFree;
   type_ = RegionType::kRegionTypeNone;
@@ -1024,14 +1220,35 @@ RegionSpace::Region* RegionSpace::AllocateRegion(bool for_evac) {
   if (!for_evac && (num_non_free_regions_ + 1) * 2 > num_regions_) {
     return nullptr;
   }
-  for (size_t i = 0; i < num_regions_; ++i) {
+  if (num_numa_nodes_ > 1) {
+    // Prefer a region on the node of the calling thread: the mutator for TLABs and regular
+    // allocations, and the copying thread when evacuating, which is where the copied objects are
+    // about to be accessed. Fall back to any node otherwise.
+    size_t node = GetCurrentNumaNode();
+    if (node < num_numa_nodes_) {
+      size_t begin = node * regions_per_numa_node_;
+      size_t end = std::min(begin + regions_per_numa_node_, num_regions_);
+      Region* r = AllocateRegionInRange(for_evac, begin, end);
+      if (r != nullptr) {
+        return r;
+      }
+    }
+  }
+  return AllocateRegionInRange(for_evac, 0u, num_regions_);
+}
+
+RegionSpace::Region* RegionSpace::AllocateRegionInRange(bool for_evac, size_t begin, size_t end) {
+  DCHECK_LE(begin, end);
+  DCHECK_LE(end, num_regions_);
+  const size_t num_regions = end - begin;
+  for (size_t i = 0; i < num_regions; ++i) {
     // When using the cyclic region allocation strategy, try to
     // allocate a region starting from the last cyclic allocated
     // region marker. Otherwise, try to allocate a region starting
     // from the beginning of the region space.
     size_t region_index = kCyclicRegionAllocation
-        ? ((cyclic_alloc_region_index_ + i) % num_regions_)
-        : i;
+        ? begin + ((std::max(cyclic_alloc_region_index_, begin) - begin + i) % num_regions)
+        : begin + i;
     Region* r = &regions_[region_index];
     if (r->IsFree()) {
       r->Unfree(this, time_);
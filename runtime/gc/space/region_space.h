@@ -22,6 +22,7 @@
 #include "space.h"
 #include "thread.h"
 
+#include <array>
 #include <functional>
 #include <map>
 
@@ -54,6 +55,31 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
     kEvacModeForceAll,
   };
 
+  // How the regions that were not allocated since the previous GC are picked for evacuation in
+  // `kEvacModeLivePercentNewlyAllocated` mode.
+  enum class EvacuationPolicy {
+    // Evacuate the regions whose live ratio is below a fixed threshold.
+    kLivePercentThreshold,
+    // Evacuate the regions with the fewest live bytes, as long as the live bytes of the
+    // evacuated regions fit in the copy budget.
+    kCopyBudget,
+  };
+
+  // Distribution of the regions holding liveness information, taken when the evacuation
+  // candidates are last selected after marking.
+  struct RegionHistogram {
+    // Live percent buckets of 10% each, the last one includes 100%.
+    static constexpr size_t kNumLivePercentBuckets = 10;
+    // Age buckets in number of collections since allocation: 0, 1, 2-3, 4-7, ..., 32 and more.
+    static constexpr size_t kNumAgeBuckets = 7;
+
+    std::array<size_t, kNumLivePercentBuckets> live_percent_regions = {};
+    std::array<size_t, kNumAgeBuckets> age_regions = {};
+    // Regions selected for evacuation and the sum of their live bytes.
+    size_t evacuated_regions = 0;
+    uint64_t evacuated_live_bytes = 0;
+  };
+
   SpaceType GetType() const override {
     return kSpaceTypeRegionSpace;
   }
@@ -62,7 +88,12 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   // guaranteed to be granted, if it is required, the caller should call Begin on the returned
   // space to confirm the request was granted.
   static MemMap CreateMemMap(const std::string& name, size_t capacity, uint8_t* requested_begin);
-  static RegionSpace* Create(const std::string& name, MemMap&& mem_map, bool use_generational_cc);
+  // If `numa_aware` is true and the system has several NUMA nodes, the regions are partitioned
+  // among the nodes and new regions are preferably allocated on the node of the calling thread.
+  static RegionSpace* Create(const std::string& name,
+                             MemMap&& mem_map,
+                             bool use_generational_cc,
+                             bool numa_aware = false);
 
   // Allocate `num_bytes`, returns null if the space is full.
   mirror::Object* Alloc(Thread* self,
@@ -142,6 +173,19 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   // Dump region containing object `obj`. Precondition: `obj` is in the region space.
   void DumpRegionForObject(std::ostream& os, mirror::Object* obj) REQUIRES(!region_lock_);
   void DumpNonFreeRegions(std::ostream& os) REQUIRES(!region_lock_);
+  void DumpRegionHistogram(std::ostream& os) REQUIRES(!region_lock_);
+
+  // Set the evacuation policy. `copy_budget_bytes` is only used by `kCopyBudget`. Not thread
+  // safe, must be called before the first collection.
+  void SetEvacuationPolicy(EvacuationPolicy policy, size_t copy_budget_bytes) {
+    DCHECK(policy != EvacuationPolicy::kCopyBudget || copy_budget_bytes > 0u);
+    evacuation_policy_ = policy;
+    evacuation_copy_budget_ = copy_budget_bytes;
+  }
+  EvacuationPolicy GetEvacuationPolicy() const {
+    return evacuation_policy_;
+  }
+  RegionHistogram GetRegionHistogram() REQUIRES(!region_lock_);
 
   size_t RevokeThreadLocalBuffers(Thread* thread) override REQUIRES(!region_lock_);
   size_t RevokeThreadLocalBuffers(Thread* thread, const bool reuse) REQUIRES(!region_lock_);
@@ -214,6 +258,12 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   ALWAYS_INLINE void Walk(Visitor&& visitor) REQUIRES(Locks::mutator_lock_);
   template <typename Visitor>
   ALWAYS_INLINE void WalkToSpace(Visitor&& visitor) REQUIRES(Locks::mutator_lock_);
+  // Visit the objects of the regions with indexes in [begin, end). Like Walk, this needs the
+  // mutators to be suspended, but threads may walk disjoint ranges of regions concurrently
+  // while another thread holds the mutator lock.
+  template <typename Visitor>
+  ALWAYS_INLINE void WalkRegions(Visitor&& visitor, size_t begin, size_t end)
+      NO_THREAD_SAFETY_ANALYSIS;
 
   // Scans regions and calls visitor for objects in unevac-space corresponding
   // to the bits set in 'bitmap'.
@@ -243,6 +293,19 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
     return false;
   }
 
+  // Pins the region of `obj`, so that `obj` does not move until it is unpinned, for JNI critical
+  // sections. Must be called by a runnable thread: regions only become from-space during the
+  // thread flip, see SetFromSpace, so `obj` cannot be in the from-space before it is pinned.
+  void PinObject(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK(HasAddress(obj));
+    RefToRegionUnlocked(obj)->Pin();
+  }
+
+  void UnpinObject(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK(HasAddress(obj));
+    RefToRegionUnlocked(obj)->Unpin();
+  }
+
   bool IsRegionNewlyAllocated(size_t idx) const NO_THREAD_SAFETY_ANALYSIS {
     DCHECK_LT(idx, num_regions_);
     return regions_[idx].IsNewlyAllocated();
@@ -309,6 +372,10 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
       REQUIRES(!region_lock_);
 
   size_t FromSpaceSize() REQUIRES(!region_lock_);
+  // Append the allocated range [Begin(), Top()) of every from-space region, except large tails, to
+  // `ranges`. Used to split evacuation among several GC threads by whole regions.
+  void GetFromSpaceRegionRanges(std::vector<std::pair<uint8_t*, uint8_t*>>* ranges)
+      REQUIRES(!region_lock_);
   size_t UnevacFromSpaceSize() REQUIRES(!region_lock_);
   size_t ToSpaceSize() REQUIRES(!region_lock_);
   void ClearFromSpace(/* out */ uint64_t* cleared_bytes,
@@ -321,6 +388,12 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
     reg->AddLiveBytes(alloc_size);
   }
 
+  // Same as AddLiveBytes but safe to call from multiple GC threads at once.
+  void AtomicAddLiveBytes(mirror::Object* ref, size_t alloc_size) {
+    Region* reg = RefToRegionUnlocked(ref);
+    reg->AtomicAddLiveBytes(alloc_size);
+  }
+
   void AssertAllRegionLiveBytesZeroOrCleared() REQUIRES(!region_lock_) {
     if (kIsDebugBuild) {
       MutexLock mu(Thread::Current(), region_lock_);
@@ -381,7 +454,10 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   }
 
  private:
-  RegionSpace(const std::string& name, MemMap&& mem_map, bool use_generational_cc);
+  RegionSpace(const std::string& name,
+              MemMap&& mem_map,
+              bool use_generational_cc,
+              bool numa_aware);
 
   class Region {
    public:
@@ -394,6 +470,7 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
           end_(nullptr),
           objects_allocated_(0),
           alloc_time_(0),
+          pin_count_(0u),
           is_newly_allocated_(false),
           is_a_tlab_(false),
           state_(RegionState::kRegionStateAllocated),
@@ -409,6 +486,7 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
       objects_allocated_.store(0, std::memory_order_relaxed);
       alloc_time_ = 0;
       live_bytes_ = static_cast<size_t>(-1);
+      pin_count_.store(0u, std::memory_order_relaxed);
       is_newly_allocated_ = false;
       is_a_tlab_ = false;
       thread_ = nullptr;
@@ -552,6 +630,21 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
     // Return whether this region should be evacuated. Used by RegionSpace::SetFromSpace.
     ALWAYS_INLINE bool ShouldBeEvacuated(EvacMode evac_mode);
 
+    // A pinned region holds objects in JNI critical sections, it is never evacuated. The count
+    // only changes in runnable threads, so it is stable during the thread flip.
+    void Pin() {
+      pin_count_.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    void Unpin() {
+      uint32_t old_pin_count = pin_count_.fetch_sub(1u, std::memory_order_relaxed);
+      DCHECK_NE(old_pin_count, 0u);
+    }
+
+    bool IsPinned() const {
+      return pin_count_.load(std::memory_order_relaxed) != 0u;
+    }
+
     void AddLiveBytes(size_t live_bytes) {
       DCHECK(GetUseGenerationalCC() || IsInUnevacFromSpace());
       DCHECK(!IsLargeTail());
@@ -561,6 +654,16 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
       DCHECK_LE(live_bytes_, BytesAllocated());
     }
 
+    void AtomicAddLiveBytes(size_t live_bytes) {
+      DCHECK(GetUseGenerationalCC() || IsInUnevacFromSpace());
+      DCHECK(!IsLargeTail());
+      DCHECK_NE(live_bytes_, static_cast<size_t>(-1));
+      // For large allocations, we always consider all bytes in the regions live. A large object is
+      // marked only once, so its live bytes are only added once.
+      size_t delta = IsLarge() ? Top() - begin_ : live_bytes;
+      reinterpret_cast<Atomic<size_t>*>(&live_bytes_)->fetch_add(delta, std::memory_order_relaxed);
+    }
+
     bool AllAllocatedBytesAreLive() const {
       return LiveBytes() == static_cast<size_t>(Top() - Begin());
     }
@@ -622,6 +725,7 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
     // are concurrent updates.
     Atomic<size_t> objects_allocated_;  // The number of objects allocated.
     uint32_t alloc_time_;               // The allocation time of the region.
+    Atomic<uint32_t> pin_count_;        // The number of JNI critical sections on its objects.
     // Note that newly allocated and evacuated regions use -1 as
     // special value for `live_bytes_`.
     bool is_newly_allocated_;           // True if it's allocated after the last collection.
@@ -634,6 +738,9 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
 
   template<bool kToSpaceOnly, typename Visitor>
   ALWAYS_INLINE void WalkInternal(Visitor&& visitor) NO_THREAD_SAFETY_ANALYSIS;
+  template<bool kToSpaceOnly, typename Visitor>
+  ALWAYS_INLINE void WalkRegionsInternal(Visitor&& visitor, size_t begin, size_t end)
+      NO_THREAD_SAFETY_ANALYSIS;
 
   // Visitor will be iterating on objects in increasing address order.
   template<typename Visitor>
@@ -703,6 +810,16 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   }
 
   Region* AllocateRegion(bool for_evac) REQUIRES(region_lock_);
+  // Try to allocate a free region among the regions [begin, end). Returns null if there is none.
+  Region* AllocateRegionInRange(bool for_evac, size_t begin, size_t end) REQUIRES(region_lock_);
+
+  // Bind each partition of the regions to its NUMA node. Only used in NUMA-aware mode.
+  void BindRegionsToNumaNodes();
+  // Return the NUMA node that the region at index `region_index` is placed on.
+  size_t NumaNodeForRegion(size_t region_index) const {
+    DCHECK_GT(num_numa_nodes_, 1u);
+    return region_index / regions_per_numa_node_;
+  }
   void RevokeThreadLocalBuffersLocked(Thread* thread, bool reuse) REQUIRES(region_lock_);
 
   // Scan region range [`begin`, `end`) in increasing order to try to
@@ -732,6 +849,12 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   // objects earlier in debug mode.
   void PoisonDeadObjectsInUnevacuatedRegion(Region* r);
 
+  // Record the region histogram and, with the `kCopyBudget` policy, set
+  // `(*budget_candidates)[i]` for the regions among the first `iter_limit` ones that fit the
+  // copy budget.
+  void SelectEvacuationCandidates(size_t iter_limit, /* out */ std::vector<bool>* budget_candidates)
+      REQUIRES(region_lock_);
+
   Mutex region_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
   // Cached version of Heap::use_generational_cc_.
@@ -774,6 +897,15 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   // Mark bitmap used by the GC.
   accounting::ContinuousSpaceBitmap mark_bitmap_;
 
+  // The number of NUMA nodes the regions are partitioned among; 1 if not NUMA-aware. Node `n`
+  // holds the regions [n * regions_per_numa_node_, (n + 1) * regions_per_numa_node_).
+  size_t num_numa_nodes_;
+  size_t regions_per_numa_node_;
+
+  EvacuationPolicy evacuation_policy_;
+  size_t evacuation_copy_budget_;
+  RegionHistogram region_histogram_ GUARDED_BY(region_lock_);
+
   DISALLOW_COPY_AND_ASSIGN(RegionSpace);
 };
 
@@ -41,8 +41,12 @@ TaskProcessor::~TaskProcessor() {
 void TaskProcessor::AddTask(Thread* self, HeapTask* task) {
   ScopedThreadStateChange tsc(self, kWaitingForTaskProcessor);
   MutexLock mu(self, lock_);
-  tasks_.insert(task);
-  cond_.Signal(self);
+  auto it = tasks_.insert(task);
+  // The processor thread only sleeps on the earliest task, so a task that sorts after it does not
+  // need a wakeup.
+  if (it == tasks_.begin()) {
+    cond_.Signal(self);
+  }
 }
 
 HeapTask* TaskProcessor::GetTask(Thread* self) {
@@ -82,18 +86,19 @@ void TaskProcessor::UpdateTargetRunTime(Thread* self, HeapTask* task, uint64_t n
   auto range = tasks_.equal_range(task);
   for (auto it = range.first; it != range.second; ++it) {
     if (*it == task) {
-      // Check if the target time was updated, if so re-insert then wait.
+      // Check if the target time was updated, if so re-insert then wait. Reuse the node so that
+      // rescheduling does not allocate while holding the lock.
       if (new_target_time != task->GetTargetRunTime()) {
-        tasks_.erase(it);
+        auto node = tasks_.extract(it);
         task->SetTargetRunTime(new_target_time);
-        tasks_.insert(task);
+        auto new_it = tasks_.insert(std::move(node));
         // If we became the first task then we may need to signal since we changed the task that we
         // are sleeping on.
-        if (*tasks_.begin() == task) {
+        if (new_it == tasks_.begin()) {
           cond_.Signal(self);
         }
-        return;
       }
+      return;
     }
   }
 }
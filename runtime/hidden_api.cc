@@ -20,6 +20,7 @@
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
+#include "base/casts.h"
 #include "base/dumpable.h"
 #include "base/file_utils.h"
 #include "class_root.h"
@@ -378,6 +379,54 @@ static void VisitMembers(const DexFile& dex_file,
   accessor.VisitMethods(fn_visit, fn_visit);
 }
 
+// Returns the position of `field` in the class data of its declaring class or
+// false if it cannot be determined without decoding the class data.
+static bool GetMemberPosition(ArtField* field,
+                              ObjPtr<mirror::Class> declaring_class,
+                              const ClassAccessor& accessor,
+                              uint32_t* position)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // Duplicate fields are dropped when the class is loaded, so the position in
+  // the runtime arrays only matches the class data if there were none.
+  if (declaring_class->NumStaticFields() != accessor.NumStaticFields() ||
+      declaring_class->NumInstanceFields() != accessor.NumInstanceFields()) {
+    return false;
+  }
+  LengthPrefixedArray<ArtField>* fields =
+      field->IsStatic() ? declaring_class->GetSFieldsPtr() : declaring_class->GetIFieldsPtr();
+  DCHECK(fields != nullptr);
+  uintptr_t offset =
+      reinterpret_cast<uintptr_t>(field) - reinterpret_cast<uintptr_t>(&fields->At(0));
+  DCHECK_LT(offset / sizeof(ArtField), fields->size());
+  *position = dchecked_integral_cast<uint32_t>(offset / sizeof(ArtField)) +
+      (field->IsStatic() ? 0u : accessor.NumStaticFields());
+  return true;
+}
+
+static bool GetMemberPosition(ArtMethod* method,
+                              ObjPtr<mirror::Class> declaring_class,
+                              const ClassAccessor& accessor,
+                              uint32_t* position)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ArraySlice<ArtMethod> methods = declaring_class->GetDeclaredMethodsSlice(kRuntimePointerSize);
+  if (methods.empty() || methods.size() != accessor.NumMethods()) {
+    return false;
+  }
+  // Copied methods keep their declaring class but live in another class's
+  // method array, so check that `method` is really one of the declared methods.
+  const size_t method_size = ArtMethod::Size(kRuntimePointerSize);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(&methods[0]);
+  uintptr_t address = reinterpret_cast<uintptr_t>(method);
+  if (address < begin ||
+      address >= begin + methods.size() * method_size ||
+      (address - begin) % method_size != 0u) {
+    return false;
+  }
+  *position =
+      accessor.NumFields() + dchecked_integral_cast<uint32_t>((address - begin) / method_size);
+  return true;
+}
+
 template<typename T>
 uint32_t GetDexFlags(T* member) REQUIRES_SHARED(Locks::mutator_lock_) {
   static_assert(std::is_same<T, ArtField>::value || std::is_same<T, ArtMethod>::value);
@@ -408,13 +457,31 @@ uint32_t GetDexFlags(T* member) REQUIRES_SHARED(Locks::mutator_lock_) {
           << "Interface methods should be inspected instead of proxy class methods";
       flags = ApiList::Greylist();
     } else {
-      uint32_t member_index = GetMemberDexIndex(member);
-      auto fn_visit = [&](const AccessorType& dex_member) {
-        if (dex_member.GetIndex() == member_index) {
-          flags = ApiList(dex_member.GetHiddenapiFlags());
+      // The flags are stored in class data order, so if the position of the
+      // member is known only the flags before it need to be skipped.
+      const DexFile& dex_file = declaring_class->GetDexFile();
+      ClassAccessor accessor(dex_file, *class_def, /* parse_hiddenapi_class_data= */ true);
+      const dex::HiddenapiClassData* hiddenapi_class_data = dex_file.GetHiddenapiClassData();
+      const uint8_t* flags_ptr = (hiddenapi_class_data != nullptr)
+          ? hiddenapi_class_data->GetFlagsPointer(declaring_class->GetDexClassDefIndex())
+          : nullptr;
+      uint32_t position;
+      if (flags_ptr != nullptr &&
+          GetMemberPosition(member, declaring_class, accessor, &position)) {
+        for (uint32_t i = 0; i != position; ++i) {
+          DecodeUnsignedLeb128(&flags_ptr);
         }
-      };
-      VisitMembers(declaring_class->GetDexFile(), *class_def, fn_visit);
+        flags = ApiList(DecodeUnsignedLeb128(&flags_ptr));
+        DCHECK(flags.IsValid());
+      } else {
+        uint32_t member_index = GetMemberDexIndex(member);
+        auto fn_visit = [&](const AccessorType& dex_member) {
+          if (dex_member.GetIndex() == member_index) {
+            flags = ApiList(dex_member.GetHiddenapiFlags());
+          }
+        };
+        VisitMembers(dex_file, *class_def, fn_visit);
+      }
     }
   } else {
     // Class was redefined using JVMTI. We have a pointer to the original dex file
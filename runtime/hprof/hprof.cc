@@ -30,17 +30,22 @@
 #include <string.h>
 #include <sys/time.h>
 #include <sys/uio.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
 #include <set>
+#include <unordered_map>
 
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 
+#include "zlib.h"
+
 #include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "base/array_ref.h"
+#include "base/data_hash.h"
 #include "base/file_utils.h"
 #include "base/logging.h"
 #include "base/macros.h"
@@ -74,6 +79,16 @@ namespace hprof {
 
 static constexpr bool kDirectStream = true;
 
+// A forked dump that takes longer than this is assumed to be stuck on a lock held by a thread that
+// did not survive the fork, and is killed.
+static constexpr unsigned int kForkedDumpTimeoutSeconds = 20 * 60;
+
+// Primitive arrays with fewer bytes of elements are not worth deduplicating.
+static constexpr size_t kMinDeduplicatedArrayBytes = 16;
+
+// Size of the buffer receiving compressed output.
+static constexpr size_t kCompressedOutputBufferSize = 64 * KB;
+
 static constexpr uint32_t kHprofTime = 0;
 static constexpr uint32_t kHprofNullThread = 0;
 
@@ -127,6 +142,9 @@ enum HprofHeapTag {
   HPROF_ROOT_JNI_MONITOR = 0x8e,
   HPROF_UNREACHABLE = 0x90,  // Obsolete.
   HPROF_PRIMITIVE_ARRAY_NODATA_DUMP = 0xc3,  // Obsolete.
+  // A primitive array with the same elements as an earlier primitive array dump. The record is
+  // a primitive array dump in which the element values are replaced by the ID of that array.
+  HPROF_PRIMITIVE_ARRAY_DUPLICATE_DUMP = 0xc4,
 };
 
 enum HprofHeapId {
@@ -388,13 +406,36 @@ class EndianOutputBuffered : public EndianOutput {
   std::vector<uint8_t> buffer_;
 };
 
+// Writes records to a file, optionally as a gzip stream. A compressed stream is flushed at the end
+// of every heap dump segment so that each segment is written out as it completes.
 class FileEndianOutput final : public EndianOutputBuffered {
  public:
-  FileEndianOutput(File* fp, size_t reserved_size)
-      : EndianOutputBuffered(reserved_size), fp_(fp), errors_(false) {
+  FileEndianOutput(File* fp, size_t reserved_size, bool compress)
+      : EndianOutputBuffered(reserved_size), fp_(fp), errors_(false), compress_(compress) {
     DCHECK(fp != nullptr);
+    if (compress_) {
+      memset(&stream_, 0, sizeof(stream_));
+      // Adding 16 to the window bits selects the gzip wrapper.
+      errors_ = deflateInit2(&stream_,
+                             Z_DEFAULT_COMPRESSION,
+                             Z_DEFLATED,
+                             16 + MAX_WBITS,
+                             /* memLevel= */ 8,
+                             Z_DEFAULT_STRATEGY) != Z_OK;
+      compressed_buffer_.resize(kCompressedOutputBufferSize);
+    }
   }
   ~FileEndianOutput() {
+    if (compress_) {
+      deflateEnd(&stream_);
+    }
+  }
+
+  // Writes the end of the compressed stream. Must be called after the last record.
+  void Finish() {
+    if (compress_) {
+      Deflate(nullptr, 0, Z_FINISH);
+    }
   }
 
   bool Errors() {
@@ -403,14 +444,42 @@ class FileEndianOutput final : public EndianOutputBuffered {
 
  protected:
   void HandleFlush(const uint8_t* buffer, size_t length) override {
-    if (!errors_) {
+    if (compress_) {
+      bool segment = length != 0 && buffer[0] == HPROF_TAG_HEAP_DUMP_SEGMENT;
+      Deflate(buffer, length, segment ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+    } else if (!errors_) {
       errors_ = !fp_->WriteFully(buffer, length);
     }
   }
 
  private:
+  void Deflate(const uint8_t* buffer, size_t length, int flush) {
+    if (errors_) {
+      return;
+    }
+    stream_.next_in = const_cast<uint8_t*>(buffer);
+    stream_.avail_in = length;
+    do {
+      stream_.next_out = compressed_buffer_.data();
+      stream_.avail_out = compressed_buffer_.size();
+      if (deflate(&stream_, flush) == Z_STREAM_ERROR) {
+        errors_ = true;
+        return;
+      }
+      size_t compressed_length = compressed_buffer_.size() - stream_.avail_out;
+      if (compressed_length != 0 &&
+          !fp_->WriteFully(compressed_buffer_.data(), compressed_length)) {
+        errors_ = true;
+        return;
+      }
+    } while (stream_.avail_out == 0);
+  }
+
   File* fp_;
   bool errors_;
+  const bool compress_;
+  z_stream stream_;
+  std::vector<uint8_t> compressed_buffer_;
 };
 
 class VectorEndianOuputput final : public EndianOutputBuffered {
@@ -437,7 +506,9 @@ class Hprof : public SingleRootVisitor {
   Hprof(const char* output_filename, int fd, bool direct_to_ddms)
       : filename_(output_filename),
         fd_(fd),
-        direct_to_ddms_(direct_to_ddms) {
+        direct_to_ddms_(direct_to_ddms),
+        compress_(!direct_to_ddms && Runtime::Current()->GetCompressHprofDump()),
+        deduplicate_arrays_(!direct_to_ddms && Runtime::Current()->GetDeduplicateHprofArrays()) {
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
   }
 
@@ -509,6 +580,8 @@ class Hprof : public SingleRootVisitor {
     // Reset current heap and object count.
     current_heap_ = HPROF_HEAP_DEFAULT;
     objects_in_segment_ = 0;
+    // Both passes must make the same deduplication decisions.
+    primitive_arrays_.clear();
 
     if (header_first) {
       ProcessHeader(true);
@@ -657,6 +730,41 @@ class Hprof : public SingleRootVisitor {
     return LookupStringId(c->PrettyDescriptor());
   }
 
+  // Writes the header of a primitive array dump. If array deduplication is enabled and an earlier
+  // primitive array has the same elements, writes a reference to that array instead and returns
+  // false; otherwise the caller must write the `length` elements at `data`.
+  bool AddPrimitiveArrayHeader(const mirror::Object* id,
+                               HprofStackTraceSerialNumber stack_trace_sn,
+                               uint32_t length,
+                               HprofBasicType type,
+                               const void* data,
+                               size_t element_size) {
+    if (deduplicate_arrays_ && length * element_size >= kMinDeduplicatedArrayBytes) {
+      ArrayRef<const uint8_t> bytes(reinterpret_cast<const uint8_t*>(data), length * element_size);
+      auto result =
+          primitive_arrays_.emplace(DataHash()(bytes), PrimitiveArrayInfo{id, type, bytes});
+      const PrimitiveArrayInfo& original = result.first->second;
+      if (!result.second &&
+          original.type == type &&
+          original.data.size() == bytes.size() &&
+          memcmp(original.data.data(), bytes.data(), bytes.size()) == 0) {
+        __ AddU1(HPROF_PRIMITIVE_ARRAY_DUPLICATE_DUMP);
+        __ AddObjectId(id);
+        __ AddStackTraceSerialNumber(stack_trace_sn);
+        __ AddU4(length);
+        __ AddU1(type);
+        __ AddObjectId(original.id);
+        return false;
+      }
+    }
+    __ AddU1(HPROF_PRIMITIVE_ARRAY_DUMP);
+    __ AddObjectId(id);
+    __ AddStackTraceSerialNumber(stack_trace_sn);
+    __ AddU4(length);
+    __ AddU1(type);
+    return true;
+  }
+
   void WriteFixedHeader() {
     // Write the file header.
     // U1: NUL-terminated magic string.
@@ -778,9 +886,10 @@ class Hprof : public SingleRootVisitor {
     std::unique_ptr<File> file(new File(out_fd, filename_, true));
     bool okay;
     {
-      FileEndianOutput file_output(file.get(), max_length);
+      FileEndianOutput file_output(file.get(), max_length, compress_);
       output_ = &file_output;
       ProcessHeap(true);
+      file_output.Finish();
       okay = !file_output.Errors();
 
       if (okay) {
@@ -877,6 +986,12 @@ class Hprof : public SingleRootVisitor {
   int fd_;
   bool direct_to_ddms_;
 
+  // Whether a file dump is gzip compressed, see -XX:CompressHprofDump.
+  const bool compress_;
+  // Whether primitive arrays with the same elements are only dumped once, see
+  // -XX:DeduplicateHprofArrays.
+  const bool deduplicate_arrays_;
+
   uint64_t start_ns_ = NanoTime();
 
   EndianOutput* output_ = nullptr;
@@ -911,6 +1026,15 @@ class Hprof : public SingleRootVisitor {
   // To make sure we don't dump the same object multiple times. b/34967844
   std::unordered_set<mirror::Object*> visited_objects_;
 
+  // The first dumped primitive array for each hash of array elements, for deduplication. The heap
+  // is paused for the whole dump, so the element data stays valid.
+  struct PrimitiveArrayInfo {
+    const mirror::Object* id;
+    HprofBasicType type;
+    ArrayRef<const uint8_t> data;
+  };
+  std::unordered_map<size_t, PrimitiveArrayInfo> primitive_arrays_;
+
   friend class GcRootVisitor;
   DISALLOW_COPY_AND_ASSIGN(Hprof);
 };
@@ -1043,6 +1167,7 @@ void Hprof::MarkRootObject(const mirror::Object* obj, jobject jni_obj, HprofHeap
     case HPROF_PRIMITIVE_ARRAY_DUMP:
     case HPROF_HEAP_DUMP_INFO:
     case HPROF_PRIMITIVE_ARRAY_NODATA_DUMP:
+    case HPROF_PRIMITIVE_ARRAY_DUPLICATE_DUMP:
       // Ignored.
       break;
 
@@ -1445,12 +1570,14 @@ void Hprof::DumpHeapArray(mirror::Array* obj, mirror::Class* klass) {
         Primitive::Descriptor(klass->GetComponentType()->GetPrimitiveType()), &size);
 
     // obj is a primitive array.
-    __ AddU1(HPROF_PRIMITIVE_ARRAY_DUMP);
-
-    __ AddObjectId(obj);
-    __ AddStackTraceSerialNumber(LookupStackTraceSerialNumber(obj));
-    __ AddU4(length);
-    __ AddU1(t);
+    if (!AddPrimitiveArrayHeader(obj,
+                                 LookupStackTraceSerialNumber(obj),
+                                 length,
+                                 t,
+                                 obj->GetRawData(size, 0),
+                                 size)) {
+      return;
+    }
 
     // Dump the raw, packed element values.
     if (size == 1) {
@@ -1553,16 +1680,24 @@ void Hprof::DumpHeapInstanceObject(mirror::Object* obj,
   CHECK_EQ(obj->IsString(), string_value != nullptr);
   if (string_value != nullptr) {
     ObjPtr<mirror::String> s = obj->AsString();
-    __ AddU1(HPROF_PRIMITIVE_ARRAY_DUMP);
-    __ AddObjectId(string_value);
-    __ AddStackTraceSerialNumber(LookupStackTraceSerialNumber(obj));
-    __ AddU4(s->GetLength());
     if (s->IsCompressed()) {
-      __ AddU1(hprof_basic_byte);
-      __ AddU1List(s->GetValueCompressed(), s->GetLength());
+      if (AddPrimitiveArrayHeader(string_value,
+                                  LookupStackTraceSerialNumber(obj),
+                                  s->GetLength(),
+                                  hprof_basic_byte,
+                                  s->GetValueCompressed(),
+                                  sizeof(uint8_t))) {
+        __ AddU1List(s->GetValueCompressed(), s->GetLength());
+      }
     } else {
-      __ AddU1(hprof_basic_char);
-      __ AddU2List(s->GetValue(), s->GetLength());
+      if (AddPrimitiveArrayHeader(string_value,
+                                  LookupStackTraceSerialNumber(obj),
+                                  s->GetLength(),
+                                  hprof_basic_char,
+                                  s->GetValue(),
+                                  sizeof(uint16_t))) {
+        __ AddU2List(s->GetValue(), s->GetLength());
+      }
     }
   } else if (fake_object_array != nullptr) {
     DumpFakeObjectArray(fake_object_array, fake_roots);
@@ -1594,6 +1729,48 @@ void Hprof::VisitRoot(mirror::Object* obj, const RootInfo& info) {
   MarkRootObject(obj, nullptr, xlate[info.GetType()], info.GetThreadId());
 }
 
+// Fork a process that dumps its copy-on-write snapshot of the heap, so that the threads of this
+// process are only suspended for the duration of the fork. Returns false if no process could be
+// started, in which case the caller dumps the heap itself. Does not return in the forked process.
+static bool DumpHeapInForkedProcess(const char* filename, int fd)
+    REQUIRES(Locks::mutator_lock_) {
+  // Open the output before forking, errors are reported by the in-process dump.
+  int out_fd = (fd >= 0)
+      ? DupCloexec(fd)
+      : open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (out_fd < 0) {
+    return false;
+  }
+  pid_t pid = fork();
+  if (pid == -1) {
+    PLOG(WARNING) << "hprof: fork failed, dumping the heap in process";
+    close(out_fd);
+    return false;
+  }
+  if (pid != 0) {
+    // Reap the intermediate process, it exits as soon as the dumping process is started.
+    int stat_loc;
+    while (waitpid(pid, &stat_loc, 0) == -1 && errno == EINTR) {
+    }
+    close(out_fd);
+    LOG(INFO) << "hprof: heap dump \"" << filename << "\" continues in a forked process";
+    return true;
+  }
+  // Only the forking thread exists from here on. It keeps the mutator lock exclusively held for
+  // the whole dump, so the snapshot only changes through the writes of the dump itself. Daemonize
+  // so that the dump is not a child of the original process, which does not wait for it.
+  if (daemon(/* nochdir= */ 1, /* noclose= */ 1) == -1) {
+    PLOG(ERROR) << "hprof: daemon failed";
+    _exit(1);
+  }
+  alarm(kForkedDumpTimeoutSeconds);
+  Hprof hprof(filename, out_fd, /* direct_to_ddms= */ false);
+  hprof.Dump();
+  close(out_fd);
+  // Do not run the atexit handlers registered by the original process.
+  _exit(Thread::Current()->IsExceptionPending() ? 1 : 0);
+}
+
 // If "direct_to_ddms" is true, the other arguments are ignored, and data is
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
@@ -1607,6 +1784,11 @@ void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
                                   gc::kGcCauseHprof,
                                   gc::kCollectorTypeHprof);
   ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
+  if (!direct_to_ddms &&
+      Runtime::Current()->GetForkedHprofDump() &&
+      DumpHeapInForkedProcess(filename, fd)) {
+    return;
+  }
   Hprof hprof(filename, fd, direct_to_ddms);
   hprof.Dump();
 }
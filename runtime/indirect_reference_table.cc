@@ -66,14 +66,17 @@ void IndirectReferenceTable::AbortIfNoCheckJNI(const std::string& msg) {
 IndirectReferenceTable::IndirectReferenceTable(size_t max_count,
                                                IndirectRefKind desired_kind,
                                                ResizableCapacity resizable,
-                                               std::string* error_msg)
+                                               std::string* error_msg,
+                                               uint32_t shard)
     : segment_state_(kIRTFirstSegment),
       kind_(desired_kind),
+      shard_(shard),
       max_entries_(max_count),
       current_num_holes_(0),
       resizable_(resizable) {
   CHECK(error_msg != nullptr);
   CHECK_NE(desired_kind, kHandleScopeOrInvalid);
+  CHECK_LT(shard, kMaxShards);
 
   // Overflow and maximum check.
   CHECK_LE(max_count, kMaxTableSizeInBytes / sizeof(IrtEntry));
@@ -126,6 +129,15 @@ void IndirectReferenceTable::ConstexprChecks() {
   static_assert(DecodeIndex(EncodeIndex(1u)) == 1u, "Index encoding error");
   static_assert(DecodeIndex(EncodeIndex(2u)) == 2u, "Index encoding error");
   static_assert(DecodeIndex(EncodeIndex(3u)) == 3u, "Index encoding error");
+
+  // Check shard.
+  static_assert(DecodeShard(EncodeShard(0u)) == 0u, "Shard encoding error");
+  static_assert(DecodeShard(EncodeShard(kMaxShards - 1u)) == kMaxShards - 1u,
+                "Shard encoding error");
+  static_assert(DecodeShard(EncodeIndex(kMaxShards) | EncodeShard(1u)) == 1u,
+                "Shard encoding error");
+  static_assert(DecodeIndex(EncodeIndex(1u) | EncodeShard(kMaxShards - 1u)) == 1u,
+                "Index encoding error");
 }
 
 bool IndirectReferenceTable::IsValid() const {
@@ -221,17 +233,22 @@ bool IndirectReferenceTable::Resize(size_t new_size, std::string* error_msg) {
   // Note: the above check also ensures that there is no overflow below.
 
   const size_t table_bytes = new_size * sizeof(IrtEntry);
-  MemMap new_map = MemMap::MapAnonymous("indirect ref table",
-                                        table_bytes,
-                                        PROT_READ | PROT_WRITE,
-                                        /*low_4gb=*/ false,
-                                        error_msg);
-  if (!new_map.IsValid()) {
-    return false;
-  }
+  // Grow the table by remapping its pages where possible. Tables reach hundreds of thousands of
+  // entries, copying them on each doubling would touch all of their pages again.
+  std::string grow_error_msg;
+  if (!table_mem_map_.Grow(table_bytes, &grow_error_msg)) {
+    MemMap new_map = MemMap::MapAnonymous("indirect ref table",
+                                          table_bytes,
+                                          PROT_READ | PROT_WRITE,
+                                          /*low_4gb=*/ false,
+                                          error_msg);
+    if (!new_map.IsValid()) {
+      return false;
+    }
 
-  memcpy(new_map.Begin(), table_mem_map_.Begin(), table_mem_map_.Size());
-  table_mem_map_ = std::move(new_map);
+    memcpy(new_map.Begin(), table_mem_map_.Begin(), table_mem_map_.Size());
+    table_mem_map_ = std::move(new_map);
+  }
   table_ = reinterpret_cast<IrtEntry*>(table_mem_map_.Begin());
   max_entries_ = new_size;
 
@@ -80,7 +80,8 @@ class Object;
 // convenient to let null be null, so we use void*.
 //
 // We need a (potentially) large table index and a 2-bit reference type (global, local, weak
-// global). We also reserve some bits to be used to detect stale indirect references: we put a
+// global). Tables may be split into shards, so refs also hold the shard of the table that holds
+// them. We also reserve some bits to be used to detect stale indirect references: we put a
 // serial number in the extra bits, and keep a copy of the serial number in the table. This requires
 // more memory and additional memory accesses on add/get, but is moving-GC safe. It will catch
 // additional problems, e.g.: create iref1 for obj, delete iref1, create iref2 for same obj,
@@ -225,15 +226,20 @@ class IndirectReferenceTable {
     kYes
   };
 
+  // The number of tables a kind of reference can be split into. See GetShard.
+  static constexpr size_t kShardBits = 2;
+  static constexpr size_t kMaxShards = 1u << kShardBits;
+
   // WARNING: Construction of the IndirectReferenceTable may fail.
   // error_msg must not be null. If error_msg is set by the constructor, then
   // construction has failed and the IndirectReferenceTable will be in an
   // invalid state. Use IsValid to check whether the object is in an invalid
-  // state.
+  // state. `shard` is encoded in the references of this table.
   IndirectReferenceTable(size_t max_count,
                          IndirectRefKind kind,
                          ResizableCapacity resizable,
-                         std::string* error_msg);
+                         std::string* error_msg,
+                         uint32_t shard = 0u);
 
   ~IndirectReferenceTable();
 
@@ -331,6 +337,11 @@ class IndirectReferenceTable {
     return DecodeIndirectRefKind(reinterpret_cast<uintptr_t>(iref));
   }
 
+  // Determine which shard of the tables of its kind holds this indirect reference.
+  ALWAYS_INLINE static inline uint32_t GetShard(IndirectRef iref) {
+    return DecodeShard(reinterpret_cast<uintptr_t>(iref));
+  }
+
  private:
   static constexpr size_t kSerialBits = MinimumBitsToStore(kIRTPrevCount);
   static constexpr uint32_t kShiftedSerialMask = (1u << kSerialBits) - 1;
@@ -339,13 +350,24 @@ class IndirectReferenceTable {
       static_cast<uint32_t>(IndirectRefKind::kLastKind));
   static constexpr uint32_t kKindMask = (1u << kKindBits) - 1;
 
+  static constexpr uint32_t kShardMask = kMaxShards - 1u;
+
   static constexpr uintptr_t EncodeIndex(uint32_t table_index) {
     static_assert(sizeof(IndirectRef) == sizeof(uintptr_t), "Unexpected IndirectRef size");
-    DCHECK_LE(MinimumBitsToStore(table_index), BitSizeOf<uintptr_t>() - kSerialBits - kKindBits);
-    return (static_cast<uintptr_t>(table_index) << kKindBits << kSerialBits);
+    DCHECK_LE(MinimumBitsToStore(table_index),
+              BitSizeOf<uintptr_t>() - kShardBits - kSerialBits - kKindBits);
+    return (static_cast<uintptr_t>(table_index) << kKindBits << kSerialBits << kShardBits);
   }
   static constexpr uint32_t DecodeIndex(uintptr_t uref) {
-    return static_cast<uint32_t>((uref >> kKindBits) >> kSerialBits);
+    return static_cast<uint32_t>(((uref >> kKindBits) >> kSerialBits) >> kShardBits);
+  }
+
+  static constexpr uintptr_t EncodeShard(uint32_t shard) {
+    DCHECK_LT(shard, kMaxShards);
+    return static_cast<uintptr_t>(shard) << kKindBits << kSerialBits;
+  }
+  static constexpr uint32_t DecodeShard(uintptr_t uref) {
+    return static_cast<uint32_t>((uref >> kKindBits) >> kSerialBits) & kShardMask;
   }
 
   static constexpr uintptr_t EncodeIndirectRefKind(IndirectRefKind kind) {
@@ -365,7 +387,10 @@ class IndirectReferenceTable {
 
   constexpr uintptr_t EncodeIndirectRef(uint32_t table_index, uint32_t serial) const {
     DCHECK_LT(table_index, max_entries_);
-    return EncodeIndex(table_index) | EncodeSerial(serial) | EncodeIndirectRefKind(kind_);
+    return EncodeIndex(table_index) |
+           EncodeShard(shard_) |
+           EncodeSerial(serial) |
+           EncodeIndirectRefKind(kind_);
   }
 
   static void ConstexprChecks();
@@ -403,6 +428,8 @@ class IndirectReferenceTable {
   IrtEntry* table_;
   // bit mask, ORed into all irefs.
   const IndirectRefKind kind_;
+  // Shard of the tables of `kind_`, also ORed into all irefs.
+  const uint32_t shard_;
 
   // max #of entries allowed (modulo resizing).
   size_t max_entries_;
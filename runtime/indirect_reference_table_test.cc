@@ -514,4 +514,49 @@ TEST_F(IndirectReferenceTableTest, Resize) {
   EXPECT_EQ(irt.Capacity(), kTableMax + 1);
 }
 
+TEST_F(IndirectReferenceTableTest, Shards) {
+  // This will lead to error messages in the log.
+  ScopedLogSeverity sls(LogSeverity::FATAL);
+
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kTableMax = 20;
+
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Class> c = hs.NewHandle(
+      class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;"));
+  ASSERT_TRUE(c != nullptr);
+  Handle<mirror::Object> obj0 = hs.NewHandle(c->AllocObject(soa.Self()));
+  ASSERT_TRUE(obj0 != nullptr);
+
+  std::string error_msg;
+  IndirectReferenceTable irt0(kTableMax,
+                              kGlobal,
+                              IndirectReferenceTable::ResizableCapacity::kNo,
+                              &error_msg);
+  ASSERT_TRUE(irt0.IsValid()) << error_msg;
+  const uint32_t kLastShard = IndirectReferenceTable::kMaxShards - 1u;
+  IndirectReferenceTable irt1(kTableMax,
+                              kGlobal,
+                              IndirectReferenceTable::ResizableCapacity::kNo,
+                              &error_msg,
+                              kLastShard);
+  ASSERT_TRUE(irt1.IsValid()) << error_msg;
+
+  const IRTSegmentState cookie = kIRTFirstSegment;
+  IndirectRef iref0 = irt0.Add(cookie, obj0.Get(), &error_msg);
+  IndirectRef iref1 = irt1.Add(cookie, obj0.Get(), &error_msg);
+  ASSERT_NE(iref0, nullptr) << error_msg;
+  ASSERT_NE(iref1, nullptr) << error_msg;
+  EXPECT_EQ(IndirectReferenceTable::GetShard(iref0), 0u);
+  EXPECT_EQ(IndirectReferenceTable::GetShard(iref1), kLastShard);
+  EXPECT_EQ(IndirectReferenceTable::GetIndirectRefKind(iref1), kGlobal);
+  EXPECT_NE(iref0, iref1);
+  EXPECT_OBJ_PTR_EQ(irt1.Get(iref1), obj0.Get());
+
+  // The shard is part of the reference, a table does not accept the references of another.
+  EXPECT_FALSE(irt0.Remove(cookie, iref1));
+  EXPECT_TRUE(irt1.Remove(cookie, iref1));
+  EXPECT_TRUE(irt0.Remove(cookie, iref0));
+}
+
 }  // namespace art
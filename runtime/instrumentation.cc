@@ -1010,6 +1010,24 @@ bool Instrumentation::IsDeoptimizedMethodsEmpty() const {
   return deoptimized_methods_.empty();
 }
 
+// Returns whether `thread` has a frame of `method`, including an inlined one, on its stack.
+static bool HasFrameOf(Thread* thread, ArtMethod* method) REQUIRES(Locks::mutator_lock_) {
+  bool found = false;
+  StackVisitor::WalkStack(
+      [&](const StackVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_) {
+        ArtMethod* m = visitor->GetMethod();
+        if (m != nullptr && !m->IsRuntimeMethod() && m->GetCanonicalMethod() == method) {
+          found = true;
+          return false;
+        }
+        return true;
+      },
+      thread,
+      /* context= */ nullptr,
+      StackVisitor::StackWalkKind::kIncludeInlinedFrames);
+  return found;
+}
+
 void Instrumentation::Deoptimize(ArtMethod* method) {
   CHECK(!method->IsNative());
   CHECK(!method->IsProxyMethod());
@@ -1026,10 +1044,19 @@ void Instrumentation::Deoptimize(ArtMethod* method) {
     UpdateEntrypoints(method, GetQuickInstrumentationEntryPoint());
 
     // Install instrumentation exit stub and instrumentation frames. We may already have installed
-    // these previously so it will only cover the newly created frames.
+    // these previously so it will only cover the newly created frames. Only threads with an
+    // active frame of the method need them, so that the frame is deoptimized when its callee
+    // returns. Other threads enter the method through its new entrypoint.
     instrumentation_stubs_installed_ = true;
     MutexLock mu(self, *Locks::thread_list_lock_);
-    Runtime::Current()->GetThreadList()->ForEach(InstrumentationInstallStack, this);
+    // The compiler gets confused on the thread annotations of the lambda, but we hold the
+    // mutator lock exclusively at this point.
+    Locks::mutator_lock_->AssertExclusiveHeld(self);
+    Runtime::Current()->GetThreadList()->ForEach([&](Thread* thread) NO_THREAD_SAFETY_ANALYSIS {
+      if (HasFrameOf(thread, method)) {
+        InstrumentationInstallStack(thread, this);
+      }
+    });
   }
 }
 
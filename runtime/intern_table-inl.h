@@ -46,11 +46,21 @@ inline size_t InternTable::AddTableFromMemory(const uint8_t* ptr,
   {
     // Hold the lock while calling the visitor to prevent possible race
     // conditions with another thread adding intern strings.
-    MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+    WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
     // Visit the unordered set, may remove elements.
     visitor(set);
     if (!set.empty()) {
-      strong_interns_.AddInternStrings(std::move(set), is_boot_image);
+      static constexpr bool kCheckDuplicates = kIsDebugBuild;
+      if (kCheckDuplicates) {
+        // Avoid doing read barriers since the space might not yet be added to the heap.
+        // See b/117803941
+        for (GcRoot<mirror::String>& string : set) {
+          ObjPtr<mirror::String> s = string.Read<kWithoutReadBarrier>();
+          CHECK(FindStrong(GetShard(s), s) == nullptr)
+              << "Already found " << s->ToModifiedUtf8() << " in the intern table";
+        }
+      }
+      image_strong_interns_.AddInternStrings(std::move(set), is_boot_image);
     }
   }
   return read_count;
@@ -58,16 +68,6 @@ inline size_t InternTable::AddTableFromMemory(const uint8_t* ptr,
 
 inline void InternTable::Table::AddInternStrings(UnorderedSet&& intern_strings,
                                                  bool is_boot_image) {
-  static constexpr bool kCheckDuplicates = kIsDebugBuild;
-  if (kCheckDuplicates) {
-    // Avoid doing read barriers since the space might not yet be added to the heap.
-    // See b/117803941
-    for (GcRoot<mirror::String>& string : intern_strings) {
-      CHECK(Find(string.Read<kWithoutReadBarrier>()) == nullptr)
-          << "Already found " << string.Read<kWithoutReadBarrier>()->ToModifiedUtf8()
-          << " in the intern table";
-    }
-  }
   // Insert at the front since we add new interns into the back.
   tables_.insert(tables_.begin(),
                  InternalTable(std::move(intern_strings), is_boot_image));
@@ -91,8 +91,13 @@ inline void InternTable::VisitInterns(const Visitor& visitor,
       }
     }
   };
-  visit_tables(strong_interns_.tables_);
-  visit_tables(weak_interns_.tables_);
+  visit_tables(image_strong_interns_.tables_);
+  for (Shard& shard : shards_) {
+    visit_tables(shard.strong_interns.tables_);
+  }
+  for (Shard& shard : shards_) {
+    visit_tables(shard.weak_interns.tables_);
+  }
 }
 
 inline size_t InternTable::CountInterns(bool visit_boot_images,
@@ -110,8 +115,11 @@ inline size_t InternTable::CountInterns(bool visit_boot_images,
       }
     }
   };
-  visit_tables(strong_interns_.tables_);
-  visit_tables(weak_interns_.tables_);
+  visit_tables(image_strong_interns_.tables_);
+  for (const Shard& shard : shards_) {
+    visit_tables(shard.strong_interns.tables_);
+    visit_tables(shard.weak_interns.tables_);
+  }
   return ret;
 }
 
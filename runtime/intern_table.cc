@@ -35,25 +35,37 @@
 
 namespace art {
 
+InternTable::Shard::Shard()
+    : lock("InternTable shard lock", kInternTableShardLock),
+      weak_intern_condition("New intern condition", lock) {
+}
+
 InternTable::InternTable()
     : log_new_roots_(false),
-      weak_intern_condition_("New intern condition", *Locks::intern_table_lock_),
+      image_strong_interns_(/*has_initial_table=*/ false),
       weak_root_state_(gc::kWeakRootStateNormal) {
 }
 
 size_t InternTable::Size() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size() + weak_interns_.Size();
+  return StrongSize() + WeakSize();
 }
 
 size_t InternTable::StrongSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size();
+  WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  size_t size = image_strong_interns_.Size();
+  for (const Shard& shard : shards_) {
+    size += shard.strong_interns.Size();
+  }
+  return size;
 }
 
 size_t InternTable::WeakSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return weak_interns_.Size();
+  WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  size_t size = 0u;
+  for (const Shard& shard : shards_) {
+    size += shard.weak_interns.Size();
+  }
+  return size;
 }
 
 void InternTable::DumpForSigQuit(std::ostream& os) const {
@@ -61,42 +73,65 @@ void InternTable::DumpForSigQuit(std::ostream& os) const {
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
   if ((flags & kVisitRootFlagAllRoots) != 0) {
-    strong_interns_.VisitRoots(visitor);
+    image_strong_interns_.VisitRoots(visitor);
+    for (Shard& shard : shards_) {
+      shard.strong_interns.VisitRoots(visitor);
+    }
   } else if ((flags & kVisitRootFlagNewRoots) != 0) {
-    for (auto& root : new_strong_intern_roots_) {
-      ObjPtr<mirror::String> old_ref = root.Read<kWithoutReadBarrier>();
-      root.VisitRoot(visitor, RootInfo(kRootInternedString));
-      ObjPtr<mirror::String> new_ref = root.Read<kWithoutReadBarrier>();
-      if (new_ref != old_ref) {
-        // The GC moved a root in the log. Need to search the strong interns and update the
-        // corresponding object. This is slow, but luckily for us, this may only happen with a
-        // concurrent moving GC.
-        strong_interns_.Remove(old_ref);
-        strong_interns_.Insert(new_ref);
+    for (Shard& shard : shards_) {
+      for (auto& root : shard.new_strong_intern_roots) {
+        ObjPtr<mirror::String> old_ref = root.Read<kWithoutReadBarrier>();
+        root.VisitRoot(visitor, RootInfo(kRootInternedString));
+        ObjPtr<mirror::String> new_ref = root.Read<kWithoutReadBarrier>();
+        if (new_ref != old_ref) {
+          // The GC moved a root in the log. Need to search the strong interns and update the
+          // corresponding object. This is slow, but luckily for us, this may only happen with a
+          // concurrent moving GC.
+          shard.strong_interns.Remove(old_ref);
+          shard.strong_interns.Insert(new_ref);
+        }
       }
     }
   }
   if ((flags & kVisitRootFlagClearRootLog) != 0) {
-    new_strong_intern_roots_.clear();
+    for (Shard& shard : shards_) {
+      shard.new_strong_intern_roots.clear();
+    }
   }
   if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
     log_new_roots_ = true;
   } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
     log_new_roots_ = false;
   }
-  // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
+  // Note: we deliberately don't visit the weak interns and the immutable image roots.
+}
+
+InternTable::Shard& InternTable::GetShard(ObjPtr<mirror::String> s) {
+  return GetShard(s->GetHashCode());
+}
+
+ObjPtr<mirror::String> InternTable::FindStrong(Shard& shard, ObjPtr<mirror::String> s) {
+  ObjPtr<mirror::String> image_string = image_strong_interns_.Find(s);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  return shard.strong_interns.Find(s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeak(Thread* self, ObjPtr<mirror::String> s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupWeakLocked(s);
+  ReaderMutexLock mu(self, *Locks::intern_table_lock_);
+  Shard& shard = GetShard(s);
+  MutexLock mu2(self, shard.lock);
+  return shard.weak_interns.Find(s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self, ObjPtr<mirror::String> s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupStrongLocked(s);
+  ReaderMutexLock mu(self, *Locks::intern_table_lock_);
+  Shard& shard = GetShard(s);
+  MutexLock mu2(self, shard.lock);
+  return FindStrong(shard, s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
@@ -106,95 +141,108 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
   Utf8String string(utf16_length,
                     utf8_data,
                     ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length));
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(string);
+  ReaderMutexLock mu(self, *Locks::intern_table_lock_);
+  ObjPtr<mirror::String> image_string = image_strong_interns_.Find(string);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Shard& shard = GetShard(string.GetHash());
+  MutexLock mu2(self, shard.lock);
+  return shard.strong_interns.Find(string);
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeakLocked(ObjPtr<mirror::String> s) {
-  return weak_interns_.Find(s);
+  return GetShard(s).weak_interns.Find(s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrongLocked(ObjPtr<mirror::String> s) {
-  return strong_interns_.Find(s);
+  return FindStrong(GetShard(s), s);
 }
 
 void InternTable::AddNewTable() {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.AddNewTable();
-  strong_interns_.AddNewTable();
+  WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  for (Shard& shard : shards_) {
+    shard.weak_interns.AddNewTable();
+    shard.strong_interns.AddNewTable();
+  }
 }
 
-ObjPtr<mirror::String> InternTable::InsertStrong(ObjPtr<mirror::String> s) {
+ObjPtr<mirror::String> InternTable::InsertStrong(Shard& shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordStrongStringInsertion(s);
   }
   if (log_new_roots_) {
-    new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
+    shard.new_strong_intern_roots.push_back(GcRoot<mirror::String>(s));
   }
-  strong_interns_.Insert(s);
+  shard.strong_interns.Insert(s);
   return s;
 }
 
-ObjPtr<mirror::String> InternTable::InsertWeak(ObjPtr<mirror::String> s) {
+ObjPtr<mirror::String> InternTable::InsertWeak(Shard& shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordWeakStringInsertion(s);
   }
-  weak_interns_.Insert(s);
+  shard.weak_interns.Insert(s);
   return s;
 }
 
-void InternTable::RemoveStrong(ObjPtr<mirror::String> s) {
-  strong_interns_.Remove(s);
+void InternTable::RemoveStrong(Shard& shard, ObjPtr<mirror::String> s) {
+  shard.strong_interns.Remove(s);
 }
 
-void InternTable::RemoveWeak(ObjPtr<mirror::String> s) {
+void InternTable::RemoveWeak(Shard& shard, ObjPtr<mirror::String> s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
     runtime->RecordWeakStringRemoval(s);
   }
-  weak_interns_.Remove(s);
+  shard.weak_interns.Remove(s);
 }
 
 // Insert/remove methods used to undo changes made during an aborted transaction.
 ObjPtr<mirror::String> InternTable::InsertStrongFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertStrong(s);
+  return InsertStrong(GetShard(s), s);
 }
 
 ObjPtr<mirror::String> InternTable::InsertWeakFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertWeak(s);
+  return InsertWeak(GetShard(s), s);
 }
 
 void InternTable::RemoveStrongFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveStrong(s);
+  RemoveStrong(GetShard(s), s);
 }
 
 void InternTable::RemoveWeakFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveWeak(s);
+  RemoveWeak(GetShard(s), s);
 }
 
 void InternTable::BroadcastForNewInterns() {
   Thread* self = Thread::Current();
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  weak_intern_condition_.Broadcast(self);
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock);
+    shard.weak_intern_condition.Broadcast(self);
+  }
 }
 
-void InternTable::WaitUntilAccessible(Thread* self) {
-  Locks::intern_table_lock_->ExclusiveUnlock(self);
+void InternTable::WaitUntilAccessible(Thread* self, Shard& shard) {
+  shard.lock.ExclusiveUnlock(self);
+  Locks::intern_table_lock_->SharedUnlock(self);
   {
     ScopedThreadSuspension sts(self, kWaitingWeakGcRootRead);
-    MutexLock mu(self, *Locks::intern_table_lock_);
-    while ((!kUseReadBarrier && weak_root_state_ == gc::kWeakRootStateNoReadsOrWrites) ||
+    MutexLock mu(self, shard.lock);
+    while ((!kUseReadBarrier && weak_root_state_.load(std::memory_order_relaxed) ==
+                                    gc::kWeakRootStateNoReadsOrWrites) ||
            (kUseReadBarrier && !self->GetWeakRefAccessEnabled())) {
-      weak_intern_condition_.Wait(self);
+      shard.weak_intern_condition.Wait(self);
     }
   }
-  Locks::intern_table_lock_->ExclusiveLock(self);
+  Locks::intern_table_lock_->SharedLock(self);
+  shard.lock.ExclusiveLock(self);
 }
 
 ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
@@ -204,25 +252,28 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     return nullptr;
   }
   Thread* const self = Thread::Current();
-  MutexLock mu(self, *Locks::intern_table_lock_);
+  ReaderMutexLock mu(self, *Locks::intern_table_lock_);
+  Shard& shard = GetShard(s);
+  MutexLock mu2(self, shard.lock);
   if (kDebugLocking && !holding_locks) {
     Locks::mutator_lock_->AssertSharedHeld(self);
-    CHECK_EQ(2u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
+    CHECK_EQ(3u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
   }
   while (true) {
     if (holding_locks) {
       if (!kUseReadBarrier) {
-        CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+        CHECK_EQ(weak_root_state_.load(std::memory_order_relaxed), gc::kWeakRootStateNormal);
       } else {
         CHECK(self->GetWeakRefAccessEnabled());
       }
     }
     // Check the strong table for a match.
-    ObjPtr<mirror::String> strong = LookupStrongLocked(s);
+    ObjPtr<mirror::String> strong = FindStrong(shard, s);
     if (strong != nullptr) {
       return strong;
     }
-    if ((!kUseReadBarrier && weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites) ||
+    if ((!kUseReadBarrier && weak_root_state_.load(std::memory_order_relaxed) !=
+                                 gc::kWeakRootStateNoReadsOrWrites) ||
         (kUseReadBarrier && self->GetWeakRefAccessEnabled())) {
       break;
     }
@@ -232,25 +283,25 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     CHECK(!holding_locks);
     StackHandleScope<1> hs(self);
     auto h = hs.NewHandleWrapper(&s);
-    WaitUntilAccessible(self);
+    WaitUntilAccessible(self, shard);
   }
   if (!kUseReadBarrier) {
-    CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+    CHECK_EQ(weak_root_state_.load(std::memory_order_relaxed), gc::kWeakRootStateNormal);
   } else {
     CHECK(self->GetWeakRefAccessEnabled());
   }
   // There is no match in the strong table, check the weak table.
-  ObjPtr<mirror::String> weak = LookupWeakLocked(s);
+  ObjPtr<mirror::String> weak = shard.weak_interns.Find(s);
   if (weak != nullptr) {
     if (is_strong) {
       // A match was found in the weak table. Promote to the strong table.
-      RemoveWeak(weak);
-      return InsertStrong(weak);
+      RemoveWeak(shard, weak);
+      return InsertStrong(shard, weak);
     }
     return weak;
   }
   // No match in the strong table or the weak table. Insert into the strong / weak table.
-  return is_strong ? InsertStrong(s) : InsertWeak(s);
+  return is_strong ? InsertStrong(shard, s) : InsertWeak(shard, s);
 }
 
 ObjPtr<mirror::String> InternTable::InternStrong(int32_t utf16_length, const char* utf8_data) {
@@ -276,13 +327,15 @@ ObjPtr<mirror::String> InternTable::InternStrongImageString(ObjPtr<mirror::Strin
 }
 
 void InternTable::PromoteWeakToStrong() {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  DCHECK_EQ(weak_interns_.tables_.size(), 1u);
-  for (GcRoot<mirror::String>& entry : weak_interns_.tables_.front().set_) {
-    DCHECK(LookupStrongLocked(entry.Read()) == nullptr);
-    InsertStrong(entry.Read());
+  WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  for (Shard& shard : shards_) {
+    DCHECK_EQ(shard.weak_interns.tables_.size(), 1u);
+    for (GcRoot<mirror::String>& entry : shard.weak_interns.tables_.front().set_) {
+      DCHECK(FindStrong(shard, entry.Read()) == nullptr);
+      InsertStrong(shard, entry.Read());
+    }
+    shard.weak_interns.tables_.front().set_.clear();
   }
-  weak_interns_.tables_.front().set_.clear();
 }
 
 ObjPtr<mirror::String> InternTable::InternStrong(ObjPtr<mirror::String> s) {
@@ -303,13 +356,31 @@ bool InternTable::ContainsWeak(ObjPtr<mirror::String> s) {
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.SweepWeaks(visitor);
+  Thread* self = Thread::Current();
+  // Sweep shard by shard so that interning in the other shards can proceed.
+  ReaderMutexLock mu(self, *Locks::intern_table_lock_);
+  for (Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock);
+    shard.weak_interns.SweepWeaks(visitor);
+  }
 }
 
 size_t InternTable::WriteToMemory(uint8_t* ptr) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.WriteToMemory(ptr);
+  WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  // Combine the image tables and the tables of all shards into a single one.
+  UnorderedSet combined;
+  auto add_tables = [&combined](Table& table) REQUIRES(Locks::intern_table_lock_) {
+    for (Table::InternalTable& internal_table : table.tables_) {
+      for (GcRoot<mirror::String>& string : internal_table.set_) {
+        combined.insert(string);
+      }
+    }
+  };
+  add_tables(image_strong_interns_);
+  for (Shard& shard : shards_) {
+    add_tables(shard.strong_interns);
+  }
+  return combined.WriteToMemory(ptr);
 }
 
 std::size_t InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& root) const {
@@ -326,7 +397,14 @@ bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
   if (kIsDebugBuild) {
     Locks::mutator_lock_->AssertSharedHeld(Thread::Current());
   }
-  return a.Read<kWithoutReadBarrier>()->Equals(b.Read<kWithoutReadBarrier>());
+  ObjPtr<mirror::String> a_string = a.Read<kWithoutReadBarrier>();
+  ObjPtr<mirror::String> b_string = b.Read<kWithoutReadBarrier>();
+  // Both hash codes are cached in the strings, so check them before comparing the contents.
+  if (a_string->GetHashCode() != b_string->GetHashCode()) {
+    DCHECK(!a_string->Equals(b_string));
+    return false;
+  }
+  return a_string->Equals(b_string);
 }
 
 bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
@@ -335,6 +413,9 @@ bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
     Locks::mutator_lock_->AssertSharedHeld(Thread::Current());
   }
   ObjPtr<mirror::String> a_string = a.Read<kWithoutReadBarrier>();
+  if (a_string->GetHashCode() != b.GetHash()) {
+    return false;
+  }
   uint32_t a_length = static_cast<uint32_t>(a_string->GetLength());
   if (a_length != b.GetUtf16Length()) {
     return false;
@@ -358,25 +439,6 @@ bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
   }
 }
 
-size_t InternTable::Table::WriteToMemory(uint8_t* ptr) {
-  if (tables_.empty()) {
-    return 0;
-  }
-  UnorderedSet* table_to_write;
-  UnorderedSet combined;
-  if (tables_.size() > 1) {
-    table_to_write = &combined;
-    for (InternalTable& table : tables_) {
-      for (GcRoot<mirror::String>& string : table.set_) {
-        combined.insert(string);
-      }
-    }
-  } else {
-    table_to_write = &tables_.back().set_;
-  }
-  return table_to_write->WriteToMemory(ptr);
-}
-
 void InternTable::Table::Remove(ObjPtr<mirror::String> s) {
   for (InternalTable& table : tables_) {
     auto it = table.set_.find(GcRoot<mirror::String>(s));
@@ -389,7 +451,7 @@ void InternTable::Table::Remove(ObjPtr<mirror::String> s) {
 }
 
 ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
+  Locks::intern_table_lock_->AssertSharedHeld(Thread::Current());
   for (InternalTable& table : tables_) {
     auto it = table.set_.find(GcRoot<mirror::String>(s));
     if (it != table.set_.end()) {
@@ -400,7 +462,7 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
 }
 
 ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
+  Locks::intern_table_lock_->AssertSharedHeld(Thread::Current());
   for (InternalTable& table : tables_) {
     auto it = table.set_.find(string);
     if (it != table.set_.end()) {
@@ -461,24 +523,23 @@ size_t InternTable::Table::Size() const {
 }
 
 void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  ChangeWeakRootStateLocked(new_state);
-}
-
-void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
   CHECK(!kUseReadBarrier);
-  weak_root_state_ = new_state;
+  weak_root_state_.store(new_state, std::memory_order_relaxed);
   if (new_state != gc::kWeakRootStateNoReadsOrWrites) {
-    weak_intern_condition_.Broadcast(Thread::Current());
+    // Waiters check the state with the lock of their shard held, so they either see the new state
+    // or are waiting when the shard is broadcast.
+    BroadcastForNewInterns();
   }
 }
 
-InternTable::Table::Table() {
-  Runtime* const runtime = Runtime::Current();
-  InternalTable initial_table;
-  initial_table.set_.SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
-                                   runtime->GetHashTableMaxLoadFactor());
-  tables_.push_back(std::move(initial_table));
+InternTable::Table::Table(bool has_initial_table) {
+  if (has_initial_table) {
+    Runtime* const runtime = Runtime::Current();
+    InternalTable initial_table;
+    initial_table.set_.SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
+                                     runtime->GetHashTableMaxLoadFactor());
+    tables_.push_back(std::move(initial_table));
+  }
 }
 
 }  // namespace art
@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <atomic>
+
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/mutex.h"
@@ -53,6 +55,12 @@ class Transaction;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * Both tables are split into shards by string hash, each with its own lock, so that threads
+ * interning different strings do not contend. Interning holds Locks::intern_table_lock_ shared
+ * and the lock of the shard of the string, operations on the whole table hold
+ * Locks::intern_table_lock_ exclusively. The strings of images are in tables shared by all shards,
+ * which are only modified with Locks::intern_table_lock_ held exclusively.
  */
 class InternTable {
  public:
@@ -184,7 +192,7 @@ class InternTable {
 
   void DumpForSigQuit(std::ostream& os) const REQUIRES(!Locks::intern_table_lock_);
 
-  void BroadcastForNewInterns();
+  void BroadcastForNewInterns() REQUIRES(!Locks::intern_table_lock_);
 
   // Add all of the strings in the image's intern table into this intern table. This is required so
   // the intern table is correct.
@@ -210,7 +218,7 @@ class InternTable {
 
  private:
   // Table which holds pre zygote and post zygote interned strings. There is one instance for
-  // weak interns and strong interns.
+  // weak interns and strong interns in each shard, and one for the strong interns of images.
   class Table {
    public:
     class InternalTable {
@@ -240,37 +248,27 @@ class InternTable {
       ART_FRIEND_TEST(InternTableTest, CrossHash);
     };
 
-    Table();
+    // The image table has no initial table, it only holds the tables read from images.
+    explicit Table(bool has_initial_table = true);
     ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::intern_table_lock_);
     ObjPtr<mirror::String> Find(const Utf8String& string) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::intern_table_lock_);
     void Insert(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::intern_table_lock_);
     void Remove(ObjPtr<mirror::String> s)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
     void VisitRoots(RootVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
     void SweepWeaks(IsMarkedVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
     // Add a new intern table that will only be inserted into from now on.
     void AddNewTable() REQUIRES(Locks::intern_table_lock_);
-    size_t Size() const REQUIRES(Locks::intern_table_lock_);
-    // Read and add an intern table from ptr.
-    // Tables read are inserted at the front of the table array. Only checks for conflicts in
-    // debug builds. Returns how many bytes were read.
-    // NO_THREAD_SAFETY_ANALYSIS for the visitor that may require locks.
-    template <typename Visitor>
-    size_t AddTableFromMemory(const uint8_t* ptr, const Visitor& visitor, bool is_boot_image)
-        REQUIRES(!Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
-    // Write the intern tables to ptr, if there are multiple tables they are combined into a single
-    // one. Returns how many bytes were written.
-    size_t WriteToMemory(uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+    size_t Size() const REQUIRES_SHARED(Locks::intern_table_lock_);
 
    private:
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
 
     // Add a table to the front of the tables vector.
     void AddInternStrings(UnorderedSet&& intern_strings, bool is_boot_image)
@@ -285,6 +283,39 @@ class InternTable {
     ART_FRIEND_TEST(InternTableTest, CrossHash);
   };
 
+  static constexpr size_t kShardBits = 3u;
+  static constexpr size_t kNumShards = 1u << kShardBits;
+
+  // The tables of the strings hashed to a shard. They are accessed with Locks::intern_table_lock_
+  // held shared and `lock` held, or with Locks::intern_table_lock_ held exclusively.
+  struct Shard {
+    Shard();
+
+    Mutex lock ACQUIRED_AFTER(Locks::intern_table_lock_);
+    ConditionVariable weak_intern_condition;
+    // Since this contains (strong) roots, they need a read barrier to
+    // enable concurrent intern table (strong) root scan. Do not
+    // directly access the strings in it. Use functions that contain
+    // read barriers.
+    Table strong_interns;
+    std::vector<GcRoot<mirror::String>> new_strong_intern_roots;
+    // Since this contains (weak) roots, they need a read barrier. Do
+    // not directly access the strings in it. Use functions that contain
+    // read barriers.
+    Table weak_interns;
+  };
+
+  Shard& GetShard(int32_t hash) {
+    // Mix the hash, similar strings have hashes differing in the low bits.
+    return shards_[(static_cast<uint32_t>(hash) * 0x9e3779b1u) >> (32u - kShardBits)];
+  }
+
+  Shard& GetShard(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Look up a strong intern in the image tables and the tables of `shard`.
+  ObjPtr<mirror::String> FindStrong(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
+
   // Insert if non null, otherwise return null. Must be called holding the mutator lock.
   // If holding_locks is true, then we may also hold other locks. If holding_locks is true, then we
   // require GC is not running since it is not safe to wait while holding locks.
@@ -296,14 +327,14 @@ class InternTable {
   size_t AddTableFromMemory(const uint8_t* ptr, const Visitor& visitor, bool is_boot_image)
       REQUIRES(!Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
-  ObjPtr<mirror::String> InsertStrong(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  ObjPtr<mirror::String> InsertWeak(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveStrong(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveWeak(ObjPtr<mirror::String> s)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+  ObjPtr<mirror::String> InsertStrong(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
+  ObjPtr<mirror::String> InsertWeak(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
+  void RemoveStrong(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
+  void RemoveWeak(Shard& shard, ObjPtr<mirror::String> s)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES_SHARED(Locks::intern_table_lock_);
 
   // Transaction rollback access.
   ObjPtr<mirror::String> InsertStrongFromTransaction(ObjPtr<mirror::String> s)
@@ -315,34 +346,24 @@ class InternTable {
   void RemoveWeakFromTransaction(ObjPtr<mirror::String> s)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
 
-  // Change the weak root state. May broadcast to waiters.
-  void ChangeWeakRootStateLocked(gc::WeakRootState new_state)
-      REQUIRES(Locks::intern_table_lock_);
-
-  // Wait until we can read weak roots.
-  void WaitUntilAccessible(Thread* self)
-      REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+  // Wait until we can read weak roots. Called with Locks::intern_table_lock_ held shared and the
+  // lock of `shard` held, both are released while waiting.
+  void WaitUntilAccessible(Thread* self, Shard& shard)
+      REQUIRES_SHARED(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
   bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
-  ConditionVariable weak_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (strong) roots, they need a read barrier to
-  // enable concurrent intern table (strong) root scan. Do not
-  // directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  std::vector<GcRoot<mirror::String>> new_strong_intern_roots_
-      GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (weak) roots, they need a read barrier. Do
-  // not directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  // Weak root state, used for concurrent system weak processing and more.
-  gc::WeakRootState weak_root_state_ GUARDED_BY(Locks::intern_table_lock_);
+  // The strong interns of images, searched before the tables of the shards.
+  Table image_strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
+  Shard shards_[kNumShards];
+  // Weak root state, used for concurrent system weak processing and more. Stored before
+  // broadcasting to the shards, so it can be read without the locks.
+  std::atomic<gc::WeakRootState> weak_root_state_;
 
   friend class gc::space::ImageSpace;
   friend class linker::ImageWriter;
   friend class Transaction;
   ART_FRIEND_TEST(InternTableTest, CrossHash);
+  ART_FRIEND_TEST(InternTableTest, Shards);
   DISALLOW_COPY_AND_ASSIGN(InternTable);
 };
 
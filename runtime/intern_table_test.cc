@@ -16,6 +16,8 @@
 
 #include "intern_table.h"
 
+#include <string>
+
 #include "base/hash_set.h"
 #include "common_runtime_test.h"
 #include "dex/utf.h"
@@ -65,6 +67,29 @@ TEST_F(InternTableTest, Size) {
   EXPECT_EQ(2U, t.Size());
 }
 
+TEST_F(InternTableTest, Shards) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable t;
+  static constexpr size_t kNumStrings = 100u;
+  for (size_t i = 0; i != kNumStrings; ++i) {
+    std::string str = "string" + std::to_string(i);
+    t.InternStrong(str.c_str());
+  }
+  EXPECT_EQ(kNumStrings, t.StrongSize());
+  for (size_t i = 0; i != kNumStrings; ++i) {
+    std::string str = "string" + std::to_string(i);
+    ObjPtr<mirror::String> s =
+        t.LookupStrong(soa.Self(), static_cast<uint32_t>(str.length()), str.c_str());
+    ASSERT_TRUE(s != nullptr) << str;
+    EXPECT_TRUE(s->Equals(str.c_str()));
+  }
+  // Similar strings are spread over the shards.
+  WriterMutexLock mu(soa.Self(), *Locks::intern_table_lock_);
+  for (const InternTable::Shard& shard : t.shards_) {
+    EXPECT_NE(0u, shard.strong_interns.Size());
+  }
+}
+
 // Check if table indexes match on 64 and 32 bit machines.
 // This is done by ensuring hash values are the same on every machine and limited to 32-bit wide.
 // Otherwise cross compilation can cause a table to be filled on host using one indexing algorithm
@@ -77,8 +102,8 @@ TEST_F(InternTableTest, CrossHash) {
   // A string that has a negative hash value.
   GcRoot<mirror::String> str(mirror::String::AllocFromModifiedUtf8(soa.Self(), "00000000"));
 
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  for (InternTable::Table::InternalTable& table : t.strong_interns_.tables_) {
+  WriterMutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  for (InternTable::Table::InternalTable& table : t.shards_[0].strong_interns.tables_) {
     // The negative hash value shall be 32-bit wide on every host.
     ASSERT_TRUE(IsUint<32>(table.set_.hashfn_(str)));
   }
@@ -25,6 +25,16 @@ void InterpreterCache::Clear(Thread* owning_thread) {
   data_.fill(Entry{});
 }
 
+void InterpreterCache::ClearRange(Thread* owning_thread, const void* begin, const void* end) {
+  DCHECK(owning_thread->GetInterpreterCache() == this);
+  DCHECK(owning_thread == Thread::Current() || owning_thread->IsSuspended());
+  for (Entry& entry : data_) {
+    if (entry.first >= begin && entry.first < end) {
+      entry = Entry{};
+    }
+  }
+}
+
 bool InterpreterCache::IsCalledFromOwningThread() {
   return Thread::Current()->GetInterpreterCache() == this;
 }
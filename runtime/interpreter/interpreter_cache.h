@@ -39,8 +39,12 @@ class Thread;
 //   sget/sput: The ArtField* pointer. The field must be non-volitile.
 //   invoke: The ArtMethod* pointer (before vtable indirection, etc).
 //
-// We ensure consistency of the cache by clearing it
-// whenever any dex file is unloaded.
+// We ensure consistency of the cache by clearing the entries
+// keyed in any dex file which is unloaded.
+//
+// The cache is set-associative. The most recently set entry of a set is its first
+// way, where the assembly fast paths of mterp look. The other ways are looked at
+// by the C++ lookups and by the fast paths of nterp.
 //
 // Aligned to 16-bytes to make it easier to get the address of the cache
 // from assembly (it ensures that the offset is valid immediate value).
@@ -53,6 +57,16 @@ class ALIGNED(16) InterpreterCache {
   // Value of 256 has around 75% cache hit rate.
   static constexpr size_t kSize = 256;
 
+  // Two ways avoid most of the misses of large methods whose instructions alias.
+  // The assembly fast paths depend on the size of a set, through the
+  // THREAD_INTERPRETER_CACHE_* asm defines.
+  static constexpr size_t kNumWays = 2;
+  static constexpr size_t kNumSets = kSize / kNumWays;
+
+  // Whether to count the hits of the C++ lookups and the misses. The hits of
+  // the assembly fast paths are not counted.
+  static constexpr bool kCollectStats = false;
+
   InterpreterCache() {
     // We can not use the Clear() method since the constructor will not
     // be called from the owning thread.
@@ -62,36 +76,73 @@ class ALIGNED(16) InterpreterCache {
   // Clear the whole cache. It requires the owning thread for DCHECKs.
   void Clear(Thread* owning_thread);
 
+  // Clear the entries keyed by a pointer in [begin, end). It requires the owning
+  // thread for DCHECKs.
+  void ClearRange(Thread* owning_thread, const void* begin, const void* end);
+
   ALWAYS_INLINE bool Get(const void* key, /* out */ size_t* value) {
     DCHECK(IsCalledFromOwningThread());
-    Entry& entry = data_[IndexOf(key)];
-    if (LIKELY(entry.first == key)) {
-      *value = entry.second;
-      return true;
+    Entry* set = &data_[IndexOf(key)];
+    for (size_t way = 0; way != kNumWays; ++way) {
+      if (LIKELY(set[way].first == key)) {
+        *value = set[way].second;
+        if (kCollectStats) {
+          ++hits_;
+        }
+        return true;
+      }
     }
     return false;
   }
 
   ALWAYS_INLINE void Set(const void* key, size_t value) {
     DCHECK(IsCalledFromOwningThread());
-    data_[IndexOf(key)] = Entry{key, value};
+    if (kCollectStats) {
+      ++misses_;
+    }
+    Entry* set = &data_[IndexOf(key)];
+    if (set[0].first != key) {
+      // Evict the least recently set entry, or the stale entry for the same key.
+      size_t way = 1;
+      while (way != kNumWays - 1 && set[way].first != key) {
+        ++way;
+      }
+      for (; way != 0; --way) {
+        set[way] = set[way - 1];
+      }
+    }
+    set[0] = Entry{key, value};
   }
 
   std::array<Entry, kSize>& GetArray() {
     return data_;
   }
 
+  size_t GetHits() const {
+    return hits_;
+  }
+
+  size_t GetMisses() const {
+    return misses_;
+  }
+
  private:
   bool IsCalledFromOwningThread();
 
+  // Returns the index of the first way of the set of `key`.
   static ALWAYS_INLINE size_t IndexOf(const void* key) {
-    static_assert(IsPowerOfTwo(kSize), "Size must be power of two");
-    size_t index = (reinterpret_cast<uintptr_t>(key) >> 2) & (kSize - 1);
+    static_assert(IsPowerOfTwo(kNumSets), "Number of sets must be power of two");
+    static_assert(kNumSets * kNumWays == kSize, "Size must be a multiple of the number of ways");
+    size_t index = ((reinterpret_cast<uintptr_t>(key) >> 2) & (kNumSets - 1)) * kNumWays;
     DCHECK_LT(index, kSize);
     return index;
   }
 
   std::array<Entry, kSize> data_;
+
+  // Only updated if kCollectStats.
+  size_t hits_ = 0u;
+  size_t misses_ = 0u;
 };
 
 }  // namespace art
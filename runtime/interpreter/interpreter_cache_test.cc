@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "interpreter_cache.h"
+
+#include "common_runtime_test.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+class InterpreterCacheTest : public CommonRuntimeTest {
+ protected:
+  // Returns a key of the set of `key`, in the `n`-th lap around the cache.
+  static const void* Alias(const void* key, size_t n) {
+    return reinterpret_cast<const uint8_t*>(key) + n * InterpreterCache::kNumSets * 4u;
+  }
+};
+
+TEST_F(InterpreterCacheTest, KeepsAliasingEntries) {
+  Thread* self = Thread::Current();
+  InterpreterCache* cache = self->GetInterpreterCache();
+  cache->Clear(self);
+  const uint8_t data[4] = {};
+  const void* key = &data[0];
+
+  // The cache holds as many entries of the same set as it has ways.
+  for (size_t i = 0; i != InterpreterCache::kNumWays; ++i) {
+    cache->Set(Alias(key, i), i);
+  }
+  for (size_t i = 0; i != InterpreterCache::kNumWays; ++i) {
+    size_t value;
+    ASSERT_TRUE(cache->Get(Alias(key, i), &value));
+    EXPECT_EQ(i, value);
+  }
+
+  // One more evicts the least recently set.
+  cache->Set(Alias(key, InterpreterCache::kNumWays), InterpreterCache::kNumWays);
+  size_t value;
+  EXPECT_FALSE(cache->Get(Alias(key, 0u), &value));
+  ASSERT_TRUE(cache->Get(Alias(key, InterpreterCache::kNumWays), &value));
+  EXPECT_EQ(InterpreterCache::kNumWays, value);
+
+  // Setting a present key again updates it without evicting the others.
+  cache->Set(Alias(key, 1u), 42u);
+  ASSERT_TRUE(cache->Get(Alias(key, 1u), &value));
+  EXPECT_EQ(42u, value);
+  ASSERT_TRUE(cache->Get(Alias(key, InterpreterCache::kNumWays), &value));
+  EXPECT_EQ(InterpreterCache::kNumWays, value);
+  cache->Clear(self);
+}
+
+TEST_F(InterpreterCacheTest, ClearRange) {
+  Thread* self = Thread::Current();
+  InterpreterCache* cache = self->GetInterpreterCache();
+  cache->Clear(self);
+  const uint16_t code[8] = {};
+
+  for (size_t i = 0; i != arraysize(code); ++i) {
+    cache->Set(&code[i], i);
+  }
+  cache->ClearRange(self, &code[2], &code[6]);
+  for (size_t i = 0; i != arraysize(code); ++i) {
+    size_t value;
+    EXPECT_EQ(i < 2u || i >= 6u, cache->Get(&code[i], &value)) << i;
+  }
+  cache->Clear(self);
+}
+
+}  // namespace art
@@ -262,6 +262,9 @@ SIMPLE_STRING_INTRINSIC(StringIsEmpty, SetZ(str->GetLength() == 0))
 // java.lang.String.length()I
 SIMPLE_STRING_INTRINSIC(StringLength, SetI(str->GetLength()))
 
+// java.lang.String.hashCode()I
+SIMPLE_STRING_INTRINSIC(StringHashCode, SetI(str->GetHashCode()))
+
 // java.lang.String.getCharsNoCheck(II[CI)V
 static ALWAYS_INLINE bool MterpStringGetCharsNoCheck(ShadowFrame* shadow_frame,
                                                      const Instruction* inst,
@@ -498,7 +501,9 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
     UNIMPLEMENTED_CASE(MathRint /* (D)D */)
     UNIMPLEMENTED_CASE(MathRoundDouble /* (D)J */)
     UNIMPLEMENTED_CASE(MathRoundFloat /* (F)I */)
+    UNIMPLEMENTED_CASE(SystemArrayCopyByte /* ([BI[BII)V */)
     UNIMPLEMENTED_CASE(SystemArrayCopyChar /* ([CI[CII)V */)
+    UNIMPLEMENTED_CASE(SystemArrayCopyInt /* ([II[III)V */)
     UNIMPLEMENTED_CASE(SystemArrayCopy /* (Ljava/lang/Object;ILjava/lang/Object;II)V */)
     UNIMPLEMENTED_CASE(ThreadCurrentThread /* ()Ljava/lang/Thread; */)
     UNIMPLEMENTED_CASE(MemoryPeekByte /* (J)B */)
@@ -514,6 +519,7 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
     INTRINSIC_CASE(StringCompareTo)
     INTRINSIC_CASE(StringEquals)
     INTRINSIC_CASE(StringGetCharsNoCheck)
+    INTRINSIC_CASE(StringHashCode)
     INTRINSIC_CASE(StringIndexOf)
     INTRINSIC_CASE(StringIndexOfAfter)
     UNIMPLEMENTED_CASE(StringStringIndexOf /* (Ljava/lang/String;)I */)
@@ -1950,43 +1950,65 @@ void ExecuteSwitchImplCpp(SwitchImplContext* ctx) {
       << "Entered interpreter from invoke without retry instruction being handled!";
 
   bool const interpret_one_instruction = ctx->interpret_one_instruction;
+
+  // The handlers are threaded: each of them dispatches to the next instruction itself, rather
+  // than looping back to a shared switch. Each handler then has its own indirect branch, which
+  // the branch predictor can tell apart. The preamble still runs before every instruction, so
+  // the instrumentation sees the same events.
+  static const void* const kHandlers[kNumPackedOpcodes] = {
+#define OPCODE_LABEL(OPCODE, OPCODE_NAME, NAME, FORMAT, i, a, e, v) &&OPCODE_NAME##_HANDLER,
+  DEX_INSTRUCTION_LIST(OPCODE_LABEL)
+#undef OPCODE_LABEL
+  };
+
+  const Instruction* inst;
+  uint16_t inst_data;
+  bool exit;
+#define DISPATCH_NEXT_INSTRUCTION()                                                               \
+  inst = next;                                                                                    \
+  dex_pc = inst->GetDexPc(insns);                                                                 \
+  shadow_frame.SetDexPC(dex_pc);                                                                  \
+  TraceExecution(shadow_frame, inst, dex_pc);                                                     \
+  inst_data = inst->Fetch16(0);                                                                   \
+  exit = false;                                                                                   \
+  if (UNLIKELY(!InstructionHandler<do_access_check,                                               \
+                                   transaction_active,                                            \
+                                   Instruction::kInvalidFormat>(                                  \
+          ctx, instrumentation, self, shadow_frame, dex_pc, inst, inst_data, next, exit).         \
+          Preamble())) {                                                                          \
+    goto PREAMBLE_FAILED;                                                                         \
+  }                                                                                               \
+  goto *kHandlers[inst->Opcode(inst_data)]
+
   while (true) {
-    const Instruction* const inst = next;
-    dex_pc = inst->GetDexPc(insns);
-    shadow_frame.SetDexPC(dex_pc);
-    TraceExecution(shadow_frame, inst, dex_pc);
-    uint16_t inst_data = inst->Fetch16(0);
-    bool exit = false;
-    if (InstructionHandler<do_access_check, transaction_active, Instruction::kInvalidFormat>(
-            ctx, instrumentation, self, shadow_frame, dex_pc, inst, inst_data, next, exit).
-            Preamble()) {
-      switch (inst->Opcode(inst_data)) {
+    DISPATCH_NEXT_INSTRUCTION();
 #define OPCODE_CASE(OPCODE, OPCODE_NAME, NAME, FORMAT, i, a, e, v)                                \
-        case OPCODE: {                                                                            \
-          DCHECK_EQ(self->IsExceptionPending(), (OPCODE == Instruction::MOVE_EXCEPTION));         \
-          next = inst->RelativeAt(Instruction::SizeInCodeUnits(Instruction::FORMAT));             \
-          bool success = OP_##OPCODE_NAME<do_access_check, transaction_active>(                   \
-              ctx, instrumentation, self, shadow_frame, dex_pc, inst, inst_data, next, exit);     \
-          if (success && LIKELY(!interpret_one_instruction)) {                                    \
-            DCHECK(!exit) << NAME;                                                                \
-            continue;                                                                             \
-          }                                                                                       \
-          if (exit) {                                                                             \
-            shadow_frame.SetDexPC(dex::kDexNoIndex);                                              \
-            return;                                                                               \
-          }                                                                                       \
-          break;                                                                                  \
-        }
+    OPCODE_NAME##_HANDLER: {                                                                      \
+      DCHECK_EQ(self->IsExceptionPending(), (OPCODE == Instruction::MOVE_EXCEPTION));             \
+      next = inst->RelativeAt(Instruction::SizeInCodeUnits(Instruction::FORMAT));                 \
+      bool success = OP_##OPCODE_NAME<do_access_check, transaction_active>(                       \
+          ctx, instrumentation, self, shadow_frame, dex_pc, inst, inst_data, next, exit);         \
+      if (success && LIKELY(!interpret_one_instruction)) {                                        \
+        DCHECK(!exit) << NAME;                                                                    \
+        DISPATCH_NEXT_INSTRUCTION();                                                              \
+      }                                                                                           \
+      if (exit) {                                                                                 \
+        shadow_frame.SetDexPC(dex::kDexNoIndex);                                                  \
+        return;                                                                                   \
+      }                                                                                           \
+      goto HANDLED;                                                                               \
+    }
   DEX_INSTRUCTION_LIST(OPCODE_CASE)
 #undef OPCODE_CASE
-      }
-    } else {
-      // Preamble returned false due to debugger event.
-      if (exit) {
-        shadow_frame.SetDexPC(dex::kDexNoIndex);
-        return;  // Return statement or debugger forced exit.
-      }
+#undef DISPATCH_NEXT_INSTRUCTION
+
+  PREAMBLE_FAILED:
+    // Preamble returned false due to debugger event.
+    if (exit) {
+      shadow_frame.SetDexPC(dex::kDexNoIndex);
+      return;  // Return statement or debugger forced exit.
     }
+  HANDLED:
     if (self->IsExceptionPending()) {
       if (!InstructionHandler<do_access_check, transaction_active, Instruction::kInvalidFormat>(
               ctx, instrumentation, self, shadow_frame, dex_pc, inst, inst_data, next, exit).
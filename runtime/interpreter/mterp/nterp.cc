@@ -71,6 +71,8 @@ void CheckNterpAsmConstants() {
   }
 }
 
+static_assert(InterpreterCache::kNumWays == 2, "FETCH_FROM_THREAD_CACHE looks at two ways");
+
 template<typename T>
 inline void UpdateCache(Thread* self, uint16_t* dex_pc_ptr, T value) {
   DCHECK(kUseReadBarrier) << "Nterp only works with read barriers";
@@ -585,7 +587,8 @@ extern "C" jit::OsrData* NterpHotMethod(ArtMethod* method, uint16_t* dex_pc_ptr,
         return osr_data;
       }
     }
-    jit->EnqueueCompilationFromNterp(method, Thread::Current());
+    jit->EnqueueCompilationFromNterp(
+        method, Thread::Current(), /* from_back_edge= */ dex_pc_ptr != nullptr);
   }
   return nullptr;
 }
@@ -466,6 +466,10 @@ static constexpr uint32_t kJitRepackGroupSize = 64 * KB;
 static constexpr uint32_t kJitRepackFrequency = 64;
 static uint32_t g_jit_num_unpacked_entries = 0;
 
+// Also compress the packed entries of an app every 'n' automatic repacks.
+static constexpr uint32_t kJitCompressFrequency = 8;
+static uint32_t g_jit_num_uncompressed_repacks = 0;
+
 // Split the JIT code cache into groups of fixed size and create single JITCodeEntry for each group.
 // The start address of method's code determines which group it belongs to.  The end is irrelevant.
 // New mini debug infos will be merged if possible, and entries for GCed functions will be removed.
@@ -547,6 +551,9 @@ static void RepackEntries(bool compress_entries, ArrayRef<const void*> removed)
     group_it = end;  // Go to next group.
   }
   g_jit_num_unpacked_entries = 0;
+  if (compress_entries) {
+    g_jit_num_uncompressed_repacks = 0;
+  }
 }
 
 void AddNativeDebugInfoForJit(const void* code_ptr,
@@ -567,11 +574,14 @@ void AddNativeDebugInfoForJit(const void* code_ptr,
 
   // Automatically repack entries on regular basis to save space.
   // Pack (but don't compress) recent entries - this is cheap and reduces memory use by ~4x.
-  // We delay compression until after GC since it is more expensive (and saves further ~4x).
+  // We mostly delay compression until after GC since it is more expensive (and saves further
+  // ~4x), but an app that rarely GCs its code cache compresses in batches as well. Groups that
+  // are already compressed and unchanged are skipped, so each batch only pays for new code.
   // Always compress zygote, since it does not GC and we want to keep the high-water mark low.
   if (++g_jit_num_unpacked_entries >= kJitRepackFrequency) {
     bool is_zygote = Runtime::Current()->IsZygote();
-    RepackEntries(/*compress_entries=*/ is_zygote, /*removed=*/ ArrayRef<const void*>());
+    bool compress = is_zygote || ++g_jit_num_uncompressed_repacks >= kJitCompressFrequency;
+    RepackEntries(/*compress_entries=*/ compress, /*removed=*/ ArrayRef<const void*>());
   }
 }
 
@@ -24,6 +24,7 @@
 #include "base/logging.h"  // For VLOG.
 #include "base/memfd.h"
 #include "base/memory_tool.h"
+#include "base/os.h"
 #include "base/runtime_debug.h"
 #include "base/scoped_flock.h"
 #include "base/utils.h"
@@ -91,6 +92,10 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
   jit_options->use_jit_compilation_ = options.GetOrDefault(RuntimeArgumentMap::UseJitCompilation);
   jit_options->use_tiered_jit_compilation_ =
       options.GetOrDefault(RuntimeArgumentMap::UseTieredJitCompilation);
+  jit_options->use_baseline_plus_compiler_ =
+      options.GetOrDefault(RuntimeArgumentMap::UseBaselinePlusJitCompilation);
+  jit_options->baseline_plus_queue_threshold_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITBaselinePlusQueueThreshold);
 
   jit_options->code_cache_initial_capacity_ =
       options.GetOrDefault(RuntimeArgumentMap::JITCodeCacheInitialCapacity);
@@ -102,6 +107,11 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
       options.GetOrDefault(RuntimeArgumentMap::ProfileSaverOpts);
   jit_options->thread_pool_pthread_priority_ =
       options.GetOrDefault(RuntimeArgumentMap::JITPoolThreadPthreadPriority);
+  jit_options->thread_pool_count_ =
+      std::max(options.GetOrDefault(RuntimeArgumentMap::JITPoolThreadCount), 1u);
+  jit_options->warm_start_file_ = options.GetOrDefault(RuntimeArgumentMap::JITWarmStartFile);
+  jit_options->use_segmented_code_cache_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITSegmentedCodeCache);
 
   // Set default compile threshold to aide with sanity checking defaults.
   jit_options->compile_threshold_ =
@@ -197,6 +207,21 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
 
 void Jit::DumpInfo(std::ostream& os) {
   code_cache_->Dump(os);
+  for (size_t i = 0; i != kNumberOfCompilationKinds; ++i) {
+    os << "Compiled " << static_cast<CompilationKind>(i) << " methods="
+       << compiled_methods_[i].load(std::memory_order_relaxed)
+       << " failed=" << failed_compilations_[i].load(std::memory_order_relaxed) << "\n";
+  }
+  if (options_->UseBaselinePlusCompiler()) {
+    os << "Deferred promotions to optimized="
+       << deferred_promotions_.load(std::memory_order_relaxed) << "\n";
+  }
+  os << "Generic JNI calls=" << generic_jni_calls_.load(std::memory_order_relaxed) << "\n";
+  os << "Methods over the compiler memory budget="
+     << memory_budget_rejections_.load(std::memory_order_relaxed) << "\n";
+  if (thread_pool_ != nullptr) {
+    thread_pool_->DumpStatistics(os);
+  }
   cumulative_timings_.Dump(os);
   MutexLock mu(Thread::Current(), lock_);
   memory_use_.PrintMemoryUse(os);
@@ -215,6 +240,7 @@ Jit::Jit(JitCodeCache* code_cache, JitOptions* options)
     : code_cache_(code_cache),
       options_(options),
       boot_completed_lock_("Jit::boot_completed_lock_"),
+      warm_start_lock_("Jit::warm_start_lock_"),
       cumulative_timings_("JIT timings"),
       memory_use_("Memory used for compilation", 16),
       lock_("JIT memory use lock"),
@@ -289,7 +315,10 @@ bool Jit::LoadCompilerLibrary(std::string* error_msg) {
   return true;
 }
 
-bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool baseline, bool osr, bool prejit) {
+bool Jit::CompileMethod(ArtMethod* method,
+                        Thread* self,
+                        CompilationKind compilation_kind,
+                        bool prejit) {
   DCHECK(Runtime::Current()->UseJitCompilation());
   DCHECK(!method->IsRuntimeMethod());
 
@@ -318,6 +347,7 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool baseline, bool osr
     return false;
   }
 
+  const bool osr = (compilation_kind == CompilationKind::kOsr);
   JitMemoryRegion* region = GetCodeCache()->GetCurrentRegion();
   if (osr && GetCodeCache()->IsSharedRegion(*region)) {
     VLOG(jit) << "JIT not osr compiling "
@@ -329,20 +359,30 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool baseline, bool osr
   // If we get a request to compile a proxy method, we pass the actual Java method
   // of that proxy method, as the compiler does not expect a proxy method.
   ArtMethod* method_to_compile = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
-  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr, prejit, baseline, region)) {
+  if (!code_cache_->NotifyCompilationOf(
+          method_to_compile, self, compilation_kind, prejit, region)) {
     return false;
   }
 
   VLOG(jit) << "Compiling method "
             << ArtMethod::PrettyMethod(method_to_compile)
-            << " osr=" << std::boolalpha << osr
-            << " baseline=" << std::boolalpha << baseline;
-  bool success = jit_compiler_->CompileMethod(self, region, method_to_compile, baseline, osr);
+            << " kind=" << compilation_kind;
+  bool success = jit_compiler_->CompileMethod(self, region, method_to_compile, compilation_kind);
   code_cache_->DoneCompiling(method_to_compile, self, osr);
-  if (!success) {
+  if (success) {
+    compiled_methods_[static_cast<size_t>(compilation_kind)].fetch_add(
+        1u, std::memory_order_relaxed);
+    if (!options_->GetWarmStartFile().empty() &&
+        (compilation_kind == CompilationKind::kOptimized ||
+         compilation_kind == CompilationKind::kOsr)) {
+      MaybeSaveWarmStartInfo(self);
+    }
+  } else {
+    failed_compilations_[static_cast<size_t>(compilation_kind)].fetch_add(
+        1u, std::memory_order_relaxed);
     VLOG(jit) << "Failed to compile method "
               << ArtMethod::PrettyMethod(method_to_compile)
-              << " osr=" << std::boolalpha << osr;
+              << " kind=" << compilation_kind;
   }
   if (kIsDebugBuild) {
     if (self->IsExceptionPending()) {
@@ -365,7 +405,7 @@ void Jit::WaitForWorkersToBeCreated() {
 void Jit::DeleteThreadPool() {
   Thread* self = Thread::Current();
   if (thread_pool_ != nullptr) {
-    std::unique_ptr<ThreadPool> pool;
+    std::unique_ptr<JitThreadPool> pool;
     {
       ScopedSuspendAll ssa(__FUNCTION__);
       // Clear thread_pool_ field while the threads are suspended.
@@ -464,12 +504,6 @@ OsrData* Jit::PrepareForOsr(ArtMethod* method, uint32_t dex_pc, uint32_t* vregs)
     return nullptr;
   }
 
-  // Cheap check if the method has been compiled already. That's an indicator that we should
-  // osr into it.
-  if (!GetCodeCache()->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
-    return nullptr;
-  }
-
   // Fetch some data before looking up for an OSR method. We don't want thread
   // suspension once we hold an OSR method, as the JIT code cache could delete the OSR
   // method while we are being suspended.
@@ -582,6 +616,12 @@ bool Jit::MaybeDoOnStackReplacement(Thread* thread,
     return false;
   }
 
+  // Cheap check if the method has been compiled already. That's an indicator that we should
+  // osr into it. This runs on every taken back edge, so avoid looking up the OSR code otherwise.
+  if (!jit->GetCodeCache()->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+    return false;
+  }
+
   ShadowFrame* shadow_frame = thread->GetManagedStack()->GetTopShadowFrame();
   OsrData* osr_data = jit->PrepareForOsr(method,
                                          dex_pc + dex_pc_offset,
@@ -624,6 +664,16 @@ void Jit::AddMemoryUsage(ArtMethod* method, size_t bytes) {
   memory_use_.AddValue(bytes);
 }
 
+void Jit::NotifyMemoryBudgetExceeded(ArtMethod* method, size_t bytes) {
+  LOG(WARNING) << "JIT compilation of " << ArtMethod::PrettyMethod(method)
+               << " abandoned after allocating " << PrettySize(bytes);
+  memory_budget_rejections_.fetch_add(1u, std::memory_order_relaxed);
+  // kAccCompileDontBother overlaps with kAccIntrinsicBits.
+  if (!method->IsIntrinsic()) {
+    method->SetDontCompile();
+  }
+}
+
 void Jit::NotifyZygoteCompilationDone() {
   if (fd_methods_ == -1) {
     return;
@@ -759,6 +809,7 @@ class JitCompileTask final : public Task {
     kAllocateProfile,
     kCompile,
     kCompileBaseline,
+    kCompileBaselinePlus,
     kCompileOsr,
     kPreCompile,
   };
@@ -790,12 +841,12 @@ class JitCompileTask final : public Task {
         case TaskKind::kPreCompile:
         case TaskKind::kCompile:
         case TaskKind::kCompileBaseline:
+        case TaskKind::kCompileBaselinePlus:
         case TaskKind::kCompileOsr: {
           Runtime::Current()->GetJit()->CompileMethod(
               method_,
               self,
-              /* baseline= */ (kind_ == TaskKind::kCompileBaseline),
-              /* osr= */ (kind_ == TaskKind::kCompileOsr),
+              GetCompilationKind(),
               /* prejit= */ (kind_ == TaskKind::kPreCompile));
           break;
         }
@@ -815,6 +866,21 @@ class JitCompileTask final : public Task {
   }
 
  private:
+  CompilationKind GetCompilationKind() const {
+    switch (kind_) {
+      case TaskKind::kCompileBaseline:
+        return CompilationKind::kBaseline;
+      case TaskKind::kCompileBaselinePlus:
+        return CompilationKind::kBaselinePlus;
+      case TaskKind::kCompileOsr:
+        return CompilationKind::kOsr;
+      case TaskKind::kCompile:
+      case TaskKind::kPreCompile:
+      case TaskKind::kAllocateProfile:
+        return CompilationKind::kOptimized;
+    }
+  }
+
   ArtMethod* const method_;
   const TaskKind kind_;
   jobject klass_;
@@ -822,6 +888,30 @@ class JitCompileTask final : public Task {
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCompileTask);
 };
 
+void Jit::AddCompileTask(Thread* self, ArtMethod* method, CompilationKind compilation_kind) {
+  uint32_t samples = method->GetCounter();
+  if (thread_pool_->IsCompilationPending(self, method, compilation_kind, samples)) {
+    return;
+  }
+  JitCompileTask::TaskKind kind = JitCompileTask::TaskKind::kCompile;
+  switch (compilation_kind) {
+    case CompilationKind::kBaseline:
+      kind = JitCompileTask::TaskKind::kCompileBaseline;
+      break;
+    case CompilationKind::kBaselinePlus:
+      kind = JitCompileTask::TaskKind::kCompileBaselinePlus;
+      break;
+    case CompilationKind::kOptimized:
+      kind = JitCompileTask::TaskKind::kCompile;
+      break;
+    case CompilationKind::kOsr:
+      kind = JitCompileTask::TaskKind::kCompileOsr;
+      break;
+  }
+  thread_pool_->AddCompileTask(
+      self, new JitCompileTask(method, kind), method, compilation_kind, samples);
+}
+
 static std::string GetProfileFile(const std::string& dex_location) {
   // Hardcoded assumption where the profile file is.
   // TODO(ngeoffray): this is brittle and we would need to change change if we
@@ -1032,6 +1122,50 @@ class JitProfileTask final : public Task {
   DISALLOW_COPY_AND_ASSIGN(JitProfileTask);
 };
 
+class JitWarmStartTask final : public Task {
+ public:
+  JitWarmStartTask(const std::vector<std::unique_ptr<const DexFile>>& dex_files,
+                   jobject class_loader) {
+    ScopedObjectAccess soa(Thread::Current());
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::ClassLoader> h_loader(hs.NewHandle(
+        soa.Decode<mirror::ClassLoader>(class_loader)));
+    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+    for (const auto& dex_file : dex_files) {
+      dex_files_.push_back(dex_file.get());
+      // Register the dex file so that we can guarantee it doesn't get deleted
+      // while reading it during the task.
+      class_linker->RegisterDexFile(*dex_file.get(), h_loader.Get());
+    }
+    class_loader_ = soa.Vm()->AddGlobalRef(soa.Self(), h_loader.Get());
+  }
+
+  void Run(Thread* self) override {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::ClassLoader> loader = hs.NewHandle<mirror::ClassLoader>(
+        soa.Decode<mirror::ClassLoader>(class_loader_));
+    uint32_t added_to_queue =
+        Runtime::Current()->GetJit()->CompileMethodsFromWarmStartInfo(self, dex_files_, loader);
+    VLOG(jit) << "Added " << added_to_queue << " methods from the warm start file";
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+  ~JitWarmStartTask() {
+    ScopedObjectAccess soa(Thread::Current());
+    soa.Vm()->DeleteGlobalRef(soa.Self(), class_loader_);
+  }
+
+ private:
+  std::vector<const DexFile*> dex_files_;
+  jobject class_loader_;
+
+  DISALLOW_COPY_AND_ASSIGN(JitWarmStartTask);
+};
+
 static void CopyIfDifferent(void* s1, const void* s2, size_t n) {
   if (memcmp(s1, s2, n) != 0) {
     memcpy(s1, s2, n);
@@ -1199,12 +1333,16 @@ void Jit::CreateThreadPool() {
 
   // We need peers as we may report the JIT thread, e.g., in the debugger.
   constexpr bool kJitPoolNeedsPeers = true;
-  thread_pool_.reset(new ThreadPool("Jit thread pool", 1, kJitPoolNeedsPeers));
+  // The zygote compiles with a single thread, as its tasks rely on their FIFO order, e.g.
+  // JitDoneCompilingProfileTask runs after the compilation of the profile. Forked children
+  // get the requested number of threads in PostZygoteFork.
+  Runtime* runtime = Runtime::Current();
+  size_t num_threads = runtime->IsZygote() ? 1u : options_->GetThreadPoolCount();
+  thread_pool_.reset(new JitThreadPool("Jit thread pool", num_threads, kJitPoolNeedsPeers));
 
   thread_pool_->SetPthreadPriority(options_->GetThreadPoolPthreadPriority());
   Start();
 
-  Runtime* runtime = Runtime::Current();
   if (runtime->IsZygote()) {
     // To speed up class lookups, generate a type lookup table for
     // dex files not backed by oat file.
@@ -1309,6 +1447,104 @@ void Jit::RegisterDexFiles(const std::vector<std::unique_ptr<const DexFile>>& de
       !runtime->IsJavaDebuggable()) {
     thread_pool_->AddTask(Thread::Current(), new JitProfileTask(dex_files, class_loader));
   }
+  if (!options_->GetWarmStartFile().empty() &&
+      thread_pool_ != nullptr &&
+      UseJitCompilation() &&
+      !runtime->IsZygote() &&
+      !runtime->IsJavaDebuggable()) {
+    thread_pool_->AddTask(Thread::Current(), new JitWarmStartTask(dex_files, class_loader));
+  }
+}
+
+JitWarmStartInfo* Jit::GetWarmStartInfoLocked() {
+  if (warm_start_info_ == nullptr) {
+    warm_start_info_.reset(new JitWarmStartInfo());
+    const std::string& filename = options_->GetWarmStartFile();
+    std::string error_msg;
+    if (OS::FileExists(filename.c_str()) && !warm_start_info_->Load(filename, &error_msg)) {
+      LOG(WARNING) << "Ignoring JIT warm start file: " << error_msg;
+    }
+  }
+  return warm_start_info_.get();
+}
+
+uint32_t Jit::CompileMethodsFromWarmStartInfo(Thread* self,
+                                              const std::vector<const DexFile*>& dex_files,
+                                              Handle<mirror::ClassLoader> class_loader) {
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  StackHandleScope<1> hs(self);
+  MutableHandle<mirror::DexCache> dex_cache = hs.NewHandle<mirror::DexCache>(nullptr);
+  uint32_t added_to_queue = 0u;
+  for (const DexFile* dex_file : dex_files) {
+    std::set<uint32_t> methods;
+    {
+      MutexLock mu(self, warm_start_lock_);
+      const std::set<uint32_t>* recorded_methods = GetWarmStartInfoLocked()->GetMethods(
+          dex_file->GetLocation(), dex_file->GetLocationChecksum());
+      if (recorded_methods == nullptr) {
+        // Not recorded, or recorded for another version of the dex file.
+        continue;
+      }
+      methods = *recorded_methods;
+    }
+    dex_cache.Assign(class_linker->FindDexCache(self, *dex_file));
+    CHECK(dex_cache != nullptr) << "Could not find dex cache for " << dex_file->GetLocation();
+    for (uint32_t method_idx : methods) {
+      if (method_idx >= dex_file->NumMethodIds()) {
+        continue;
+      }
+      ArtMethod* method = class_linker->ResolveMethodWithoutInvokeType(
+          method_idx, dex_cache, class_loader);
+      if (method == nullptr) {
+        self->ClearException();
+        continue;
+      }
+      if (method->IsClassInitializer() ||
+          method->IsNative() ||
+          !method->IsCompilable() ||
+          !method->IsInvokable() ||
+          method->IsPreCompiled() ||
+          code_cache_->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+        continue;
+      }
+      if (thread_pool_ == nullptr) {
+        break;
+      }
+      AddCompileTask(self, method, CompilationKind::kOptimized);
+      ++added_to_queue;
+    }
+  }
+  return added_to_queue;
+}
+
+void Jit::MaybeSaveWarmStartInfo(Thread* self) {
+  MutexLock mu(self, warm_start_lock_);
+  if (++compilations_since_warm_start_save_ < kJitWarmStartSaveInterval) {
+    return;
+  }
+  compilations_since_warm_start_save_ = 0u;
+  ScopedTrace trace(__FUNCTION__);
+  // Keep the methods recorded by previous runs, which may not have been compiled yet, or belong
+  // to dex files this run did not load.
+  JitWarmStartInfo* info = GetWarmStartInfoLocked();
+  std::vector<ArtMethod*> methods;
+  code_cache_->GetOptimizedMethods(&methods);
+  for (ArtMethod* method : methods) {
+    if (method->IsProxyMethod() || method->IsObsolete()) {
+      continue;
+    }
+    const DexFile* dex_file = method->GetDexFile();
+    info->AddMethod(
+        dex_file->GetLocation(), dex_file->GetLocationChecksum(), method->GetDexMethodIndex());
+  }
+  std::string error_msg;
+  // Do not block GCs on the file write.
+  ScopedThreadSuspension sts(self, kNative);
+  if (!info->Save(options_->GetWarmStartFile(), &error_msg)) {
+    LOG(WARNING) << "Could not save JIT warm start file: " << error_msg;
+    return;
+  }
+  VLOG(jit) << "Saved " << info->GetNumberOfMethods() << " methods to the JIT warm start file";
 }
 
 bool Jit::CompileMethodFromProfile(Thread* self,
@@ -1339,7 +1575,7 @@ bool Jit::CompileMethodFromProfile(Thread* self,
       (entry_point == GetQuickResolutionStub())) {
     method->SetPreCompiled();
     if (!add_to_queue) {
-      CompileMethod(method, self, /* baseline= */ false, /* osr= */ false, /* prejit= */ true);
+      CompileMethod(method, self, CompilationKind::kOptimized, /* prejit= */ true);
     } else {
       Task* task = new JitCompileTask(method, JitCompileTask::TaskKind::kPreCompile);
       if (compile_after_boot) {
@@ -1554,14 +1790,24 @@ bool Jit::MaybeCompileMethod(Thread* self,
     }
   }
   if (UseJitCompilation()) {
+    if (method->IsNative()) {
+      // The generic JNI trampoline costs much more than a compiled stub, and stubs are cheap to
+      // compile and shared by the methods of the same shorty and flags. Compile the stub as soon
+      // as the method is warm.
+      if (old_count < WarmMethodThreshold() && new_count >= WarmMethodThreshold() &&
+          !code_cache_->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+        AddCompileTask(self, method, CompilationKind::kOptimized);
+      }
+      return true;
+    }
     if (old_count < HotMethodThreshold() && new_count >= HotMethodThreshold()) {
       if (!code_cache_->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
         DCHECK(thread_pool_ != nullptr);
-        JitCompileTask::TaskKind kind =
+        CompilationKind kind =
             (options_->UseTieredJitCompilation() || options_->UseBaselineCompiler())
-                ? JitCompileTask::TaskKind::kCompileBaseline
-                : JitCompileTask::TaskKind::kCompile;
-        thread_pool_->AddTask(self, new JitCompileTask(method, kind));
+                ? CompilationKind::kBaseline
+                : CompilationKind::kOptimized;
+        AddCompileTask(self, method, kind);
       }
     }
     if (old_count < OSRMethodThreshold() && new_count >= OSRMethodThreshold()) {
@@ -1571,8 +1817,7 @@ bool Jit::MaybeCompileMethod(Thread* self,
       DCHECK(!method->IsNative());  // No back edges reported for native methods.
       if (!code_cache_->IsOsrCompiled(method)) {
         DCHECK(thread_pool_ != nullptr);
-        thread_pool_->AddTask(
-            self, new JitCompileTask(method, JitCompileTask::TaskKind::kCompileOsr));
+        AddCompileTask(self, method, CompilationKind::kOsr);
       }
     }
   }
@@ -1586,10 +1831,30 @@ void Jit::EnqueueOptimizedCompilation(ArtMethod* method, Thread* self) {
   // We arrive here after a baseline compiled code has reached its baseline
   // hotness threshold. If tiered compilation is enabled, enqueue a compilation
   // task that will compile optimize the method.
-  if (options_->UseTieredJitCompilation()) {
-    thread_pool_->AddTask(
-        self, new JitCompileTask(method, JitCompileTask::TaskKind::kCompile));
+  if (!options_->UseTieredJitCompilation()) {
+    return;
+  }
+  CompilationKind kind = CompilationKind::kOptimized;
+  if (options_->UseBaselinePlusCompiler()) {
+    // While the queue is deep, promote baseline code to the cheaper baseline-plus tier first, so
+    // that hot methods leave baseline code sooner. Hot baseline-plus code waits for the queue to
+    // drain: its hotness counter overflows again later.
+    bool queue_is_deep =
+        thread_pool_->GetTaskCount(self) >= options_->GetBaselinePlusQueueThreshold();
+    const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
+    bool is_baseline_plus = code_cache_->ContainsPc(entry_point) &&
+        CodeInfo::IsBaselinePlus(
+            OatQuickMethodHeader::FromEntryPoint(entry_point)->GetOptimizedCodeInfoPtr());
+    if (is_baseline_plus) {
+      if (queue_is_deep) {
+        deferred_promotions_.fetch_add(1u, std::memory_order_relaxed);
+        return;
+      }
+    } else if (queue_is_deep) {
+      kind = CompilationKind::kBaselinePlus;
+    }
   }
+  AddCompileTask(self, method, kind);
 }
 
 class ScopedSetRuntimeThread {
@@ -1627,6 +1892,11 @@ void Jit::MethodEntered(Thread* thread, ArtMethod* method) {
     return;
   }
 
+  if (method->IsNative()) {
+    // Compiled JNI stubs do not call MethodEntered(), so this is a generic JNI call.
+    generic_jni_calls_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
   ProfilingInfo* profiling_info = method->GetProfilingInfo(kRuntimePointerSize);
   // Update the entrypoint if the ProfilingInfo has one. The interpreter will call it
   // instead of interpreting the method. We don't update it for instrumentation as the entrypoint
@@ -1795,6 +2065,9 @@ void Jit::PostZygoteFork() {
     NotifyZygoteCompilationDone();
     CHECK(code_cache_->GetZygoteMap()->IsCompilationNotified());
   }
+  if (!Runtime::Current()->IsZygote()) {
+    thread_pool_->SetThreadCount(Thread::Current(), options_->GetThreadPoolCount());
+  }
   thread_pool_->CreateThreads();
 }
 
@@ -1840,24 +2113,27 @@ bool Jit::CanAssumeInitialized(ObjPtr<mirror::Class> cls, bool is_for_shared_reg
   }
 }
 
-void Jit::EnqueueCompilationFromNterp(ArtMethod* method, Thread* self) {
+void Jit::EnqueueCompilationFromNterp(ArtMethod* method, Thread* self, bool from_back_edge) {
   if (thread_pool_ == nullptr) {
     return;
   }
   if (GetCodeCache()->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
     // If we already have compiled code for it, nterp may be stuck in a loop.
     // Compile OSR.
-    thread_pool_->AddTask(
-        self, new JitCompileTask(method, JitCompileTask::TaskKind::kCompileOsr));
+    AddCompileTask(self, method, CompilationKind::kOsr);
     return;
   }
+  if (from_back_edge) {
+    // The method got hot in a loop of its first invocations. Compiled code for the
+    // method would only be used by the next invocation, so also compile OSR code
+    // that nterp can jump to from this loop.
+    AddCompileTask(self, method, CompilationKind::kOsr);
+  }
   if (GetCodeCache()->CanAllocateProfilingInfo()) {
     ProfilingInfo::Create(self, method, /* retry_allocation= */ false);
-    thread_pool_->AddTask(
-        self, new JitCompileTask(method, JitCompileTask::TaskKind::kCompileBaseline));
+    AddCompileTask(self, method, CompilationKind::kBaseline);
   } else {
-    thread_pool_->AddTask(
-        self, new JitCompileTask(method, JitCompileTask::TaskKind::kCompile));
+    AddCompileTask(self, method, CompilationKind::kOptimized);
   }
 }
 
@@ -24,13 +24,15 @@
 #include "base/mutex.h"
 #include "base/runtime_debug.h"
 #include "base/timing_logger.h"
+#include "compilation_kind.h"
 #include "handle.h"
 #include "offsets.h"
 #include "interpreter/mterp/mterp.h"
 #include "jit/debugger_interface.h"
+#include "jit/jit_thread_pool.h"
+#include "jit/jit_warm_start.h"
 #include "jit/profile_saver_options.h"
 #include "obj_ptr.h"
-#include "thread_pool.h"
 
 namespace art {
 
@@ -60,9 +62,16 @@ static constexpr int16_t kJitHotnessDisabled = -2;
 // At what priority to schedule jit threads. 9 is the lowest foreground priority on device.
 // See android/os/Process.java.
 static constexpr int kJitPoolThreadPthreadDefaultPriority = 9;
+// Number of JIT worker threads, see -Xjitthreadcount. The zygote always uses one.
+static constexpr uint32_t kJitDefaultPoolThreadCount = 1;
+// Number of optimized compilations between two updates of the warm start file.
+static constexpr size_t kJitWarmStartSaveInterval = 64;
 // We check whether to jit-compile the method every Nth invoke.
 // The tests often use threshold of 1000 (and thus 500 to start profiling).
 static constexpr uint32_t kJitSamplesBatchSize = 512;  // Must be power of 2.
+// Number of pending JIT tasks from which hot baseline code is first promoted to baseline-plus
+// code rather than to optimized code, see Jit::EnqueueOptimizedCompilation.
+static constexpr uint32_t kJitDefaultBaselinePlusQueueThreshold = 16;
 
 class JitOptions {
  public:
@@ -112,6 +121,21 @@ class JitOptions {
     return thread_pool_pthread_priority_;
   }
 
+  uint32_t GetThreadPoolCount() const {
+    return thread_pool_count_;
+  }
+
+  // The file recording the optimized methods across runs, see JitWarmStartInfo. Empty if the
+  // warm start is disabled.
+  const std::string& GetWarmStartFile() const {
+    return warm_start_file_;
+  }
+
+  // Whether baseline code is allocated apart from optimized code, see JitMemoryRegion.
+  bool UseSegmentedCodeCache() const {
+    return use_segmented_code_cache_;
+  }
+
   bool UseJitCompilation() const {
     return use_jit_compilation_;
   }
@@ -151,6 +175,14 @@ class JitOptions {
     return use_baseline_compiler_;
   }
 
+  bool UseBaselinePlusCompiler() const {
+    return use_baseline_plus_compiler_;
+  }
+
+  uint32_t GetBaselinePlusQueueThreshold() const {
+    return baseline_plus_queue_threshold_;
+  }
+
  private:
   // We add the sample in batches of size kJitSamplesBatchSize.
   // This method rounds the threshold so that it is multiple of the batch size.
@@ -159,6 +191,8 @@ class JitOptions {
   bool use_jit_compilation_;
   bool use_tiered_jit_compilation_;
   bool use_baseline_compiler_;
+  bool use_baseline_plus_compiler_;
+  uint32_t baseline_plus_queue_threshold_;
   size_t code_cache_initial_capacity_;
   size_t code_cache_max_capacity_;
   uint32_t compile_threshold_;
@@ -168,12 +202,17 @@ class JitOptions {
   uint16_t invoke_transition_weight_;
   bool dump_info_on_shutdown_;
   int thread_pool_pthread_priority_;
+  uint32_t thread_pool_count_;
+  std::string warm_start_file_;
+  bool use_segmented_code_cache_;
   ProfileSaverOptions profile_saver_options_;
 
   JitOptions()
       : use_jit_compilation_(false),
         use_tiered_jit_compilation_(false),
         use_baseline_compiler_(false),
+        use_baseline_plus_compiler_(false),
+        baseline_plus_queue_threshold_(0),
         code_cache_initial_capacity_(0),
         code_cache_max_capacity_(0),
         compile_threshold_(0),
@@ -182,7 +221,9 @@ class JitOptions {
         priority_thread_weight_(0),
         invoke_transition_weight_(0),
         dump_info_on_shutdown_(false),
-        thread_pool_pthread_priority_(kJitPoolThreadPthreadDefaultPriority) {}
+        thread_pool_pthread_priority_(kJitPoolThreadPthreadDefaultPriority),
+        thread_pool_count_(kJitDefaultPoolThreadCount),
+        use_segmented_code_cache_(false) {}
 
   DISALLOW_COPY_AND_ASSIGN(JitOptions);
 };
@@ -192,7 +233,7 @@ class JitCompilerInterface {
  public:
   virtual ~JitCompilerInterface() {}
   virtual bool CompileMethod(
-      Thread* self, JitMemoryRegion* region, ArtMethod* method, bool baseline, bool osr)
+      Thread* self, JitMemoryRegion* region, ArtMethod* method, CompilationKind compilation_kind)
       REQUIRES_SHARED(Locks::mutator_lock_) = 0;
   virtual void TypesLoaded(mirror::Class**, size_t count)
       REQUIRES_SHARED(Locks::mutator_lock_) = 0;
@@ -243,7 +284,10 @@ class Jit {
   // Create JIT itself.
   static Jit* Create(JitCodeCache* code_cache, JitOptions* options);
 
-  bool CompileMethod(ArtMethod* method, Thread* self, bool baseline, bool osr, bool prejit)
+  bool CompileMethod(ArtMethod* method,
+                     Thread* self,
+                     CompilationKind compilation_kind,
+                     bool prejit)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   const JitCodeCache* GetCodeCache() const {
@@ -262,8 +306,8 @@ class Jit {
   void DeleteThreadPool();
   void WaitForWorkersToBeCreated();
 
-  // Dump interesting info: #methods compiled, code vs data size, compile / verify cumulative
-  // loggers.
+  // Dump interesting info: #methods compiled per tier, code vs data size, compile / verify
+  // cumulative loggers.
   void DumpInfo(std::ostream& os) REQUIRES(!lock_);
   // Add a timing logger to cumulative_timings_.
   void AddTimingLogger(const TimingLogger& logger);
@@ -272,6 +316,11 @@ class Jit {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Called by the compiler when compiling `method` used more than its arena memory budget.
+  // The method is not JIT compiled again.
+  void NotifyMemoryBudgetExceeded(ArtMethod* method, size_t bytes)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   uint16_t OSRMethodThreshold() const {
     return options_->GetOsrThreshold();
   }
@@ -371,7 +420,7 @@ class Jit {
   // Load the compiler library.
   static bool LoadCompilerLibrary(std::string* error_msg);
 
-  ThreadPool* GetThreadPool() const {
+  JitThreadPool* GetThreadPool() const {
     return thread_pool_.get();
   }
 
@@ -413,6 +462,14 @@ class Jit {
                                          Handle<mirror::ClassLoader> class_loader,
                                          bool add_to_queue);
 
+  // Add to the JIT queue the methods of `dex_files` recorded in the warm start file.
+  // Return the number of methods added to the queue.
+  uint32_t CompileMethodsFromWarmStartInfo(Thread* self,
+                                           const std::vector<const DexFile*>& dex_files,
+                                           Handle<mirror::ClassLoader> class_loader)
+      REQUIRES(!warm_start_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Register the dex files to the JIT. This is to perform any compilation/optimization
   // at the point of loading the dex files.
   void RegisterDexFiles(const std::vector<std::unique_ptr<const DexFile>>& dex_files,
@@ -436,9 +493,14 @@ class Jit {
   // class path methods.
   void NotifyZygoteCompilationDone();
 
-  void EnqueueOptimizedCompilation(ArtMethod* method, Thread* self);
+  // Called when baseline code of `method` becomes hot. Enqueues its compilation to the next tier,
+  // depending on the tier of its current code and on the number of pending compilations.
+  void EnqueueOptimizedCompilation(ArtMethod* method, Thread* self)
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
-  void EnqueueCompilationFromNterp(ArtMethod* method, Thread* self)
+  // Called when the nterp hotness counter of `method` expires. `from_back_edge` tells
+  // whether it happened on a loop back edge rather than on method entry.
+  void EnqueueCompilationFromNterp(ArtMethod* method, Thread* self, bool from_back_edge)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
  private:
@@ -464,6 +526,20 @@ class Jit {
                           bool with_backedges)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Add a task compiling `method` to `compilation_kind`, unless a compilation of the method to
+  // the same or a higher tier is already pending.
+  void AddCompileTask(Thread* self, ArtMethod* method, CompilationKind compilation_kind)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Record the optimized methods in the warm start file, every kJitWarmStartSaveInterval
+  // optimized compilations.
+  void MaybeSaveWarmStartInfo(Thread* self)
+      REQUIRES(!warm_start_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Returns the warm start info, loading the warm start file on first use.
+  JitWarmStartInfo* GetWarmStartInfoLocked() REQUIRES(warm_start_lock_);
+
   static bool BindCompilerMethods(std::string* error_msg);
 
   // JIT compiler
@@ -476,17 +552,31 @@ class Jit {
   jit::JitCodeCache* const code_cache_;
   const JitOptions* const options_;
 
-  std::unique_ptr<ThreadPool> thread_pool_;
+  std::unique_ptr<JitThreadPool> thread_pool_;
   std::vector<std::unique_ptr<OatDexFile>> type_lookup_tables_;
 
   Mutex boot_completed_lock_;
   bool boot_completed_ GUARDED_BY(boot_completed_lock_) = false;
   std::deque<Task*> tasks_after_boot_ GUARDED_BY(boot_completed_lock_);
 
+  Mutex warm_start_lock_;
+  std::unique_ptr<JitWarmStartInfo> warm_start_info_ GUARDED_BY(warm_start_lock_);
+  size_t compilations_since_warm_start_save_ GUARDED_BY(warm_start_lock_) = 0u;
+
   // Performance monitoring.
   CumulativeLogger cumulative_timings_;
   Histogram<uint64_t> memory_use_ GUARDED_BY(lock_);
   Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Per tier numbers of methods compiled and of failed compilations.
+  Atomic<uint64_t> compiled_methods_[kNumberOfCompilationKinds];
+  Atomic<uint64_t> failed_compilations_[kNumberOfCompilationKinds];
+  // Number of hot baseline-plus methods not promoted to optimized code because of the number of
+  // pending compilations.
+  Atomic<uint64_t> deferred_promotions_;
+  // Number of calls to native methods through the generic JNI trampoline.
+  Atomic<uint64_t> generic_jni_calls_;
+  // Number of methods no longer JIT compiled because they went over the compiler memory budget.
+  Atomic<uint64_t> memory_budget_rejections_;
 
   // In the JIT zygote configuration, after all compilation is done, the zygote
   // will copy its contents of the boot image to the zygote_mapping_methods_,
@@ -16,6 +16,7 @@
 
 #include "jit_code_cache.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include <android-base/logging.h>
@@ -234,6 +235,7 @@ JitCodeCache* JitCodeCache::Create(bool used_only_for_profile_data,
                          max_capacity,
                          rwx_memory_allowed,
                          is_zygote,
+                         Runtime::Current()->GetJITOptions()->UseSegmentedCodeCache(),
                          error_msg)) {
     return nullptr;
   }
@@ -263,9 +265,12 @@ JitCodeCache::JitCodeCache()
       collection_in_progress_(false),
       last_collection_increased_code_cache_(false),
       garbage_collect_code_(true),
+      pending_commits_(nullptr),
       number_of_compilations_(0),
       number_of_osr_compilations_(0),
       number_of_collections_(0),
+      number_of_commit_batches_(0),
+      number_of_batched_commits_(0),
       histogram_stack_map_memory_use_("Memory used for stack maps", 16),
       histogram_code_memory_use_("Memory used for compiled code", 16),
       histogram_profiling_info_memory_use_("Memory used for profiling info", 16) {
@@ -454,6 +459,9 @@ void JitCodeCache::SweepRootTables(IsMarkedVisitor* visitor) {
       InlineCache* cache = &info->cache_[i];
       for (size_t j = 0; j < InlineCache::kIndividualCacheSize; ++j) {
         Runtime::ProcessWeakClass(&cache->classes_[j], visitor, nullptr);
+        if (cache->classes_[j].IsNull()) {
+          cache->counts_[j] = 0u;
+        }
       }
     }
   }
@@ -595,7 +603,8 @@ void JitCodeCache::DisallowInlineCacheAccess() {
 }
 
 void JitCodeCache::CopyInlineCacheInto(const InlineCache& ic,
-                                       Handle<mirror::ObjectArray<mirror::Class>> array) {
+                                       Handle<mirror::ObjectArray<mirror::Class>> array,
+                                       /*out*/ uint16_t* counts) {
   WaitUntilInlineCacheAccessible(Thread::Current());
   // Note that we don't need to lock `lock_` here, the compiler calling
   // this method has already ensured the inline cache will not be deleted.
@@ -604,6 +613,7 @@ void JitCodeCache::CopyInlineCacheInto(const InlineCache& ic,
        ++in_cache) {
     mirror::Class* object = ic.classes_[in_cache].Read();
     if (object != nullptr) {
+      counts[in_array] = ic.counts_[in_cache];
       array->Set(in_array++, object);
     }
   }
@@ -634,6 +644,23 @@ void JitCodeCache::WaitForPotentialCollectionToCompleteRunnable(Thread* self) {
   }
 }
 
+struct JitCodeCache::CommitRequest {
+  JitMemoryRegion* region;
+  ArtMethod* method;
+  ArrayRef<const uint8_t> reserved_code;
+  ArrayRef<const uint8_t> code;
+  ArrayRef<const uint8_t> reserved_data;
+  const std::vector<Handle<mirror::Object>>* roots;
+  ArrayRef<const uint8_t> stack_map;
+  bool osr;
+  bool has_should_deoptimize_flag;
+  const ArenaSet<ArtMethod*>* cha_single_implementation_list;
+  CommitRequest* next;
+  // Set under the jit lock by the thread committing the request.
+  bool done;
+  bool success;
+};
+
 bool JitCodeCache::Commit(Thread* self,
                           JitMemoryRegion* region,
                           ArtMethod* method,
@@ -653,107 +680,186 @@ bool JitCodeCache::Commit(Thread* self,
     DCheckRootsAreValid(roots, IsSharedRegion(*region));
   }
 
-  const uint8_t* roots_data = reserved_data.data();
-  size_t root_table_size = ComputeRootTableSize(roots.size());
-  const uint8_t* stack_map_data = roots_data + root_table_size;
+  CommitRequest request = {
+      region,
+      method,
+      reserved_code,
+      code,
+      reserved_data,
+      &roots,
+      stack_map,
+      osr,
+      has_should_deoptimize_flag,
+      &cha_single_implementation_list,
+      /* next= */ pending_commits_.load(std::memory_order_relaxed),
+      /* done= */ false,
+      /* success= */ false,
+  };
+  while (!pending_commits_.CompareAndSetWeakRelease(request.next, &request)) {
+    request.next = pending_commits_.load(std::memory_order_relaxed);
+  }
 
   MutexLock mu(self, *Locks::jit_lock_);
   // We need to make sure that there will be no jit-gcs going on and wait for any ongoing one to
   // finish.
   WaitForPotentialCollectionToCompleteRunnable(self);
-  const uint8_t* code_ptr = region->CommitCode(
-      reserved_code, code, stack_map_data, has_should_deoptimize_flag);
-  if (code_ptr == nullptr) {
-    return false;
+  if (!request.done) {
+    // No other thread took the request: the threads committing requests hold the jit lock from
+    // taking them to marking them done. Commit it along with the requests pushed meanwhile.
+    CommitBatchLocked(self, pending_commits_.exchange(nullptr, std::memory_order_acquire));
+  }
+  DCHECK(request.done);
+  return request.success;
+}
+
+void JitCodeCache::CommitBatchLocked(Thread* self, CommitRequest* batch) {
+  std::vector<CommitRequest*> requests;
+  for (CommitRequest* request = batch; request != nullptr; request = request->next) {
+    requests.push_back(request);
+  }
+  std::reverse(requests.begin(), requests.end());
+  ++number_of_commit_batches_;
+  number_of_batched_commits_ += requests.size() - 1u;
+
+  // Write the code of all the requests with one write window per region, and flush the caches
+  // before the window ends.
+  std::vector<const uint8_t*> code_ptrs(requests.size(), nullptr);
+  bool sync_cores = false;
+  for (JitMemoryRegion* region : { &private_region_, &shared_region_ }) {
+    auto in_region = [region](CommitRequest* request) { return request->region == region; };
+    if (std::none_of(requests.begin(), requests.end(), in_region)) {
+      continue;
+    }
+    ScopedCodeCacheWrite scc(*region);
+    for (size_t i = 0; i != requests.size(); ++i) {
+      CommitRequest* request = requests[i];
+      if (!in_region(request)) {
+        continue;
+      }
+      DCHECK(!request->method->IsNative() || !request->osr);
+      const uint8_t* roots_data = request->reserved_data.data();
+      size_t root_table_size = ComputeRootTableSize(request->roots->size());
+      const uint8_t* stack_map_data = roots_data + root_table_size;
+      const uint8_t* code_ptr = region->WriteCode(request->reserved_code,
+                                                  request->code,
+                                                  stack_map_data,
+                                                  request->has_should_deoptimize_flag);
+      if (region->FlushCode(code_ptr)) {
+        code_ptrs[i] = code_ptr;
+        sync_cores = true;
+      }
+    }
   }
-  OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
-
-  // Commit roots and stack maps before updating the entry point.
-  if (!region->CommitData(reserved_data, roots, stack_map)) {
-    return false;
+  if (sync_cores) {
+    JitMemoryRegion::SyncCores();
   }
 
-  number_of_compilations_++;
+  // Commit roots and stack maps before updating the entry points.
+  for (size_t i = 0; i != requests.size(); ++i) {
+    CommitRequest* request = requests[i];
+    if (code_ptrs[i] != nullptr &&
+        !request->region->CommitData(request->reserved_data, *request->roots, request->stack_map)) {
+      code_ptrs[i] = nullptr;
+    }
+  }
 
-  // We need to update the entry point in the runnable state for the instrumentation.
+  // We need to update the entry points in the runnable state for the instrumentation.
   {
     // The following needs to be guarded by cha_lock_ also. Otherwise it's possible that the
     // compiled code is considered invalidated by some class linking, but below we still make the
     // compiled code valid for the method.  Need cha_lock_ for checking all single-implementation
     // flags and register dependencies.
     MutexLock cha_mu(self, *Locks::cha_lock_);
-    bool single_impl_still_valid = true;
-    for (ArtMethod* single_impl : cha_single_implementation_list) {
-      if (!single_impl->HasSingleImplementation()) {
-        // Simply discard the compiled code. Clear the counter so that it may be recompiled later.
-        // Hopefully the class hierarchy will be more stable when compilation is retried.
-        single_impl_still_valid = false;
-        ClearMethodCounter(method, /*was_warm=*/ false);
-        break;
-      }
+    for (size_t i = 0; i != requests.size(); ++i) {
+      CommitRequest* request = requests[i];
+      request->success =
+          (code_ptrs[i] != nullptr) && PublishCodeLocked(*request, code_ptrs[i]);
     }
+  }
+  for (CommitRequest* request : requests) {
+    request->done = true;
+  }
+}
 
-    // Discard the code if any single-implementation assumptions are now invalid.
-    if (UNLIKELY(!single_impl_still_valid)) {
-      VLOG(jit) << "JIT discarded jitted code due to invalid single-implementation assumptions.";
-      return false;
-    }
-    DCHECK(cha_single_implementation_list.empty() || !Runtime::Current()->IsJavaDebuggable())
-        << "Should not be using cha on debuggable apps/runs!";
+bool JitCodeCache::PublishCodeLocked(const CommitRequest& request, const uint8_t* code_ptr) {
+  ArtMethod* method = request.method;
+  JitMemoryRegion* region = request.region;
+  bool osr = request.osr;
+  const ArenaSet<ArtMethod*>& cha_single_implementation_list =
+      *request.cha_single_implementation_list;
+  OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
+  number_of_compilations_++;
 
-    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
-    for (ArtMethod* single_impl : cha_single_implementation_list) {
-      class_linker->GetClassHierarchyAnalysis()->AddDependency(single_impl, method, method_header);
+  bool single_impl_still_valid = true;
+  for (ArtMethod* single_impl : cha_single_implementation_list) {
+    if (!single_impl->HasSingleImplementation()) {
+      // Simply discard the compiled code. Clear the counter so that it may be recompiled later.
+      // Hopefully the class hierarchy will be more stable when compilation is retried.
+      single_impl_still_valid = false;
+      ClearMethodCounter(method, /*was_warm=*/ false);
+      break;
     }
+  }
 
-    if (UNLIKELY(method->IsNative())) {
-      auto it = jni_stubs_map_.find(JniStubKey(method));
-      DCHECK(it != jni_stubs_map_.end())
-          << "Entry inserted in NotifyCompilationOf() should be alive.";
-      JniStubData* data = &it->second;
-      DCHECK(ContainsElement(data->GetMethods(), method))
-          << "Entry inserted in NotifyCompilationOf() should contain this method.";
-      data->SetCode(code_ptr);
-      data->UpdateEntryPoints(method_header->GetEntryPoint());
+  // Discard the code if any single-implementation assumptions are now invalid.
+  if (UNLIKELY(!single_impl_still_valid)) {
+    VLOG(jit) << "JIT discarded jitted code due to invalid single-implementation assumptions.";
+    return false;
+  }
+  DCHECK(cha_single_implementation_list.empty() || !Runtime::Current()->IsJavaDebuggable())
+      << "Should not be using cha on debuggable apps/runs!";
+
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  for (ArtMethod* single_impl : cha_single_implementation_list) {
+    class_linker->GetClassHierarchyAnalysis()->AddDependency(single_impl, method, method_header);
+  }
+
+  if (UNLIKELY(method->IsNative())) {
+    auto it = jni_stubs_map_.find(JniStubKey(method));
+    DCHECK(it != jni_stubs_map_.end())
+        << "Entry inserted in NotifyCompilationOf() should be alive.";
+    JniStubData* data = &it->second;
+    DCHECK(ContainsElement(data->GetMethods(), method))
+        << "Entry inserted in NotifyCompilationOf() should contain this method.";
+    data->SetCode(code_ptr);
+    data->UpdateEntryPoints(method_header->GetEntryPoint());
+  } else {
+    if (method->IsPreCompiled() && IsSharedRegion(*region)) {
+      zygote_map_.Put(code_ptr, method);
     } else {
-      if (method->IsPreCompiled() && IsSharedRegion(*region)) {
-        zygote_map_.Put(code_ptr, method);
-      } else {
-        method_code_map_.Put(code_ptr, method);
+      method_code_map_.Put(code_ptr, method);
+    }
+    if (osr) {
+      number_of_osr_compilations_++;
+      osr_code_map_.Put(method, code_ptr);
+    } else if (NeedsClinitCheckBeforeCall(method) &&
+               !method->GetDeclaringClass()->IsVisiblyInitialized()) {
+      // This situation currently only occurs in the jit-zygote mode.
+      DCHECK(!garbage_collect_code_);
+      DCHECK(method->IsPreCompiled());
+      // The shared region can easily be queried. For the private region, we
+      // use a side map.
+      if (!IsSharedRegion(*region)) {
+        saved_compiled_methods_map_.Put(method, code_ptr);
       }
-      if (osr) {
-        number_of_osr_compilations_++;
-        osr_code_map_.Put(method, code_ptr);
-      } else if (NeedsClinitCheckBeforeCall(method) &&
-                 !method->GetDeclaringClass()->IsVisiblyInitialized()) {
-        // This situation currently only occurs in the jit-zygote mode.
-        DCHECK(!garbage_collect_code_);
-        DCHECK(method->IsPreCompiled());
-        // The shared region can easily be queried. For the private region, we
-        // use a side map.
-        if (!IsSharedRegion(*region)) {
-          saved_compiled_methods_map_.Put(method, code_ptr);
-        }
-      } else {
-        Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
-            method, method_header->GetEntryPoint());
-      }
-    }
-    if (collection_in_progress_) {
-      // We need to update the live bitmap if there is a GC to ensure it sees this new
-      // code.
-      GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
+    } else {
+      Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
+          method, method_header->GetEntryPoint());
     }
-    VLOG(jit)
-        << "JIT added (osr=" << std::boolalpha << osr << std::noboolalpha << ") "
-        << ArtMethod::PrettyMethod(method) << "@" << method
-        << " ccache_size=" << PrettySize(CodeCacheSizeLocked()) << ": "
-        << " dcache_size=" << PrettySize(DataCacheSizeLocked()) << ": "
-        << reinterpret_cast<const void*>(method_header->GetEntryPoint()) << ","
-        << reinterpret_cast<const void*>(method_header->GetEntryPoint() +
-                                         method_header->GetCodeSize());
   }
-
+  if (collection_in_progress_) {
+    // We need to update the live bitmap if there is a GC to ensure it sees this new
+    // code.
+    GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
+  }
+  VLOG(jit)
+      << "JIT added (osr=" << std::boolalpha << osr << std::noboolalpha << ") "
+      << ArtMethod::PrettyMethod(method) << "@" << method
+      << " ccache_size=" << PrettySize(CodeCacheSizeLocked()) << ": "
+      << " dcache_size=" << PrettySize(DataCacheSizeLocked()) << ": "
+      << reinterpret_cast<const void*>(method_header->GetEntryPoint()) << ","
+      << reinterpret_cast<const void*>(method_header->GetEntryPoint() +
+                                       method_header->GetCodeSize());
   return true;
 }
 
@@ -929,6 +1035,7 @@ bool JitCodeCache::Reserve(Thread* self,
                            size_t stack_map_size,
                            size_t number_of_roots,
                            ArtMethod* method,
+                           bool baseline,
                            /*out*/ArrayRef<const uint8_t>* reserved_code,
                            /*out*/ArrayRef<const uint8_t>* reserved_data) {
   code_size = OatQuickMethodHeader::InstructionAlignedSize() + code_size;
@@ -943,7 +1050,7 @@ bool JitCodeCache::Reserve(Thread* self,
       MutexLock mu(self, *Locks::jit_lock_);
       WaitForPotentialCollectionToComplete(self);
       ScopedCodeCacheWrite ccw(*region);
-      code = region->AllocateCode(code_size);
+      code = region->AllocateCode(code_size, baseline);
       data = region->AllocateData(data_size);
     }
     if (code == nullptr || data == nullptr) {
@@ -1052,7 +1159,8 @@ void JitCodeCache::MarkCompiledCodeOnThreadStacks(Thread* self) {
   Barrier barrier(0);
   size_t threads_running_checkpoint = 0;
   MarkCodeClosure closure(this, GetLiveBitmap(), &barrier);
-  threads_running_checkpoint = Runtime::Current()->GetThreadList()->RunCheckpoint(&closure);
+  threads_running_checkpoint = Runtime::Current()->GetThreadList()->RunCheckpoint(
+      &closure, /* callback= */ nullptr, ThreadList::MayRunManagedCode);
   // Now that we have run our checkpoint, move to a suspended state and wait
   // for other threads to run the checkpoint.
   ScopedThreadSuspension sts(self, kSuspended);
@@ -1441,6 +1549,7 @@ OatQuickMethodHeader* JitCodeCache::LookupOsrMethodHeader(ArtMethod* method) {
 ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
                                               ArtMethod* method,
                                               const std::vector<uint32_t>& entries,
+                                              const std::vector<uint32_t>& branch_cache_entries,
                                               bool retry_allocation)
     // No thread safety analysis as we are using TryLock/Unlock explicitly.
     NO_THREAD_SAFETY_ANALYSIS {
@@ -1450,30 +1559,39 @@ ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
     // If we are allocating for the interpreter, just try to lock, to avoid
     // lock contention with the JIT.
     if (Locks::jit_lock_->ExclusiveTryLock(self)) {
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_cache_entries);
       Locks::jit_lock_->ExclusiveUnlock(self);
     }
   } else {
     {
       MutexLock mu(self, *Locks::jit_lock_);
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_cache_entries);
     }
 
     if (info == nullptr) {
       GarbageCollectCache(self);
       MutexLock mu(self, *Locks::jit_lock_);
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_cache_entries);
     }
   }
   return info;
 }
 
-ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(Thread* self ATTRIBUTE_UNUSED,
-                                                      ArtMethod* method,
-                                                      const std::vector<uint32_t>& entries) {
-  size_t profile_info_size = RoundUp(
-      sizeof(ProfilingInfo) + sizeof(InlineCache) * entries.size(),
+static size_t ComputeProfilingInfoSize(size_t number_of_inline_caches,
+                                       size_t number_of_branch_caches) {
+  return RoundUp(
+      sizeof(ProfilingInfo) +
+          sizeof(InlineCache) * number_of_inline_caches +
+          sizeof(BranchCache) * number_of_branch_caches,
       sizeof(void*));
+}
+
+ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(
+    Thread* self ATTRIBUTE_UNUSED,
+    ArtMethod* method,
+    const std::vector<uint32_t>& entries,
+    const std::vector<uint32_t>& branch_cache_entries) {
+  size_t profile_info_size = ComputeProfilingInfoSize(entries.size(), branch_cache_entries.size());
 
   // Check whether some other thread has concurrently created it.
   ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
@@ -1486,7 +1604,7 @@ ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(Thread* self ATTRIBUTE_UNU
     return nullptr;
   }
   uint8_t* writable_data = private_region_.GetWritableDataAddress(data);
-  info = new (writable_data) ProfilingInfo(method, entries);
+  info = new (writable_data) ProfilingInfo(method, entries, branch_cache_entries);
 
   // Make sure other threads see the data in the profiling info object before the
   // store in the ArtMethod's ProfilingInfo pointer.
@@ -1504,6 +1622,19 @@ void* JitCodeCache::MoreCore(const void* mspace, intptr_t increment) {
       : private_region_.MoreCore(mspace, increment);
 }
 
+void JitCodeCache::GetOptimizedMethods(std::vector<ArtMethod*>* methods) {
+  MutexLock mu(Thread::Current(), *Locks::jit_lock_);
+  for (const auto& it : method_code_map_) {
+    OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(it.first);
+    if (!CodeInfo::IsBaseline(method_header->GetOptimizedCodeInfoPtr())) {
+      methods->push_back(it.second);
+    }
+  }
+  for (const auto& it : osr_code_map_) {
+    methods->push_back(it.first);
+  }
+}
+
 void JitCodeCache::GetProfiledMethods(const std::set<std::string>& dex_base_locations,
                                       std::vector<ProfileMethodInfo>& methods) {
   Thread* self = Thread::Current();
@@ -1595,19 +1726,27 @@ bool JitCodeCache::IsOsrCompiled(ArtMethod* method) {
 
 bool JitCodeCache::NotifyCompilationOf(ArtMethod* method,
                                        Thread* self,
-                                       bool osr,
+                                       CompilationKind compilation_kind,
                                        bool prejit,
-                                       bool baseline,
                                        JitMemoryRegion* region) {
+  const bool osr = (compilation_kind == CompilationKind::kOsr);
+  const bool baseline = (compilation_kind == CompilationKind::kBaseline) ||
+                        (compilation_kind == CompilationKind::kBaselinePlus);
   const void* existing_entry_point = method->GetEntryPointFromQuickCompiledCode();
   if (!osr && ContainsPc(existing_entry_point)) {
     OatQuickMethodHeader* method_header =
         OatQuickMethodHeader::FromEntryPoint(existing_entry_point);
-    if (CodeInfo::IsBaseline(method_header->GetOptimizedCodeInfoPtr()) == baseline) {
+    const uint8_t* code_info = method_header->GetOptimizedCodeInfoPtr();
+    // Baseline-plus code is also baseline code. Do not replace it with baseline code, nor
+    // optimized code with baseline-plus code.
+    bool already_compiled = (compilation_kind == CompilationKind::kBaselinePlus)
+        ? (CodeInfo::IsBaselinePlus(code_info) || !CodeInfo::IsBaseline(code_info))
+        : (CodeInfo::IsBaseline(code_info) == baseline);
+    if (already_compiled) {
       VLOG(jit) << "Not compiling "
                 << method->PrettyMethod()
                 << " because it has already been compiled"
-                << " baseline=" << std::boolalpha << baseline;
+                << " kind=" << compilation_kind;
       return false;
     }
   }
@@ -1797,6 +1936,36 @@ void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
   }
 }
 
+void JitCodeCache::DumpDataCacheUsage(std::ostream& os) {
+  const JitMemoryRegion* region = GetCurrentRegion();
+  size_t profiling_info_bytes = 0u;
+  size_t number_of_profiling_infos = 0u;
+  for (ProfilingInfo* info : profiling_infos_) {
+    if (region->IsInDataSpace(info)) {
+      profiling_info_bytes +=
+          ComputeProfilingInfoSize(info->number_of_inline_caches_, info->number_of_branch_caches_);
+      ++number_of_profiling_infos;
+    }
+  }
+  size_t root_table_bytes = 0u;
+  size_t number_of_roots = 0u;
+  for (const auto& entry : method_code_map_) {
+    uint32_t roots = 0u;
+    const uint8_t* root_table = GetRootTable(entry.first, &roots);
+    if (region->IsInDataSpace(root_table)) {
+      root_table_bytes += ComputeRootTableSize(roots);
+      number_of_roots += roots;
+    }
+  }
+  size_t used_data = region->GetUsedMemoryForData();
+  size_t other_bytes = used_data - std::min(used_data, profiling_info_bytes + root_table_bytes);
+  os << "  Profiling infos: " << number_of_profiling_infos
+     << " (" << PrettySize(profiling_info_bytes) << ")\n"
+     << "  Root tables: " << number_of_roots << " roots"
+     << " (" << PrettySize(root_table_bytes) << ")\n"
+     << "  Stack maps and other data: " << PrettySize(other_bytes) << "\n";
+}
+
 void JitCodeCache::Dump(std::ostream& os) {
   MutexLock mu(Thread::Current(), *Locks::jit_lock_);
   os << "Current JIT code cache size (used / resident): "
@@ -1805,6 +1974,7 @@ void JitCodeCache::Dump(std::ostream& os) {
      << "Current JIT data cache size (used / resident): "
      << GetCurrentRegion()->GetUsedMemoryForData() / KB << "KB / "
      << GetCurrentRegion()->GetResidentMemoryForData() / KB << "KB\n";
+  DumpDataCacheUsage(os);
   if (!Runtime::Current()->IsZygote()) {
     os << "Zygote JIT code cache size (at point of fork): "
        << shared_region_.GetUsedMemoryForCode() / KB << "KB / "
@@ -1820,7 +1990,9 @@ void JitCodeCache::Dump(std::ostream& os) {
      << "Total number of JIT compilations: " << number_of_compilations_ << "\n"
      << "Total number of JIT compilations for on stack replacement: "
         << number_of_osr_compilations_ << "\n"
-     << "Total number of JIT code cache collections: " << number_of_collections_ << std::endl;
+     << "Total number of JIT code cache collections: " << number_of_collections_ << "\n"
+     << "Total number of JIT commit batches: " << number_of_commit_batches_
+        << " (commits done by another thread: " << number_of_batched_commits_ << ")" << std::endl;
   histogram_stack_map_memory_use_.PrintMemoryUse(os);
   histogram_code_memory_use_.PrintMemoryUse(os);
   histogram_profiling_info_memory_use_.PrintMemoryUse(os);
@@ -1865,6 +2037,7 @@ void JitCodeCache::PostForkChildAction(bool is_system_server, bool is_zygote) {
                                   max_capacity,
                                   /* rwx_memory_allowed= */ !is_system_server,
                                   is_zygote,
+                                  Runtime::Current()->GetJITOptions()->UseSegmentedCodeCache(),
                                   &error_msg)) {
     LOG(WARNING) << "Could not create private region after zygote fork: " << error_msg;
   }
@@ -32,6 +32,7 @@
 #include "base/mem_map.h"
 #include "base/mutex.h"
 #include "base/safe_map.h"
+#include "compilation_kind.h"
 #include "jit_memory_region.h"
 
 namespace art {
@@ -195,9 +196,8 @@ class JitCodeCache {
 
   bool NotifyCompilationOf(ArtMethod* method,
                            Thread* self,
-                           bool osr,
+                           CompilationKind compilation_kind,
                            bool prejit,
-                           bool baseline,
                            JitMemoryRegion* region)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::jit_lock_);
@@ -239,13 +239,15 @@ class JitCodeCache {
   const void* GetJniStubCode(ArtMethod* method) REQUIRES(!Locks::jit_lock_);
 
   // Allocate a region for both code and data in the JIT code cache.
-  // The reserved memory is left completely uninitialized.
+  // The reserved memory is left completely uninitialized. Baseline code goes to the baseline
+  // segment of segmented regions.
   bool Reserve(Thread* self,
                JitMemoryRegion* region,
                size_t code_size,
                size_t stack_map_size,
                size_t number_of_roots,
                ArtMethod* method,
+               bool baseline,
                /*out*/ArrayRef<const uint8_t>* reserved_code,
                /*out*/ArrayRef<const uint8_t>* reserved_data)
       REQUIRES_SHARED(Locks::mutator_lock_)
@@ -253,6 +255,10 @@ class JitCodeCache {
 
   // Initialize code and data of previously allocated memory.
   //
+  // Concurrent commits are batched: the first thread to get the jit lock commits the pending
+  // requests of all threads with one code write window per region and one core sync, and
+  // publishes their entry points together.
+  //
   // `cha_single_implementation_list` needs to be registered via CHA (if it's
   // still valid), since the compiled code still needs to be invalidated if the
   // single-implementation assumptions are violated later. This needs to be done
@@ -305,7 +311,11 @@ class JitCodeCache {
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  void CopyInlineCacheInto(const InlineCache& ic, Handle<mirror::ObjectArray<mirror::Class>> array)
+  // Copy the classes of `ic` into `array`, and their counts into `counts`, which both have
+  // InlineCache::kIndividualCacheSize entries.
+  void CopyInlineCacheInto(const InlineCache& ic,
+                           Handle<mirror::ObjectArray<mirror::Class>> array,
+                           /*out*/ uint16_t* counts)
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -314,6 +324,7 @@ class JitCodeCache {
   ProfilingInfo* AddProfilingInfo(Thread* self,
                                   ArtMethod* method,
                                   const std::vector<uint32_t>& entries,
+                                  const std::vector<uint32_t>& branch_cache_entries,
                                   bool retry_allocation)
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -330,6 +341,11 @@ class JitCodeCache {
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Adds to `methods` the methods with optimized code in the private region, including OSR code.
+  void GetOptimizedMethods(std::vector<ArtMethod*>* methods)
+      REQUIRES(!Locks::jit_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void InvalidateAllCompiledCode()
       REQUIRES(!Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -408,9 +424,25 @@ class JitCodeCache {
  private:
   JitCodeCache();
 
+  // A pending call to Commit, see CommitBatchLocked.
+  struct CommitRequest;
+
+  // Commit the requests of `batch`, a list linked from the most recent request, and mark them
+  // as done.
+  void CommitBatchLocked(Thread* self, CommitRequest* batch)
+      REQUIRES(Locks::jit_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Register the dependencies of code committed by `request` at `code_ptr`, and update the entry
+  // points. Returns false if the code must be discarded.
+  bool PublishCodeLocked(const CommitRequest& request, const uint8_t* code_ptr)
+      REQUIRES(Locks::jit_lock_, Locks::cha_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   ProfilingInfo* AddProfilingInfoInternal(Thread* self,
                                           ArtMethod* method,
-                                          const std::vector<uint32_t>& entries)
+                                          const std::vector<uint32_t>& entries,
+                                          const std::vector<uint32_t>& branch_cache_entries)
       REQUIRES(Locks::jit_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -452,6 +484,9 @@ class JitCodeCache {
   // Number of bytes allocated in the data cache.
   size_t DataCacheSizeLocked() REQUIRES(Locks::jit_lock_);
 
+  // Print how the used data cache splits between profiling infos, root tables and the rest.
+  void DumpDataCacheUsage(std::ostream& os) REQUIRES(Locks::jit_lock_);
+
   // Notify all waiting threads that a collection is done.
   void NotifyCollectionDone(Thread* self) REQUIRES(Locks::jit_lock_);
 
@@ -543,6 +578,10 @@ class JitCodeCache {
   // Whether we can do garbage collection. Not 'const' as tests may override this.
   bool garbage_collect_code_ GUARDED_BY(Locks::jit_lock_);
 
+  // Requests of threads waiting in Commit, most recent first. Pushed without the jit lock, and
+  // taken by the thread committing them under the jit lock.
+  Atomic<CommitRequest*> pending_commits_;
+
   // ---------------- JIT statistics -------------------------------------- //
 
   // Number of compilations done throughout the lifetime of the JIT.
@@ -554,6 +593,10 @@ class JitCodeCache {
   // Number of code cache collections done throughout the lifetime of the JIT.
   size_t number_of_collections_ GUARDED_BY(Locks::jit_lock_);
 
+  // Number of batches of commits, and of commits done by another thread than the compiling one.
+  size_t number_of_commit_batches_ GUARDED_BY(Locks::jit_lock_);
+  size_t number_of_batched_commits_ GUARDED_BY(Locks::jit_lock_);
+
   // Histograms for keeping track of stack map size statistics.
   Histogram<uint64_t> histogram_stack_map_memory_use_ GUARDED_BY(Locks::jit_lock_);
 
@@ -41,10 +41,18 @@ namespace jit {
 // TODO: Make this variable?
 static constexpr size_t kCodeAndDataCapacityDivider = 2;
 
+// In a segmented region, the baseline code gets a quarter of the code capacity.
+static constexpr size_t kBaselineCodeCapacityDivider = 4;
+
+static size_t GetBaselineCodeFootprint(size_t exec_footprint) {
+  return RoundDown(exec_footprint / kBaselineCodeCapacityDivider, kPageSize);
+}
+
 bool JitMemoryRegion::Initialize(size_t initial_capacity,
                                  size_t max_capacity,
                                  bool rwx_memory_allowed,
                                  bool is_zygote,
+                                 bool segmented_code,
                                  std::string* error_msg) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
 
@@ -286,6 +294,16 @@ bool JitMemoryRegion::Initialize(size_t initial_capacity,
     // Make all pages reserved for the code heap writable. The mspace allocator, that manages the
     // heap, will take and initialize pages in create_mspace_with_base().
     CheckedCall(mprotect, "create code heap", code_heap->Begin(), code_heap->Size(), kProtRW);
+    if (segmented_code && !is_zygote && GetBaselineCodeFootprint(exec_end_) != 0u) {
+      // The baseline segment ends the code mapping, and grows towards its end. The optimized
+      // code cannot grow into it, as it gets at most the rest of the code capacity.
+      baseline_exec_begin_ = exec_capacity - GetBaselineCodeFootprint(exec_capacity);
+      baseline_exec_end_ = GetBaselineCodeFootprint(exec_end_);
+      exec_end_ -= baseline_exec_end_;
+      baseline_exec_mspace_ = create_mspace_with_base(
+          code_heap->Begin() + baseline_exec_begin_, baseline_exec_end_, false /*locked*/);
+      CHECK(baseline_exec_mspace_ != nullptr) << "create_mspace_with_base (baseline) failed";
+    }
     exec_mspace_ = create_mspace_with_base(code_heap->Begin(), exec_end_, false /*locked*/);
     CHECK(exec_mspace_ != nullptr) << "create_mspace_with_base (exec) failed";
     SetFootprintLimit(current_capacity_);
@@ -305,7 +323,13 @@ void JitMemoryRegion::SetFootprintLimit(size_t new_footprint) {
   DCHECK_EQ(data_space_footprint * kCodeAndDataCapacityDivider, new_footprint);
   if (HasCodeMapping()) {
     ScopedCodeCacheWrite scc(*this);
-    mspace_set_footprint_limit(exec_mspace_, new_footprint - data_space_footprint);
+    size_t exec_footprint = new_footprint - data_space_footprint;
+    if (baseline_exec_mspace_ != nullptr) {
+      size_t baseline_footprint = GetBaselineCodeFootprint(exec_footprint);
+      mspace_set_footprint_limit(baseline_exec_mspace_, baseline_footprint);
+      exec_footprint -= baseline_footprint;
+    }
+    mspace_set_footprint_limit(exec_mspace_, exec_footprint);
   }
 }
 
@@ -341,6 +365,11 @@ void* JitMemoryRegion::MoreCore(const void* mspace, intptr_t increment) NO_THREA
     void* result = code_pages->Begin() + exec_end_;
     exec_end_ += increment;
     return result;
+  } else if (baseline_exec_mspace_ != nullptr && mspace == baseline_exec_mspace_) {
+    const MemMap* const code_pages = GetUpdatableCodeMapping();
+    void* result = code_pages->Begin() + baseline_exec_begin_ + baseline_exec_end_;
+    baseline_exec_end_ += increment;
+    return result;
   } else {
     CHECK_EQ(data_mspace_, mspace);
     const MemMap* const writable_data_pages = GetWritableDataMapping();
@@ -354,8 +383,20 @@ const uint8_t* JitMemoryRegion::CommitCode(ArrayRef<const uint8_t> reserved_code
                                            ArrayRef<const uint8_t> code,
                                            const uint8_t* stack_map,
                                            bool has_should_deoptimize_flag) {
-  DCHECK(IsInExecSpace(reserved_code.data()));
   ScopedCodeCacheWrite scc(*this);
+  const uint8_t* result = WriteCode(reserved_code, code, stack_map, has_should_deoptimize_flag);
+  if (!FlushCode(result)) {
+    return nullptr;
+  }
+  SyncCores();
+  return result;
+}
+
+const uint8_t* JitMemoryRegion::WriteCode(ArrayRef<const uint8_t> reserved_code,
+                                          ArrayRef<const uint8_t> code,
+                                          const uint8_t* stack_map,
+                                          bool has_should_deoptimize_flag) {
+  DCHECK(IsInExecSpace(reserved_code.data()));
 
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
   size_t header_size = OatQuickMethodHeader::InstructionAlignedSize();
@@ -384,6 +425,16 @@ const uint8_t* JitMemoryRegion::CommitCode(ArrayRef<const uint8_t> reserved_code
   if (has_should_deoptimize_flag) {
     method_header->SetHasShouldDeoptimizeFlag();
   }
+  return result;
+}
+
+bool JitMemoryRegion::FlushCode(const uint8_t* code_ptr) {
+  size_t header_size = OatQuickMethodHeader::InstructionAlignedSize();
+  uint8_t* x_memory = const_cast<uint8_t*>(code_ptr) - header_size;
+  uint8_t* w_memory = const_cast<uint8_t*>(GetNonExecutableAddress(x_memory));
+  const OatQuickMethodHeader* method_header =
+      OatQuickMethodHeader::FromCodePointer(w_memory + header_size);
+  size_t total_size = header_size + method_header->GetCodeSize();
 
   // Both instruction and data caches need flushing to the point of unification where both share
   // a common view of memory. Flushing the data cache ensures the dirty cachelines from the
@@ -415,9 +466,12 @@ const uint8_t* JitMemoryRegion::CommitCode(ArrayRef<const uint8_t> reserved_code
   // correctness of the instructions present in the processor caches.
   if (!cache_flush_success) {
     PLOG(ERROR) << "Cache flush failed triggering code allocation failure";
-    return nullptr;
+    return false;
   }
+  return true;
+}
 
+void JitMemoryRegion::SyncCores() {
   // Ensure CPU instruction pipelines are flushed for all cores. This is necessary for
   // correctness as code may still be in instruction pipelines despite the i-cache flush. It is
   // not safe to assume that changing permissions with mprotect (RX->RWX->RX) will cause a TLB
@@ -428,8 +482,6 @@ const uint8_t* JitMemoryRegion::CommitCode(ArrayRef<const uint8_t> reserved_code
   // address this (see mbarrier(2)). The membarrier here will fail on prior kernels and on
   // platforms lacking the appropriate support.
   art::membarrier(art::MembarrierCommand::kPrivateExpeditedSyncCore);
-
-  return result;
 }
 
 static void FillRootTable(uint8_t* roots_data, const std::vector<Handle<mirror::Object>>& roots)
@@ -466,9 +518,19 @@ bool JitMemoryRegion::CommitData(ArrayRef<const uint8_t> reserved_data,
   return true;
 }
 
-const uint8_t* JitMemoryRegion::AllocateCode(size_t size) {
+const uint8_t* JitMemoryRegion::AllocateCode(size_t size, bool baseline) {
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
-  void* result = mspace_memalign(exec_mspace_, alignment, size);
+  void* mspace = exec_mspace_;
+  void* other_mspace = nullptr;
+  if (baseline_exec_mspace_ != nullptr) {
+    mspace = baseline ? baseline_exec_mspace_ : exec_mspace_;
+    other_mspace = baseline ? exec_mspace_ : baseline_exec_mspace_;
+  }
+  void* result = mspace_memalign(mspace, alignment, size);
+  if (UNLIKELY(result == nullptr) && other_mspace != nullptr) {
+    // Rather than collecting the code cache while the other segment has room.
+    result = mspace_memalign(other_mspace, alignment, size);
+  }
   if (UNLIKELY(result == nullptr)) {
     return nullptr;
   }
@@ -479,7 +541,15 @@ const uint8_t* JitMemoryRegion::AllocateCode(size_t size) {
 void JitMemoryRegion::FreeCode(const uint8_t* code) {
   code = GetNonExecutableAddress(code);
   used_memory_for_code_ -= mspace_usable_size(code);
-  mspace_free(exec_mspace_, const_cast<uint8_t*>(code));
+  mspace_free(GetExecMspaceFor(code), const_cast<uint8_t*>(code));
+}
+
+void* JitMemoryRegion::GetExecMspaceFor(const uint8_t* code) const {
+  if (baseline_exec_mspace_ != nullptr &&
+      code >= GetUpdatableCodeMapping()->Begin() + baseline_exec_begin_) {
+    return baseline_exec_mspace_;
+  }
+  return exec_mspace_;
 }
 
 const uint8_t* JitMemoryRegion::AllocateData(size_t data_size) {
@@ -63,12 +63,19 @@ class JitMemoryRegion {
         exec_pages_(),
         non_exec_pages_(),
         data_mspace_(nullptr),
-        exec_mspace_(nullptr) {}
-
+        exec_mspace_(nullptr),
+        baseline_exec_begin_(0),
+        baseline_exec_end_(0),
+        baseline_exec_mspace_(nullptr) {}
+
+  // If `segmented_code` is true, and the region is not the zygote's, baseline code is allocated
+  // in a separate segment at the end of the code space, so that the longer lived optimized code
+  // stays dense and the holes left by collected baseline code do not fragment it.
   bool Initialize(size_t initial_capacity,
                   size_t max_capacity,
                   bool rwx_memory_allowed,
                   bool is_zygote,
+                  bool segmented_code,
                   std::string* error_msg)
       REQUIRES(Locks::jit_lock_);
 
@@ -79,7 +86,9 @@ class JitMemoryRegion {
   // Set the footprint limit of the code cache.
   void SetFootprintLimit(size_t new_footprint) REQUIRES(Locks::jit_lock_);
 
-  const uint8_t* AllocateCode(size_t code_size) REQUIRES(Locks::jit_lock_);
+  // Allocate code, in the baseline segment if `baseline` and the region is segmented. Falls back
+  // to the other segment when one is full.
+  const uint8_t* AllocateCode(size_t code_size, bool baseline) REQUIRES(Locks::jit_lock_);
   void FreeCode(const uint8_t* code) REQUIRES(Locks::jit_lock_);
   const uint8_t* AllocateData(size_t data_size) REQUIRES(Locks::jit_lock_);
   void FreeData(const uint8_t* data) REQUIRES(Locks::jit_lock_);
@@ -94,6 +103,22 @@ class JitMemoryRegion {
                             bool has_should_deoptimize_flag)
       REQUIRES(Locks::jit_lock_);
 
+  // Same as CommitCode, but neither flushes the caches nor makes the code writable: the caller
+  // holds a ScopedCodeCacheWrite for the region, calls FlushCode for the returned code before it
+  // ends, then calls SyncCores. This lets several methods share one write window and one sync.
+  const uint8_t* WriteCode(ArrayRef<const uint8_t> reserved_code,
+                           ArrayRef<const uint8_t> code,
+                           const uint8_t* stack_map,
+                           bool has_should_deoptimize_flag)
+      REQUIRES(Locks::jit_lock_);
+
+  // Flush the caches for code emitted by WriteCode. Returns false if the flush failed, in which
+  // case the code must not be used.
+  bool FlushCode(const uint8_t* code_ptr) REQUIRES(Locks::jit_lock_);
+
+  // Flush the instruction pipelines of all cores, once flushed code is about to be used.
+  static void SyncCores();
+
   // Emit roots and stack map into the memory pointed by `roots_data` (despite it being const).
   bool CommitData(ArrayRef<const uint8_t> reserved_data,
                   const std::vector<Handle<mirror::Object>>& roots,
@@ -153,7 +178,9 @@ class JitMemoryRegion {
   void* MoreCore(const void* mspace, intptr_t increment);
 
   bool OwnsSpace(const void* mspace) const NO_THREAD_SAFETY_ANALYSIS {
-    return mspace == data_mspace_ || mspace == exec_mspace_;
+    return mspace == data_mspace_ ||
+        mspace == exec_mspace_ ||
+        (baseline_exec_mspace_ != nullptr && mspace == baseline_exec_mspace_);
   }
 
   size_t GetCurrentCapacity() const REQUIRES(Locks::jit_lock_) {
@@ -169,7 +196,11 @@ class JitMemoryRegion {
   }
 
   size_t GetResidentMemoryForCode() const REQUIRES(Locks::jit_lock_) {
-    return exec_end_;
+    return exec_end_ + baseline_exec_end_;
+  }
+
+  bool HasBaselineSegment() const REQUIRES(Locks::jit_lock_) {
+    return baseline_exec_mspace_ != nullptr;
   }
 
   size_t GetUsedMemoryForData() const REQUIRES(Locks::jit_lock_) {
@@ -234,6 +265,9 @@ class JitMemoryRegion {
     return TranslateAddress(src_ptr, exec_pages_, non_exec_pages_);
   }
 
+  // Returns the mspace that allocated `code`, given its non-executable address.
+  void* GetExecMspaceFor(const uint8_t* code) const REQUIRES(Locks::jit_lock_);
+
   static int CreateZygoteMemory(size_t capacity, std::string* error_msg);
   static bool ProtectZygoteMemory(int fd, std::string* error_msg);
 
@@ -278,6 +312,13 @@ class JitMemoryRegion {
   // The opaque mspace for allocating code.
   void* exec_mspace_ GUARDED_BY(Locks::jit_lock_);
 
+  // The offset in the code mapping of the baseline segment, and its footprint in bytes.
+  size_t baseline_exec_begin_ GUARDED_BY(Locks::jit_lock_);
+  size_t baseline_exec_end_ GUARDED_BY(Locks::jit_lock_);
+
+  // The opaque mspace for allocating baseline code, null if the region is not segmented.
+  void* baseline_exec_mspace_ GUARDED_BY(Locks::jit_lock_);
+
   friend class ScopedCodeCacheWrite;  // For GetUpdatableCodeMapping
   friend class TestZygoteMemory;
 };
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit_thread_pool.h"
+
+#include <algorithm>
+#include <ostream>
+
+#include "base/histogram-inl.h"
+#include "thread-current-inl.h"
+
+namespace art {
+namespace jit {
+
+static_assert(kNumberOfCompilationKinds == 4, "Update the wait time histograms");
+
+JitThreadPool::JitThreadPool(const char* name, size_t num_threads, bool create_peers)
+    : ThreadPool(name, num_threads, create_peers),
+      next_sequence_(0),
+      compile_tasks_taken_(0),
+      queue_depth_("JIT queue depth", 1),
+      wait_time_{{"JIT baseline task wait time", 100},
+                 {"JIT baseline-plus task wait time", 100},
+                 {"JIT optimized task wait time", 100},
+                 {"JIT osr task wait time", 100}},
+      merged_requests_(0),
+      aged_tasks_(0) {}
+
+JitThreadPool::~JitThreadPool() {
+  // The base class destructor no longer dispatches to the queue of this class, so the threads
+  // are stopped and the pending tasks deleted here.
+  DeleteThreads();
+  RemoveAllTasks(Thread::Current());
+}
+
+bool JitThreadPool::PriorityComparator::operator()(const CompileTaskEntry* lhs,
+                                                   const CompileTaskEntry* rhs) const {
+  size_t lhs_rank = GetRank(lhs->compilation_kind);
+  size_t rhs_rank = GetRank(rhs->compilation_kind);
+  if (lhs_rank != rhs_rank) {
+    return lhs_rank > rhs_rank;
+  }
+  if (lhs->samples != rhs->samples) {
+    return lhs->samples > rhs->samples;
+  }
+  return lhs->sequence < rhs->sequence;
+}
+
+size_t JitThreadPool::GetRank(CompilationKind compilation_kind) {
+  switch (compilation_kind) {
+    case CompilationKind::kOsr:
+      return 3u;
+    case CompilationKind::kOptimized:
+      return 2u;
+    case CompilationKind::kBaselinePlus:
+      return 1u;
+    case CompilationKind::kBaseline:
+      return 0u;
+  }
+}
+
+void JitThreadPool::AddCompileTask(Thread* self,
+                                   Task* task,
+                                   ArtMethod* method,
+                                   CompilationKind compilation_kind,
+                                   uint32_t samples) {
+  Task* dropped_task = nullptr;
+  {
+    MutexLock mu(self, task_queue_lock_);
+    MethodKey key = GetMethodKey(method, compilation_kind);
+    auto it = compile_tasks_.find(key);
+    if (it == compile_tasks_.end()) {
+      uint64_t sequence = next_sequence_++;
+      std::unique_ptr<CompileTaskEntry> entry(new CompileTaskEntry {
+          task, method, compilation_kind, samples, sequence, NanoTime() });
+      compile_tasks_by_priority_.insert(entry.get());
+      compile_tasks_by_sequence_.emplace(sequence, entry.get());
+      compile_tasks_.emplace(key, std::move(entry));
+    } else {
+      // Keep the task of the highest tier, at the position of the oldest request.
+      CompileTaskEntry* entry = it->second.get();
+      compile_tasks_by_priority_.erase(entry);
+      if (GetRank(compilation_kind) > GetRank(entry->compilation_kind)) {
+        dropped_task = entry->task;
+        entry->task = task;
+        entry->compilation_kind = compilation_kind;
+      } else {
+        dropped_task = task;
+      }
+      entry->samples = std::max(entry->samples, samples);
+      compile_tasks_by_priority_.insert(entry);
+      ++merged_requests_;
+    }
+    queue_depth_.AddValue(GetTaskCountLocked());
+    SignalTaskAddedLocked(self);
+  }
+  if (dropped_task != nullptr) {
+    dropped_task->Finalize();
+  }
+}
+
+bool JitThreadPool::IsCompilationPending(Thread* self,
+                                         ArtMethod* method,
+                                         CompilationKind compilation_kind,
+                                         uint32_t samples) {
+  MutexLock mu(self, task_queue_lock_);
+  auto it = compile_tasks_.find(GetMethodKey(method, compilation_kind));
+  if (it == compile_tasks_.end() ||
+      GetRank(it->second->compilation_kind) < GetRank(compilation_kind)) {
+    return false;
+  }
+  CompileTaskEntry* entry = it->second.get();
+  if (samples > entry->samples) {
+    compile_tasks_by_priority_.erase(entry);
+    entry->samples = samples;
+    compile_tasks_by_priority_.insert(entry);
+  }
+  ++merged_requests_;
+  return true;
+}
+
+void JitThreadPool::SetThreadCount(Thread* self, size_t num_threads) {
+  CHECK(threads_.empty());
+  CHECK_NE(num_threads, 0u);
+  MutexLock mu(self, task_queue_lock_);
+  max_active_workers_ = num_threads;
+}
+
+void JitThreadPool::PushTaskLocked(Task* task) {
+  fifo_tasks_.push_back(task);
+  queue_depth_.AddValue(GetTaskCountLocked());
+}
+
+Task* JitThreadPool::PopTaskLocked() {
+  if (!fifo_tasks_.empty()) {
+    Task* task = fifo_tasks_.front();
+    fifo_tasks_.pop_front();
+    return task;
+  }
+  DCHECK(!compile_tasks_by_priority_.empty());
+  CompileTaskEntry* entry = *compile_tasks_by_priority_.begin();
+  uint64_t now = NanoTime();
+  ++compile_tasks_taken_;
+  if (compile_tasks_taken_ % kAgingInterval == 0) {
+    CompileTaskEntry* oldest = compile_tasks_by_sequence_.begin()->second;
+    if (oldest != entry && now - oldest->enqueue_time_ns > kMaxWaitTimeNs) {
+      entry = oldest;
+      ++aged_tasks_;
+    }
+  }
+  wait_time_[static_cast<size_t>(entry->compilation_kind)].AdjustAndAddValue(
+      now - entry->enqueue_time_ns);
+  Task* task = entry->task;
+  RemoveEntryLocked(entry);
+  return task;
+}
+
+size_t JitThreadPool::GetTaskCountLocked() const {
+  return fifo_tasks_.size() + compile_tasks_.size();
+}
+
+void JitThreadPool::ClearTasksLocked() {
+  fifo_tasks_.clear();
+  compile_tasks_by_priority_.clear();
+  compile_tasks_by_sequence_.clear();
+  compile_tasks_.clear();
+}
+
+void JitThreadPool::RemoveEntryLocked(CompileTaskEntry* entry) {
+  compile_tasks_by_priority_.erase(entry);
+  compile_tasks_by_sequence_.erase(entry->sequence);
+  // Erasing from `compile_tasks_` deletes the entry.
+  compile_tasks_.erase(GetMethodKey(entry->method, entry->compilation_kind));
+}
+
+void JitThreadPool::DumpStatistics(std::ostream& os) {
+  MutexLock mu(Thread::Current(), task_queue_lock_);
+  os << "JIT pending tasks=" << GetTaskCountLocked()
+     << " merged requests=" << merged_requests_
+     << " aged tasks=" << aged_tasks_ << "\n";
+  if (queue_depth_.SampleSize() != 0) {
+    os << queue_depth_.Name() << ": Avg: " << queue_depth_.Mean()
+       << " Max: " << queue_depth_.Max() << "\n";
+  }
+  for (const Histogram<uint64_t>& wait_time : wait_time_) {
+    if (wait_time.SampleSize() != 0) {
+      Histogram<uint64_t>::CumulativeData data;
+      wait_time.CreateHistogram(&data);
+      wait_time.PrintConfidenceIntervals(os, 0.99, data);
+    }
+  }
+}
+
+}  // namespace jit
+}  // namespace art
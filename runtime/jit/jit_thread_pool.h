@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_JIT_JIT_THREAD_POOL_H_
+#define ART_RUNTIME_JIT_JIT_THREAD_POOL_H_
+
+#include <deque>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+
+#include "base/histogram.h"
+#include "base/time_utils.h"
+#include "compilation_kind.h"
+#include "thread_pool.h"
+
+namespace art {
+
+class ArtMethod;
+
+namespace jit {
+
+// The thread pool of the JIT. Compilation tasks added with AddCompileTask are run by priority
+// rather than in FIFO order: OSR first, then optimized, baseline-plus and baseline compilations,
+// and the hottest methods first within a tier. At most one compilation of each method is pending
+// for OSR, and one for the other tiers. Other tasks keep their FIFO order, and run before the
+// compilation tasks.
+class JitThreadPool : public ThreadPool {
+ public:
+  // Every kAgingInterval-th compilation task taken from the queue is the oldest one, if it has
+  // been waiting for more than kMaxWaitTimeNs, so that lukewarm methods still get compiled.
+  static constexpr size_t kAgingInterval = 4;
+  static constexpr uint64_t kMaxWaitTimeNs = MsToNs(1000);
+
+  JitThreadPool(const char* name, size_t num_threads, bool create_peers = false);
+  ~JitThreadPool() override;
+
+  // Add a task compiling `method`, whose hotness is `samples`. If a compilation of `method` is
+  // already pending, the two are merged into the task of the highest tier, and the other task is
+  // finalized.
+  void AddCompileTask(Thread* self,
+                      Task* task,
+                      ArtMethod* method,
+                      CompilationKind compilation_kind,
+                      uint32_t samples) REQUIRES(!task_queue_lock_);
+
+  // Returns whether a compilation of `method`, to `compilation_kind` or a higher tier, is pending.
+  // Updates the hotness of the pending compilation to `samples`.
+  bool IsCompilationPending(Thread* self,
+                            ArtMethod* method,
+                            CompilationKind compilation_kind,
+                            uint32_t samples) REQUIRES(!task_queue_lock_);
+
+  // Set the number of worker threads of the next CreateThreads, when there are no threads.
+  void SetThreadCount(Thread* self, size_t num_threads) REQUIRES(!task_queue_lock_);
+
+  // Dump the queue depth and the wait times of the compilation tasks.
+  void DumpStatistics(std::ostream& os) REQUIRES(!task_queue_lock_);
+
+ protected:
+  void PushTaskLocked(Task* task) override REQUIRES(task_queue_lock_);
+  Task* PopTaskLocked() override REQUIRES(task_queue_lock_);
+  size_t GetTaskCountLocked() const override REQUIRES(task_queue_lock_);
+  void ClearTasksLocked() override REQUIRES(task_queue_lock_);
+
+ private:
+  struct CompileTaskEntry {
+    Task* task;
+    ArtMethod* method;
+    CompilationKind compilation_kind;
+    uint32_t samples;
+    // Order of the first request among the pending compilation tasks, and its time.
+    uint64_t sequence;
+    uint64_t enqueue_time_ns;
+  };
+
+  // Orders the entries with the highest priority first.
+  struct PriorityComparator {
+    bool operator()(const CompileTaskEntry* lhs, const CompileTaskEntry* rhs) const;
+  };
+
+  // The key under which duplicate requests are merged: OSR code is separate from the entry
+  // point code of the other tiers.
+  using MethodKey = std::pair<ArtMethod*, bool>;
+
+  static MethodKey GetMethodKey(ArtMethod* method, CompilationKind compilation_kind) {
+    return MethodKey(method, compilation_kind == CompilationKind::kOsr);
+  }
+
+  // Rank of a tier, OSR compilations having the highest rank.
+  static size_t GetRank(CompilationKind compilation_kind);
+
+  void RemoveEntryLocked(CompileTaskEntry* entry) REQUIRES(task_queue_lock_);
+
+  // Pending tasks other than compilations, which keep their FIFO order.
+  std::deque<Task*> fifo_tasks_ GUARDED_BY(task_queue_lock_);
+  std::map<MethodKey, std::unique_ptr<CompileTaskEntry>> compile_tasks_
+      GUARDED_BY(task_queue_lock_);
+  std::set<CompileTaskEntry*, PriorityComparator> compile_tasks_by_priority_
+      GUARDED_BY(task_queue_lock_);
+  std::map<uint64_t, CompileTaskEntry*> compile_tasks_by_sequence_ GUARDED_BY(task_queue_lock_);
+  uint64_t next_sequence_ GUARDED_BY(task_queue_lock_);
+  size_t compile_tasks_taken_ GUARDED_BY(task_queue_lock_);
+
+  // Statistics.
+  Histogram<uint64_t> queue_depth_ GUARDED_BY(task_queue_lock_);
+  Histogram<uint64_t> wait_time_[kNumberOfCompilationKinds] GUARDED_BY(task_queue_lock_);
+  uint64_t merged_requests_ GUARDED_BY(task_queue_lock_);
+  uint64_t aged_tasks_ GUARDED_BY(task_queue_lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(JitThreadPool);
+};
+
+}  // namespace jit
+}  // namespace art
+
+#endif  // ART_RUNTIME_JIT_JIT_THREAD_POOL_H_
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit/jit_thread_pool.h"
+
+#include <vector>
+
+#include "common_runtime_test.h"
+#include "runtime_globals.h"
+#include "thread-inl.h"
+
+namespace art {
+namespace jit {
+
+// A task recording its id when run. The tasks are run by a single worker, and the ids are read
+// after waiting for the pool.
+class RecordTask : public Task {
+ public:
+  RecordTask(int id, std::vector<int>* run_ids, size_t* finalized)
+      : id_(id), run_ids_(run_ids), finalized_(finalized) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) override {
+    run_ids_->push_back(id_);
+  }
+
+  void Finalize() override {
+    ++*finalized_;
+    delete this;
+  }
+
+ private:
+  const int id_;
+  std::vector<int>* const run_ids_;
+  size_t* const finalized_;
+};
+
+class JitThreadPoolTest : public CommonRuntimeTest {
+ protected:
+  static ArtMethod* FakeMethod(uintptr_t index) {
+    return reinterpret_cast<ArtMethod*>(index * kObjectAlignment);
+  }
+};
+
+TEST_F(JitThreadPoolTest, RunsByPriority) {
+  Thread* self = Thread::Current();
+  JitThreadPool pool("JIT thread pool test", 1);
+  std::vector<int> run_ids;
+  size_t finalized = 0;
+  pool.AddCompileTask(self,
+                      new RecordTask(1, &run_ids, &finalized),
+                      FakeMethod(1),
+                      CompilationKind::kBaseline,
+                      /* samples= */ 10);
+  pool.AddCompileTask(self,
+                      new RecordTask(2, &run_ids, &finalized),
+                      FakeMethod(2),
+                      CompilationKind::kOptimized,
+                      /* samples= */ 5);
+  pool.AddCompileTask(self,
+                      new RecordTask(3, &run_ids, &finalized),
+                      FakeMethod(3),
+                      CompilationKind::kOsr,
+                      /* samples= */ 1);
+  pool.AddCompileTask(self,
+                      new RecordTask(4, &run_ids, &finalized),
+                      FakeMethod(4),
+                      CompilationKind::kBaseline,
+                      /* samples= */ 20);
+  // Tasks other than compilations run first.
+  pool.AddTask(self, new RecordTask(5, &run_ids, &finalized));
+  EXPECT_EQ(5u, pool.GetTaskCount(self));
+  pool.StartWorkers(self);
+  pool.Wait(self, /* do_work= */ false, /* may_hold_locks= */ false);
+  EXPECT_EQ((std::vector<int>{5, 3, 2, 4, 1}), run_ids);
+  EXPECT_EQ(5u, finalized);
+}
+
+TEST_F(JitThreadPoolTest, MergesDuplicateRequests) {
+  Thread* self = Thread::Current();
+  JitThreadPool pool("JIT thread pool test", 1);
+  std::vector<int> run_ids;
+  size_t finalized = 0;
+  pool.AddCompileTask(self,
+                      new RecordTask(1, &run_ids, &finalized),
+                      FakeMethod(1),
+                      CompilationKind::kBaseline,
+                      /* samples= */ 10);
+  pool.AddCompileTask(self,
+                      new RecordTask(2, &run_ids, &finalized),
+                      FakeMethod(1),
+                      CompilationKind::kOptimized,
+                      /* samples= */ 10);
+  // The baseline task is replaced by the optimized one.
+  EXPECT_EQ(1u, finalized);
+  pool.AddCompileTask(self,
+                      new RecordTask(3, &run_ids, &finalized),
+                      FakeMethod(1),
+                      CompilationKind::kBaseline,
+                      /* samples= */ 10);
+  // The new baseline task is dropped.
+  EXPECT_EQ(2u, finalized);
+  EXPECT_EQ(1u, pool.GetTaskCount(self));
+
+  EXPECT_TRUE(pool.IsCompilationPending(self, FakeMethod(1), CompilationKind::kBaselinePlus, 10));
+  EXPECT_TRUE(pool.IsCompilationPending(self, FakeMethod(1), CompilationKind::kOptimized, 10));
+  // OSR compilations are not merged with the other tiers.
+  EXPECT_FALSE(pool.IsCompilationPending(self, FakeMethod(1), CompilationKind::kOsr, 10));
+  EXPECT_FALSE(pool.IsCompilationPending(self, FakeMethod(2), CompilationKind::kBaseline, 10));
+
+  pool.StartWorkers(self);
+  pool.Wait(self, /* do_work= */ false, /* may_hold_locks= */ false);
+  EXPECT_EQ((std::vector<int>{2}), run_ids);
+  EXPECT_EQ(3u, finalized);
+  EXPECT_FALSE(pool.IsCompilationPending(self, FakeMethod(1), CompilationKind::kBaseline, 10));
+}
+
+}  // namespace jit
+}  // namespace art
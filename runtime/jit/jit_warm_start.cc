@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit_warm_start.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <android-base/file.h>
+#include <android-base/stringprintf.h>
+#include "zlib.h"
+
+namespace art {
+namespace jit {
+
+using android::base::StringPrintf;
+
+static constexpr char kWarmStartMagic[] = { 'j', 'w', 's', '\n' };
+static constexpr char kWarmStartVersion[] = { '0', '0', '1', '\0' };
+// Magic, version, payload size and payload checksum.
+static constexpr size_t kWarmStartHeaderSize =
+    sizeof(kWarmStartMagic) + sizeof(kWarmStartVersion) + 2 * sizeof(uint32_t);
+
+static void AppendU32(std::string* out, uint32_t value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static bool ReadU32(const std::string& in, size_t* pos, uint32_t* value) {
+  if (in.size() - *pos < sizeof(*value)) {
+    return false;
+  }
+  memcpy(value, in.data() + *pos, sizeof(*value));
+  *pos += sizeof(*value);
+  return true;
+}
+
+static uint32_t ComputeChecksum(const char* data, size_t size) {
+  uint32_t checksum = adler32(0L, Z_NULL, 0);
+  return adler32(checksum, reinterpret_cast<const Bytef*>(data), size);
+}
+
+void JitWarmStartInfo::AddMethod(const std::string& dex_location,
+                                 uint32_t dex_checksum,
+                                 uint32_t method_idx) {
+  auto it = dex_files_.find(dex_location);
+  if (it == dex_files_.end()) {
+    it = dex_files_.emplace(dex_location, DexFileMethods { dex_checksum, {} }).first;
+  } else if (it->second.checksum != dex_checksum) {
+    it->second.checksum = dex_checksum;
+    it->second.methods.clear();
+  }
+  it->second.methods.insert(method_idx);
+}
+
+const std::set<uint32_t>* JitWarmStartInfo::GetMethods(const std::string& dex_location,
+                                                       uint32_t dex_checksum) const {
+  auto it = dex_files_.find(dex_location);
+  if (it == dex_files_.end() || it->second.checksum != dex_checksum) {
+    return nullptr;
+  }
+  return &it->second.methods;
+}
+
+size_t JitWarmStartInfo::GetNumberOfMethods() const {
+  size_t count = 0u;
+  for (const auto& entry : dex_files_) {
+    count += entry.second.methods.size();
+  }
+  return count;
+}
+
+bool JitWarmStartInfo::Load(const std::string& filename, std::string* error_msg) {
+  dex_files_.clear();
+  std::string contents;
+  if (!android::base::ReadFileToString(filename, &contents)) {
+    *error_msg = StringPrintf("Could not read %s: %s", filename.c_str(), strerror(errno));
+    return false;
+  }
+  if (contents.size() < kWarmStartHeaderSize ||
+      memcmp(contents.data(), kWarmStartMagic, sizeof(kWarmStartMagic)) != 0 ||
+      memcmp(contents.data() + sizeof(kWarmStartMagic),
+             kWarmStartVersion,
+             sizeof(kWarmStartVersion)) != 0) {
+    *error_msg = StringPrintf("Invalid header in %s", filename.c_str());
+    return false;
+  }
+  size_t pos = sizeof(kWarmStartMagic) + sizeof(kWarmStartVersion);
+  uint32_t payload_size;
+  uint32_t payload_checksum;
+  ReadU32(contents, &pos, &payload_size);
+  ReadU32(contents, &pos, &payload_checksum);
+  if (contents.size() - pos != payload_size ||
+      ComputeChecksum(contents.data() + pos, payload_size) != payload_checksum) {
+    *error_msg = StringPrintf("Corrupted contents in %s", filename.c_str());
+    return false;
+  }
+
+  uint32_t number_of_dex_files;
+  bool valid = ReadU32(contents, &pos, &number_of_dex_files);
+  for (uint32_t i = 0; valid && i != number_of_dex_files; ++i) {
+    uint32_t location_size;
+    uint32_t dex_checksum;
+    uint32_t number_of_methods;
+    valid = ReadU32(contents, &pos, &location_size) && contents.size() - pos >= location_size;
+    if (!valid) {
+      break;
+    }
+    std::string location = contents.substr(pos, location_size);
+    pos += location_size;
+    valid = ReadU32(contents, &pos, &dex_checksum) && ReadU32(contents, &pos, &number_of_methods);
+    DexFileMethods& methods = dex_files_[location];
+    methods.checksum = dex_checksum;
+    for (uint32_t j = 0; valid && j != number_of_methods; ++j) {
+      uint32_t method_idx;
+      valid = ReadU32(contents, &pos, &method_idx);
+      methods.methods.insert(method_idx);
+    }
+  }
+  if (!valid || pos != contents.size()) {
+    dex_files_.clear();
+    *error_msg = StringPrintf("Truncated contents in %s", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool JitWarmStartInfo::Save(const std::string& filename, std::string* error_msg) const {
+  std::string payload;
+  AppendU32(&payload, dex_files_.size());
+  for (const auto& entry : dex_files_) {
+    AppendU32(&payload, entry.first.size());
+    payload.append(entry.first);
+    AppendU32(&payload, entry.second.checksum);
+    AppendU32(&payload, entry.second.methods.size());
+    for (uint32_t method_idx : entry.second.methods) {
+      AppendU32(&payload, method_idx);
+    }
+  }
+  std::string contents(kWarmStartMagic, sizeof(kWarmStartMagic));
+  contents.append(kWarmStartVersion, sizeof(kWarmStartVersion));
+  AppendU32(&contents, payload.size());
+  AppendU32(&contents, ComputeChecksum(payload.data(), payload.size()));
+  contents.append(payload);
+
+  // Write to a temporary file first, so that a process starting meanwhile sees either the old or
+  // the new contents.
+  std::string temp_filename = filename + ".tmp";
+  if (!android::base::WriteStringToFile(contents, temp_filename)) {
+    *error_msg = StringPrintf("Could not write %s: %s", temp_filename.c_str(), strerror(errno));
+    unlink(temp_filename.c_str());
+    return false;
+  }
+  if (rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    *error_msg = StringPrintf("Could not rename %s: %s", temp_filename.c_str(), strerror(errno));
+    unlink(temp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace jit
+}  // namespace art
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_JIT_JIT_WARM_START_H_
+#define ART_RUNTIME_JIT_JIT_WARM_START_H_
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "base/macros.h"
+
+namespace art {
+namespace jit {
+
+// The methods a process compiled with the optimizing JIT, saved with -Xjitwarmstartfile so that
+// the next run of the process compiles them from startup rather than once they are hot again.
+//
+// Methods are identified by dex file location, dex checksum and method index. The entries of a
+// dex file are ignored once its checksum changes, and the whole file is rejected if its header
+// or checksum do not match. The compiled code itself is not saved: it embeds ArtMethod and
+// object addresses of the process, and its class hierarchy assumptions are best checked again
+// by compiling in the new process.
+class JitWarmStartInfo {
+ public:
+  JitWarmStartInfo() {}
+
+  // Record a method of the dex file at `dex_location`. Forgets the methods recorded for a
+  // different checksum of that dex file.
+  void AddMethod(const std::string& dex_location, uint32_t dex_checksum, uint32_t method_idx);
+
+  // Returns the methods recorded for the dex file, or null if it has none or they were recorded
+  // for another checksum.
+  const std::set<uint32_t>* GetMethods(const std::string& dex_location,
+                                       uint32_t dex_checksum) const;
+
+  size_t GetNumberOfMethods() const;
+
+  // Replace the contents with those of `filename`. Returns false, with no methods recorded, if
+  // the file cannot be read or is not a valid warm start file.
+  bool Load(const std::string& filename, std::string* error_msg);
+
+  // Write the recorded methods to `filename`, atomically replacing it.
+  bool Save(const std::string& filename, std::string* error_msg) const;
+
+ private:
+  struct DexFileMethods {
+    uint32_t checksum;
+    std::set<uint32_t> methods;
+  };
+
+  std::map<std::string, DexFileMethods> dex_files_;
+
+  DISALLOW_COPY_AND_ASSIGN(JitWarmStartInfo);
+};
+
+}  // namespace jit
+}  // namespace art
+
+#endif  // ART_RUNTIME_JIT_JIT_WARM_START_H_
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit/jit_warm_start.h"
+
+#include <android-base/file.h>
+
+#include "base/common_art_test.h"
+
+namespace art {
+namespace jit {
+
+class JitWarmStartTest : public CommonArtTest {};
+
+TEST_F(JitWarmStartTest, SaveAndLoad) {
+  ScratchFile file;
+  JitWarmStartInfo info;
+  info.AddMethod("/data/app/base.apk", 0x1234u, 3u);
+  info.AddMethod("/data/app/base.apk", 0x1234u, 7u);
+  info.AddMethod("/data/app/base.apk!classes2.dex", 0x5678u, 1u);
+  std::string error_msg;
+  ASSERT_TRUE(info.Save(file.GetFilename(), &error_msg)) << error_msg;
+
+  JitWarmStartInfo loaded;
+  ASSERT_TRUE(loaded.Load(file.GetFilename(), &error_msg)) << error_msg;
+  EXPECT_EQ(3u, loaded.GetNumberOfMethods());
+  const std::set<uint32_t>* methods = loaded.GetMethods("/data/app/base.apk", 0x1234u);
+  ASSERT_TRUE(methods != nullptr);
+  EXPECT_EQ((std::set<uint32_t>{3u, 7u}), *methods);
+  methods = loaded.GetMethods("/data/app/base.apk!classes2.dex", 0x5678u);
+  ASSERT_TRUE(methods != nullptr);
+  EXPECT_EQ((std::set<uint32_t>{1u}), *methods);
+  EXPECT_TRUE(loaded.GetMethods("/data/app/other.apk", 0x1234u) == nullptr);
+}
+
+TEST_F(JitWarmStartTest, RejectsStaleDexFile) {
+  JitWarmStartInfo info;
+  info.AddMethod("/data/app/base.apk", 0x1234u, 3u);
+  EXPECT_TRUE(info.GetMethods("/data/app/base.apk", 0x4321u) == nullptr);
+  // Recording a method of the new dex file forgets the methods of the old one.
+  info.AddMethod("/data/app/base.apk", 0x4321u, 5u);
+  EXPECT_TRUE(info.GetMethods("/data/app/base.apk", 0x1234u) == nullptr);
+  const std::set<uint32_t>* methods = info.GetMethods("/data/app/base.apk", 0x4321u);
+  ASSERT_TRUE(methods != nullptr);
+  EXPECT_EQ((std::set<uint32_t>{5u}), *methods);
+}
+
+TEST_F(JitWarmStartTest, RejectsCorruptedFile) {
+  ScratchFile file;
+  JitWarmStartInfo info;
+  info.AddMethod("/data/app/base.apk", 0x1234u, 3u);
+  std::string error_msg;
+  ASSERT_TRUE(info.Save(file.GetFilename(), &error_msg)) << error_msg;
+
+  std::string contents;
+  ASSERT_TRUE(android::base::ReadFileToString(file.GetFilename(), &contents));
+  contents[contents.size() - 1] ^= 1;
+  ASSERT_TRUE(android::base::WriteStringToFile(contents, file.GetFilename()));
+  JitWarmStartInfo corrupted;
+  EXPECT_FALSE(corrupted.Load(file.GetFilename(), &error_msg));
+  EXPECT_EQ(0u, corrupted.GetNumberOfMethods());
+
+  ASSERT_TRUE(android::base::WriteStringToFile(contents.substr(0, 10), file.GetFilename()));
+  JitWarmStartInfo truncated;
+  EXPECT_FALSE(truncated.Load(file.GetFilename(), &error_msg));
+  EXPECT_EQ(0u, truncated.GetNumberOfMethods());
+}
+
+}  // namespace jit
+}  // namespace art
@@ -511,6 +511,19 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods(bool startup) {
                  << PrettyDuration(NanoTime() - start_time);
 }
 
+bool ProfileSaver::GetProfileFileStamp(const std::string& filename,
+                                       /*out*/ProfileFileStamp* stamp) {
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0) {
+    return false;
+  }
+  stamp->device = st.st_dev;
+  stamp->inode = st.st_ino;
+  stamp->size = st.st_size;
+  stamp->mtime = st.st_mtime;
+  return true;
+}
+
 bool ProfileSaver::ProcessProfilingInfo(bool force_save, /*out*/uint16_t* number_of_new_methods) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
 
@@ -553,11 +566,33 @@ bool ProfileSaver::ProcessProfilingInfo(bool force_save, /*out*/uint16_t* number
       total_number_of_code_cache_queries_++;
     }
     {
-      ProfileCompilationInfo info(Runtime::Current()->GetArenaPool());
-      if (!info.Load(filename, /*clear_if_invalid=*/ true)) {
-        LOG(WARNING) << "Could not forcefully load profile " << filename;
-        continue;
+      // Reuse the profile we last saved if the file still holds it, otherwise load the file.
+      std::unique_ptr<ProfileCompilationInfo> info_holder;
+      uint64_t last_save_number_of_methods = 0u;
+      uint64_t last_save_number_of_classes = 0u;
+      ProfileFileStamp stamp;
+      auto saved_profile_it = saved_profiles_.find(filename);
+      if (saved_profile_it != saved_profiles_.end() &&
+          GetProfileFileStamp(filename, &stamp) &&
+          stamp == saved_profile_it->second.stamp) {
+        info_holder = std::move(saved_profile_it->second.info);
+        last_save_number_of_methods = saved_profile_it->second.number_of_methods;
+        last_save_number_of_classes = saved_profile_it->second.number_of_classes;
+        saved_profiles_.erase(saved_profile_it);
+      } else {
+        if (saved_profile_it != saved_profiles_.end()) {
+          VLOG(profiler) << "Profile " << filename << " changed since the last save";
+          saved_profiles_.erase(saved_profile_it);
+        }
+        info_holder.reset(new ProfileCompilationInfo(Runtime::Current()->GetArenaPool()));
+        if (!info_holder->Load(filename, /*clear_if_invalid=*/ true)) {
+          LOG(WARNING) << "Could not forcefully load profile " << filename;
+          continue;
+        }
+        last_save_number_of_methods = info_holder->GetNumberOfMethods();
+        last_save_number_of_classes = info_holder->GetNumberOfResolvedClasses();
       }
+      ProfileCompilationInfo& info = *info_holder;
       if (options_.GetProfileBootClassPath() != info.IsForBootImage()) {
         // If we enabled boot class path profiling but the profile is a regular one,
         // (or the opposite), clear the profile. We do not support cross-version merges.
@@ -567,8 +602,6 @@ bool ProfileSaver::ProcessProfilingInfo(bool force_save, /*out*/uint16_t* number
         // For saving to ensure we persist the new version.
         force_save = true;
       }
-      uint64_t last_save_number_of_methods = info.GetNumberOfMethods();
-      uint64_t last_save_number_of_classes = info.GetNumberOfResolvedClasses();
       VLOG(profiler) << "last_save_number_of_methods=" << last_save_number_of_methods
                      << " last_save_number_of_classes=" << last_save_number_of_classes
                      << " number of profiled methods=" << profile_methods.size();
@@ -612,6 +645,14 @@ bool ProfileSaver::ProcessProfilingInfo(bool force_save, /*out*/uint16_t* number
                        << " Number of methods: " << delta_number_of_methods
                        << " Number of classes: " << delta_number_of_classes;
         total_number_of_skipped_writes_++;
+        // Keep the merged data for the next attempt, the file still holds the old counts.
+        if (GetProfileFileStamp(filename, &stamp)) {
+          saved_profiles_.Put(filename,
+                              SavedProfile{std::move(info_holder),
+                                           stamp,
+                                           last_save_number_of_methods,
+                                           last_save_number_of_classes});
+        }
         continue;
       }
 
@@ -630,6 +671,15 @@ bool ProfileSaver::ProcessProfilingInfo(bool force_save, /*out*/uint16_t* number
           profile_cache_.erase(profile_cache_it);
           delete cached_info;
         }
+        if (GetProfileFileStamp(filename, &stamp)) {
+          uint64_t number_of_methods = info.GetNumberOfMethods();
+          uint64_t number_of_classes = info.GetNumberOfResolvedClasses();
+          saved_profiles_.Put(filename,
+                              SavedProfile{std::move(info_holder),
+                                           stamp,
+                                           number_of_methods,
+                                           number_of_classes});
+        }
         if (bytes_written > 0) {
           total_number_of_writes_++;
           total_bytes_written_ += bytes_written;
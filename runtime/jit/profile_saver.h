@@ -17,6 +17,10 @@
 #ifndef ART_RUNTIME_JIT_PROFILE_SAVER_H_
 #define ART_RUNTIME_JIT_PROFILE_SAVER_H_
 
+#include <sys/types.h>
+
+#include <memory>
+
 #include "base/mutex.h"
 #include "base/safe_map.h"
 #include "dex/method_reference.h"
@@ -102,6 +106,32 @@ class ProfileSaver {
   // and put the result in tracked_dex_base_locations_.
   void ResolveTrackedLocations() REQUIRES(!Locks::profiler_lock_);
 
+  // The identity of a profile file, used to detect that the file was written by someone else.
+  struct ProfileFileStamp {
+    bool operator==(const ProfileFileStamp& other) const {
+      return device == other.device &&
+          inode == other.inode &&
+          size == other.size &&
+          mtime == other.mtime;
+    }
+
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    time_t mtime;
+  };
+
+  // A profile as last saved to its file by this saver.
+  struct SavedProfile {
+    std::unique_ptr<ProfileCompilationInfo> info;
+    ProfileFileStamp stamp;
+    uint64_t number_of_methods;
+    uint64_t number_of_classes;
+  };
+
+  // Returns false if the file cannot be stat'd.
+  static bool GetProfileFileStamp(const std::string& filename, /*out*/ProfileFileStamp* stamp);
+
   // Get the profile metadata that should be associated with the profile session during the current
   // profile saver session.
   ProfileCompilationInfo::ProfileSampleAnnotation GetProfileSampleAnnotation();
@@ -138,6 +168,11 @@ class ProfileSaver {
   // to just a few hundreds entries in the ProfileCompilationInfo objects.
   SafeMap<std::string, ProfileCompilationInfo*> profile_cache_;
 
+  // Maps each tracked file to the profile this saver last wrote to it. As long as the file was
+  // not modified since, the next save merges into this profile instead of loading and inflating
+  // the file again.
+  SafeMap<std::string, SavedProfile> saved_profiles_;
+
   // Save period condition support.
   Mutex wait_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   ConditionVariable period_condition_ GUARDED_BY(wait_lock_);
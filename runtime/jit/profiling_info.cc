@@ -16,6 +16,9 @@
 
 #include "profiling_info.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "art_method-inl.h"
 #include "dex/dex_instruction.h"
 #include "jit/jit.h"
@@ -25,11 +28,14 @@
 
 namespace art {
 
-ProfilingInfo::ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries)
+ProfilingInfo::ProfilingInfo(ArtMethod* method,
+                             const std::vector<uint32_t>& entries,
+                             const std::vector<uint32_t>& branch_cache_entries)
       : baseline_hotness_count_(0),
         method_(method),
         saved_entry_point_(nullptr),
         number_of_inline_caches_(entries.size()),
+        number_of_branch_caches_(branch_cache_entries.size()),
         current_inline_uses_(0),
         is_method_being_compiled_(false),
         is_osr_method_being_compiled_(false) {
@@ -37,6 +43,11 @@ ProfilingInfo::ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& ent
   for (size_t i = 0; i < number_of_inline_caches_; ++i) {
     cache_[i].dex_pc_ = entries[i];
   }
+  BranchCache* branch_caches = GetBranchCaches();
+  memset(branch_caches, 0, number_of_branch_caches_ * sizeof(BranchCache));
+  for (size_t i = 0; i < number_of_branch_caches_; ++i) {
+    branch_caches[i].dex_pc_ = branch_cache_entries[i];
+  }
 }
 
 bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocation) {
@@ -45,6 +56,7 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
   DCHECK(!method->IsNative());
 
   std::vector<uint32_t> entries;
+  std::vector<uint32_t> branch_cache_entries;
   for (const DexInstructionPcPair& inst : method->DexInstructions()) {
     switch (inst->Opcode()) {
       case Instruction::INVOKE_VIRTUAL:
@@ -56,6 +68,21 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
         entries.push_back(inst.DexPc());
         break;
 
+      case Instruction::IF_EQ:
+      case Instruction::IF_NE:
+      case Instruction::IF_LT:
+      case Instruction::IF_GE:
+      case Instruction::IF_GT:
+      case Instruction::IF_LE:
+      case Instruction::IF_EQZ:
+      case Instruction::IF_NEZ:
+      case Instruction::IF_LTZ:
+      case Instruction::IF_GEZ:
+      case Instruction::IF_GTZ:
+      case Instruction::IF_LEZ:
+        branch_cache_entries.push_back(inst.DexPc());
+        break;
+
       default:
         break;
     }
@@ -66,7 +93,8 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
 
   // Allocate the `ProfilingInfo` object int the JIT's data space.
   jit::JitCodeCache* code_cache = Runtime::Current()->GetJit()->GetCodeCache();
-  return code_cache->AddProfilingInfo(self, method, entries, retry_allocation) != nullptr;
+  return code_cache->AddProfilingInfo(
+      self, method, entries, branch_cache_entries, retry_allocation) != nullptr;
 }
 
 InlineCache* ProfilingInfo::GetInlineCache(uint32_t dex_pc) {
@@ -80,13 +108,32 @@ InlineCache* ProfilingInfo::GetInlineCache(uint32_t dex_pc) {
   UNREACHABLE();
 }
 
+BranchCache* ProfilingInfo::GetBranchCache(uint32_t dex_pc) {
+  // The dex pcs are sorted, as they were recorded in the order of the dex instructions.
+  BranchCache* branch_caches = GetBranchCaches();
+  BranchCache* end = branch_caches + number_of_branch_caches_;
+  BranchCache* it = std::lower_bound(
+      branch_caches, end, dex_pc, [](const BranchCache& cache, uint32_t pc) {
+        return cache.dex_pc_ < pc;
+      });
+  return (it != end && it->dex_pc_ == dex_pc) ? it : nullptr;
+}
+
+static void IncrementInlineCacheCount(uint16_t* count) {
+  // Like the counts updated by compiled code, the increment is racy and saturating.
+  if (*count != std::numeric_limits<uint16_t>::max()) {
+    ++*count;
+  }
+}
+
 void ProfilingInfo::AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls) {
   InlineCache* cache = GetInlineCache(dex_pc);
   for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
     mirror::Class* existing = cache->classes_[i].Read<kWithoutReadBarrier>();
     mirror::Class* marked = ReadBarrier::IsMarked(existing);
     if (marked == cls) {
-      // Receiver type is already in the cache, nothing else to do.
+      // Receiver type is already in the cache, only count the call.
+      IncrementInlineCacheCount(&cache->counts_[i]);
       return;
     } else if (marked == nullptr) {
       // Cache entry is empty, try to put `cls` in it.
@@ -101,13 +148,16 @@ void ProfilingInfo::AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls) {
         // entry in case the entry contains `cls`.
         --i;
       } else {
-        // We successfully set `cls`, just return.
+        // We successfully set `cls`, count the call and return.
+        IncrementInlineCacheCount(&cache->counts_[i]);
         return;
       }
     }
   }
   // Unsuccessfull - cache is full, making it megamorphic. We do not DCHECK it though,
-  // as the garbage collector might clear the entries concurrently.
+  // as the garbage collector might clear the entries concurrently. The last entry counts the
+  // calls with receivers not in the cache.
+  IncrementInlineCacheCount(&cache->counts_[InlineCache::kIndividualCacheSize - 1]);
 }
 
 }  // namespace art
@@ -38,6 +38,9 @@ class Class;
 
 // Structure to store the classes seen at runtime for a specific instruction.
 // Once the classes_ array is full, we consider the INVOKE to be megamorphic.
+// Each class has a saturating count of the calls seen with it as receiver. Once the cache is
+// megamorphic, the last entry holds the latest receiver not in the other entries, and its count
+// is the number of calls with any such receiver.
 class InlineCache {
  public:
   // This is hard coded in the assembly stub art_quick_update_inline_cache.
@@ -47,9 +50,14 @@ class InlineCache {
     return MemberOffset(OFFSETOF_MEMBER(InlineCache, classes_));
   }
 
+  static constexpr MemberOffset CountsOffset() {
+    return MemberOffset(OFFSETOF_MEMBER(InlineCache, counts_));
+  }
+
  private:
   uint32_t dex_pc_;
   GcRoot<mirror::Class> classes_[kIndividualCacheSize];
+  uint16_t counts_[kIndividualCacheSize];
 
   friend class jit::JitCodeCache;
   friend class ProfilingInfo;
@@ -57,6 +65,40 @@ class InlineCache {
   DISALLOW_COPY_AND_ASSIGN(InlineCache);
 };
 
+// Structure to store the number of times a conditional branch was not taken and taken, indexed
+// by the value of the condition. Counters saturate at the maximum value of uint16_t.
+class BranchCache {
+ public:
+  static constexpr MemberOffset FalseOffset() {
+    return MemberOffset(OFFSETOF_MEMBER(BranchCache, false_));
+  }
+
+  static constexpr MemberOffset TrueOffset() {
+    return MemberOffset(OFFSETOF_MEMBER(BranchCache, true_));
+  }
+
+  uint32_t GetDexPc() const {
+    return dex_pc_;
+  }
+
+  uint16_t GetFalse() const {
+    return false_;
+  }
+
+  uint16_t GetTrue() const {
+    return true_;
+  }
+
+ private:
+  uint32_t dex_pc_;
+  uint16_t false_;
+  uint16_t true_;
+
+  friend class ProfilingInfo;
+
+  DISALLOW_COPY_AND_ASSIGN(BranchCache);
+};
+
 /**
  * Profiling info for a method, created and filled by the interpreter once the
  * method is warm, and used by the compiler to drive optimizations.
@@ -83,6 +125,9 @@ class ProfilingInfo {
   InlineCache* GetInlineCache(uint32_t dex_pc)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Returns the branch cache of the `if` instruction at `dex_pc`, or null if there is none.
+  BranchCache* GetBranchCache(uint32_t dex_pc);
+
   bool IsMethodBeingCompiled(bool osr) const {
     return osr
         ? is_osr_method_being_compiled_
@@ -139,7 +184,13 @@ class ProfilingInfo {
   }
 
  private:
-  ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries);
+  ProfilingInfo(ArtMethod* method,
+                const std::vector<uint32_t>& entries,
+                const std::vector<uint32_t>& branch_cache_entries);
+
+  BranchCache* GetBranchCaches() {
+    return reinterpret_cast<BranchCache*>(&cache_[number_of_inline_caches_]);
+  }
 
   // Hotness count for methods compiled with the JIT baseline compiler. Once
   // a threshold is hit (currentily the maximum value of uint16_t), we will
@@ -157,6 +208,7 @@ class ProfilingInfo {
 
   // Number of instructions we are profiling in the ArtMethod.
   const uint32_t number_of_inline_caches_;
+  const uint32_t number_of_branch_caches_;
 
   // When the compiler inlines the method associated to this ProfilingInfo,
   // it updates this counter so that the GC does not try to clear the inline caches.
@@ -168,7 +220,8 @@ class ProfilingInfo {
   bool is_method_being_compiled_;
   bool is_osr_method_being_compiled_;
 
-  // Dynamically allocated array of size `number_of_inline_caches_`.
+  // Dynamically allocated array of size `number_of_inline_caches_`, followed by an array of
+  // `number_of_branch_caches_` BranchCache.
   InlineCache cache_[0];
 
   friend class jit::JitCodeCache;
@@ -17,6 +17,7 @@
 #include "java_vm_ext.h"
 
 #include <dlfcn.h>
+#include <string.h>
 #include <string_view>
 
 #include "android-base/stringprintf.h"
@@ -63,6 +64,11 @@ static constexpr size_t kGlobalsMax = 51200;  // Arbitrary sanity check. (Must f
 
 static constexpr size_t kWeakGlobalsMax = 51200;  // Arbitrary sanity check. (Must fit in 16 bits.)
 
+// The limits above are for all the shards together.
+static_assert(kGlobalsMax % IndirectReferenceTable::kMaxShards == 0u, "Unexpected globals max");
+static_assert(kWeakGlobalsMax % IndirectReferenceTable::kMaxShards == 0u,
+              "Unexpected weak globals max");
+
 bool JavaVMExt::IsBadJniVersion(int version) {
   // We don't support JNI_VERSION_1_1. These are the only other valid versions.
   return version != JNI_VERSION_1_2 && version != JNI_VERSION_1_4 && version != JNI_VERSION_1_6;
@@ -178,7 +184,8 @@ class SharedLibrary {
       REQUIRES(!Locks::mutator_lock_) {
     CHECK(NeedsNativeBridge());
 
-    uint32_t len = 0;
+    // Pass the shorty length so that the native bridge does not need to measure it again.
+    uint32_t len = (shorty != nullptr) ? strlen(shorty) : 0u;
     return android::NativeBridgeGetTrampoline(handle_, symbol_name.c_str(), shorty, len);
   }
 
@@ -272,7 +279,6 @@ class Libraries {
       REQUIRES(!Locks::jni_libraries_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     std::string jni_short_name(m->JniShortName());
-    std::string jni_long_name(m->JniLongName());
     const ObjPtr<mirror::ClassLoader> declaring_class_loader =
         m->GetDeclaringClass()->GetClassLoader();
     ScopedObjectAccessUnchecked soa(Thread::Current());
@@ -287,7 +293,19 @@ class Libraries {
       void* native_code = FindNativeMethodInternal(self,
                                                    declaring_class_loader_allocator,
                                                    shorty,
-                                                   jni_short_name,
+                                                   jni_short_name);
+      if (native_code != nullptr) {
+        return native_code;
+      }
+    }
+    // The long name is only needed for overloaded native methods, so only pay for mangling the
+    // signature once no library of the class loader exports the short name.
+    std::string jni_long_name(m->JniLongName());
+    {
+      ScopedThreadSuspension sts(self, kNative);
+      void* native_code = FindNativeMethodInternal(self,
+                                                   declaring_class_loader_allocator,
+                                                   shorty,
                                                    jni_long_name);
       if (native_code != nullptr) {
         return native_code;
@@ -302,8 +320,7 @@ class Libraries {
   void* FindNativeMethodInternal(Thread* self,
                                  void* declaring_class_loader_allocator,
                                  const char* shorty,
-                                 const std::string& jni_short_name,
-                                 const std::string& jni_long_name)
+                                 const std::string& jni_name)
       REQUIRES(!Locks::jni_libraries_lock_)
       REQUIRES(!Locks::mutator_lock_) {
     MutexLock mu(self, *Locks::jni_libraries_lock_);
@@ -314,14 +331,10 @@ class Libraries {
         // We only search libraries loaded by the appropriate ClassLoader.
         continue;
       }
-      // Try the short name then the long name...
       const char* arg_shorty = library->NeedsNativeBridge() ? shorty : nullptr;
-      void* fn = library->FindSymbol(jni_short_name, arg_shorty);
-      if (fn == nullptr) {
-        fn = library->FindSymbol(jni_long_name, arg_shorty);
-      }
+      void* fn = library->FindSymbol(jni_name, arg_shorty);
       if (fn != nullptr) {
-        VLOG(jni) << "[Found native code for " << jni_long_name
+        VLOG(jni) << "[Found native code for " << jni_name
                   << " in \"" << library->GetPath() << "\"]";
         return fn;
       }
@@ -485,6 +498,21 @@ const JNIInvokeInterface gJniInvokeInterface = {
   JII::AttachCurrentThreadAsDaemon
 };
 
+JavaVMExt::GlobalsShard::GlobalsShard(uint32_t shard, size_t max_count, std::string* error_msg)
+    : lock("JNI global reference table lock", kJniGlobalsLock),
+      table(max_count, kGlobal, IndirectReferenceTable::ResizableCapacity::kNo, error_msg, shard) {}
+
+JavaVMExt::WeakGlobalsShard::WeakGlobalsShard(uint32_t shard,
+                                              size_t max_count,
+                                              std::string* error_msg)
+    : lock("JNI weak global reference table lock", kJniWeakGlobalsLock),
+      table(max_count,
+            kWeakGlobal,
+            IndirectReferenceTable::ResizableCapacity::kNo,
+            error_msg,
+            shard),
+      add_condition("weak globals add condition", lock) {}
+
 JavaVMExt::JavaVMExt(Runtime* runtime,
                      const RuntimeArgumentMap& runtime_options,
                      std::string* error_msg)
@@ -496,23 +524,20 @@ JavaVMExt::JavaVMExt(Runtime* runtime,
       tracing_enabled_(runtime_options.Exists(RuntimeArgumentMap::JniTrace)
                        || VLOG_IS_ON(third_party_jni)),
       trace_(runtime_options.GetOrDefault(RuntimeArgumentMap::JniTrace)),
-      globals_(kGlobalsMax, kGlobal, IndirectReferenceTable::ResizableCapacity::kNo, error_msg),
       libraries_(new Libraries),
       unchecked_functions_(&gJniInvokeInterface),
-      weak_globals_(kWeakGlobalsMax,
-                    kWeakGlobal,
-                    IndirectReferenceTable::ResizableCapacity::kNo,
-                    error_msg),
       allow_accessing_weak_globals_(true),
-      weak_globals_add_condition_("weak globals add condition",
-                                  (CHECK(Locks::jni_weak_globals_lock_ != nullptr),
-                                   *Locks::jni_weak_globals_lock_)),
       env_hooks_(),
       enable_allocation_tracking_delta_(
           runtime_options.GetOrDefault(RuntimeArgumentMap::GlobalRefAllocStackTraceLimit)),
       allocation_tracking_enabled_(false),
       old_allocation_tracking_state_(false) {
   functions = unchecked_functions_;
+  for (size_t i = 0; i != kNumGlobalsShards; ++i) {
+    globals_[i].reset(new GlobalsShard(i, kGlobalsMax / kNumGlobalsShards, error_msg));
+    weak_globals_[i].reset(
+        new WeakGlobalsShard(i, kWeakGlobalsMax / kNumGlobalsShards, error_msg));
+  }
   SetCheckJniEnabled(runtime_options.Exists(RuntimeArgumentMap::CheckJni));
 }
 
@@ -527,10 +552,15 @@ std::unique_ptr<JavaVMExt> JavaVMExt::Create(Runtime* runtime,
                                              const RuntimeArgumentMap& runtime_options,
                                              std::string* error_msg) NO_THREAD_SAFETY_ANALYSIS {
   std::unique_ptr<JavaVMExt> java_vm(new JavaVMExt(runtime, runtime_options, error_msg));
-  if (java_vm && java_vm->globals_.IsValid() && java_vm->weak_globals_.IsValid()) {
-    return java_vm;
+  if (java_vm == nullptr) {
+    return nullptr;
   }
-  return nullptr;
+  for (size_t i = 0; i != kNumGlobalsShards; ++i) {
+    if (!java_vm->globals_[i]->table.IsValid() || !java_vm->weak_globals_[i]->table.IsValid()) {
+      return nullptr;
+    }
+  }
+  return java_vm;
 }
 
 jint JavaVMExt::HandleGetEnv(/*out*/void** env, jint version) {
@@ -629,7 +659,10 @@ void JavaVMExt::CheckGlobalRefAllocationTracking() {
   if (LIKELY(enable_allocation_tracking_delta_ == 0)) {
     return;
   }
-  size_t simple_free_capacity = globals_.FreeCapacity();
+  size_t simple_free_capacity = 0u;
+  for (const std::unique_ptr<GlobalsShard>& shard : globals_) {
+    simple_free_capacity += shard->table.FreeCapacity();
+  }
   if (UNLIKELY(simple_free_capacity <= enable_allocation_tracking_delta_)) {
     if (!allocation_tracking_enabled_) {
       LOG(WARNING) << "Global reference storage appears close to exhaustion, program termination "
@@ -663,11 +696,19 @@ jobject JavaVMExt::AddGlobalRef(Thread* self, ObjPtr<mirror::Object> obj) {
   if (obj == nullptr) {
     return nullptr;
   }
-  IndirectRef ref;
+  IndirectRef ref = nullptr;
   std::string error_msg;
-  {
-    WriterMutexLock mu(self, *Locks::jni_globals_lock_);
-    ref = globals_.Add(kIRTFirstSegment, obj, &error_msg);
+  size_t preferred_shard = GetPreferredShard(self);
+  for (size_t i = 0; i != kNumGlobalsShards && ref == nullptr; ++i) {
+    GlobalsShard& shard = *globals_[(preferred_shard + i) % kNumGlobalsShards];
+    WriterMutexLock mu(self, shard.lock);
+    // Only fail in the preferred shard once all of them are full.
+    if (shard.table.FreeCapacity() != 0u || i == kNumGlobalsShards - 1u) {
+      ref = shard.table.Add(kIRTFirstSegment, obj, &error_msg);
+      if (ref == nullptr) {
+        break;
+      }
+    }
   }
   if (UNLIKELY(ref == nullptr)) {
     LOG(FATAL) << error_msg;
@@ -681,18 +722,27 @@ jweak JavaVMExt::AddWeakGlobalRef(Thread* self, ObjPtr<mirror::Object> obj) {
   if (obj == nullptr) {
     return nullptr;
   }
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  // CMS needs this to block for concurrent reference processing because an object allocated during
-  // the GC won't be marked and concurrent reference processing would incorrectly clear the JNI weak
-  // ref. But CC (kUseReadBarrier == true) doesn't because of the to-space invariant.
-  while (!kUseReadBarrier && UNLIKELY(!MayAccessWeakGlobals(self))) {
-    // Check and run the empty checkpoint before blocking so the empty checkpoint will work in the
-    // presence of threads blocking for weak ref access.
-    self->CheckEmptyCheckpointFromWeakRefAccess(Locks::jni_weak_globals_lock_);
-    weak_globals_add_condition_.WaitHoldingLocks(self);
-  }
+  IndirectRef ref = nullptr;
   std::string error_msg;
-  IndirectRef ref = weak_globals_.Add(kIRTFirstSegment, obj, &error_msg);
+  size_t preferred_shard = GetPreferredShard(self);
+  for (size_t i = 0; i != kNumGlobalsShards && ref == nullptr; ++i) {
+    WeakGlobalsShard& shard = *weak_globals_[(preferred_shard + i) % kNumGlobalsShards];
+    MutexLock mu(self, shard.lock);
+    // CMS needs this to block for concurrent reference processing because an object allocated
+    // during the GC won't be marked and concurrent reference processing would incorrectly clear
+    // the JNI weak ref. But CC (kUseReadBarrier == true) doesn't because of the to-space
+    // invariant.
+    if (!kUseReadBarrier) {
+      WaitForWeakGlobalsAccess(self, shard);
+    }
+    // Only fail in the preferred shard once all of them are full.
+    if (shard.table.FreeCapacity() != 0u || i == kNumGlobalsShards - 1u) {
+      ref = shard.table.Add(kIRTFirstSegment, obj, &error_msg);
+      if (ref == nullptr) {
+        break;
+      }
+    }
+  }
   if (UNLIKELY(ref == nullptr)) {
     LOG(FATAL) << error_msg;
     UNREACHABLE();
@@ -705,8 +755,9 @@ void JavaVMExt::DeleteGlobalRef(Thread* self, jobject obj) {
     return;
   }
   {
-    WriterMutexLock mu(self, *Locks::jni_globals_lock_);
-    if (!globals_.Remove(kIRTFirstSegment, obj)) {
+    GlobalsShard& shard = GetGlobalsShard(obj);
+    WriterMutexLock mu(self, shard.lock);
+    if (!shard.table.Remove(kIRTFirstSegment, obj)) {
       LOG(WARNING) << "JNI WARNING: DeleteGlobalRef(" << obj << ") "
                    << "failed to find entry";
     }
@@ -718,8 +769,9 @@ void JavaVMExt::DeleteWeakGlobalRef(Thread* self, jweak obj) {
   if (obj == nullptr) {
     return;
   }
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  if (!weak_globals_.Remove(kIRTFirstSegment, obj)) {
+  WeakGlobalsShard& shard = GetWeakGlobalsShard(obj);
+  MutexLock mu(self, shard.lock);
+  if (!shard.table.Remove(kIRTFirstSegment, obj)) {
     LOG(WARNING) << "JNI WARNING: DeleteWeakGlobalRef(" << obj << ") "
                  << "failed to find entry";
   }
@@ -745,15 +797,19 @@ void JavaVMExt::DumpForSigQuit(std::ostream& os) {
     os << " (with forcecopy)";
   }
   Thread* self = Thread::Current();
-  {
-    ReaderMutexLock mu(self, *Locks::jni_globals_lock_);
-    os << "; globals=" << globals_.Capacity();
+  size_t globals = 0u;
+  for (const std::unique_ptr<GlobalsShard>& shard : globals_) {
+    ReaderMutexLock mu(self, shard->lock);
+    globals += shard->table.Capacity();
   }
-  {
-    MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-    if (weak_globals_.Capacity() > 0) {
-      os << " (plus " << weak_globals_.Capacity() << " weak)";
-    }
+  os << "; globals=" << globals;
+  size_t weak_globals = 0u;
+  for (const std::unique_ptr<WeakGlobalsShard>& shard : weak_globals_) {
+    MutexLock mu(self, shard->lock);
+    weak_globals += shard->table.Capacity();
+  }
+  if (weak_globals > 0) {
+    os << " (plus " << weak_globals << " weak)";
   }
   os << '\n';
 
@@ -766,7 +822,6 @@ void JavaVMExt::DumpForSigQuit(std::ostream& os) {
 void JavaVMExt::DisallowNewWeakGlobals() {
   CHECK(!kUseReadBarrier);
   Thread* const self = Thread::Current();
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
   // DisallowNewWeakGlobals is only called by CMS during the pause. It is required to have the
   // mutator lock exclusively held so that we don't have any threads in the middle of
   // DecodeWeakGlobal.
@@ -776,25 +831,30 @@ void JavaVMExt::DisallowNewWeakGlobals() {
 
 void JavaVMExt::AllowNewWeakGlobals() {
   CHECK(!kUseReadBarrier);
-  Thread* self = Thread::Current();
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
   allow_accessing_weak_globals_.store(true, std::memory_order_seq_cst);
-  weak_globals_add_condition_.Broadcast(self);
+  BroadcastForNewWeakGlobals();
 }
 
 void JavaVMExt::BroadcastForNewWeakGlobals() {
   Thread* self = Thread::Current();
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  weak_globals_add_condition_.Broadcast(self);
+  for (const std::unique_ptr<WeakGlobalsShard>& shard : weak_globals_) {
+    MutexLock mu(self, shard->lock);
+    shard->add_condition.Broadcast(self);
+  }
+}
+
+size_t JavaVMExt::GetPreferredShard(Thread* self) {
+  return self->GetThreadId() % kNumGlobalsShards;
 }
 
 ObjPtr<mirror::Object> JavaVMExt::DecodeGlobal(IndirectRef ref) {
-  return globals_.SynchronizedGet(ref);
+  return GetGlobalsShard(ref).table.SynchronizedGet(ref);
 }
 
 void JavaVMExt::UpdateGlobal(Thread* self, IndirectRef ref, ObjPtr<mirror::Object> result) {
-  WriterMutexLock mu(self, *Locks::jni_globals_lock_);
-  globals_.Update(ref, result);
+  GlobalsShard& shard = GetGlobalsShard(ref);
+  WriterMutexLock mu(self, shard.lock);
+  shard.table.Update(ref, result);
 }
 
 inline bool JavaVMExt::MayAccessWeakGlobals(Thread* self) const {
@@ -816,24 +876,31 @@ ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobal(Thread* self, IndirectRef ref
   // case, it may be racy, this is benign since DecodeWeakGlobalLocked does the correct behavior
   // if MayAccessWeakGlobals is false.
   DCHECK_EQ(IndirectReferenceTable::GetIndirectRefKind(ref), kWeakGlobal);
+  WeakGlobalsShard& shard = GetWeakGlobalsShard(ref);
   if (LIKELY(MayAccessWeakGlobalsUnlocked(self))) {
-    return weak_globals_.SynchronizedGet(ref);
+    return shard.table.SynchronizedGet(ref);
   }
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  return DecodeWeakGlobalLocked(self, ref);
+  MutexLock mu(self, shard.lock);
+  return DecodeWeakGlobalLocked(self, shard, ref);
 }
 
-ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobalLocked(Thread* self, IndirectRef ref) {
+ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobalLocked(Thread* self,
+                                                         WeakGlobalsShard& shard,
+                                                         IndirectRef ref) {
   if (kDebugLocking) {
-    Locks::jni_weak_globals_lock_->AssertHeld(self);
+    shard.lock.AssertHeld(self);
   }
+  WaitForWeakGlobalsAccess(self, shard);
+  return shard.table.Get(ref);
+}
+
+void JavaVMExt::WaitForWeakGlobalsAccess(Thread* self, WeakGlobalsShard& shard) {
   while (UNLIKELY(!MayAccessWeakGlobals(self))) {
     // Check and run the empty checkpoint before blocking so the empty checkpoint will work in the
     // presence of threads blocking for weak ref access.
-    self->CheckEmptyCheckpointFromWeakRefAccess(Locks::jni_weak_globals_lock_);
-    weak_globals_add_condition_.WaitHoldingLocks(self);
+    self->CheckEmptyCheckpointFromWeakRefAccess(&shard.lock);
+    shard.add_condition.WaitHoldingLocks(self);
   }
-  return weak_globals_.Get(ref);
 }
 
 ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobalDuringShutdown(Thread* self, IndirectRef ref) {
@@ -846,39 +913,37 @@ ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobalDuringShutdown(Thread* self, I
   if (!kUseReadBarrier) {
     DCHECK(allow_accessing_weak_globals_.load(std::memory_order_seq_cst));
   }
-  return weak_globals_.SynchronizedGet(ref);
+  return GetWeakGlobalsShard(ref).table.SynchronizedGet(ref);
 }
 
 bool JavaVMExt::IsWeakGlobalCleared(Thread* self, IndirectRef ref) {
   DCHECK_EQ(IndirectReferenceTable::GetIndirectRefKind(ref), kWeakGlobal);
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  while (UNLIKELY(!MayAccessWeakGlobals(self))) {
-    // Check and run the empty checkpoint before blocking so the empty checkpoint will work in the
-    // presence of threads blocking for weak ref access.
-    self->CheckEmptyCheckpointFromWeakRefAccess(Locks::jni_weak_globals_lock_);
-    weak_globals_add_condition_.WaitHoldingLocks(self);
-  }
+  WeakGlobalsShard& shard = GetWeakGlobalsShard(ref);
+  MutexLock mu(self, shard.lock);
+  WaitForWeakGlobalsAccess(self, shard);
   // When just checking a weak ref has been cleared, avoid triggering the read barrier in decode
   // (DecodeWeakGlobal) so that we won't accidentally mark the object alive. Since the cleared
   // sentinel is a non-moving object, we can compare the ref to it without the read barrier and
   // decide if it's cleared.
-  return Runtime::Current()->IsClearedJniWeakGlobal(weak_globals_.Get<kWithoutReadBarrier>(ref));
+  return Runtime::Current()->IsClearedJniWeakGlobal(
+      shard.table.Get<kWithoutReadBarrier>(ref));
 }
 
 void JavaVMExt::UpdateWeakGlobal(Thread* self, IndirectRef ref, ObjPtr<mirror::Object> result) {
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  weak_globals_.Update(ref, result);
+  WeakGlobalsShard& shard = GetWeakGlobalsShard(ref);
+  MutexLock mu(self, shard.lock);
+  shard.table.Update(ref, result);
 }
 
 void JavaVMExt::DumpReferenceTables(std::ostream& os) {
   Thread* self = Thread::Current();
-  {
-    ReaderMutexLock mu(self, *Locks::jni_globals_lock_);
-    globals_.Dump(os);
+  for (const std::unique_ptr<GlobalsShard>& shard : globals_) {
+    ReaderMutexLock mu(self, shard->lock);
+    shard->table.Dump(os);
   }
-  {
-    MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-    weak_globals_.Dump(os);
+  for (const std::unique_ptr<WeakGlobalsShard>& shard : weak_globals_) {
+    MutexLock mu(self, shard->lock);
+    shard->table.Dump(os);
   }
 }
 
@@ -1150,31 +1215,40 @@ void* JavaVMExt::FindCodeForNativeMethod(ArtMethod* m) {
 }
 
 void JavaVMExt::SweepJniWeakGlobals(IsMarkedVisitor* visitor) {
-  MutexLock mu(Thread::Current(), *Locks::jni_weak_globals_lock_);
+  Thread* self = Thread::Current();
   Runtime* const runtime = Runtime::Current();
-  for (auto* entry : weak_globals_) {
-    // Need to skip null here to distinguish between null entries and cleared weak ref entries.
-    if (!entry->IsNull()) {
-      // Since this is called by the GC, we don't need a read barrier.
-      mirror::Object* obj = entry->Read<kWithoutReadBarrier>();
-      mirror::Object* new_obj = visitor->IsMarked(obj);
-      if (new_obj == nullptr) {
-        new_obj = runtime->GetClearedJniWeakGlobal();
+  for (const std::unique_ptr<WeakGlobalsShard>& shard : weak_globals_) {
+    MutexLock mu(self, shard->lock);
+    for (auto* entry : shard->table) {
+      // Need to skip null here to distinguish between null entries and cleared weak ref entries.
+      if (!entry->IsNull()) {
+        // Since this is called by the GC, we don't need a read barrier.
+        mirror::Object* obj = entry->Read<kWithoutReadBarrier>();
+        mirror::Object* new_obj = visitor->IsMarked(obj);
+        if (new_obj == nullptr) {
+          new_obj = runtime->GetClearedJniWeakGlobal();
+        }
+        *entry = GcRoot<mirror::Object>(new_obj);
       }
-      *entry = GcRoot<mirror::Object>(new_obj);
     }
   }
 }
 
 void JavaVMExt::TrimGlobals() {
-  WriterMutexLock mu(Thread::Current(), *Locks::jni_globals_lock_);
-  globals_.Trim();
+  Thread* self = Thread::Current();
+  for (const std::unique_ptr<GlobalsShard>& shard : globals_) {
+    WriterMutexLock mu(self, shard->lock);
+    shard->table.Trim();
+  }
 }
 
 void JavaVMExt::VisitRoots(RootVisitor* visitor) {
   Thread* self = Thread::Current();
-  ReaderMutexLock mu(self, *Locks::jni_globals_lock_);
-  globals_.VisitRoots(visitor, RootInfo(kRootJNIGlobal));
+  // Each shard is visited under its own lock, threads may keep adding to the other shards.
+  for (const std::unique_ptr<GlobalsShard>& shard : globals_) {
+    ReaderMutexLock mu(self, shard->lock);
+    shard->table.VisitRoots(visitor, RootInfo(kRootJNIGlobal));
+  }
   // The weak_globals table is visited by the GC itself (because it mutates the table).
 }
 
@@ -19,6 +19,9 @@
 
 #include "jni.h"
 
+#include <array>
+#include <memory>
+
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "indirect_reference_table.h"
@@ -122,82 +125,61 @@ class JavaVMExt : public JavaVM {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   void DumpForSigQuit(std::ostream& os)
-      REQUIRES(!Locks::jni_libraries_lock_,
-               !Locks::jni_globals_lock_,
-               !Locks::jni_weak_globals_lock_);
+      REQUIRES(!Locks::jni_libraries_lock_);
 
   void DumpReferenceTables(std::ostream& os)
       REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_globals_lock_,
-               !Locks::jni_weak_globals_lock_,
-               !Locks::alloc_tracker_lock_);
+      REQUIRES(!Locks::alloc_tracker_lock_);
 
   bool SetCheckJniEnabled(bool enabled);
 
-  void VisitRoots(RootVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_globals_lock_);
+  void VisitRoots(RootVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
 
   void DisallowNewWeakGlobals()
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void AllowNewWeakGlobals()
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
-  void BroadcastForNewWeakGlobals()
-      REQUIRES(!Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  void BroadcastForNewWeakGlobals();
 
   jobject AddGlobalRef(Thread* self, ObjPtr<mirror::Object> obj)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   jweak AddWeakGlobalRef(Thread* self, ObjPtr<mirror::Object> obj)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
-  void DeleteGlobalRef(Thread* self, jobject obj) REQUIRES(!Locks::jni_globals_lock_);
+  void DeleteGlobalRef(Thread* self, jobject obj);
 
-  void DeleteWeakGlobalRef(Thread* self, jweak obj) REQUIRES(!Locks::jni_weak_globals_lock_);
+  void DeleteWeakGlobalRef(Thread* self, jweak obj);
 
   void SweepJniWeakGlobals(IsMarkedVisitor* visitor)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   ObjPtr<mirror::Object> DecodeGlobal(IndirectRef ref)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   void UpdateGlobal(Thread* self, IndirectRef ref, ObjPtr<mirror::Object> result)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   ObjPtr<mirror::Object> DecodeWeakGlobal(Thread* self, IndirectRef ref)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
-
-  ObjPtr<mirror::Object> DecodeWeakGlobalLocked(Thread* self, IndirectRef ref)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Like DecodeWeakGlobal() but to be used only during a runtime shutdown where self may be
   // null.
   ObjPtr<mirror::Object> DecodeWeakGlobalDuringShutdown(Thread* self, IndirectRef ref)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Checks if the weak global ref has been cleared by the GC without decode (read barrier.)
   bool IsWeakGlobalCleared(Thread* self, IndirectRef ref)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   void UpdateWeakGlobal(Thread* self, IndirectRef ref, ObjPtr<mirror::Object> result)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   const JNIInvokeInterface* GetUncheckedFunctions() const {
     return unchecked_functions_;
   }
 
-  void TrimGlobals() REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_globals_lock_);
+  void TrimGlobals() REQUIRES_SHARED(Locks::mutator_lock_);
 
   jint HandleGetEnv(/*out*/void** env, jint version);
 
@@ -215,11 +197,56 @@ class JavaVMExt : public JavaVM {
   // an erroneous state, and the result needs to be checked.
   JavaVMExt(Runtime* runtime, const RuntimeArgumentMap& runtime_options, std::string* error_msg);
 
+  // The global and weak global references are split into shards, each with its own table and
+  // lock, so that threads adding and deleting references do not all serialize on one lock. A
+  // thread adds to the shard of its thread id, unless that one is full, and the shard is encoded
+  // in the references so that decoding stays O(1).
+  static constexpr size_t kNumGlobalsShards = IndirectReferenceTable::kMaxShards;
+
+  struct GlobalsShard {
+    GlobalsShard(uint32_t shard, size_t max_count, std::string* error_msg);
+
+    ReaderWriterMutex lock;
+    // Not guarded by `lock` since we sometimes use SynchronizedGet in Thread::DecodeJObject.
+    IndirectReferenceTable table;
+  };
+
+  struct WeakGlobalsShard {
+    WeakGlobalsShard(uint32_t shard, size_t max_count, std::string* error_msg);
+
+    Mutex lock;
+    // Since the table contains weak roots, be careful not to directly access the object
+    // references in it. Use Get() with the read barrier enabled.
+    // Not guarded by `lock` since we may use SynchronizedGet in DecodeWeakGlobal.
+    IndirectReferenceTable table;
+    ConditionVariable add_condition GUARDED_BY(lock);
+  };
+
+  GlobalsShard& GetGlobalsShard(IndirectRef ref) const {
+    return *globals_[IndirectReferenceTable::GetShard(ref)];
+  }
+
+  WeakGlobalsShard& GetWeakGlobalsShard(IndirectRef ref) const {
+    return *weak_globals_[IndirectReferenceTable::GetShard(ref)];
+  }
+
+  // Returns the shard `self` adds its references to while it is not full.
+  static size_t GetPreferredShard(Thread* self);
+
+  ObjPtr<mirror::Object> DecodeWeakGlobalLocked(Thread* self,
+                                                WeakGlobalsShard& shard,
+                                                IndirectRef ref)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(shard.lock);
+
+  // Waits on the condition of `shard` until `self` may access weak globals.
+  void WaitForWeakGlobalsAccess(Thread* self, WeakGlobalsShard& shard)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(shard.lock);
+
   // Return true if self can currently access weak globals.
   bool MayAccessWeakGlobalsUnlocked(Thread* self) const REQUIRES_SHARED(Locks::mutator_lock_);
-  bool MayAccessWeakGlobals(Thread* self) const
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(Locks::jni_weak_globals_lock_);
+  bool MayAccessWeakGlobals(Thread* self) const REQUIRES_SHARED(Locks::mutator_lock_);
 
   void CheckGlobalRefAllocationTracking();
 
@@ -237,8 +264,7 @@ class JavaVMExt : public JavaVM {
   // Extra diagnostics.
   const std::string trace_;
 
-  // Not guarded by globals_lock since we sometimes use SynchronizedGet in Thread::DecodeJObject.
-  IndirectReferenceTable globals_;
+  std::array<std::unique_ptr<GlobalsShard>, kNumGlobalsShards> globals_;
 
   // No lock annotation since UnloadNativeLibraries is called on libraries_ but locks the
   // jni_libraries_lock_ internally.
@@ -247,14 +273,9 @@ class JavaVMExt : public JavaVM {
   // Used by -Xcheck:jni.
   const JNIInvokeInterface* const unchecked_functions_;
 
-  // Since weak_globals_ contain weak roots, be careful not to
-  // directly access the object references in it. Use Get() with the
-  // read barrier enabled.
-  // Not guarded by weak_globals_lock since we may use SynchronizedGet in DecodeWeakGlobal.
-  IndirectReferenceTable weak_globals_;
-  // Not guarded by weak_globals_lock since we may use SynchronizedGet in DecodeWeakGlobal.
+  std::array<std::unique_ptr<WeakGlobalsShard>, kNumGlobalsShards> weak_globals_;
+  // Not guarded by the weak globals locks since we may use SynchronizedGet in DecodeWeakGlobal.
   Atomic<bool> allow_accessing_weak_globals_;
-  ConditionVariable weak_globals_add_condition_ GUARDED_BY(Locks::jni_weak_globals_lock_);
 
   // TODO Maybe move this to Runtime.
   std::vector<GetEnvHook> env_hooks_;
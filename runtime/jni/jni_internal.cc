@@ -100,10 +100,11 @@ size_t VisitModifiedUtf8Chars(const char* utf8, size_t byte_count, GoodFunc good
   while (utf8 != end) {
     int ic = *utf8;
     if (LIKELY((ic & 0x80) == 0)) {
-      // One-byte encoding.
-      good(utf8, 1u);
-      utf8 += 1u;
-      len += 1u;
+      // One-byte encoding, process the whole run of them.
+      size_t ascii_length = CountModifiedUtf8AsciiPrefix(utf8, end - utf8);
+      good(utf8, ascii_length);
+      utf8 += ascii_length;
+      len += ascii_length;
       continue;
     }
     auto is_ascii = [utf8]() {
@@ -1972,8 +1973,9 @@ class JNI {
     } else {
       CHECK_NON_NULL_MEMCPY_ARGUMENT(length, buf);
       if (s->IsCompressed()) {
+        const uint8_t* chars = s->GetValueCompressed();
         for (int i = 0; i < length; ++i) {
-          buf[i] = static_cast<jchar>(s->CharAt(start+i));
+          buf[i] = static_cast<jchar>(chars[start + i]);
         }
       } else {
         const jchar* chars = static_cast<jchar*>(s->GetValue());
@@ -1992,9 +1994,8 @@ class JNI {
     } else {
       CHECK_NON_NULL_MEMCPY_ARGUMENT(length, buf);
       if (s->IsCompressed()) {
-        for (int i = 0; i < length; ++i) {
-          buf[i] = s->CharAt(start+i);
-        }
+        // Compressed strings are ASCII, which is its own modified UTF-8 encoding.
+        memcpy(buf, s->GetValueCompressed() + start, length);
       } else {
         const jchar* chars = s->GetValue();
         size_t bytes = CountUtf8Bytes(chars + start, length);
@@ -2046,13 +2047,7 @@ class JNI {
     if (heap->IsMovableObject(s)) {
       StackHandleScope<1> hs(soa.Self());
       HandleWrapperObjPtr<mirror::String> h(hs.NewHandleWrapper(&s));
-      if (!kUseReadBarrier) {
-        heap->IncrementDisableMovingGC(soa.Self());
-      } else {
-        // For the CC collector, we only need to wait for the thread flip rather than the whole GC
-        // to occur thanks to the to-space invariant.
-        heap->IncrementDisableThreadFlip(soa.Self());
-      }
+      heap->PinObject(soa.Self(), s);
     }
     if (s->IsCompressed()) {
       if (is_copy != nullptr) {
@@ -2080,11 +2075,7 @@ class JNI {
     gc::Heap* heap = Runtime::Current()->GetHeap();
     ObjPtr<mirror::String> s = soa.Decode<mirror::String>(java_string);
     if (heap->IsMovableObject(s)) {
-      if (!kUseReadBarrier) {
-        heap->DecrementDisableMovingGC(soa.Self());
-      } else {
-        heap->DecrementDisableThreadFlip(soa.Self());
-      }
+      heap->UnpinObject(soa.Self(), s);
     }
     if (s->IsCompressed() || (s->IsCompressed() == false && s->GetValue() != chars)) {
       delete[] chars;
@@ -2104,9 +2095,9 @@ class JNI {
     char* bytes = new char[byte_count + 1];
     CHECK(bytes != nullptr);  // bionic aborts anyway.
     if (s->IsCompressed()) {
-      for (size_t i = 0; i < byte_count; ++i) {
-        bytes[i] = s->CharAt(i);
-      }
+      // Compressed strings are ASCII, which is its own modified UTF-8 encoding.
+      DCHECK_EQ(byte_count, static_cast<size_t>(s->GetLength()));
+      memcpy(bytes, s->GetValueCompressed(), byte_count);
     } else {
       const uint16_t* chars = s->GetValue();
       ConvertUtf16ToModifiedUtf8(bytes, byte_count, chars, s->GetLength());
@@ -2241,13 +2232,7 @@ class JNI {
     }
     gc::Heap* heap = Runtime::Current()->GetHeap();
     if (heap->IsMovableObject(array)) {
-      if (!kUseReadBarrier) {
-        heap->IncrementDisableMovingGC(soa.Self());
-      } else {
-        // For the CC collector, we only need to wait for the thread flip rather than the whole GC
-        // to occur thanks to the to-space invariant.
-        heap->IncrementDisableThreadFlip(soa.Self());
-      }
+      heap->PinObject(soa.Self(), array);
       // Re-decode in case the object moved since IncrementDisableGC waits for GC to complete.
       array = soa.Decode<mirror::Array>(java_array);
     }
@@ -2805,12 +2790,8 @@ class JNI {
       if (is_copy) {
         delete[] reinterpret_cast<uint64_t*>(elements);
       } else if (heap->IsMovableObject(array)) {
-        // Non copy to a movable object must means that we had disabled the moving GC.
-        if (!kUseReadBarrier) {
-          heap->DecrementDisableMovingGC(soa.Self());
-        } else {
-          heap->DecrementDisableThreadFlip(soa.Self());
-        }
+        // Non copy to a movable object must means that we had pinned the object.
+        heap->UnpinObject(soa.Self(), array);
       }
     }
   }
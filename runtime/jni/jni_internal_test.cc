@@ -1270,6 +1270,23 @@ TEST_F(JniInternalTest, GetReleasePrimitiveArrayCriticalOfWrongType) {
   GetReleasePrimitiveArrayCriticalOfWrongType(true);
 }
 
+TEST_F(JniInternalTest, GetPrimitiveArrayCriticalDuringGc) {
+  jbyteArray array = env_->NewByteArray(16);
+  ASSERT_NE(array, nullptr);
+  jboolean is_copy;
+  void* data = env_->GetPrimitiveArrayCritical(array, &is_copy);
+  ASSERT_NE(data, nullptr);
+  if (kUseReadBarrier && is_copy == JNI_FALSE) {
+    // The CC collector pins the region of the array instead of blocking the thread flip, so it
+    // can collect during the critical section, and must not move the array.
+    Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references= */ false);
+    void* nested_data = env_->GetPrimitiveArrayCritical(array, nullptr);
+    EXPECT_EQ(nested_data, data);
+    env_->ReleasePrimitiveArrayCritical(array, nested_data, 0);
+  }
+  env_->ReleasePrimitiveArrayCritical(array, data, 0);
+}
+
 TEST_F(JniInternalTest, GetPrimitiveArrayRegionElementsOfWrongType) {
   GetPrimitiveArrayRegionElementsOfWrongType(false);
   GetPrimitiveArrayRegionElementsOfWrongType(true);
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lock_contention_sampler.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <tuple>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "base/enums.h"
+#include "base/time_utils.h"
+#include "gc_root-inl.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+LockContentionSampler::LockContentionSampler()
+    : lock_("lock contention sampler lock"),
+      slots_(nullptr),
+      sampling_period_(0u),
+      contentions_(0u),
+      enqueue_position_(0u),
+      dequeue_position_(0u),
+      dropped_samples_(0u) {}
+
+void LockContentionSampler::SetSamplingPeriod(uint32_t sampling_period) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (sampling_period != 0u && slots_ == nullptr) {
+    slots_.reset(new Slot[kNumSlots]);
+    for (size_t i = 0; i < kNumSlots; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  // Publish the slots to the producers along with the sampling period.
+  sampling_period_.store(sampling_period, std::memory_order_release);
+}
+
+LockContentionSampler::Slot* LockContentionSampler::ClaimSlot(/*out*/ size_t* position) {
+  size_t pos = enqueue_position_.load(std::memory_order_relaxed);
+  while (true) {
+    Slot* slot = &slots_[pos % kNumSlots];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence == pos) {
+      if (enqueue_position_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        *position = pos;
+        return slot;
+      }
+    } else if (sequence < pos) {
+      // The slot still holds the sample of the previous lap, the buffer is full.
+      dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    } else {
+      pos = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void LockContentionSampler::RecordMonitorContention(Thread* self,
+                                                    ArtMethod* owner_method,
+                                                    uint32_t owner_dex_pc,
+                                                    uint64_t wait_ns) {
+  size_t position;
+  Slot* slot = ClaimSlot(&position);
+  if (slot == nullptr) {
+    return;
+  }
+  LockContentionSample& sample = slot->sample;
+  sample.owner_method = owner_method;
+  sample.owner_dex_pc = owner_dex_pc;
+  sample.waiter_method = self->GetCurrentMethod(&sample.waiter_dex_pc,
+                                                /* check_suspended= */ true,
+                                                /* abort_on_error= */ false);
+  sample.lock_name = nullptr;
+  sample.owner_tid = 0;
+  sample.waiter_tid = self->GetTid();
+  sample.wait_ns = wait_ns;
+  // Publish the sample to the consumer and the GC.
+  slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void LockContentionSampler::RecordLockContention(const char* lock_name,
+                                                 pid_t waiter_tid,
+                                                 pid_t owner_tid,
+                                                 uint64_t wait_ns) {
+  size_t position;
+  Slot* slot = ClaimSlot(&position);
+  if (slot == nullptr) {
+    return;
+  }
+  LockContentionSample& sample = slot->sample;
+  sample.owner_method = nullptr;
+  sample.owner_dex_pc = 0u;
+  sample.waiter_method = nullptr;
+  sample.waiter_dex_pc = 0u;
+  sample.lock_name = lock_name;
+  sample.owner_tid = owner_tid;
+  sample.waiter_tid = waiter_tid;
+  sample.wait_ns = wait_ns;
+  slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void LockContentionSampler::VisitRoots(RootVisitor* visitor) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (slots_ == nullptr) {
+    return;
+  }
+  BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(visitor, RootInfo(kRootDebugger));
+  // Only the consumer frees slots, and it holds `lock_`, so the published samples seen here stay
+  // published during the visit. Samples still being recorded are skipped, their methods are on
+  // the stacks of the recording threads.
+  size_t end = enqueue_position_.load(std::memory_order_acquire);
+  for (size_t position = dequeue_position_; position != end; ++position) {
+    Slot& slot = slots_[position % kNumSlots];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+      continue;
+    }
+    const LockContentionSample& sample = slot.sample;
+    if (sample.owner_method != nullptr) {
+      sample.owner_method->VisitRoots(buffered_visitor, kRuntimePointerSize);
+    }
+    if (sample.waiter_method != nullptr) {
+      sample.waiter_method->VisitRoots(buffered_visitor, kRuntimePointerSize);
+    }
+  }
+}
+
+void LockContentionSampler::DumpForSigQuit(std::ostream& os) {
+  if (sampling_period_.load(std::memory_order_relaxed) == 0u) {
+    return;
+  }
+  // Total wait and number of samples, by owner, waiter and lock name.
+  using Location = std::tuple<ArtMethod*, ArtMethod*, const char*>;
+  std::map<Location, std::pair<uint64_t, size_t>> contentions;
+  ScopedObjectAccess soa(Thread::Current());
+  {
+    MutexLock mu(soa.Self(), lock_);
+    size_t end = enqueue_position_.load(std::memory_order_acquire);
+    for (size_t position = dequeue_position_; position != end; ++position) {
+      Slot& slot = slots_[position % kNumSlots];
+      if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+        continue;
+      }
+      const LockContentionSample& sample = slot.sample;
+      std::pair<uint64_t, size_t>& entry =
+          contentions[Location(sample.owner_method, sample.waiter_method, sample.lock_name)];
+      entry.first += sample.wait_ns;
+      entry.second += 1u;
+    }
+  }
+  std::vector<std::pair<Location, std::pair<uint64_t, size_t>>> sorted(contentions.begin(),
+                                                                      contentions.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.second.first > rhs.second.first;
+  });
+
+  static constexpr size_t kMaxDumpedLocations = 20u;
+  os << "Sampled lock contentions (one in " << sampling_period_.load(std::memory_order_relaxed)
+     << ", " << GetDroppedSamples() << " dropped):\n";
+  for (size_t i = 0; i != std::min(sorted.size(), kMaxDumpedLocations); ++i) {
+    ArtMethod* owner_method = std::get<0>(sorted[i].first);
+    ArtMethod* waiter_method = std::get<1>(sorted[i].first);
+    const char* lock_name = std::get<2>(sorted[i].first);
+    os << "  " << PrettyDuration(sorted[i].second.first) << " in " << sorted[i].second.second
+       << " samples: ";
+    if (lock_name != nullptr) {
+      os << "runtime lock " << lock_name;
+    } else {
+      os << "waiting in " << ArtMethod::PrettyMethod(waiter_method)
+         << " for owner in " << ArtMethod::PrettyMethod(owner_method);
+    }
+    os << "\n";
+  }
+  os << "\n";
+}
+
+}  // namespace art
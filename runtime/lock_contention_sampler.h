@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_LOCK_CONTENTION_SAMPLER_H_
+#define ART_RUNTIME_LOCK_CONTENTION_SAMPLER_H_
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+class ArtMethod;
+class RootVisitor;
+class Thread;
+
+// A sampled lock contention. Contentions on Java monitors have the methods holding and waiting
+// for the monitor, contentions on the runtime's own locks have the name of the lock instead.
+struct LockContentionSample {
+  ArtMethod* owner_method;
+  uint32_t owner_dex_pc;
+  ArtMethod* waiter_method;
+  uint32_t waiter_dex_pc;
+  const char* lock_name;
+  pid_t owner_tid;
+  pid_t waiter_tid;
+  uint64_t wait_ns;
+};
+
+// Records one in `sampling period` lock contentions, on Java monitors and on the runtime's own
+// Mutex and ReaderWriterMutex. Recording a sample only stores the methods and the wait time, the
+// methods are pretty printed when the samples are dumped. Like the AllocationSampler, the samples
+// go to a bounded lock-free ring buffer, and are dropped while it is full. A single consumer at a
+// time drains the buffer, under `lock_`, which also excludes the GC visiting the buffered methods.
+class LockContentionSampler {
+ public:
+  static constexpr size_t kNumSlots = 1024;
+
+  LockContentionSampler();
+
+  // Sample one in `sampling_period` contentions, or none if it is zero.
+  void SetSamplingPeriod(uint32_t sampling_period) REQUIRES(!lock_);
+
+  // Returns whether the contention about to be waited for should be recorded. Only costs a load
+  // while sampling is off.
+  bool ShouldSample() {
+    uint32_t sampling_period = sampling_period_.load(std::memory_order_acquire);
+    return sampling_period != 0u &&
+        contentions_.fetch_add(1u, std::memory_order_relaxed) % sampling_period == 0u;
+  }
+
+  // Records the contention of `self` on a monitor held by `owner_method`, once `self` acquired
+  // the monitor after waiting `wait_ns`.
+  void RecordMonitorContention(Thread* self,
+                               ArtMethod* owner_method,
+                               uint32_t owner_dex_pc,
+                               uint64_t wait_ns)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Records the contention on the runtime lock `lock_name`. It does not acquire any lock, so this
+  // can be called from the Mutex implementation.
+  void RecordLockContention(const char* lock_name,
+                            pid_t waiter_tid,
+                            pid_t owner_tid,
+                            uint64_t wait_ns);
+
+  // Removes up to `max_samples` samples from the ring buffer, oldest first, and calls `visitor`
+  // on each of them. Returns the number of samples visited.
+  template <typename Visitor>
+  size_t Drain(Thread* self, size_t max_samples, const Visitor& visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Visits the methods of the buffered samples as roots, so that they stay valid until the
+  // samples are drained.
+  void VisitRoots(RootVisitor* visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Dumps the buffered samples aggregated by lock location, longest total wait first.
+  void DumpForSigQuit(std::ostream& os) REQUIRES(!lock_, !Locks::mutator_lock_);
+
+  // Number of samples lost because the ring buffer was full.
+  size_t GetDroppedSamples() const {
+    return dropped_samples_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Slot {
+    // Equal to the position of the slot in the sequence of samples when it is free to record that
+    // sample, and to the position plus one once the sample is recorded.
+    std::atomic<size_t> sequence;
+    LockContentionSample sample;
+  };
+
+  // Claims the slot of the next sample, or returns null if the buffer is full.
+  Slot* ClaimSlot(/*out*/ size_t* position);
+
+  Mutex lock_;
+  // Allocated when sampling starts, before `sampling_period_` is published.
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint32_t> sampling_period_;
+  std::atomic<uint32_t> contentions_;
+  // Position of the next sample to record.
+  std::atomic<size_t> enqueue_position_;
+  // Position of the next sample to drain.
+  size_t dequeue_position_ GUARDED_BY(lock_);
+  std::atomic<size_t> dropped_samples_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockContentionSampler);
+};
+
+template <typename Visitor>
+inline size_t LockContentionSampler::Drain(Thread* self,
+                                           size_t max_samples,
+                                           const Visitor& visitor) {
+  MutexLock mu(self, lock_);
+  if (slots_ == nullptr) {
+    return 0u;
+  }
+  size_t count = 0;
+  for (; count < max_samples; ++count) {
+    Slot& slot = slots_[dequeue_position_ % kNumSlots];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_position_ + 1) {
+      break;
+    }
+    visitor(slot.sample);
+    // Hand the slot back to the producers for the sample one lap ahead.
+    slot.sequence.store(dequeue_position_ + kNumSlots, std::memory_order_release);
+    ++dequeue_position_;
+  }
+  return count;
+}
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_LOCK_CONTENTION_SAMPLER_H_
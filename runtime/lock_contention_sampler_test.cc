@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lock_contention_sampler.h"
+
+#include <string>
+#include <vector>
+
+#include "common_runtime_test.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+class LockContentionSamplerTest : public CommonRuntimeTest {};
+
+TEST_F(LockContentionSamplerTest, SamplesOneInPeriod) {
+  LockContentionSampler sampler;
+  EXPECT_FALSE(sampler.ShouldSample());
+  sampler.SetSamplingPeriod(3u);
+  size_t sampled = 0u;
+  for (size_t i = 0; i != 9u; ++i) {
+    if (sampler.ShouldSample()) {
+      ++sampled;
+    }
+  }
+  EXPECT_EQ(sampled, 3u);
+  sampler.SetSamplingPeriod(0u);
+  EXPECT_FALSE(sampler.ShouldSample());
+}
+
+TEST_F(LockContentionSamplerTest, DrainsOldestFirstAndDropsWhenFull) {
+  LockContentionSampler sampler;
+  sampler.SetSamplingPeriod(1u);
+  for (size_t i = 0; i != LockContentionSampler::kNumSlots + 2u; ++i) {
+    sampler.RecordLockContention("test lock", /* waiter_tid= */ 1, /* owner_tid= */ 2, i);
+  }
+  EXPECT_EQ(sampler.GetDroppedSamples(), 2u);
+
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<uint64_t> wait_times;
+  auto visitor = [&](const LockContentionSample& sample) {
+    EXPECT_STREQ(sample.lock_name, "test lock");
+    EXPECT_EQ(sample.owner_method, nullptr);
+    EXPECT_EQ(sample.waiter_tid, 1);
+    EXPECT_EQ(sample.owner_tid, 2);
+    wait_times.push_back(sample.wait_ns);
+  };
+  EXPECT_EQ(sampler.Drain(soa.Self(), 2u, visitor), 2u);
+  EXPECT_EQ(wait_times, std::vector<uint64_t>({0u, 1u}));
+
+  // Drained slots are reused.
+  sampler.RecordLockContention("test lock", 1, 2, 42u);
+  EXPECT_EQ(sampler.GetDroppedSamples(), 2u);
+  wait_times.clear();
+  EXPECT_EQ(sampler.Drain(soa.Self(), LockContentionSampler::kNumSlots, visitor),
+            LockContentionSampler::kNumSlots - 1u);
+  EXPECT_EQ(wait_times.back(), 42u);
+  EXPECT_EQ(sampler.Drain(soa.Self(), LockContentionSampler::kNumSlots, visitor), 0u);
+}
+
+}  // namespace art
@@ -112,10 +112,17 @@ size_t MethodType::NumberOfVRegs() {
 }
 
 bool MethodType::IsExactMatch(ObjPtr<MethodType> target) {
+  // Call sites and method handles frequently share the same MethodType or parameter array.
+  if (this == target) {
+    return true;
+  }
   const ObjPtr<ObjectArray<Class>> p_types = GetPTypes();
-  const int32_t params_length = p_types->GetLength();
-
   const ObjPtr<ObjectArray<Class>> target_p_types = target->GetPTypes();
+  if (p_types == target_p_types) {
+    return GetRType() == target->GetRType();
+  }
+
+  const int32_t params_length = p_types->GetLength();
   if (params_length != target_p_types->GetLength()) {
     return false;
   }
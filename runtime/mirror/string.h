@@ -62,6 +62,10 @@ class MANAGED String final : public Object {
     return OFFSET_OF_OBJECT_MEMBER(String, value_);
   }
 
+  static constexpr MemberOffset HashCodeOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(String, hash_code_);
+  }
+
   uint16_t* GetValue() REQUIRES_SHARED(Locks::mutator_lock_) {
     return &value_[0];
   }
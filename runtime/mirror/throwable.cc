@@ -88,7 +88,7 @@ int32_t Throwable::GetStackDepth() {
   const ObjPtr<mirror::ObjectArray<Object>> trace = stack_state->AsObjectArray<Object>();
   const int32_t array_len = trace->GetLength();
   DCHECK_GT(array_len, 0);
-  // See method BuildInternalStackTraceVisitor::Init for the format.
+  // See method InternalStackTraceBuilder::Init for the format.
   return array_len - 1;
 }
 
@@ -105,7 +105,7 @@ std::string Throwable::Dump() {
   if (stack_state != nullptr && stack_state->IsObjectArray()) {
     ObjPtr<ObjectArray<Object>> object_array = stack_state->AsObjectArray<Object>();
     // Decode the internal stack trace into the depth and method trace
-    // See method BuildInternalStackTraceVisitor::Init for the format.
+    // See method InternalStackTraceBuilder::Init for the format.
     DCHECK_GT(object_array->GetLength(), 0);
     ObjPtr<Object> methods_and_dex_pcs = object_array->Get(0);
     DCHECK(methods_and_dex_pcs->IsIntArray() || methods_and_dex_pcs->IsLongArray());
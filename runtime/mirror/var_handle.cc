@@ -1450,17 +1450,19 @@ VarHandle::MatchKind VarHandle::GetMethodTypeMatchForAccessMode(AccessMode acces
                                                       var_type,
                                                       GetCoordinateType0(),
                                                       GetCoordinateType1());
-  if (vh_ptypes_count != method_type->GetPTypes()->GetLength()) {
+  ObjPtr<ObjectArray<Class>> mt_ptypes = method_type->GetPTypes();
+  if (vh_ptypes_count != mt_ptypes->GetLength()) {
     return MatchKind::kNone;
   }
 
-  // Check the parameter types are compatible.
-  ObjPtr<ObjectArray<Class>> mt_ptypes = method_type->GetPTypes();
+  // Check the parameter types are compatible. The count check above makes the
+  // indices valid, so the array bounds checks can be skipped.
   for (int32_t i = 0; i < vh_ptypes_count; ++i) {
-    if (mt_ptypes->Get(i) == vh_ptypes[i]) {
+    ObjPtr<Class> mt_ptype = mt_ptypes->GetWithoutChecks(i);
+    if (mt_ptype == vh_ptypes[i]) {
       continue;
     }
-    if (!IsParameterTypeConvertible(mt_ptypes->Get(i), vh_ptypes[i])) {
+    if (!IsParameterTypeConvertible(mt_ptype, vh_ptypes[i])) {
       return MatchKind::kNone;
     }
     match = MatchKind::kWithConversions;
@@ -16,6 +16,7 @@
 
 #include "monitor-inl.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "android-base/stringprintf.h"
@@ -31,6 +32,7 @@
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_types.h"
 #include "dex/dex_instruction-inl.h"
+#include "lock_contention_sampler.h"
 #include "lock_word-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -49,6 +51,11 @@ using android::base::StringPrintf;
 static constexpr uint64_t kDebugThresholdFudgeFactor = kIsDebugBuild ? 10 : 1;
 static constexpr uint64_t kLongWaitMs = 100 * kDebugThresholdFudgeFactor;
 
+// Bounds of the adaptive spinning of contended monitors. Contenders always spin a little, since
+// hold times change, and never for long, since spinning delays responding to suspend requests.
+static constexpr uint8_t kMinMonitorSpins = 1u;
+static constexpr uint8_t kMaxMonitorSpins = 2u * Mutex::kDefaultMaxSpins;
+
 /*
  * Every Object has a monitor associated with it, but not every Object is actually locked.  Even
  * the ones that are locked do not need a full-fledged monitor until a) there is actual contention
@@ -93,6 +100,7 @@ void Monitor::Init(uint32_t lock_profiling_threshold,
 Monitor::Monitor(Thread* self, Thread* owner, ObjPtr<mirror::Object> obj, int32_t hash_code)
     : monitor_lock_("a monitor lock", kMonitorLock),
       num_waiters_(0),
+      max_spins_(Mutex::kDefaultMaxSpins),
       owner_(owner),
       lock_count_(0),
       obj_(GcRoot<mirror::Object>(obj)),
@@ -122,6 +130,7 @@ Monitor::Monitor(Thread* self,
                  MonitorId id)
     : monitor_lock_("a monitor lock", kMonitorLock),
       num_waiters_(0),
+      max_spins_(Mutex::kDefaultMaxSpins),
       owner_(owner),
       lock_count_(0),
       obj_(GcRoot<mirror::Object>(obj)),
@@ -422,8 +431,22 @@ bool Monitor::TryLock(Thread* self, bool spin) {
     lock_count_++;
     CHECK_NE(lock_count_, 0u);  // Abort on overflow.
   } else {
-    bool success = spin ? monitor_lock_.ExclusiveTryLockWithSpinning(self)
-        : monitor_lock_.ExclusiveTryLock(self);
+    bool success;
+    if (spin) {
+      // Spinning is worth it when the lock is held for short periods, which is best predicted
+      // by whether the previous spins succeeded. We cannot look at the state of the owner
+      // without holding the thread list lock, as it could exit concurrently.
+      uint8_t max_spins = max_spins_.load(std::memory_order_relaxed);
+      success = monitor_lock_.ExclusiveTryLockWithSpinning(self, max_spins);
+      uint8_t new_max_spins = success
+          ? std::min<uint8_t>(max_spins + 1u, kMaxMonitorSpins)
+          : std::max<uint8_t>(max_spins / 2u, kMinMonitorSpins);
+      if (new_max_spins != max_spins) {
+        max_spins_.store(new_max_spins, std::memory_order_relaxed);
+      }
+    } else {
+      success = monitor_lock_.ExclusiveTryLock(self);
+    }
     if (!success) {
       return false;
     }
@@ -453,6 +476,9 @@ void Monitor::Lock(Thread* self) {
   // Contended; not reentrant. We hold no locks, so tread carefully.
   const bool log_contention = (lock_profiling_threshold_ != 0);
   uint64_t wait_start_ms = log_contention ? MilliTime() : 0;
+  LockContentionSampler* sampler = Runtime::Current()->GetLockContentionSampler();
+  const bool sample_contention = sampler != nullptr && sampler->ShouldSample();
+  uint64_t wait_start_ns = sample_contention ? NanoTime() : 0;
 
   Thread *orig_owner = nullptr;
   ArtMethod* owners_method;
@@ -494,7 +520,7 @@ void Monitor::Lock(Thread* self) {
       Locks::thread_list_lock_->ExclusiveUnlock(self);
     }
   }
-  if (log_contention) {
+  if (log_contention || sample_contention) {
     // Request the current holder to set lock_owner_info.
     // Do this even if tracing is enabled, so we semi-consistently get the information
     // corresponding to MonitorExit.
@@ -623,6 +649,13 @@ void Monitor::Lock(Thread* self) {
   owner_.store(self, std::memory_order_relaxed);
   DCHECK_EQ(lock_count_, 0u);
 
+  if (sample_contention && orig_owner != nullptr) {
+    // Only record the methods here, they are printed when the samples are dumped.
+    uint64_t wait_ns = NanoTime() - wait_start_ns;
+    GetLockOwnerInfo(&owners_method, &owners_dex_pc, orig_owner);
+    sampler->RecordMonitorContention(self, owners_method, owners_dex_pc, wait_ns);
+  }
+
   if (ATraceEnabled()) {
     SetLockingMethodNoProxy(self);
   }
@@ -1647,6 +1680,9 @@ void MonitorList::Add(Monitor* m) {
 void MonitorList::SweepMonitorList(IsMarkedVisitor* visitor) {
   Thread* self = Thread::Current();
   MutexLock mu(self, monitor_list_lock_);
+  // Collect the dead monitors and give them back to the pool together, so that the pool lock
+  // is taken once per sweep rather than once per monitor.
+  Monitors dead_monitors;
   for (auto it = list_.begin(); it != list_.end(); ) {
     Monitor* m = *it;
     // Disable the read barrier in GetObject() as this is called by GC.
@@ -1656,13 +1692,15 @@ void MonitorList::SweepMonitorList(IsMarkedVisitor* visitor) {
     if (new_obj == nullptr) {
       VLOG(monitor) << "freeing monitor " << m << " belonging to unmarked object "
                     << obj;
-      MonitorPool::ReleaseMonitor(self, m);
-      it = list_.erase(it);
+      auto next = std::next(it);
+      dead_monitors.splice(dead_monitors.end(), list_, it);
+      it = next;
     } else {
       m->SetObject(new_obj);
       ++it;
     }
   }
+  MonitorPool::ReleaseMonitors(self, &dead_monitors);
 }
 
 size_t MonitorList::Size() {
@@ -1671,6 +1709,18 @@ size_t MonitorList::Size() {
   return list_.size();
 }
 
+bool MonitorList::HasIdleMonitors() {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, monitor_list_lock_);
+  for (Monitor* m : list_) {
+    if (m->owner_.load(std::memory_order_relaxed) == nullptr &&
+        m->num_waiters_.load(std::memory_order_relaxed) == 0u) {
+      return true;
+    }
+  }
+  return false;
+}
+
 class MonitorDeflateVisitor : public IsMarkedVisitor {
  public:
   MonitorDeflateVisitor() : self_(Thread::Current()), deflate_count_(0) {}
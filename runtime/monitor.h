@@ -220,7 +220,8 @@ class Monitor {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Try to lock without blocking, returns true if we acquired the lock.
-  // If spin is true, then we spin for a short period before failing.
+  // If spin is true, then we spin for a short period before failing. The period adapts to
+  // whether spinning recently succeeded on this monitor.
   bool TryLock(Thread* self, bool spin = false)
       TRY_ACQUIRE(true, monitor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -318,6 +319,11 @@ class Monitor {
   // monitor acquisition. Prevents deflation.
   std::atomic<size_t> num_waiters_;
 
+  // How long contenders spin on monitor_lock_ before blocking, in Mutex spins. It grows when
+  // spinning acquires the lock and shrinks when it does not, to follow how long the lock is
+  // usually held. Updated racily, as it is only a heuristic.
+  std::atomic<uint8_t> max_spins_;
+
   // Which thread currently owns the lock? monitor_lock_ only keeps the tid.
   // Only set while holding monitor_lock_. Non-locking readers only use it to
   // compare to self or for debugging.
@@ -442,6 +448,10 @@ class MonitorList {
   void BroadcastForNewMonitors() REQUIRES(!monitor_list_lock_);
   // Returns how many monitors were deflated.
   size_t DeflateMonitors() REQUIRES(!monitor_list_lock_) REQUIRES(Locks::mutator_lock_);
+  // Returns whether any monitor is currently neither owned nor waited on, i.e. whether
+  // DeflateMonitors() would be likely to find work. Does not require mutators to be suspended,
+  // so the answer may be stale by the time it is used.
+  bool HasIdleMonitors() REQUIRES(!monitor_list_lock_);
   size_t Size() REQUIRES(!monitor_list_lock_);
 
   typedef std::list<Monitor*, TrackingAllocator<Monitor*, kAllocatorTagMonitorList>> Monitors;
@@ -110,31 +110,31 @@ Monitor* MonitorPool::CreateMonitorInPool(Thread* self,
                                           ObjPtr<mirror::Object> obj,
                                           int32_t hash_code)
     REQUIRES_SHARED(Locks::mutator_lock_) {
-  // We are gonna allocate, so acquire the writer lock.
-  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+  Monitor* mon_uninitialized;
+  {
+    // We are gonna allocate, so acquire the writer lock.
+    MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+
+    // Enough space, or need to resize?
+    if (first_free_ == nullptr) {
+      VLOG(monitor) << "Allocating a new chunk.";
+      AllocateChunk();
+    }
 
-  // Enough space, or need to resize?
-  if (first_free_ == nullptr) {
-    VLOG(monitor) << "Allocating a new chunk.";
-    AllocateChunk();
+    mon_uninitialized = first_free_;
+    first_free_ = first_free_->next_free_;
   }
 
-  Monitor* mon_uninitialized = first_free_;
-  first_free_ = first_free_->next_free_;
-
   // Pull out the id which was preinitialized.
   MonitorId id = mon_uninitialized->monitor_id_;
 
-  // Initialize it.
+  // Initialize it. The slot is ours now, so this does not need the lock.
   Monitor* monitor = new(mon_uninitialized) Monitor(self, owner, obj, hash_code, id);
 
   return monitor;
 }
 
-void MonitorPool::ReleaseMonitorToPool(Thread* self, Monitor* monitor) {
-  // Might be racy with allocation, so acquire lock.
-  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
-
+void MonitorPool::DestroyMonitorForPool(Monitor* monitor, Monitor* next_free) {
   // Keep the monitor id. Don't trust it's not cleared.
   MonitorId id = monitor->monitor_id_;
 
@@ -142,18 +142,41 @@ void MonitorPool::ReleaseMonitorToPool(Thread* self, Monitor* monitor) {
   // TODO: Exception safety?
   monitor->~Monitor();
 
-  // Add to the head of the free list.
-  monitor->next_free_ = first_free_;
-  first_free_ = monitor;
+  monitor->next_free_ = next_free;
 
   // Rewrite monitor id.
   monitor->monitor_id_ = id;
 }
 
+void MonitorPool::ReleaseMonitorToPool(Thread* self, Monitor* monitor) {
+  DestroyMonitorForPool(monitor, /*next_free=*/ nullptr);
+
+  // Might be racy with allocation, so acquire lock.
+  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+
+  // Add to the head of the free list.
+  monitor->next_free_ = first_free_;
+  first_free_ = monitor;
+}
+
 void MonitorPool::ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* monitors) {
+  if (monitors->empty()) {
+    return;
+  }
+  // Chain the monitors together first, then splice the chain into the free
+  // list with a single acquisition of the lock.
+  Monitor* head = nullptr;
+  Monitor* tail = nullptr;
   for (Monitor* mon : *monitors) {
-    ReleaseMonitorToPool(self, mon);
+    DestroyMonitorForPool(mon, head);
+    if (tail == nullptr) {
+      tail = mon;
+    }
+    head = mon;
   }
+  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+  tail->next_free_ = first_free_;
+  first_free_ = head;
 }
 
 }  // namespace art
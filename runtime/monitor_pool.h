@@ -134,6 +134,12 @@ class MonitorPool {
   void ReleaseMonitorToPool(Thread* self, Monitor* monitor);
   void ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* monitors);
 
+  // Runs the destructor of `monitor` and links it to `next_free`, ready to be put back on the
+  // free list. The monitor is not reachable from the pool yet, so its next_free_ field can be
+  // written without the lock.
+  static void DestroyMonitorForPool(Monitor* monitor, Monitor* next_free)
+      NO_THREAD_SAFETY_ANALYSIS;
+
   // Note: This is safe as we do not ever move chunks.  All needed entries in the monitor_chunks_
   // data structure are read-only once we get here.  Updates happen-before this call because
   // the lock word was stored with release semantics and we read it with acquire semantics to
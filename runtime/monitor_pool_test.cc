@@ -16,6 +16,8 @@
 
 #include "monitor_pool.h"
 
+#include <set>
+
 #include "common_runtime_test.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
@@ -124,4 +126,38 @@ TEST_F(MonitorPoolTest, MonitorPoolTest) {
   }
 }
 
+TEST_F(MonitorPoolTest, ReleaseMonitors) {
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+
+  // Create enough monitors to span several chunks, then release them as one batch.
+  constexpr size_t kNumMonitors = 100;
+  MonitorList::Monitors monitors;
+  std::set<MonitorId> ids;
+  for (size_t i = 0; i < kNumMonitors; ++i) {
+    Monitor* mon = MonitorPool::CreateMonitor(self, self, nullptr, static_cast<int32_t>(i));
+    VerifyMonitor(mon, self);
+    monitors.push_back(mon);
+    ids.insert(mon->GetMonitorId());
+  }
+  EXPECT_EQ(kNumMonitors, ids.size());
+  MonitorPool::ReleaseMonitors(self, &monitors);
+
+  // All released slots are back on the free list with their ids intact. Without a pool
+  // (32-bit), monitors are heap allocated and ids follow their addresses.
+  const bool has_pool = MonitorPool::GetMonitorPool() != nullptr;
+  std::vector<Monitor*> reused;
+  for (size_t i = 0; i < kNumMonitors; ++i) {
+    Monitor* mon = MonitorPool::CreateMonitor(self, self, nullptr, static_cast<int32_t>(i));
+    VerifyMonitor(mon, self);
+    if (has_pool) {
+      EXPECT_EQ(1u, ids.count(mon->GetMonitorId()));
+    }
+    reused.push_back(mon);
+  }
+  for (Monitor* mon : reused) {
+    MonitorPool::ReleaseMonitor(self, mon);
+  }
+}
+
 }  // namespace art
@@ -17,6 +17,7 @@
 #include "java_lang_Class.h"
 
 #include <iostream>
+#include <vector>
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
@@ -288,55 +289,38 @@ static ObjPtr<mirror::ObjectArray<mirror::Field>> GetDeclaredFields(
     return nullptr;
   }
   StackHandleScope<1> hs(self);
-  IterationRange<StrideIterator<ArtField>> ifields = klass->GetIFields();
-  IterationRange<StrideIterator<ArtField>> sfields = klass->GetSFields();
-  size_t array_size = klass->NumInstanceFields() + klass->NumStaticFields();
   hiddenapi::AccessContext hiddenapi_context = GetReflectionCaller(self);
-  // Lets go subtract all the non discoverable fields.
-  for (ArtField& field : ifields) {
-    if (!IsDiscoverable(public_only, hiddenapi_context, &field)) {
-      --array_size;
+  // Collect the discoverable fields first so that the hidden API checks run
+  // only once per field.
+  std::vector<ArtField*> fields;
+  fields.reserve(klass->NumInstanceFields() + klass->NumStaticFields());
+  for (ArtField& field : klass->GetIFields()) {
+    if (IsDiscoverable(public_only, hiddenapi_context, &field)) {
+      fields.push_back(&field);
     }
   }
-  for (ArtField& field : sfields) {
-    if (!IsDiscoverable(public_only, hiddenapi_context, &field)) {
-      --array_size;
+  for (ArtField& field : klass->GetSFields()) {
+    if (IsDiscoverable(public_only, hiddenapi_context, &field)) {
+      fields.push_back(&field);
     }
   }
-  size_t array_idx = 0;
   auto object_array = hs.NewHandle(mirror::ObjectArray<mirror::Field>::Alloc(
-      self, GetClassRoot<mirror::ObjectArray<mirror::Field>>(), array_size));
+      self, GetClassRoot<mirror::ObjectArray<mirror::Field>>(), fields.size()));
   if (object_array == nullptr) {
     return nullptr;
   }
-  for (ArtField& field : ifields) {
-    if (IsDiscoverable(public_only, hiddenapi_context, &field)) {
-      ObjPtr<mirror::Field> reflect_field =
-          mirror::Field::CreateFromArtField<kRuntimePointerSize>(self, &field, force_resolve);
-      if (reflect_field == nullptr) {
-        if (kIsDebugBuild) {
-          self->AssertPendingException();
-        }
-        // Maybe null due to OOME or type resolving exception.
-        return nullptr;
-      }
-      object_array->SetWithoutChecks<false>(array_idx++, reflect_field);
-    }
-  }
-  for (ArtField& field : sfields) {
-    if (IsDiscoverable(public_only, hiddenapi_context, &field)) {
-      ObjPtr<mirror::Field> reflect_field =
-          mirror::Field::CreateFromArtField<kRuntimePointerSize>(self, &field, force_resolve);
-      if (reflect_field == nullptr) {
-        if (kIsDebugBuild) {
-          self->AssertPendingException();
-        }
-        return nullptr;
+  for (size_t i = 0; i != fields.size(); ++i) {
+    ObjPtr<mirror::Field> reflect_field =
+        mirror::Field::CreateFromArtField<kRuntimePointerSize>(self, fields[i], force_resolve);
+    if (reflect_field == nullptr) {
+      if (kIsDebugBuild) {
+        self->AssertPendingException();
       }
-      object_array->SetWithoutChecks<false>(array_idx++, reflect_field);
+      // Maybe null due to OOME or type resolving exception.
+      return nullptr;
     }
+    object_array->SetWithoutChecks<false>(i, reflect_field);
   }
-  DCHECK_EQ(array_idx, array_size);
   return object_array.Get();
 }
 
@@ -571,30 +555,31 @@ static jobjectArray Class_getDeclaredConstructorsInternal(
     ThrowRuntimeException("Obsolete Object!");
     return nullptr;
   }
-  size_t constructor_count = 0;
-  // Two pass approach for speed.
+  // Collect the matching constructors first so that the hidden API checks run
+  // only once per method.
+  std::vector<ArtMethod*> constructors;
   for (auto& m : h_klass->GetDirectMethods(kRuntimePointerSize)) {
-    constructor_count += MethodMatchesConstructor(&m, public_only, hiddenapi_context) ? 1u : 0u;
+    if (MethodMatchesConstructor(&m, public_only, hiddenapi_context)) {
+      constructors.push_back(&m);
+    }
   }
   auto h_constructors = hs.NewHandle(mirror::ObjectArray<mirror::Constructor>::Alloc(
-      soa.Self(), GetClassRoot<mirror::ObjectArray<mirror::Constructor>>(), constructor_count));
+      soa.Self(), GetClassRoot<mirror::ObjectArray<mirror::Constructor>>(), constructors.size()));
   if (UNLIKELY(h_constructors == nullptr)) {
     soa.Self()->AssertPendingException();
     return nullptr;
   }
-  constructor_count = 0;
-  for (auto& m : h_klass->GetDirectMethods(kRuntimePointerSize)) {
-    if (MethodMatchesConstructor(&m, public_only, hiddenapi_context)) {
-      DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), kRuntimePointerSize);
-      DCHECK(!Runtime::Current()->IsActiveTransaction());
-      ObjPtr<mirror::Constructor> constructor =
-          mirror::Constructor::CreateFromArtMethod<kRuntimePointerSize, false>(soa.Self(), &m);
-      if (UNLIKELY(constructor == nullptr)) {
-        soa.Self()->AssertPendingOOMException();
-        return nullptr;
-      }
-      h_constructors->SetWithoutChecks<false>(constructor_count++, constructor);
+  DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), kRuntimePointerSize);
+  DCHECK(!Runtime::Current()->IsActiveTransaction());
+  for (size_t i = 0; i != constructors.size(); ++i) {
+    ObjPtr<mirror::Constructor> constructor =
+        mirror::Constructor::CreateFromArtMethod<kRuntimePointerSize, false>(soa.Self(),
+                                                                            constructors[i]);
+    if (UNLIKELY(constructor == nullptr)) {
+      soa.Self()->AssertPendingOOMException();
+      return nullptr;
     }
+    h_constructors->SetWithoutChecks<false>(i, constructor);
   }
   return soa.AddLocalReference<jobjectArray>(h_constructors.Get());
 }
@@ -636,36 +621,32 @@ static jobjectArray Class_getDeclaredMethodsUnchecked(JNIEnv* env, jobject javaT
     ThrowRuntimeException("Obsolete Object!");
     return nullptr;
   }
-  size_t num_methods = 0;
+  // Collect the discoverable non-constructor methods first so that the hidden
+  // API checks run only once per method.
+  std::vector<ArtMethod*> methods;
   for (ArtMethod& m : klass->GetDeclaredMethods(kRuntimePointerSize)) {
     uint32_t modifiers = m.GetAccessFlags();
-    // Add non-constructor declared methods.
     if ((modifiers & kAccConstructor) == 0 &&
         IsDiscoverable(public_only, hiddenapi_context, &m)) {
-      ++num_methods;
+      methods.push_back(&m);
     }
   }
   auto ret = hs.NewHandle(mirror::ObjectArray<mirror::Method>::Alloc(
-      soa.Self(), GetClassRoot<mirror::ObjectArray<mirror::Method>>(), num_methods));
+      soa.Self(), GetClassRoot<mirror::ObjectArray<mirror::Method>>(), methods.size()));
   if (ret == nullptr) {
     soa.Self()->AssertPendingOOMException();
     return nullptr;
   }
-  num_methods = 0;
-  for (ArtMethod& m : klass->GetDeclaredMethods(kRuntimePointerSize)) {
-    uint32_t modifiers = m.GetAccessFlags();
-    if ((modifiers & kAccConstructor) == 0 &&
-        IsDiscoverable(public_only, hiddenapi_context, &m)) {
-      DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), kRuntimePointerSize);
-      DCHECK(!Runtime::Current()->IsActiveTransaction());
-      ObjPtr<mirror::Method> method =
-          mirror::Method::CreateFromArtMethod<kRuntimePointerSize, false>(soa.Self(), &m);
-      if (method == nullptr) {
-        soa.Self()->AssertPendingException();
-        return nullptr;
-      }
-      ret->SetWithoutChecks<false>(num_methods++, method);
+  DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), kRuntimePointerSize);
+  DCHECK(!Runtime::Current()->IsActiveTransaction());
+  for (size_t i = 0; i != methods.size(); ++i) {
+    ObjPtr<mirror::Method> method =
+        mirror::Method::CreateFromArtMethod<kRuntimePointerSize, false>(soa.Self(), methods[i]);
+    if (method == nullptr) {
+      soa.Self()->AssertPendingException();
+      return nullptr;
     }
+    ret->SetWithoutChecks<false>(i, method);
   }
   return soa.AddLocalReference<jobjectArray>(ret.Get());
 }
@@ -296,6 +296,15 @@ static bool RunCommand(const std::string& cmd) {
   }
 }
 
+// Returns whether addr2line can be run. The answer is computed once, as the
+// abort path dumps every thread and would otherwise spawn a process per thread.
+static bool HaveAddr2line() {
+  // Try to run it to see whether we have it. Push an argument so that it doesn't assume a.out
+  // and print to stderr.
+  static const bool have_addr2line = RunCommand(FindAddr2line() + " -h");
+  return have_addr2line;
+}
+
 static bool PcIsWithinQuickCode(ArtMethod* method, uintptr_t pc) NO_THREAD_SAFETY_ANALYSIS {
   const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
   if (entry_point == nullptr) {
@@ -346,9 +355,7 @@ void DumpNativeStack(std::ostream& os,
   // Check whether we have and should use addr2line.
   bool use_addr2line;
   if (kUseAddr2line) {
-    // Try to run it to see whether we have it. Push an argument so that it doesn't assume a.out
-    // and print to stderr.
-    use_addr2line = (gAborting > 0) && RunCommand(FindAddr2line() + " -h");
+    use_addr2line = (gAborting > 0) && HaveAddr2line();
   } else {
     use_addr2line = false;
   }
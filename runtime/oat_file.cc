@@ -2047,11 +2047,7 @@ const dex::ClassDef* OatDexFile::FindClassDef(const DexFile& dex_file,
 void OatDexFile::MadviseDexFile(const DexFile& dex_file, MadviseState state) {
   Runtime* const runtime = Runtime::Current();
   const bool low_ram = runtime->GetHeap()->IsLowMemoryMode();
-  // TODO: Also do madvise hints for non low ram devices.
-  if (!low_ram) {
-    return;
-  }
-  if (state == MadviseState::kMadviseStateAtLoad && runtime->MAdviseRandomAccess()) {
+  if (low_ram && state == MadviseState::kMadviseStateAtLoad && runtime->MAdviseRandomAccess()) {
     // Default every dex file to MADV_RANDOM when its loaded by default for low ram devices.
     // Other devices have enough page cache to get performance benefits from loading more pages
     // into the page cache.
@@ -2064,6 +2060,9 @@ void OatDexFile::MadviseDexFile(const DexFile& dex_file, MadviseState state) {
     // Should always be there.
     const DexLayoutSections* const sections = oat_dex_file->GetDexLayoutSections();
     CHECK(sections != nullptr);
+    // The layout sections only cover the profiled code, so the hints for them are useful on all
+    // devices: prefetch the startup and hot code at load and drop the startup only code once
+    // startup is completed.
     sections->Madvise(&dex_file, state);
   }
 }
@@ -27,6 +27,7 @@
 #include "base/file_utils.h"
 #include "base/logging.h"  // For VLOG.
 #include "base/macros.h"
+#include "base/mutex.h"
 #include "base/os.h"
 #include "base/stl_util.h"
 #include "base/string_view_cpp20.h"
@@ -44,6 +45,7 @@
 #include "oat.h"
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
 #include "vdex_file.h"
 
 namespace art {
@@ -564,11 +566,113 @@ bool OatFileAssistant::DexLocationToOatFilename(const std::string& location,
   return GetDalvikCacheFilename(location.c_str(), cache_dir.c_str(), oat_filename, error_msg);
 }
 
+namespace {
+
+// Process-wide cache of the multidex checksums read from dex locations. Every
+// OatFileAssistant reads the zip central directory again otherwise, and the
+// same locations are queried repeatedly (class loader creation, the
+// DexFile.getDexOptNeeded family). Entries are keyed on the file identity so
+// that a replaced or modified file is read again.
+class DexChecksumsCache {
+ public:
+  struct Key {
+    std::string location;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    int64_t mtime_ns;
+
+    bool operator==(const Key& other) const {
+      return dev == other.dev &&
+             ino == other.ino &&
+             size == other.size &&
+             mtime_ns == other.mtime_ns &&
+             location == other.location;
+    }
+  };
+
+  // The key must be made before the checksums are read, so that a file
+  // modified in between is not recorded with the old checksums.
+  static bool MakeKey(const std::string& location, Key* key) {
+    struct stat st;
+    if (stat(location.c_str(), &st) != 0) {
+      return false;
+    }
+    key->location = location;
+    key->dev = st.st_dev;
+    key->ino = st.st_ino;
+    key->size = st.st_size;
+    key->mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+  }
+
+  bool Lookup(const Key& key,
+              std::vector<uint32_t>* checksums,
+              bool* only_contains_uncompressed_dex) {
+    MutexLock mu(Thread::Current(), lock_);
+    for (const Entry& entry : entries_) {
+      if (entry.key == key) {
+        *checksums = entry.checksums;
+        *only_contains_uncompressed_dex = entry.only_contains_uncompressed_dex;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Insert(const Key& key,
+              const std::vector<uint32_t>& checksums,
+              bool only_contains_uncompressed_dex) {
+    MutexLock mu(Thread::Current(), lock_);
+    for (Entry& entry : entries_) {
+      if (entry.key.location == key.location) {
+        entry = Entry{key, checksums, only_contains_uncompressed_dex};
+        return;
+      }
+    }
+    if (entries_.size() >= kMaxEntries) {
+      entries_.erase(entries_.begin());
+    }
+    entries_.push_back(Entry{key, checksums, only_contains_uncompressed_dex});
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 64u;
+
+  struct Entry {
+    Key key;
+    std::vector<uint32_t> checksums;
+    bool only_contains_uncompressed_dex;
+  };
+
+  Mutex lock_{"OatFileAssistant dex checksums cache lock", kGenericBottomLock};
+  std::vector<Entry> entries_ GUARDED_BY(lock_);
+};
+
+DexChecksumsCache* GetDexChecksumsCache() {
+  static DexChecksumsCache* cache = new DexChecksumsCache();
+  return cache;
+}
+
+}  // namespace
+
 const std::vector<uint32_t>* OatFileAssistant::GetRequiredDexChecksums() {
   if (!required_dex_checksums_attempted_) {
     required_dex_checksums_attempted_ = true;
     required_dex_checksums_found_ = false;
     cached_required_dex_checksums_.clear();
+    // The cache is keyed on the path, so locations opened through a file
+    // descriptor always read the zip.
+    DexChecksumsCache::Key key;
+    bool use_cache = zip_fd_ < 0 && DexChecksumsCache::MakeKey(dex_location_, &key);
+    if (use_cache &&
+        GetDexChecksumsCache()->Lookup(key,
+                                       &cached_required_dex_checksums_,
+                                       &zip_file_only_contains_uncompressed_dex_)) {
+      required_dex_checksums_found_ = true;
+      has_original_dex_files_ = true;
+      return &cached_required_dex_checksums_;
+    }
     std::string error_msg;
     const ArtDexFileLoader dex_file_loader;
     if (dex_file_loader.GetMultiDexChecksums(dex_location_.c_str(),
@@ -576,6 +680,11 @@ const std::vector<uint32_t>* OatFileAssistant::GetRequiredDexChecksums() {
                                              &error_msg,
                                              zip_fd_,
                                              &zip_file_only_contains_uncompressed_dex_)) {
+      if (use_cache) {
+        GetDexChecksumsCache()->Insert(key,
+                                       cached_required_dex_checksums_,
+                                       zip_file_only_contains_uncompressed_dex_);
+      }
       required_dex_checksums_found_ = true;
       has_original_dex_files_ = true;
     } else {
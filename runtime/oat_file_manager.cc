@@ -16,8 +16,10 @@
 
 #include "oat_file_manager.h"
 
+#include <algorithm>
 #include <memory>
 #include <queue>
+#include <utility>
 #include <vector>
 #include <sys/stat.h>
 
@@ -37,7 +39,9 @@
 #include "dex/art_dex_file_loader.h"
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_loader.h"
+#include "dex/dex_file_verifier.h"
 #include "dex/dex_file_tracking_registrar.h"
+#include "fault_handler.h"
 #include "gc/scoped_gc_critical_section.h"
 #include "gc/space/image_space.h"
 #include "handle_scope-inl.h"
@@ -64,6 +68,30 @@ using android::base::StringPrintf;
 // If true, we attempt to load the application image if it exists.
 static constexpr bool kEnableAppImage = true;
 
+// Returns the compiled code of `oat_file` that the fault handler should know about. The
+// size is zero if the oat file has no executable code.
+static std::pair<const uint8_t*, size_t> GetGeneratedCodeRange(const OatFile* oat_file) {
+  const uint8_t* code_begin = oat_file->Begin() + oat_file->GetOatHeader().GetExecutableOffset();
+  if (!oat_file->IsExecutable() || code_begin >= oat_file->End()) {
+    return {code_begin, 0u};
+  }
+  return {code_begin, static_cast<size_t>(oat_file->End() - code_begin)};
+}
+
+static void AddGeneratedCodeToFaultManager(const OatFile* oat_file) {
+  auto [code_begin, code_size] = GetGeneratedCodeRange(oat_file);
+  if (code_size != 0u) {
+    fault_manager.AddGeneratedCodeRange(code_begin, code_size);
+  }
+}
+
+static void RemoveGeneratedCodeFromFaultManager(const OatFile* oat_file) {
+  auto [code_begin, code_size] = GetGeneratedCodeRange(oat_file);
+  if (code_size != 0u) {
+    fault_manager.RemoveGeneratedCodeRange(code_begin, code_size);
+  }
+}
+
 const OatFile* OatFileManager::RegisterOatFile(std::unique_ptr<const OatFile> oat_file) {
   WriterMutexLock mu(Thread::Current(), *Locks::oat_file_manager_lock_);
   CHECK(!only_use_system_oat_files_ ||
@@ -82,6 +110,7 @@ const OatFile* OatFileManager::RegisterOatFile(std::unique_ptr<const OatFile> oa
   }
   const OatFile* ret = oat_file.get();
   oat_files_.insert(std::move(oat_file));
+  AddGeneratedCodeToFaultManager(ret);
   return ret;
 }
 
@@ -91,6 +120,7 @@ void OatFileManager::UnRegisterAndDeleteOatFile(const OatFile* oat_file) {
   std::unique_ptr<const OatFile> compare(oat_file);
   auto it = oat_files_.find(compare);
   CHECK(it != oat_files_.end());
+  RemoveGeneratedCodeFromFaultManager(oat_file);
   oat_files_.erase(it);
   compare.release();  // NOLINT b/117926937
 }
@@ -154,6 +184,9 @@ OatFileManager::OatFileManager()
     : only_use_system_oat_files_(false) {}
 
 OatFileManager::~OatFileManager() {
+  for (const std::unique_ptr<const OatFile>& oat_file : oat_files_) {
+    RemoveGeneratedCodeFromFaultManager(oat_file.get());
+  }
   // Explicitly clear oat_files_ since the OatFile destructor calls back into OatFileManager for
   // UnRegisterOatFileLocation.
   oat_files_.clear();
@@ -451,6 +484,32 @@ bool OatFileManager::ShouldLoadAppImage(CheckCollisionResult check_collision_res
   return false;
 }
 
+// Structurally verify the dex files in `dex_files` whose checksums do not match a dex file of
+// `oat_file`. The matching ones were verified by dex2oat when `oat_file` was compiled.
+static bool VerifyDexFilesNotInOatFile(const OatFile& oat_file,
+                                       const std::vector<std::unique_ptr<const DexFile>>& dex_files,
+                                       /*out*/ std::string* error_msg) {
+  ScopedTrace trace(__FUNCTION__);
+  for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+    const uint32_t checksum = dex_file->GetLocationChecksum();
+    if (oat_file.GetOatDexFile(dex_file->GetLocation().c_str(), &checksum) != nullptr) {
+      VLOG(oat) << "Skipping verification of " << dex_file->GetLocation()
+                << ", already verified for " << oat_file.GetLocation();
+      continue;
+    }
+    if (!dex::Verify(dex_file.get(),
+                     dex_file->Begin(),
+                     dex_file->Size(),
+                     dex_file->GetLocation().c_str(),
+                     /*verify_checksum=*/ true,
+                     error_msg)) {
+      *error_msg = "Failed to verify dex file '" + dex_file->GetLocation() + "': " + *error_msg;
+      return false;
+    }
+  }
+  return true;
+}
+
 std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
     const char* dex_location,
     jobject class_loader,
@@ -632,15 +691,25 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
       if (Runtime::Current()->IsDexFileFallbackEnabled()) {
         static constexpr bool kVerifyChecksum = true;
         const ArtDexFileLoader dex_file_loader;
+        // If we rejected an oat file because of class collisions, the dex files it was compiled
+        // from have already been verified by dex2oat. Only verify the ones that do not match it.
+        const bool verify = Runtime::Current()->IsVerificationEnabled();
+        const bool verify_after_open = verify && oat_file != nullptr;
         if (!dex_file_loader.Open(dex_location,
                                   dex_location,
-                                  Runtime::Current()->IsVerificationEnabled(),
+                                  verify && !verify_after_open,
                                   kVerifyChecksum,
                                   /*out*/ &error_msg,
                                   &dex_files)) {
           LOG(WARNING) << error_msg;
           error_msgs->push_back("Failed to open dex files from " + std::string(dex_location)
                                 + " because: " + error_msg);
+        } else if (verify_after_open &&
+                   !VerifyDexFilesNotInOatFile(*oat_file, dex_files, &error_msg)) {
+          LOG(WARNING) << error_msg;
+          error_msgs->push_back("Failed to open dex files from " + std::string(dex_location)
+                                + " because: " + error_msg);
+          dex_files.clear();
         }
       } else {
         error_msgs->push_back("Fallback mode disabled, skipping dex files.");
@@ -656,6 +725,11 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
     Runtime::Current()->GetJit()->RegisterDexFiles(dex_files, class_loader);
   }
 
+  // Verify the classes that dex2oat could not verify off the critical path of the app.
+  if (source_oat_file != nullptr && class_loader != nullptr && runtime->VerifyAfterStartup()) {
+    RunVerificationAfterStartup(MakeNonOwningPointerVector(dex_files), class_loader);
+  }
+
   // Verify if any of the dex files being loaded is already in the class path.
   // If so, report an error with the current stack trace.
   // Most likely the developer didn't intend to do this because it will waste
@@ -1054,16 +1128,199 @@ void OatFileManager::RunBackgroundVerification(const std::vector<const DexFile*>
   }
 }
 
+// Returns whether the class was verified at compile time, in which case the class linker
+// marks it verified when loading it.
+static bool IsVerifiedAtCompileTime(const DexFile& dex_file, uint16_t class_def_index) {
+  const OatDexFile* oat_dex_file = dex_file.GetOatDexFile();
+  if (oat_dex_file == nullptr || oat_dex_file->GetOatFile() == nullptr) {
+    // Not backed by an oat file, nothing was verified ahead of time.
+    return false;
+  }
+  return oat_dex_file->GetOatClass(class_def_index).GetStatus() >= ClassStatus::kVerified;
+}
+
+class StartupVerificationTask final : public Task {
+ public:
+  StartupVerificationTask(const std::vector<const DexFile*>& dex_files, jobject class_loader)
+      : dex_files_(dex_files) {
+    Thread* const self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    // Create a global ref for `class_loader` because it will be accessed from a different thread.
+    class_loader_ = soa.Vm()->AddGlobalRef(self, soa.Decode<mirror::ClassLoader>(class_loader));
+    CHECK(class_loader_ != nullptr);
+  }
+
+  ~StartupVerificationTask() {
+    Thread* const self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    soa.Vm()->DeleteGlobalRef(self, class_loader_);
+  }
+
+  void Run(Thread* self) override {
+    ScopedTrace trace("Verification after startup");
+    ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+    size_t number_of_verified_classes = 0u;
+    for (const DexFile* dex_file : dex_files_) {
+      for (uint32_t cdef_idx = 0; cdef_idx < dex_file->NumClassDefs(); cdef_idx++) {
+        if (IsVerifiedAtCompileTime(*dex_file, cdef_idx)) {
+          continue;
+        }
+        if (Runtime::Current()->IsShuttingDown(self)) {
+          return;
+        }
+        const dex::ClassDef& class_def = dex_file->GetClassDef(cdef_idx);
+
+        // Take handles inside the loop, the app threads have priority over this task.
+        ScopedObjectAccess soa(self);
+        StackHandleScope<2> hs(self);
+        Handle<mirror::ClassLoader> h_loader(hs.NewHandle(
+            soa.Decode<mirror::ClassLoader>(class_loader_)));
+        Handle<mirror::Class> h_class(hs.NewHandle<mirror::Class>(class_linker->FindClass(
+            self,
+            dex_file->GetClassDescriptor(class_def),
+            h_loader)));
+
+        if (h_class == nullptr) {
+          CHECK(self->IsExceptionPending());
+          self->ClearException();
+          continue;
+        }
+
+        if (&h_class->GetDexFile() != dex_file || h_class->IsVerified()) {
+          // Either the descriptor resolves to a class of another dex file, or the app
+          // already verified the class.
+          continue;
+        }
+
+        class_linker->VerifyClass(self, h_class);
+        if (h_class->IsErroneous()) {
+          // ClassLinker::VerifyClass throws, which isn't useful here.
+          CHECK(soa.Self()->IsExceptionPending());
+          soa.Self()->ClearException();
+        } else {
+          ++number_of_verified_classes;
+        }
+      }
+    }
+    VLOG(verifier) << "Verified " << number_of_verified_classes << " classes after startup";
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  const std::vector<const DexFile*> dex_files_;
+  jobject class_loader_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupVerificationTask);
+};
+
+void OatFileManager::RunVerificationAfterStartup(const std::vector<const DexFile*>& dex_files,
+                                                 jobject class_loader) {
+  Runtime* const runtime = Runtime::Current();
+  Thread* const self = Thread::Current();
+
+  if (runtime->IsJavaDebuggable() ||
+      !IsSdkVersionSetAndAtLeast(runtime->GetTargetSdkVersion(), SdkVersion::kQ)) {
+    // Same restrictions as for RunBackgroundVerification.
+    return;
+  }
+
+  auto has_unverified_classes = [](const DexFile* dex_file) {
+    for (uint32_t cdef_idx = 0; cdef_idx < dex_file->NumClassDefs(); cdef_idx++) {
+      if (!IsVerifiedAtCompileTime(*dex_file, cdef_idx)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  if (std::none_of(dex_files.begin(), dex_files.end(), has_unverified_classes)) {
+    return;
+  }
+
+  Task* task = new StartupVerificationTask(dex_files, class_loader);
+  ThreadPool* thread_pool;
+  {
+    WriterMutexLock mu(self, *Locks::oat_file_manager_lock_);
+    thread_pool = startup_verification_thread_pool_.get();
+    if (thread_pool == nullptr) {
+      // Startup is not completed yet, StartVerificationAfterStartup() will add the task.
+      pending_startup_verification_tasks_.push_back(task);
+      return;
+    }
+  }
+  // The task queue lock cannot be acquired while holding the oat file manager lock.
+  thread_pool->AddTask(self, task);
+}
+
+void OatFileManager::StartVerificationAfterStartup() {
+  Thread* const self = Thread::Current();
+  if (Runtime::Current()->IsShuttingDown(self)) {
+    // Not allowed to create new threads during runtime shutdown.
+    return;
+  }
+
+  // Use the priority of background threads, so that the app threads are not slowed down.
+  static constexpr int kStartupVerificationThreadPriority = 10;
+  std::unique_ptr<ThreadPool> thread_pool(
+      new ThreadPool("Startup verification thread pool", /* num_threads= */ 1));
+  thread_pool->SetPthreadPriority(kStartupVerificationThreadPriority);
+  thread_pool->StartWorkers(self);
+
+  ThreadPool* started_thread_pool = thread_pool.get();
+  std::vector<Task*> pending_tasks;
+  {
+    WriterMutexLock mu(self, *Locks::oat_file_manager_lock_);
+    if (startup_verification_thread_pool_ != nullptr) {
+      // Already started. Delete the new thread pool outside of the lock.
+      return;
+    }
+    startup_verification_thread_pool_ = std::move(thread_pool);
+    pending_tasks.swap(pending_startup_verification_tasks_);
+  }
+  VLOG(startup) << "Verifying the classes of " << pending_tasks.size()
+                << " class loader(s) after startup";
+  for (Task* task : pending_tasks) {
+    started_thread_pool->AddTask(self, task);
+  }
+}
+
 void OatFileManager::WaitForWorkersToBeCreated() {
   DCHECK(!Runtime::Current()->IsShuttingDown(Thread::Current()))
       << "Cannot create new threads during runtime shutdown";
   if (verification_thread_pool_ != nullptr) {
     verification_thread_pool_->WaitForWorkersToBeCreated();
   }
+  ThreadPool* startup_verification_thread_pool;
+  {
+    ReaderMutexLock mu(Thread::Current(), *Locks::oat_file_manager_lock_);
+    startup_verification_thread_pool = startup_verification_thread_pool_.get();
+  }
+  if (startup_verification_thread_pool != nullptr) {
+    startup_verification_thread_pool->WaitForWorkersToBeCreated();
+  }
 }
 
 void OatFileManager::DeleteThreadPool() {
   verification_thread_pool_.reset(nullptr);
+  Thread* const self = Thread::Current();
+  std::unique_ptr<ThreadPool> startup_verification_thread_pool;
+  std::vector<Task*> pending_tasks;
+  {
+    WriterMutexLock mu(self, *Locks::oat_file_manager_lock_);
+    startup_verification_thread_pool = std::move(startup_verification_thread_pool_);
+    pending_tasks.swap(pending_startup_verification_tasks_);
+  }
+  // Delete the thread pool and the tasks that never ran outside of the lock. The tasks need
+  // the mutator lock to release their class loader, drop them if the shutdown thread is
+  // already detached.
+  startup_verification_thread_pool.reset(nullptr);
+  if (self != nullptr) {
+    for (Task* task : pending_tasks) {
+      task->Finalize();
+    }
+  }
 }
 
 void OatFileManager::WaitForBackgroundVerificationTasks() {
@@ -39,6 +39,7 @@ class ClassLoaderContext;
 class DexFile;
 class MemMap;
 class OatFile;
+class Task;
 class ThreadPool;
 
 // Class for dealing with oat file management.
@@ -127,12 +128,23 @@ class OatFileManager {
                                  jobject class_loader,
                                  const char* class_loader_context);
 
+  // Verify the classes of the given dex files that were not verified at compile time on a
+  // low-priority background thread, so that they are not verified at first use. The
+  // verification is deferred until StartVerificationAfterStartup() is called.
+  void RunVerificationAfterStartup(const std::vector<const DexFile*>& dex_files,
+                                   jobject class_loader)
+      REQUIRES(!Locks::oat_file_manager_lock_);
+
+  // Start the verification requested by RunVerificationAfterStartup(). This is called once
+  // startup is completed.
+  void StartVerificationAfterStartup() REQUIRES(!Locks::oat_file_manager_lock_);
+
   // Wait for thread pool workers to be created. This is used during shutdown as
   // threads are not allowed to attach while runtime is in shutdown lock.
   void WaitForWorkersToBeCreated();
 
-  // If allocated, delete a thread pool of background verification threads.
-  void DeleteThreadPool();
+  // If allocated, delete the thread pools of background verification threads.
+  void DeleteThreadPool() REQUIRES(!Locks::oat_file_manager_lock_);
 
   // Wait for all background verification tasks to finish. This is only used by tests.
   void WaitForBackgroundVerificationTasks();
@@ -193,6 +205,13 @@ class OatFileManager {
   // Single-thread pool used to run the verifier in the background.
   std::unique_ptr<ThreadPool> verification_thread_pool_;
 
+  // Single-thread pool used to verify the classes of app oat files once startup is completed,
+  // and the verification tasks waiting for it to be created.
+  std::unique_ptr<ThreadPool> startup_verification_thread_pool_
+      GUARDED_BY(Locks::oat_file_manager_lock_);
+  std::vector<Task*> pending_startup_verification_tasks_
+      GUARDED_BY(Locks::oat_file_manager_lock_);
+
   DISALLOW_COPY_AND_ASSIGN(OatFileManager);
 };
 
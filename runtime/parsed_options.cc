@@ -156,6 +156,47 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:ConcGCThreads=_")
           .WithType<unsigned int>()
           .IntoKey(M::ConcGCThreads)
+      .Define("-XX:ParallelCCMarking:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::ParallelCCMarking)
+      .Define("-XX:ParallelCCEvacuation:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::ParallelCCEvacuation)
+      .Define("-XX:NumaAwareHeap:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::NumaAwareHeap)
+      .Define("-XX:NonMovingSpaceTrim:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::NonMovingSpaceTrim)
+      .Define("-XX:HugePageHeap:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::HugePageHeap)
+      .Define("-XX:ParallelReferenceProcessing:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::ParallelReferenceProcessing)
+      .Define("-XX:ParallelSystemWeakSweeping:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::ParallelSystemWeakSweeping)
+      .Define("-XX:GenerationalCCRememberedSet:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::GenerationalCCRememberedSet)
+      .Define("-XX:GcPauseTargetMs=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::GcPauseTargetMs)
+      .Define("-XX:GcCpuFractionTarget=_")
+          .WithType<double>().WithRange(0.0, 1.0)
+          .IntoKey(M::GcCpuFractionTarget)
+      .Define("-XX:RegionEvacuationCopyBudgetKB=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::RegionEvacuationCopyBudgetKB)
       .Define("-XX:FinalizerTimeoutMs=_")
           .WithType<unsigned int>()
           .IntoKey(M::FinalizerTimeoutMs)
@@ -193,10 +234,26 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::DumpNativeStackOnSigQuit)
+      .Define("-XX:ForkedHprofDump:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::ForkedHprofDump)
+      .Define("-XX:CompressHprofDump:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::CompressHprofDump)
+      .Define("-XX:DeduplicateHprofArrays:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::DeduplicateHprofArrays)
       .Define("-XX:MadviseRandomAccess:_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::MadviseRandomAccess)
+      .Define("-XX:VerifyAfterStartup:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::VerifyAfterStartup)
       .Define("-Xusejit:_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
@@ -205,6 +262,10 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::UseTieredJitCompilation)
+      .Define("-Xusebaselineplusjit:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::UseBaselinePlusJitCompilation)
       .Define("-Xjitinitialsize:_")
           .WithType<MemoryKiB>()
           .IntoKey(M::JITCodeCacheInitialCapacity)
@@ -226,9 +287,22 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xjittransitionweight:_")
           .WithType<unsigned int>()
           .IntoKey(M::JITInvokeTransitionWeight)
+      .Define("-Xjitbaselineplusqueuethreshold:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITBaselinePlusQueueThreshold)
       .Define("-Xjitpthreadpriority:_")
           .WithType<int>()
           .IntoKey(M::JITPoolThreadPthreadPriority)
+      .Define("-Xjitthreadcount:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITPoolThreadCount)
+      .Define("-Xjitwarmstartfile:_")
+          .WithType<std::string>()
+          .IntoKey(M::JITWarmStartFile)
+      .Define("-Xjitsegmentedcodecache:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITSegmentedCodeCache)
       .Define("-Xjitsaveprofilinginfo")
           .WithType<ProfileSaverOptions>()
           .AppendValues()
@@ -281,6 +355,9 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xstackdumplockprofthreshold:_")
           .WithType<unsigned int>()
           .IntoKey(M::StackDumpLockProfThreshold)
+      .Define("-Xlockcontentionsampling:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::LockContentionSamplingPeriod)
       .Define("-Xmethod-trace")
           .IntoKey(M::MethodTrace)
       .Define("-Xmethod-trace-file:_")
@@ -595,9 +672,9 @@ bool ParsedOptions::DoParse(const RuntimeOptions& options,
     args.SetIfMissing(M::ClassPath, std::string(getenv("CLASSPATH")));
   }
 
-  // Default to number of processors minus one since the main GC thread also does work.
+  // Default to number of usable processors minus one since the main GC thread also does work.
   args.SetIfMissing(M::ParallelGCThreads, gc::Heap::kDefaultEnableParallelGC ?
-      static_cast<unsigned int>(sysconf(_SC_NPROCESSORS_CONF) - 1u) : 0u);
+      static_cast<unsigned int>(GetUsableCpuCount() - 1u) : 0u);
 
   // -verbose:
   {
@@ -761,6 +838,17 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:+DisableExplicitGC\n");
   UsageMessage(stream, "  -XX:ParallelGCThreads=integervalue\n");
   UsageMessage(stream, "  -XX:ConcGCThreads=integervalue\n");
+  UsageMessage(stream, "  -XX:ParallelCCMarking:{false,true}\n");
+  UsageMessage(stream, "  -XX:ParallelCCEvacuation:{false,true}\n");
+  UsageMessage(stream, "  -XX:NumaAwareHeap:{false,true}\n");
+  UsageMessage(stream, "  -XX:NonMovingSpaceTrim:{false,true}\n");
+  UsageMessage(stream, "  -XX:HugePageHeap:{false,true}\n");
+  UsageMessage(stream, "  -XX:ParallelReferenceProcessing:{false,true}\n");
+  UsageMessage(stream, "  -XX:ParallelSystemWeakSweeping:{false,true}\n");
+  UsageMessage(stream, "  -XX:GenerationalCCRememberedSet:{false,true}\n");
+  UsageMessage(stream, "  -XX:GcPauseTargetMs=integervalue\n");
+  UsageMessage(stream, "  -XX:GcCpuFractionTarget=doublevalue\n");
+  UsageMessage(stream, "  -XX:RegionEvacuationCopyBudgetKB=integervalue\n");
   UsageMessage(stream, "  -XX:FinalizerTimeoutMs=integervalue\n");
   UsageMessage(stream, "  -XX:MaxSpinsBeforeThinLockInflation=integervalue\n");
   UsageMessage(stream, "  -XX:LongPauseLogThreshold=integervalue\n");
@@ -775,7 +863,11 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:LargeObjectThreshold=N\n");
   UsageMessage(stream, "  -XX:StopForNativeAllocs=N\n");
   UsageMessage(stream, "  -XX:DumpNativeStackOnSigQuit=booleanvalue\n");
+  UsageMessage(stream, "  -XX:ForkedHprofDump:{false,true}\n");
+  UsageMessage(stream, "  -XX:CompressHprofDump:{false,true}\n");
+  UsageMessage(stream, "  -XX:DeduplicateHprofArrays:{false,true}\n");
   UsageMessage(stream, "  -XX:MadviseRandomAccess:booleanvalue\n");
+  UsageMessage(stream, "  -XX:VerifyAfterStartup:{false,true}\n");
   UsageMessage(stream, "  -XX:SlowDebug={false,true}\n");
   UsageMessage(stream, "  -Xmethod-trace\n");
   UsageMessage(stream, "  -Xmethod-trace-file:filename\n");
@@ -797,6 +889,11 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xjitwarmupthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitosrthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitprithreadweight:integervalue\n");
+  UsageMessage(stream, "  -Xusebaselineplusjit:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitbaselineplusqueuethreshold:integervalue\n");
+  UsageMessage(stream, "  -Xjitthreadcount:integervalue\n");
+  UsageMessage(stream, "  -Xjitwarmstartfile:file-path\n");
+  UsageMessage(stream, "  -Xjitsegmentedcodecache:booleanvalue\n");
   UsageMessage(stream, "  -X[no]relocate\n");
   UsageMessage(stream, "  -X[no]dex2oat (Whether to invoke dex2oat on the application)\n");
   UsageMessage(stream, "  -X[no]image-dex2oat (Whether to create and use a boot image)\n");
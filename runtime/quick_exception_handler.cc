@@ -21,6 +21,7 @@
 #include "base/enums.h"
 #include "base/logging.h"  // For VLOG_IS_ON.
 #include "base/systrace.h"
+#include "dex/code_item_accessors-inl.h"
 #include "dex/dex_file_types.h"
 #include "dex/dex_instruction.h"
 #include "entrypoints/entrypoint_utils.h"
@@ -100,7 +101,11 @@ class CatchBlockStackVisitor final : public StackVisitor {
   bool HandleTryItems(ArtMethod* method)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     uint32_t dex_pc = dex::kDexNoIndex;
-    if (!method->IsNative()) {
+    // A method without try items cannot catch the exception, so do not spend time decoding
+    // its dex pc and looking for catch handlers. Most frames we unwind are like that.
+    const dex::CodeItem* code_item = method->GetCodeItem();
+    if (code_item != nullptr &&
+        CodeItemDataAccessor(*method->GetDexFile(), code_item).TriesSize() != 0u) {
       dex_pc = GetDexPc();
     }
     if (dex_pc != dex::kDexNoIndex) {
@@ -117,15 +122,16 @@ class CatchBlockStackVisitor final : public StackVisitor {
         exception_handler_->SetHandlerQuickFrame(GetCurrentQuickFrame());
         exception_handler_->SetHandlerMethodHeader(GetCurrentOatQuickMethodHeader());
         return false;  // End stack walk.
-      } else if (UNLIKELY(GetThread()->HasDebuggerShadowFrames())) {
-        // We are going to unwind this frame. Did we prepare a shadow frame for debugging?
-        size_t frame_id = GetFrameId();
-        ShadowFrame* frame = GetThread()->FindDebuggerShadowFrame(frame_id);
-        if (frame != nullptr) {
-          // We will not execute this shadow frame so we can safely deallocate it.
-          GetThread()->RemoveDebuggerShadowFrameMapping(frame_id);
-          ShadowFrame::DeleteDeoptimizedFrame(frame);
-        }
+      }
+    }
+    if (UNLIKELY(GetThread()->HasDebuggerShadowFrames()) && !method->IsNative()) {
+      // We are going to unwind this frame. Did we prepare a shadow frame for debugging?
+      size_t frame_id = GetFrameId();
+      ShadowFrame* frame = GetThread()->FindDebuggerShadowFrame(frame_id);
+      if (frame != nullptr) {
+        // We will not execute this shadow frame so we can safely deallocate it.
+        GetThread()->RemoveDebuggerShadowFrameMapping(frame_id);
+        ShadowFrame::DeleteDeoptimizedFrame(frame);
       }
     }
     return true;  // Continue stack walk.
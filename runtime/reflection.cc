@@ -41,6 +41,13 @@ namespace {
 
 using android::base::StringPrintf;
 
+// Returns the boxing class that declares `value_of`. Boxed arguments are matched by comparing
+// the class pointer, which is cheaper than comparing descriptors.
+ALWAYS_INLINE ObjPtr<mirror::Class> GetBoxClass(jmethodID value_of)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  return jni::DecodeArtMethod(value_of)->GetDeclaringClass();
+}
+
 class ArgArray {
  public:
   ArgArray(const char* shorty, uint32_t shorty_len)
@@ -259,15 +266,15 @@ class ArgArray {
         }
       }
 
-#define DO_FIRST_ARG(match_descriptor, get_fn, append) { \
+#define DO_FIRST_ARG(box_value_of, get_fn, append) { \
           if (LIKELY(arg != nullptr && \
-              arg->GetClass()->DescriptorEquals(match_descriptor))) { \
+              arg->GetClass() == GetBoxClass(box_value_of))) { \
             ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
             append(primitive_field-> get_fn(arg.Get()));
 
-#define DO_ARG(match_descriptor, get_fn, append) \
+#define DO_ARG(box_value_of, get_fn, append) \
           } else if (LIKELY(arg != nullptr && \
-                            arg->GetClass<>()->DescriptorEquals(match_descriptor))) { \
+                            arg->GetClass<>() == GetBoxClass(box_value_of))) { \
             ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
             append(primitive_field-> get_fn(arg.Get()));
 
@@ -293,54 +300,54 @@ class ArgArray {
           Append(arg.Get());
           break;
         case 'Z':
-          DO_FIRST_ARG("Ljava/lang/Boolean;", GetBoolean, Append)
+          DO_FIRST_ARG(WellKnownClasses::java_lang_Boolean_valueOf, GetBoolean, Append)
           DO_FAIL("boolean")
           break;
         case 'B':
-          DO_FIRST_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(WellKnownClasses::java_lang_Byte_valueOf, GetByte, Append)
           DO_FAIL("byte")
           break;
         case 'C':
-          DO_FIRST_ARG("Ljava/lang/Character;", GetChar, Append)
+          DO_FIRST_ARG(WellKnownClasses::java_lang_Character_valueOf, GetChar, Append)
           DO_FAIL("char")
           break;
         case 'S':
-          DO_FIRST_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(WellKnownClasses::java_lang_Short_valueOf, GetShort, Append)
+          DO_ARG(WellKnownClasses::java_lang_Byte_valueOf, GetByte, Append)
           DO_FAIL("short")
           break;
         case 'I':
-          DO_FIRST_ARG("Ljava/lang/Integer;", GetInt, Append)
-          DO_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(WellKnownClasses::java_lang_Integer_valueOf, GetInt, Append)
+          DO_ARG(WellKnownClasses::java_lang_Character_valueOf, GetChar, Append)
+          DO_ARG(WellKnownClasses::java_lang_Short_valueOf, GetShort, Append)
+          DO_ARG(WellKnownClasses::java_lang_Byte_valueOf, GetByte, Append)
           DO_FAIL("int")
           break;
         case 'J':
-          DO_FIRST_ARG("Ljava/lang/Long;", GetLong, AppendWide)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendWide)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendWide)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendWide)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendWide)
+          DO_FIRST_ARG(WellKnownClasses::java_lang_Long_valueOf, GetLong, AppendWide)
+          DO_ARG(WellKnownClasses::java_lang_Integer_valueOf, GetInt, AppendWide)
+          DO_ARG(WellKnownClasses::java_lang_Character_valueOf, GetChar, AppendWide)
+          DO_ARG(WellKnownClasses::java_lang_Short_valueOf, GetShort, AppendWide)
+          DO_ARG(WellKnownClasses::java_lang_Byte_valueOf, GetByte, AppendWide)
           DO_FAIL("long")
           break;
         case 'F':
-          DO_FIRST_ARG("Ljava/lang/Float;", GetFloat, AppendFloat)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendFloat)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendFloat)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendFloat)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendFloat)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendFloat)
+          DO_FIRST_ARG(WellKnownClasses::java_lang_Float_valueOf, GetFloat, AppendFloat)
+          DO_ARG(WellKnownClasses::java_lang_Long_valueOf, GetLong, AppendFloat)
+          DO_ARG(WellKnownClasses::java_lang_Integer_valueOf, GetInt, AppendFloat)
+          DO_ARG(WellKnownClasses::java_lang_Character_valueOf, GetChar, AppendFloat)
+          DO_ARG(WellKnownClasses::java_lang_Short_valueOf, GetShort, AppendFloat)
+          DO_ARG(WellKnownClasses::java_lang_Byte_valueOf, GetByte, AppendFloat)
           DO_FAIL("float")
           break;
         case 'D':
-          DO_FIRST_ARG("Ljava/lang/Double;", GetDouble, AppendDouble)
-          DO_ARG("Ljava/lang/Float;", GetFloat, AppendDouble)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendDouble)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendDouble)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendDouble)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendDouble)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendDouble)
+          DO_FIRST_ARG(WellKnownClasses::java_lang_Double_valueOf, GetDouble, AppendDouble)
+          DO_ARG(WellKnownClasses::java_lang_Float_valueOf, GetFloat, AppendDouble)
+          DO_ARG(WellKnownClasses::java_lang_Long_valueOf, GetLong, AppendDouble)
+          DO_ARG(WellKnownClasses::java_lang_Integer_valueOf, GetInt, AppendDouble)
+          DO_ARG(WellKnownClasses::java_lang_Character_valueOf, GetChar, AppendDouble)
+          DO_ARG(WellKnownClasses::java_lang_Short_valueOf, GetShort, AppendDouble)
+          DO_ARG(WellKnownClasses::java_lang_Byte_valueOf, GetByte, AppendDouble)
           DO_FAIL("double")
           break;
 #ifndef NDEBUG
@@ -25,6 +25,7 @@
 
 #include <fcntl.h>
 #include <signal.h>
+#include <sys/resource.h>
 #include <sys/syscall.h>
 
 #if defined(__APPLE__)
@@ -34,6 +35,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
+#include <sstream>
 #include <thread>
 #include <unordered_set>
 #include <vector>
@@ -97,6 +99,7 @@
 #include "jni/jni_id_manager.h"
 #include "jni_id_type.h"
 #include "linear_alloc.h"
+#include "lock_contention_sampler.h"
 #include "memory_representation.h"
 #include "mirror/array.h"
 #include "mirror/class-alloc-inl.h"
@@ -163,6 +166,7 @@
 #include "signal_set.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "ti/agent.h"
 #include "trace.h"
 #include "transaction.h"
@@ -291,6 +295,9 @@ Runtime::Runtime()
       dedupe_hidden_api_warnings_(true),
       hidden_api_access_event_log_rate_(0),
       dump_native_stack_on_sig_quit_(true),
+      forked_hprof_dump_(false),
+      compress_hprof_dump_(false),
+      deduplicate_hprof_arrays_(false),
       pruned_dalvik_cache_(false),
       // Initially assume we perceive jank in case the process state is never updated.
       process_state_(kProcessStateJankPerceptible),
@@ -307,6 +314,7 @@ Runtime::Runtime()
   callbacks_.reset(new RuntimeCallbacks());
   for (size_t i = 0; i <= static_cast<size_t>(DeoptimizationKind::kLast); ++i) {
     deoptimization_counts_[i] = 0u;
+    deoptimization_time_ns_[i] = 0u;
   }
 }
 
@@ -682,6 +690,10 @@ void Runtime::PreZygoteFork() {
     GetJit()->PreZygoteFork();
   }
   heap_->PreZygoteFork();
+  // Release the pages of free arenas. Otherwise they stay dirty in the zygote and every child
+  // copies them on write when it reuses the arenas for compilation or verification.
+  arena_pool_->TrimMaps();
+  jit_arena_pool_->TrimMaps();
   PreZygoteForkNativeBridge();
 }
 
@@ -702,6 +714,15 @@ void Runtime::CallExitHook(jint status) {
 }
 
 void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor) {
+  Thread* const self = Thread::Current();
+  // The workers take the mutator lock shared, which would deadlock if mutators are suspended.
+  if (GetHeap()->UseParallelSystemWeakSweeping() &&
+      GetHeap()->GetThreadPool() != nullptr &&
+      InJankPerceptibleProcessState() &&
+      !Locks::mutator_lock_->IsExclusiveHeld(self)) {
+    SweepSystemWeaksParallel(self, visitor);
+    return;
+  }
   GetInternTable()->SweepInternTableWeaks(visitor);
   GetMonitorList()->SweepMonitorList(visitor);
   GetJavaVM()->SweepJniWeakGlobals(visitor);
@@ -722,6 +743,60 @@ void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor) {
   }
 }
 
+void Runtime::SweepSystemWeaksParallel(Thread* self, IsMarkedVisitor* visitor) {
+  // Every holder is guarded by its own lock so the holders can be swept concurrently. The
+  // IsMarked implementations of the concurrent collectors are thread safe.
+  std::vector<std::function<void()>> sweeps;
+  sweeps.push_back([this, visitor]() NO_THREAD_SAFETY_ANALYSIS {
+    GetInternTable()->SweepInternTableWeaks(visitor);
+  });
+  sweeps.push_back([this, visitor]() NO_THREAD_SAFETY_ANALYSIS {
+    GetMonitorList()->SweepMonitorList(visitor);
+  });
+  sweeps.push_back([this, visitor]() NO_THREAD_SAFETY_ANALYSIS {
+    GetJavaVM()->SweepJniWeakGlobals(visitor);
+  });
+  sweeps.push_back([this, visitor]() NO_THREAD_SAFETY_ANALYSIS {
+    GetHeap()->SweepAllocationRecords(visitor);
+  });
+  if (GetJit() != nullptr) {
+    sweeps.push_back([this, visitor]() NO_THREAD_SAFETY_ANALYSIS {
+      GetJit()->GetCodeCache()->SweepRootTables(visitor);
+    });
+  }
+  sweeps.push_back([this, visitor]() NO_THREAD_SAFETY_ANALYSIS {
+    thread_list_->SweepInterpreterCaches(visitor);
+  });
+  for (gc::AbstractSystemWeakHolder* holder : system_weak_holders_) {
+    sweeps.push_back([holder, visitor]() NO_THREAD_SAFETY_ANALYSIS {
+      holder->Sweep(visitor);
+    });
+  }
+  ThreadPool* const thread_pool = GetHeap()->GetThreadPool();
+  std::vector<Task*> tasks;
+  tasks.reserve(sweeps.size());
+  for (const std::function<void()>& sweep : sweeps) {
+    tasks.push_back(new FunctionTask([&sweep](Thread* worker) {
+      if (Locks::mutator_lock_->IsSharedHeld(worker)) {
+        // The GC thread helping out from ThreadPool::Wait.
+        sweep();
+      } else {
+        ReaderMutexLock mu(worker, *Locks::mutator_lock_);
+        sweep();
+      }
+    }));
+  }
+  thread_pool->AddTasks(self, tasks);
+  const size_t thread_count = std::min(
+      {GetHeap()->ClampGcThreadCount(GetHeap()->GetConcGCThreadCount() + 1),
+       thread_pool->GetThreadCount() + 1,
+       sweeps.size()});
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ true);
+  thread_pool->StopWorkers(self);
+}
+
 bool Runtime::ParseOptions(const RuntimeOptions& raw_options,
                            bool ignore_unrecognized,
                            RuntimeArgumentMap* runtime_options) {
@@ -887,6 +962,7 @@ bool Runtime::Start() {
     ScopedTrace trace2("InitNativeMethods");
     InitNativeMethods();
   }
+  RecordStartupPhase("Native methods initialized");
 
   // IntializeIntrinsics needs to be called after the WellKnownClasses::Init in InitNativeMethods
   // because in checking the invocation types of intrinsic methods ArtMethod::GetInvokeType()
@@ -917,6 +993,7 @@ bool Runtime::Start() {
     }
     CreateJitCodeCache(/*rwx_memory_allowed=*/true);
     CreateJit();
+    RecordStartupPhase("JIT created");
   }
 
   // Send the start phase event. We have to wait till here as this is when the main thread peer
@@ -927,6 +1004,7 @@ bool Runtime::Start() {
   }
 
   system_class_loader_ = CreateSystemClassLoader(this);
+  RecordStartupPhase("System class loader created");
 
   if (!is_zygote_) {
     if (is_native_bridge_loaded_) {
@@ -943,6 +1021,7 @@ bool Runtime::Start() {
   }
 
   StartDaemonThreads();
+  RecordStartupPhase("Daemon threads started");
 
   // Make sure the environment is still clean (no lingering local refs from starting daemon
   // threads).
@@ -964,6 +1043,12 @@ bool Runtime::Start() {
   }
 
   VLOG(startup) << "Runtime::Start exiting";
+  RecordStartupPhase("Runtime::Start finished");
+  if (VLOG_IS_ON(startup)) {
+    std::ostringstream oss;
+    DumpStartupPhases(oss);
+    LOG(INFO) << oss.str();
+  }
   finished_starting_ = true;
 
   if (trace_config_.get() != nullptr && trace_config_->trace_file != "") {
@@ -1049,7 +1134,7 @@ void Runtime::InitNonZygoteOrPostFork(
     constexpr size_t kStackSize = 64 * KB;
     constexpr size_t kMaxRuntimeWorkers = 4u;
     const size_t num_workers =
-        std::min(static_cast<size_t>(std::thread::hardware_concurrency()), kMaxRuntimeWorkers);
+        std::min(GetUsableCpuCount(), kMaxRuntimeWorkers);
     MutexLock mu(Thread::Current(), *Locks::runtime_thread_pool_lock_);
     CHECK(thread_pool_ == nullptr);
     thread_pool_.reset(new ThreadPool("Runtime", num_workers, /*create_peers=*/false, kStackSize));
@@ -1121,29 +1206,51 @@ static size_t OpenBootDexFiles(ArrayRef<const std::string> dex_filenames,
                                ArrayRef<const std::string> dex_locations,
                                std::vector<std::unique_ptr<const DexFile>>* dex_files) {
   DCHECK(dex_files != nullptr) << "OpenDexFiles: out-param is nullptr";
-  size_t failure_count = 0;
   const ArtDexFileLoader dex_file_loader;
-  for (size_t i = 0; i < dex_filenames.size(); i++) {
-    const char* dex_filename = dex_filenames[i].c_str();
-    const char* dex_location = dex_locations[i].c_str();
-    static constexpr bool kVerifyChecksum = true;
-    std::string error_msg;
-    if (!OS::FileExists(dex_filename)) {
-      LOG(WARNING) << "Skipping non-existent dex file '" << dex_filename << "'";
-      continue;
+  const bool verify = Runtime::Current()->IsVerificationEnabled();
+  // Opening, checksumming and verifying the components are independent of each other, so do
+  // them on a few transient threads. Results are collected per component to keep the order.
+  std::vector<std::vector<std::unique_ptr<const DexFile>>> opened(dex_filenames.size());
+  std::atomic<size_t> next_index(0u);
+  std::atomic<size_t> failure_count(0u);
+  auto open_dex_files = [&]() {
+    for (size_t i = next_index.fetch_add(1u, std::memory_order_relaxed);
+         i < dex_filenames.size();
+         i = next_index.fetch_add(1u, std::memory_order_relaxed)) {
+      const char* dex_filename = dex_filenames[i].c_str();
+      const char* dex_location = dex_locations[i].c_str();
+      static constexpr bool kVerifyChecksum = true;
+      std::string error_msg;
+      if (!OS::FileExists(dex_filename)) {
+        LOG(WARNING) << "Skipping non-existent dex file '" << dex_filename << "'";
+        continue;
+      }
+      if (!dex_file_loader.Open(dex_filename,
+                                dex_location,
+                                verify,
+                                kVerifyChecksum,
+                                &error_msg,
+                                &opened[i])) {
+        LOG(WARNING) << "Failed to open .dex from file '" << dex_filename << "': " << error_msg;
+        failure_count.fetch_add(1u, std::memory_order_relaxed);
+      }
     }
-    bool verify = Runtime::Current()->IsVerificationEnabled();
-    if (!dex_file_loader.Open(dex_filename,
-                              dex_location,
-                              verify,
-                              kVerifyChecksum,
-                              &error_msg,
-                              dex_files)) {
-      LOG(WARNING) << "Failed to open .dex from file '" << dex_filename << "': " << error_msg;
-      ++failure_count;
+  };
+  size_t num_threads = std::min(GetUsableCpuCount(), dex_filenames.size());
+  std::vector<std::thread> helpers;
+  for (size_t i = 1; i < num_threads; ++i) {
+    helpers.emplace_back(open_dex_files);
+  }
+  open_dex_files();
+  for (std::thread& helper : helpers) {
+    helper.join();
+  }
+  for (std::vector<std::unique_ptr<const DexFile>>& component : opened) {
+    for (std::unique_ptr<const DexFile>& dex_file : component) {
+      dex_files->push_back(std::move(dex_file));
     }
   }
-  return failure_count;
+  return failure_count.load(std::memory_order_relaxed);
 }
 
 void Runtime::SetSentinel(ObjPtr<mirror::Object> sentinel) {
@@ -1191,6 +1298,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   using Opt = RuntimeArgumentMap;
   Opt runtime_options(std::move(runtime_options_in));
   ScopedTrace trace(__FUNCTION__);
+  RecordStartupPhase("Runtime::Init entered");
   CHECK_EQ(sysconf(_SC_PAGE_SIZE), kPageSize);
 
   // Early override for logging output.
@@ -1239,6 +1347,9 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   Thread::SetSensitiveThreadHook(runtime_options.GetOrDefault(Opt::HookIsSensitiveThread));
   Monitor::Init(runtime_options.GetOrDefault(Opt::LockProfThreshold),
                 runtime_options.GetOrDefault(Opt::StackDumpLockProfThreshold));
+  lock_contention_sampler_.reset(new LockContentionSampler());
+  lock_contention_sampler_->SetSamplingPeriod(
+      runtime_options.GetOrDefault(Opt::LockContentionSamplingPeriod));
 
   image_location_ = runtime_options.GetOrDefault(Opt::Image);
 
@@ -1288,6 +1399,9 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   is_explicit_gc_disabled_ = runtime_options.Exists(Opt::DisableExplicitGC);
   image_dex2oat_enabled_ = runtime_options.GetOrDefault(Opt::ImageDex2Oat);
   dump_native_stack_on_sig_quit_ = runtime_options.GetOrDefault(Opt::DumpNativeStackOnSigQuit);
+  forked_hprof_dump_ = runtime_options.GetOrDefault(Opt::ForkedHprofDump);
+  compress_hprof_dump_ = runtime_options.GetOrDefault(Opt::CompressHprofDump);
+  deduplicate_hprof_arrays_ = runtime_options.GetOrDefault(Opt::DeduplicateHprofArrays);
 
   vfprintf_ = runtime_options.GetOrDefault(Opt::HookVfprintf);
   exit_ = runtime_options.GetOrDefault(Opt::HookExit);
@@ -1350,6 +1464,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   experimental_flags_ = runtime_options.GetOrDefault(Opt::Experimental);
   is_low_memory_mode_ = runtime_options.Exists(Opt::LowMemoryMode);
   madvise_random_access_ = runtime_options.GetOrDefault(Opt::MadviseRandomAccess);
+  verify_after_startup_ = runtime_options.GetOrDefault(Opt::VerifyAfterStartup);
 
   jni_ids_indirection_ = runtime_options.GetOrDefault(Opt::OpaqueJniIds);
   automatically_set_jni_ids_indirection_ =
@@ -1414,10 +1529,25 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
                        xgc_option.measure_,
                        runtime_options.GetOrDefault(Opt::EnableHSpaceCompactForOOM),
                        use_generational_cc,
+                       runtime_options.GetOrDefault(Opt::ParallelCCMarking),
+                       runtime_options.GetOrDefault(Opt::ParallelCCEvacuation),
+                       runtime_options.GetOrDefault(Opt::NumaAwareHeap),
+                       runtime_options.GetOrDefault(Opt::NonMovingSpaceTrim),
+                       runtime_options.GetOrDefault(Opt::HugePageHeap),
+                       runtime_options.GetOrDefault(Opt::ParallelReferenceProcessing),
+                       runtime_options.GetOrDefault(Opt::ParallelSystemWeakSweeping),
+                       runtime_options.GetOrDefault(Opt::GenerationalCCRememberedSet),
+                       MsToNs(runtime_options.GetOrDefault(Opt::GcPauseTargetMs)),
+                       runtime_options.GetOrDefault(Opt::GcCpuFractionTarget),
+                       runtime_options.GetOrDefault(Opt::RegionEvacuationCopyBudgetKB) * KB,
                        runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs),
                        runtime_options.Exists(Opt::DumpRegionInfoBeforeGC),
                        runtime_options.Exists(Opt::DumpRegionInfoAfterGC),
                        image_space_loading_order_);
+  RecordStartupPhase("Heap created");
+  VLOG(startup) << "Usable CPUs: " << GetUsableCpuCount()
+                << ", parallel GC threads: " << heap_->GetParallelGCThreadCount()
+                << ", concurrent GC threads: " << heap_->GetConcGCThreadCount();
 
   if (!heap_->HasBootImageSpace() && !allow_dex_file_fallback_) {
     LOG(ERROR) << "Dex file fallback disabled, cannot continue without image.";
@@ -1633,6 +1763,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   }
 
   CHECK(class_linker_ != nullptr);
+  RecordStartupPhase("Class linker initialized");
 
   verifier::ClassVerifier::Init(class_linker_);
 
@@ -1787,6 +1918,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
     ScopedObjectAccess soa(self);
     callbacks_->NextRuntimePhase(RuntimePhaseCallback::RuntimePhase::kInitialAgents);
   }
+  RecordStartupPhase("Plugins and agents loaded");
 
   if (IsZygote() && IsPerfettoHprofEnabled()) {
     constexpr const char* plugin_name = kIsDebugBuild ?
@@ -1797,6 +1929,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   }
 
   VLOG(startup) << "Runtime::Init exiting";
+  RecordStartupPhase("Runtime::Init finished");
 
   // Set OnlyUseSystemOatFiles only after boot classpath has been set up.
   if (runtime_options.Exists(Opt::OnlyUseSystemOatFiles)) {
@@ -2005,11 +2138,41 @@ void Runtime::DumpDeoptimizations(std::ostream& os) {
          << GetDeoptimizationKindName(static_cast<DeoptimizationKind>(i))
          << " deoptimizations: "
          << deoptimization_counts_[i]
-         << "\n";
+         << " (time to build interpreter frames: "
+         << PrettyDuration(deoptimization_time_ns_[i])
+         << ")\n";
     }
   }
 }
 
+void Runtime::RecordStartupPhase(const char* name) {
+  DCHECK(!finished_starting_);
+  StartupPhase phase = { name, NanoTime(), 0, 0 };
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    phase.minor_faults = usage.ru_minflt;
+    phase.major_faults = usage.ru_majflt;
+  }
+  startup_phases_.push_back(phase);
+}
+
+void Runtime::DumpStartupPhases(std::ostream& os) const {
+  if (startup_phases_.empty()) {
+    return;
+  }
+  os << "Startup phases:\n";
+  const StartupPhase* previous = &startup_phases_[0];
+  for (size_t i = 1; i != startup_phases_.size(); ++i) {
+    const StartupPhase& phase = startup_phases_[i];
+    os << "  " << phase.name << ": +" << PrettyDuration(phase.end_time_ns - previous->end_time_ns)
+       << " (" << (phase.minor_faults - previous->minor_faults) << " minor and "
+       << (phase.major_faults - previous->major_faults) << " major page faults)\n";
+    previous = &phase;
+  }
+  os << "  Total: " << PrettyDuration(previous->end_time_ns - startup_phases_[0].end_time_ns)
+     << "\n";
+}
+
 void Runtime::DumpForSigQuit(std::ostream& os) {
   GetClassLinker()->DumpForSigQuit(os);
   GetInternTable()->DumpForSigQuit(os);
@@ -2022,11 +2185,15 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
     os << "Running non JIT\n";
   }
   DumpDeoptimizations(os);
+  if (finished_starting_) {
+    DumpStartupPhases(os);
+  }
   TrackedAllocators::Dump(os);
   os << "\n";
 
   thread_list_->DumpForSigQuit(os);
   BaseMutex::DumpAll(os);
+  lock_contention_sampler_->DumpForSigQuit(os);
 
   // Inform anyone else who is interested in SigQuit.
   {
@@ -2197,6 +2364,7 @@ void Runtime::VisitConcurrentRoots(RootVisitor* visitor, VisitRootFlags flags) {
   class_linker_->VisitRoots(visitor, flags);
   jni_id_manager_->VisitRoots(visitor);
   heap_->VisitAllocationRecords(visitor);
+  lock_contention_sampler_->VisitRoots(visitor);
   if ((flags & kVisitRootFlagNewRoots) == 0) {
     // Guaranteed to have no new roots in the constant roots.
     VisitConstantRoots(visitor);
@@ -2996,6 +3164,21 @@ class Runtime::NotifyStartupCompletedTask : public gc::HeapTask {
       ScopedTrace trace2("Delete thread pool");
       runtime->DeleteThreadPool();
     }
+
+    {
+      // The startup only code of the app dex files is not needed anymore. The boot class path
+      // dex files are shared with the zygote and are left alone.
+      ScopedTrace trace2("Madvise dex files after startup");
+      ScopedObjectAccess soa(self);
+      runtime->GetClassLinker()->MadviseAppDexFiles(self,
+                                                    MadviseState::kMadviseStateFinishedLaunch);
+    }
+
+    {
+      // Verify the classes that were not verified at compile time before the app uses them.
+      ScopedTrace trace2("Start verification after startup");
+      runtime->GetOatFileManager().StartVerificationAfterStartup();
+    }
   }
 };
 
@@ -94,6 +94,7 @@ class InternTable;
 class IsMarkedVisitor;
 class JavaVMExt;
 class LinearAlloc;
+class LockContentionSampler;
 class MonitorList;
 class MonitorPool;
 class NullPointerHandler;
@@ -269,6 +270,7 @@ class Runtime {
   void DetachCurrentThread() REQUIRES(!Locks::mutator_lock_);
 
   void DumpDeoptimizations(std::ostream& os);
+  void DumpStartupPhases(std::ostream& os) const;
   void DumpForSigQuit(std::ostream& os);
   void DumpLockHolders(std::ostream& os);
 
@@ -296,6 +298,10 @@ class Runtime {
     return jni_id_manager_.get();
   }
 
+  LockContentionSampler* GetLockContentionSampler() const {
+    return lock_contention_sampler_.get();
+  }
+
   size_t GetDefaultStackSize() const {
     return default_stack_size_;
   }
@@ -396,6 +402,11 @@ class Runtime {
   void SweepSystemWeaks(IsMarkedVisitor* visitor)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Sweep each system weak holder in its own heap thread pool task. Only valid while the caller
+  // holds the mutator lock shared, the workers take it shared as well.
+  void SweepSystemWeaksParallel(Thread* self, IsMarkedVisitor* visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Walk all reflective objects and visit their targets as well as any method/fields held by the
   // runtime threads that are marked as being reflective.
   void VisitReflectiveTargets(ReflectiveValueVisitor* visitor) REQUIRES(Locks::mutator_lock_);
@@ -562,13 +573,13 @@ class Runtime {
   void RecordWriteArray(mirror::Array* array, size_t index, uint64_t value) const
       REQUIRES_SHARED(Locks::mutator_lock_);
   void RecordStrongStringInsertion(ObjPtr<mirror::String> s) const
-      REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::intern_table_lock_);
   void RecordWeakStringInsertion(ObjPtr<mirror::String> s) const
-      REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::intern_table_lock_);
   void RecordStrongStringRemoval(ObjPtr<mirror::String> s) const
-      REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::intern_table_lock_);
   void RecordWeakStringRemoval(ObjPtr<mirror::String> s) const
-      REQUIRES(Locks::intern_table_lock_);
+      REQUIRES_SHARED(Locks::intern_table_lock_);
   void RecordResolveString(ObjPtr<mirror::DexCache> dex_cache, dex::StringIndex string_idx) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -824,6 +835,18 @@ class Runtime {
     return dump_native_stack_on_sig_quit_;
   }
 
+  bool GetForkedHprofDump() const {
+    return forked_hprof_dump_;
+  }
+
+  bool GetCompressHprofDump() const {
+    return compress_hprof_dump_;
+  }
+
+  bool GetDeduplicateHprofArrays() const {
+    return deduplicate_hprof_arrays_;
+  }
+
   bool GetPrunedDalvikCache() const {
     return pruned_dalvik_cache_;
   }
@@ -889,6 +912,12 @@ class Runtime {
     deoptimization_counts_[static_cast<size_t>(kind)]++;
   }
 
+  // Record time spent turning compiled frames into shadow frames for a deoptimization.
+  void AddDeoptimizationTime(DeoptimizationKind kind, uint64_t time_ns) {
+    DCHECK_LE(kind, DeoptimizationKind::kLast);
+    deoptimization_time_ns_[static_cast<size_t>(kind)] += time_ns;
+  }
+
   uint32_t GetNumberOfDeoptimizations() const {
     uint32_t result = 0;
     for (size_t i = 0; i <= static_cast<size_t>(DeoptimizationKind::kLast); ++i) {
@@ -903,6 +932,12 @@ class Runtime {
     return madvise_random_access_;
   }
 
+  // Whether or not the classes of app oat files that were not verified at compile time are
+  // verified in the background once startup is completed.
+  bool VerifyAfterStartup() const {
+    return verify_after_startup_;
+  }
+
   const std::string& GetJdwpOptions() {
     return jdwp_options_;
   }
@@ -992,6 +1027,7 @@ class Runtime {
 
   bool Init(RuntimeArgumentMap&& runtime_options)
       SHARED_TRYLOCK_FUNCTION(true, Locks::mutator_lock_);
+  void RecordStartupPhase(const char* name);
   void InitNativeMethods() REQUIRES(!Locks::mutator_lock_);
   void RegisterRuntimeNativeMethods(JNIEnv* env);
 
@@ -1106,6 +1142,9 @@ class Runtime {
 
   std::unique_ptr<jni::JniIdManager> jni_id_manager_;
 
+  // Samples contentions on monitors and runtime locks, when enabled.
+  std::unique_ptr<LockContentionSampler> lock_contention_sampler_;
+
   std::unique_ptr<JavaVMExt> java_vm_;
 
   std::unique_ptr<jit::Jit> jit_;
@@ -1140,6 +1179,16 @@ class Runtime {
   // is created. This flag is needed for knowing if its safe to request CMS.
   bool finished_starting_;
 
+  // Timeline of Init() and Start(). Each phase records when it ended and the page fault counts
+  // of the process at that point. Only written by the main thread before finished_starting_.
+  struct StartupPhase {
+    const char* name;
+    uint64_t end_time_ns;
+    int64_t minor_faults;
+    int64_t major_faults;
+  };
+  std::vector<StartupPhase> startup_phases_;
+
   // Hooks supported by JNI_CreateJavaVM
   jint (*vfprintf_)(FILE* stream, const char* format, va_list ap);
   void (*exit_)(jint status);
@@ -1249,6 +1298,9 @@ class Runtime {
   // This is beneficial for low RAM devices since it reduces page cache thrashing.
   bool madvise_random_access_;
 
+  // Whether or not we verify the classes left unverified by dex2oat after startup.
+  bool verify_after_startup_;
+
   // Whether the application should run in safe mode, that is, interpreter only.
   bool safe_mode_;
 
@@ -1282,6 +1334,16 @@ class Runtime {
   // Whether threads should dump their native stack on SIGQUIT.
   bool dump_native_stack_on_sig_quit_;
 
+  // Whether hprof heap dumps to a file are written by a forked process, see hprof::DumpHeap.
+  bool forked_hprof_dump_;
+
+  // Whether hprof heap dumps to a file are gzip compressed.
+  bool compress_hprof_dump_;
+
+  // Whether hprof heap dumps to a file only contain the elements of identical primitive arrays
+  // once. This uses an Android specific record that only ahat understands.
+  bool deduplicate_hprof_arrays_;
+
   // Whether the dalvik cache was pruned when initializing the runtime.
   bool pruned_dalvik_cache_;
 
@@ -1326,6 +1388,8 @@ class Runtime {
 
   std::atomic<uint32_t> deoptimization_counts_[
       static_cast<uint32_t>(DeoptimizationKind::kLast) + 1];
+  std::atomic<uint64_t> deoptimization_time_ns_[
+      static_cast<uint32_t>(DeoptimizationKind::kLast) + 1];
 
   MemMap protected_fault_page_;
 
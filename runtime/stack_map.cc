@@ -350,6 +350,9 @@ void InlineInfo::Dump(VariableIndentationOutputStream* vios,
     vios->Stream()
         << std::dec
         << ", method_index=" << code_info.GetMethodIndexOf(*this);
+    if (code_info.GetDexFileIndexOf(*this) != MethodInfo::kSameDexFile) {
+      vios->Stream() << ", dex_file_index=" << code_info.GetDexFileIndexOf(*this);
+    }
   }
   vios->Stream() << ")\n";
   code_info.GetInlineDexRegisterMapOf(stack_map, *this).Dump(vios);
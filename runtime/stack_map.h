@@ -262,10 +262,16 @@ class RegisterMask : public BitTableAccessor<2> {
 
 // Method indices are not very dedup friendly.
 // Separating them greatly improves dedup efficiency of the other tables.
-class MethodInfo : public BitTableAccessor<1> {
+class MethodInfo : public BitTableAccessor<2> {
  public:
   BIT_TABLE_HEADER(MethodInfo)
   BIT_TABLE_COLUMN(0, MethodIndex)
+  // Index of the dex file of the method in the oat file of the outer method, for methods
+  // inlined from another dex file of the same oat file.
+  BIT_TABLE_COLUMN(1, DexFileIndex)
+
+  // The method index is relative to the dex file of the outer method.
+  static constexpr uint32_t kSameDexFile = kNoValue;
 };
 
 /**
@@ -344,6 +350,12 @@ class CodeInfo {
     return method_infos_.GetRow(inline_info.GetMethodInfoIndex()).GetMethodIndex();
   }
 
+  // Returns MethodInfo::kSameDexFile, or the index in the oat file of the dex file of the
+  // method index of `inline_info`.
+  uint32_t GetDexFileIndexOf(InlineInfo inline_info) const {
+    return method_infos_.GetRow(inline_info.GetMethodInfoIndex()).GetDexFileIndex();
+  }
+
   ALWAYS_INLINE DexRegisterMap GetDexRegisterMapOf(StackMap stack_map) const {
     if (stack_map.HasDexRegisterMap()) {
       DexRegisterMap map(number_of_dex_registers_, DexRegisterLocation::Invalid());
@@ -433,6 +445,12 @@ class CodeInfo {
     return (*code_info_data & kIsBaseline) != 0;
   }
 
+  // Whether the code is baseline code compiled with the cheaper optimizations. Such code is
+  // also baseline code.
+  ALWAYS_INLINE static bool IsBaselinePlus(const uint8_t* code_info_data) {
+    return (*code_info_data & kIsBaselinePlus) != 0;
+  }
+
  private:
   // Scan backward to determine dex register locations at given stack map.
   void DecodeDexRegisterMap(uint32_t stack_map_index,
@@ -477,6 +495,7 @@ class CodeInfo {
   enum Flags {
     kHasInlineInfo = 1 << 0,
     kIsBaseline = 1 << 1,
+    kIsBaselinePlus = 1 << 2,
   };
 
   // The CodeInfo starts with sequence of variable-length bit-encoded integers.
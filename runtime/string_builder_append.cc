@@ -22,7 +22,10 @@
 #include "gc/heap.h"
 #include "mirror/string-alloc-inl.h"
 #include "obj_ptr-inl.h"
+#include "reflection.h"
 #include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+#include "well_known_classes.h"
 
 namespace art {
 
@@ -39,6 +42,10 @@ class StringBuilderAppend::Builder {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
  private:
+  // Moves the references to the handle scope and converts the floating point arguments to
+  // strings with Float.toString() and Double.toString(). Returns false if an exception is pending.
+  bool PrepareArgs() REQUIRES_SHARED(Locks::mutator_lock_);
+
   static size_t Uint64Length(uint64_t value);
 
   static size_t Int64Length(int64_t value) {
@@ -90,7 +97,8 @@ class StringBuilderAppend::Builder {
   const uint32_t format_;
   const uint32_t* const args_;
 
-  // References are moved to the handle scope during CalculateLengthWithFlag().
+  // References and the strings of floating point arguments are held in the handle scope from
+  // PrepareArgs() on, in argument order.
   StackHandleScope<kMaxArgs> hs_;
 
   // The length and flag to store when the AppendBuilder is used as a pre-fence visitor.
@@ -204,17 +212,99 @@ inline CharType* StringBuilderAppend::Builder::AppendInt64(ObjPtr<mirror::String
   return data + length;
 }
 
+bool StringBuilderAppend::Builder::PrepareArgs() {
+  // Move all references to handles first, converting the floating point arguments can cause GC.
+  // Reserve a handle for the string of each floating point argument.
+  bool has_fp_args = false;
+  const uint32_t* current_arg = args_;
+  for (uint32_t f = format_; f != 0u; f >>= kBitsPerArg) {
+    DCHECK_LE(f & kArgMask, static_cast<uint32_t>(Argument::kLast));
+    switch (static_cast<Argument>(f & kArgMask)) {
+      case Argument::kString:
+        hs_.NewHandle(reinterpret_cast32<mirror::String*>(*current_arg));
+        break;
+      case Argument::kFloat:
+        hs_.NewHandle<mirror::String>(nullptr);
+        has_fp_args = true;
+        break;
+      case Argument::kDouble:
+        hs_.NewHandle<mirror::String>(nullptr);
+        has_fp_args = true;
+        FALLTHROUGH_INTENDED;
+      case Argument::kLong:
+        current_arg = AlignUp(current_arg, sizeof(int64_t));
+        ++current_arg;  // Skip the low word, let the common code skip the high word.
+        break;
+      default:
+        break;
+    }
+    ++current_arg;
+    DCHECK_LE(hs_.NumberOfReferences(), kMaxArgs);
+  }
+  if (!has_fp_args) {
+    return true;
+  }
+
+  Thread* self = hs_.Self();
+  ScopedObjectAccessUnchecked soa(self);
+  size_t handle_index = 0u;
+  current_arg = args_;
+  for (uint32_t f = format_; f != 0u; f >>= kBitsPerArg) {
+    Argument arg = static_cast<Argument>(f & kArgMask);
+    if (arg == Argument::kLong || arg == Argument::kDouble) {
+      current_arg = AlignUp(current_arg, sizeof(int64_t));
+    }
+    if (arg == Argument::kFloat || arg == Argument::kDouble) {
+      jvalue value;
+      jmethodID to_string;
+      if (arg == Argument::kFloat) {
+        value.f = bit_cast<float>(*current_arg);
+        to_string = WellKnownClasses::java_lang_Float_toString;
+      } else {
+        value.d = bit_cast<double>(*reinterpret_cast<const uint64_t*>(current_arg));
+        to_string = WellKnownClasses::java_lang_Double_toString;
+      }
+      JValue result = InvokeWithJValues(soa, nullptr, to_string, &value);
+      if (self->IsExceptionPending()) {
+        return false;
+      }
+      DCHECK(result.GetL() != nullptr);
+      hs_.SetReference(handle_index, result.GetL());
+    }
+    if (arg == Argument::kString || arg == Argument::kFloat || arg == Argument::kDouble) {
+      ++handle_index;
+    }
+    if (arg == Argument::kLong || arg == Argument::kDouble) {
+      ++current_arg;  // Skip the low word, let the common code skip the high word.
+    }
+    ++current_arg;
+  }
+  DCHECK_EQ(handle_index, hs_.NumberOfReferences());
+  return true;
+}
+
 inline int32_t StringBuilderAppend::Builder::CalculateLengthWithFlag() {
   static_assert(static_cast<size_t>(Argument::kEnd) == 0u, "kEnd must be 0.");
+  if (!PrepareArgs()) {
+    return -1;
+  }
   bool compressible = mirror::kUseStringCompression;
   uint64_t length = 0u;
+  size_t handle_index = 0u;
   const uint32_t* current_arg = args_;
   for (uint32_t f = format_; f != 0u; f >>= kBitsPerArg) {
     DCHECK_LE(f & kArgMask, static_cast<uint32_t>(Argument::kLast));
     switch (static_cast<Argument>(f & kArgMask)) {
-      case Argument::kString: {
-        Handle<mirror::String> str =
-            hs_.NewHandle(reinterpret_cast32<mirror::String*>(*current_arg));
+      case Argument::kString:
+      case Argument::kFloat:
+      case Argument::kDouble: {
+        if (static_cast<Argument>(f & kArgMask) == Argument::kDouble) {
+          current_arg = AlignUp(current_arg, sizeof(int64_t));
+          ++current_arg;  // Skip the low word, let the common code skip the high word.
+        }
+        ObjPtr<mirror::String> str =
+            ObjPtr<mirror::String>::DownCast(hs_.GetReference(handle_index));
+        ++handle_index;
         if (str != nullptr) {
           length += str->GetLength();
           compressible = compressible && str->IsCompressed();
@@ -247,8 +337,6 @@ inline int32_t StringBuilderAppend::Builder::CalculateLengthWithFlag() {
       case Argument::kStringBuilder:
       case Argument::kCharArray:
       case Argument::kObject:
-      case Argument::kFloat:
-      case Argument::kDouble:
         LOG(FATAL) << "Unimplemented arg format: 0x" << std::hex
             << (f & kArgMask) << " full format: 0x" << std::hex << format_;
         UNREACHABLE();
@@ -258,8 +346,8 @@ inline int32_t StringBuilderAppend::Builder::CalculateLengthWithFlag() {
         UNREACHABLE();
     }
     ++current_arg;
-    DCHECK_LE(hs_.NumberOfReferences(), kMaxArgs);
   }
+  DCHECK_EQ(handle_index, hs_.NumberOfReferences());
 
   if (length > std::numeric_limits<int32_t>::max()) {
     // We cannot allocate memory for the entire result.
@@ -280,7 +368,13 @@ inline void StringBuilderAppend::Builder::StoreData(ObjPtr<mirror::String> new_s
   for (uint32_t f = format_; f != 0u; f >>= kBitsPerArg) {
     DCHECK_LE(f & kArgMask, static_cast<uint32_t>(Argument::kLast));
     switch (static_cast<Argument>(f & kArgMask)) {
-      case Argument::kString: {
+      case Argument::kString:
+      case Argument::kFloat:
+      case Argument::kDouble: {
+        if (static_cast<Argument>(f & kArgMask) == Argument::kDouble) {
+          current_arg = AlignUp(current_arg, sizeof(int64_t));
+          ++current_arg;  // Skip the low word, let the common code skip the high word.
+        }
         ObjPtr<mirror::String> str =
             ObjPtr<mirror::String>::DownCast(hs_.GetReference(handle_index));
         ++handle_index;
@@ -318,8 +412,7 @@ inline void StringBuilderAppend::Builder::StoreData(ObjPtr<mirror::String> new_s
 
       case Argument::kStringBuilder:
       case Argument::kCharArray:
-      case Argument::kFloat:
-      case Argument::kDouble:
+      case Argument::kObject:
         LOG(FATAL) << "Unimplemented arg format: 0x" << std::hex
             << (f & kArgMask) << " full format: 0x" << std::hex << format_;
         UNREACHABLE();
@@ -348,6 +348,11 @@ inline void Thread::RevokeThreadLocalAllocationStack() {
   }
   tlsPtr_.thread_local_alloc_stack_end = nullptr;
   tlsPtr_.thread_local_alloc_stack_top = nullptr;
+  if (thread_local_alloc_stack_refills_ <= 1) {
+    // Rarely allocating into the allocation stack since the last revoke, reserve less next time.
+    thread_local_alloc_stack_chunk_size_ /= 2;
+  }
+  thread_local_alloc_stack_refills_ = 0;
 }
 
 inline void Thread::PoisonObjectPointersIfDebug() {
@@ -43,6 +43,7 @@
 #include "arch/context.h"
 #include "art_field-inl.h"
 #include "art_method-inl.h"
+#include "barrier.h"
 #include "base/atomic.h"
 #include "base/bit_utils.h"
 #include "base/casts.h"
@@ -108,6 +109,7 @@
 #include "stack_map.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "verifier/method_verifier.h"
 #include "verify_object.h"
 #include "well_known_classes.h"
@@ -303,6 +305,17 @@ enum {
 void Thread::Park(bool is_absolute, int64_t time) {
   DCHECK(this == Thread::Current());
 #if ART_USE_FUTEXES
+  if ((!is_absolute && time == 0) || time > 0) {
+    // In producer/consumer handoffs the permit often arrives right after we decide to park.
+    // Poll for it briefly first: if it shows up, neither we nor the unparking thread need to
+    // make a futex call, and we skip the thread state transitions.
+    static constexpr size_t kParkSpinIterations = 256;
+    for (size_t i = 0; i != kParkSpinIterations; ++i) {
+      if (tls32_.park_state_.load(std::memory_order_relaxed) != kNoPermit) {
+        break;
+      }
+    }
+  }
   // Consume the permit, or mark as waiting. This cannot cause park_state to go
   // outside of its valid range (0, 1, 2), because in all cases where 2 is
   // assigned it is set back to 1 before returning, and this method cannot run
@@ -2295,7 +2308,8 @@ void Thread::NotifyThreadGroup(ScopedObjectAccessAlreadyRunnable& soa, jobject t
 Thread::Thread(bool daemon)
     : tls32_(daemon),
       wait_monitor_(nullptr),
-      is_runtime_thread_(false) {
+      is_runtime_thread_(false),
+      is_thread_pool_worker_(false) {
   wait_mutex_ = new Mutex("a thread wait mutex", LockLevel::kThreadWaitLock);
   wait_cond_ = new ConditionVariable("a thread wait condition variable", *wait_mutex_);
   tlsPtr_.instrumentation_stack =
@@ -2664,16 +2678,14 @@ void Thread::SetClassLoaderOverride(jobject class_loader_override) {
 
 using ArtMethodDexPcPair = std::pair<ArtMethod*, uint32_t>;
 
-// Counts the stack trace depth and also fetches the first max_saved_frames frames.
+// Counts the stack trace depth and also fetches the frames if `saved_frames` is not null.
 class FetchStackTraceVisitor : public StackVisitor {
  public:
   explicit FetchStackTraceVisitor(Thread* thread,
-                                  ArtMethodDexPcPair* saved_frames = nullptr,
-                                  size_t max_saved_frames = 0)
+                                  std::vector<ArtMethodDexPcPair>* saved_frames = nullptr)
       REQUIRES_SHARED(Locks::mutator_lock_)
       : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
-        saved_frames_(saved_frames),
-        max_saved_frames_(max_saved_frames) {}
+        saved_frames_(saved_frames) {}
 
   bool VisitFrame() override REQUIRES_SHARED(Locks::mutator_lock_) {
     // We want to skip frames up to and including the exception's constructor.
@@ -2686,14 +2698,11 @@ class FetchStackTraceVisitor : public StackVisitor {
     }
     if (!skipping_) {
       if (!m->IsRuntimeMethod()) {  // Ignore runtime frames (in particular callee save).
-        if (depth_ < max_saved_frames_) {
-          saved_frames_[depth_].first = m;
-          saved_frames_[depth_].second = m->IsProxyMethod() ? dex::kDexNoIndex : GetDexPc();
+        if (saved_frames_ != nullptr) {
+          saved_frames_->emplace_back(m, m->IsProxyMethod() ? dex::kDexNoIndex : GetDexPc());
         }
         ++depth_;
       }
-    } else {
-      ++skip_depth_;
     }
     return true;
   }
@@ -2702,27 +2711,19 @@ class FetchStackTraceVisitor : public StackVisitor {
     return depth_;
   }
 
-  uint32_t GetSkipDepth() const {
-    return skip_depth_;
-  }
-
  private:
   uint32_t depth_ = 0;
-  uint32_t skip_depth_ = 0;
   bool skipping_ = true;
-  ArtMethodDexPcPair* saved_frames_;
-  const size_t max_saved_frames_;
+  std::vector<ArtMethodDexPcPair>* const saved_frames_;
 
   DISALLOW_COPY_AND_ASSIGN(FetchStackTraceVisitor);
 };
 
 template<bool kTransactionActive>
-class BuildInternalStackTraceVisitor : public StackVisitor {
+class InternalStackTraceBuilder {
  public:
-  BuildInternalStackTraceVisitor(Thread* self, Thread* thread, int skip_depth)
-      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
-        self_(self),
-        skip_depth_(skip_depth),
+  explicit InternalStackTraceBuilder(Thread* self)
+      : self_(self),
         pointer_size_(Runtime::Current()->GetClassLinker()->GetImagePointerSize()) {}
 
   bool Init(int depth) REQUIRES_SHARED(Locks::mutator_lock_) ACQUIRE(Roles::uninterruptible_) {
@@ -2759,26 +2760,10 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
     return true;
   }
 
-  virtual ~BuildInternalStackTraceVisitor() RELEASE(Roles::uninterruptible_) {
+  ~InternalStackTraceBuilder() RELEASE(Roles::uninterruptible_) {
     self_->EndAssertNoThreadSuspension(nullptr);
   }
 
-  bool VisitFrame() override REQUIRES_SHARED(Locks::mutator_lock_) {
-    if (trace_ == nullptr) {
-      return true;  // We're probably trying to fillInStackTrace for an OutOfMemoryError.
-    }
-    if (skip_depth_ > 0) {
-      skip_depth_--;
-      return true;
-    }
-    ArtMethod* m = GetMethod();
-    if (m->IsRuntimeMethod()) {
-      return true;  // Ignore runtime frames (in particular callee save).
-    }
-    AddFrame(m, m->IsProxyMethod() ? dex::kDexNoIndex : GetDexPc());
-    return true;
-  }
-
   void AddFrame(ArtMethod* method, uint32_t dex_pc) REQUIRES_SHARED(Locks::mutator_lock_) {
     ObjPtr<mirror::PointerArray> trace_methods_and_pcs = GetTraceMethodsAndPCs();
     trace_methods_and_pcs->SetElementPtrSize<kTransactionActive>(count_, method, pointer_size_);
@@ -2802,8 +2787,6 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
 
  private:
   Thread* const self_;
-  // How many more frames to skip.
-  int32_t skip_depth_;
   // Current position down stack trace.
   uint32_t count_ = 0;
   // An object array where the first element is a pointer array that contains the ArtMethod
@@ -2814,41 +2797,32 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
   // For cross compilation.
   const PointerSize pointer_size_;
 
-  DISALLOW_COPY_AND_ASSIGN(BuildInternalStackTraceVisitor);
+  DISALLOW_COPY_AND_ASSIGN(InternalStackTraceBuilder);
 };
 
 template<bool kTransactionActive>
 jobject Thread::CreateInternalStackTrace(const ScopedObjectAccessAlreadyRunnable& soa) const {
-  // Compute depth of stack, save frames if possible to avoid needing to recompute many.
-  constexpr size_t kMaxSavedFrames = 256;
-  std::unique_ptr<ArtMethodDexPcPair[]> saved_frames(new ArtMethodDexPcPair[kMaxSavedFrames]);
-  FetchStackTraceVisitor count_visitor(const_cast<Thread*>(this),
-                                       &saved_frames[0],
-                                       kMaxSavedFrames);
+  // Compute depth of stack and save all frames, so that the stack is walked only once.
+  constexpr size_t kInitialSavedFrames = 256;
+  std::vector<ArtMethodDexPcPair> saved_frames;
+  saved_frames.reserve(kInitialSavedFrames);
+  FetchStackTraceVisitor count_visitor(const_cast<Thread*>(this), &saved_frames);
   count_visitor.WalkStack();
   const uint32_t depth = count_visitor.GetDepth();
-  const uint32_t skip_depth = count_visitor.GetSkipDepth();
+  DCHECK_EQ(depth, saved_frames.size());
 
   // Build internal stack trace.
-  BuildInternalStackTraceVisitor<kTransactionActive> build_trace_visitor(soa.Self(),
-                                                                         const_cast<Thread*>(this),
-                                                                         skip_depth);
-  if (!build_trace_visitor.Init(depth)) {
+  InternalStackTraceBuilder<kTransactionActive> builder(soa.Self());
+  if (!builder.Init(depth)) {
     return nullptr;  // Allocation failed.
   }
-  // If we saved all of the frames we don't even need to do the actual stack walk. This is faster
-  // than doing the stack walk twice.
-  if (depth < kMaxSavedFrames) {
-    for (size_t i = 0; i < depth; ++i) {
-      build_trace_visitor.AddFrame(saved_frames[i].first, saved_frames[i].second);
-    }
-  } else {
-    build_trace_visitor.WalkStack();
+  for (const ArtMethodDexPcPair& frame : saved_frames) {
+    builder.AddFrame(frame.first, frame.second);
   }
 
-  mirror::ObjectArray<mirror::Object>* trace = build_trace_visitor.GetInternalStackTrace();
+  mirror::ObjectArray<mirror::Object>* trace = builder.GetInternalStackTrace();
   if (kIsDebugBuild) {
-    ObjPtr<mirror::PointerArray> trace_methods = build_trace_visitor.GetTraceMethodsAndPCs();
+    ObjPtr<mirror::PointerArray> trace_methods = builder.GetTraceMethodsAndPCs();
     // Second half of trace_methods is dex PCs.
     for (uint32_t i = 0; i < static_cast<uint32_t>(trace_methods->GetLength() / 2); ++i) {
       auto* method = trace_methods->GetElementPtrSize<ArtMethod*>(
@@ -3824,9 +3798,13 @@ class ReferenceMapVisitor : public StackVisitor {
       StackReference<mirror::Object>* vreg_base =
           reinterpret_cast<StackReference<mirror::Object>*>(cur_quick_frame);
       uintptr_t native_pc_offset = method_header->NativeQuickPcOffset(GetCurrentQuickFramePc());
-      CodeInfo code_info = kPrecise
-          ? CodeInfo(method_header)  // We will need dex register maps.
-          : CodeInfo::DecodeGcMasksOnly(method_header);
+      if (method_header != last_method_header_) {
+        last_code_info_ = kPrecise
+            ? CodeInfo(method_header)  // We will need dex register maps.
+            : CodeInfo::DecodeGcMasksOnly(method_header);
+        last_method_header_ = method_header;
+      }
+      const CodeInfo& code_info = last_code_info_;
       StackMap map = code_info.GetStackMapForNativePcOffset(native_pc_offset);
       DCHECK(map.IsValid());
 
@@ -3986,6 +3964,11 @@ class ReferenceMapVisitor : public StackVisitor {
 
   // Visitor for when we visit a root.
   RootVisitor& visitor_;
+
+  // The decoded CodeInfo of the last visited compiled frame. Consecutive frames of the
+  // same method, such as in deep recursion, reuse it instead of decoding it again.
+  const OatQuickMethodHeader* last_method_header_ = nullptr;
+  CodeInfo last_code_info_;
 };
 
 class RootCallbackVisitor {
@@ -4308,7 +4291,32 @@ void Thread::ClearAllInterpreterCaches() {
       thread->GetInterpreterCache()->Clear(thread);
     }
   } closure;
-  Runtime::Current()->GetThreadList()->RunCheckpoint(&closure);
+  Runtime::Current()->GetThreadList()->RunCheckpoint(
+      &closure, /* callback= */ nullptr, ThreadList::MayRunManagedCode);
+}
+
+void Thread::ClearInterpreterCachesFor(const std::vector<const DexFile*>& dex_files) {
+  std::vector<std::pair<const void*, const void*>> ranges;
+  for (const DexFile* dex_file : dex_files) {
+    if (dex_file != nullptr) {
+      // Code items of compact dex files are in the separate data section.
+      ranges.emplace_back(dex_file->Begin(), dex_file->Begin() + dex_file->Size());
+      ranges.emplace_back(dex_file->DataBegin(), dex_file->DataBegin() + dex_file->DataSize());
+    }
+  }
+  Thread* self = Thread::Current();
+  Barrier barrier(0);
+  FunctionClosure closure([&](Thread* thread) {
+    for (const std::pair<const void*, const void*>& range : ranges) {
+      thread->GetInterpreterCache()->ClearRange(thread, range.first, range.second);
+    }
+    barrier.Pass(Thread::Current());
+  });
+  size_t barrier_count = Runtime::Current()->GetThreadList()->RunCheckpoint(
+      &closure, /* callback= */ nullptr, ThreadList::MayRunManagedCode);
+  // The closure refers to `ranges`, wait for all threads to have run it.
+  ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
+  barrier.Increment(self, barrier_count);
 }
 
 
@@ -24,6 +24,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/atomic.h"
 #include "base/enums.h"
@@ -1003,6 +1004,16 @@ class Thread {
     is_runtime_thread_ = is_runtime_thread;
   }
 
+  // Returns true if the thread is a ThreadPool worker. Unlike IsRuntimeThread(), this never
+  // changes back, so it can be read by other threads.
+  bool IsThreadPoolWorker() const {
+    return is_thread_pool_worker_.load(std::memory_order_relaxed);
+  }
+
+  void SetIsThreadPoolWorker() {
+    is_thread_pool_worker_.store(true, std::memory_order_relaxed);
+  }
+
   uint32_t CorePlatformApiCookie() {
     return core_platform_api_cookie_;
   }
@@ -1175,6 +1186,31 @@ class Thread {
   uint8_t* GetTlabEnd() {
     return tlsPtr_.thread_local_end;
   }
+
+  // Size the heap should use for this thread's next TLAB refill, or 0 if the heap default
+  // should be used. Adjusted by the heap from the thread's allocation rate between GCs.
+  size_t GetTlabSizeHint() const {
+    return tlab_size_hint_;
+  }
+  void SetTlabSizeHint(size_t size) {
+    tlab_size_hint_ = size;
+  }
+
+  // Number of TLAB refills and TLAB bytes handed out to this thread since the last GC.
+  size_t GetTlabRefillsSinceGc() const {
+    return tlab_refills_since_gc_;
+  }
+  size_t GetTlabBytesSinceGc() const {
+    return tlab_bytes_since_gc_;
+  }
+  void RecordTlabRefill(size_t bytes) {
+    ++tlab_refills_since_gc_;
+    tlab_bytes_since_gc_ += bytes;
+  }
+  void ResetTlabRefillStats() {
+    tlab_refills_since_gc_ = 0;
+    tlab_bytes_since_gc_ = 0;
+  }
   // Remove the suspend trigger for this thread by making the suspend_trigger_ TLS value
   // equal to a valid pointer.
   // TODO: does this need to atomic?  I don't think so.
@@ -1201,6 +1237,51 @@ class Thread {
   // Resets the thread local allocation pointers.
   void RevokeThreadLocalAllocationStack();
 
+  // Number of slots to reserve for the next thread-local allocation stack segment, or 0 for the
+  // heap default. Halved on revocation when the thread refilled at most once since the last one.
+  size_t GetThreadLocalAllocationStackChunkSize() const {
+    return thread_local_alloc_stack_chunk_size_;
+  }
+  void SetThreadLocalAllocationStackChunkSize(size_t chunk_size) {
+    thread_local_alloc_stack_chunk_size_ = chunk_size;
+  }
+  // Records a segment refill and returns the number of refills since the last revocation.
+  size_t RecordThreadLocalAllocationStackRefill() {
+    return ++thread_local_alloc_stack_refills_;
+  }
+
+  // Native bytes registered (positive) or freed (negative) by this thread and not yet added to
+  // the heap counter, see Heap::RegisterNativeAllocation. Returns the new balance.
+  ssize_t AddNativeBytesBuffered(ssize_t bytes) {
+    native_bytes_buffered_ += bytes;
+    return native_bytes_buffered_;
+  }
+  // Records a buffered native allocation and returns the number buffered since the last flush.
+  uint32_t RecordNativeAllocationBuffered() {
+    return ++native_allocations_buffered_;
+  }
+  // Returns the buffered native bytes and allocations and empties the buffer.
+  void TakeNativeAllocationBuffer(/* out */ ssize_t* bytes, /* out */ uint32_t* allocations) {
+    *bytes = native_bytes_buffered_;
+    *allocations = native_allocations_buffered_;
+    native_bytes_buffered_ = 0;
+    native_allocations_buffered_ = 0;
+  }
+
+  // Counts down the bytes until the next allocation sample and returns true when a sample is due,
+  // see Heap::SetAllocationSamplingInterval.
+  bool CountDownAllocationSample(size_t bytes) {
+    alloc_sample_bytes_remaining_ -= static_cast<ssize_t>(bytes);
+    return alloc_sample_bytes_remaining_ <= 0;
+  }
+  void SetAllocationSampleDistance(size_t bytes) {
+    alloc_sample_bytes_remaining_ = static_cast<ssize_t>(bytes);
+  }
+  // State of the random number generator choosing the distances between allocation samples.
+  uint64_t* GetAllocationSampleRandomState() {
+    return &alloc_sample_random_state_;
+  }
+
   size_t GetThreadLocalBytesAllocated() const {
     return tlsPtr_.thread_local_end - tlsPtr_.thread_local_start;
   }
@@ -1333,13 +1414,23 @@ class Thread {
   // called if the pre-conditions might no longer hold true.
   static void ClearAllInterpreterCaches();
 
+  // Clear the entries of the thread-local interpreter caches which are keyed in
+  // `dex_files`, and wait for all threads to have done so. Must be called before
+  // the dex files get unloaded.
+  static void ClearInterpreterCachesFor(const std::vector<const DexFile*>& dex_files)
+      REQUIRES(!Locks::mutator_lock_);
+
   template<PointerSize pointer_size>
   static constexpr ThreadOffset<pointer_size> InterpreterCacheOffset() {
     return ThreadOffset<pointer_size>(OFFSETOF_MEMBER(Thread, interpreter_cache_));
   }
 
   static constexpr int InterpreterCacheSizeLog2() {
-    return WhichPowerOf2(InterpreterCache::kSize);
+    return WhichPowerOf2(InterpreterCache::kNumSets);
+  }
+
+  static constexpr int InterpreterCacheSetSizeLog2() {
+    return WhichPowerOf2(sizeof(InterpreterCache::Entry) * InterpreterCache::kNumWays);
   }
 
  private:
@@ -1882,10 +1973,31 @@ class Thread {
   // True if the thread is some form of runtime thread (ex, GC or JIT).
   bool is_runtime_thread_;
 
+  // True if the thread is a ThreadPool worker.
+  std::atomic<bool> is_thread_pool_worker_;
+
   // Set during execution of JNI methods that get field and method id's as part of determining if
   // the caller is allowed to access all fields and methods in the Core Platform API.
   uint32_t core_platform_api_cookie_ = 0;
 
+  // Adaptive TLAB sizing state, only touched by the thread itself or while it is suspended.
+  size_t tlab_size_hint_ = 0;
+  size_t tlab_refills_since_gc_ = 0;
+  size_t tlab_bytes_since_gc_ = 0;
+
+  // Adaptive thread-local allocation stack segment size, see
+  // GetThreadLocalAllocationStackChunkSize.
+  size_t thread_local_alloc_stack_chunk_size_ = 0;
+  size_t thread_local_alloc_stack_refills_ = 0;
+
+  // Native allocation accounting not yet flushed to the heap, see AddNativeBytesBuffered.
+  ssize_t native_bytes_buffered_ = 0;
+  uint32_t native_allocations_buffered_ = 0;
+
+  // Bytes to allocate until the next allocation sample, see CountDownAllocationSample.
+  ssize_t alloc_sample_bytes_remaining_ = 0;
+  uint64_t alloc_sample_random_state_ = 0;
+
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
   friend class QuickExceptionHandler;  // For dumping the stack.
@@ -151,18 +151,34 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
       suspend_all_historam_.PrintConfidenceIntervals(os, 0.99, data);  // Dump time to suspend.
     }
   }
+  if (InterpreterCache::kCollectStats) {
+    size_t hits = 0u;
+    size_t misses = 0u;
+    {
+      MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
+      for (Thread* thread : list_) {
+        hits += thread->GetInterpreterCache()->GetHits();
+        misses += thread->GetInterpreterCache()->GetMisses();
+      }
+    }
+    os << "Interpreter cache: " << hits << " hits outside of the fast paths, "
+       << misses << " misses\n";
+  }
   bool dump_native_stack = Runtime::Current()->GetDumpNativeStackOnSigQuit();
   Dump(os, dump_native_stack);
   DumpUnattachedThreads(os, dump_native_stack && kDumpUnattachedThreadNativeStackForSigQuit);
 }
 
-static void DumpUnattachedThread(std::ostream& os, pid_t tid, bool dump_native_stack)
+static void DumpUnattachedThread(std::ostream& os,
+                                 pid_t tid,
+                                 bool dump_native_stack,
+                                 BacktraceMap* backtrace_map)
     NO_THREAD_SAFETY_ANALYSIS {
   // TODO: No thread safety analysis as DumpState with a null thread won't access fields, should
   // refactor DumpState to avoid skipping analysis.
   Thread::DumpState(os, nullptr, tid);
   if (dump_native_stack) {
-    DumpNativeStack(os, tid, nullptr, "  native: ");
+    DumpNativeStack(os, tid, backtrace_map, "  native: ");
   }
   os << std::endl;
 }
@@ -173,6 +189,11 @@ void ThreadList::DumpUnattachedThreads(std::ostream& os, bool dump_native_stack)
     return;
   }
 
+  // Share one map between all the unattached threads rather than reading the
+  // process maps again for each of them.
+  std::unique_ptr<BacktraceMap> backtrace_map(
+      dump_native_stack ? BacktraceMap::Create(getpid()) : nullptr);
+
   Thread* self = Thread::Current();
   dirent* e;
   while ((e = readdir(d)) != nullptr) {
@@ -185,7 +206,7 @@ void ThreadList::DumpUnattachedThreads(std::ostream& os, bool dump_native_stack)
         contains = Contains(tid);
       }
       if (!contains) {
-        DumpUnattachedThread(os, tid, dump_native_stack);
+        DumpUnattachedThread(os, tid, dump_native_stack, backtrace_map.get());
       }
     }
   }
@@ -317,7 +338,13 @@ static void ThreadSuspendSleep(useconds_t delay_us) {
   }
 }
 
-size_t ThreadList::RunCheckpoint(Closure* checkpoint_function, Closure* callback) {
+bool ThreadList::MayRunManagedCode(Thread* thread) {
+  return !thread->IsThreadPoolWorker() || Runtime::Current()->IsAotCompiler();
+}
+
+size_t ThreadList::RunCheckpoint(Closure* checkpoint_function,
+                                 Closure* callback,
+                                 CheckpointFilter filter) {
   Thread* self = Thread::Current();
   Locks::mutator_lock_->AssertNotExclusiveHeld(self);
   Locks::thread_list_lock_->AssertNotHeld(self);
@@ -325,13 +352,20 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function, Closure* callback
 
   std::vector<Thread*> suspended_count_modified_threads;
   size_t count = 0;
+  bool run_on_self = true;
   {
     // Call a checkpoint function for each thread, threads which are suspend get their checkpoint
     // manually called.
     MutexLock mu(self, *Locks::thread_list_lock_);
     MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
-    count = list_.size();
     for (const auto& thread : list_) {
+      if (filter != nullptr && !filter(thread)) {
+        if (thread == self) {
+          run_on_self = false;
+        }
+        continue;
+      }
+      ++count;
       if (thread != self) {
         bool requested_suspend = false;
         while (true) {
@@ -380,7 +414,9 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function, Closure* callback
   }
 
   // Run the checkpoint on ourself while we wait for threads to suspend.
-  checkpoint_function->Run(self);
+  if (run_on_self) {
+    checkpoint_function->Run(self);
+  }
 
   // Run the checkpoint on the suspended threads.
   for (const auto& thread : suspended_count_modified_threads) {
@@ -581,7 +617,8 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
 
   collector->GetHeap()->ThreadFlipEnd(self);
 
-  // Run the closure on the other threads and let them resume.
+  // Run the closure on the other threads and let each of them resume as soon as its roots
+  // have been flipped, rather than keeping all of them suspended until the last one is done.
   {
     TimingLogger::ScopedTiming split3("FlipOtherThreads", collector->GetTimings());
     ReaderMutexLock mu(self, *Locks::mutator_lock_);
@@ -590,6 +627,10 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
       if (flip_func != nullptr) {
         flip_func->Run(thread);
       }
+      MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+      bool updated = thread->ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
+      DCHECK(updated);
+      Thread::resume_cond_->Broadcast(self);
     }
     // Run it for self.
     Closure* flip_func = self->GetFlipFunction();
@@ -598,17 +639,6 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
     }
   }
 
-  // Resume other threads.
-  {
-    TimingLogger::ScopedTiming split4("ResumeOtherThreads", collector->GetTimings());
-    MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
-    for (const auto& thread : other_threads) {
-      bool updated = thread->ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
-      DCHECK(updated);
-    }
-    Thread::resume_cond_->Broadcast(self);
-  }
-
   return runnable_thread_count + other_threads.size() + 1;  // +1 for self.
 }
 
@@ -723,39 +753,47 @@ void ThreadList::SuspendAllInternal(Thread* self,
   }
 
   // Wait for the barrier to be passed by all runnable threads. This wait
-  // is done with a timeout so that we can detect problems.
+  // is done with a timeout so that we can detect problems. The first wait is
+  // cut short at kLongThreadSuspendThreshold, to record the threads that are
+  // slow to suspend while they are still running.
 #if ART_USE_FUTEXES
   timespec wait_timeout;
   InitTimeSpec(false, CLOCK_MONOTONIC, NsToMs(thread_suspend_timeout_ns_), 0, &wait_timeout);
+  timespec straggler_timeout;
+  InitTimeSpec(false, CLOCK_MONOTONIC, NsToMs(kLongThreadSuspendThreshold), 0, &straggler_timeout);
+  bool recorded_stragglers = false;
 #endif
+  std::string stragglers;
   const uint64_t start_time = NanoTime();
   while (true) {
     int32_t cur_val = pending_threads.load(std::memory_order_relaxed);
     if (LIKELY(cur_val > 0)) {
 #if ART_USE_FUTEXES
-      if (futex(pending_threads.Address(), FUTEX_WAIT_PRIVATE, cur_val, &wait_timeout, nullptr, 0)
+      timespec* timeout = recorded_stragglers ? &wait_timeout : &straggler_timeout;
+      if (futex(pending_threads.Address(), FUTEX_WAIT_PRIVATE, cur_val, timeout, nullptr, 0)
           != 0) {
         if ((errno == EAGAIN) || (errno == EINTR)) {
           // EAGAIN and EINTR both indicate a spurious failure, try again from the beginning.
           continue;
         }
+        if (errno == ETIMEDOUT && !recorded_stragglers) {
+          // Unwinding is slow and lengthens the suspension, only do it when asked for.
+          recorded_stragglers = true;
+          stragglers = DescribeUnsuspendedThreads(self,
+                                                  ignore1,
+                                                  ignore2,
+                                                  /* dump_native_stacks= */ VLOG_IS_ON(threads));
+          continue;
+        }
         if (errno == ETIMEDOUT) {
           const uint64_t wait_time = NanoTime() - start_time;
-          MutexLock mu(self, *Locks::thread_list_lock_);
-          MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
-          std::ostringstream oss;
-          for (const auto& thread : list_) {
-            if (thread == ignore1 || thread == ignore2) {
-              continue;
-            }
-            if (!thread->IsSuspended()) {
-              oss << std::endl << "Thread not suspended: " << *thread;
-            }
-          }
           LOG(kIsDebugBuild ? ::android::base::FATAL : ::android::base::ERROR)
               << "Timed out waiting for threads to suspend, waited for "
               << PrettyDuration(wait_time)
-              << oss.str();
+              << DescribeUnsuspendedThreads(self,
+                                            ignore1,
+                                            ignore2,
+                                            /* dump_native_stacks= */ false);
         } else {
           PLOG(FATAL) << "futex wait failed for SuspendAllInternal()";
         }
@@ -769,6 +807,41 @@ void ThreadList::SuspendAllInternal(Thread* self,
       break;
     }
   }
+  if (!stragglers.empty()) {
+    LOG(WARNING) << "Suspending threads took " << PrettyDuration(NanoTime() - start_time)
+                 << ", threads still running after "
+                 << PrettyDuration(kLongThreadSuspendThreshold) << ":" << stragglers;
+  }
+}
+
+std::string ThreadList::DescribeUnsuspendedThreads(Thread* self,
+                                                   Thread* ignore1,
+                                                   Thread* ignore2,
+                                                   bool dump_native_stacks) {
+  std::ostringstream oss;
+  std::vector<pid_t> tids;
+  {
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+    for (const auto& thread : list_) {
+      if (thread == ignore1 || thread == ignore2) {
+        continue;
+      }
+      if (!thread->IsSuspended()) {
+        oss << std::endl << "Thread not suspended: " << *thread;
+        tids.push_back(thread->GetTid());
+      }
+    }
+  }
+  if (dump_native_stacks) {
+    // The threads cannot exit while they have a pending suspend request.
+    std::unique_ptr<BacktraceMap> map(BacktraceMap::Create(getpid()));
+    for (pid_t tid : tids) {
+      oss << std::endl << "Native stack of thread " << tid << ":" << std::endl;
+      DumpNativeStack(oss, tid, map.get(), "  ");
+    }
+  }
+  return oss.str();
 }
 
 void ThreadList::ResumeAll() {
@@ -101,6 +101,10 @@ class ThreadList {
                !Locks::thread_list_lock_,
                !Locks::thread_suspend_count_lock_);
 
+  // Selects the threads a checkpoint runs on. Called with the thread list lock and the thread
+  // suspend count lock held, so it must not block.
+  using CheckpointFilter = bool (*)(Thread* thread);
+
   // Find an existing thread (or self) by its thread id (not tid).
   Thread* FindThreadByThreadId(uint32_t thread_id) REQUIRES(Locks::thread_list_lock_);
 
@@ -112,10 +116,19 @@ class ThreadList {
   // of the suspend check. Returns how many checkpoints that are expected to run, including for
   // already suspended threads for b/24191051. Run the callback, if non-null, inside the
   // thread_list_lock critical section after determining the runnable/suspended states of the
-  // threads.
-  size_t RunCheckpoint(Closure* checkpoint_function, Closure* callback = nullptr)
+  // threads. If `filter` is non-null, the checkpoint only runs on the threads, including self,
+  // for which it returns true, and the others are left running.
+  size_t RunCheckpoint(Closure* checkpoint_function,
+                       Closure* callback = nullptr,
+                       CheckpointFilter filter = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Checkpoint filter for the checkpoints which only look at managed frames or at the
+  // interpreter cache. Outside of the AOT compiler, thread pool workers never call into managed
+  // code, so they have neither.
+  static bool MayRunManagedCode(Thread* thread)
+      REQUIRES(Locks::thread_list_lock_, Locks::thread_suspend_count_lock_);
+
   // Run an empty checkpoint on threads. Wait until threads pass the next suspend point or are
   // suspended. This is used to ensure that the threads finish or aren't in the middle of an
   // in-flight mutator heap access (eg. a read barrier.) Runnable threads will respond by
@@ -205,6 +218,14 @@ class ThreadList {
                           SuspendReason reason = SuspendReason::kInternal)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Describes the threads other than `ignore1` and `ignore2` that are not suspended yet, with
+  // their native stacks if `dump_native_stacks`.
+  std::string DescribeUnsuspendedThreads(Thread* self,
+                                         Thread* ignore1,
+                                         Thread* ignore2,
+                                         bool dump_native_stacks)
+      REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
+
   void AssertThreadsAreSuspended(Thread* self, Thread* ignore1, Thread* ignore2 = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
@@ -111,6 +111,7 @@ void* ThreadPoolWorker::Callback(void* arg) {
   worker->thread_ = Thread::Current();
   // Mark thread pool workers as runtime-threads.
   worker->thread_->SetIsRuntimeThread(true);
+  worker->thread_->SetIsThreadPoolWorker();
   // Do work until its time to shut down.
   worker->Run();
   runtime->DetachCurrentThread();
@@ -119,7 +120,31 @@ void* ThreadPoolWorker::Callback(void* arg) {
 
 void ThreadPool::AddTask(Thread* self, Task* task) {
   MutexLock mu(self, task_queue_lock_);
-  tasks_.push_back(task);
+  PushTaskLocked(task);
+  SignalTaskAddedLocked(self);
+}
+
+void ThreadPool::AddTasks(Thread* self, const std::vector<Task*>& tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  MutexLock mu(self, task_queue_lock_);
+  for (Task* task : tasks) {
+    PushTaskLocked(task);
+  }
+  if (!started_ || waiting_count_ == 0) {
+    return;
+  }
+  if (tasks.size() >= waiting_count_) {
+    task_queue_condition_.Broadcast(self);
+  } else {
+    for (size_t i = 0; i != tasks.size(); ++i) {
+      task_queue_condition_.Signal(self);
+    }
+  }
+}
+
+void ThreadPool::SignalTaskAddedLocked(Thread* self) {
   // If we have any waiters, signal one.
   if (started_ && waiting_count_ != 0) {
     task_queue_condition_.Signal(self);
@@ -134,7 +159,7 @@ void ThreadPool::RemoveAllTasks(Thread* self) {
     task->Finalize();
   }
   MutexLock mu(self, task_queue_lock_);
-  tasks_.clear();
+  ClearTasksLocked();
 }
 
 ThreadPool::ThreadPool(const char* name,
@@ -263,13 +288,17 @@ Task* ThreadPool::TryGetTask(Thread* self) {
 
 Task* ThreadPool::TryGetTaskLocked() {
   if (HasOutstandingTasks()) {
-    Task* task = tasks_.front();
-    tasks_.pop_front();
-    return task;
+    return PopTaskLocked();
   }
   return nullptr;
 }
 
+Task* ThreadPool::PopTaskLocked() {
+  Task* task = tasks_.front();
+  tasks_.pop_front();
+  return task;
+}
+
 void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
   if (do_work) {
     CHECK(!create_peers_);
@@ -292,7 +321,7 @@ void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
 
 size_t ThreadPool::GetTaskCount(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
-  return tasks_.size();
+  return GetTaskCountLocked();
 }
 
 void ThreadPool::SetPthreadPriority(int priority) {
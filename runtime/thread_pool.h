@@ -124,6 +124,10 @@ class ThreadPool {
   // after running it, it is the caller's responsibility.
   void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
 
+  // Add a batch of tasks under a single acquisition of the task queue lock, waking at most one
+  // waiting worker per task. Ownership is the same as for AddTask.
+  void AddTasks(Thread* self, const std::vector<Task*>& tasks) REQUIRES(!task_queue_lock_);
+
   // Remove all tasks in the queue.
   void RemoveAllTasks(Thread* self) REQUIRES(!task_queue_lock_);
 
@@ -180,8 +184,23 @@ class ThreadPool {
   }
 
   bool HasOutstandingTasks() const REQUIRES(task_queue_lock_) {
-    return started_ && !tasks_.empty();
+    return started_ && GetTaskCountLocked() != 0;
+  }
+
+  // Operations on the queue of pending tasks, which is a FIFO unless a subclass orders the tasks.
+  virtual void PushTaskLocked(Task* task) REQUIRES(task_queue_lock_) {
+    tasks_.push_back(task);
   }
+  virtual Task* PopTaskLocked() REQUIRES(task_queue_lock_);
+  virtual size_t GetTaskCountLocked() const REQUIRES(task_queue_lock_) {
+    return tasks_.size();
+  }
+  virtual void ClearTasksLocked() REQUIRES(task_queue_lock_) {
+    tasks_.clear();
+  }
+
+  // Signal a waiting worker, if any, that a task was added.
+  void SignalTaskAddedLocked(Thread* self) REQUIRES(task_queue_lock_);
 
   const std::string name_;
   Mutex task_queue_lock_;
@@ -17,11 +17,14 @@
 #include "thread_pool.h"
 
 #include <string>
+#include <vector>
 
+#include "barrier.h"
 #include "base/atomic.h"
 #include "common_runtime_test.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
+#include "thread_list.h"
 
 namespace art {
 
@@ -74,6 +77,26 @@ TEST_F(ThreadPoolTest, CheckRun) {
   EXPECT_EQ(num_tasks, count.load(std::memory_order_seq_cst));
 }
 
+// Check that a batch added to a started pool wakes enough idle workers to drain it.
+TEST_F(ThreadPoolTest, AddTasks) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool", num_threads);
+  thread_pool.StartWorkers(self);
+  thread_pool.WaitForWorkersToBeCreated();
+  AtomicInteger count(0);
+  static const int32_t num_tasks = num_threads * 4;
+  std::vector<Task*> tasks;
+  for (int32_t i = 0; i < num_tasks; ++i) {
+    tasks.push_back(new CountTask(&count));
+  }
+  thread_pool.AddTasks(self, tasks);
+  // The current thread does not help, so the workers alone must get woken up for every task.
+  thread_pool.Wait(self, false, false);
+  EXPECT_EQ(num_tasks, count.load(std::memory_order_seq_cst));
+  thread_pool.AddTasks(self, {});
+  EXPECT_EQ(0u, thread_pool.GetTaskCount(self));
+}
+
 TEST_F(ThreadPoolTest, StopStart) {
   Thread* self = Thread::Current();
   ThreadPool thread_pool("Thread pool test thread pool", num_threads);
@@ -211,4 +234,46 @@ TEST_F(ThreadPoolTest, PeerTest) {
   }
 }
 
+// Test that checkpoints which only need threads running managed code skip the workers.
+TEST_F(ThreadPoolTest, CheckpointSkipsWorkers) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool", num_threads);
+  thread_pool.StartWorkers(self);
+  thread_pool.WaitForWorkersToBeCreated();
+
+  ThreadList* thread_list = runtime_->GetThreadList();
+  size_t expected_checkpoints = 0u;
+  size_t num_threads_in_list = 0u;
+  {
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+    std::list<Thread*> threads = thread_list->GetList();
+    num_threads_in_list = threads.size();
+    for (Thread* thread : threads) {
+      if (ThreadList::MayRunManagedCode(thread)) {
+        ++expected_checkpoints;
+      } else {
+        EXPECT_TRUE(thread->IsThreadPoolWorker());
+      }
+    }
+  }
+  if (!runtime_->IsAotCompiler()) {
+    EXPECT_EQ(expected_checkpoints + num_threads, num_threads_in_list);
+  }
+
+  Barrier barrier(0);
+  AtomicInteger count(0);
+  FunctionClosure closure([&](Thread* thread) {
+    EXPECT_TRUE(runtime_->IsAotCompiler() || !thread->IsThreadPoolWorker());
+    ++count;
+    barrier.Pass(Thread::Current());
+  });
+  size_t checkpoints =
+      thread_list->RunCheckpoint(&closure, /* callback= */ nullptr, ThreadList::MayRunManagedCode);
+  EXPECT_EQ(expected_checkpoints, checkpoints);
+  barrier.Increment(self, checkpoints);
+  EXPECT_EQ(static_cast<int32_t>(checkpoints), count.load(std::memory_order_seq_cst));
+  thread_pool.Wait(self, false, false);
+}
+
 }  // namespace art
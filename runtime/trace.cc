@@ -23,6 +23,7 @@
 #include "android-base/stringprintf.h"
 
 #include "art_method-inl.h"
+#include "barrier.h"
 #include "base/casts.h"
 #include "base/enums.h"
 #include "base/os.h"
@@ -50,6 +51,7 @@
 #include "stack.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -73,7 +75,6 @@ TraceClockSource Trace::default_clock_source_ = kDefaultTraceClockSource;
 
 Trace* volatile Trace::the_trace_ = nullptr;
 pthread_t Trace::sampling_pthread_ = 0U;
-std::unique_ptr<std::vector<ArtMethod*>> Trace::temp_stack_trace_;
 
 // The key identifying the tracer to update instrumentation.
 static constexpr const char* kTracerInstrumentationKey = "Tracer";
@@ -88,6 +89,38 @@ ArtMethod* Trace::DecodeTraceMethod(uint32_t tmid) {
 }
 
 uint32_t Trace::EncodeTraceMethod(ArtMethod* method) {
+  // Look up the method in the cache, claiming an empty slot for it if it's not found.
+  const uintptr_t key = reinterpret_cast<uintptr_t>(method);
+  size_t index =
+      static_cast<size_t>((static_cast<uint64_t>(key) * UINT64_C(0x9e3779b97f4a7c15)) >> 32);
+  MethodIdSlot* claimed_slot = nullptr;
+  for (size_t probe = 0; probe != kMethodIdCacheMaxProbes; ++probe, ++index) {
+    MethodIdSlot* slot = &method_id_cache_[index & (kMethodIdCacheSize - 1u)];
+    uintptr_t slot_key = slot->method.load(std::memory_order_acquire);
+    if (slot_key == key) {
+      return slot->id;
+    }
+    if (slot_key == 0u &&
+        slot->method.compare_exchange_strong(slot_key, kClaimedMethodIdSlot,
+                                             std::memory_order_relaxed)) {
+      claimed_slot = slot;
+      break;
+    }
+    if (slot_key == key) {
+      // Another thread published the method between the load and the failed CAS.
+      return slot->id;
+    }
+  }
+  uint32_t idx = AssignTraceMethodId(method);
+  if (claimed_slot != nullptr) {
+    // The slot is ours, publish the id with the method.
+    claimed_slot->id = idx;
+    claimed_slot->method.store(key, std::memory_order_release);
+  }
+  return idx;
+}
+
+uint32_t Trace::AssignTraceMethodId(ArtMethod* method) {
   MutexLock mu(Thread::Current(), *unique_methods_lock_);
   uint32_t idx;
   auto it = art_method_id_map_.find(method);
@@ -109,16 +142,6 @@ uint32_t Trace::EncodeTraceMethodAndAction(ArtMethod* method, TraceAction action
   return tmid;
 }
 
-std::vector<ArtMethod*>* Trace::AllocStackTrace() {
-  return (temp_stack_trace_.get() != nullptr)  ? temp_stack_trace_.release() :
-      new std::vector<ArtMethod*>();
-}
-
-void Trace::FreeStackTrace(std::vector<ArtMethod*>* stack_trace) {
-  stack_trace->clear();
-  temp_stack_trace_.reset(stack_trace);
-}
-
 void Trace::SetDefaultClockSource(TraceClockSource clock_source) {
 #if defined(__linux__)
   default_clock_source_ = clock_source;
@@ -204,8 +227,26 @@ static void Append8LE(uint8_t* buf, uint64_t val) {
   *buf++ = static_cast<uint8_t>(val >> 56);
 }
 
-static void GetSample(Thread* thread, void* arg) REQUIRES_SHARED(Locks::mutator_lock_) {
-  std::vector<ArtMethod*>* const stack_trace = Trace::AllocStackTrace();
+// Samples the stack of a thread. Runs as a checkpoint, on the thread itself or, if the thread
+// is suspended, on the sampling thread.
+class SampleClosure : public Closure {
+ public:
+  SampleClosure(Trace* trace, Barrier* barrier) : trace_(trace), barrier_(barrier) {}
+
+  void Run(Thread* thread) override REQUIRES_SHARED(Locks::mutator_lock_) {
+    GetSample(thread, trace_);
+    barrier_->Pass(Thread::Current());
+  }
+
+ private:
+  static void GetSample(Thread* thread, Trace* trace) REQUIRES_SHARED(Locks::mutator_lock_);
+
+  Trace* const trace_;
+  Barrier* const barrier_;
+};
+
+void SampleClosure::GetSample(Thread* thread, Trace* trace) {
+  std::vector<ArtMethod*>* const stack_trace = new std::vector<ArtMethod*>();
   StackVisitor::WalkStack(
       [&](const art::StackVisitor* stack_visitor) REQUIRES_SHARED(Locks::mutator_lock_) {
         ArtMethod* m = stack_visitor->GetMethod();
@@ -218,8 +259,7 @@ static void GetSample(Thread* thread, void* arg) REQUIRES_SHARED(Locks::mutator_
       thread,
       /* context= */ nullptr,
       art::StackVisitor::StackWalkKind::kIncludeInlinedFrames);
-  Trace* the_trace = reinterpret_cast<Trace*>(arg);
-  the_trace->CompareAndUpdateStackTrace(thread, stack_trace);
+  trace->CompareAndUpdateStackTrace(thread, stack_trace);
 }
 
 static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUTE_UNUSED) {
@@ -231,7 +271,7 @@ static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUT
 
 void Trace::CompareAndUpdateStackTrace(Thread* thread,
                                        std::vector<ArtMethod*>* stack_trace) {
-  CHECK_EQ(pthread_self(), sampling_pthread_);
+  // Samples of a thread are taken one at a time, by the thread or by the sampling thread.
   std::vector<ArtMethod*>* old_stack_trace = thread->GetStackTraceSample();
   // Update the thread's stack trace sample.
   thread->SetStackTraceSample(stack_trace);
@@ -266,7 +306,7 @@ void Trace::CompareAndUpdateStackTrace(Thread* thread,
       LogMethodTraceEvent(thread, *rit, instrumentation::Instrumentation::kMethodEntered,
                           thread_clock_diff, wall_clock_diff);
     }
-    FreeStackTrace(old_stack_trace);
+    delete old_stack_trace;
   }
 }
 
@@ -290,15 +330,16 @@ void* Trace::RunSamplingThread(void* arg) {
       }
     }
     {
-      // Avoid a deadlock between a thread doing garbage collection
-      // and the profile sampling thread, by blocking GC when sampling
-      // thread stacks (see b/73624630).
-      gc::ScopedGCCriticalSection gcs(self,
-                                      art::gc::kGcCauseInstrumentation,
-                                      art::gc::kCollectorTypeInstrumentation);
-      ScopedSuspendAll ssa(__FUNCTION__);
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(GetSample, the_trace);
+      // Sample the threads with a checkpoint rather than suspending all threads, so that
+      // running threads only pause to walk their own stack.
+      ScopedObjectAccess soa(self);
+      Barrier barrier(0);
+      SampleClosure closure(the_trace, &barrier);
+      size_t barrier_count = runtime->GetThreadList()->RunCheckpoint(&closure);
+      // The closure refers to `barrier`, wait for all threads to have run it. The trace is not
+      // deleted before the sampling thread is joined.
+      ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
+      barrier.Increment(self, barrier_count);
     }
   }
 
@@ -559,7 +600,8 @@ Trace::Trace(File* trace_file,
       buffer_size_(std::max(kMinBufSize, buffer_size)),
       start_time_(MicroTime()), clock_overhead_ns_(GetClockOverheadNanoSeconds()),
       overflow_(false), interval_us_(0), streaming_lock_(nullptr),
-      unique_methods_lock_(new Mutex("unique methods lock", kTracingUniqueMethodsLock)) {
+      unique_methods_lock_(new Mutex("unique methods lock", kTracingUniqueMethodsLock)),
+      method_id_cache_(new MethodIdSlot[kMethodIdCacheSize]()) {
   CHECK(trace_file != nullptr || output_mode == TraceOutputMode::kDDMS);
 
   uint16_t trace_version = GetTraceVersion(clock_source_);
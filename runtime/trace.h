@@ -226,10 +226,6 @@ class Trace final : public instrumentation::InstrumentationListener {
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!unique_methods_lock_) override;
   void WatchedFramePop(Thread* thread, const ShadowFrame& frame)
       REQUIRES_SHARED(Locks::mutator_lock_) override;
-  // Reuse an old stack trace if it exists, otherwise allocate a new one.
-  static std::vector<ArtMethod*>* AllocStackTrace();
-  // Clear and store an old stack trace for later use.
-  static void FreeStackTrace(std::vector<ArtMethod*>* stack_trace);
   // Save id and name of a thread before it exits.
   static void StoreExitingThreadInfo(Thread* thread);
 
@@ -290,6 +286,7 @@ class Trace final : public instrumentation::InstrumentationListener {
       REQUIRES(streaming_lock_);
 
   uint32_t EncodeTraceMethod(ArtMethod* method) REQUIRES(!unique_methods_lock_);
+  uint32_t AssignTraceMethodId(ArtMethod* method) REQUIRES(!unique_methods_lock_);
   uint32_t EncodeTraceMethodAndAction(ArtMethod* method, TraceAction action)
       REQUIRES(!unique_methods_lock_);
   ArtMethod* DecodeTraceMethod(uint32_t tmid) REQUIRES(!unique_methods_lock_);
@@ -308,9 +305,6 @@ class Trace final : public instrumentation::InstrumentationListener {
   // Sampling thread, non-zero when sampling.
   static pthread_t sampling_pthread_;
 
-  // Used to remember an unused stack trace to avoid re-allocation during sampling.
-  static std::unique_ptr<std::vector<ArtMethod*>> temp_stack_trace_;
-
   // File to write trace data out to, null if direct to ddms.
   std::unique_ptr<File> trace_file_;
 
@@ -383,6 +377,19 @@ class Trace final : public instrumentation::InstrumentationListener {
   std::unordered_map<ArtMethod*, uint32_t> art_method_id_map_ GUARDED_BY(unique_methods_lock_);
   std::vector<ArtMethod*> unique_methods_ GUARDED_BY(unique_methods_lock_);
 
+  // Lock-free cache of art_method_id_map_, so that tracing a method seen before does not take
+  // unique_methods_lock_. A thread missing in the cache claims an empty slot by setting it to
+  // kClaimedMethodIdSlot and publishes the method once it has stored its id, slots never change
+  // afterwards. Methods not found within kMethodIdCacheMaxProbes slots use the map.
+  struct MethodIdSlot {
+    std::atomic<uintptr_t> method;
+    uint32_t id;
+  };
+  static constexpr size_t kMethodIdCacheSize = 1u << 14;
+  static constexpr size_t kMethodIdCacheMaxProbes = 8u;
+  static constexpr uintptr_t kClaimedMethodIdSlot = 1u;
+  std::unique_ptr<MethodIdSlot[]> method_id_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(Trace);
 };
 
@@ -288,7 +288,7 @@ void Transaction::RecordWeakStringRemoval(ObjPtr<mirror::String> s) {
 }
 
 void Transaction::LogInternedString(InternStringLog&& log) {
-  Locks::intern_table_lock_->AssertExclusiveHeld(Thread::Current());
+  Locks::intern_table_lock_->AssertSharedHeld(Thread::Current());
   MutexLock mu(Thread::Current(), log_lock_);
   DCHECK(assert_no_new_records_reason_ == nullptr) << assert_no_new_records_reason_;
   intern_string_logs_.push_front(std::move(log));
@@ -297,7 +297,7 @@ void Transaction::LogInternedString(InternStringLog&& log) {
 void Transaction::Rollback() {
   Thread* self = Thread::Current();
   self->AssertNoPendingException();
-  MutexLock mu1(self, *Locks::intern_table_lock_);
+  WriterMutexLock mu1(self, *Locks::intern_table_lock_);
   MutexLock mu2(self, log_lock_);
   rolling_back_ = true;
   CHECK(!Runtime::Current()->IsActiveTransaction());
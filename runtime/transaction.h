@@ -114,16 +114,16 @@ class Transaction final {
 
   // Record intern string table changes.
   void RecordStrongStringInsertion(ObjPtr<mirror::String> s)
-      REQUIRES(Locks::intern_table_lock_)
+      REQUIRES_SHARED(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordWeakStringInsertion(ObjPtr<mirror::String> s)
-      REQUIRES(Locks::intern_table_lock_)
+      REQUIRES_SHARED(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordStrongStringRemoval(ObjPtr<mirror::String> s)
-      REQUIRES(Locks::intern_table_lock_)
+      REQUIRES_SHARED(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
   void RecordWeakStringRemoval(ObjPtr<mirror::String> s)
-      REQUIRES(Locks::intern_table_lock_)
+      REQUIRES_SHARED(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
 
   // Record resolve string.
@@ -277,7 +277,7 @@ class Transaction final {
   };
 
   void LogInternedString(InternStringLog&& log)
-      REQUIRES(Locks::intern_table_lock_)
+      REQUIRES_SHARED(Locks::intern_table_lock_)
       REQUIRES(!log_lock_);
 
   void UndoObjectModifications()
@@ -2084,9 +2084,9 @@ bool MethodVerifier<kVerifierDebug>::CodeFlowVerifyInstruction(uint32_t* start_g
 
   // We need to ensure the work line is consistent while performing validation. When we spot a
   // peephole pattern we compute a new line for either the fallthrough instruction or the
-  // branch target.
-  RegisterLineArenaUniquePtr branch_line;
-  RegisterLineArenaUniquePtr fallthrough_line;
+  // branch target, in `peephole_line_`.
+  RegisterLine* branch_line = nullptr;
+  RegisterLine* fallthrough_line = nullptr;
 
   switch (inst->Opcode()) {
     case Instruction::NOP:
@@ -2728,13 +2728,16 @@ bool MethodVerifier<kVerifierDebug>::CodeFlowVerifyInstruction(uint32_t* start_g
             (orig_type.IsZeroOrNull() ||
                 orig_type.IsStrictlyAssignableFrom(
                     cast_type.Merge(orig_type, &reg_types_, this), this))) {
-          RegisterLine* update_line = RegisterLine::Create(code_item_accessor_.RegistersSize(),
-                                                           allocator_,
-                                                           GetRegTypeCache());
+          if (peephole_line_ == nullptr) {
+            peephole_line_.reset(RegisterLine::Create(code_item_accessor_.RegistersSize(),
+                                                      allocator_,
+                                                      GetRegTypeCache()));
+          }
+          RegisterLine* update_line = peephole_line_.get();
           if (inst->Opcode() == Instruction::IF_EQZ) {
-            fallthrough_line.reset(update_line);
+            fallthrough_line = update_line;
           } else {
-            branch_line.reset(update_line);
+            branch_line = update_line;
           }
           update_line->CopyFromLine(work_line_.get());
           update_line->SetRegisterType<LockOp::kKeep>(this,
@@ -3532,7 +3535,7 @@ bool MethodVerifier<kVerifierDebug>::CodeFlowVerifyInstruction(uint32_t* start_g
     }
     /* update branch target, set "changed" if appropriate */
     if (nullptr != branch_line) {
-      if (!UpdateRegisters(work_insn_idx_ + branch_target, branch_line.get(), false)) {
+      if (!UpdateRegisters(work_insn_idx_ + branch_target, branch_line, false)) {
         return false;
       }
     } else {
@@ -3664,7 +3667,7 @@ bool MethodVerifier<kVerifierDebug>::CodeFlowVerifyInstruction(uint32_t* start_g
     }
     if (nullptr != fallthrough_line) {
       // Make workline consistent with fallthrough computed from peephole optimization.
-      work_line_->CopyFromLine(fallthrough_line.get());
+      work_line_->CopyFromLine(fallthrough_line);
     }
     if (GetInstructionFlags(next_insn_idx).IsReturn()) {
       // For returns we only care about the operand to the return, all other registers are dead.
@@ -332,6 +332,10 @@ class MethodVerifier {
   // Storage for the register status we're saving for later.
   RegisterLineArenaUniquePtr saved_line_;
 
+  // Storage for the register status computed by peephole optimizations of branches. Allocated on
+  // first use and reused for every such branch of the method.
+  RegisterLineArenaUniquePtr peephole_line_;
+
   const uint32_t dex_method_idx_;  // The method we're working on.
   const DexFile* const dex_file_;  // The dex file containing the method.
   const CodeItemDataAccessor code_item_accessor_;
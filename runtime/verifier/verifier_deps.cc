@@ -938,6 +938,22 @@ bool VerifierDeps::ValidateDependencies(Thread* self,
   return true;
 }
 
+bool VerifierDeps::ValidateDexFileDependencies(Thread* self,
+                                               Handle<mirror::ClassLoader> class_loader,
+                                               const DexFile& dex_file,
+                                               const std::vector<const DexFile*>& classpath,
+                                               /* out */ std::string* error_msg) const {
+  const DexFileDeps* deps = GetDexFileDeps(dex_file);
+  DCHECK(deps != nullptr);
+  return VerifyDexFile(class_loader, dex_file, *deps, classpath, self, error_msg);
+}
+
+void VerifierDeps::ClearDexFileDependencies(const DexFile& dex_file) {
+  auto it = dex_deps_.find(&dex_file);
+  DCHECK(it != dex_deps_.end());
+  it->second.reset(new DexFileDeps(dex_file.NumClassDefs()));
+}
+
 // TODO: share that helper with other parts of the compiler that have
 // the same lookup pattern.
 static ObjPtr<mirror::Class> FindClassAndClearException(ClassLinker* class_linker,
@@ -132,6 +132,18 @@ class VerifierDeps {
                             /* out */ std::string* error_msg) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Verify the encoded dependencies of `dex_file` are still valid. This lets the dex files
+  // whose dependencies still hold skip verification when those of other dex files changed.
+  bool ValidateDexFileDependencies(Thread* self,
+                                   Handle<mirror::ClassLoader> class_loader,
+                                   const DexFile& dex_file,
+                                   const std::vector<const DexFile*>& classpath,
+                                   /* out */ std::string* error_msg) const
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Drop the dependencies recorded for `dex_file`, before verifying it again.
+  void ClearDexFileDependencies(const DexFile& dex_file);
+
   const std::vector<bool>& GetVerifiedClasses(const DexFile& dex_file) const {
     return GetDexFileDeps(dex_file)->verified_classes_;
   }
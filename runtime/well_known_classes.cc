@@ -96,7 +96,9 @@ jmethodID WellKnownClasses::java_lang_ClassNotFoundException_init;
 jmethodID WellKnownClasses::java_lang_Daemons_start;
 jmethodID WellKnownClasses::java_lang_Daemons_stop;
 jmethodID WellKnownClasses::java_lang_Daemons_waitForDaemonStart;
+jmethodID WellKnownClasses::java_lang_Double_toString;
 jmethodID WellKnownClasses::java_lang_Double_valueOf;
+jmethodID WellKnownClasses::java_lang_Float_toString;
 jmethodID WellKnownClasses::java_lang_Float_valueOf;
 jmethodID WellKnownClasses::java_lang_Integer_valueOf;
 jmethodID WellKnownClasses::java_lang_invoke_MethodHandles_lookup;
@@ -242,6 +244,14 @@ static jmethodID CachePrimitiveBoxingMethod(JNIEnv* env, char prim_name, const c
                      android::base::StringPrintf("(%c)L%s;", prim_name, boxed_name).c_str());
 }
 
+static jmethodID CachePrimitiveToStringMethod(JNIEnv* env,
+                                              char prim_name,
+                                              const char* boxed_name) {
+  ScopedLocalRef<jclass> boxed_class(env, env->FindClass(boxed_name));
+  return CacheMethod(env, boxed_class.get(), true, "toString",
+                     android::base::StringPrintf("(%c)Ljava/lang/String;", prim_name).c_str());
+}
+
 #define STRING_INIT_LIST(V) \
   V(java_lang_String_init, "()V", newEmptyString, "newEmptyString", "()Ljava/lang/String;", NewEmptyString) \
   V(java_lang_String_init_B, "([B)V", newStringFromBytes_B, "newStringFromBytes", "([B)Ljava/lang/String;", NewStringFromBytes_B) \
@@ -473,6 +483,9 @@ void WellKnownClasses::InitFieldsAndMethodsOnly(JNIEnv* env) {
   java_lang_Integer_valueOf = CachePrimitiveBoxingMethod(env, 'I', "java/lang/Integer");
   java_lang_Long_valueOf = CachePrimitiveBoxingMethod(env, 'J', "java/lang/Long");
   java_lang_Short_valueOf = CachePrimitiveBoxingMethod(env, 'S', "java/lang/Short");
+
+  java_lang_Double_toString = CachePrimitiveToStringMethod(env, 'D', "java/lang/Double");
+  java_lang_Float_toString = CachePrimitiveToStringMethod(env, 'F', "java/lang/Float");
 }
 
 void WellKnownClasses::LateInit(JNIEnv* env) {
@@ -558,7 +571,9 @@ void WellKnownClasses::Clear() {
   java_lang_ClassNotFoundException_init = nullptr;
   java_lang_Daemons_start = nullptr;
   java_lang_Daemons_stop = nullptr;
+  java_lang_Double_toString = nullptr;
   java_lang_Double_valueOf = nullptr;
+  java_lang_Float_toString = nullptr;
   java_lang_Float_valueOf = nullptr;
   java_lang_Integer_valueOf = nullptr;
   java_lang_invoke_MethodHandles_lookup = nullptr;
@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <initializer_list>
+#include <iterator>
 #include <mutex>
 #include <type_traits>
 #include <utility>
@@ -47,8 +48,9 @@
 // It implements wrapper functions for signal, sigaction, and sigprocmask, and a handler that
 // forwards signals appropriately.
 //
-// In our handler, we start off with all signals blocked, fetch the original signal mask from the
-// passed in ucontext, and then adjust our signal mask appropriately for the user handler.
+// In our handler, we start off with all signals but the crash signals blocked, fetch the original
+// signal mask from the passed in ucontext, and then adjust our signal mask appropriately for the
+// user handler. Special handlers asking for that same mask run without any sigprocmask call.
 //
 // It's somewhat tricky for us to properly handle some flag cases:
 //   SA_NOCLDSTOP and SA_NOCLDWAIT: shouldn't matter, we don't have special handlers for SIGCHLD.
@@ -75,6 +77,10 @@ static int sigaddset(sigset64_t* sigset, int signum) {
 static int sigdelset(sigset64_t* sigset, int signum) {
   return sigdelset64(sigset, signum);
 }
+
+static int sigfillset(sigset64_t* sigset) {
+  return sigfillset64(sigset);
+}
 #endif
 
 template<typename SigsetType>
@@ -90,6 +96,15 @@ static int sigorset(SigsetType* dest, SigsetType* left, SigsetType* right) {
 
 namespace art {
 
+// Signals raised synchronously by a crash, which stay unblocked while dispatching so that a crash
+// in a handler is reported instead of killing the process.
+static constexpr int kCrashSignals[] = { SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV };
+
+static bool IsCrashSignal(int signo) {
+  return std::find(std::begin(kCrashSignals), std::end(kCrashSignals), signo) !=
+      std::end(kCrashSignals);
+}
+
 static decltype(&sigaction) linked_sigaction;
 static decltype(&sigprocmask) linked_sigprocmask;
 
@@ -197,14 +212,21 @@ class SignalChain {
   void Register(int signo) {
 #if defined(__BIONIC__)
     struct sigaction64 handler_action = {};
-    sigfillset64(&handler_action.sa_mask);
 #else
     struct sigaction handler_action = {};
-    sigfillset(&handler_action.sa_mask);
 #endif
+    // This is the mask the runtime's fault handler runs with, see FaultManager::Init().
+    sigfillset(&handler_mask_);
+    for (int crash_signal : kCrashSignals) {
+      sigdelset(&handler_mask_, crash_signal);
+    }
+    handler_action.sa_mask = handler_mask_;
 
     handler_action.sa_sigaction = SignalChain::Handler;
     handler_action.sa_flags = SA_RESTART | SA_SIGINFO | SA_ONSTACK;
+    if (IsCrashSignal(signo)) {
+      handler_action.sa_flags |= SA_NODEFER;
+    }
 
 #if defined(__BIONIC__)
     linked_sigaction64(signo, &handler_action, &action_);
@@ -274,14 +296,43 @@ class SignalChain {
   }
 
 
+  // Returns whether `mask` is the signal mask the kernel installed when entering Handler() for
+  // `signo`, interrupting code that ran with the mask saved in `ucontext`.
+  bool IsEntryMask(int signo, const ucontext_t* ucontext, const sigset_t& mask) const {
+    if (sizeof(mask) * CHAR_BIT < _NSIG - 1) {
+      // A sigset_t this small (LP32 bionic) cannot describe the real-time signals.
+      return false;
+    }
+#if defined(__BIONIC__)
+    const sigset64_t& interrupted_mask = ucontext->uc_sigmask64;
+#else
+    const sigset_t& interrupted_mask = ucontext->uc_sigmask;
+#endif
+    for (int i = 1; i < _NSIG; ++i) {
+      if (i == SIGKILL || i == SIGSTOP) {
+        // The kernel never blocks these.
+        continue;
+      }
+      bool blocked = sigismember(&interrupted_mask, i) == 1 ||
+                     sigismember(&handler_mask_, i) == 1 ||
+                     (i == signo && !IsCrashSignal(signo));
+      if (blocked != (sigismember(&mask, i) == 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   static void Handler(int signo, siginfo_t* siginfo, void*);
 
  private:
   bool claimed_;
 #if defined(__BIONIC__)
   struct sigaction64 action_;
+  sigset64_t handler_mask_;
 #else
   struct sigaction action_;
+  sigset_t handler_mask_;
 #endif
   SigchainAction special_handlers_[2];
 };
@@ -293,6 +344,8 @@ static SignalChain chains[_NSIG + 1];
 static bool is_signal_hook_debuggable = false;
 
 void SignalChain::Handler(int signo, siginfo_t* siginfo, void* ucontext_raw) {
+  ucontext_t* ucontext = static_cast<ucontext_t*>(ucontext_raw);
+
   // Try the special handlers first.
   // If one of them crashes, we'll reenter this handler and pass that crash onto the user handler.
   if (!GetHandlingSignal()) {
@@ -305,8 +358,13 @@ void SignalChain::Handler(int signo, siginfo_t* siginfo, void* ucontext_raw) {
       // Avoid setting the thread local flag in this case, since we'll never
       // get a chance to restore it.
       bool handler_noreturn = (handler.sc_flags & SIGCHAIN_ALLOW_NORETURN);
+      // Faults in generated code are common enough that the syscalls matter, so leave the mask
+      // alone when the kernel already installed the one the handler asks for.
+      bool set_mask = !chains[signo].IsEntryMask(signo, ucontext, handler.sc_mask);
       sigset_t previous_mask;
-      linked_sigprocmask(SIG_SETMASK, &handler.sc_mask, &previous_mask);
+      if (set_mask) {
+        linked_sigprocmask(SIG_SETMASK, &handler.sc_mask, &previous_mask);
+      }
 
       ScopedHandlingSignal restorer;
       if (!handler_noreturn) {
@@ -317,13 +375,14 @@ void SignalChain::Handler(int signo, siginfo_t* siginfo, void* ucontext_raw) {
         return;
       }
 
-      linked_sigprocmask(SIG_SETMASK, &previous_mask, nullptr);
+      if (set_mask) {
+        linked_sigprocmask(SIG_SETMASK, &previous_mask, nullptr);
+      }
     }
   }
 
   // Forward to the user's signal handler.
   int handler_flags = chains[signo].action_.sa_flags;
-  ucontext_t* ucontext = static_cast<ucontext_t*>(ucontext_raw);
 #if defined(__BIONIC__)
   sigset64_t mask;
   sigorset(&mask, &ucontext->uc_sigmask64, &chains[signo].action_.sa_mask);
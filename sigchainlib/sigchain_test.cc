@@ -202,6 +202,43 @@ TEST_F(SigchainTest, sigsetmask) {
 
 #endif
 
+// Make sure that a special handler runs with the mask it asked for, whether or not that is the mask
+// the kernel installs on entry to the signal chain.
+TEST_F(SigchainTest, special_handler_mask) {
+  static sigset64_t handler_mask;
+  static sigset_t crash_mask;
+  sigfillset(&crash_mask);
+  for (int signo : { SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV }) {
+    sigdelset(&crash_mask, signo);
+  }
+
+  for (const sigset_t& expected : { sigset_t{}, crash_mask }) {
+    art::SigchainAction checking_action = {
+        .sc_sigaction = [](int, siginfo_t*, void*) -> bool {
+          RealSigprocmask(SIG_SETMASK, nullptr, &handler_mask);
+          return true;
+        },
+        .sc_mask = expected,
+        .sc_flags = 0,
+    };
+    art::AddSpecialSignalHandlerFn(SIGSEGV, &checking_action);
+
+    sigset64_t mask;
+    sigemptyset64(&mask);
+    ASSERT_EQ(0, RealSigprocmask(SIG_SETMASK, &mask, nullptr)) << strerror(errno);
+    // The fixture's handler declines the unhandled signal, so it reaches ours.
+    RaiseUnhandled();
+    art::RemoveSpecialSignalHandlerFn(SIGSEGV, checking_action.sc_sigaction);
+
+    for (int signo = 1; signo < 32; ++signo) {
+      if (signo == SIGKILL || signo == SIGSTOP) {
+        continue;
+      }
+      EXPECT_EQ(sigismember(&expected, signo), sigismember64(&handler_mask, signo)) << signo;
+    }
+  }
+}
+
 // Make sure that we properly put ourselves back in front if we get circumvented.
 TEST_F(SigchainTest, EnsureFrontOfChain) {
 #if defined(__BIONIC__)
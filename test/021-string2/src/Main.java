@@ -89,6 +89,7 @@ public class Main {
         System.out.println(result);
 
         testCompareToAndEquals();
+        testEqualsLong();
         testIndexOf();
 
         String s0_0 = "\u0000";
@@ -413,6 +414,26 @@ public class Main {
         }
     }
 
+    public static void testEqualsLong() {
+        // Compare strings that differ in a single char, at each position, for lengths
+        // covering several 16-byte chunks and a partial last chunk.
+        String ascii = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        String nonAscii = ascii.replace('0', '\u0440');
+        for (String base : new String[] { ascii, nonAscii }) {
+            for (int length = 0; length <= base.length(); ++length) {
+                String s = base.substring(0, length);
+                Assert.assertTrue(s.equals(new String(s.toCharArray())));
+                for (int i = 0; i < length; ++i) {
+                    char[] chars = s.toCharArray();
+                    chars[i] ^= 1;  // Keeps the compression style.
+                    String t = new String(chars);
+                    Assert.assertFalse(s.equals(t));
+                    Assert.assertFalse(t.equals(s));
+                }
+            }
+        }
+    }
+
     public static void testIndexOf() {
         String[] prefixes = {
                 "",
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Point {
+  Point(int x, int y) {
+    this.x = x;
+    this.y = y;
+  }
+  int x;
+  int y;
+}
+
+public class Main {
+  static Point sPoint;
+
+  static int $noinline$consume(Point p) {
+    return p.x - p.y;
+  }
+
+  /// CHECK-START: int Main.$noinline$escapeOnRarePath(int, int, boolean) partial_escape_analysis (before)
+  /// CHECK:     NewInstance
+  /// CHECK-NOT: NewInstance
+
+  /// CHECK-START: int Main.$noinline$escapeOnRarePath(int, int, boolean) partial_escape_analysis (after)
+  /// CHECK:     NewInstance
+  /// CHECK:     NewInstance
+  /// CHECK-NOT: NewInstance
+
+  /// CHECK-START: int Main.$noinline$escapeOnRarePath(int, int, boolean) load_store_elimination (after)
+  /// CHECK:     NewInstance
+  /// CHECK-NOT: NewInstance
+
+  /// CHECK-START: int Main.$noinline$escapeOnRarePath(int, int, boolean) load_store_elimination (after)
+  /// CHECK-NOT: InstanceFieldGet
+
+  /// CHECK-START: int Main.$noinline$escapeOnRarePath(int, int, boolean) load_store_elimination (after)
+  /// CHECK:     NewInstance
+  /// CHECK:     InvokeStaticOrDirect
+  static int $noinline$escapeOnRarePath(int x, int y, boolean rare) {
+    Point p = new Point(x, y);
+    if (rare) {
+      return $noinline$consume(p);
+    }
+    return p.x * p.y;
+  }
+
+  /// CHECK-START: int Main.$noinline$escapeOnTwoPaths(int, int, int) load_store_elimination (after)
+  /// CHECK:     NewInstance
+  /// CHECK:     NewInstance
+  /// CHECK-NOT: NewInstance
+
+  /// CHECK-START: int Main.$noinline$escapeOnTwoPaths(int, int, int) load_store_elimination (after)
+  /// CHECK-NOT: InstanceFieldGet
+  static int $noinline$escapeOnTwoPaths(int x, int y, int mode) {
+    Point p = new Point(x, y);
+    if (mode == 1) {
+      return $noinline$consume(p);
+    } else if (mode == 2) {
+      sPoint = p;
+      return 0;
+    }
+    return p.x + p.y;
+  }
+
+  /// CHECK-START: int Main.$noinline$escapeOnAllPaths(int, int) partial_escape_analysis (after)
+  /// CHECK:     NewInstance
+  /// CHECK-NOT: NewInstance
+  static int $noinline$escapeOnAllPaths(int x, int y) {
+    Point p = new Point(x, y);
+    return $noinline$consume(p);
+  }
+
+  // The object is still used after the escape, it must keep a single identity.
+
+  /// CHECK-START: int Main.$noinline$usedAfterEscape(int, int, boolean) partial_escape_analysis (after)
+  /// CHECK:     NewInstance
+  /// CHECK-NOT: NewInstance
+  static int $noinline$usedAfterEscape(int x, int y, boolean rare) {
+    Point p = new Point(x, y);
+    if (rare) {
+      sPoint = p;
+    }
+    p.x = 42;
+    return p.x + p.y;
+  }
+
+  // The object escapes in a loop, materializing it once per iteration would be wrong.
+
+  /// CHECK-START: int Main.$noinline$escapeInLoop(int, int, int) partial_escape_analysis (after)
+  /// CHECK:     NewInstance
+  /// CHECK-NOT: NewInstance
+  static int $noinline$escapeInLoop(int x, int y, int n) {
+    Point p = new Point(x, y);
+    int result = 0;
+    for (int i = 0; i < n; ++i) {
+      if (i == 5) {
+        result += $noinline$consume(p);
+      }
+    }
+    return result;
+  }
+
+  // A new object is allocated in each iteration, each can be materialized.
+
+  /// CHECK-START: int Main.$noinline$allocationInLoop(int, int) load_store_elimination (after)
+  /// CHECK:     NewInstance
+  /// CHECK-NOT: NewInstance
+  static int $noinline$allocationInLoop(int x, int n) {
+    int result = 0;
+    for (int i = 0; i < n; ++i) {
+      Point p = new Point(x, i);
+      if (i == 5) {
+        sPoint = p;
+      } else {
+        result += p.x * p.y;
+      }
+    }
+    return result;
+  }
+
+  static void assertIntEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  public static void main(String[] args) {
+    assertIntEquals(12, $noinline$escapeOnRarePath(3, 4, false));
+    assertIntEquals(-1, $noinline$escapeOnRarePath(3, 4, true));
+
+    assertIntEquals(7, $noinline$escapeOnTwoPaths(3, 4, 0));
+    assertIntEquals(-1, $noinline$escapeOnTwoPaths(3, 4, 1));
+    sPoint = null;
+    assertIntEquals(0, $noinline$escapeOnTwoPaths(3, 4, 2));
+    assertIntEquals(3, sPoint.x);
+    assertIntEquals(4, sPoint.y);
+
+    assertIntEquals(-1, $noinline$escapeOnAllPaths(3, 4));
+
+    sPoint = null;
+    assertIntEquals(46, $noinline$usedAfterEscape(3, 4, true));
+    assertIntEquals(42, sPoint.x);
+    assertIntEquals(46, $noinline$usedAfterEscape(3, 4, false));
+
+    assertIntEquals(-1, $noinline$escapeInLoop(3, 4, 10));
+
+    sPoint = null;
+    assertIntEquals(3 * (0 + 1 + 2 + 3 + 4 + 6 + 7), $noinline$allocationInLoop(3, 8));
+    assertIntEquals(3, sPoint.x);
+    assertIntEquals(5, sPoint.y);
+
+    System.out.println("passed");
+  }
+}
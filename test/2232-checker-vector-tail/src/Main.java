@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for the overlapping vector tail, which executes the remainder iterations of
+ * a vectorized loop as one more vector iteration ending at the trip count.
+ */
+public class Main {
+
+  /// CHECK-START-ARM64: void Main.$noinline$scale(int[], int[], int) loop_optimization (after)
+  /// CHECK-DAG: VecStore loop:<<Loop1:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecStore loop:<<Loop2:B\d+>> outer_loop:none
+  /// CHECK-EVAL: "<<Loop1>>" != "<<Loop2>>"
+  private static void $noinline$scale(int[] a, int[] b, int n) {
+    for (int i = 0; i < n; i++) {
+      a[i] = b[i] * 3;
+    }
+  }
+
+  /// CHECK-START-ARM64: void Main.$noinline$fill(int[], int) loop_optimization (after)
+  /// CHECK-DAG: VecStore loop:<<Loop1:B\d+>> outer_loop:none
+  /// CHECK-DAG: VecStore loop:<<Loop2:B\d+>> outer_loop:none
+  /// CHECK-EVAL: "<<Loop1>>" != "<<Loop2>>"
+  private static void $noinline$fill(int[] a, int n) {
+    for (int i = 0; i < n; i++) {
+      a[i] = 7;
+    }
+  }
+
+  // Not idempotent: the tail would increment some elements twice.
+  //
+  /// CHECK-START-ARM64: void Main.$noinline$increment(int[], int) loop_optimization (after)
+  /// CHECK:     VecStore
+  /// CHECK-NOT: VecStore
+  private static void $noinline$increment(int[] a, int n) {
+    for (int i = 0; i < n; i++) {
+      a[i] += 1;
+    }
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  public static void main(String[] args) {
+    for (int n = 0; n <= 40; n++) {
+      int[] a = new int[n];
+      int[] b = new int[n];
+      int[] c = new int[n];
+      for (int i = 0; i < n; i++) {
+        a[i] = i;
+        b[i] = i;
+      }
+      $noinline$scale(a, b, n);
+      for (int i = 0; i < n; i++) {
+        expectEquals(3 * i, a[i]);
+      }
+      // Same array: the tail must not run again over the scaled values.
+      $noinline$scale(b, b, n);
+      for (int i = 0; i < n; i++) {
+        expectEquals(3 * i, b[i]);
+      }
+      $noinline$fill(c, n);
+      for (int i = 0; i < n; i++) {
+        expectEquals(7, c[i]);
+      }
+      $noinline$increment(a, n);
+      for (int i = 0; i < n; i++) {
+        expectEquals(3 * i + 1, a[i]);
+      }
+    }
+    System.out.println("passed");
+  }
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for the System.arraycopy overloads taking byte[] and int[] arguments, which are
+ * intrinsified for short copies between distinct arrays.
+ */
+public class Main {
+
+  /// CHECK-START: void Main.$noinline$copyBytes(byte[], int, byte[], int, int) builder (after)
+  /// CHECK: InvokeStaticOrDirect method_name:java.lang.System.arraycopy intrinsic:SystemArrayCopyByte
+  private static void $noinline$copyBytes(byte[] src, int srcPos, byte[] dst, int dstPos, int n) {
+    System.arraycopy(src, srcPos, dst, dstPos, n);
+  }
+
+  /// CHECK-START: void Main.$noinline$copyInts(int[], int, int[], int, int) builder (after)
+  /// CHECK: InvokeStaticOrDirect method_name:java.lang.System.arraycopy intrinsic:SystemArrayCopyInt
+  private static void $noinline$copyInts(int[] src, int srcPos, int[] dst, int dstPos, int n) {
+    System.arraycopy(src, srcPos, dst, dstPos, n);
+  }
+
+  private static void $noinline$copyFiveBytes(byte[] src, byte[] dst) {
+    System.arraycopy(src, 1, dst, 2, 5);
+  }
+
+  private static void $noinline$copyFiveInts(int[] src, int[] dst) {
+    System.arraycopy(src, 1, dst, 2, 5);
+  }
+
+  private static byte[] makeBytes(int n) {
+    byte[] a = new byte[n];
+    for (int i = 0; i < n; i++) {
+      a[i] = (byte) (i + 1);
+    }
+    return a;
+  }
+
+  private static int[] makeInts(int n) {
+    int[] a = new int[n];
+    for (int i = 0; i < n; i++) {
+      a[i] = 0x01010101 * (i + 1);
+    }
+    return a;
+  }
+
+  private static void testBytes() {
+    // Cover the empty copy, the intrinsic copy loop up to the threshold of 32 elements,
+    // and the library call above it.
+    for (int n = 0; n <= 40; n++) {
+      byte[] src = makeBytes(n + 3);
+      byte[] dst = new byte[n + 5];
+      $noinline$copyBytes(src, 3, dst, 1, n);
+      for (int i = 0; i < dst.length; i++) {
+        byte expected = (i >= 1 && i < n + 1) ? src[i + 2] : 0;
+        expectEquals(expected, dst[i]);
+      }
+    }
+    byte[] src = makeBytes(8);
+    byte[] dst = new byte[8];
+    $noinline$copyFiveBytes(src, dst);
+    for (int i = 0; i < dst.length; i++) {
+      expectEquals((i >= 2 && i < 7) ? src[i - 1] : 0, dst[i]);
+    }
+    // Overlapping copy within the same array.
+    byte[] a = makeBytes(10);
+    $noinline$copyBytes(a, 0, a, 1, 9);
+    for (int i = 1; i < a.length; i++) {
+      expectEquals(i, a[i]);
+    }
+  }
+
+  private static void testInts() {
+    for (int n = 0; n <= 40; n++) {
+      int[] src = makeInts(n + 3);
+      int[] dst = new int[n + 5];
+      $noinline$copyInts(src, 3, dst, 1, n);
+      for (int i = 0; i < dst.length; i++) {
+        int expected = (i >= 1 && i < n + 1) ? src[i + 2] : 0;
+        expectEquals(expected, dst[i]);
+      }
+    }
+    int[] src = makeInts(8);
+    int[] dst = new int[8];
+    $noinline$copyFiveInts(src, dst);
+    for (int i = 0; i < dst.length; i++) {
+      expectEquals((i >= 2 && i < 7) ? src[i - 1] : 0, dst[i]);
+    }
+    int[] a = makeInts(10);
+    $noinline$copyInts(a, 0, a, 1, 9);
+    for (int i = 1; i < a.length; i++) {
+      expectEquals(0x01010101 * i, a[i]);
+    }
+  }
+
+  private static void testExceptions() {
+    try {
+      $noinline$copyBytes(null, 0, new byte[1], 0, 1);
+      throw new Error("Should not be here");
+    } catch (NullPointerException expected) {
+    }
+    try {
+      $noinline$copyInts(new int[1], 0, null, 0, 1);
+      throw new Error("Should not be here");
+    } catch (NullPointerException expected) {
+    }
+    try {
+      $noinline$copyBytes(new byte[4], 2, new byte[4], 0, 3);
+      throw new Error("Should not be here");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      $noinline$copyInts(new int[4], 0, new int[4], -1, 1);
+      throw new Error("Should not be here");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      $noinline$copyInts(new int[4], 0, new int[4], 0, -1);
+      throw new Error("Should not be here");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+  }
+
+  public static void main(String[] args) {
+    testBytes();
+    testInts();
+    testExceptions();
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  static class Counter {
+    int value;
+  }
+
+  static Counter sCounter;
+
+  /// CHECK-START: int Main.$noinline$localLock(int) constructor_fence_redundancy_elimination (before)
+  /// CHECK:     MonitorOperation kind:enter
+  /// CHECK:     MonitorOperation kind:exit
+
+  /// CHECK-START: int Main.$noinline$localLock(int) constructor_fence_redundancy_elimination (after)
+  /// CHECK-NOT: MonitorOperation
+  private static int $noinline$localLock(int n) {
+    Counter c = new Counter();
+    for (int i = 0; i < n; i++) {
+      synchronized (c) {
+        c.value += i;
+      }
+    }
+    return c.value;
+  }
+
+  /// CHECK-START: int Main.$noinline$escapingLock(int) constructor_fence_redundancy_elimination (after)
+  /// CHECK:     MonitorOperation kind:enter
+  /// CHECK:     MonitorOperation kind:exit
+  private static int $noinline$escapingLock(int n) {
+    Counter c = new Counter();
+    sCounter = c;
+    synchronized (c) {
+      c.value = n;
+    }
+    return c.value;
+  }
+
+  public static void main(String[] args) {
+    expectEquals(45, $noinline$localLock(10));
+    expectEquals(7, $noinline$escapingLock(7));
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  static class CheckFailed extends RuntimeException {}
+
+  private static int $inline$checkNonNegative(int value) {
+    if (value < 0) {
+      throw new CheckFailed();
+    }
+    return value;
+  }
+
+  /// CHECK-START: int Main.$noinline$parseOrDefault(int, int) inliner (before)
+  /// CHECK:     InvokeStaticOrDirect method_name:Main.$inline$checkNonNegative
+
+  /// CHECK-START: int Main.$noinline$parseOrDefault(int, int) inliner (after)
+  /// CHECK-NOT: InvokeStaticOrDirect method_name:Main.$inline$checkNonNegative
+
+  /// CHECK-START: int Main.$noinline$parseOrDefault(int, int) inliner (after)
+  /// CHECK:     Throw
+  /// CHECK:     TryBoundary kind:exit
+  private static int $noinline$parseOrDefault(int value, int defaultValue) {
+    try {
+      return $inline$checkNonNegative(value);
+    } catch (CheckFailed e) {
+      return defaultValue;
+    }
+  }
+
+  public static void main(String[] args) {
+    expectEquals(42, $noinline$parseOrDefault(42, -1));
+    expectEquals(-1, $noinline$parseOrDefault(-42, -1));
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
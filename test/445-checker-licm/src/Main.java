@@ -230,6 +230,46 @@ public class Main {
     return i;
   }
 
+  //
+  // The load of the loop bound is hoisted even though the loop stores
+  // another int field.
+  //
+  /// CHECK-START: int Main.sumList(Main$IntList) licm (before)
+  /// CHECK-DAG: InstanceFieldGet field_name:Main$IntList.size loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: InstanceFieldSet field_name:Main$IntList.sum  loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START: int Main.sumList(Main$IntList) licm (after)
+  /// CHECK-DAG: InstanceFieldGet field_name:Main$IntList.size loop:none
+  /// CHECK-DAG: InstanceFieldSet field_name:Main$IntList.sum  loop:<<Loop:B\d+>> outer_loop:none
+  public static int sumList(IntList list) {
+    for (int i = 0; i < list.size; i++) {
+      list.sum += list.data[i];
+    }
+    return list.sum;
+  }
+
+  /// CHECK-START: void Main.countUpToStaticLimit() licm (before)
+  /// CHECK-DAG: StaticFieldGet field_name:Main.staticLimit loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: StaticFieldSet field_name:Main.staticCount loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START: void Main.countUpToStaticLimit() licm (after)
+  /// CHECK-DAG: StaticFieldGet field_name:Main.staticLimit loop:none
+  /// CHECK-DAG: StaticFieldSet field_name:Main.staticCount loop:<<Loop:B\d+>> outer_loop:none
+  public static void countUpToStaticLimit() {
+    for (int i = 0; i < staticLimit; i++) {
+      staticCount += i;
+    }
+  }
+
+  static class IntList {
+    int[] data;
+    int size;
+    int sum;
+  }
+
+  public static int staticLimit;
+  public static int staticCount;
+
   public static int staticField = 42;
 
   public static int[] staticArray = null;
@@ -251,6 +291,14 @@ public class Main {
     assertEquals(45, invariantBoundIntrinsic(-10));
     assertEquals(30, invariantBodyIntrinsic(2, 3));
 
+    IntList list = new IntList();
+    list.data = new int[] { 1, 2, 3, 4 };
+    list.size = 3;
+    assertEquals(6, sumList(list));
+    staticLimit = 10;
+    countUpToStaticLimit();
+    assertEquals(45, staticCount);
+
     staticArray = null;
     try {
       doWhile(0);
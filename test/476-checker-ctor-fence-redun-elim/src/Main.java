@@ -377,6 +377,38 @@ class TestNonEscaping {
   }
 }
 
+class TestThreadLocal implements Test {
+  // Not a constant, so that LSE keeps the allocation and its fence.
+  static int length = 4;
+  static int sum;
+
+  /// CHECK-START: void TestThreadLocal.exercise() constructor_fence_redundancy_elimination (before)
+  /// CHECK: <<NewArray:l\d+>>        NewArray
+  /// CHECK:                          ConstructorFence [<<NewArray>>]
+
+  /// CHECK-START: void TestThreadLocal.exercise() constructor_fence_redundancy_elimination (after)
+  /// CHECK:                          NewArray
+  /// CHECK-NOT:                      ConstructorFence
+  @Override
+  public void exercise() {
+    // The array is never stored, passed or returned, so no other thread can see it.
+    int[] a = new int[length];
+    for (int i = 0; i < a.length; ++i) {
+      a[i] = i;
+    }
+    int s = 0;
+    for (int i = 0; i < a.length; ++i) {
+      s += a[i];
+    }
+    sum = s;
+  }
+
+  @Override
+  public void check() {
+    Assert.stringEquals("6", sum);
+  }
+}
+
 class TestDontOptimizeAcrossBlocks implements Test {
   // Prevent constant folding.
   static boolean test;
@@ -791,6 +823,7 @@ public class Main {
       TestThreeFinalTwice.class,
       TestNonEscaping.Invoke.class,
       TestNonEscaping.Store.class,
+      TestThreadLocal.class,
       TestDontOptimizeAcrossBlocks.class,
       TestDontOptimizeAcrossEscape.Invoke.class,
       TestDontOptimizeAcrossEscape.StoreIput.class,
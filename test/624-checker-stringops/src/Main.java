@@ -289,6 +289,37 @@ public class Main {
     x.toString();
   }
 
+  // The hash code is computed on the first call, and then read from the string.
+  //
+  /// CHECK-START: int Main.$noinline$hashCodeTwice(java.lang.String) builder (after)
+  /// CHECK: InvokeVirtual intrinsic:StringHashCode
+  /// CHECK: InvokeVirtual intrinsic:StringHashCode
+  static int $noinline$hashCodeTwice(String s) {
+    int first = s.hashCode();
+    int second = s.hashCode();
+    if (first != second) {
+      throw new Error("Different hash codes: " + first + ", " + second);
+    }
+    return first;
+  }
+
+  static int computeHashCode(String s) {
+    int hash = 0;
+    for (int i = 0; i < s.length(); i++) {
+      hash = 31 * hash + s.charAt(i);
+    }
+    return hash;
+  }
+
+  static void hashCodes() {
+    String[] strings = { "", "a", "abc", ABC, ABC + XYZ + ABC, "\u0440\u0441" + ABC };
+    for (String s : strings) {
+      String copy = new String(s.toCharArray());  // hash code not computed yet
+      expectEquals(computeHashCode(s), $noinline$hashCodeTwice(copy));
+      expectEquals(computeHashCode(s), $noinline$hashCodeTwice(s));
+    }
+  }
+
   public static void main(String[] args) throws Exception {
     expectEquals(1865, liveIndexOf());
     expectEquals(29, deadIndexOf());
@@ -317,6 +348,7 @@ public class Main {
     expectEquals(0, builderDeadLoop());
 
     doesNothing();
+    hashCodes();
 
     System.out.println("passed");
   }
@@ -19,6 +19,9 @@ public class Main {
         testAppendStringAndLong();
         testAppendStringAndInt();
         testAppendStringAndString();
+        testAppendStringAndFloat();
+        testAppendStringAndDouble();
+        testAppendStringAndStringObject();
         testMiscelaneous();
         testNoArgs();
         testInline();
@@ -201,6 +204,65 @@ public class Main {
         assertEquals("\u0131test\u0131", $noinline$appendStringAndString("\u0131", "test\u0131"));
     }
 
+    /// CHECK-START: java.lang.String Main.$noinline$appendStringAndFloat(java.lang.String, float) instruction_simplifier (before)
+    /// CHECK-NOT:              StringBuilderAppend
+
+    /// CHECK-START: java.lang.String Main.$noinline$appendStringAndFloat(java.lang.String, float) instruction_simplifier (after)
+    /// CHECK:                  StringBuilderAppend
+    public static String $noinline$appendStringAndFloat(String s, float f) {
+        return new StringBuilder().append(s).append(f).toString();
+    }
+
+    public static void testAppendStringAndFloat() {
+        assertEquals("F/1.0", $noinline$appendStringAndFloat("F/", 1.0f));
+        assertEquals("F/-0.0", $noinline$appendStringAndFloat("F/", -0.0f));
+        assertEquals("F/0.1", $noinline$appendStringAndFloat("F/", 0.1f));
+        assertEquals("F/1.0E10", $noinline$appendStringAndFloat("F/", 1.0e10f));
+        assertEquals("F/3.4028235E38", $noinline$appendStringAndFloat("F/", Float.MAX_VALUE));
+        assertEquals("F/1.4E-45", $noinline$appendStringAndFloat("F/", Float.MIN_VALUE));
+        assertEquals("F/NaN", $noinline$appendStringAndFloat("F/", Float.NaN));
+        assertEquals("F/-Infinity",
+                     $noinline$appendStringAndFloat("F/", Float.NEGATIVE_INFINITY));
+        assertEquals("\u0131/1.5", $noinline$appendStringAndFloat("\u0131/", 1.5f));
+    }
+
+    /// CHECK-START: java.lang.String Main.$noinline$appendStringAndDouble(java.lang.String, double) instruction_simplifier (before)
+    /// CHECK-NOT:              StringBuilderAppend
+
+    /// CHECK-START: java.lang.String Main.$noinline$appendStringAndDouble(java.lang.String, double) instruction_simplifier (after)
+    /// CHECK:                  StringBuilderAppend
+    public static String $noinline$appendStringAndDouble(String s, double d) {
+        return new StringBuilder().append(s).append(d).toString();
+    }
+
+    public static void testAppendStringAndDouble() {
+        assertEquals("D/1.0", $noinline$appendStringAndDouble("D/", 1.0));
+        assertEquals("D/-0.0", $noinline$appendStringAndDouble("D/", -0.0));
+        assertEquals("D/0.1", $noinline$appendStringAndDouble("D/", 0.1));
+        assertEquals("D/1.0E-5", $noinline$appendStringAndDouble("D/", 1.0e-5));
+        assertEquals("D/1.7976931348623157E308",
+                     $noinline$appendStringAndDouble("D/", Double.MAX_VALUE));
+        assertEquals("D/4.9E-324", $noinline$appendStringAndDouble("D/", Double.MIN_VALUE));
+        assertEquals("D/NaN", $noinline$appendStringAndDouble("D/", Double.NaN));
+        assertEquals("D/Infinity",
+                     $noinline$appendStringAndDouble("D/", Double.POSITIVE_INFINITY));
+    }
+
+    /// CHECK-START: java.lang.String Main.$noinline$appendStringObjectAndDouble(java.lang.String, double) instruction_simplifier (before)
+    /// CHECK-NOT:              StringBuilderAppend
+
+    /// CHECK-START: java.lang.String Main.$noinline$appendStringObjectAndDouble(java.lang.String, double) instruction_simplifier (after)
+    /// CHECK:                  StringBuilderAppend
+    public static String $noinline$appendStringObjectAndDouble(String s, double d) {
+        Object o = s;
+        return new StringBuilder().append(o).append(d).append(s).toString();
+    }
+
+    public static void testAppendStringAndStringObject() {
+        assertEquals("x2.5x", $noinline$appendStringObjectAndDouble("x", 2.5));
+        assertEquals("null2.5null", $noinline$appendStringObjectAndDouble(null, 2.5));
+    }
+
     /// CHECK-START: java.lang.String Main.$noinline$appendSLILC(java.lang.String, long, int, long, char) instruction_simplifier (before)
     /// CHECK-NOT:              StringBuilderAppend
 
@@ -46,6 +46,16 @@ public class AhatArrayInstance extends AhatInstance {
     mRefSize = refSize;
   }
 
+  /**
+   * Initialize the array elements to be the same as those of a primitive
+   * array with identical contents.
+   */
+  void initialize(AhatArrayInstance original) {
+    mValues = original.mValues;
+    mByteArray = original.mByteArray;
+    mCharArray = original.mCharArray;
+  }
+
   /**
    * Initialize the array elements for a primitive boolean array.
    */
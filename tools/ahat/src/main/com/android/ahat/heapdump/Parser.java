@@ -19,8 +19,11 @@ package com.android.ahat.heapdump;
 import com.android.ahat.progress.NullProgress;
 import com.android.ahat.progress.Progress;
 import com.android.ahat.proguard.ProguardMap;
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
 import java.io.File;
 import java.io.IOException;
+import java.io.InputStream;
 import java.nio.BufferUnderflowException;
 import java.nio.ByteBuffer;
 import java.nio.channels.FileChannel;
@@ -33,6 +36,7 @@ import java.util.Iterator;
 import java.util.List;
 import java.util.Map;
 import java.util.Objects;
+import java.util.zip.GZIPInputStream;
 
 /**
  * Provides methods for parsing heap dumps.
@@ -161,6 +165,8 @@ public class Parser {
   }
 
   private AhatSnapshot parseInternal() throws IOException, HprofFormatException {
+    hprof.decompress();
+
     // Read, and mostly ignore, the hprof header info.
     int idSize;
     {
@@ -515,6 +521,27 @@ public class Parser {
                   break;
                 }
 
+                case 0xc4: { // PRIMITIVE ARRAY DUPLICATE (ANDROID)
+                  long objectId = hprof.getId();
+                  int stackSerialNumber = hprof.getU4();
+                  int length = hprof.getU4();
+                  Type type = hprof.getPrimitiveType();
+                  long originalId = hprof.getId();
+                  Site site = sites.get(stackSerialNumber);
+
+                  AhatClassObj classObj = primArrayClasses[type.ordinal()];
+                  if (classObj == null) {
+                    throw new HprofFormatException(
+                        "No class definition found for " + type.name + "[]");
+                  }
+
+                  AhatArrayInstance obj = new AhatArrayInstance(objectId, idSize);
+                  obj.initialize(heaps.getCurrentHeap(), site, classObj);
+                  obj.setTemporaryUserData(new DuplicateArrayData(length, originalId));
+                  instances.add(obj);
+                  break;
+                }
+
                 case 0x89: { // ROOT INTERNED STRING (ANDROID)
                   long objectId = hprof.getId();
                   roots.add(new RootData(objectId, RootType.INTERNED_STRING));
@@ -654,6 +681,18 @@ public class Parser {
             }
           }
           ((AhatClassObj)inst).initialize(loader, data.staticFields);
+        } else if (inst.getTemporaryUserData() instanceof DuplicateArrayData) {
+          DuplicateArrayData data = (DuplicateArrayData)inst.getTemporaryUserData();
+          inst.setTemporaryUserData(null);
+          AhatInstance original = mInstances.get(data.originalId);
+          if (!(original instanceof AhatArrayInstance)
+              || original.getTemporaryUserData() != null
+              || ((AhatArrayInstance)original).getLength() != data.length) {
+            throw new HprofFormatException(String.format(
+                  "Duplicate array 0x%x has no matching primitive array 0x%x",
+                  inst.getId(), data.originalId));
+          }
+          ((AhatArrayInstance)inst).initialize((AhatArrayInstance)original);
         } else if (inst instanceof AhatArrayInstance && inst.getTemporaryUserData() != null) {
           // TODO: Have specialized object array instance and check for that
           // rather than checking for the presence of user data?
@@ -704,6 +743,16 @@ public class Parser {
     }
   }
 
+  private static class DuplicateArrayData {
+    public int length;          // Number of array elements.
+    public long originalId;     // Id of the primitive array with the same elements.
+
+    public DuplicateArrayData(int length, long originalId) {
+      this.length = length;
+      this.originalId = originalId;
+    }
+  }
+
   private static class ClassObjData {
     public long classLoaderId;
     public FieldValue[] staticFields; // Contains DeferredInstanceValues.
@@ -906,7 +955,7 @@ public class Parser {
    */
   private static class HprofBuffer {
     private boolean mIdSize8;
-    private final ByteBuffer mBuffer;
+    private ByteBuffer mBuffer;
 
     public HprofBuffer(File path) throws IOException {
       FileChannel channel = FileChannel.open(path.toPath(), StandardOpenOption.READ);
@@ -918,6 +967,30 @@ public class Parser {
       mBuffer = buffer;
     }
 
+    /**
+     * Replaces the contents of a gzip compressed heap dump with its
+     * uncompressed contents. Does nothing if the heap dump is not compressed.
+     */
+    public void decompress() throws IOException {
+      if (mBuffer.remaining() < 2
+          || (mBuffer.get(mBuffer.position()) & 0xFF) != 0x1f
+          || (mBuffer.get(mBuffer.position() + 1) & 0xFF) != 0x8b) {
+        return;
+      }
+
+      byte[] compressed = new byte[mBuffer.remaining()];
+      mBuffer.get(compressed);
+      ByteArrayOutputStream baos = new ByteArrayOutputStream();
+      try (InputStream is = new GZIPInputStream(new ByteArrayInputStream(compressed))) {
+        byte[] buf = new byte[64 * 1024];
+        int read;
+        while ((read = is.read(buf)) != -1) {
+          baos.write(buf, 0, read);
+        }
+      }
+      mBuffer = ByteBuffer.wrap(baos.toByteArray());
+    }
+
     public void setIdSize8() {
       mIdSize8 = true;
     }
@@ -20,12 +20,17 @@ import com.android.ahat.heapdump.AhatClassObj;
 import com.android.ahat.heapdump.AhatHeap;
 import com.android.ahat.heapdump.AhatInstance;
 import com.android.ahat.heapdump.AhatSnapshot;
+import com.android.ahat.heapdump.HprofFormatException;
+import com.android.ahat.heapdump.Parser;
 import com.android.ahat.heapdump.PathElement;
 import com.android.ahat.heapdump.Reachability;
 import com.android.ahat.heapdump.Size;
 import com.android.ahat.heapdump.Value;
+import java.io.ByteArrayOutputStream;
 import java.io.IOException;
+import java.nio.ByteBuffer;
 import java.util.List;
+import java.util.zip.GZIPOutputStream;
 import org.junit.Test;
 
 import static org.junit.Assert.assertEquals;
@@ -614,4 +619,18 @@ public class InstanceTest {
     AhatInstance nonBinderObject = dump.getDumpedAhatInstance("anObject");
     assertNull(nonBinderObject.getBinderStubInterfaceName());
   }
+
+  @Test
+  public void gzipCompressedDump() throws IOException, HprofFormatException {
+    TestDump dump = TestDump.getTestDump();
+    AhatInstance str = dump.getDumpedAhatInstance("basicString");
+
+    ByteBuffer hprof = TestDump.dataBufferFromResource("test-dump.hprof");
+    ByteArrayOutputStream baos = new ByteArrayOutputStream();
+    try (GZIPOutputStream gzip = new GZIPOutputStream(baos)) {
+      gzip.write(hprof.array(), hprof.arrayOffset(), hprof.remaining());
+    }
+    AhatSnapshot snapshot = new Parser(ByteBuffer.wrap(baos.toByteArray())).parse();
+    assertEquals("hello, world", snapshot.findInstance(str.getId()).asString());
+  }
 }
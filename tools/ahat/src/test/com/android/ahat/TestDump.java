@@ -75,7 +75,7 @@ public class TestDump {
   /**
    * Read the named resource into a ByteBuffer.
    */
-  private static ByteBuffer dataBufferFromResource(String name) throws IOException {
+  static ByteBuffer dataBufferFromResource(String name) throws IOException {
     ClassLoader loader = TestDump.class.getClassLoader();
     InputStream is = loader.getResourceAsStream(name);
     ByteArrayOutputStream baos = new ByteArrayOutputStream();
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2020 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Compares two JSON outputs of benchmark/runner and reports, for each benchmark,
+   the change of the median time per operation and whether it is significant
+   according to Welch's t-test."""
+
+import argparse
+import json
+import math
+import sys
+
+
+def load(path):
+  with open(path) as f:
+    return {result['benchmark']: result for result in json.load(f)}
+
+
+def welch_t(before, after):
+  """Returns the t statistic of Welch's t-test for the two lists of samples."""
+  def mean_and_variance(samples):
+    mean = sum(samples) / len(samples)
+    return mean, sum((x - mean) ** 2 for x in samples) / (len(samples) - 1)
+  mean_before, variance_before = mean_and_variance(before)
+  mean_after, variance_after = mean_and_variance(after)
+  error = math.sqrt(variance_before / len(before) + variance_after / len(after))
+  if error == 0:
+    return 0.0 if mean_before == mean_after else math.copysign(math.inf, mean_after - mean_before)
+  return (mean_after - mean_before) / error
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('before', help='JSON results of the baseline build')
+  parser.add_argument('after', help='JSON results of the build to compare')
+  parser.add_argument('--threshold', type=float, default=3.0,
+                      help='absolute t statistic above which a change is significant')
+  args = parser.parse_args()
+
+  before = load(args.before)
+  after = load(args.after)
+  print('%-60s %12s %12s %8s %8s' % ('benchmark', 'before (ns)', 'after (ns)', 'change', 't'))
+  for name in sorted(set(before) & set(after)):
+    median_before = before[name]['median_ns']
+    median_after = after[name]['median_ns']
+    change = (median_after - median_before) / median_before * 100 if median_before else 0.0
+    t = welch_t(before[name]['samples_ns'], after[name]['samples_ns'])
+    mark = ' *' if abs(t) > args.threshold else ''
+    print('%-60s %12.2f %12.2f %+7.1f%% %8.2f%s' %
+          (name, median_before, median_after, change, t, mark))
+  for name in sorted(set(before) ^ set(after)):
+    print('%-60s only in %s' % (name, 'before' if name in before else 'after'))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -14,20 +14,25 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
+
 #include <cstdint>
 #include <iostream>
 #include <set>
 #include <sstream>
 
 #include <android-base/file.h>
+#include <android-base/unique_fd.h>
 
 #include "dexanalyze_bytecode.h"
 #include "dexanalyze_experiments.h"
+#include "dexanalyze_patterns.h"
 #include "dexanalyze_strings.h"
 #include "dex/code_item_accessors-inl.h"
 #include "dex/dex_file.h"
 #include "dex/dex_file_loader.h"
 #include "dex/dex_instruction-inl.h"
+#include "profile/profile_compilation_info.h"
 
 namespace art {
 namespace dexanalyze {
@@ -37,6 +42,7 @@ class DexAnalyze {
   static constexpr int kExitCodeFailedToOpenFile = 2;
   static constexpr int kExitCodeFailedToOpenDex = 3;
   static constexpr int kExitCodeFailedToProcessDex = 4;
+  static constexpr int kExitCodeFailedToOpenProfile = 5;
 
   static void StdoutLogger(android::base::LogId,
                            android::base::LogSeverity,
@@ -55,6 +61,8 @@ class DexAnalyze {
         << "    -analyze-strings (Analyze string data)\n"
         << "    -analyze-debug-info (Analyze debug info)\n"
         << "    -new-bytecode (Bytecode optimizations)\n"
+        << "    -hot-patterns (Superinstruction and intrinsic candidates)\n"
+        << "    -profile <file> (Weight -hot-patterns by method hotness in the profile)\n"
         << "    -i (Ignore Dex checksum and verification failures)\n"
         << "    -a (Run all experiments)\n"
         << "    -n <int> (run experiment with 1 .. n as argument)\n"
@@ -100,6 +108,14 @@ class DexAnalyze {
           exp_debug_info_ = true;
         } else if (arg == "-new-bytecode") {
           exp_bytecode_ = true;
+        } else if (arg == "-hot-patterns") {
+          exp_hot_patterns_ = true;
+        } else if (arg == "-profile") {
+          if (i + 1 >= argc) {
+            return Usage(argv);
+          }
+          profile_filename_ = argv[i + 1];
+          ++i;
         } else if (arg == "-d") {
           dump_per_input_dex_ = true;
         } else if (!arg.empty() && arg[0] == '-') {
@@ -124,9 +140,13 @@ class DexAnalyze {
     bool exp_analyze_strings_ = false;
     bool exp_debug_info_ = false;
     bool exp_bytecode_ = false;
+    bool exp_hot_patterns_ = false;
     bool run_all_experiments_ = false;
     uint64_t experiment_max_ = 1u;
+    std::string profile_filename_;
     std::vector<std::string> filenames_;
+    // Loaded from `profile_filename_`, if any.
+    const ProfileCompilationInfo* profile_ = nullptr;
   };
 
   class Analysis {
@@ -144,6 +164,9 @@ class DexAnalyze {
       if (options->run_all_experiments_ || options->exp_debug_info_) {
         experiments_.emplace_back(new AnalyzeDebugInfo);
       }
+      if (options->run_all_experiments_ || options->exp_hot_patterns_) {
+        experiments_.emplace_back(new AnalyzeHotPatterns(options->profile_));
+      }
       if (options->run_all_experiments_ || options->exp_bytecode_) {
         for (size_t i = 0; i < options->experiment_max_; ++i) {
           uint64_t exp_value = 0u;
@@ -196,6 +219,17 @@ class DexAnalyze {
       return result;
     }
 
+    ProfileCompilationInfo profile;
+    if (!options.profile_filename_.empty()) {
+      android::base::unique_fd profile_fd(
+          open(options.profile_filename_.c_str(), O_RDONLY | O_CLOEXEC));
+      if (profile_fd.get() < 0 || !profile.Load(profile_fd.get())) {
+        LOG(ERROR) << "Failed to load profile " << options.profile_filename_ << std::endl;
+        return kExitCodeFailedToOpenProfile;
+      }
+      options.profile_ = &profile;
+    }
+
     DexFileLoaderErrorCode error_code;
     std::string error_msg;
     Analysis cumulative(&options);
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dexanalyze_patterns.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <set>
+
+#include "base/leb128.h"
+#include "dex/bytecode_utils.h"
+#include "dex/class_accessor-inl.h"
+#include "dex/code_item_accessors-inl.h"
+#include "dex/dex_file_exception_helpers.h"
+#include "dex/dex_instruction-inl.h"
+#include "dex/method_reference.h"
+#include "profile/profile_compilation_info.h"
+
+namespace art {
+namespace dexanalyze {
+
+uint64_t AnalyzeHotPatterns::GetMethodWeight(const DexFile& dex_file, uint32_t method_idx) const {
+  if (profile_ == nullptr) {
+    return kColdMethodWeight;
+  }
+  ProfileCompilationInfo::MethodHotness hotness =
+      profile_->GetMethodHotness(MethodReference(&dex_file, method_idx));
+  if (hotness.IsHot()) {
+    return kHotMethodWeight;
+  } else if (hotness.IsInProfile()) {
+    return kStartupMethodWeight;
+  }
+  return kColdMethodWeight;
+}
+
+void AnalyzeHotPatterns::ProcessDexFile(const DexFile& dex_file) {
+  for (ClassAccessor accessor : dex_file.GetClasses()) {
+    for (const ClassAccessor::Method& method : accessor.GetMethods()) {
+      CodeItemDataAccessor code_item(dex_file, method.GetCodeItem());
+      if (!code_item.HasCodeItem()) {
+        continue;
+      }
+      uint64_t weight = GetMethodWeight(dex_file, method.GetIndex());
+      ++methods_;
+      if (weight != kColdMethodWeight) {
+        ++hot_methods_;
+      }
+      ProcessCodeItem(dex_file, code_item, weight);
+    }
+  }
+}
+
+void AnalyzeHotPatterns::ProcessCodeItem(const DexFile& dex_file,
+                                         const CodeItemDataAccessor& code_item,
+                                         uint64_t weight) {
+  // A superinstruction is dispatched as a whole, so no instruction other than the first one
+  // may be the target of a branch, a switch or an exception handler.
+  std::set<uint32_t> targets;
+  for (const DexInstructionPcPair& inst : code_item) {
+    if (inst->IsBranch()) {
+      targets.insert(inst.DexPc() + inst->GetTargetOffset());
+    } else if (inst->IsSwitch()) {
+      DexSwitchTable table(inst.Inst(), inst.DexPc());
+      for (DexSwitchTableIterator it(table); !it.Done(); it.Advance()) {
+        targets.insert(inst.DexPc() + it.CurrentTargetOffset());
+      }
+    }
+  }
+  if (code_item.TriesSize() != 0) {
+    const uint8_t* handlers_ptr = code_item.GetCatchHandlerData();
+    uint32_t handlers_size = DecodeUnsignedLeb128(&handlers_ptr);
+    for (uint32_t idx = 0; idx < handlers_size; ++idx) {
+      CatchHandlerIterator iterator(handlers_ptr);
+      for (; iterator.HasNext(); iterator.Next()) {
+        targets.insert(iterator.GetHandlerAddress());
+      }
+      handlers_ptr = iterator.EndDataPointer();
+    }
+  }
+
+  // The current run of instructions that may be fused.
+  std::vector<Instruction::Code> run;
+  for (const DexInstructionPcPair& inst : code_item) {
+    const Instruction::Code opcode = inst->Opcode();
+    if (opcode == Instruction::NOP) {
+      // Also covers switch and array data payloads, which are never executed.
+      run.clear();
+      continue;
+    }
+    if (targets.find(inst.DexPc()) != targets.end()) {
+      run.clear();
+    }
+    run.push_back(opcode);
+    weighted_instructions_ += weight;
+    for (size_t length = 2; length <= std::min(run.size(), kMaxSequenceLength); ++length) {
+      Count& count = sequences_[std::vector<Instruction::Code>(run.end() - length, run.end())];
+      ++count.occurrences;
+      count.weighted += weight;
+    }
+    switch (opcode) {
+      case Instruction::INVOKE_VIRTUAL:
+      case Instruction::INVOKE_VIRTUAL_RANGE:
+      case Instruction::INVOKE_DIRECT:
+      case Instruction::INVOKE_DIRECT_RANGE:
+      case Instruction::INVOKE_SUPER:
+      case Instruction::INVOKE_SUPER_RANGE:
+      case Instruction::INVOKE_STATIC:
+      case Instruction::INVOKE_STATIC_RANGE:
+      case Instruction::INVOKE_INTERFACE:
+      case Instruction::INVOKE_INTERFACE_RANGE: {
+        Count& count = invoke_targets_[dex_file.PrettyMethod(DexMethodIndex(inst.Inst()))];
+        ++count.occurrences;
+        count.weighted += weight;
+        weighted_invokes_ += weight;
+        break;
+      }
+      default:
+        break;
+    }
+    if (inst->IsBasicBlockEnd() || inst->IsSwitch()) {
+      run.clear();
+    }
+  }
+}
+
+void AnalyzeHotPatterns::Dump(std::ostream& os, uint64_t total_size ATTRIBUTE_UNUSED) const {
+  const size_t num_candidates =
+      verbose_level_ >= VerboseLevel::kEverything ? kNumCandidatesVerbose : kNumCandidates;
+  os << "Hot pattern analysis\n";
+  os << "Methods with code: " << methods_ << "\n";
+  os << "Methods in profile: " << Percent(hot_methods_, methods_) << "\n";
+  os << "Weighted instructions: " << weighted_instructions_ << "\n";
+
+  // Fusing a sequence of N instructions saves N - 1 dispatches each time it is executed.
+  // Overlapping sequences are counted independently, so the savings are an upper bound.
+  std::vector<std::pair<uint64_t, const std::vector<Instruction::Code>*>> sequences;
+  for (const auto& pair : sequences_) {
+    sequences.emplace_back(pair.second.weighted * (pair.first.size() - 1u), &pair.first);
+  }
+  std::sort(sequences.rbegin(), sequences.rend());
+  os << "Superinstruction candidates (estimated dispatch savings, occurrences):\n";
+  for (size_t i = 0; i < std::min(num_candidates, sequences.size()); ++i) {
+    const std::vector<Instruction::Code>& sequence = *sequences[i].second;
+    os << std::setw(4) << i + 1 << ": ";
+    for (size_t j = 0; j < sequence.size(); ++j) {
+      os << (j != 0 ? " + " : "") << Instruction::Name(sequence[j]);
+    }
+    os << " savings=" << Percent(sequences[i].first, weighted_instructions_)
+       << " occurrences=" << sequences_.find(sequence)->second.occurrences << "\n";
+  }
+
+  // An intrinsic saves the whole call sequence, which is counted as one dispatch here.
+  std::vector<std::pair<uint64_t, const std::string*>> targets;
+  for (const auto& pair : invoke_targets_) {
+    targets.emplace_back(pair.second.weighted, &pair.first);
+  }
+  std::sort(targets.rbegin(), targets.rend());
+  os << "Intrinsic candidates (weighted invokes, call sites):\n";
+  for (size_t i = 0; i < std::min(num_candidates, targets.size()); ++i) {
+    const std::string& target = *targets[i].second;
+    os << std::setw(4) << i + 1 << ": " << target
+       << " invokes=" << Percent(targets[i].first, weighted_invokes_)
+       << " call_sites=" << invoke_targets_.find(target)->second.occurrences << "\n";
+  }
+}
+
+}  // namespace dexanalyze
+}  // namespace art
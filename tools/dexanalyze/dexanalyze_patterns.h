@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_TOOLS_DEXANALYZE_DEXANALYZE_PATTERNS_H_
+#define ART_TOOLS_DEXANALYZE_DEXANALYZE_PATTERNS_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "dexanalyze_experiments.h"
+#include "dex/code_item_accessors.h"
+#include "dex/dex_instruction.h"
+
+namespace art {
+
+class ProfileCompilationInfo;
+
+namespace dexanalyze {
+
+// Mine frequent opcode sequences and invoke targets, weighted by method hotness if a profile is
+// given. The results are ranked candidates for interpreter superinstructions and intrinsics.
+class AnalyzeHotPatterns : public Experiment {
+ public:
+  explicit AnalyzeHotPatterns(const ProfileCompilationInfo* profile) : profile_(profile) {}
+
+  void ProcessDexFile(const DexFile& dex_file) override;
+  void Dump(std::ostream& os, uint64_t total_size) const override;
+
+ private:
+  // Weights used for methods depending on their profile hotness. Without a profile, every
+  // method has the weight of a method that is not in the profile.
+  static constexpr uint64_t kHotMethodWeight = 100u;
+  static constexpr uint64_t kStartupMethodWeight = 10u;
+  static constexpr uint64_t kColdMethodWeight = 1u;
+
+  // Sequences from two up to this many instructions are counted.
+  static constexpr size_t kMaxSequenceLength = 4u;
+
+  static constexpr size_t kNumCandidates = 25u;
+  static constexpr size_t kNumCandidatesVerbose = 100u;
+
+  struct Count {
+    // Number of static occurrences.
+    uint64_t occurrences = 0u;
+    // Sum of the weights of the methods containing the occurrences.
+    uint64_t weighted = 0u;
+  };
+
+  uint64_t GetMethodWeight(const DexFile& dex_file, uint32_t method_idx) const;
+  void ProcessCodeItem(const DexFile& dex_file,
+                       const CodeItemDataAccessor& code_item,
+                       uint64_t weight);
+
+  const ProfileCompilationInfo* const profile_;
+
+  uint64_t methods_ = 0u;
+  uint64_t hot_methods_ = 0u;
+  // Weighted count of all dispatched instructions.
+  uint64_t weighted_instructions_ = 0u;
+  uint64_t weighted_invokes_ = 0u;
+  std::map<std::vector<Instruction::Code>, Count> sequences_;
+  std::map<std::string, Count> invoke_targets_;
+};
+
+}  // namespace dexanalyze
+}  // namespace art
+
+#endif  // ART_TOOLS_DEXANALYZE_DEXANALYZE_PATTERNS_H_